@@ -23,12 +23,14 @@
 CBaseCreateProps::CBaseCreateProps() : 
 	m_nFXFlags(0),
 	m_nNumEffects(0),
-	m_nNumToCreate(1)
+	m_nNumToCreate(1),
+	m_bResolvedEffects(false)
 {
 	//initalize all the names to be empty
 	for(uint32 nCurrEffect = 0; nCurrEffect < knNumEffects; nCurrEffect++)
 	{
 		m_pszEffects[nCurrEffect] = NULL;
+		m_hEffects[nCurrEffect] = INVALID_FX_GROUP;
 	}
 }
 
@@ -121,11 +123,36 @@ bool CBaseCreateFX::CreateEffect(const CLIENTFX_CREATESTRUCT& CreateStruct)
 	if(GetProps()->m_nNumEffects == 0)
 		return false;
 
+	//the first time any of these properties are used, resolve the effect names to handles so
+	//that creating them does not need to look up the name. Names that are delimited lists of
+	//effects are left to CreateNewFX.
+	const CBaseCreateProps* pProps = GetProps();
+	if(!pProps->m_bResolvedEffects)
+	{
+		for(uint32 nCurrEffect = 0; nCurrEffect < pProps->m_nNumEffects; nCurrEffect++)
+		{
+			const char* pszEffect = pProps->m_pszEffects[nCurrEffect];
+			if(!strpbrk(pszEffect, "; \t") && (LTStrLen(pszEffect) <= MAX_CLIENTFX_NAME_LEN))
+				pProps->m_hEffects[nCurrEffect] = m_pFxMgr->ResolveEffect(pszEffect);
+		}
+		pProps->m_bResolvedEffects = true;
+	}
+
 	//find a random effect within our collection of effects
-	uint32 nRandom = GetRandom(0, GetProps()->m_nNumEffects - 1);
-	
+	uint32 nRandom = GetRandom(0, pProps->m_nNumEffects - 1);
+
 	//and now create it at the specified rotation and position
-	CreateNewFX(m_pFxMgr, GetProps()->m_pszEffects[nRandom], CreateStruct, true);
+	if(pProps->m_hEffects[nRandom] != INVALID_FX_GROUP)
+	{
+		CLIENTFX_CREATESTRUCT OurCreateStruct = CreateStruct;
+		LTStrCpy(OurCreateStruct.m_sName, pProps->m_pszEffects[nRandom], LTARRAYSIZE(OurCreateStruct.m_sName));
+		OurCreateStruct.m_hGroup = pProps->m_hEffects[nRandom];
+		m_pFxMgr->CreateEffect(OurCreateStruct, true);
+	}
+	else
+	{
+		CreateNewFX(m_pFxMgr, pProps->m_pszEffects[nRandom], CreateStruct, true);
+	}
 
 	//success
 	return true;
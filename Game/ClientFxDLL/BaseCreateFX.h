@@ -37,6 +37,11 @@ public:
 	//the list of the different effects
 	const char*	m_pszEffects[knNumEffects];
 
+	//handles to each of the effects above, resolved the first time an effect is created. An
+	//effect that lists several names is left as INVALID_FX_GROUP and created by name.
+	mutable HFXGROUP	m_hEffects[knNumEffects];
+	mutable bool		m_bResolvedEffects;
+
 	//the number of effects provided
 	uint32		m_nNumEffects;
 
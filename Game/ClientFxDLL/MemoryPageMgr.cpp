@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "memorypagemgr.h"
+#include "ltautocriticalsection.h"
 
 //---------------------------------------------------------------------------------
 // Constants
@@ -50,6 +51,8 @@ void CMemoryPage::Free(uint32 nSize)
 // CMemoryPageMgr
 //---------------------------------------------------------------------------------
 
+bool CMemoryPageMgr::s_bThreadSafe = false;
+
 CMemoryPageMgr::CMemoryPageMgr(uint32 nPageSize, uint32 nMaxMemory) :
 	m_nAllocatedMemory(0),
 	m_nMaxAllocatedMemory(nMaxMemory),
@@ -115,6 +118,15 @@ uint32 CMemoryPageMgr::GetCurrentMemoryUsage() const
 //called to request a page from the memory page manager. This can return
 //NULL if the memory limit for the memory page manager has been exceeded.
 CMemoryPage* CMemoryPageMgr::AllocatePage()
+{
+	if(!s_bThreadSafe)
+		return AllocatePageUnlocked();
+
+	CLTAutoCriticalSection cAutoCS(m_csPages);
+	return AllocatePageUnlocked();
+}
+
+CMemoryPage* CMemoryPageMgr::AllocatePageUnlocked()
 {
 	//see if we have a free one on the list
 	CMemoryPage* pPage = PopFreePage();
@@ -151,6 +163,18 @@ CMemoryPage* CMemoryPageMgr::AllocatePage()
 
 //called to free a memory page that is no longer in use.
 void CMemoryPageMgr::FreePage(CMemoryPage* pPage)
+{
+	if(!s_bThreadSafe)
+	{
+		FreePageUnlocked(pPage);
+		return;
+	}
+
+	CLTAutoCriticalSection cAutoCS(m_csPages);
+	FreePageUnlocked(pPage);
+}
+
+void CMemoryPageMgr::FreePageUnlocked(CMemoryPage* pPage)
 {
 	//if we are over our memory budget, then toss this page, otherwise push it onto our list
 	if(m_nAllocatedMemory > m_nMaxAllocatedMemory)
@@ -10,6 +10,10 @@
 #ifndef __MEMORYPAGEMGR_H__
 #define __MEMORYPAGEMGR_H__
 
+#ifndef __LTCRITICALSECTION_H__
+#include "ltcriticalsection.h"
+#endif
+
 //defines a single memory page which at its simplest is a block of memory in a doubly
 //linked list
 class CMemoryPage
@@ -105,6 +109,11 @@ public:
 	//called to free a memory page that is no longer in use.
 	void				FreePage(CMemoryPage* pPage);
 
+	//called to allow pages to be allocated and freed from any thread, which is needed while
+	//effects are updated on the worker threads. Until then pages are only used from the main
+	//thread and are not locked.
+	static void			SetThreadSafe(bool bThreadSafe)	{ s_bThreadSafe = bThreadSafe; }
+
 private:
 
 	//we don't allow copying of this object
@@ -113,6 +122,10 @@ private:
 	//deletes the specified page. This assumes that the page has already been detatched
 	void				DeletePage(CMemoryPage* pPage);
 
+	//versions of AllocatePage and FreePage that assume the page lists are already locked if needed
+	CMemoryPage*		AllocatePageUnlocked();
+	void				FreePageUnlocked(CMemoryPage* pPage);
+
 	//this function will pop a page off of the free list, and return NULL if there are no
 	//more pages on the list
 	CMemoryPage*		PopFreePage();
@@ -128,6 +141,13 @@ private:
 
 	//the head of our free list
 	CMemoryPage*		m_pFreeList;
+
+	//protects the free list and memory totals from being changed by multiple threads at once
+	//while page managers are thread safe
+	CLTCriticalSection	m_csPages;
+
+	//whether or not pages can currently be allocated and freed from multiple threads
+	static bool			s_bThreadSafe;
 };
 
 
@@ -12,6 +12,9 @@
 //our object used for tracking performance for effect
 static CTimedSystem g_tsClientFXParticles("ClientFX_Particles", "ClientFX");
 
+//the value used to initialize particle bounding boxes to extreme extents
+static const float kfInfinity = FLT_MAX;
+
 //-------------------------------------------------------------------------------------------
 // Particle Structures
 //-------------------------------------------------------------------------------------------
@@ -144,7 +147,9 @@ CParticleSystemGroup::CParticleSystemGroup() :
 	m_hCustomRender(NULL),
 	m_pProps(NULL),
 	m_pFxMgr(NULL),
-	m_pVisibleFlag(NULL)
+	m_pVisibleFlag(NULL),
+	m_bParallelUpdatePending(false),
+	m_nParallelUpdateIndex(0)
 {
 	//setup our particle stride
 	m_Particles.SetStride(sizeof(SParticle));
@@ -214,6 +219,13 @@ bool CParticleSystemGroup::Init(IClientFXMgr* pFxMgr, HMATERIAL hMaterial, const
 //called to terminate this object and place it into an invalid state
 void CParticleSystemGroup::Term()
 {
+	//make sure that the manager doesn't run an update for us after we are gone
+	if(m_bParallelUpdatePending)
+	{
+		m_pFxMgr->CancelParallelUpdate(this, m_nParallelUpdateIndex);
+		m_bParallelUpdatePending = false;
+	}
+
 	m_nNumRayTestParticles = 0;
 	m_Particles.FreeAllParticles();
 
@@ -227,6 +239,9 @@ void CParticleSystemGroup::Term()
 //called to add a particle batch marker onto our listing of particles
 void CParticleSystemGroup::AddParticleBatchMarker(float fUpdateTime, bool bDefault)
 {
+	//the marker must be added after any update that was queued earlier
+	FinishParallelUpdate();
+
 	SParticle* pParticle = (SParticle*)m_Particles.AllocateParticle();
 	if(!pParticle)
 	{
@@ -252,6 +267,9 @@ void CParticleSystemGroup::EmitParticleBatch(float fUnitLifetime, float fUpdateT
 {
 	LTASSERT(m_pProps, "Error: Called EmitParticleBatch on an uninitialized particle group");
 
+	//the new particles must not be stepped by an update that was queued earlier
+	FinishParallelUpdate();
+
 	//determine the number of particles that we are going to emit (and bail if we aren't going to emit any)
 	uint32 nParticlesToEmit = m_pProps->m_nfcParticlesPerEmission.GetValue(fUnitLifetime);
 	if(nParticlesToEmit == 0)
@@ -373,6 +391,9 @@ void CParticleSystemGroup::UpdateParticles(float tmFrame, const LTVector& vGravi
 	//track our performance
 	CTimedSystemBlock TimingBlock(g_tsClientFXParticles);
 
+	//any update that was queued earlier needs to be completed before we step the particles again
+	FinishParallelUpdate();
+
 	//get an iterator to our list of particles
 	CParticleReverseIterator itParticles = m_Particles.GetReverseIterator();
 
@@ -380,101 +401,45 @@ void CParticleSystemGroup::UpdateParticles(float tmFrame, const LTVector& vGravi
 	if(itParticles.IsDone())
 		return;
 
-	//find the coefficient of restitution to use for these particles in case they bounce
-	float fCOR = m_pProps->m_fBounceStrength;
-
-	//do our particles have infinite lifetime?
-	bool bInfiniteLife = m_pProps->m_bInfiniteLife;
-
 	//initialize our particle bounding box to extreme extents
-	static const float kfInfinity = FLT_MAX;
 	LTVector vMin = LTVector(kfInfinity, kfInfinity, kfInfinity);
 	LTVector vMax = LTVector(-kfInfinity, -kfInfinity, -kfInfinity);
 
-	LTVector vDefaultGravity	= vGravity * tmFrame;
-	float fDefaultFriction		= powf(fFrictionCoef, tmFrame);
-
-	//the current gravity and friction for us to use
-	LTVector vCurrGravity	= vDefaultGravity;
-	float fCurrFriction		= fDefaultFriction;
-	float fCurrUpdateTime	= tmFrame;
-
 	//we now need to handle updating the particles. For performance reasons, this is broken apart
 	//into two update loops, one that handles bouncing/splat, another that doesn't
 	if(m_nNumRayTestParticles == 0)
 	{
-		//this is the non-bouncing update loop
-		while(!itParticles.IsDone())
+		//the non-bouncing update only touches our own particles, so try to hand it off to the worker
+		//threads, in which case our object will be updated once it is complete
+		m_tmPendingFrame		= tmFrame;
+		m_vPendingGravity		= vGravity;
+		m_fPendingFrictionCoef	= fFrictionCoef;
+		m_tPendingObjTrans		= tObjTrans;
+
+		if(m_pFxMgr && m_pFxMgr->QueueParallelUpdate(this, m_nParallelUpdateIndex))
 		{
-			SParticle* pParticle = (SParticle*)itParticles.GetParticle();
-
-			//update the lifetime
-			pParticle->m_fLifetime -= fCurrUpdateTime;
-
-			// Check for expiration
-			if( pParticle->m_fLifetime <= 0.0f )
-			{
-				if(pParticle->m_nUserData & PARTICLE_BATCH_MARKER)
-				{
-					//restore our defaults
-					if(pParticle->m_nUserData & PARTICLE_DEFAULT_BATCH)
-					{
-						//restore our defaults
-						vCurrGravity	= vDefaultGravity;
-						fCurrFriction	= fDefaultFriction;
-						fCurrUpdateTime = tmFrame;
-					}
-					else
-					{
-						//compute new values for us to use
-						vCurrGravity	= vGravity * pParticle->m_fTotalLifetime;
-						fCurrFriction	= powf(fFrictionCoef, pParticle->m_fTotalLifetime);
-						fCurrUpdateTime	= pParticle->m_fTotalLifetime;
-					}						
+			m_bParallelUpdatePending = true;
+			return;
+		}
 
-					//do the direct remove (we know batch markers don't have bounce or splat)
-					itParticles = m_Particles.RemoveParticle(itParticles);
-					continue;
-				}
-				else if(bInfiniteLife)
-				{
-					//this particle has died, but resurrect it since it lives forever
-					pParticle->m_fLifetime = pParticle->m_fTotalLifetime - fmodf(-pParticle->m_fLifetime, pParticle->m_fTotalLifetime); 				
-				}
-				else
-				{
-					//remove the dead particle (can do direct version since we know we don't have splat or bounce)
-					itParticles = m_Particles.RemoveParticle(itParticles);
-					continue;
-				}
-			}
+		StepParticles(tmFrame, vGravity, fFrictionCoef, vMin, vMax);
+	}
+	else
+	{
+		//find the coefficient of restitution to use for these particles in case they bounce
+		float fCOR = m_pProps->m_fBounceStrength;
 
-			// Give the particle an update
+		//do our particles have infinite lifetime?
+		bool bInfiniteLife = m_pProps->m_bInfiniteLife;
 
-			//update the velocity, applying gravity and friction
-			pParticle->m_Velocity = pParticle->m_Velocity * fCurrFriction + vCurrGravity;
-			pParticle->m_Pos	 += pParticle->m_Velocity * fCurrUpdateTime;
+		LTVector vDefaultGravity	= vGravity * tmFrame;
+		float fDefaultFriction		= powf(fFrictionCoef, tmFrame);
 
-			// Update the angle if appropriate
-			pParticle->m_fAngle	+= pParticle->m_fAngularVelocity * fCurrUpdateTime;
+		//the current gravity and friction for us to use
+		LTVector vCurrGravity	= vDefaultGravity;
+		float fCurrFriction		= fDefaultFriction;
+		float fCurrUpdateTime	= tmFrame;
 
-			//extend the bounding box
-			vMin.Min(pParticle->m_Pos);
-			vMax.Max(pParticle->m_Pos);
-
-			if(m_pProps->m_bStreak)
-			{
-				LTVector vStreakPt = pParticle->m_Pos - pParticle->m_Velocity * m_pProps->m_fStreakScale;
-				vMin.Min(vStreakPt);
-				vMax.Max(vStreakPt);
-			}
-
-			//and move onto the next particle
-			itParticles.Prev();
-		}
-	}
-	else
-	{
 		//this is the bouncing/splat update loop
 		IntersectQuery		iQuery;
 		IntersectInfo		iInfo;
@@ -637,6 +602,104 @@ void CParticleSystemGroup::UpdateParticles(float tmFrame, const LTVector& vGravi
 		}
 	}
 
+	UpdateVisibility(vMin, vMax, tObjTrans);
+}
+
+//steps all of the particles in this group, which must not have any particles that require ray testing,
+//and extends the provided extents to contain them. This only touches the particles in this group
+//and so can be called from any thread
+void CParticleSystemGroup::StepParticles(float tmFrame, const LTVector& vGravity, float fFrictionCoef, LTVector& vMin, LTVector& vMax)
+{
+	LTASSERT(m_nNumRayTestParticles == 0, "Error: Called StepParticles on a group with particles that require ray tests");
+
+	//get an iterator to our list of particles
+	CParticleReverseIterator itParticles = m_Particles.GetReverseIterator();
+
+	//do our particles have infinite lifetime?
+	bool bInfiniteLife = m_pProps->m_bInfiniteLife;
+
+	LTVector vDefaultGravity	= vGravity * tmFrame;
+	float fDefaultFriction		= powf(fFrictionCoef, tmFrame);
+
+	//the current gravity and friction for us to use
+	LTVector vCurrGravity	= vDefaultGravity;
+	float fCurrFriction		= fDefaultFriction;
+	float fCurrUpdateTime	= tmFrame;
+
+	while(!itParticles.IsDone())
+	{
+		SParticle* pParticle = (SParticle*)itParticles.GetParticle();
+
+		//update the lifetime
+		pParticle->m_fLifetime -= fCurrUpdateTime;
+
+		// Check for expiration
+		if( pParticle->m_fLifetime <= 0.0f )
+		{
+			if(pParticle->m_nUserData & PARTICLE_BATCH_MARKER)
+			{
+				//restore our defaults
+				if(pParticle->m_nUserData & PARTICLE_DEFAULT_BATCH)
+				{
+					//restore our defaults
+					vCurrGravity	= vDefaultGravity;
+					fCurrFriction	= fDefaultFriction;
+					fCurrUpdateTime = tmFrame;
+				}
+				else
+				{
+					//compute new values for us to use
+					vCurrGravity	= vGravity * pParticle->m_fTotalLifetime;
+					fCurrFriction	= powf(fFrictionCoef, pParticle->m_fTotalLifetime);
+					fCurrUpdateTime	= pParticle->m_fTotalLifetime;
+				}						
+
+				//do the direct remove (we know batch markers don't have bounce or splat)
+				itParticles = m_Particles.RemoveParticle(itParticles);
+				continue;
+			}
+			else if(bInfiniteLife)
+			{
+				//this particle has died, but resurrect it since it lives forever
+				pParticle->m_fLifetime = pParticle->m_fTotalLifetime - fmodf(-pParticle->m_fLifetime, pParticle->m_fTotalLifetime); 				
+			}
+			else
+			{
+				//remove the dead particle (can do direct version since we know we don't have splat or bounce)
+				itParticles = m_Particles.RemoveParticle(itParticles);
+				continue;
+			}
+		}
+
+		// Give the particle an update
+
+		//update the velocity, applying gravity and friction
+		pParticle->m_Velocity = pParticle->m_Velocity * fCurrFriction + vCurrGravity;
+		pParticle->m_Pos	 += pParticle->m_Velocity * fCurrUpdateTime;
+
+		// Update the angle if appropriate
+		pParticle->m_fAngle	+= pParticle->m_fAngularVelocity * fCurrUpdateTime;
+
+		//extend the bounding box
+		vMin.Min(pParticle->m_Pos);
+		vMax.Max(pParticle->m_Pos);
+
+		if(m_pProps->m_bStreak)
+		{
+			LTVector vStreakPt = pParticle->m_Pos - pParticle->m_Velocity * m_pProps->m_fStreakScale;
+			vMin.Min(vStreakPt);
+			vMax.Max(vStreakPt);
+		}
+
+		//and move onto the next particle
+		itParticles.Prev();
+	}
+}
+
+//given the extents of the particles, this will update the visibility box and the transform of our
+//object to match
+void CParticleSystemGroup::UpdateVisibility(LTVector vMin, LTVector vMax, const LTRigidTransform& tObjTrans)
+{
 	//handle the case where we didn't hit any particles and therefore need to clear out our min and
 	//max (note we only check one component for speed)
 	if(vMin.x == kfInfinity)
@@ -682,6 +745,34 @@ void CParticleSystemGroup::UpdateParticles(float tmFrame, const LTVector& vGravi
 	g_pLTClient->SetObjectTransform(m_hCustomRender, tObjTrans);
 }
 
+//called to make sure that a particle update that was queued with the effect manager has been performed
+void CParticleSystemGroup::FinishParallelUpdate()
+{
+	if(!m_bParallelUpdatePending)
+		return;
+
+	//take the update back from the manager and just perform it now
+	m_pFxMgr->CancelParallelUpdate(this, m_nParallelUpdateIndex);
+	ParallelUpdate();
+	CommitParallelUpdate();
+}
+
+//called by the effect manager to perform the queued particle update, potentially on a worker thread
+void CParticleSystemGroup::ParallelUpdate()
+{
+	m_vPendingMin = LTVector(kfInfinity, kfInfinity, kfInfinity);
+	m_vPendingMax = LTVector(-kfInfinity, -kfInfinity, -kfInfinity);
+
+	StepParticles(m_tmPendingFrame, m_vPendingGravity, m_fPendingFrictionCoef, m_vPendingMin, m_vPendingMax);
+}
+
+//called by the effect manager on the main thread once the queued particle update has been performed
+void CParticleSystemGroup::CommitParallelUpdate()
+{
+	m_bParallelUpdatePending = false;
+	UpdateVisibility(m_vPendingMin, m_vPendingMax, m_tPendingObjTrans);
+}
+
 
 //this will randomly generate an object space position for the starting of a particle based upon
 //the current properties of this effect
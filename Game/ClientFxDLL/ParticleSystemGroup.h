@@ -13,6 +13,10 @@
 #	include "iltcustomrendercallback.h"
 #endif
 
+#ifndef __ICLIENTFXMGR_H__
+#	include "IClientFXMgr.h"
+#endif
+
 //forward declarations
 struct SParticle;
 class CParticleSystemProps;
@@ -23,7 +27,8 @@ class CParticleSystemProps;
 //a particle group represents a collection of particles and maintains a single custom render object
 //for visibility and rendering of the group
 
-class CParticleSystemGroup
+class CParticleSystemGroup :
+	public IClientFXParallelUpdate
 {
 public:
 
@@ -40,9 +45,14 @@ public:
 	//called to emit a batch of particles given the properties 
 	void	EmitParticleBatch(float fUnitLifetime, float fUpdateTime, const LTRigidTransform& tObjTrans);
 
-	//called to handle updating of a batch of particles given the appropriate properties
+	//called to handle updating of a batch of particles given the appropriate properties. When the
+	//particles don't need any ray testing, this may be queued with the effect manager to be run
+	//on the worker threads after all effects have been updated
 	void	UpdateParticles(float tmFrame, const LTVector& vGravity, float fFrictionCoef, const LTRigidTransform& tObjTrans);
 
+	//called to make sure that any queued particle update has been performed
+	void	FinishParallelUpdate();
+
 	//called to get the number of particles in this system
 	uint32	GetNumParticles() const			{ return m_Particles.GetNumParticles(); }
 
@@ -68,6 +78,19 @@ private:
 	//called to remove a particle using the particle iterator
 	CParticleReverseIterator	RemoveParticle(CParticleReverseIterator& Iterator);
 
+	//---------------------------------------
+	// Particle Updating
+
+	//steps particles that don't require ray testing and extends the extents to contain them
+	void	StepParticles(float tmFrame, const LTVector& vGravity, float fFrictionCoef, LTVector& vMin, LTVector& vMax);
+
+	//updates the visibility box and transform of our object given the extents of the particles
+	void	UpdateVisibility(LTVector vMin, LTVector vMax, const LTRigidTransform& tObjTrans);
+
+	//IClientFXParallelUpdate implementation
+	virtual void	ParallelUpdate();
+	virtual void	CommitParallelUpdate();
+
 	//---------------------------------------
 	// Particle Rendering
 
@@ -97,6 +120,19 @@ private:
 
 	//the properties associated with this particle system
 	const CParticleSystemProps*	m_pProps;
+
+	//the particle update that has been queued with the effect manager, if any, and its index in
+	//the manager's queue
+	bool				m_bParallelUpdatePending;
+	uint32				m_nParallelUpdateIndex;
+	float				m_tmPendingFrame;
+	LTVector			m_vPendingGravity;
+	float				m_fPendingFrictionCoef;
+	LTRigidTransform	m_tPendingObjTrans;
+
+	//the extents of the particles once the queued update has been performed
+	LTVector			m_vPendingMin;
+	LTVector			m_vPendingMax;
 };
 
 #endif
\ No newline at end of file
@@ -38,7 +38,9 @@ CPolyTrailFX::CPolyTrailFX() :
 	m_nTrailSamplePitch(0),
 	m_fAccumulatedDist(0.0f),
 	m_fTotalElapsed(0.0f),
-	m_hObject(NULL)
+	m_hObject(NULL),
+	m_bParallelUpdatePending(false),
+	m_nParallelUpdateIndex(0)
 {
 }
 
@@ -103,6 +105,13 @@ bool CPolyTrailFX::Init(const FX_BASEDATA *pBaseData, const CBaseFXProps *pProps
 
 void CPolyTrailFX::Term()
 {
+	//make sure that the manager doesn't run an update for us after we are gone
+	if(m_bParallelUpdatePending)
+	{
+		m_pFxMgr->CancelParallelUpdate(this, m_nParallelUpdateIndex);
+		m_bParallelUpdatePending = false;
+	}
+
 	//free our memory pages
 	CMemoryPage* pCurrPage = m_pPageHead;
 	while(pCurrPage)
@@ -146,6 +155,9 @@ bool CPolyTrailFX::Update(float tmFrameTime)
 	//track our performance
 	CTimedSystemBlock TimingBlock(g_tsClientFXPolyTrail);
 
+	//any update that was queued earlier needs to be completed before we change the samples again
+	FinishParallelUpdate();
+
 	//allow the base class to update first
 	BaseUpdate(tmFrameTime);
 
@@ -207,6 +219,9 @@ bool CPolyTrailFX::SuspendedUpdate(float tmFrameTime)
 	//track our performance
 	CTimedSystemBlock TimingBlock(g_tsClientFXPolyTrail);
 
+	//any update that was queued earlier needs to be completed before we change the samples again
+	FinishParallelUpdate();
+
 	if(!CBaseFX::SuspendedUpdate(tmFrameTime))
 		return false;
 
@@ -320,8 +335,28 @@ void CPolyTrailFX::UpdateCurrentSamplePositions(const LTVector& vObjectPos)
 //called to update the current samples that we have and also the visibility for this object
 void CPolyTrailFX::UpdateSamples(float fElapsed, const LTVector& vObjectPos)
 {
-	LTVector vMin = vObjectPos;
-	LTVector vMax = vObjectPos;
+	//stepping the samples only touches our own samples, so try to hand it off to the worker
+	//threads, in which case our visibility will be updated once it is complete
+	m_fPendingElapsed	= fElapsed;
+	m_vPendingObjectPos	= vObjectPos;
+
+	if(m_pFxMgr->QueueParallelUpdate(this, m_nParallelUpdateIndex))
+	{
+		m_bParallelUpdatePending = true;
+		return;
+	}
+
+	LTVector vMin, vMax;
+	StepSamples(fElapsed, vObjectPos, vMin, vMax);
+	UpdateVisibility(vMin, vMax, vObjectPos);
+}
+
+//ages the samples, frees the expired ones, and determines the extents of the remaining samples.
+//This only touches the samples of this trail and so can be called from any thread
+void CPolyTrailFX::StepSamples(float fElapsed, const LTVector& vObjectPos, LTVector& vMin, LTVector& vMax)
+{
+	vMin = vObjectPos;
+	vMax = vObjectPos;
 	bool bFirstPt = true;
 
 	//start at the head and work our way to the tail
@@ -360,7 +395,11 @@ void CPolyTrailFX::UpdateSamples(float fElapsed, const LTVector& vObjectPos)
 		//and finally move onto the next node
 		pCurrSample = pCurrSample->m_pNextSample;
 	}
+}
 
+//given the extents of the samples, this will update the visibility box of our object
+void CPolyTrailFX::UpdateVisibility(LTVector vMin, LTVector vMax, const LTVector& vObjectPos)
+{
 	//expand the visibility box if we are a single node by the single node width
 	if(m_nNumTrackedNodes == 1)
 	{
@@ -374,6 +413,31 @@ void CPolyTrailFX::UpdateSamples(float fElapsed, const LTVector& vObjectPos)
 	g_pLTClient->GetCustomRender()->SetVisBoundingBox(m_hObject, vMin - vObjectPos, vMax - vObjectPos);
 }
 
+//called to make sure that a sample update that was queued with the effect manager has been performed
+void CPolyTrailFX::FinishParallelUpdate()
+{
+	if(!m_bParallelUpdatePending)
+		return;
+
+	//take the update back from the manager and just perform it now
+	m_pFxMgr->CancelParallelUpdate(this, m_nParallelUpdateIndex);
+	ParallelUpdate();
+	CommitParallelUpdate();
+}
+
+//called by the effect manager to perform the queued sample update, potentially on a worker thread
+void CPolyTrailFX::ParallelUpdate()
+{
+	StepSamples(m_fPendingElapsed, m_vPendingObjectPos, m_vPendingMin, m_vPendingMax);
+}
+
+//called by the effect manager on the main thread once the queued sample update has been performed
+void CPolyTrailFX::CommitParallelUpdate()
+{
+	m_bParallelUpdatePending = false;
+	UpdateVisibility(m_vPendingMin, m_vPendingMax, m_vPendingObjectPos);
+}
+
 //utility function that calculates the distance between the head sample and the next sample
 //for the node that is selected to be the node used for distance tracking
 float CPolyTrailFX::CalcHeadSegmentDistance() const
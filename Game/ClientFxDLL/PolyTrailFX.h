@@ -70,7 +70,8 @@ public:
 // CPolyTrailFX
 //--------------------------------------------------------------------------------
 class CPolyTrailFX : 
-	public CBaseFX
+	public CBaseFX,
+	public IClientFXParallelUpdate
 {
 public:
 
@@ -97,9 +98,24 @@ private:
 	//sample list
 	void	UpdateCurrentSamplePositions(const LTVector& vObjectPos);
 
-	//called to update the current samples that we have and also the visibility for this object
+	//called to update the current samples that we have and also the visibility for this object. This
+	//may be queued with the effect manager to be run on the worker threads after all effects have
+	//been updated
 	void	UpdateSamples(float fElapsed, const LTVector& vObjectPos);
 
+	//ages the samples, frees the expired ones, and determines the extents of the remaining samples
+	void	StepSamples(float fElapsed, const LTVector& vObjectPos, LTVector& vMin, LTVector& vMax);
+
+	//updates the visibility box of our object given the extents of the samples
+	void	UpdateVisibility(LTVector vMin, LTVector vMax, const LTVector& vObjectPos);
+
+	//called to make sure that any queued sample update has been performed
+	void	FinishParallelUpdate();
+
+	//IClientFXParallelUpdate implementation
+	virtual void	ParallelUpdate();
+	virtual void	CommitParallelUpdate();
+
 	//utility function that calculates the distance between the head sample and the next sample
 	//for the node that is selected to be the node used for distance tracking
 	float	CalcHeadSegmentDistance() const;
@@ -194,6 +210,17 @@ private:
 
 	//the total amount of time that this effect has been around
 	float			m_fTotalElapsed;
+
+	//the sample update that has been queued with the effect manager, if any, and its index in
+	//the manager's queue
+	bool			m_bParallelUpdatePending;
+	uint32			m_nParallelUpdateIndex;
+	float			m_fPendingElapsed;
+	LTVector		m_vPendingObjectPos;
+
+	//the extents of the samples once the queued update has been performed
+	LTVector		m_vPendingMin;
+	LTVector		m_vPendingMax;
 };
 
 #endif
\ No newline at end of file
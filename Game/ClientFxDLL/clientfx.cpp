@@ -14,6 +14,7 @@
 #include "ClientFX.h"
 #include "SurfaceDefs.h"
 #include "ClientFXVertexDeclMgr.h"
+#include "MemoryPageMgr.h"
 #include "memblockallocator.h"
 
 // Dummy variable for ensuring proper external linkage.
@@ -298,6 +299,21 @@ __declspec(dllexport) void fxTermDLLRuntime()
 	g_ClientFXVertexDecl.Term();
 }
 
+//------------------------------------------------------------------
+//
+//   FUNCTION : fxSetParallelUpdate()
+//
+//   PURPOSE  : Called before and after the game runs the work queued
+//				by effects on the worker threads
+//
+//------------------------------------------------------------------
+
+__declspec(dllexport) void fxSetParallelUpdate(bool bParallelUpdate)
+{
+	//particle steps on the worker threads can free memory pages
+	CMemoryPageMgr::SetThreadSafe(bParallelUpdate);
+}
+
 //------------------------------------------------------------------
 //
 //   FUNCTION : fxGetNum()
@@ -608,6 +624,7 @@ bool CreateNewFX(IClientFXMgr* pFxMgr, const char* pszEffectName,
 
 	//copy the other creation information, so we can fill in the name of the effect
 	CLIENTFX_CREATESTRUCT OurCreateInfo = CreateInfo;
+	OurCreateInfo.m_hGroup = INVALID_FX_GROUP;
 
 	//the current character offset
 	uint32 nDestOffset = 0;
@@ -19,11 +19,13 @@
 #include "iltdrawprim.h"
 #include "ClientFXMgr.h"
 #include "PlayerMgr.h"
+#include "PlayerCamera.h"
 #include "CMoveMgr.h"
 #include "WinUtil.h"
 #include "ClientFXDB.h"
 #include "iperformancemonitor.h"
 #include "SpecialFXNotifyMessageHandler.h"
+#include "lttimeutils.h"
 
 
 //for std::sort
@@ -36,14 +38,28 @@ static CTimedSystem g_tsClientFXUpdateCreate("ClientFX_Update_Create", "ClientFX
 static CTimedSystem g_tsClientFXUpdateOverlay("ClientFX_Update_Overlay", "ClientFX_Update");
 static CTimedSystem g_tsClientFXUpdateCamera("ClientFX_Update_Camera", "ClientFX_Update");
 static CTimedSystem g_tsClientFXUpdateController("ClientFX_Update_Controller", "ClientFX_Update");
+static CTimedSystem g_tsClientFXUpdateParallel("ClientFX_Update_Parallel", "ClientFX_Update");
+
+//the number of queued parallel updates that are handed to a worker at a time
+static const uint32 knParallelUpdatesPerJob = 4;
 
 // Globals....
 typedef CBankedList<CClientFXInstance> ClientFXBank;
 ClientFXBank* g_pCLIENTFX_INSTANCE_Bank = NULL;
 
+//the number of effect managers sharing the instance bank
+static uint32 g_nNumClientFXMgrs = 0;
+
 //the detail level of the client FX (0 = low, 1 = med, 2 = high)
 VarTrack	g_vtClientFXDetailLevel;
 
+//whether or not effects can move work onto the worker threads. This is off by default
+//until the results of the parallel update have been checked against the serial one.
+VarTrack	g_vtClientFXParallelUpdate;
+
+//whether or not effects should be updated at all
+extern VarTrack g_vtUpdateClientFX;
+
 //------------------------------------------------------------------
 //
 //   FUNCTION : CClientFXMgr()
@@ -57,6 +73,10 @@ CClientFXMgr::CClientFXMgr()
 	m_bGoreEnabled		= true;
 	m_bInSlowMotion		= false;
 	m_hCamera			= NULL;
+	m_bQueueParallelUpdates = false;
+	m_nNumParallelUpdatesRun = 0;
+
+	g_nNumClientFXMgrs++;
 
 	if( !g_pCLIENTFX_INSTANCE_Bank )
 	{
@@ -78,9 +98,12 @@ CClientFXMgr::~CClientFXMgr()
 
 	Term();
 
+	g_nNumClientFXMgrs--;
+
 	// Check if we have the bank initialized, which it must be
-	// since it was created in the constructor.
-	if( g_pCLIENTFX_INSTANCE_Bank )
+	// since it was created in the constructor.  Other managers
+	// may still be using it, such as while the benchmark runs.
+	if( g_pCLIENTFX_INSTANCE_Bank && ( g_nNumClientFXMgrs == 0 ))
 	{
 		// Check if it's now empty, which means we can delete it.
 		if( !g_pCLIENTFX_INSTANCE_Bank->GetSize( ))
@@ -107,6 +130,9 @@ bool CClientFXMgr::Init(ILTClient *pClientDE, EngineTimer& timer )
 	if(!g_vtClientFXDetailLevel.IsInitted())
 		g_vtClientFXDetailLevel.Init(pClientDE, "ClientFXDetailLevel", NULL, 2.0f);
 
+	if(!g_vtClientFXParallelUpdate.IsInitted())
+		g_vtClientFXParallelUpdate.Init(pClientDE, "ClientFXParallelUpdate", NULL, 0.0f);
+
 	// This is the timer we will use with all calculations.  Since
 	// there can be multiple clientfxmgr's, we take it from our "mgr".
 	m_Timer = timer;
@@ -166,15 +192,27 @@ void CClientFXMgr::SetCamera(HOBJECT hCamera)
 //------------------------------------------------------------------
 
 CBaseFX* CClientFXMgr::CreateFX(const char *sName, FX_BASEDATA *pBaseData, CBaseFXProps* pProps)
+{
+	// Locate the named FX
+
+	return CreateFX(CClientFXDB::GetSingleton().FindFX(sName), pBaseData, pProps);
+}
+
+//------------------------------------------------------------------
+//
+//   FUNCTION : CreateFX()
+//
+//   PURPOSE  : Creates an FX of the specified type
+//
+//------------------------------------------------------------------
+
+CBaseFX* CClientFXMgr::CreateFX(const FX_REF* pFxRef, FX_BASEDATA *pBaseData, CBaseFXProps* pProps)
 {
 	//track our performance
 	CTimedSystemBlock TimingBlock(g_tsClientFXUpdateCreate);
 
 	CBaseFX *pNewFX = NULL;
 
-	// Locate the named FX
-
-	const FX_REF *pFxRef = CClientFXDB::GetSingleton().FindFX(sName);
 	if( pFxRef ) 
 	{
 		pNewFX = pFxRef->m_pfnCreate();
@@ -255,8 +293,19 @@ bool CClientFXMgr::UpdateAllActiveFX()
 
 	//Update our frame time, before any early outs so there aren't giant pops when the early
 	//out fails
-	float fFrameTime = m_Timer.GetTimerElapsedS();
+	return UpdateActiveFX(m_Timer.GetTimerElapsedS());
+}
 
+//------------------------------------------------------------------
+//
+//   FUNCTION : UpdateActiveFX()
+//
+//   PURPOSE  : Updates all the active FX by the provided frame time
+//
+//------------------------------------------------------------------
+
+bool CClientFXMgr::UpdateActiveFX(float fFrameTime)
+{
 	//add in all the effects from our next update list and clear that out
 	LTListIter<CClientFXInstance*> itFXInstance = m_NextUpdateFXList.Begin();
 	while(itFXInstance != m_NextUpdateFXList.End())
@@ -268,14 +317,8 @@ bool CClientFXMgr::UpdateAllActiveFX()
 		m_FXInstanceList.AddTail(&pFXInstance->m_FXListLink);
 	}
 
-	HCONSOLEVAR hVar = m_pClientDE->GetConsoleVariable("UpdateClientFX");
-	if (hVar)
-	{
-		float fVal = m_pClientDE->GetConsoleVariableFloat(hVar);
-
-		if (!fVal) 
-			return true;
-	}
+	if(g_vtUpdateClientFX.GetFloat() == 0.0f)
+		return true;
 
 	//see if we should even update
 	if( g_pGameClientShell->IsServerPaused( ))
@@ -284,6 +327,10 @@ bool CClientFXMgr::UpdateAllActiveFX()
 		return true;
 	}
 
+	//allow effects to queue work for the worker threads while they are updated
+	m_bQueueParallelUpdates = (g_vtClientFXParallelUpdate.GetFloat() != 0.0f) &&
+							  (g_pGameClientShell->GetJobSystem()->GetNumWorkers() > 0);
+
 	//
 	// Update the group Instances
 	//
@@ -352,10 +399,62 @@ bool CClientFXMgr::UpdateAllActiveFX()
 		}
 	}
 
+	//now run any work that the effects queued up during their update
+	m_bQueueParallelUpdates = false;
+	RunParallelUpdates();
+
 	// Success !!
 	return true;
 }	
 
+//job system entry point for running a range of the queued parallel updates
+static void ParallelUpdateJob(void* pData, uint32 nBegin, uint32 nEnd)
+{
+	IClientFXParallelUpdate** ppUpdates = (IClientFXParallelUpdate**)pData;
+	for(uint32 nCurrUpdate = nBegin; nCurrUpdate < nEnd; nCurrUpdate++)
+	{
+		if(ppUpdates[nCurrUpdate])
+			ppUpdates[nCurrUpdate]->ParallelUpdate();
+	}
+}
+
+//------------------------------------------------------------------
+//
+//   FUNCTION : RunParallelUpdates()
+//
+//   PURPOSE  : Runs the work queued by effects across the worker
+//				threads and commits the results
+//
+//------------------------------------------------------------------
+
+void CClientFXMgr::RunParallelUpdates()
+{
+	if(m_ParallelUpdates.empty())
+		return;
+
+	//track our performance
+	CTimedSystemBlock TimingBlock(g_tsClientFXUpdateParallel);
+
+	//each queued update only touches the data of the effect that queued it, so they can be
+	//split up across the workers in any way
+	CLTJobSystem* pJobSystem = g_pGameClientShell->GetJobSystem();
+	CClientFXDB::GetSingleton().SetParallelUpdate(true);
+	pJobSystem->ParallelFor((uint32)m_ParallelUpdates.size(), knParallelUpdatesPerJob, ParallelUpdateJob, &m_ParallelUpdates[0], "ClientFXParallelUpdate");
+	CClientFXDB::GetSingleton().SetParallelUpdate(false);
+
+	m_nNumParallelUpdatesRun += (uint32)m_ParallelUpdates.size();
+
+	//and now hand the results over to the engine on this thread, always in the order the
+	//work was queued so that the results do not depend upon how the work was scheduled
+	for(uint32 nCurrUpdate = 0; nCurrUpdate < m_ParallelUpdates.size(); nCurrUpdate++)
+	{
+		if(m_ParallelUpdates[nCurrUpdate])
+			m_ParallelUpdates[nCurrUpdate]->CommitParallelUpdate();
+	}
+
+	m_ParallelUpdates.clear();
+}
+
 //called to determine for the provided camera transform, what the relative transform and scales
 //for the field of view should be applied given the current state of the active effects
 void CClientFXMgr::GetCameraModifier(	const LTRigidTransform& tCameraTrans,
@@ -621,7 +720,13 @@ bool CClientFXMgr::StartClientFX(CClientFXInstance* pInstance, const CLIENTFX_CR
 	if(!pInstance)
 		return false;
 
-	const FX_GROUP *pRef = CClientFXDB::GetSingleton().FindGroupFX(fxInit.m_sName);
+	//use the handle if the caller resolved one, otherwise fall back to looking up the name
+	const FX_GROUP *pRef = NULL;
+	if(fxInit.m_hGroup != INVALID_FX_GROUP)
+		pRef = CClientFXDB::GetSingleton().GetGroupFX(fxInit.m_hGroup);
+	else
+		pRef = CClientFXDB::GetSingleton().FindGroupFX(fxInit.m_sName);
+
 	if (!pRef) 
 		return false;
 
@@ -697,7 +802,7 @@ bool CClientFXMgr::CreateFXKey(const CLIENTFX_CREATESTRUCT &fxInit, CClientFXIns
 	fxData.m_dwFlags			= fxInit.m_dwFlags;
 
 	// Create the FX
-	CBaseFX *pNewFX = CreateFX(pKey->m_pFxRef->m_sName, &fxData, pKey->m_pProps);
+	CBaseFX *pNewFX = CreateFX(pKey->m_pFxRef, &fxData, pKey->m_pProps);
 	if( pNewFX )
 	{
 		pNewFX->SetVisible(false);
@@ -922,6 +1027,11 @@ bool CClientFXMgr::CreateEffect(const CLIENTFX_CREATESTRUCT& cs, bool bStartInst
 	return CreateClientFX(NULL, cs, bStartInst, true);
 }
 
+HFXGROUP CClientFXMgr::ResolveEffect(const char* pszEffectName)
+{
+	return CClientFXDB::GetSingleton().ResolveGroupFX(pszEffectName);
+}
+
 // System Subscription
 void CClientFXMgr::SubscribeOverlay(LTLink<IClientFXOverlay*>& Link)
 {
@@ -938,6 +1048,27 @@ void CClientFXMgr::SubscribeCamera(LTLink<IClientFXCamera*>& Link)
 	m_CameraList.AddHead(&Link);
 }
 
+// Parallel Update
+bool CClientFXMgr::QueueParallelUpdate(IClientFXParallelUpdate* pUpdate, uint32& nQueueIndex)
+{
+	//work can only be queued while we are updating the effects
+	if(!m_bQueueParallelUpdates)
+		return false;
+
+	nQueueIndex = (uint32)m_ParallelUpdates.size();
+	m_ParallelUpdates.push_back(pUpdate);
+	return true;
+}
+
+void CClientFXMgr::CancelParallelUpdate(IClientFXParallelUpdate* pUpdate, uint32 nQueueIndex)
+{
+	LTASSERT((nQueueIndex < m_ParallelUpdates.size()) && (m_ParallelUpdates[nQueueIndex] == pUpdate), "Error: Cancelled parallel update that was not queued");
+
+	//clear the entry rather than removing it so that the list is never reordered
+	if(nQueueIndex < m_ParallelUpdates.size())
+		m_ParallelUpdates[nQueueIndex] = NULL;
+}
+
 //these functions are intended only for development support of reloading of effects mid-game
 //and therefore are not included in final builds. The calling of these should be to release
 //the effect database, which will shut down all of the effects, clear out the database, load in
@@ -1008,4 +1139,124 @@ bool CClientFXMgr::RestartEffects()
 	return true;
 }
 
+//counts the effect instances and keys that a manager is currently updating
+static void CountBenchmarkFX(LTList<CClientFXInstance*>& InstanceList, uint32& nNumInstances, uint32& nNumKeys)
+{
+	nNumInstances	= 0;
+	nNumKeys		= 0;
+
+	LTListIter<CClientFXInstance*> itFXInstance = InstanceList.Begin();
+	while(itFXInstance != InstanceList.End())
+	{
+		CClientFXInstance* pFXInstance = *itFXInstance;
+		itFXInstance++;
+
+		nNumInstances++;
+		for(LTListIter<CBaseFX*> itActiveFX = pFXInstance->m_ActiveFXList.Begin(); itActiveFX != pFXInstance->m_ActiveFXList.End(); itActiveFX++)
+		{
+			nNumKeys++;
+		}
+	}
+}
+
+//------------------------------------------------------------------
+//
+//   FUNCTION : RunBenchmark()
+//
+//   PURPOSE  : Creates the named effect at a steady rate over a run
+//				of fixed length frames in a manager of its own, and
+//				times the update with and without the parallel update
+//
+//------------------------------------------------------------------
+
+void CClientFXMgr::RunBenchmark(const char* pszEffect, uint32 nNumEffects, uint32 nNumFrames)
+{
+	if(!CClientFXDB::GetSingleton().FindGroupFX(pszEffect))
+	{
+		g_pLTClient->CPrint("ClientFXBenchmark: unknown effect %s", pszEffect);
+		return;
+	}
+
+	if(g_pGameClientShell->IsServerPaused())
+	{
+		g_pLTClient->CPrint("ClientFXBenchmark: effects are not updated while the server is paused");
+		return;
+	}
+
+	if(nNumEffects == 0)
+		nNumEffects = 5000;
+	if(nNumFrames == 0)
+		nNumFrames = 300;
+
+	//every pass creates the same effects at the same times and positions, spread over the frames
+	//like the impacts of a large firefight
+	static const float kfFrameTime = 1.0f / 30.0f;
+	static const uint32 knGridSize = 64;
+	static const float kfGridSpacing = 64.0f;
+	uint32 nEffectsPerFrame = (nNumEffects + nNumFrames - 1) / nNumFrames;
+
+	uint32 nNumWorkers = g_pGameClientShell->GetJobSystem()->GetNumWorkers();
+	float fOldParallelUpdate = g_vtClientFXParallelUpdate.GetFloat();
+
+	uint32 nFailures = 0;
+	for(uint32 nPass = 0; nPass < 2; nPass++)
+	{
+		bool bParallel = (nPass == 1);
+		g_vtClientFXParallelUpdate.SetFloat(bParallel ? 1.0f : 0.0f);
+
+		CClientFXMgr BenchmarkMgr;
+		BenchmarkMgr.Init(g_pLTClient, SimulationTimer::Instance());
+		BenchmarkMgr.SetCamera(g_pPlayerMgr->GetPlayerCamera()->GetCamera());
+
+		uint32 nNumCreated		= 0;
+		uint32 nMaxInstances	= 0;
+		uint32 nMaxKeys			= 0;
+		double fUpdateMS		= 0.0;
+		double fMaxFrameMS		= 0.0;
+
+		//run until every effect has been created, and then let them finish, up to twice the frames
+		for(uint32 nFrame = 0; nFrame < nNumFrames * 2; nFrame++)
+		{
+			for(uint32 nCreate = 0; (nCreate < nEffectsPerFrame) && (nNumCreated < nNumEffects); nCreate++, nNumCreated++)
+			{
+				LTVector vPos((float)(nNumCreated % knGridSize) * kfGridSpacing, 0.0f, (float)((nNumCreated / knGridSize) % knGridSize) * kfGridSpacing);
+				CLIENTFX_CREATESTRUCT fxInit(pszEffect, 0, LTRigidTransform(vPos, LTRotation::GetIdentity()));
+				BenchmarkMgr.CreateClientFX(NULL, fxInit, true);
+			}
+
+			TLTPrecisionTime StartTime = LTTimeUtils::GetPrecisionTime();
+			BenchmarkMgr.UpdateActiveFX(kfFrameTime);
+			double fFrameMS = LTTimeUtils::GetPrecisionTimeIntervalMS(StartTime, LTTimeUtils::GetPrecisionTime());
+
+			fUpdateMS += fFrameMS;
+			fMaxFrameMS = LTMAX(fMaxFrameMS, fFrameMS);
+
+			//everything queued during the update must have been run and committed
+			if(!BenchmarkMgr.m_ParallelUpdates.empty())
+				nFailures++;
+
+			uint32 nNumInstances, nNumKeys;
+			CountBenchmarkFX(BenchmarkMgr.m_FXInstanceList, nNumInstances, nNumKeys);
+			nMaxInstances	= LTMAX(nMaxInstances, nNumInstances);
+			nMaxKeys		= LTMAX(nMaxKeys, nNumKeys);
+
+			if((nNumCreated == nNumEffects) && (nNumInstances == 0) && BenchmarkMgr.m_NextUpdateFXList.IsEmpty())
+				break;
+		}
+
+		//with workers, the parallel pass must have moved work onto them, and the serial pass must not
+		if((bParallel && (nNumWorkers > 0)) != (BenchmarkMgr.m_nNumParallelUpdatesRun > 0))
+			nFailures++;
+
+		g_pLTClient->CPrint("ClientFXBenchmark: %s, %u effects, up to %u instances and %u keys: %.3f ms updating, %.3f ms longest frame, %u updates on %u workers",
+			bParallel ? "parallel" : "serial", nNumCreated, nMaxInstances, nMaxKeys, fUpdateMS, fMaxFrameMS, BenchmarkMgr.m_nNumParallelUpdatesRun, nNumWorkers);
+
+		BenchmarkMgr.Term();
+	}
+
+	g_vtClientFXParallelUpdate.SetFloat(fOldParallelUpdate);
+
+	g_pLTClient->CPrint("ClientFXBenchmark: %u failures - %s", nFailures, (nFailures == 0) ? "PASSED" : "FAILED");
+}
+
 #endif
\ No newline at end of file
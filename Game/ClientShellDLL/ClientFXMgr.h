@@ -83,6 +83,11 @@ public :
 #ifndef _FINAL
 	void	ReleaseEffectDatabase();
 	bool	RestartEffects();
+
+	//creates the named effect thousands of times over a run of fixed length frames, and times the
+	//update of the effects with and without the parallel update. This is used by the ClientFXBenchmark
+	//console program
+	static void	RunBenchmark(const char* pszEffect, uint32 nNumEffects, uint32 nNumFrames);
 #endif
 
 private :
@@ -94,12 +99,24 @@ private :
 
 	// Effect creation
 	virtual bool	CreateEffect(const CLIENTFX_CREATESTRUCT& cs, bool bStartInst);
+	virtual HFXGROUP	ResolveEffect(const char* pszEffectName);
 
 	// System Subscription
 	virtual void	SubscribeOverlay(LTLink<IClientFXOverlay*>& Link);
 	virtual void	SubscribeController(LTLink<IClientFXController*>& Link);
 	virtual void	SubscribeCamera(LTLink<IClientFXCamera*>& Link);
 
+	// Parallel Update
+	virtual bool	QueueParallelUpdate(IClientFXParallelUpdate* pUpdate, uint32& nQueueIndex);
+	virtual void	CancelParallelUpdate(IClientFXParallelUpdate* pUpdate, uint32 nQueueIndex);
+
+	//called to update all of the effects by the provided amount of time
+	bool			UpdateActiveFX(float fFrameTime);
+
+	//called to run the work queued by effects during the update across the worker threads, and
+	//then commit the results in the order they were queued
+	void			RunParallelUpdates();
+
 	//called to delete a ClientFXInstance
 	void			DeleteClientFXInstance(CClientFXInstance* pInstance);
 
@@ -128,6 +145,7 @@ private :
 	bool							StartClientFX(	CClientFXInstance* pInstance, const CLIENTFX_CREATESTRUCT &fxInit);
 
 	CBaseFX*						CreateFX(const char *sName, FX_BASEDATA *pBaseData, CBaseFXProps* pProps);
+	CBaseFX*						CreateFX(const FX_REF* pFxRef, FX_BASEDATA *pBaseData, CBaseFXProps* pProps);
 
 	// Member Variables
 
@@ -148,6 +166,17 @@ private :
 	//(this is for effects that are created in mid-update)
 	LTList<CClientFXInstance*>		m_NextUpdateFXList;
 
+	//work queued by effects during the current update to be run on the worker threads. Entries
+	//are set to NULL when their work is cancelled
+	typedef std::vector<IClientFXParallelUpdate*, LTAllocator<IClientFXParallelUpdate*, LT_MEM_TYPE_CLIENTFX> > TParallelUpdateList;
+	TParallelUpdateList				m_ParallelUpdates;
+
+	//whether or not effects are currently allowed to queue parallel work
+	bool							m_bQueueParallelUpdates;
+
+	//the total number of updates that have been run on the worker threads
+	uint32							m_nNumParallelUpdatesRun;
+
 	//the paused status
 	bool							m_bPaused;
 
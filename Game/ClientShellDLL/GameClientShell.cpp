@@ -78,12 +78,15 @@
 #include "GameRenderLayers.h"
 #include "AnimationPropStrings.h"
 #include "lttimeutils.h"
+#include "ltthreadutils.h"
+#include "ltinterlockedoperations.h"
 #include "PhysicsUtilities.h"
 #include "PerformanceMgr.h"
 #include "SpecialFXNotifyMessageHandler.h"
 #include "LadderMgr.h"
 #include "LadderFX.h"
 #include "ClientVoteMgr.h"
+#include "PolyGridFX.h"
 
 #if !defined(PLATFORM_XENON)
 #include "IGameSpy.h"
@@ -516,6 +519,608 @@ void AIDebugFn( int argc, char **argv )
 #endif// _FINAL
 }
 
+#ifndef _FINAL
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	JobSystemTestFn
+//
+//	PURPOSE:	Checks the job system's counters, dependencies, parallel for
+//			and nested waits, then times a fixed workload across every
+//			worker count to show how the job system scales on this machine.
+//
+// ----------------------------------------------------------------------- //
+
+// Data shared by the job system test jobs
+struct SJobSystemTestData
+{
+	CLTJobSystem*	m_pJobSystem;
+	CLTJobCounter*	m_pDependency;
+	uint32			m_nJobsRun;
+	uint32			m_nDependencyErrors;
+	uint32			m_aVisits[4096];
+	float			m_aResults[4096];
+};
+
+static void JobSystemTestCountJob(void* pData)
+{
+	SJobSystemTestData* pTest = (SJobSystemTestData*)pData;
+	LTInterlockedOperations::InterlockedIncrement(&pTest->m_nJobsRun);
+}
+
+static void JobSystemTestDependentJob(void* pData)
+{
+	SJobSystemTestData* pTest = (SJobSystemTestData*)pData;
+	// Dependent jobs must never start before the jobs they depend on have finished
+	if (!pTest->m_pDependency->IsDone())
+		LTInterlockedOperations::InterlockedIncrement(&pTest->m_nDependencyErrors);
+	LTInterlockedOperations::InterlockedIncrement(&pTest->m_nJobsRun);
+}
+
+static void JobSystemTestVisitRange(void* pData, uint32 nBegin, uint32 nEnd)
+{
+	SJobSystemTestData* pTest = (SJobSystemTestData*)pData;
+	for (uint32 nIndex = nBegin; nIndex < nEnd; ++nIndex)
+		LTInterlockedOperations::InterlockedIncrement(&pTest->m_aVisits[nIndex]);
+}
+
+static void JobSystemTestNestedJob(void* pData)
+{
+	SJobSystemTestData* pTest = (SJobSystemTestData*)pData;
+	// Waiting from inside a job has to help out rather than deadlock
+	pTest->m_pJobSystem->ParallelFor(LTARRAYSIZE(pTest->m_aVisits), 64, JobSystemTestVisitRange, pTest, "JobSystemTestNested");
+}
+
+static void JobSystemTestWorkRange(void* pData, uint32 nBegin, uint32 nEnd)
+{
+	SJobSystemTestData* pTest = (SJobSystemTestData*)pData;
+	for (uint32 nIndex = nBegin; nIndex < nEnd; ++nIndex)
+	{
+		float fValue = (float)nIndex;
+		for (uint32 nStep = 0; nStep < 2000; ++nStep)
+			fValue = sqrtf(fValue * 1.0001f + 1.0f);
+		pTest->m_aResults[nIndex] = fValue;
+	}
+}
+
+static bool JobSystemTestCheckVisits(SJobSystemTestData& Test, uint32 nExpected)
+{
+	for (uint32 nIndex = 0; nIndex < LTARRAYSIZE(Test.m_aVisits); ++nIndex)
+	{
+		if (Test.m_aVisits[nIndex] != nExpected)
+			return false;
+	}
+	return true;
+}
+
+static bool JobSystemTestCorrectness(CLTJobSystem& JobSystem)
+{
+	SJobSystemTestData* pTest = debug_new(SJobSystemTestData);
+	memset(pTest, 0, sizeof(*pTest));
+	pTest->m_pJobSystem = &JobSystem;
+
+	bool bPassed = true;
+	const uint32 knNumJobs = 1000;
+
+	// Counters
+	{
+		CLTJobCounter Counter;
+		for (uint32 nJob = 0; nJob < knNumJobs; ++nJob)
+			JobSystem.AddJob(JobSystemTestCountJob, pTest, &Counter, "JobSystemTestCount");
+		JobSystem.WaitForCounter(Counter);
+		if (pTest->m_nJobsRun != knNumJobs)
+		{
+			g_pLTClient->CPrint("  Counter: FAILED, %d of %d jobs run", pTest->m_nJobsRun, knNumJobs);
+			bPassed = false;
+		}
+	}
+
+	// Dependencies
+	{
+		pTest->m_nJobsRun = 0;
+		CLTJobCounter Dependency;
+		CLTJobCounter Counter;
+		pTest->m_pDependency = &Dependency;
+		for (uint32 nJob = 0; nJob < knNumJobs; ++nJob)
+			JobSystem.AddJob(JobSystemTestCountJob, pTest, &Dependency, "JobSystemTestCount");
+		for (uint32 nJob = 0; nJob < knNumJobs; ++nJob)
+			JobSystem.AddDependentJob(Dependency, JobSystemTestDependentJob, pTest, &Counter, "JobSystemTestDependent");
+		JobSystem.WaitForCounter(Counter);
+		if ((pTest->m_nJobsRun != knNumJobs * 2) || (pTest->m_nDependencyErrors != 0))
+		{
+			g_pLTClient->CPrint("  Dependencies: FAILED, %d jobs run, %d started early", pTest->m_nJobsRun, pTest->m_nDependencyErrors);
+			bPassed = false;
+		}
+	}
+
+	// Parallel for covers every index exactly once
+	JobSystem.ParallelFor(LTARRAYSIZE(pTest->m_aVisits), 37, JobSystemTestVisitRange, pTest, "JobSystemTestVisit");
+	if (!JobSystemTestCheckVisits(*pTest, 1))
+	{
+		g_pLTClient->CPrint("  ParallelFor: FAILED");
+		bPassed = false;
+	}
+
+	// Nested waits from within jobs
+	{
+		CLTJobCounter Counter;
+		for (uint32 nJob = 0; nJob < 8; ++nJob)
+			JobSystem.AddJob(JobSystemTestNestedJob, pTest, &Counter, "JobSystemTestNested");
+		JobSystem.WaitForCounter(Counter);
+		if (!JobSystemTestCheckVisits(*pTest, 9))
+		{
+			g_pLTClient->CPrint("  Nested wait: FAILED");
+			bPassed = false;
+		}
+	}
+
+	debug_delete(pTest);
+	return bPassed;
+}
+
+void JobSystemTestFn(int argc, char **argv)
+{
+	// Correctness checks on the shared job system and on one without workers
+	CLTJobSystem* pJobSystem = g_pGameClientShell->GetJobSystem();
+	g_pLTClient->CPrint("JobSystemTest: %d workers", pJobSystem->GetNumWorkers());
+	bool bPassed = JobSystemTestCorrectness(*pJobSystem);
+	{
+		// A job system that hasn't been started runs everything on the calling thread
+		CLTJobSystem SerialJobSystem;
+		bPassed = JobSystemTestCorrectness(SerialJobSystem) && bPassed;
+	}
+	g_pLTClient->CPrint("JobSystemTest: %s", bPassed ? "passed" : "FAILED");
+
+	// Scaling benchmark
+	uint32 nMaxWorkers = LTThreadUtils::GetProcessorCount();
+	if (argc > 0)
+		nMaxWorkers = (uint32)atoi(argv[0]);
+
+	SJobSystemTestData* pTest = debug_new(SJobSystemTestData);
+	double fSerialMS = 0.0;
+	for (uint32 nNumWorkers = 0; nNumWorkers <= nMaxWorkers; ++nNumWorkers)
+	{
+		// Zero would ask for a worker per processor, so leave it unstarted to run serially
+		CLTJobSystem BenchJobSystem;
+		if (nNumWorkers > 0)
+			BenchJobSystem.Init(nNumWorkers);
+
+		// Best of a few runs, to keep thread start up and other processes out of the result
+		double fBestMS = 0.0;
+		for (uint32 nRun = 0; nRun < 5; ++nRun)
+		{
+			TLTPrecisionTime StartTime = LTTimeUtils::GetPrecisionTime();
+			BenchJobSystem.ParallelFor(LTARRAYSIZE(pTest->m_aResults), 64, JobSystemTestWorkRange, pTest, "JobSystemTestWork");
+			double fRunMS = LTTimeUtils::GetPrecisionTimeIntervalMS(StartTime, LTTimeUtils::GetPrecisionTime());
+			if ((nRun == 0) || (fRunMS < fBestMS))
+				fBestMS = fRunMS;
+		}
+		if (nNumWorkers == 0)
+			fSerialMS = fBestMS;
+
+		g_pLTClient->CPrint("  %2d workers: %8.3f ms, %5.2fx", nNumWorkers, fBestMS, (fBestMS > 0.0) ? fSerialMS / fBestMS : 0.0);
+	}
+	debug_delete(pTest);
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	SFXListTestFn
+//
+//	PURPOSE:	Drives a CSpecialFXList with special fx that have no
+//			renderer side, through random adds, removes, WantRemove calls
+//			and update passes that also remove other fx the way an update
+//			can, and checks the server object index and the
+//			packed array against a brute force scan of the slots after
+//			every step.
+//
+// ----------------------------------------------------------------------- //
+
+// Special fx that only tracks how often it was updated
+class CSFXListTestFX : public CSpecialFX
+{
+public:
+
+	CSFXListTestFX(HOBJECT hServerObj)
+	{
+		m_hServerObject = hServerObj;
+		m_nUpdates = 0;
+		m_bDone = false;
+	}
+
+	virtual bool Update()
+	{
+		++m_nUpdates;
+		return !m_bDone;
+	}
+
+	uint32	m_nUpdates;
+	bool	m_bDone;
+};
+
+static bool SFXListTestCheck(CSpecialFXList& List, const HOBJECT* pObjects, uint32 nNumObjects, uint32 nExpected)
+{
+	bool bPassed = true;
+	unsigned int nSize = List.GetSize();
+
+	// The packed array must hold exactly the fx in the slots
+	uint32 nInSlots = 0;
+	for (unsigned int nSlot = 0; nSlot < nSize; ++nSlot)
+	{
+		if (List[nSlot])
+			++nInSlots;
+	}
+	if (nInSlots != nExpected || (uint32)List.GetNumItems() != nExpected)
+		bPassed = false;
+
+	for (unsigned int nDense = 0; nDense < (unsigned int)List.GetNumItems(); ++nDense)
+	{
+		unsigned int nSlot = List.GetDenseSlot(nDense);
+		if (nSlot >= nSize || !List.GetDense(nDense) || List[nSlot] != List.GetDense(nDense))
+			bPassed = false;
+	}
+
+	// The index must find the same fx as a scan of the slots, including for
+	// fx with no server object
+	for (uint32 nObject = 0; nObject <= nNumObjects; ++nObject)
+	{
+		HOBJECT hObj = (nObject < nNumObjects) ? pObjects[nObject] : NULL;
+
+		CSpecialFX* pScanned = NULL;
+		for (unsigned int nSlot = 0; nSlot < nSize && !pScanned; ++nSlot)
+		{
+			if (List[nSlot] && List[nSlot]->GetServerObj() == hObj)
+				pScanned = List[nSlot];
+		}
+
+		if (List.FindByServerObj(hObj) != pScanned)
+			bPassed = false;
+	}
+
+	return bPassed;
+}
+
+void SFXListTestFn(int argc, char **argv)
+{
+	uint32 nNumSteps = 5000;
+	if (argc > 0)
+		nNumSteps = (uint32)atoi(argv[0]);
+
+	// A few real objects for the fx to be attached to, since the fx hold
+	// engine references to their server objects
+	enum { kNumObjects = 8, kListSize = 40 };
+	HOBJECT aObjects[kNumObjects];
+	for (uint32 nObject = 0; nObject < kNumObjects; ++nObject)
+	{
+		ObjectCreateStruct ocs;
+		ocs.m_ObjectType = OT_NORMAL;
+		aObjects[nObject] = g_pLTClient->CreateObject(&ocs);
+		if (!aObjects[nObject])
+		{
+			g_pLTClient->CPrint("SFXListTest: could not create test objects");
+			for (uint32 nCreated = 0; nCreated < nObject; ++nCreated)
+				g_pLTClient->RemoveObject(aObjects[nCreated]);
+			return;
+		}
+	}
+
+	bool bPassed = true;
+	{
+		CSpecialFXList List;
+		List.Create(kListSize);
+		uint32 nExpected = 0;
+
+		for (uint32 nStep = 0; nStep < nNumSteps && bPassed; ++nStep)
+		{
+			int nOp = GetRandom(0, 9);
+			if (nOp < 4)
+			{
+				// Add, leaving a slot free so the list never has to replace
+				// its oldest fx (which asserts)
+				if (nExpected < kListSize - 1)
+				{
+					int nObject = GetRandom(0, kNumObjects);
+					HOBJECT hObj = (nObject < kNumObjects) ? aObjects[nObject] : NULL;
+					if (!List.Add(debug_new1(CSFXListTestFX, hObj)))
+						bPassed = false;
+					++nExpected;
+				}
+			}
+			else if (nOp < 6)
+			{
+				// Remove
+				if (nExpected > 0)
+				{
+					if (!List.Remove(List.GetDense(GetRandom(0, nExpected - 1))))
+						bPassed = false;
+					--nExpected;
+				}
+			}
+			else if (nOp < 8)
+			{
+				// WantRemove clears the server object but leaves the fx in
+				// the index under its old object
+				if (nExpected > 0)
+					List.GetDense(GetRandom(0, nExpected - 1))->WantRemove();
+			}
+			else
+			{
+				// An update pass the way CSFXMgr does it, with some of the
+				// fx finishing, and some of the updates removing another fx,
+				// visited or not.  Every fx left must be updated exactly once.
+				for (uint32 nDense = 0; nDense < nExpected; ++nDense)
+				{
+					CSFXListTestFX* pFX = (CSFXListTestFX*)List.GetDense(nDense);
+					pFX->m_nUpdates = 0;
+					pFX->m_bDone = (GetRandom(0, 3) == 0);
+				}
+
+				List.BeginIteration();
+
+				CSFXListTestFX* pFX;
+				while ((pFX = (CSFXListTestFX*)List.GetNextIteration()) != NULL)
+				{
+					if (pFX->m_nUpdates != 0)
+						bPassed = false;
+
+					bool bKeep = pFX->Update();
+
+					if (nExpected > 1 && GetRandom(0, 5) == 0)
+					{
+						CSpecialFX* pOther = List.GetDense(GetRandom(0, nExpected - 1));
+						if (pOther != pFX)
+						{
+							if (!List.Remove(pOther))
+								bPassed = false;
+							--nExpected;
+						}
+					}
+
+					if (!bKeep)
+					{
+						List.Remove(pFX);
+						--nExpected;
+					}
+				}
+
+				List.EndIteration();
+
+				for (uint32 nDense = 0; nDense < nExpected; ++nDense)
+				{
+					CSFXListTestFX* pFX = (CSFXListTestFX*)List.GetDense(nDense);
+					if (pFX->m_bDone || pFX->m_nUpdates != 1)
+						bPassed = false;
+				}
+			}
+
+			if (!SFXListTestCheck(List, aObjects, kNumObjects, nExpected))
+				bPassed = false;
+
+			if (!bPassed)
+				g_pLTClient->CPrint("SFXListTest: failed at step %d", nStep);
+		}
+	}
+
+	for (uint32 nObject = 0; nObject < kNumObjects; ++nObject)
+		g_pLTClient->RemoveObject(aObjects[nObject]);
+
+	g_pLTClient->CPrint("SFXListTest: %s", bPassed ? "passed" : "FAILED");
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ClientFXBenchmarkFn
+//
+//	PURPOSE:	Times the effect update of many copies of an effect with
+//			the parallel update off and then on.
+//
+// ----------------------------------------------------------------------- //
+
+void ClientFXBenchmarkFn(int argc, char **argv)
+{
+	if (argc < 1)
+	{
+		g_pLTClient->CPrint("ClientFXBenchmark <effect> [<count> [<frames>]]");
+		return;
+	}
+
+	uint32 nNumEffects = (argc > 1) ? (uint32)atoi(argv[1]) : 0;
+	uint32 nNumFrames = (argc > 2) ? (uint32)atoi(argv[2]) : 0;
+	CClientFXMgr::RunBenchmark(argv[0], nNumEffects, nNumFrames);
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ClientFXLookupBenchmarkFn
+//
+//	PURPOSE:	Times finding every loaded effect by name and by handle,
+//			and checks that every lookup finds the same effect.
+//
+// ----------------------------------------------------------------------- //
+
+static void ClientFXLookupBenchmarkReport(const char* pszMessage)
+{
+	g_pLTClient->CPrint("ClientFXLookupBenchmark: %s", pszMessage);
+}
+
+void ClientFXLookupBenchmarkFn(int argc, char **argv)
+{
+	uint32 nIterations = (argc > 0) ? (uint32)atoi(argv[0]) : 0;
+	uint32 nFailures = CClientFXDB::GetSingleton().RunLookupBenchmark(nIterations, ClientFXLookupBenchmarkReport);
+	g_pLTClient->CPrint("ClientFXLookupBenchmark: %u failures - %s", nFailures, nFailures ? "FAILED" : "PASSED");
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ShatterBenchmarkFn
+//
+//	PURPOSE:	Times the shattering of a generated pane of glass with
+//			the named shatter type.
+//
+// ----------------------------------------------------------------------- //
+
+void ShatterBenchmarkFn(int argc, char **argv)
+{
+	if (argc < 1)
+	{
+		g_pLTClient->CPrint("ShatterBenchmark <shattertype> [<gridsize> [<count>]]");
+		return;
+	}
+
+	uint32 nGridSize = (argc > 1) ? (uint32)atoi(argv[1]) : 0;
+	uint32 nNumShatters = (argc > 2) ? (uint32)atoi(argv[2]) : 0;
+	CShatterEffectMgr::RunBenchmark(argv[0], nGridSize, nNumShatters);
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	PolyGridBenchmarkFn
+//
+//	PURPOSE:	Reports the polygrid wave propagation speed in cells per
+//			millisecond at several grid sizes.
+//
+// ----------------------------------------------------------------------- //
+
+void PolyGridBenchmarkFn(int argc, char **argv)
+{
+	uint32 nNumFrames = (argc > 0) ? (uint32)atoi(argv[0]) : 0;
+	CPolyGridFX::RunBenchmark(nNumFrames);
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ObjectDetectorTestFn
+//
+//	PURPOSE:	Moves objects around a detector walking its list and a
+//			detector using the grid, and checks that both acquire the
+//			same object.  Only some of the moves are passed to
+//			OnObjectMove, so the grid has to catch up on the rest.
+//			Also checks that a custom line of site test is called on
+//			every acquire even with the line of site cache on.
+//
+// ----------------------------------------------------------------------- //
+
+static bool ObjectDetectorTestLOSFn(const LTVector& /*vSourcePos*/, ObjectDetectorLink* /*pLink*/, void* pUserData)
+{
+	++*(uint32*)pUserData;
+	return true;
+}
+
+static LTVector ObjectDetectorTestPos()
+{
+	return LTVector(GetRandom(-1024.0f, 1024.0f), GetRandom(-1024.0f, 1024.0f), GetRandom(-1024.0f, 1024.0f));
+}
+
+void ObjectDetectorTestFn(int argc, char **argv)
+{
+	uint32 nNumSteps = 1000;
+	if (argc > 0)
+		nNumSteps = (uint32)atoi(argv[0]);
+
+	enum { kNumObjects = 64, kMovesPerStep = 4 };
+	HOBJECT aObjects[kNumObjects];
+	for (uint32 nObject = 0; nObject < kNumObjects; ++nObject)
+	{
+		ObjectCreateStruct ocs;
+		ocs.m_ObjectType = OT_NORMAL;
+		ocs.m_Pos = ObjectDetectorTestPos();
+		aObjects[nObject] = g_pLTClient->CreateObject(&ocs);
+		if (!aObjects[nObject])
+		{
+			g_pLTClient->CPrint("ObjectDetectorTest: could not create test objects");
+			for (uint32 nCreated = 0; nCreated < nObject; ++nCreated)
+				g_pLTClient->RemoveObject(aObjects[nCreated]);
+			return;
+		}
+	}
+
+	bool bPassed = true;
+	{
+		// The detectors are declared first so the links release themselves
+		// while the detectors are still around
+		ObjectDetector ListDetector;
+		ObjectDetector GridDetector;
+		ObjectDetectorLink aListLinks[kNumObjects];
+		ObjectDetectorLink aGridLinks[kNumObjects];
+
+		ListDetector.SetBehaviorFlags(ObjectDetector::ODBF_ACQUIRESPHERE);
+		ListDetector.SetParamsSphere(1.0f, 400.0f);
+		GridDetector.SetBehaviorFlags(ObjectDetector::ODBF_ACQUIRESPHERE);
+		GridDetector.SetParamsSphere(1.0f, 400.0f);
+		GridDetector.SetBroadphaseParams(256.0f, 0.0f);
+
+		for (uint32 nObject = 0; nObject < kNumObjects; ++nObject)
+		{
+			ListDetector.RegisterObject(aListLinks[nObject], aObjects[nObject], NULL);
+			GridDetector.RegisterObject(aGridLinks[nObject], aObjects[nObject], NULL);
+		}
+
+		// Enough queries for the grid to re-read every position
+		uint32 nRefreshQueries = (kNumObjects + ObjectDetector::ODBF_GRIDREFRESHCOUNT - 1) / ObjectDetector::ODBF_GRIDREFRESHCOUNT;
+
+		for (uint32 nStep = 0; nStep < nNumSteps && bPassed; ++nStep)
+		{
+			for (uint32 nMove = 0; nMove < kMovesPerStep; ++nMove)
+			{
+				uint32 nObject = (uint32)GetRandom(0, kNumObjects - 1);
+				LTVector vPos = ObjectDetectorTestPos();
+				g_pLTClient->SetObjectPos(aObjects[nObject], vPos);
+				if (GetRandom(0, 1))
+					ObjectDetector::OnObjectMove(aObjects[nObject], vPos);
+			}
+
+			// Registering again moves the link to the front of the list the
+			// grid is refreshed from
+			if (GetRandom(0, 3) == 0)
+			{
+				uint32 nObject = (uint32)GetRandom(0, kNumObjects - 1);
+				GridDetector.RegisterObject(aGridLinks[nObject], aObjects[nObject], NULL);
+			}
+
+			LTVector vSource = ObjectDetectorTestPos();
+			ListDetector.SetTransform(vSource, LTRotation::GetIdentity());
+			GridDetector.SetTransform(vSource, LTRotation::GetIdentity());
+
+			HOBJECT hGridObject = NULL;
+			for (uint32 nQuery = 0; nQuery < nRefreshQueries; ++nQuery)
+				hGridObject = GridDetector.AcquireObject(false);
+
+			if (ListDetector.AcquireObject(false) != hGridObject)
+			{
+				g_pLTClient->CPrint("ObjectDetectorTest: grid acquired a different object at step %d", nStep);
+				bPassed = false;
+			}
+		}
+
+		// A custom line of site test must not have its results cached
+		uint32 nNumLOSCalls = 0;
+		ListDetector.SetBehaviorFlags(ObjectDetector::ODBF_ACQUIRESPHERE | ObjectDetector::ODBF_ACQUIRELINEOFSITE);
+		ListDetector.SetLineOfSiteFn(ObjectDetectorTestLOSFn, &nNumLOSCalls);
+		ListDetector.SetLineOfSiteCacheTime(10.0f);
+
+		LTVector vPos;
+		g_pLTClient->GetObjectPos(aObjects[0], &vPos);
+		ListDetector.SetTransform(vPos + LTVector(10.0f, 0.0f, 0.0f), LTRotation::GetIdentity());
+
+		ListDetector.AcquireObject(false);
+		uint32 nFirstLOSCalls = nNumLOSCalls;
+		ListDetector.AcquireObject(false);
+
+		if (nFirstLOSCalls == 0 || nNumLOSCalls != nFirstLOSCalls * 2)
+		{
+			g_pLTClient->CPrint("ObjectDetectorTest: custom line of site results were cached");
+			bPassed = false;
+		}
+	}
+
+	for (uint32 nObject = 0; nObject < kNumObjects; ++nObject)
+		g_pLTClient->RemoveObject(aObjects[nObject]);
+
+	g_pLTClient->CPrint("ObjectDetectorTest: %s", bPassed ? "passed" : "FAILED");
+}
+
+#endif // _FINAL
+
 void ExitLevelFn(int /*argc*/, char ** /*argv*/)
 {
 	// Track the current execution shell scope for proper SEM behavior
@@ -1228,6 +1833,15 @@ uint32 CGameClientShell::OnEngineInitialized(LTGUID *pAppGuid, RMode *pMode)
 	g_pLTClient->RegisterConsoleProgram("ConsoleRunWorld", ConsoleRunWorldFn);
 	g_pLTClient->RegisterConsoleProgram("NextSpawnPoint", NextSpawnPointFn);
 	g_pLTClient->RegisterConsoleProgram("PrevSpawnPoint", PrevSpawnPointFn);
+#ifndef _FINAL
+	g_pLTClient->RegisterConsoleProgram("JobSystemTest", JobSystemTestFn);
+	g_pLTClient->RegisterConsoleProgram("SFXListTest", SFXListTestFn);
+	g_pLTClient->RegisterConsoleProgram("ClientFXBenchmark", ClientFXBenchmarkFn);
+	g_pLTClient->RegisterConsoleProgram("ClientFXLookupBenchmark", ClientFXLookupBenchmarkFn);
+	g_pLTClient->RegisterConsoleProgram("ShatterBenchmark", ShatterBenchmarkFn);
+	g_pLTClient->RegisterConsoleProgram("PolyGridBenchmark", PolyGridBenchmarkFn);
+	g_pLTClient->RegisterConsoleProgram("ObjectDetectorTest", ObjectDetectorTestFn);
+#endif
 
 	g_pLTClient->RegisterConsoleProgram( "DisplayImage", DisplayImageFn );
 	g_vtDisplayImageScale.Init( g_pLTClient, "DisplayImageScale", NULL, 1.0f );
@@ -1433,6 +2047,9 @@ uint32 CGameClientShell::OnEngineInitialized(LTGUID *pAppGuid, RMode *pMode)
 
 	ClientVoteMgr::Instance().Init();
 
+	// Start the effect worker threads.  If this fails the jobs are just run on this thread.
+	m_JobSystem.Init();
+
 	// Init the special fx mgr...
 	if (!m_sfxMgr.Init(g_pLTClient))
 	{
@@ -1635,6 +2252,9 @@ void CGameClientShell::OnEngineTerm()
 
 	TermClientShell();
 
+	// Stop the effect worker threads.
+	m_JobSystem.Term();
+
 	// shut down the game streaming system
 	CGameStreamingMgr::Singleton().Term();
 
@@ -1764,7 +2384,13 @@ LTRESULT CGameClientShell::OnObjectMove(HOBJECT hObj, bool bTeleport, LTVector *
 	CClientShellScopeTracker cScopeTracker;
 	if( !g_pPlayerMgr )
 		return LT_OK;
-	return g_pPlayerMgr->GetMoveMgr()->OnObjectMove(hObj, bTeleport, pPos);
+	LTRESULT res = g_pPlayerMgr->GetMoveMgr()->OnObjectMove(hObj, bTeleport, pPos);
+
+	// Keep the object detector grids up to date with where the object ends up.
+	if (pPos)
+		ObjectDetector::OnObjectMove(hObj, *pPos);
+
+	return res;
 }
 
 
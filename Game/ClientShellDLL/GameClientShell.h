@@ -35,6 +35,7 @@
 #include "rendererframestats.h"
 #include "ShatterEffectMgr.h"
 #include "ltfilewrite.h"
+#include "ltjobsystem.h"
 #include <map>
 #include "iltgameutil.h"
 
@@ -285,6 +286,9 @@ private:
 	//**************************************************************************
 public:
 	CSFXMgr*	GetSFXMgr() { return &m_sfxMgr; }
+
+	// Worker threads shared by the client side effects.
+	CLTJobSystem*	GetJobSystem() { return &m_JobSystem; }
     void        FlashScreen(const LTVector &vFlashColor, const LTVector &vPos, float fFlashRange,
 		float fTime, float fRampUp, float fRampDown, bool bForce=false);
 
@@ -350,6 +354,7 @@ private :
 	CClientFXMgr		m_SimulationTimeClientFXMgr;			// This handles the Client fx created with FXEdit and uses simulation time.
 	CClientFXMgr		m_RealTimeClientFXMgr;	// This handles the Client fx created with FXEdit and uses real time.
 	CShatterEffectMgr	m_ShatterEffectMgr;		// Handles all shattering effect like breaking glass, etc.
+	CLTJobSystem		m_JobSystem;			// Worker threads used to spread effect updates across processors.
 
 	// List of ClientFXMgrs to manage ClientFX on a per-RenderTarget basis.
 	typedef std::pair<CRenderTarget*,bool> RenderTargetClientFXKey;
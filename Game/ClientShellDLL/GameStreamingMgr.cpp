@@ -4,6 +4,10 @@
 #include "iltrefcount.h"
 #include "soundmgr.h"
 #include "MissionMgr.h"
+#include "EngineTimer.h"
+#include "ltfileoperations.h"
+#include "ltfileread.h"
+#include "ltfilewrite.h"
 
 
 //-----------------------------------------------------------------------------------------------------
@@ -29,6 +33,44 @@ VarTrack	g_vtResourceStreamingAutoFlush;
 //should we disable visibility in sectors that we aren't in?
 VarTrack	g_vtResourceStreamingUpdateVis;
 
+//should we prefetch the region we expect to enter next?
+VarTrack	g_vtResourceStreamingPredict;
+
+//how many seconds ahead along the current velocity to look for the next region
+VarTrack	g_vtResourceStreamingPredictTime;
+
+//the score a region needs before it is prefetched, where following the velocity into a region
+//is worth 1 and the learned transitions are worth the fraction of times they were taken
+VarTrack	g_vtResourceStreamingPredictThreshold;
+
+//the fraction of the streaming region pool that the current, linked and predicted regions can use
+VarTrack	g_vtResourceStreamingPredictBudget;
+
+//-----------------------------------------------------------------------------------------------------
+// Prediction constants
+
+//identifies the file that learned transitions are saved in
+#define PREFETCH_FILE_FOURCC	LTMakeFourCC('S', 'P', 'R', 'F')
+static const uint32 knPrefetchFileVersion = 2;
+
+//the folder within the user directory that the learned transitions are saved in
+static const char* const kpszPrefetchFolder = "StreamingPrefetch";
+
+//the minimum amount of time a prediction is held before it can change, to avoid thrashing
+static const float kfMinPredictionTime = 1.0f;
+
+//any speed beyond this is treated as a teleport rather than movement
+static const float kfMaxPredictionSpeed = 5000.0f;
+
+//speeds below this are not used to predict the next region
+static const float kfMinPredictionSpeed = 10.0f;
+
+//how quickly the velocity estimate follows the actual movement, per second
+static const float kfVelocitySmoothing = 4.0f;
+
+//the number of times a region must have been left before its transitions are trusted
+static const uint32 knMinTransitionSamples = 3;
+
 //-----------------------------------------------------------------------------------------------------
 // Layout constants and HUD rendering utilities
 //
@@ -201,6 +243,23 @@ private:
 };
 
 
+//-----------------------------------------------------------------------------------------------------
+// Console Programs
+
+//displays the prefetching statistics for the current level
+static void ResourceStreamingStatsFn(int argc, char** argv)
+{
+	CGameStreamingMgr::Singleton().ReportPrefetchStats();
+}
+
+#ifndef _FINAL
+//checks the region prediction against a set of made up transitions
+static void ResourceStreamingPredictTestFn(int argc, char** argv)
+{
+	CGameStreamingMgr::RunPredictorTest();
+}
+#endif
+
 //-----------------------------------------------------------------------------------------------------
 // CGameStreamingMgr
 
@@ -210,6 +269,21 @@ CGameStreamingMgr::CGameStreamingMgr()
 	m_hRegion = NULL;
 	m_hLinked = NULL;
 
+	//initialize the prediction data
+	m_hPredicted = NULL;
+	m_fPredictedTime = 0.0;
+	m_vLastPos.Init();
+	m_fLastPosTime = 0.0;
+	m_bHasLastPos = false;
+	m_vVelocity.Init();
+
+	m_nLinkedHits			= 0;
+	m_nPredictedHits		= 0;
+	m_nRegionMisses			= 0;
+	m_nWastedPredictions	= 0;
+	m_nUnprefetchedAccesses	= 0;
+	m_nLateEntries			= 0;
+
 	//initialize the HUD data
 	m_TextFont = CFontInfo("Terminal", knFontHeight);
 
@@ -257,6 +331,15 @@ void CGameStreamingMgr::Init()
 	g_vtResourceStreamingConsoleHUD.Init(g_pLTClient, "ResourceStreamingConsoleHUD", NULL, 0.0f);	
 	g_vtResourceStreamingAutoFlush.Init(g_pLTClient, "ResourceStreamingAutoFlush", NULL, 1.0f);
 	g_vtResourceStreamingUpdateVis.Init(g_pLTClient, "ResourceStreamingUpdateVis", NULL, 1.0f);
+	g_vtResourceStreamingPredict.Init(g_pLTClient, "ResourceStreamingPredict", NULL, 1.0f);
+	g_vtResourceStreamingPredictTime.Init(g_pLTClient, "ResourceStreamingPredictTime", NULL, 2.0f);
+	g_vtResourceStreamingPredictThreshold.Init(g_pLTClient, "ResourceStreamingPredictThreshold", NULL, 0.5f);
+	g_vtResourceStreamingPredictBudget.Init(g_pLTClient, "ResourceStreamingPredictBudget", NULL, 1.0f);
+
+	g_pLTClient->RegisterConsoleProgram("ResourceStreamingStats", ResourceStreamingStatsFn);
+#ifndef _FINAL
+	g_pLTClient->RegisterConsoleProgram("ResourceStreamingPredictTest", ResourceStreamingPredictTestFn);
+#endif
 }
 
 //called to clean up the streaming system at an application wide level
@@ -264,17 +347,22 @@ void CGameStreamingMgr::Term()
 {
 	//remove our resource listener from the resource manager
 	g_pLTClient->ResourceMgr()->UnregisterResourceListener(&CGameStreamingListener::GetSingleton());
+	g_pLTClient->UnregisterConsoleProgram("ResourceStreamingStats");
+#ifndef _FINAL
+	g_pLTClient->UnregisterConsoleProgram("ResourceStreamingPredictTest");
+#endif
 	TermHUDAssets();
 }
 
 //called after a level has been loaded to allow the streaming to perform any necessary operations
 void CGameStreamingMgr::OnLevelLoaded()
 {
+	uint32 nNumRegions = 0;
+	g_pLTClient->ResourceMgr()->GetNumStreamingRegions(nNumRegions);
+
 	if(g_vtResourceStreamingUpdateVis.GetFloat() != 0.0f)
 	{
 		//run through each streaming region and turn off the sectors in the region
-		uint32 nNumRegions = 0;
-		g_pLTClient->ResourceMgr()->GetNumStreamingRegions(nNumRegions);
 		for(uint32 nCurrRegion = 0; nCurrRegion < nNumRegions; nCurrRegion++)
 		{
 			//get the region handle
@@ -284,11 +372,43 @@ void CGameStreamingMgr::OnLevelLoaded()
 			g_pLTClient->EnableRegionSectors(hRegion, false);
 		}
 	}
+
+	//build up the table of regions in this level so transitions can be tracked between them
+	m_Regions.resize(nNumRegions);
+	m_RegionNames.resize(nNumRegions);
+	for(uint32 nCurrRegion = 0; nCurrRegion < nNumRegions; nCurrRegion++)
+	{
+		m_Regions[nCurrRegion] = g_pLTClient->ResourceMgr()->GetStreamingRegion(nCurrRegion);
+
+		char pszRegionName[128];
+		g_pLTClient->ResourceMgr()->GetStreamingRegionName(m_Regions[nCurrRegion], pszRegionName, LTARRAYSIZE(pszRegionName));
+		m_RegionNames[nCurrRegion] = pszRegionName;
+	}
+
+	STransition EmptyTransition = { 0, 0 };
+	m_Transitions.assign(nNumRegions * nNumRegions, EmptyTransition);
+
+	//and bring in what was learned about this world in previous sessions
+	LoadPrefetchData();
+
+	//reset the prediction state for the new level
+	m_bHasLastPos = false;
+	m_vVelocity.Init();
+
+	m_nLinkedHits			= 0;
+	m_nPredictedHits		= 0;
+	m_nRegionMisses			= 0;
+	m_nWastedPredictions	= 0;
+	m_nUnprefetchedAccesses	= 0;
+	m_nLateEntries			= 0;
 }
 
 //called to update the current streaming data based upon the point provided to the callback
 void CGameStreamingMgr::UpdateRegions(const LTVector& vPos)
 {
+	//track how the point is moving so that we can anticipate where it is going
+	UpdateVelocity(vPos);
+
 	//determine what streaming regions this point is in
 	HSTREAMINGREGION	hNewRegion = NULL;
 	HSTREAMINGREGION	hNewLinked = NULL;
@@ -299,9 +419,16 @@ void CGameStreamingMgr::UpdateRegions(const LTVector& vPos)
 	if(hNewRegion == hNewLinked)
 		hNewLinked = NULL;
 
-	//see if we are already using these regions, meaning we don't need to do anything
+	//see if we are already using these regions, meaning only the prediction can change
 	if((m_hRegion == hNewRegion) && (m_hLinked == hNewLinked))
+	{
+		SetPredictedRegion(PredictRegion(vPos));
 		return;
+	}
+
+	//keep track of how well we anticipated entering this region
+	if(hNewRegion && (hNewRegion != m_hRegion))
+		OnEnterRegion(hNewRegion);
 
 	//see if we have just swapped our regions (if we don't handle this explicitly, the current
 	//region will be overridden which will make this less efficient and involve a deactivate
@@ -323,6 +450,7 @@ void CGameStreamingMgr::UpdateRegions(const LTVector& vPos)
 			g_pLTClient->ResourceMgr()->FlushAutoLoadedResources();
 
 		//and we can stop processing at this time
+		SetPredictedRegion(PredictRegion(vPos));
 		return;
 	}
 
@@ -344,10 +472,10 @@ void CGameStreamingMgr::UpdateRegions(const LTVector& vPos)
 		}
 		else
 		{
-			//this is a new region of which we didn't anticipate, we need to activate this region.
-			//This should rarely if ever be the case.
+			//this is a new region that wasn't linked, we need to activate this region unless it
+			//was already prefetched through prediction.
 			DeactivateRegion(m_hRegion);
-			ActivateRegion(hNewRegion);
+			ActivateRegionFromPrediction(hNewRegion);
 			m_hRegion = hNewRegion;
 
 			//update our active streaming region so assets can be tracked correctly
@@ -368,18 +496,37 @@ void CGameStreamingMgr::UpdateRegions(const LTVector& vPos)
 	{
 		//this is a new region of which we didn't anticipate, we need to activate this region
 		DeactivateRegion(m_hLinked);
-		ActivateRegion(hNewLinked);
+		ActivateRegionFromPrediction(hNewLinked);
 		m_hLinked = hNewLinked;
 
 		//and clear out our label
 		g_pLTClient->GetTextureString()->ReleaseTextureString(m_hLinkedRegionName);
 		m_hLinkedRegionName = NULL;
 	}
+
+	//and now determine what we should prefetch next from our new regions
+	SetPredictedRegion(PredictRegion(vPos));
 }
 
 //called to clear out any currently associated regions
 void CGameStreamingMgr::ClearCurrentRegions()
 {
+	//save out what was learned about this level before we lose track of the regions
+	if(!m_Regions.empty())
+	{
+		SavePrefetchData();
+
+		if(g_vtResourceStreamingConsoleHUD.GetFloat() != 0.0f)
+			ReportPrefetchStats();
+
+		m_Regions.clear();
+		m_RegionNames.clear();
+		m_Transitions.clear();
+	}
+
+	DeactivateRegion(m_hPredicted);
+	m_hPredicted = NULL;
+
 	DeactivateRegion(m_hRegion);
 	m_hRegion = NULL;
 
@@ -455,6 +602,11 @@ void CGameStreamingMgr::DisplayStreamingHUD(float fElapsedTime)
 
 		//and print out our global memory statistics and any events
 		g_pLTClient->CPrint("Global: %d/%d", nGlobalAssetMem, nGlobalLimit);
+
+		//print out the region we are prefetching ahead of time
+		g_pLTClient->ResourceMgr()->GetStreamingRegionName(m_hPredicted, pszRegionName, LTARRAYSIZE(pszRegionName));
+		g_pLTClient->CPrint("Predicted: %s Hits: %d/%d", (m_hPredicted ? pszRegionName : ""), m_nLinkedHits + m_nPredictedHits,
+							m_nLinkedHits + m_nPredictedHits + m_nRegionMisses);
 		g_pLTClient->CPrint("Events: %c %c %c", ((m_fNotPrefetchedTime > 0.0f) ? 'P' : ' '),
 												((m_fNotLoadedTime > 0.0f) ? 'L' : ' '),
 												((m_fOutOfMemoryTime > 0.0f) ? 'M' : ' '));
@@ -556,8 +708,7 @@ void CGameStreamingMgr::OnAccessUnprefetchedResource(const char* pszResource)
 	//reset our timing on the icon
 	m_fNotPrefetchedTime = kfIconDisplayTime;
 
-	//and log it if appropriate
-	//TODO:JO
+	++m_nUnprefetchedAccesses;
 }
 
 //called to trigger an event where a resource was not loaded when it was accessed
@@ -644,6 +795,474 @@ void CGameStreamingMgr::ActivateRegion(HSTREAMINGREGION hRegion)
 	}
 }
 
+//called to print out the prefetching statistics for the current level to the console
+void CGameStreamingMgr::ReportPrefetchStats()
+{
+	uint32 nHits = m_nLinkedHits + m_nPredictedHits;
+	uint32 nEntered = nHits + m_nRegionMisses;
+	uint32 nHitPercent = (nEntered) ? (nHits * 100) / nEntered : 0;
+
+	g_pLTClient->CPrint("Streaming: %d regions entered, %d linked, %d predicted, %d missed (%d%% prefetched)",
+						nEntered, m_nLinkedHits, m_nPredictedHits, m_nRegionMisses, nHitPercent);
+	g_pLTClient->CPrint("Streaming: %d predictions unused, %d regions entered before they were loaded, %d unprefetched accesses",
+						m_nWastedPredictions, m_nLateEntries, m_nUnprefetchedAccesses);
+}
+
+//called to update the estimated velocity of the streaming point
+void CGameStreamingMgr::UpdateVelocity(const LTVector& vPos)
+{
+	double fTime = RealTimeTimer::Instance().GetTimerAccumulatedS();
+	float fElapsed = (float)(fTime - m_fLastPosTime);
+
+	if(m_bHasLastPos && (fElapsed > 0.0f))
+	{
+		LTVector vFrameVelocity = (vPos - m_vLastPos) / fElapsed;
+
+		//a very large jump is a teleport or a camera cut, which tells us nothing about where
+		//we are headed
+		if(vFrameVelocity.MagSqr() > kfMaxPredictionSpeed * kfMaxPredictionSpeed)
+		{
+			m_vVelocity.Init();
+		}
+		else
+		{
+			//smooth out the velocity so that small movements don't change the prediction
+			float fBlend = LTMIN(fElapsed * kfVelocitySmoothing, 1.0f);
+			m_vVelocity += (vFrameVelocity - m_vVelocity) * fBlend;
+		}
+	}
+
+	m_vLastPos = vPos;
+	m_fLastPosTime = fTime;
+	m_bHasLastPos = true;
+}
+
+//called when the streaming point moves into a new region to update the statistics
+void CGameStreamingMgr::OnEnterRegion(HSTREAMINGREGION hNewRegion)
+{
+	//the first region in a level can't have been anticipated
+	if(!m_hRegion)
+		return;
+
+	//see if the region was activated too late. A region that wasn't linked or predicted hasn't
+	//even started loading, otherwise see if all of its assets have made it in yet
+	bool bLate = true;
+	if((hNewRegion == m_hLinked) || (hNewRegion == m_hPredicted))
+	{
+		if(hNewRegion == m_hLinked)
+			m_nLinkedHits++;
+		else
+			m_nPredictedHits++;
+
+		HREGIONASSETLIST hAsset = g_pLTClient->ResourceMgr()->GetStreamingRegionAssetList(hNewRegion);
+
+		uint32 nNumLoaded = 0, nTotalAssets = 0, nMemUsage = 0;
+		bLate = hAsset && (g_pLTClient->ResourceMgr()->GetRegionAssetListStats(hAsset, nNumLoaded, nTotalAssets, nMemUsage) == LT_OK) &&
+				(nNumLoaded < nTotalAssets);
+	}
+	else
+	{
+		m_nRegionMisses++;
+	}
+
+	if(bLate)
+		m_nLateEntries++;
+
+	//and learn from this transition, counting it against the transition if it was late so that it
+	//will be prefetched more eagerly in the future
+	int32 nFrom = GetRegionIndex(m_hRegion);
+	int32 nTo = GetRegionIndex(hNewRegion);
+	if((nFrom < 0) || (nTo < 0))
+		return;
+
+	STransition& Transition = GetTransition(nFrom, nTo);
+	Transition.m_nCount++;
+	if(bLate)
+		Transition.m_nLateEntries++;
+}
+
+//determines the region that should be prefetched in addition to the current and linked regions
+HSTREAMINGREGION CGameStreamingMgr::PredictRegion(const LTVector& vPos)
+{
+	if(g_vtResourceStreamingPredict.GetFloat() == 0.0f)
+		return NULL;
+
+	//hold onto a recent prediction so that we don't thrash between regions
+	double fTime = RealTimeTimer::Instance().GetTimerAccumulatedS();
+	if(m_hPredicted && (fTime - m_fPredictedTime < kfMinPredictionTime))
+		return m_hPredicted;
+
+	//find the region we will be in shortly if we keep moving the way we are
+	HSTREAMINGREGION hAhead = NULL;
+	if(m_vVelocity.MagSqr() > kfMinPredictionSpeed * kfMinPredictionSpeed)
+	{
+		LTVector vAhead = vPos + m_vVelocity * g_vtResourceStreamingPredictTime.GetFloat();
+
+		HSTREAMINGREGION hAheadLinked = NULL;
+		if(g_pLTClient->ResourceMgr()->GetPointStreamingRegions(vAhead, hAhead, hAheadLinked) != LT_OK)
+			hAhead = NULL;
+	}
+
+	//and score each region using the transitions out of the region we are in
+	int32 nFrom = GetRegionIndex(m_hRegion);
+	uint32 nNumRegions = (uint32)m_Regions.size();
+	const STransition* pTransitions = (nFrom >= 0) ? &GetTransition(nFrom, 0) : NULL;
+
+	int32 nBest = PickPredictedRegion(	pTransitions, nNumRegions, GetRegionIndex(hAhead), nFrom, GetRegionIndex(m_hLinked),
+										GetRegionIndex(m_hPredicted), g_vtResourceStreamingPredictThreshold.GetFloat());
+	if(nBest < 0)
+		return NULL;
+
+	//make sure that it will fit alongside what we are already using
+	HSTREAMINGREGION hBest = m_Regions[nBest];
+	if(!CanPrefetchRegion(hBest))
+		return NULL;
+
+	return hBest;
+}
+
+//given the transitions out of the current region (NULL if none are known), and the indices of
+//the region ahead along the velocity and the active regions (-1 if none), this will score each
+//region and return the index of the best one that passes the threshold, or -1 if none do
+int32 CGameStreamingMgr::PickPredictedRegion(	const STransition* pTransitions, uint32 nNumRegions, int32 nAhead,
+												int32 nCurrent, int32 nLinked, int32 nPredicted, float fThreshold)
+{
+	//determine how often each region has been entered from this one, where transitions that
+	//were made before the region had loaded count extra
+	uint32 nTotalCount = 0;
+	uint32 nTotalWeight = 0;
+
+	if(pTransitions)
+	{
+		for(uint32 nTo = 0; nTo < nNumRegions; nTo++)
+		{
+			nTotalCount += pTransitions[nTo].m_nCount;
+			nTotalWeight += pTransitions[nTo].m_nCount + pTransitions[nTo].m_nLateEntries;
+		}
+	}
+
+	bool bUseTransitions = (nTotalCount >= knMinTransitionSamples) && (nTotalWeight > 0);
+
+	//and now find the best scoring region that isn't already active
+	int32 nBest = -1;
+	float fBestScore = 0.0f;
+
+	for(int32 nTo = 0; nTo < (int32)nNumRegions; nTo++)
+	{
+		if((nTo == nCurrent) || (nTo == nLinked))
+			continue;
+
+		float fScore = (nTo == nAhead) ? 1.0f : 0.0f;
+		if(bUseTransitions)
+			fScore += (float)(pTransitions[nTo].m_nCount + pTransitions[nTo].m_nLateEntries) / (float)nTotalWeight;
+
+		//prefer the region we already have on a tie to avoid reloading
+		if((fScore > fBestScore) || ((fScore == fBestScore) && (nTo == nPredicted)))
+		{
+			nBest = nTo;
+			fBestScore = fScore;
+		}
+	}
+
+	if((nBest < 0) || (fBestScore <= 0.0f) || (fBestScore < fThreshold))
+		return -1;
+
+	return nBest;
+}
+
+//determines if there is enough memory in the streaming pool to prefetch the provided region
+bool CGameStreamingMgr::CanPrefetchRegion(HSTREAMINGREGION hRegion)
+{
+	//if the level doesn't specify a pool size, there is no limit to enforce
+	uint32 nPoolSize = 0;
+	g_pLTClient->ResourceMgr()->GetStreamingRegionPoolSize(nPoolSize);
+	if(nPoolSize == 0)
+		return true;
+
+	//determine how much memory the regions we are using have loaded
+	uint32 nUsedMem = 0;
+
+	HSTREAMINGREGION hActiveRegions[] = { m_hRegion, m_hLinked };
+	for(uint32 nCurrRegion = 0; nCurrRegion < LTARRAYSIZE(hActiveRegions); nCurrRegion++)
+	{
+		HREGIONASSETLIST hAsset = g_pLTClient->ResourceMgr()->GetStreamingRegionAssetList(hActiveRegions[nCurrRegion]);
+		if(!hAsset)
+			continue;
+
+		uint32 nLoadedAssets = 0, nAssets = 0, nAssetMem = 0;
+		g_pLTClient->ResourceMgr()->GetRegionAssetListStats(hAsset, nLoadedAssets, nAssets, nAssetMem);
+		nUsedMem += nAssetMem;
+	}
+
+	//and assume that the new region will use everything that it is allowed to
+	uint32 nRegionLimit = 0;
+	g_pLTClient->ResourceMgr()->GetStreamingRegionResourceLimit(hRegion, nRegionLimit);
+
+	return ((float)(nUsedMem + nRegionLimit) <= (float)nPoolSize * g_vtResourceStreamingPredictBudget.GetFloat());
+}
+
+//called to change the predicted region, activating and deactivating as needed
+void CGameStreamingMgr::SetPredictedRegion(HSTREAMINGREGION hRegion)
+{
+	if(hRegion == m_hPredicted)
+		return;
+
+	//we never made it to the old prediction
+	if(m_hPredicted)
+	{
+		DeactivateRegion(m_hPredicted);
+		m_nWastedPredictions++;
+	}
+
+	ActivateRegion(hRegion);
+	m_hPredicted = hRegion;
+	m_fPredictedTime = RealTimeTimer::Instance().GetTimerAccumulatedS();
+}
+
+//called when a region is about to be activated. If it is the predicted region, it is already
+//active and is handed over, otherwise the prediction is dropped and the region is activated
+void CGameStreamingMgr::ActivateRegionFromPrediction(HSTREAMINGREGION hRegion)
+{
+	if(!hRegion)
+		return;
+
+	if(hRegion == m_hPredicted)
+	{
+		m_hPredicted = NULL;
+		return;
+	}
+
+	//the prediction was wrong, so free up its memory before loading what we really need
+	SetPredictedRegion(NULL);
+	ActivateRegion(hRegion);
+}
+
+//given a region, this will find its index into the region table, or -1 if not found
+int32 CGameStreamingMgr::GetRegionIndex(HSTREAMINGREGION hRegion) const
+{
+	if(!hRegion)
+		return -1;
+
+	for(uint32 nCurrRegion = 0; nCurrRegion < m_Regions.size(); nCurrRegion++)
+	{
+		if(m_Regions[nCurrRegion] == hRegion)
+			return (int32)nCurrRegion;
+	}
+
+	return -1;
+}
+
+//called to build the filename that the learned transitions for the current world are stored in
+bool CGameStreamingMgr::GetPrefetchFilename(char* pszFilename, uint32 nBufferLen, bool bCreateDir)
+{
+	const char* pszWorldName = g_pMissionMgr->GetCurrentWorldName();
+	if(!pszWorldName || !pszWorldName[0])
+		return false;
+
+	//strip off any path from the world name
+	const char* pszBaseName = pszWorldName;
+	for(const char* pszCurr = pszWorldName; *pszCurr; pszCurr++)
+	{
+		if((*pszCurr == '/') || (*pszCurr == '\\'))
+			pszBaseName = pszCurr + 1;
+	}
+
+	char pszFolder[MAX_PATH];
+	LTFileOperations::GetUserDirectory(pszFolder, LTARRAYSIZE(pszFolder));
+	LTStrCat(pszFolder, kpszPrefetchFolder, LTARRAYSIZE(pszFolder));
+
+	if(bCreateDir && !LTFileOperations::DirectoryExists(pszFolder))
+	{
+		if(!LTFileOperations::CreateNewDirectory(pszFolder))
+			return false;
+	}
+
+	LTSNPrintF(pszFilename, nBufferLen, "%s%s%s.dat", pszFolder, FILE_PATH_SEPARATOR, pszBaseName);
+	return true;
+}
+
+//reads a length prefixed region name from the prefetch file
+static bool ReadPrefetchString(CLTFileRead& File, char* pszBuffer, uint32 nBufferLen)
+{
+	uint16 nLength = 0;
+	if(!File.Read(&nLength, sizeof(nLength)) || (nLength >= nBufferLen))
+		return false;
+
+	if(nLength && !File.Read(pszBuffer, nLength))
+		return false;
+
+	pszBuffer[nLength] = '\0';
+	return true;
+}
+
+//writes a length prefixed region name to the prefetch file
+static bool WritePrefetchString(CLTFileWrite& File, const std::string& sString)
+{
+	uint16 nLength = (uint16)sString.length();
+	return File.Write(&nLength, sizeof(nLength)) && (!nLength || File.Write(sString.c_str(), nLength));
+}
+
+//called to load the learned transitions for the current world
+void CGameStreamingMgr::LoadPrefetchData()
+{
+	char pszFilename[MAX_PATH];
+	if(!GetPrefetchFilename(pszFilename, LTARRAYSIZE(pszFilename), false) || !LTFileOperations::FileExists(pszFilename))
+		return;
+
+	CLTFileRead cFileRead;
+	if(!cFileRead.Open(pszFilename))
+		return;
+
+	//make sure this is a file we understand
+	uint32 nFileID = 0, nFileVersion = 0, nNumTransitions = 0;
+	if(	!cFileRead.Read(&nFileID, sizeof(nFileID)) || (nFileID != PREFETCH_FILE_FOURCC) ||
+		!cFileRead.Read(&nFileVersion, sizeof(nFileVersion)) || (nFileVersion != knPrefetchFileVersion) ||
+		!cFileRead.Read(&nNumTransitions, sizeof(nNumTransitions)))
+	{
+		return;
+	}
+
+	//and read in each transition, ignoring any regions that are no longer in the level
+	for(uint32 nCurrTransition = 0; nCurrTransition < nNumTransitions; nCurrTransition++)
+	{
+		char pszFrom[256], pszTo[256];
+		STransition Transition;
+		if(	!ReadPrefetchString(cFileRead, pszFrom, LTARRAYSIZE(pszFrom)) || !ReadPrefetchString(cFileRead, pszTo, LTARRAYSIZE(pszTo)) ||
+			!cFileRead.Read(&Transition.m_nCount, sizeof(Transition.m_nCount)) ||
+			!cFileRead.Read(&Transition.m_nLateEntries, sizeof(Transition.m_nLateEntries)))
+		{
+			return;
+		}
+
+		int32 nFrom = -1, nTo = -1;
+		for(uint32 nCurrRegion = 0; nCurrRegion < m_RegionNames.size(); nCurrRegion++)
+		{
+			if(m_RegionNames[nCurrRegion] == pszFrom)
+				nFrom = (int32)nCurrRegion;
+			if(m_RegionNames[nCurrRegion] == pszTo)
+				nTo = (int32)nCurrRegion;
+		}
+
+		if((nFrom >= 0) && (nTo >= 0))
+			GetTransition(nFrom, nTo) = Transition;
+	}
+}
+
+//called to save the learned transitions for the current world
+void CGameStreamingMgr::SavePrefetchData()
+{
+	//only write out the transitions that have been taken
+	uint32 nNumRegions = (uint32)m_Regions.size();
+	uint32 nNumTransitions = 0;
+	for(uint32 nCurrTransition = 0; nCurrTransition < m_Transitions.size(); nCurrTransition++)
+	{
+		if(m_Transitions[nCurrTransition].m_nCount)
+			nNumTransitions++;
+	}
+
+	if(nNumTransitions == 0)
+		return;
+
+	char pszFilename[MAX_PATH];
+	if(!GetPrefetchFilename(pszFilename, LTARRAYSIZE(pszFilename), true))
+		return;
+
+	CLTFileWrite cFileWrite;
+	if(!cFileWrite.Open(pszFilename, false))
+		return;
+
+	uint32 nFileID = PREFETCH_FILE_FOURCC;
+	cFileWrite.Write(&nFileID, sizeof(nFileID));
+	cFileWrite.Write(&knPrefetchFileVersion, sizeof(knPrefetchFileVersion));
+	cFileWrite.Write(&nNumTransitions, sizeof(nNumTransitions));
+
+	for(uint32 nFrom = 0; nFrom < nNumRegions; nFrom++)
+	{
+		for(uint32 nTo = 0; nTo < nNumRegions; nTo++)
+		{
+			const STransition& Transition = GetTransition(nFrom, nTo);
+			if(!Transition.m_nCount)
+				continue;
+
+			if(	!WritePrefetchString(cFileWrite, m_RegionNames[nFrom]) || !WritePrefetchString(cFileWrite, m_RegionNames[nTo]) ||
+				!cFileWrite.Write(&Transition.m_nCount, sizeof(Transition.m_nCount)) ||
+				!cFileWrite.Write(&Transition.m_nLateEntries, sizeof(Transition.m_nLateEntries)))
+			{
+				break;
+			}
+		}
+	}
+
+	cFileWrite.Close();
+}
+
+#ifndef _FINAL
+
+//called to check the region prediction against a set of made up transitions, reporting the
+//results to the console
+void CGameStreamingMgr::RunPredictorTest()
+{
+	//each case is the transitions out of region 0 to regions 0 through 3, followed by the region
+	//ahead along the velocity, the linked and predicted regions, the threshold, and the expected result
+	struct SPredictorCase
+	{
+		const char*	m_pszName;
+		uint32		m_nCounts[4];
+		uint32		m_nLateEntries[4];
+		int32		m_nAhead;
+		int32		m_nLinked;
+		int32		m_nPredicted;
+		float		m_fThreshold;
+		int32		m_nExpected;
+	};
+
+	static const SPredictorCase kCases[] =
+	{
+		{ "velocity only",					{ 0, 0, 0, 0 }, { 0, 0, 0, 0 },  2, -1, -1, 0.5f,  2 },
+		{ "nothing known",					{ 0, 0, 0, 0 }, { 0, 0, 0, 0 }, -1, -1, -1, 0.5f, -1 },
+		{ "too few transitions",			{ 0, 2, 0, 0 }, { 0, 0, 0, 0 }, -1, -1, -1, 0.5f, -1 },
+		{ "most taken transition",			{ 0, 3, 1, 0 }, { 0, 0, 0, 0 }, -1, -1, -1, 0.5f,  1 },
+		{ "velocity over transitions",		{ 0, 3, 1, 0 }, { 0, 0, 0, 0 },  2, -1, -1, 0.5f,  2 },
+		{ "late entries weigh more",		{ 0, 2, 2, 0 }, { 0, 0, 3, 0 }, -1, -1, -1, 0.5f,  2 },
+		{ "linked is skipped",				{ 0, 3, 1, 0 }, { 0, 0, 0, 0 }, -1,  1, -1, 0.5f, -1 },
+		{ "linked is skipped, low bar",		{ 0, 3, 1, 0 }, { 0, 0, 0, 0 }, -1,  1, -1, 0.2f,  2 },
+		{ "current is skipped",				{ 0, 0, 0, 0 }, { 0, 0, 0, 0 },  0, -1, -1, 0.5f, -1 },
+		{ "tie keeps prediction",			{ 0, 2, 2, 0 }, { 0, 0, 0, 0 }, -1, -1,  2, 0.4f,  2 },
+		{ "tie keeps other prediction",		{ 0, 2, 2, 0 }, { 0, 0, 0, 0 }, -1, -1,  1, 0.4f,  1 },
+	};
+
+	uint32 nFailures = 0;
+	for(uint32 nCurrCase = 0; nCurrCase < LTARRAYSIZE(kCases); nCurrCase++)
+	{
+		const SPredictorCase& Case = kCases[nCurrCase];
+
+		STransition Transitions[4];
+		for(uint32 nTo = 0; nTo < LTARRAYSIZE(Transitions); nTo++)
+		{
+			Transitions[nTo].m_nCount		= Case.m_nCounts[nTo];
+			Transitions[nTo].m_nLateEntries	= Case.m_nLateEntries[nTo];
+		}
+
+		int32 nResult = PickPredictedRegion(Transitions, LTARRAYSIZE(Transitions), Case.m_nAhead, 0, Case.m_nLinked, Case.m_nPredicted, Case.m_fThreshold);
+		if(nResult != Case.m_nExpected)
+		{
+			g_pLTClient->CPrint("ResourceStreamingPredictTest: %s picked %d, expected %d", Case.m_pszName, nResult, Case.m_nExpected);
+			nFailures++;
+		}
+	}
+
+	//and with no transitions known at all, only the velocity can be used
+	if(PickPredictedRegion(NULL, 4, 3, 0, -1, -1, 0.5f) != 3)
+	{
+		g_pLTClient->CPrint("ResourceStreamingPredictTest: no transitions didn't follow the velocity");
+		nFailures++;
+	}
+
+	g_pLTClient->CPrint("ResourceStreamingPredictTest: %d failures - %s", nFailures, (nFailures == 0) ? "PASSED" : "FAILED");
+}
+
+#endif
+
 //called to update the labels associated with the current streaming regions, and will regenerate
 //labels for any region that has a NULL label
 void CGameStreamingMgr::UpdateRegionLabels()
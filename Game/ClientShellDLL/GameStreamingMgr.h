@@ -5,6 +5,12 @@
 // events. This is responsible for managing the currently active streaming regions
 // that the player is involved in.
 //
+// In addition to the region the camera is in and the region it is linked to, a third
+// region can be activated ahead of time based upon where the camera is heading and
+// which regions have been entered from the current one in the past. The transitions
+// between regions, and how often each was made before the region had finished loading,
+// are saved per world so that the prediction improves across sessions.
+//
 // (c) 1997-2004 Monolith Productions, Inc.  All Rights Reserved
 //
 //---------------------------------------------------------------------------------
@@ -15,6 +21,8 @@
 #	include "iltresourcemgr.h"
 #endif
 
+#include <vector>
+
 class CGameStreamingMgr
 {
 public:
@@ -50,6 +58,15 @@ public:
 
 	//called to trigger an event where a resource was not loaded when it was accessed
 	void	OnAccessUnloadedResource(const char* pszResource);
+
+	//called to print out the prefetching statistics for the current level to the console
+	void	ReportPrefetchStats();
+
+#ifndef _FINAL
+	//called to check the region prediction against a set of made up transitions, reporting
+	//the results to the console
+	static void	RunPredictorTest();
+#endif
 	
 private:
 
@@ -72,6 +89,85 @@ private:
 	//the streaming region that we are currently linked to (need to prefetch before we get there)
 	HSTREAMINGREGION	m_hLinked;
 
+	//------------------------------------------
+	// Predictive Prefetching
+
+	//a transition from one region into another that has been observed, along with the number
+	//of times the region was entered before it had finished loading
+	struct STransition
+	{
+		uint32	m_nCount;
+		uint32	m_nLateEntries;
+	};
+
+	typedef std::vector<HSTREAMINGREGION, LTAllocator<HSTREAMINGREGION, LT_MEM_TYPE_CLIENTSHELL> > TRegionList;
+	typedef std::vector<STransition, LTAllocator<STransition, LT_MEM_TYPE_CLIENTSHELL> > TTransitionList;
+
+	//called to update the estimated velocity of the streaming point
+	void	UpdateVelocity(const LTVector& vPos);
+
+	//called when the streaming point moves into a new region to update the statistics
+	void	OnEnterRegion(HSTREAMINGREGION hNewRegion);
+
+	//determines the region that should be prefetched in addition to the current and linked regions
+	HSTREAMINGREGION	PredictRegion(const LTVector& vPos);
+
+	//given the transitions out of the current region (NULL if none are known), and the indices of
+	//the region ahead along the velocity and the active regions (-1 if none), this will score each
+	//region and return the index of the best one that passes the threshold, or -1 if none do
+	static int32	PickPredictedRegion(const STransition* pTransitions, uint32 nNumRegions, int32 nAhead,
+										int32 nCurrent, int32 nLinked, int32 nPredicted, float fThreshold);
+
+	//determines if there is enough memory in the streaming pool to prefetch the provided region
+	bool	CanPrefetchRegion(HSTREAMINGREGION hRegion);
+
+	//called to change the predicted region, activating and deactivating as needed
+	void	SetPredictedRegion(HSTREAMINGREGION hRegion);
+
+	//called when a region is about to be activated. If it is the predicted region, it is
+	//already active and is handed over, otherwise the prediction is dropped and the region
+	//is activated
+	void	ActivateRegionFromPrediction(HSTREAMINGREGION hRegion);
+
+	//given a region, this will find its index into the region table, or -1 if not found
+	int32	GetRegionIndex(HSTREAMINGREGION hRegion) const;
+
+	//access to the transition from one region index to another
+	STransition&	GetTransition(uint32 nFrom, uint32 nTo)	{ return m_Transitions[nFrom * m_RegionNames.size() + nTo]; }
+
+	//called to build the filename that the learned transitions for the current world are stored in
+	bool	GetPrefetchFilename(char* pszFilename, uint32 nBufferLen, bool bCreateDir);
+
+	//called to load and save the learned transitions for the current world
+	void	LoadPrefetchData();
+	void	SavePrefetchData();
+
+	//the region that we have activated because we expect to enter it soon
+	HSTREAMINGREGION	m_hPredicted;
+
+	//the time at which the predicted region was chosen
+	double				m_fPredictedTime;
+
+	//the last position and time used to estimate the velocity, and the smoothed velocity
+	LTVector			m_vLastPos;
+	double				m_fLastPosTime;
+	bool				m_bHasLastPos;
+	LTVector			m_vVelocity;
+
+	//the handles and names of every region in the current level, and the transitions between
+	//them indexed by [from * number of regions + to]
+	TRegionList			m_Regions;
+	StringArray			m_RegionNames;
+	TTransitionList		m_Transitions;
+
+	//statistics for the current level
+	uint32				m_nLinkedHits;
+	uint32				m_nPredictedHits;
+	uint32				m_nRegionMisses;
+	uint32				m_nWastedPredictions;
+	uint32				m_nUnprefetchedAccesses;
+	uint32				m_nLateEntries;
+
 	//------------------------------------------
 	// HUD Support
 
@@ -12,6 +12,7 @@
 #include "ModelDecalMgr.h"
 #include "iltrenderer.h"
 #include "VarTrack.h"
+#include "lttimeutils.h"
 #include <malloc.h>
 #include <algorithm>
 
@@ -22,6 +23,10 @@ extern ILTRenderer *g_pLTRenderer;
 // Note: Code should use the class interface instead of updating this variable!!!
 VarTrack g_CV_ModelDecalPerformanceLevel;
 
+// Console variable for the number of microseconds per frame that can be spent re-attaching
+// decals after a load.  At least one decal is always re-attached each frame.
+VarTrack g_CV_ModelDecalRestoreBudget;
+
 CGameModelDecalMgr* g_pModelDecalMgr = NULL;
 
 // Value indicating that a decal isn't currently fading
@@ -33,10 +38,14 @@ CGameModelDecalMgr::CGameModelDecalMgr()
 	g_pModelDecalMgr = this;
 	
 	g_CV_ModelDecalPerformanceLevel.Init(g_pLTClient, "ModelDecalPerformanceLevel", "1", 1.0f);
+	g_CV_ModelDecalRestoreBudget.Init(g_pLTClient, "ModelDecalRestoreBudget", NULL, 500.0f);
 	
 	LoadDecalTypes();
 	
 	m_fLastDecalTime = -1.0f;
+
+	m_nNumDecals = 0;
+	m_nNextSerial = 1;
 	
 	// Set the restriction settings to unrestricted to begin with
 	m_fMaxDecals = -1.0f;
@@ -107,26 +116,48 @@ void CGameModelDecalMgr::Save(ILTMessage_Write* pMsg, SaveDataState eSaveDataSta
 	
 	// Make sure our decal list is clean
 	CleanDecalList();
+
+	// Gather the decals a model at a time, so the decals on each model are next to each other
+	// in the save and can share a single object search when they're re-attached
+	Tuint32List aSaveDecals;
+	aSaveDecals.reserve(m_nNumDecals);
+	for (uint32 nCurBucket = 0; nCurBucket < k_nNumModelBuckets; ++nCurBucket)
+	{
+		TModelDecalsList::const_iterator iCurModel = m_aModelBuckets[nCurBucket].begin();
+		for (; iCurModel != m_aModelBuckets[nCurBucket].end(); ++iCurModel)
+		{
+			aSaveDecals.insert(aSaveDecals.end(), iCurModel->m_aDecals.begin(), iCurModel->m_aDecals.end());
+		}
+	}
 	
-	// Save the decals
-	pMsg->Writeuint32(m_aDecals.size());
-	TDecalList::iterator iCurDecal = m_aDecals.begin();
-	for (; iCurDecal != m_aDecals.end(); ++iCurDecal)
+	// Save the decals, along with any loaded decals that haven't been re-attached yet
+	pMsg->Writeuint32(aSaveDecals.size() + m_aLoadRecords.size());
+	Tuint32List::iterator iCurDecal = aSaveDecals.begin();
+	for (; iCurDecal != aSaveDecals.end(); ++iCurDecal)
 	{
-		pMsg->Writeuint32(iCurDecal->m_nType);
+		SDecal &sCurDecal = m_aDecals[*iCurDecal];
+		pMsg->Writeuint32(sCurDecal.m_nType);
 		LTMatrix3x4 mProjection;
-		g_pLTRenderer->GetModelDecalProjection(iCurDecal->m_hDecal, mProjection);
+		g_pLTRenderer->GetModelDecalProjection(sCurDecal.m_hDecal, mProjection);
 		pMsg->WriteType(mProjection);
 		// Write out the dims and position of the object, so we can try to figure out
 		// what object we were referring to when we load
 		// Note : This must happen because we can't save object references from the client!
 		LTVector vDims;
-		g_pPhysicsLT->GetObjectDims(iCurDecal->m_hObject, &vDims);
+		g_pPhysicsLT->GetObjectDims(sCurDecal.m_hObject, &vDims);
 		LTVector vPos;
-		g_pLTClient->GetObjectPos(iCurDecal->m_hObject, &vPos);
+		g_pLTClient->GetObjectPos(sCurDecal.m_hObject, &vPos);
 		pMsg->WriteLTVector(vDims);
 		pMsg->WriteLTVector(vPos);
 	}
+	TLoadRecordList::iterator iCurLoadRecord = m_aLoadRecords.begin();
+	for (; iCurLoadRecord != m_aLoadRecords.end(); ++iCurLoadRecord)
+	{
+		pMsg->Writeuint32(iCurLoadRecord->m_nDecalType);
+		pMsg->WriteType(iCurLoadRecord->m_mProjection);
+		pMsg->WriteLTVector(iCurLoadRecord->m_vDims);
+		pMsg->WriteLTVector(iCurLoadRecord->m_vPos);
+	}
 }
 
 void CGameModelDecalMgr::Load(ILTMessage_Read* pMsg, SaveDataState eLoadDataState)
@@ -143,10 +174,16 @@ void CGameModelDecalMgr::Load(ILTMessage_Read* pMsg, SaveDataState eLoadDataStat
 	}
 
 	// Clear any decals we already have
-	while (!m_aDecals.empty())
+	for (uint32 nCurDecal = 0; nCurDecal < m_aDecals.size(); ++nCurDecal)
 	{
-		RemoveDecal(m_aDecals.size() - 1);
+		RemoveDecal(nCurDecal);
 	}
+	m_aDecals.clear();
+	m_aFreeDecals.clear();
+	m_aFadeQueue.clear();
+	m_aFadingDecals.clear();
+	m_aBrokenModels.clear();
+	m_aLoadRecords.clear();
 	
 	// Load the decals	
 	uint32 nNumDecals = pMsg->Readuint32();
@@ -197,41 +234,70 @@ void CGameModelDecalMgr::Update()
 	if ((uint32)g_CV_ModelDecalPerformanceLevel.GetFloat() != GetPerformanceLevel())
 		SetPerformanceLevel((uint32)g_CV_ModelDecalPerformanceLevel.GetFloat());
 		
-	if (m_bCleanOnNextUpdate)
+	if (!m_aBrokenModels.empty())
 	{
-		CleanDecalList();
-		m_bCleanOnNextUpdate = false;
+		CleanBrokenModels();
 	}
 
 	// Process the load records
-	if (!m_aLoadRecords.empty())
+	UpdateRestore();
+	
+	UpdateFading();
+}
+
+void CGameModelDecalMgr::UpdateRestore()
+{
+	if (m_aLoadRecords.empty())
+		return;
+
+	// Make room for everything that's left to avoid copying the decal list while restoring
+	m_aDecals.reserve(m_nNumDecals + m_aLoadRecords.size());
+
+	TLTPrecisionTime nStartTime = LTTimeUtils::GetPrecisionTime();
+	double fBudgetUS = LTMAX(g_CV_ModelDecalRestoreBudget.GetFloat(), 0.0f);
+
+	// The object found for the previous record.  Decals on the same model are saved next to each
+	// other, so this saves searching for the same object again.
+	LTVector vPrevPos, vPrevDims;
+	HOBJECT hPrevResult = INVALID_HOBJECT;
+	bool bHavePrevResult = false;
+
+	do 
 	{
-		m_aDecals.reserve(m_aDecals.size() + m_aLoadRecords.size());
-		do 
+		// Get the next load record
+		SLoadRecord& sCurLoadRecord = m_aLoadRecords.back();
+		HOBJECT hResult;
+		if (bHavePrevResult && (sCurLoadRecord.m_vPos == vPrevPos) && (sCurLoadRecord.m_vDims == vPrevDims))
+		{
+			hResult = hPrevResult;
+		}
+		else
 		{
-			// Get the next load record
-			SLoadRecord& sCurLoadRecord = m_aLoadRecords.back();
 			// Set up the record for the query function
 			SFindObjectsAfterLoadInfo sInfo;
 			sInfo.m_pLoadRecord = &sCurLoadRecord;
 			sInfo.m_hResult = INVALID_HOBJECT;
 			// Find the object of our affection
-			LTVector vMin, vMax;
 			g_pLTClient->FindObjectsInBox(sCurLoadRecord.m_vPos, sCurLoadRecord.m_vDims + LTVector(1.0f, 1.0f, 1.0f), 
 							FindObjectAfterLoadFilterFn, &sInfo);
-			// Add a decal if we found something				
-			if (sInfo.m_hResult != INVALID_HOBJECT)
-			{
-				// Don't worry about time restrictions
-				m_fLastDecalTime = -1;
-				AddDecal(sInfo.m_hResult, sCurLoadRecord.m_nDecalType, sCurLoadRecord.m_mProjection);
-			}
-			// Remove it from the list
-			m_aLoadRecords.pop_back();
-		} while (!m_aLoadRecords.empty());
-	}
-	
-	UpdateFading();
+			hResult = sInfo.m_hResult;
+			// Remember the result for the next record
+			vPrevPos = sCurLoadRecord.m_vPos;
+			vPrevDims = sCurLoadRecord.m_vDims;
+			hPrevResult = hResult;
+			bHavePrevResult = true;
+		}
+		// Add a decal if we found something				
+		if (hResult != INVALID_HOBJECT)
+		{
+			// Don't worry about time restrictions
+			m_fLastDecalTime = -1;
+			AddDecal(hResult, sCurLoadRecord.m_nDecalType, sCurLoadRecord.m_mProjection);
+		}
+		// Remove it from the list
+		m_aLoadRecords.pop_back();
+	} while (!m_aLoadRecords.empty() && 
+			((LTTimeUtils::GetPrecisionTimeIntervalS(nStartTime, LTTimeUtils::GetPrecisionTime()) * 1000000.0) < fBudgetUS));
 }
 
 void CGameModelDecalMgr::AddDecal(HOBJECT hObject, HMODELNODE hNode, uint32 nDecalType, const LTVector& vOrigin, const LTVector& vDirection)
@@ -310,7 +376,7 @@ void CGameModelDecalMgr::AddDecal(HOBJECT hObject, uint32 nDecalType, const LTMa
 	double fCurTime = SimulationTimer::Instance().GetTimerAccumulatedS();
 
 	// Total
-	if ((m_fMaxDecals >= 0.0f) && (m_aDecals.size() >= (uint32)m_fMaxDecals))
+	if ((m_fMaxDecals >= 0.0f) && (m_nNumDecals >= (uint32)m_fMaxDecals))
 		return;	
 
 	// Over time
@@ -341,19 +407,35 @@ void CGameModelDecalMgr::AddDecal(HOBJECT hObject, uint32 nDecalType, const LTMa
 	if (nResult != LT_OK)
 		return;
 	
-	// Add it to the list
-	m_aDecals.push_back(SDecal());
-	SDecal &sNewDecal = m_aDecals.back();
+	// Add it to the list, re-using a free slot if we have one
+	uint32 nNewDecal;
+	if (!m_aFreeDecals.empty())
+	{
+		nNewDecal = m_aFreeDecals.back();
+		m_aFreeDecals.pop_back();
+	}
+	else
+	{
+		nNewDecal = m_aDecals.size();
+		m_aDecals.push_back(SDecal());
+	}
+	++m_nNumDecals;
+	SDecal &sNewDecal = m_aDecals[nNewDecal];
 	sNewDecal.m_hDecal = hDecal;
 	sNewDecal.m_hObject = hObject;
 	// Register for deletion notification
 	sNewDecal.m_hObject.SetReceiver(*this);
+	sNewDecal.m_hModel = hObject;
 	sNewDecal.m_nType = nDecalType;
-	// Add it to the fading list, if appropriate for this decal type
+	sNewDecal.m_nSerial = m_nNextSerial++;
+	sNewDecal.m_bInUse = true;
+	// Add it to the model's decals
+	GetModelDecals(hObject).m_aDecals.push_back(nNewDecal);
+	// Add it to the fading queue, if appropriate for this decal type
 	if (sDecalType.m_fFadeDelay >= 0.0f)
 	{
 		sNewDecal.m_fFadeStartTime = fCurTime + sDecalType.m_fFadeDelay;
-		m_aFadingDecals.push_back(m_aDecals.size() - 1);
+		QueueFade(nNewDecal);
 	}
 	else
 	{
@@ -379,38 +461,40 @@ uint32 CGameModelDecalMgr::GetDecalType(HRECORD hRecord)
 
 void CGameModelDecalMgr::FadeDecals(HOBJECT hModel)
 {
-	// Shortcut-out if this model doesn't have any decals (the engine can check in constant time)
-	uint32 nNumDecals = 0;
-	g_pLTRenderer->GetModelDecals(hModel, NULL, nNumDecals);
-	if (nNumDecals == 0)
+	// Shortcut-out if this model doesn't have any decals
+	SModelDecals* pModelDecals = FindModelDecals(hModel);
+	if (pModelDecals == NULL)
 		return;
 		
 	// Current simulation time
 	double fCurTime = SimulationTimer::Instance().GetTimerAccumulatedS();
 	
-	// Go through all the active decals
-	TDecalList::iterator iCurDecal = m_aDecals.begin();
-	for (; iCurDecal != m_aDecals.end(); ++iCurDecal)
+	// Go through the model's decals
+	Tuint32List::iterator iCurDecal = pModelDecals->m_aDecals.begin();
+	for (; iCurDecal != pModelDecals->m_aDecals.end(); ++iCurDecal)
 	{
-		// Skip decals that aren't attached to this model
-		if (iCurDecal->m_hObject != hModel)
+		SDecal &sCurDecal = m_aDecals[*iCurDecal];
+		// Skip decals that are no longer attached to this model
+		if (sCurDecal.m_hObject != hModel)
 			continue;
 		// Get the fading delay time for this decal
-		double fTypeDelay = m_aDecalTypes[iCurDecal->m_nType].m_fFadeDelay;
+		double fTypeDelay = m_aDecalTypes[sCurDecal.m_nType].m_fFadeDelay;
 		// Skip decals that are already fading
-		if (iCurDecal->m_fFadeStartTime != FADETIME_NOT_FADING)
+		if (sCurDecal.m_fFadeStartTime != FADETIME_NOT_FADING)
 		{
 			// Update the fade start time if the fade delay of the decal type hasn't elapsed yet
-			if ((fTypeDelay > 0.0f) && ((fCurTime - iCurDecal->m_fFadeStartTime) < 0.0f))
+			if ((fTypeDelay > 0.0f) && ((fCurTime - sCurDecal.m_fFadeStartTime) < 0.0f))
 			{
-				iCurDecal->m_fFadeStartTime = fCurTime - fTypeDelay;
+				sCurDecal.m_fFadeStartTime = fCurTime - fTypeDelay;
+				// Queue it again for the new time, the old entry will be dropped
+				QueueFade(*iCurDecal);
 			}
 			continue;
 		}
 		// Set the fade start time, offset by the delay time
-		iCurDecal->m_fFadeStartTime = fCurTime + LTMAX(fTypeDelay, 0.0f);
-		// Start it fading, and add it to the fading list
-		m_aFadingDecals.push_back(iCurDecal - m_aDecals.begin());
+		sCurDecal.m_fFadeStartTime = fCurTime + LTMAX(fTypeDelay, 0.0f);
+		// Start it fading, and add it to the fading queue
+		QueueFade(*iCurDecal);
 	}
 }
 
@@ -434,11 +518,22 @@ void CGameModelDecalMgr::TransferDecals(HOBJECT hSource, HOBJECT hDest)
 	}
 	
 	// Update the decal references to match
-	TDecalList::iterator iCurDecal = m_aDecals.begin();
-	for (; iCurDecal != m_aDecals.end(); ++iCurDecal)
+	SModelDecals* pSourceDecals = FindModelDecals(hSource);
+	if ((pSourceDecals == NULL) || (hSource == hDest))
+		return;
+
+	// Work from a copy, since moving the decals changes the source's list
+	m_aCleanDecals = pSourceDecals->m_aDecals;
+	Tuint32List::iterator iCurDecal = m_aCleanDecals.begin();
+	for (; iCurDecal != m_aCleanDecals.end(); ++iCurDecal)
 	{
-		if (iCurDecal->m_hObject == hSource)
-			iCurDecal->m_hObject = hDest;
+		SDecal &sCurDecal = m_aDecals[*iCurDecal];
+		if (sCurDecal.m_hObject != hSource)
+			continue;
+		RemoveModelDecal(hSource, *iCurDecal);
+		sCurDecal.m_hObject = hDest;
+		sCurDecal.m_hModel = hDest;
+		GetModelDecals(hDest).m_aDecals.push_back(*iCurDecal);
 	}
 }
 
@@ -485,24 +580,49 @@ void CGameModelDecalMgr::LoadDecalTypes()
 void CGameModelDecalMgr::CleanDecalList()
 {
 	// Remove all decals referring to null objects.
-	// RemoveDecal swaps the current element with the last and then pops off 
-	// the back to the list; we don't need to do any special handling here.
+	// Decals never move between slots, so we don't need to do any special handling here.
 
 	for ( size_t i = 0; i < m_aDecals.size(); ++i )
 	{
-		if (m_aDecals[i].m_hObject == INVALID_HOBJECT)
+		if (m_aDecals[i].m_bInUse && (m_aDecals[i].m_hObject == INVALID_HOBJECT))
 		{
 			RemoveDecal( i );
 		}
 	}
+
+	// Everything has been cleaned
+	m_aBrokenModels.clear();
+}
+
+void CGameModelDecalMgr::CleanBrokenModels()
+{
+	// Remove the decals referring to null objects from each of the models that lost decals
+	TObjectList::iterator iCurModel = m_aBrokenModels.begin();
+	for (; iCurModel != m_aBrokenModels.end(); ++iCurModel)
+	{
+		SModelDecals* pModelDecals = FindModelDecals(*iCurModel);
+		if (pModelDecals == NULL)
+			continue;
+
+		// Work from a copy, since removing decals changes the model's list
+		m_aCleanDecals = pModelDecals->m_aDecals;
+		Tuint32List::iterator iCurDecal = m_aCleanDecals.begin();
+		for (; iCurDecal != m_aCleanDecals.end(); ++iCurDecal)
+		{
+			if (m_aDecals[*iCurDecal].m_hObject == INVALID_HOBJECT)
+				RemoveDecal(*iCurDecal);
+		}
+	}
+
+	m_aBrokenModels.clear();
 }
 
 void CGameModelDecalMgr::OnLinkBroken(LTObjRefNotifier* pRef, HOBJECT hObj)
 {
-	// Remember to clean up the decal list soon
+	// Remember to clean up the model's decals soon
 	// Note: This is done later so we don't have to worry about any interactions with
 	// removing the object references while in the middle of getting notifications
-	m_bCleanOnNextUpdate = true;
+	m_aBrokenModels.push_back(hObj);
 }
 
 void CGameModelDecalMgr::SetPerformanceLevel(uint32 nLevel)
@@ -561,79 +681,150 @@ void CGameModelDecalMgr::LoadPerformanceSettings()
 
 void CGameModelDecalMgr::RemoveDecal(uint32 nIndex)
 {
-	bool bIsLast = (nIndex == (m_aDecals.size() - 1));
-	bool bWasFading = (m_aDecals[nIndex].m_fFadeStartTime != FADETIME_NOT_FADING);
-	// If the last element in the decal list is fading, that entry in the  fading list will need to get updated
-	// with a new index because it's going to get swapped with the deleted item
-	bool bIsLastFading = (m_aDecals.back().m_fFadeStartTime != FADETIME_NOT_FADING) && (!bIsLast);
+	SDecal &sDecal = m_aDecals[nIndex];
+	if (!sDecal.m_bInUse)
+		return;
 
 	// Remove it from the object
-	if (m_aDecals[nIndex].m_hObject != INVALID_HOBJECT)
+	if (sDecal.m_hObject != INVALID_HOBJECT)
 	{
-		m_hDeletingDecal = m_aDecals[nIndex].m_hDecal;
-		g_pLTRenderer->DestroyModelDecal(m_aDecals[nIndex].m_hDecal);
+		m_hDeletingDecal = sDecal.m_hDecal;
+		g_pLTRenderer->DestroyModelDecal(sDecal.m_hDecal);
 	}
+
+	// Remove it from the model table
+	RemoveModelDecal(sDecal.m_hModel, nIndex);
 			
-	// Remove it from the main list
-	if (!bIsLast)
-		m_aDecals[nIndex] = m_aDecals.back();
-	m_aDecals.pop_back();
-	
-	if (bWasFading)
+	// Free up the slot
+	// Note : Any fading entries for this decal are dropped the next time they're looked at
+	sDecal.m_hObject = NULL;
+	sDecal.m_hModel = NULL;
+	sDecal.m_hDecal = NULL;
+	sDecal.m_bInUse = false;
+	m_aFreeDecals.push_back(nIndex);
+	--m_nNumDecals;
+}
+
+CGameModelDecalMgr::SModelDecals* CGameModelDecalMgr::FindModelDecals(HOBJECT hModel)
+{
+	TModelDecalsList &aBucket = m_aModelBuckets[GetModelBucket(hModel)];
+	TModelDecalsList::iterator iCurModel = aBucket.begin();
+	for (; iCurModel != aBucket.end(); ++iCurModel)
 	{
-		// Remove the index from the fading list
-		Tuint32List::iterator iErase = std::remove(m_aFadingDecals.begin(), m_aFadingDecals.end(), nIndex);
-		m_aFadingDecals.erase(iErase, m_aFadingDecals.end());
+		if (iCurModel->m_hModel == hModel)
+			return &(*iCurModel);
 	}
-	
-	if (bIsLastFading)
-	{	
-		// Re-number the fade entries for what used to be the last decal
-		Tuint32List::iterator iCurFade = m_aFadingDecals.begin();
-		for (; iCurFade != m_aFadingDecals.end(); ++iCurFade)
+	return NULL;
+}
+
+CGameModelDecalMgr::SModelDecals& CGameModelDecalMgr::GetModelDecals(HOBJECT hModel)
+{
+	SModelDecals* pModelDecals = FindModelDecals(hModel);
+	if (pModelDecals != NULL)
+		return *pModelDecals;
+
+	TModelDecalsList &aBucket = m_aModelBuckets[GetModelBucket(hModel)];
+	aBucket.push_back(SModelDecals());
+	aBucket.back().m_hModel = hModel;
+	return aBucket.back();
+}
+
+void CGameModelDecalMgr::RemoveModelDecal(HOBJECT hModel, uint32 nDecal)
+{
+	TModelDecalsList &aBucket = m_aModelBuckets[GetModelBucket(hModel)];
+	TModelDecalsList::iterator iCurModel = aBucket.begin();
+	for (; iCurModel != aBucket.end(); ++iCurModel)
+	{
+		if (iCurModel->m_hModel != hModel)
+			continue;
+
+		Tuint32List &aDecals = iCurModel->m_aDecals;
+		Tuint32List::iterator iDecal = std::find(aDecals.begin(), aDecals.end(), nDecal);
+		if (iDecal != aDecals.end())
+		{
+			*iDecal = aDecals.back();
+			aDecals.pop_back();
+		}
+
+		// Drop the model once it doesn't have any decals left
+		if (aDecals.empty())
 		{
-			if (*iCurFade == m_aDecals.size())
-				*iCurFade = nIndex;
+			iCurModel->m_hModel = aBucket.back().m_hModel;
+			iCurModel->m_aDecals.swap(aBucket.back().m_aDecals);
+			aBucket.pop_back();
 		}
+		return;
 	}
 }
 
+void CGameModelDecalMgr::QueueFade(uint32 nDecal)
+{
+	const SDecal &sDecal = m_aDecals[nDecal];
+	SFadeEntry sEntry;
+	sEntry.m_fFadeStartTime = sDecal.m_fFadeStartTime;
+	sEntry.m_nDecal = nDecal;
+	sEntry.m_nSerial = sDecal.m_nSerial;
+	m_aFadeQueue.push_back(sEntry);
+	std::push_heap(m_aFadeQueue.begin(), m_aFadeQueue.end());
+}
+
+bool CGameModelDecalMgr::IsFadeEntryCurrent(const SFadeEntry &sEntry) const
+{
+	if (sEntry.m_nDecal >= m_aDecals.size())
+		return false;
+	// The decal has to be the same one, and can't have been re-scheduled since the entry was made
+	const SDecal &sDecal = m_aDecals[sEntry.m_nDecal];
+	return sDecal.m_bInUse && 
+		(sDecal.m_nSerial == sEntry.m_nSerial) && 
+		(sDecal.m_fFadeStartTime == sEntry.m_fFadeStartTime);
+}
+
 void CGameModelDecalMgr::UpdateFading()
 {
 	// Avoid doing any work if nothing's fading
-	if (m_aFadingDecals.empty())
+	if (m_aFadeQueue.empty() && m_aFadingDecals.empty())
 		return;
 		
 	// Current simulation time
 	double fCurTime = SimulationTimer::Instance().GetTimerAccumulatedS();
+
+	// Move the decals that have started fading from the queue to the fading list
+	while (!m_aFadeQueue.empty() && (m_aFadeQueue.front().m_fFadeStartTime <= fCurTime))
+	{
+		SFadeEntry sEntry = m_aFadeQueue.front();
+		std::pop_heap(m_aFadeQueue.begin(), m_aFadeQueue.end());
+		m_aFadeQueue.pop_back();
+		if (IsFadeEntryCurrent(sEntry))
+			m_aFadingDecals.push_back(sEntry);
+	}
 	
-	for (uint32 nCurFade = 0; nCurFade < m_aFadingDecals.size(); ++nCurFade)
+	for (uint32 nCurFade = 0; nCurFade < m_aFadingDecals.size(); )
 	{
-		uint32 nFadeDecal = m_aFadingDecals[nCurFade];
-		if (nFadeDecal >= m_aDecals.size())
+		uint32 nFadeDecal = m_aFadingDecals[nCurFade].m_nDecal;
+		// Drop entries for decals that have been removed or re-scheduled
+		if (!IsFadeEntryCurrent(m_aFadingDecals[nCurFade]))
 		{
-			LTERROR("Decal fade encountered past end of list!");
+			m_aFadingDecals[nCurFade] = m_aFadingDecals.back();
+			m_aFadingDecals.pop_back();
 			continue;
 		}
 		SDecal &sCurDecal = m_aDecals[nFadeDecal];
 		// Skip decals that are no longer associated
 		if (sCurDecal.m_hObject == NULL)
+		{
+			++nCurFade;
 			continue;
+		}
 		// Calculate the fading percentage
 		float fFadePercent = (float)((fCurTime - sCurDecal.m_fFadeStartTime) / m_aDecalTypes[sCurDecal.m_nType].m_fFadeDuration);
-		// Skip decals that haven't started fading yet
-		if (fFadePercent < 0.0f)
-			continue;
 		// Remove decals that are done fading
 		if (fFadePercent >= 1.0f)
 		{
 			// Delete the decal 
 			RemoveDecal(nFadeDecal);
-			// Jump out if we removed the last decal
-			if (nCurFade >= m_aFadingDecals.size())
-				break;
-			// Back up so we don't skip anybody
-			--nCurFade;
+			// Remove the entry, which brings the last entry back to this spot
+			m_aFadingDecals[nCurFade] = m_aFadingDecals.back();
+			m_aFadingDecals.pop_back();
 			// We're done here...
 			continue;
 		}
@@ -644,6 +835,8 @@ void CGameModelDecalMgr::UpdateFading()
 		// Update the color
 		g_pLTRenderer->SetModelDecalColorOverride(sCurDecal.m_hDecal, true);
 		g_pLTRenderer->SetModelDecalColor(sCurDecal.m_hDecal, fObjectR, fObjectG, fObjectB, 1.0f - fFadePercent);
+
+		++nCurFade;
 	}
 }
 
@@ -657,14 +850,14 @@ void CGameModelDecalMgr::OnDecalDeleted(HMODELDECAL hDecal)
 	// Skip decals we already know about
 	if (hDecal != m_hDeletingDecal)
 	{
-		// Mark matching decals for deletion from the list and clean the list on the next update
+		// Mark matching decals for deletion from the list and clean their models on the next update
 		for (TDecalList::iterator iCurDecal = m_aDecals.begin(); iCurDecal != m_aDecals.end(); ++iCurDecal)
 		{
-			if (iCurDecal->m_hDecal == hDecal)
+			if (iCurDecal->m_bInUse && (iCurDecal->m_hDecal == hDecal))
 			{
 				iCurDecal->m_hObject = NULL;
 				iCurDecal->m_hDecal = NULL;
-				m_bCleanOnNextUpdate = true;
+				m_aBrokenModels.push_back(iCurDecal->m_hModel);
 			}
 		}
 	}
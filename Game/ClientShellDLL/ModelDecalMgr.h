@@ -79,20 +79,58 @@ private:
 	typedef std::vector<SDecalType> TDecalTypeList;
 	
 	// Decal tracking structure
+	// Note : Decals stay in the same slot of the decal list for their whole lifetime, so the slot
+	// index can be used to refer to them from the model table and the fading lists
 	struct SDecal
 	{
 		// Note: Unsafe obj ref notifier - Refer to notes in ltobjref.h when dealing with this member
 		LTObjRefNotifierUnsafe	m_hObject;
+		// The model this decal is filed under in the model table.  Unlike m_hObject, this isn't
+		// cleared when the model goes away, so the decal can still be found from the model
+		HOBJECT			m_hModel;
 		// The engine-side decal
 		HMODELDECAL		m_hDecal;
 		// The original type
 		uint32			m_nType;
 		// Fade start time
 		double			m_fFadeStartTime;
+		// Unique number for this use of the slot, used to detect stale fading entries
+		uint32			m_nSerial;
+		// Is this slot holding a decal?
+		bool			m_bInUse;
 	};
 	typedef std::vector<SDecal> TDecalList;
+
+	// The decals attached to a single model
+	struct SModelDecals
+	{
+		HOBJECT		m_hModel;
+		// Slots of the decals on this model
+		Tuint32List	m_aDecals;
+	};
+	typedef std::vector<SModelDecals> TModelDecalsList;
+
+	// The model table hashes on the model handle into a fixed number of buckets
+	enum { k_nNumModelBuckets = 256 };
+
+	// Entry in the fading lists
+	struct SFadeEntry
+	{
+		// Fade start time of the decal when the entry was made
+		double	m_fFadeStartTime;
+		// Slot and serial of the decal
+		uint32	m_nDecal;
+		uint32	m_nSerial;
+
+		// Heap ordering, so the earliest fade start time is at the front of the queue
+		bool operator<(const SFadeEntry& sOther) const { return m_fFadeStartTime > sOther.m_fFadeStartTime; }
+	};
+	typedef std::vector<SFadeEntry> TFadeEntryList;
+
+	// List of model handles
+	typedef std::vector<HOBJECT> TObjectList;
 	
-	// Internal structure indicating a decal that was loaded, and will be created on the next update
+	// Internal structure indicating a decal that was loaded, and will be created over the next few updates
 	struct SLoadRecord
 	{
 		// Information for finding the object in question...
@@ -138,6 +176,12 @@ private:
 	// Clean dead decals from the decal list
 	void CleanDecalList();
 
+	// Clean dead decals from the models that have been removed since the last update
+	void CleanBrokenModels();
+
+	// Re-attach loaded decals until the restore budget for this frame runs out
+	void UpdateRestore();
+
 	// Function used for re-attaching decals to their models after loading
 	static void FindObjectAfterLoadFilterFn(HOBJECT hObj, void* pUserData);
 
@@ -149,6 +193,17 @@ private:
 
 	// Remove a decal from all internal lists
 	void RemoveDecal(uint32 nIndex);
+
+	// Model table access
+	SModelDecals* FindModelDecals(HOBJECT hModel);
+	SModelDecals& GetModelDecals(HOBJECT hModel);
+	void RemoveModelDecal(HOBJECT hModel, uint32 nDecal);
+	static uint32 GetModelBucket(HOBJECT hModel) { return (uint32)((size_t)hModel >> 4) & (k_nNumModelBuckets - 1); }
+
+	// Queue a decal to start fading once its fade start time is reached
+	void QueueFade(uint32 nDecal);
+	// Does a fading entry still refer to the decal it was made for?
+	bool IsFadeEntryCurrent(const SFadeEntry& sEntry) const;
 	
 	// Update the fading state of any fading decals
 	void UpdateFading();
@@ -162,17 +217,30 @@ private:
 	// The available decal types
 	TDecalTypeList m_aDecalTypes;
 	
-	// The active decals
+	// The active decals, along with the slots that aren't currently in use
 	TDecalList m_aDecals;
+	Tuint32List m_aFreeDecals;
+	uint32	m_nNumDecals;
+	
+	// Serial number for the next decal
+	uint32	m_nNextSerial;
+
+	// The decals on each model, hashed on the model handle
+	TModelDecalsList m_aModelBuckets[k_nNumModelBuckets];
 	
-	// List of fading decals
-	Tuint32List m_aFadingDecals;
+	// Heap of decals waiting for their fade to start
+	TFadeEntryList m_aFadeQueue;
+	// List of decals that have started fading
+	TFadeEntryList m_aFadingDecals;
 
 	// Decals pending re-attachment after load
 	TLoadRecordList m_aLoadRecords;
 	
-	// Clean up the decal list on the next update
-	bool	m_bCleanOnNextUpdate;
+	// Models that have lost decals since the last update, which need their decal lists cleaned
+	TObjectList m_aBrokenModels;
+	
+	// Scratch list used when cleaning up decals
+	Tuint32List m_aCleanDecals;
 	
 	// Time of last decal placement
 	double	m_fLastDecalTime;
@@ -647,15 +647,20 @@ bool CPlayerMgr::Init()
 	g_iFocusObjectDetector.SetParamsFOV( 80.0f, 64.0f, 10.0f, 2000.0f, 0.25f, 0.5f, 0.25f );
 	g_iFocusObjectDetector.SetVerifyFailureDelay( ObjectDetector::ODBF_VERIFYLINEOFSITE, 3.0f );
 	g_iFocusObjectDetector.SetSpatialFn( FocusObjectDetectorSpatialCB, NULL );
+	g_iFocusObjectDetector.SetBroadphaseParams( 512.0f, 32.0f );
+	g_iFocusObjectDetector.SetLineOfSiteCacheTime( 0.1f );
 
 	// Setup the attack prediction detector
 	g_iAttackPredictionObjectDetector.SetBehaviorFlags( ObjectDetector::ODBF_ACQUIREFOV | ObjectDetector::ODBF_INCLUSIVEVERIFY | ObjectDetector::ODBF_VERIFYFOV );
 	g_iAttackPredictionObjectDetector.SetParamsFOV( 80.0f, 180.0f, 10.0f, 150.0f, 0.25f, 0.5f, 0.25f );
+	g_iAttackPredictionObjectDetector.SetBroadphaseParams( 256.0f, 0.0f );
 
 	// Setup the pickup object detector
 	m_PickupObjectDetector.SetBehaviorFlags( ObjectDetector::ODBF_ACQUIREFOV | ObjectDetector::ODBF_ACQUIRELINEOFSITE | ObjectDetector::ODBF_ACQUIRECUSTOM | ObjectDetector::ODBF_INCLUSIVEACQUIRE );
 	m_PickupObjectDetector.SetParamsFOV( 30.0f, 120.0f, 0.0f, g_vtPickupDistance.GetFloat(), 1.0f, 1.0f, 1.0f );
 	m_PickupObjectDetector.SetCustomTestFn( PickupObjectDetectorCustomTestCB, NULL );
+	m_PickupObjectDetector.SetBroadphaseParams( 256.0f, 0.0f );
+	m_PickupObjectDetector.SetLineOfSiteCacheTime( 0.1f );
 
 	// Setup the forensic object detector
 	m_ForensicObjectDetector.SetBehaviorFlags( ObjectDetector::ODBF_ACQUIRECUSTOM );
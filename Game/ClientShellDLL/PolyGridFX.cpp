@@ -26,6 +26,13 @@
 #include "ProjectileFX.h"
 #include "ltintersect.h"
 #include "CollisionsDB.h"
+#include "lttimeutils.h"
+
+//the wave propagation kernel processes four cells at a time with SSE on the x86 platforms
+#if defined(PLATFORM_WIN32) || defined(PLATFORM_LINUX)
+#	define POLYGRID_USE_SSE
+#	include <xmmintrin.h>
+#endif
 
 //our object used for tracking performance for poly grids
 static CTimedSystem g_tsClientPolyGrid("GameClient_PolyGrid", "GameClient");
@@ -62,6 +69,13 @@ extern CGameClientShell* g_pGameClientShell;
 //equal to one so that it doesn't have to perform a large number of costly boundary checks
 static const uint32 knKernalSize = 1;
 
+//grids with fewer cells than this are updated on the calling thread since splitting them across
+//the job system costs more than it saves
+static const uint32 knMinCellsForJobs = 64 * 64;
+
+//the approximate number of cells that are updated by each wave propagation job
+static const uint32 knCellsPerJob = 4096;
+
 //utility function that given a floating point value in the polygrid space, the number of polygons
 //along the axis, and the half dims of the axis, will convert this to a floating point value in the
 //range of [0..nNumPolies - 1]
@@ -904,6 +918,90 @@ static inline void CalcSample(float* pCurr, const float* pPrev, float fVelocCoef
 		*pCurr = 1.0f;
 }
 
+//the information needed to step a range of rows of the wave propagation
+struct SWavePropStep
+{
+	//the first polygrid cell of the buffer being written and the buffer being read
+	float*			m_pCurr;
+	const float*	m_pPrev;
+
+	//the number of cells in a row, and the distance between rows including the kernal padding
+	uint32			m_nWidth;
+	uint32			m_nRowSize;
+
+	float			m_fVelocCoeff;
+	float			m_fAccelCoeff;
+	float			m_fDampen;
+};
+
+//steps the rows [nBeginRow, nEndRow) of the wave propagation. Each row only reads from the
+//previous buffer, so any number of row ranges can be updated at the same time
+static void UpdateWaveRows(const SWavePropStep& Step, uint32 nBeginRow, uint32 nEndRow)
+{
+	const uint32 nRowSize = Step.m_nRowSize;
+
+#if defined(POLYGRID_USE_SSE)
+	const __m128 vVelocCoeff	= _mm_set1_ps(Step.m_fVelocCoeff);
+	const __m128 vAccelCoeff	= _mm_set1_ps(Step.m_fAccelCoeff);
+	const __m128 vDampen		= _mm_set1_ps(Step.m_fDampen);
+	const __m128 vCenterScale	= _mm_set1_ps(8.0f);
+	const __m128 vMin			= _mm_set1_ps(-1.0f);
+	const __m128 vMax			= _mm_set1_ps(1.0f);
+#endif
+
+	for(uint32 nY = nBeginRow; nY < nEndRow; nY++)
+	{
+		float* pCurr		= Step.m_pCurr + nY * nRowSize;
+		const float* pPrev	= Step.m_pPrev + nY * nRowSize;
+
+		uint32 nX = 0;
+
+#if defined(POLYGRID_USE_SSE)
+		//run four cells at a time, this performs the same operations in the same order as CalcSample
+		for(; nX + 4 <= Step.m_nWidth; nX += 4)
+		{
+			const float* pSrc = pPrev + nX;
+			__m128 vCenter = _mm_loadu_ps(pSrc);
+
+			__m128 vResult = _mm_add_ps(_mm_loadu_ps(pSrc - nRowSize - 1), _mm_loadu_ps(pSrc - nRowSize));
+			vResult = _mm_add_ps(vResult, _mm_loadu_ps(pSrc - nRowSize + 1));
+			vResult = _mm_add_ps(vResult, _mm_loadu_ps(pSrc - 1));
+			vResult = _mm_sub_ps(vResult, _mm_mul_ps(vCenter, vCenterScale));
+			vResult = _mm_add_ps(vResult, _mm_loadu_ps(pSrc + 1));
+			vResult = _mm_add_ps(vResult, _mm_loadu_ps(pSrc + nRowSize - 1));
+			vResult = _mm_add_ps(vResult, _mm_loadu_ps(pSrc + nRowSize));
+			vResult = _mm_add_ps(vResult, _mm_loadu_ps(pSrc + nRowSize + 1));
+
+			__m128 vOld = _mm_loadu_ps(pCurr + nX);
+			__m128 vNew = _mm_add_ps(vCenter, _mm_mul_ps(_mm_sub_ps(vCenter, vOld), vVelocCoeff));
+			vNew = _mm_add_ps(vNew, _mm_mul_ps(vResult, vAccelCoeff));
+			vNew = _mm_mul_ps(vNew, vDampen);
+
+			_mm_storeu_ps(pCurr + nX, _mm_max_ps(_mm_min_ps(vNew, vMax), vMin));
+		}
+#endif
+
+		//and handle whatever is left
+		for(; nX < Step.m_nWidth; nX++)
+		{
+			CalcSample(pCurr + nX, pPrev + nX, Step.m_fVelocCoeff, Step.m_fAccelCoeff, Step.m_fDampen, nRowSize);
+		}
+	}
+}
+
+//job system entry point for updating a range of rows
+static void UpdateWaveRowsJob(void* pData, uint32 nBegin, uint32 nEnd)
+{
+	UpdateWaveRows(*(const SWavePropStep*)pData, nBegin, nEnd);
+}
+
+//steps all of the rows of the wave propagation, split into bands across the job system
+static void UpdateWaveRowsInJobs(SWavePropStep& Step, uint32 nNumRows, CLTJobSystem* pJobSystem)
+{
+	uint32 nRowsPerJob = LTMAX(knCellsPerJob / Step.m_nWidth, (uint32)1);
+	pJobSystem->ParallelFor(nNumRows, nRowsPerJob, UpdateWaveRowsJob, &Step, "PolyGridWaveProp");
+}
+
 void CPolyGridFX::UpdateWaveProp(float fFrameTime)
 {
 	//avoid any updates with insignificant time elapses
@@ -987,44 +1085,40 @@ void CPolyGridFX::UpdateWaveProp(float fFrameTime)
 		}
 	}
 
+	SWavePropStep Step;
+
 	//the width of a row in the wave prop buffer
-	uint32 nWaveBufferRowSize = knKernalSize * 2 + m_dwNumPoliesX;
+	Step.m_nWidth	= m_dwNumPoliesX;
+	Step.m_nRowSize	= knKernalSize * 2 + m_dwNumPoliesX;
 
 	//get our primary buffer, starting at the actual polygrid data
-	float* pCurr = GetBufferAt(nCurrBufferIndex, 0, 0);
+	Step.m_pCurr = GetBufferAt(nCurrBufferIndex, 0, 0);
 
 	//now get this buffer which for the duration of this function is still our
 	//secondary buffer, skipping over the kernal buffer
-	const float* pPrev = GetBufferAt(nPrevBufferIndex, 0, 0);
+	Step.m_pPrev = GetBufferAt(nPrevBufferIndex, 0, 0);
 
 	//need to make sure that the dampening scale is not frame rate dependant, so
 	//that for every second, that amount of energy will be left in the system
-	float fDampen = (float)pow(m_fDampenScale, fFrameTime);
+	Step.m_fDampen = (float)pow(m_fDampenScale, fFrameTime);
 
 	//sanity check...
-	assert(fDampen <= 1.0f);
+	assert(Step.m_fDampen <= 1.0f);
 
 	//precalculate some variables
 	float fSpringForce = (m_fSpringCoeff * kfInvWaterMass);
-	float fAccelCoeff = fSpringForce * fFrameTime * fFrameTime;
-	float fVelocCoeff = fFrameTime / m_fPrevFrameTime;
-
-	uint32 nX, nY;
+	Step.m_fAccelCoeff = fSpringForce * fFrameTime * fFrameTime;
+	Step.m_fVelocCoeff = fFrameTime / m_fPrevFrameTime;
 
-	for(nY = 0; nY < m_dwNumPoliesY; nY++)
+	//large grids are split into bands of rows across the job system
+	CLTJobSystem* pJobSystem = g_pGameClientShell->GetJobSystem();
+	if((m_dwNumPoliesX * m_dwNumPoliesY >= knMinCellsForJobs) && (pJobSystem->GetNumWorkers() > 0))
 	{
-		for(nX = 0; nX < m_dwNumPoliesX; nX++)
-		{
-			CalcSample(pCurr, pPrev, fVelocCoeff, fAccelCoeff, fDampen, nWaveBufferRowSize);
-
-			//update our pointers
-			pCurr++;
-			pPrev++;
-		}
-
-		//now update our current pointers to skip over the kernal buffers on either side
-		pPrev += knKernalSize * 2;
-		pCurr += knKernalSize * 2;
+		UpdateWaveRowsInJobs(Step, m_dwNumPoliesY, pJobSystem);
+	}
+	else
+	{
+		UpdateWaveRows(Step, 0, m_dwNumPoliesY);
 	}
 
 	//switch our buffer to be the other one
@@ -1661,3 +1755,125 @@ void CPolyGridFX::DoPolyGridSplash( HOBJECT hObject, LTVector const& vSplashPos,
 	collisionData.fImpulse = fImpulse;
 	ClientPhysicsCollisionMgr::Instance().HandleRigidBodyCollision( collisionData );
 }
+
+#ifndef _FINAL
+
+//the wave propagation loop from before it was vectorized, used as the reference by the benchmark
+static void UpdateWaveRowsScalar(const SWavePropStep& Step, uint32 nNumRows)
+{
+	float* pCurr = Step.m_pCurr;
+	const float* pPrev = Step.m_pPrev;
+
+	for(uint32 nY = 0; nY < nNumRows; nY++)
+	{
+		for(uint32 nX = 0; nX < Step.m_nWidth; nX++)
+		{
+			CalcSample(pCurr, pPrev, Step.m_fVelocCoeff, Step.m_fAccelCoeff, Step.m_fDampen, Step.m_nRowSize);
+
+			//update our pointers
+			pCurr++;
+			pPrev++;
+		}
+
+		//now update our current pointers to skip over the kernal buffers on either side
+		pPrev += knKernalSize * 2;
+		pCurr += knKernalSize * 2;
+	}
+}
+
+//the ways the benchmark can step the wave propagation
+enum EWavePropPath
+{
+	eWavePropPath_Scalar,
+	eWavePropPath_Rows,
+	eWavePropPath_Jobs,
+
+	eWavePropPath_Count
+};
+
+void CPolyGridFX::RunBenchmark(uint32 nNumFrames)
+{
+	if(nNumFrames == 0)
+		nNumFrames = 100;
+
+	static const uint32 s_aGridSizes[] = { 16, 32, 64, 128, 256, 512 };
+
+	CLTJobSystem* pJobSystem = g_pGameClientShell->GetJobSystem();
+	uint32 nFailures = 0;
+
+	for(uint32 nSize = 0; nSize < LTARRAYSIZE(s_aGridSizes); nSize++)
+	{
+		uint32 nGridSize = s_aGridSizes[nSize];
+
+		SWavePropStep Step;
+		Step.m_nWidth		= nGridSize;
+		Step.m_nRowSize		= nGridSize + knKernalSize * 2;
+		Step.m_fVelocCoeff	= 1.0f;
+		Step.m_fAccelCoeff	= 0.05f;
+		Step.m_fDampen		= 0.99f;
+
+		//the same random water for every path, with a still border around it like the real buffers
+		uint32 nBufferSize = Step.m_nRowSize * (nGridSize + knKernalSize * 2);
+		std::vector<float> aStart(nBufferSize, 0.0f);
+		uint32 nRandom = nGridSize;
+		for(uint32 nY = 0; nY < nGridSize; nY++)
+		{
+			for(uint32 nX = 0; nX < nGridSize; nX++)
+			{
+				nRandom = nRandom * 1664525 + 1013904223;
+				aStart[(nY + knKernalSize) * Step.m_nRowSize + nX + knKernalSize] = (float)(nRandom >> 8) / (float)(1 << 24) - 0.5f;
+			}
+		}
+
+		double fCellsPerMS[eWavePropPath_Count];
+		std::vector<float> aResults[eWavePropPath_Count];
+		for(uint32 nPath = 0; nPath < eWavePropPath_Count; nPath++)
+		{
+			std::vector<float> aBuffers[2];
+			aBuffers[0] = aStart;
+			aBuffers[1] = aStart;
+
+			uint32 nCurr = 0;
+			TLTPrecisionTime StartTime = LTTimeUtils::GetPrecisionTime();
+			for(uint32 nFrame = 0; nFrame < nNumFrames; nFrame++)
+			{
+				Step.m_pCurr = &aBuffers[nCurr][Step.m_nRowSize * knKernalSize + knKernalSize];
+				Step.m_pPrev = &aBuffers[!nCurr][Step.m_nRowSize * knKernalSize + knKernalSize];
+
+				if(nPath == eWavePropPath_Scalar)
+					UpdateWaveRowsScalar(Step, nGridSize);
+				else if(nPath == eWavePropPath_Rows)
+					UpdateWaveRows(Step, 0, nGridSize);
+				else
+					UpdateWaveRowsInJobs(Step, nGridSize, pJobSystem);
+
+				nCurr = !nCurr;
+			}
+			double fMS = LTTimeUtils::GetPrecisionTimeIntervalMS(StartTime, LTTimeUtils::GetPrecisionTime());
+
+			fCellsPerMS[nPath] = (double)nGridSize * nGridSize * nNumFrames / LTMAX(fMS, 0.001);
+			aResults[nPath].swap(aBuffers[!nCurr]);
+		}
+
+		//the other paths must end up with the same water as the reference
+		float fMaxError = 0.0f;
+		for(uint32 nPath = eWavePropPath_Rows; nPath < eWavePropPath_Count; nPath++)
+		{
+			for(uint32 nCell = 0; nCell < nBufferSize; nCell++)
+			{
+				fMaxError = LTMAX(fMaxError, (float)fabs(aResults[nPath][nCell] - aResults[eWavePropPath_Scalar][nCell]));
+			}
+		}
+		if(fMaxError > 0.0001f)
+			nFailures++;
+
+		g_pLTClient->CPrint("PolyGridBenchmark: %ux%u, %u frames: scalar %.0f cells/ms, rows %.0f cells/ms, %u workers %.0f cells/ms%s, max error %g",
+			nGridSize, nGridSize, nNumFrames, fCellsPerMS[eWavePropPath_Scalar], fCellsPerMS[eWavePropPath_Rows],
+			pJobSystem->GetNumWorkers(), fCellsPerMS[eWavePropPath_Jobs],
+			(nGridSize * nGridSize >= knMinCellsForJobs) ? "" : " (not used at this size)", fMaxError);
+	}
+
+	g_pLTClient->CPrint("PolyGridBenchmark: %u failures - %s", nFailures, (nFailures == 0) ? "PASSED" : "FAILED");
+}
+
+#endif
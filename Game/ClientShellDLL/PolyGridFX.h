@@ -182,6 +182,13 @@ public :
 	typedef std::vector<CPolyGridFX*, LTAllocator<CPolyGridFX*, LT_MEM_TYPE_CLIENTSHELL> > InstanceList;
 	static InstanceList& GetInstanceList() { return m_lstInstances; }
 
+#ifndef _FINAL
+	//times the wave propagation of generated grids of several sizes with the scalar loop, the
+	//vectorized rows on this thread, and the rows split across the job system, and checks that
+	//they all end up with the same water
+	static void RunBenchmark(uint32 nNumFrames);
+#endif
+
 protected:
 
 	void UpdateSurface();
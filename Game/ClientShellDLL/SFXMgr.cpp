@@ -1241,19 +1241,25 @@ void CSFXMgr::UpdateDynamicSpecialFX()
 
 	for (int j=0; j < DYN_ARRAY_SIZE; j++)
 	{
-		int nNumSFX  = m_dynSFXLists[j].GetSize();
+		CSpecialFXList& List = m_dynSFXLists[j];
+		if (List.IsEmpty()) continue;
 
-		for (int i=0; i < nNumSFX; i++)
+		// Walk the packed array so only the special fx that exist are
+		// visited.  Updating a special fx may remove others from the list,
+		// so let the list keep track of which have been visited...
+
+		List.BeginIteration();
+
+		CSpecialFX* pSFX;
+		while ((pSFX = List.GetNextIteration()) != NULL)
 		{
-			CSpecialFX* pSFX = m_dynSFXLists[j][i];
-			if( pSFX )
+			if (!pSFX->Update())
 			{
-				if (!pSFX->Update())
-				{
-					m_dynSFXLists[j].Remove(pSFX);
-				}
+				List.Remove(pSFX);
 			}
 		}
+
+		List.EndIteration();
 	}
 }
 
@@ -1270,17 +1276,16 @@ void CSFXMgr::RemoveDynamicSpecialFX(HOBJECT hObj)
 {
 	for (int j=0; j < DYN_ARRAY_SIZE; j++)
 	{
-		int nNumSFX  = m_dynSFXLists[j].GetSize();
+		CSpecialFXList& List = m_dynSFXLists[j];
+		if (List.IsEmpty()) continue;
 
-		for (int i=0; i < nNumSFX; i++)
-		{
-			// More than one sfx may have the same server handle, so let them
-			// all have an opportunity to remove themselves...
+		// More than one sfx may have the same server handle, so let them
+		// all have an opportunity to remove themselves...
 
-			if (m_dynSFXLists[j][i] && m_dynSFXLists[j][i]->GetServerObj() == hObj)
-			{
-				m_dynSFXLists[j][i]->WantRemove();
-			}
+		unsigned int nNumSFX = List.GetSize();
+		for (unsigned int i=List.FindSlotByServerObj(hObj); i < nNumSFX; i=List.FindSlotByServerObj(hObj, i+1))
+		{
+			List[i]->WantRemove();
 		}
 	}
 }
@@ -1321,15 +1326,7 @@ CSpecialFX* CSFXMgr::FindSpecialFX(uint8 nType, HLOCALOBJ hObj)
 {
 	if (0 <= nType && nType < DYN_ARRAY_SIZE)
 	{
-		int nNumSFX  = m_dynSFXLists[nType].GetSize();
-
-		for (int i=0; i < nNumSFX; i++)
-		{
-			if (m_dynSFXLists[nType][i] && m_dynSFXLists[nType][i]->GetServerObj() == hObj)
-			{
-				return m_dynSFXLists[nType][i];
-			}
-		}
+		return m_dynSFXLists[nType].FindByServerObj(hObj);
 	}
 
     return NULL;
@@ -1546,50 +1543,50 @@ void CSFXMgr::OnModelKey(HLOCALOBJ hObj, ArgList *pArgs, ANIMTRACKERID hTrackerI
 
 	// Only pass these on to the player (and AI)...
 
-	int nNumSFX = m_dynSFXLists[SFX_CHARACTER_ID].GetSize();
+	CSpecialFXList& List = m_dynSFXLists[SFX_CHARACTER_ID];
+	unsigned int nNumSFX = List.GetSize();
 
-    int i;
-    for (i=0; i < nNumSFX; i++)
+	for (unsigned int i=List.FindSlotByServerObj(hObj); i < nNumSFX; i=List.FindSlotByServerObj(hObj, i+1))
 	{
-		if (m_dynSFXLists[SFX_CHARACTER_ID][i] && m_dynSFXLists[SFX_CHARACTER_ID][i]->GetServerObj() == hObj)
-		{
-			m_dynSFXLists[SFX_CHARACTER_ID][i]->OnModelKey(hObj, pArgs, hTrackerID);
-		}
+		List[i]->OnModelKey(hObj, pArgs, hTrackerID);
 	}
 }
 
 CCharacterFX* CSFXMgr::GetCharacterFX(HOBJECT hObject)
 {
-	CCharacterFX* pCharacterFX = NULL;
-	int cCharacterFX  = m_dynSFXLists[SFX_CHARACTER_ID].GetSize();
-
-	for ( int iCharacterFX = 0 ; iCharacterFX < cCharacterFX ; iCharacterFX++ )
-	{
-		pCharacterFX = (CCharacterFX*)m_dynSFXLists[SFX_CHARACTER_ID][iCharacterFX];
-		if (pCharacterFX && pCharacterFX->GetServerObj() == hObject)
-		{
-			return pCharacterFX;
-		}
-	}
-
-	return NULL;
+	return (CCharacterFX*)m_dynSFXLists[SFX_CHARACTER_ID].FindByServerObj(hObject);
 }
 
 
 CCharacterFX* CSFXMgr::GetCharacterFromHitBox(HOBJECT hHitBox)
 {
+	CSpecialFXList& List = m_dynSFXLists[SFX_CHARACTER_ID];
+	if (!hHitBox || List.IsEmpty()) return NULL;
+
+	// Hit boxes are created and recreated by the character fx, so remember
+	// which slot a hit box was last found in and check that first...
+
+	HitBoxCacheEntry& Cache = m_aHitBoxCache[(uint32)((size_t)hHitBox >> 4) & (kNumHitBoxCacheEntries - 1)];
+
 	CCharacterFX* pCharacterFX = NULL;
-	int cCharacterFX  = m_dynSFXLists[SFX_CHARACTER_ID].GetSize();
+	if (Cache.m_hHitBox == hHitBox)
+	{
+		pCharacterFX = (CCharacterFX*)List[Cache.m_nSlot];
+		if (pCharacterFX && pCharacterFX->GetHitBox() == hHitBox)
+		{
+			return pCharacterFX;
+		}
+	}
 
-	for ( int iCharacterFX = 0 ; iCharacterFX < cCharacterFX ; iCharacterFX++ )
+	unsigned int cCharacterFX = List.GetNumItems();
+	for (unsigned int iCharacterFX = 0; iCharacterFX < cCharacterFX; iCharacterFX++)
 	{
-		pCharacterFX = (CCharacterFX*)m_dynSFXLists[SFX_CHARACTER_ID][iCharacterFX];
-		if (pCharacterFX)
+		pCharacterFX = (CCharacterFX*)List.GetDense(iCharacterFX);
+		if (pCharacterFX->GetHitBox() == hHitBox)
 		{
-			if (pCharacterFX->GetHitBox() == hHitBox)
-			{
-				return pCharacterFX;
-			}
+			Cache.m_hHitBox = hHitBox;
+			Cache.m_nSlot	= List.GetDenseSlot(iCharacterFX);
+			return pCharacterFX;
 		}
 	}
 
@@ -1598,18 +1595,15 @@ CCharacterFX* CSFXMgr::GetCharacterFromHitBox(HOBJECT hHitBox)
 
 CCharacterFX* CSFXMgr::GetCharacterFromClientID(uint32 nClientId)
 {
-	CCharacterFX* pCharacterFX = NULL;
-	int cCharacterFX  = m_dynSFXLists[SFX_CHARACTER_ID].GetSize();
+	CSpecialFXList& List = m_dynSFXLists[SFX_CHARACTER_ID];
+	unsigned int cCharacterFX = List.GetNumItems();
 
-	for ( int iCharacterFX = 0 ; iCharacterFX < cCharacterFX ; iCharacterFX++ )
+	for ( unsigned int iCharacterFX = 0 ; iCharacterFX < cCharacterFX ; iCharacterFX++ )
 	{
-		pCharacterFX = (CCharacterFX*)m_dynSFXLists[SFX_CHARACTER_ID][iCharacterFX];
-		if (pCharacterFX)
+		CCharacterFX* pCharacterFX = (CCharacterFX*)List.GetDense(iCharacterFX);
+		if (pCharacterFX->m_cs.bIsPlayer && pCharacterFX->m_cs.nClientID == nClientId)
 		{
-			if (pCharacterFX->m_cs.bIsPlayer && pCharacterFX->m_cs.nClientID == nClientId)
-			{
-				return pCharacterFX;
-			}
+			return pCharacterFX;
 		}
 	}
 
@@ -1619,57 +1613,27 @@ CCharacterFX* CSFXMgr::GetCharacterFromClientID(uint32 nClientId)
 
 CLadderFX* CSFXMgr::GetLadderFX(HOBJECT hObject)
 {
-	CLadderFX* pLadderFX = NULL;
-	int cLadderFX  = m_dynSFXLists[SFX_LADDER_ID].GetSize();
-
-	for ( int iLadderFX = 0 ; iLadderFX < cLadderFX ; iLadderFX++ )
-	{
-		pLadderFX = (CLadderFX*)m_dynSFXLists[SFX_LADDER_ID][iLadderFX];
-		if (pLadderFX && pLadderFX->GetServerObj() == hObject)
-		{
-			return pLadderFX;
-		}
-	}
-
-	return NULL;
+	return (CLadderFX*)m_dynSFXLists[SFX_LADDER_ID].FindByServerObj(hObject);
 }
 
 CSpecialMoveFX* CSFXMgr::GetSpecialMoveFX(HOBJECT hObject)
 {
-	CSpecialMoveFX* pSpecialMoveFX = NULL;
-	int cSpecialMoveFX  = m_dynSFXLists[SFX_SPECIALMOVE_ID].GetSize();
-
-	for ( int iSpecialMoveFX = 0 ; iSpecialMoveFX < cSpecialMoveFX ; iSpecialMoveFX++ )
+	CSpecialMoveFX* pSpecialMoveFX = (CSpecialMoveFX*)m_dynSFXLists[SFX_SPECIALMOVE_ID].FindByServerObj(hObject);
+	if (pSpecialMoveFX)
 	{
-		pSpecialMoveFX = (CSpecialMoveFX*)m_dynSFXLists[SFX_SPECIALMOVE_ID][iSpecialMoveFX];
-		if (pSpecialMoveFX && pSpecialMoveFX->GetServerObj() == hObject)
-		{
-			return pSpecialMoveFX;
-		}
+		return pSpecialMoveFX;
 	}
 
-	CFinishingMoveFX* pFinishingMoveFX = NULL;
-	int cFinishingMoveFX  = m_dynSFXLists[SFX_FINISHINGMOVE_ID].GetSize();
-
-	for ( int iFinishingMoveFX = 0 ; iFinishingMoveFX < cFinishingMoveFX ; iFinishingMoveFX++ )
+	CFinishingMoveFX* pFinishingMoveFX = (CFinishingMoveFX*)m_dynSFXLists[SFX_FINISHINGMOVE_ID].FindByServerObj(hObject);
+	if (pFinishingMoveFX)
 	{
-		pFinishingMoveFX = (CFinishingMoveFX*)m_dynSFXLists[SFX_FINISHINGMOVE_ID][iFinishingMoveFX];
-		if (pFinishingMoveFX && pFinishingMoveFX->GetServerObj() == hObject)
-		{
-			return pFinishingMoveFX;
-		}
+		return pFinishingMoveFX;
 	}
 
-	CEntryToolLockFX* pEntryToolLockFX = NULL;
-	int cEntryToolLockFX  = m_dynSFXLists[SFX_ENTRYTOOLLOCK_ID].GetSize();
-
-	for ( int iEntryToolLockFX = 0 ; iEntryToolLockFX < cEntryToolLockFX ; iEntryToolLockFX++ )
+	CEntryToolLockFX* pEntryToolLockFX = (CEntryToolLockFX*)m_dynSFXLists[SFX_ENTRYTOOLLOCK_ID].FindByServerObj(hObject);
+	if (pEntryToolLockFX)
 	{
-		pEntryToolLockFX = (CEntryToolLockFX*)m_dynSFXLists[SFX_ENTRYTOOLLOCK_ID][iEntryToolLockFX];
-		if (pEntryToolLockFX && pEntryToolLockFX->GetServerObj() == hObject)
-		{
-			return pEntryToolLockFX;
-		}
+		return pEntryToolLockFX;
 	}
 
 	// Check for evidence only if we're holding the proper tool
@@ -1679,16 +1643,10 @@ CSpecialMoveFX* CSFXMgr::GetSpecialMoveFX(HOBJECT hObject)
 		uint8 nActivateType = pWeapon->GetActivationType();
 		if (IS_ACTIVATE_FORENSIC(nActivateType))
 		{
-			CForensicObjectFX* pForensicObjectFX = NULL;
-			int cForensicObjectFX  = m_dynSFXLists[SFX_FORENSICOBJECT_ID].GetSize();
-
-			for ( int iForensicObjectFX = 0 ; iForensicObjectFX < cForensicObjectFX ; iForensicObjectFX++ )
+			CForensicObjectFX* pForensicObjectFX = (CForensicObjectFX*)m_dynSFXLists[SFX_FORENSICOBJECT_ID].FindByServerObj(hObject);
+			if (pForensicObjectFX)
 			{
-				pForensicObjectFX = (CForensicObjectFX*)m_dynSFXLists[SFX_FORENSICOBJECT_ID][iForensicObjectFX];
-				if (pForensicObjectFX && pForensicObjectFX->GetServerObj() == hObject)
-				{
-					return pForensicObjectFX;
-				}
+				return pForensicObjectFX;
 			}
 		}
 	}
@@ -1710,22 +1668,6 @@ CTurretFX* CSFXMgr::GetTurretFX( HOBJECT hObject )
 	if( !hObject || (m_dynSFXLists[SFX_TURRET_ID].GetNumItems( ) == 0) )
 		return NULL;
 
-	CTurretFX *pTurretFX = NULL;
-	int cTurretFX = m_dynSFXLists[SFX_TURRET_ID].GetSize( );
-
-	// Search the 
-	for( int nTurret = 0; nTurret < cTurretFX; ++nTurret )
-	{
-		pTurretFX = (CTurretFX*)m_dynSFXLists[SFX_TURRET_ID][nTurret];
-		if( pTurretFX && pTurretFX->GetServerObj( ) == hObject )
-		{
-			// Success...
-			return pTurretFX;
-		}
-	}
-
-	// Not found...
-	return NULL;
-
+	return (CTurretFX*)m_dynSFXLists[SFX_TURRET_ID].FindByServerObj( hObject );
 }
 
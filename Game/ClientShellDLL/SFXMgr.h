@@ -38,7 +38,14 @@ class CSFXMgr
 {
 	public :
 
-        CSFXMgr()  {}
+        CSFXMgr()
+		{
+			for (uint32 i=0; i < kNumHitBoxCacheEntries; i++)
+			{
+				m_aHitBoxCache[i].m_hHitBox = NULL;
+				m_aHitBoxCache[i].m_nSlot	= 0;
+			}
+		}
 		~CSFXMgr() {}
 
         bool   Init(ILTClient* pClientDE);
@@ -100,6 +107,19 @@ class CSFXMgr
 
 		CSpecialFXList  m_dynSFXLists[DYN_ARRAY_SIZE]; // Lists of dynamic special fx
 		CSpecialFXList	m_cameraSFXList;				// List of camera special fx
+
+		// Character fx slots that hit boxes were last found in.  Entries are
+		// only hints and are checked against the character fx before use.
+
+		struct HitBoxCacheEntry
+		{
+			HOBJECT			m_hHitBox;
+			unsigned int	m_nSlot;
+		};
+
+		enum { kNumHitBoxCacheEntries = 16 };
+
+		HitBoxCacheEntry m_aHitBoxCache[kNumHitBoxCacheEntries];
 };
 
 //////////////////////////////////////////////////////////////////////////////
@@ -5,15 +5,20 @@
 #include <float.h>
 #include "iperformancemonitor.h"
 
+//the plane distances of a batch of polygons are evaluated four vertices at a time with SSE on the x86 platforms
+#if defined(PLATFORM_WIN32) || defined(PLATFORM_LINUX)
+#	define SHATTER_USE_SSE
+#	include <xmmintrin.h>
+#endif
+
 static CTimedSystem g_tsClientShatter("GameClient_Shatter", "GameClient");
 
 //----------------------------------------------------------------------------------------------------
 // Defines
 //----------------------------------------------------------------------------------------------------
 
-//the maximum number of vertices that a piece of debris can have. This is to prevent any incredibly
-//detailed pieces of debris
-#define MAX_DEBRIS_VERTICES		16
+//the number of debris slots that the debris pool allocates at a time
+#define DEBRIS_POOL_BLOCK_SLOTS	64
 
 //----------------------------------------------------------------------------------------------------
 // CWorkingPolyStack
@@ -119,6 +124,296 @@ private:
 	uint32			m_nTopPolyOffset;
 };
 
+//----------------------------------------------------------------------------------------------------
+// CDebrisPolyBatch
+//
+//holds a collection of polygons with the vertices stored as a structure of arrays. This allows the
+//distance of every vertex in the batch to a plane to be found in a single pass over the data (four
+//vertices at a time where SSE is available), which makes it well suited to splitting a large number
+//of polygons against the same plane. Each polygon has an additional 32 bits associated with it that
+//is carried through to the polygons that are split from it
+//----------------------------------------------------------------------------------------------------
+class CDebrisPolyBatch
+{
+public:
+
+	//what a polygon in the batch looks like
+	struct SBatchPoly
+	{
+		//the index of the first vertex of this polygon
+		uint32			m_nFirstVert;
+
+		//the number of vertices
+		uint32			m_nNumVerts;
+
+		//the user code
+		uint32			m_nCode;
+	};
+
+	//called to remove all polygons from the batch while keeping the memory around
+	void Clear()
+	{
+		m_Polys.resize(0);
+		m_X.resize(0);
+		m_Y.resize(0);
+		m_Z.resize(0);
+		m_U.resize(0);
+		m_V.resize(0);
+	}
+
+	//called to add a polygon to the batch. Just like the working poly stack, polygons with less than
+	//three vertices are ignored
+	void AddPoly(uint32 nCode, uint32 nNumVerts, const SDebrisVert* pVerts)
+	{
+		if(nNumVerts < 3)
+			return;
+
+		BeginPoly(nCode);
+		for(uint32 nCurrVert = 0; nCurrVert < nNumVerts; nCurrVert++)
+		{
+			AddVert(pVerts[nCurrVert].m_vPos.x, pVerts[nCurrVert].m_vPos.y, pVerts[nCurrVert].m_vPos.z,
+					pVerts[nCurrVert].m_vUV.x, pVerts[nCurrVert].m_vUV.y);
+		}
+		EndPoly();
+	}
+
+	//called to determine the number of polygons in the batch
+	uint32 GetNumPolys() const
+	{
+		return m_Polys.size();
+	}
+
+	//called to access a polygon within the batch
+	const SBatchPoly& GetPoly(uint32 nPoly) const
+	{
+		return m_Polys[nPoly];
+	}
+
+	//called to copy the vertices of a polygon out of the batch. The output must have room for all of
+	//the vertices of the polygon
+	void GetPolyVerts(uint32 nPoly, SDebrisVert* pVerts) const
+	{
+		const SBatchPoly& Poly = m_Polys[nPoly];
+		for(uint32 nCurrVert = 0; nCurrVert < Poly.m_nNumVerts; nCurrVert++)
+		{
+			uint32 nSrcVert = Poly.m_nFirstVert + nCurrVert;
+			pVerts[nCurrVert].m_vPos.Init(m_X[nSrcVert], m_Y[nSrcVert], m_Z[nSrcVert]);
+			pVerts[nCurrVert].m_vUV.Init(m_U[nSrcVert], m_V[nSrcVert]);
+		}
+	}
+
+	//called to split every polygon in this batch against the provided plane. The front and back
+	//polygons are placed into the output batch (which is cleared first) and keep the code of the
+	//polygon they were split from. This follows the same rules as CShatterEffect::SplitPoly,
+	//including the limit of MAX_DEBRIS_VERTICES on each output polygon
+	void Split(const LTPlane& SplitPlane, CDebrisPolyBatch& Out)
+	{
+		Out.Clear();
+
+		//find the distance to the plane of every vertex in the batch
+		CalcPlaneDistances(SplitPlane);
+
+		//buffers to hold the front and back results for a single polygon, as indices into our vertices
+		//along with the interpolant towards the next vertex
+		uint32 nFrontSrc[MAX_DEBRIS_VERTICES], nBackSrc[MAX_DEBRIS_VERTICES];
+		float fFrontInterp[MAX_DEBRIS_VERTICES], fBackInterp[MAX_DEBRIS_VERTICES];
+
+		for(TPolyList::const_iterator itPoly = m_Polys.begin(); itPoly != m_Polys.end(); itPoly++)
+		{
+			const SBatchPoly& Poly = *itPoly;
+
+			uint32 nFrontVerts = 0;
+			uint32 nBackVerts = 0;
+
+			uint32 nPrev		= Poly.m_nFirstVert + Poly.m_nNumVerts - 1;
+			float fPrevDist		= m_Dists[nPrev];
+			bool bPrevIn		= (fPrevDist >= 0.0f);
+
+			for(uint32 nCurr = Poly.m_nFirstVert; nCurr < Poly.m_nFirstVert + Poly.m_nNumVerts; nCurr++)
+			{
+				float fCurrDist		= m_Dists[nCurr];
+				bool bCurrIn		= (fCurrDist >= 0.0f);
+
+				//add the start vertex of the edge to whichever side it is on
+				if(bPrevIn)
+				{
+					if(nFrontVerts < MAX_DEBRIS_VERTICES)
+					{
+						nFrontSrc[nFrontVerts] = nPrev;
+						fFrontInterp[nFrontVerts] = 0.0f;
+						nFrontVerts++;
+					}
+				}
+				else
+				{
+					if(nBackVerts < MAX_DEBRIS_VERTICES)
+					{
+						nBackSrc[nBackVerts] = nPrev;
+						fBackInterp[nBackVerts] = 0.0f;
+						nBackVerts++;
+					}
+				}
+
+				//and if the edge crosses the plane, add the intersection to both sides
+				if(bPrevIn != bCurrIn)
+				{
+					float fInterp = fPrevDist / (fPrevDist - fCurrDist);
+
+					if(nFrontVerts < MAX_DEBRIS_VERTICES)
+					{
+						nFrontSrc[nFrontVerts] = nPrev;
+						fFrontInterp[nFrontVerts] = fInterp;
+						nFrontVerts++;
+					}
+
+					if(nBackVerts < MAX_DEBRIS_VERTICES)
+					{
+						nBackSrc[nBackVerts] = nPrev;
+						fBackInterp[nBackVerts] = fInterp;
+						nBackVerts++;
+					}
+				}
+
+				//and update our previous state
+				nPrev		= nCurr;
+				fPrevDist	= fCurrDist;
+				bPrevIn		= bCurrIn;
+			}
+
+			//now build up the output polygons, finding the next vertex of each edge from the
+			//previous vertex of the edge
+			Out.AddSplitPoly(*this, Poly, nFrontVerts, nFrontSrc, fFrontInterp);
+			Out.AddSplitPoly(*this, Poly, nBackVerts, nBackSrc, fBackInterp);
+		}
+	}
+
+private:
+
+	//called to start adding a new polygon to the batch
+	void BeginPoly(uint32 nCode)
+	{
+		SBatchPoly NewPoly;
+		NewPoly.m_nFirstVert	= m_X.size();
+		NewPoly.m_nNumVerts		= 0;
+		NewPoly.m_nCode			= nCode;
+		m_Polys.push_back(NewPoly);
+	}
+
+	//called to add a vertex to the polygon that is being added
+	void AddVert(float fX, float fY, float fZ, float fU, float fV)
+	{
+		m_X.push_back(fX);
+		m_Y.push_back(fY);
+		m_Z.push_back(fZ);
+		m_U.push_back(fU);
+		m_V.push_back(fV);
+		m_Polys.back().m_nNumVerts++;
+	}
+
+	//called once all of the vertices of a polygon have been added
+	void EndPoly()
+	{
+		//discard polygons that were clipped away to nothing, just like the working poly stack
+		SBatchPoly& Poly = m_Polys.back();
+		if(Poly.m_nNumVerts < 3)
+		{
+			m_X.resize(Poly.m_nFirstVert);
+			m_Y.resize(Poly.m_nFirstVert);
+			m_Z.resize(Poly.m_nFirstVert);
+			m_U.resize(Poly.m_nFirstVert);
+			m_V.resize(Poly.m_nFirstVert);
+			m_Polys.pop_back();
+		}
+	}
+
+	//called to add a polygon produced by splitting a polygon in another batch. Each vertex is given as
+	//the index of the start of an edge in the source, and the interpolant along that edge
+	void AddSplitPoly(	const CDebrisPolyBatch& Src, const SBatchPoly& SrcPoly, uint32 nNumVerts,
+						const uint32* pSrcVerts, const float* pInterps)
+	{
+		if(nNumVerts < 3)
+			return;
+
+		uint32 nSrcEnd = SrcPoly.m_nFirstVert + SrcPoly.m_nNumVerts;
+
+		BeginPoly(SrcPoly.m_nCode);
+		for(uint32 nCurrVert = 0; nCurrVert < nNumVerts; nCurrVert++)
+		{
+			uint32 nStart	= pSrcVerts[nCurrVert];
+			float fInterp	= pInterps[nCurrVert];
+
+			if(fInterp == 0.0f)
+			{
+				AddVert(Src.m_X[nStart], Src.m_Y[nStart], Src.m_Z[nStart], Src.m_U[nStart], Src.m_V[nStart]);
+			}
+			else
+			{
+				uint32 nEnd = (nStart + 1 < nSrcEnd) ? nStart + 1 : SrcPoly.m_nFirstVert;
+				AddVert(Src.m_X[nStart] + (Src.m_X[nEnd] - Src.m_X[nStart]) * fInterp,
+						Src.m_Y[nStart] + (Src.m_Y[nEnd] - Src.m_Y[nStart]) * fInterp,
+						Src.m_Z[nStart] + (Src.m_Z[nEnd] - Src.m_Z[nStart]) * fInterp,
+						Src.m_U[nStart] + (Src.m_U[nEnd] - Src.m_U[nStart]) * fInterp,
+						Src.m_V[nStart] + (Src.m_V[nEnd] - Src.m_V[nStart]) * fInterp);
+			}
+		}
+		EndPoly();
+	}
+
+	//called to find the distance of every vertex in the batch to the plane
+	void CalcPlaneDistances(const LTPlane& Plane)
+	{
+		const uint32 nNumVerts = m_X.size();
+		m_Dists.resize(nNumVerts);
+
+		if(!nNumVerts)
+			return;
+
+		const float* pX = &m_X[0];
+		const float* pY = &m_Y[0];
+		const float* pZ = &m_Z[0];
+		float* pDists	= &m_Dists[0];
+
+		uint32 nCurrVert = 0;
+
+#if defined(SHATTER_USE_SSE)
+		//run four vertices at a time, this performs the same operations in the same order as LTPlane::DistTo
+		const __m128 vNormalX	= _mm_set1_ps(Plane.m_Normal.x);
+		const __m128 vNormalY	= _mm_set1_ps(Plane.m_Normal.y);
+		const __m128 vNormalZ	= _mm_set1_ps(Plane.m_Normal.z);
+		const __m128 vDist		= _mm_set1_ps(Plane.m_Dist);
+
+		for(; nCurrVert + 4 <= nNumVerts; nCurrVert += 4)
+		{
+			__m128 vResult = _mm_mul_ps(_mm_loadu_ps(pX + nCurrVert), vNormalX);
+			vResult = _mm_add_ps(vResult, _mm_mul_ps(_mm_loadu_ps(pY + nCurrVert), vNormalY));
+			vResult = _mm_add_ps(vResult, _mm_mul_ps(_mm_loadu_ps(pZ + nCurrVert), vNormalZ));
+			_mm_storeu_ps(pDists + nCurrVert, _mm_sub_ps(vResult, vDist));
+		}
+#endif
+
+		//and handle whatever is left
+		for(; nCurrVert < nNumVerts; nCurrVert++)
+		{
+			pDists[nCurrVert] = Plane.DistTo(LTVector(pX[nCurrVert], pY[nCurrVert], pZ[nCurrVert]));
+		}
+	}
+
+	//the listing of polygons in the batch
+	typedef std::vector<SBatchPoly, LTAllocator<SBatchPoly, LT_MEM_TYPE_CLIENTSHELL> > TPolyList;
+	TPolyList		m_Polys;
+
+	//the components of each vertex in the batch
+	typedef std::vector<float, LTAllocator<float, LT_MEM_TYPE_CLIENTSHELL> > TFloatList;
+	TFloatList		m_X;
+	TFloatList		m_Y;
+	TFloatList		m_Z;
+	TFloatList		m_U;
+	TFloatList		m_V;
+
+	//the distance of each vertex to the last plane that the batch was split against
+	TFloatList		m_Dists;
+};
+
 //----------------------------------------------------------------------------------------------------
 // Utility functions
 //----------------------------------------------------------------------------------------------------
@@ -148,26 +443,25 @@ const T& MemRead(const uint8*& pReadPtr)
 
 //given a working polygon and some additional data, this will create a debris piece from
 //the polygon
-static SDebrisPiece* ConvertWorkingPolyToDebris(uint32 nNumVerts, const SDebrisVert* pVerts,
+static SDebrisPiece* ConvertWorkingPolyToDebris(CDebrisPool& DebrisPool, CShatterEffect* pOwner,
+												uint32 nNumVerts, const SDebrisVert* pVerts,
 												const LTRigidTransform& tCentroid, 
 												const LTRigidTransform& tObjTransform,
 												float fBinormalScale)
 {
 	//allocate the new debris piece with room for the vertices
-	uint8* pNewPieceMem = new uint8 [SDebrisPiece::GetPieceSize(nNumVerts)];
-	if(!pNewPieceMem)
+	SDebrisPiece* pNewPiece = DebrisPool.AllocatePiece(pOwner, nNumVerts);
+	if(!pNewPiece)
 		return NULL;
 
-	//overlay the debris on top of that memory
-	SDebrisPiece* pNewPiece = (SDebrisPiece*)pNewPieceMem;
-
 	//copy over all the data that we have
 	pNewPiece->m_nNumVerts	= nNumVerts;
 	pNewPiece->m_tTransform = tCentroid;
 
-	//clear out the linear velocity
+	//clear out the linear and angular velocity
 	pNewPiece->m_fUpdateDelayS = 0.0f;
 	pNewPiece->m_vLinearVel.Init();
+	pNewPiece->m_vAngularVel.Init();
 
 	//store the binormal scale
 	pNewPiece->m_fBinormalScale	= fBinormalScale;
@@ -223,6 +517,185 @@ static void ConvertTangentSpaceToRotation(const LTVector& vNormal, const LTVecto
 
 
 
+//----------------------------------------------------------------------------------------------------
+// CShatterWorkspace
+//----------------------------------------------------------------------------------------------------
+CShatterWorkspace::CShatterWorkspace() :
+	m_pRadialBatches(NULL)
+{
+}
+
+CShatterWorkspace::~CShatterWorkspace()
+{
+	Term();
+}
+
+//called to free all of the memory held by the workspace
+void CShatterWorkspace::Term()
+{
+	//swap with empty lists since resizing would hold onto the memory
+	TSourcePolyList().swap(m_SourcePolys);
+	TVertList().swap(m_FragmentVerts);
+
+	debug_deletea(m_pRadialBatches);
+	m_pRadialBatches = NULL;
+}
+
+//called to access the two batches that the glass radial splits flip between, allocating them
+//if they haven't been already
+CDebrisPolyBatch* CShatterWorkspace::GetRadialBatches()
+{
+	if(!m_pRadialBatches)
+		m_pRadialBatches = debug_newa(CDebrisPolyBatch, 2);
+
+	return m_pRadialBatches;
+}
+
+//----------------------------------------------------------------------------------------------------
+// CDebrisPool
+//----------------------------------------------------------------------------------------------------
+CDebrisPool::CDebrisPool() :
+	m_pFreeList(NULL),
+	m_pOldestPiece(NULL),
+	m_pNewestPiece(NULL),
+	m_nNumLivePieces(0),
+	m_nMaxLivePieces(0)
+{
+}
+
+CDebrisPool::~CDebrisPool()
+{
+	Term();
+}
+
+//the size in bytes of a single slot, large enough for a piece with MAX_DEBRIS_VERTICES
+uint32 CDebrisPool::GetSlotSize()
+{
+	//round up so that every slot in a block stays aligned
+	return (SDebrisPiece::GetPieceSize(MAX_DEBRIS_VERTICES) + 15) & ~15;
+}
+
+//called to allocate a new block of slots and add them onto the free list
+void CDebrisPool::AllocateBlock()
+{
+	const uint32 nSlotSize = GetSlotSize();
+
+	uint8* pNewBlock = new uint8 [nSlotSize * DEBRIS_POOL_BLOCK_SLOTS];
+	if(!pNewBlock)
+		return;
+
+	m_Blocks.push_back(pNewBlock);
+
+	//thread all of the slots onto the free list
+	for(uint32 nCurrSlot = 0; nCurrSlot < DEBRIS_POOL_BLOCK_SLOTS; nCurrSlot++)
+	{
+		SDebrisPiece* pSlot = (SDebrisPiece*)(pNewBlock + nCurrSlot * nSlotSize);
+		pSlot->m_pPoolNext = m_pFreeList;
+		m_pFreeList = pSlot;
+	}
+}
+
+//called to allocate a piece of debris with room for the specified number of vertices for the
+//provided effect. This may recycle the oldest live piece if the pool is at its cap
+SDebrisPiece* CDebrisPool::AllocatePiece(CShatterEffect* pOwner, uint32 nNumVerts)
+{
+	//if we are at our limit, take back the oldest piece from its effect, which will place it back
+	//onto the free list (or the heap if it wasn't pooled)
+	if(m_nMaxLivePieces && (m_nNumLivePieces >= m_nMaxLivePieces) && m_pOldestPiece)
+	{
+		m_pOldestPiece->m_pOwner->ReleaseDebrisPiece(m_pOldestPiece);
+	}
+
+	SDebrisPiece* pNewPiece = NULL;
+
+	if(nNumVerts <= MAX_DEBRIS_VERTICES)
+	{
+		//this fits within a slot, so pull one off of the free list, growing if we need to
+		if(!m_pFreeList)
+			AllocateBlock();
+
+		if(!m_pFreeList)
+			return NULL;
+
+		pNewPiece = m_pFreeList;
+		m_pFreeList = pNewPiece->m_pPoolNext;
+		pNewPiece->m_bPooled = true;
+	}
+	else
+	{
+		//this piece is too detailed for our slots, so it needs to come from the heap
+		uint8* pNewPieceMem = new uint8 [SDebrisPiece::GetPieceSize(nNumVerts)];
+		if(!pNewPieceMem)
+			return NULL;
+
+		pNewPiece = (SDebrisPiece*)pNewPieceMem;
+		pNewPiece->m_bPooled = false;
+	}
+
+	pNewPiece->m_pOwner			= pOwner;
+	pNewPiece->m_nOwnerIndex	= 0;
+
+	//and add this onto the end of the live list since it is now the newest piece
+	pNewPiece->m_pPoolPrev = m_pNewestPiece;
+	pNewPiece->m_pPoolNext = NULL;
+
+	if(m_pNewestPiece)
+		m_pNewestPiece->m_pPoolNext = pNewPiece;
+	else
+		m_pOldestPiece = pNewPiece;
+
+	m_pNewestPiece = pNewPiece;
+	m_nNumLivePieces++;
+
+	return pNewPiece;
+}
+
+//called to return a piece of debris to the pool once its effect no longer needs it
+void CDebrisPool::FreePiece(SDebrisPiece* pPiece)
+{
+	LTASSERT(m_nNumLivePieces > 0, "Error: Freed a piece of debris that was not allocated from the pool");
+
+	//unlink this piece from the live list
+	if(pPiece->m_pPoolPrev)
+		pPiece->m_pPoolPrev->m_pPoolNext = pPiece->m_pPoolNext;
+	else
+		m_pOldestPiece = pPiece->m_pPoolNext;
+
+	if(pPiece->m_pPoolNext)
+		pPiece->m_pPoolNext->m_pPoolPrev = pPiece->m_pPoolPrev;
+	else
+		m_pNewestPiece = pPiece->m_pPoolPrev;
+
+	m_nNumLivePieces--;
+
+	//and now return the memory to wherever it came from
+	if(pPiece->m_bPooled)
+	{
+		pPiece->m_pOwner	= NULL;
+		pPiece->m_pPoolPrev = NULL;
+		pPiece->m_pPoolNext = m_pFreeList;
+		m_pFreeList = pPiece;
+	}
+	else
+	{
+		delete [] (uint8*)pPiece;
+	}
+}
+
+//called to free all of the memory held by the pool. All pieces must have been freed before this
+void CDebrisPool::Term()
+{
+	LTASSERT(m_nNumLivePieces == 0, "Error: Freed the debris pool while pieces of debris were still in use");
+
+	for(TBlockList::iterator it = m_Blocks.begin(); it != m_Blocks.end(); it++)
+	{
+		delete [] *it;
+	}
+	m_Blocks.clear();
+
+	m_pFreeList = NULL;
+}
+
 //----------------------------------------------------------------------------------------------------
 // CShatterEffect
 //----------------------------------------------------------------------------------------------------
@@ -232,7 +705,8 @@ CShatterEffect::CShatterEffect() :
 	m_hVertexDecl(NULL),
 	m_hObject(NULL),
 	m_fTotalElapsed(0.0f),
-	m_hShatterType(NULL)
+	m_hShatterType(NULL),
+	m_pDebrisPool(NULL)
 {
 }
 
@@ -248,7 +722,7 @@ CShatterEffect::~CShatterEffect()
 //called to create a shatter effect given the provided data
 bool CShatterEffect::Init(	const uint8* pWMData, const LTRigidTransform& tObjTransform, 
 							const LTVector& vHitPos, const LTVector& vHitDir,
-							HRECORD hShatterType)
+							HRECORD hShatterType, CDebrisPool& DebrisPool, CShatterWorkspace& Workspace)
 {
 	//clean up any existing data that we might have
 	Term();
@@ -256,6 +730,9 @@ bool CShatterEffect::Init(	const uint8* pWMData, const LTRigidTransform& tObjTra
 	//reset our elapsed time
 	m_fTotalElapsed = 0.0f;
 
+	//store the pool that our debris will come from
+	m_pDebrisPool = &DebrisPool;
+
 	//store our shatter type
 	m_hShatterType = hShatterType;
 
@@ -319,7 +796,7 @@ bool CShatterEffect::Init(	const uint8* pWMData, const LTRigidTransform& tObjTra
 
 	if(LTStrIEquals(pszShatterType, "Glass"))
 	{
-		if(!ShatterGlass(pWMData, tObjTransform, vHitPos, vHitDir))
+		if(!ShatterGlass(pWMData, tObjTransform, vHitPos, vHitDir, Workspace))
 		{
 			Term();
 			return false;
@@ -371,22 +848,56 @@ void CShatterEffect::Term()
 	//free out other data
 	m_hShatterType = NULL;
 	m_fTotalElapsed = 0.0f;
+	m_pDebrisPool = NULL;
 }
 
 //called to free all the currently allocated debris pieces
 void CShatterEffect::FreeDebrisPieces()
 {
+	LTASSERT(m_DebrisList.empty() || m_pDebrisPool, "Error: Found debris pieces without a debris pool to free them to");
+
 	for(TDebrisList::iterator it = m_DebrisList.begin(); it != m_DebrisList.end(); it++)
 	{
-		delete [] (uint8*)*it;
+		m_pDebrisPool->FreePiece(*it);
 	}
-	m_DebrisList.empty();
+	m_DebrisList.resize(0);
 
 	//and reset our counts so that they don't get out of sync
 	m_nNumDebrisPieces = 0;
 	m_nTotalTris = 0;
 }
 
+//called to add a newly created piece of debris onto this effect
+void CShatterEffect::AddDebrisPiece(SDebrisPiece* pPiece)
+{
+	pPiece->m_nOwnerIndex = m_DebrisList.size();
+	m_DebrisList.push_back(pPiece);
+
+	//and update our counts
+	m_nNumDebrisPieces++;
+	m_nTotalTris += pPiece->m_nNumVerts - 2;
+}
+
+//called by the debris pool when it recycles one of the pieces owned by this effect. This will
+//remove the piece from the effect and return it to the pool
+void CShatterEffect::ReleaseDebrisPiece(SDebrisPiece* pPiece)
+{
+	LTASSERT((pPiece->m_pOwner == this) && (m_DebrisList[pPiece->m_nOwnerIndex] == pPiece), "Error: Released a piece of debris that does not belong to this effect");
+
+	//move our last piece into the slot of the piece that is being removed, since the order of
+	//the pieces doesn't matter
+	SDebrisPiece* pLastPiece = m_DebrisList.back();
+	m_DebrisList[pPiece->m_nOwnerIndex] = pLastPiece;
+	pLastPiece->m_nOwnerIndex = pPiece->m_nOwnerIndex;
+	m_DebrisList.pop_back();
+
+	//and update our counts
+	m_nNumDebrisPieces--;
+	m_nTotalTris -= pPiece->m_nNumVerts - 2;
+
+	m_pDebrisPool->FreePiece(pPiece);
+}
+
 //----------------------------------------------------------------------------------------------------
 // Shattering Common
 
@@ -594,7 +1105,7 @@ static bool DoesPolyOverlapCylinder(const LTVector& vObjHitPos, const LTVector&
 
 //called to apply the glass shattering algorithm and create the debris
 bool CShatterEffect::ShatterGlass(	const uint8* pWMData, const LTRigidTransform& tObjTransform, 
-									const LTVector& vHitPos, const LTVector& vHitDir)
+									const LTVector& vHitPos, const LTVector& vHitDir, CShatterWorkspace& Workspace)
 {
 	//track performance
 	CTimedSystemBlock TimeBlock(g_tsClientShatter);
@@ -611,7 +1122,7 @@ bool CShatterEffect::ShatterGlass(	const uint8* pWMData, const LTRigidTransform&
 	//------------------------
 	// Generate radial planes
 
-	//create all of the primary fracture planes (limit is 32 to allow the working poly stack 32 bit code to work)
+	//create all of the primary fracture planes (limit is 32 to keep the number of fragments reasonable)
 	static const uint32 knMaxRadialPlanes = 32;
 	LTPlane RadialPlanes[knMaxRadialPlanes];
 
@@ -620,10 +1131,6 @@ bool CShatterEffect::ShatterGlass(	const uint8* pWMData, const LTRigidTransform&
 	uint32 nMaxRadial = LTCLAMP(CShatterTypeDB::Instance().GetGlassMaxRadialFractures(m_hShatterType), nMinRadial, knMaxRadialPlanes);
 	uint32 nNumRadial = nMinRadial + (rand() % (nMaxRadial - nMinRadial + 1));
 
-	//a bitmask that contains all of the radial plane bits set (used for detecting when a shard has been
-	//fully radially subdivided)
-	uint32 nFullPlaneMask = (1 << nNumRadial) - 1;
-
 	//transform the hit information into object space
 	LTRigidTransform tInvObjTransform = tObjTransform.GetInverse();
 	LTVector vObjHitPos = tInvObjTransform * vHitPos;
@@ -657,15 +1164,18 @@ bool CShatterEffect::ShatterGlass(	const uint8* pWMData, const LTRigidTransform&
 	float fIndirectMaxRotation = MATH_DEGREES_TO_RADIANS(CShatterTypeDB::Instance().GetIndirectMaxRotation(m_hShatterType));
 
 	//-----------------------------
-	// Subidivide each source poly
+	// Radial subdivision
 
-	//buffers to hold the output results of the splitting operation
-	SDebrisVert SplitVerts[2][MAX_DEBRIS_VERTICES];
+	//the source polygons and the batches that they are split between come from the workspace so that
+	//the memory can be reused by the next shatter
+	CShatterWorkspace::TSourcePolyList& SourcePolys = Workspace.m_SourcePolys;
+	CDebrisPolyBatch* pRadialBatches = Workspace.GetRadialBatches();
 
-	//TEMP:JO Find a better means of managing this memory
-	CWorkingPolyStack PolyStack;
+	SourcePolys.resize(nNumPolys);
+	pRadialBatches[0].Clear();
 
-	//now run through each of those polygons and create a piece of debris
+	//read in all of the source polygons, tagging each one with its index so that the fragments can
+	//find it again
 	for(uint32 nCurrPoly = 0; nCurrPoly < nNumPolys; nCurrPoly++)
 	{
 		//read in the polygon parameters
@@ -682,168 +1192,166 @@ bool CShatterEffect::ShatterGlass(	const uint8* pWMData, const LTRigidTransform&
 		//and now the number of vertices
 		uint32 nNumVerts = MemRead<uint32>(pMemFile);
 
-		//we can now push the polygon onto our working stack directly from memory
-		PolyStack.PushPoly(0, nNumVerts, (SDebrisVert*)pMemFile);
+		//we can now add the polygon into the batch directly from memory
+		pRadialBatches[0].AddPoly(nCurrPoly, nNumVerts, (const SDebrisVert*)pMemFile);
 
 		//skip forward in the file over all of the vertices
 		pMemFile += nNumVerts * sizeof(SDebrisVert);
 
 		//determine the world space normal, and build up a rotation that we should use for all of the
 		//created debris pieces
-		float fBinormalScale;
+		SGlassSourcePoly& Source = SourcePolys[nCurrPoly];
+
 		LTRotation rObjDebrisRot;
-		ConvertTangentSpaceToRotation(vNormal, vTangent, vBinormal, rObjDebrisRot, fBinormalScale);
+		ConvertTangentSpaceToRotation(vNormal, vTangent, vBinormal, rObjDebrisRot, Source.m_fBinormalScale);
 
-		LTRotation rDebrisRot = tObjTransform.m_rRot * rObjDebrisRot;
+		Source.m_vNormal	= vNormal;
+		Source.m_rDebrisRot	= tObjTransform.m_rRot * rObjDebrisRot;
+	}
+
+	//every radial plane cuts through all of the polygons, so split the whole batch against each plane
+	//in turn, flipping between the two batches
+	uint32 nCurrBatch = 0;
+	for(uint32 nCurrPlane = 0; nCurrPlane < nNumRadial; nCurrPlane++)
+	{
+		pRadialBatches[nCurrBatch].Split(RadialPlanes[nCurrPlane], pRadialBatches[!nCurrBatch]);
+		nCurrBatch = !nCurrBatch;
+	}
+
+	const CDebrisPolyBatch& Fragments = pRadialBatches[nCurrBatch];
+
+	//-----------------------------
+	// Shard subdivision
+
+	//buffers to hold the output results of the splitting operation
+	SDebrisVert SplitVerts[2][MAX_DEBRIS_VERTICES];
+
+	//buffer to hold the fragment that is being subdivided (source polygons are not limited to
+	//MAX_DEBRIS_VERTICES when there are no radial planes)
+	CShatterWorkspace::TVertList& FragmentVerts = Workspace.m_FragmentVerts;
+
+	//TEMP:JO Find a better means of managing this memory
+	CWorkingPolyStack PolyStack;
+
+	//now run through each of the fragments and break it into shards
+	for(uint32 nCurrFragment = 0; nCurrFragment < Fragments.GetNumPolys(); nCurrFragment++)
+	{
+		const CDebrisPolyBatch::SBatchPoly& Fragment = Fragments.GetPoly(nCurrFragment);
+
+		//get the information for the polygon that this fragment came from
+		const SGlassSourcePoly& Source = SourcePolys[Fragment.m_nCode];
+		const LTVector& vNormal = Source.m_vNormal;
+
+		//copy the fragment out of the batch and onto our working stack
+		FragmentVerts.resize(Fragment.m_nNumVerts);
+		Fragments.GetPolyVerts(nCurrFragment, &FragmentVerts[0]);
+
+		PolyStack.PushPoly(0, Fragment.m_nNumVerts, &FragmentVerts[0]);
 
 		//now we need to go into the recursive splitting mode
 		while(!PolyStack.IsEmpty())
 		{
 			//we now need to subdivide our top polygon
 			const CWorkingPolyStack::SWorkingPoly* pWorkPoly = PolyStack.GetTopPoly();
-			uint32 nCurrPolyCode = pWorkPoly->m_nCode;
 
-			//see if we need to perform any radial subdivision on this top polygon
-			if(nCurrPolyCode != nFullPlaneMask)
+			//determine the centroid of this polygon which is needed to determine the primary axis
+			//which is used to control how to fracture the shard
+			LTVector vCentroid = CalculateCentroid(pWorkPoly->m_nNumVerts, pWorkPoly->m_Verts);
+
+			//project our polygon along a vector from the point of impact to the centroid
+			LTVector vToCentroid;
+			float fProjMin, fProjMax;
+			CalculateCentroidProjection(vObjHitPos, vCentroid, vNormal, pWorkPoly->m_nNumVerts, 
+										pWorkPoly->m_Verts, vToCentroid, fProjMin, fProjMax);
+			
+			//determine a random length of which we will clip this piece to
+			float fMaxLength = GetUnitRandom() * fPieceLenRange + fMinPieceLen;
+			float fProjDist = fProjMax - fProjMin;
+
+			if(fProjDist > fMaxLength)
 			{
-				//-----------------
-				// Radial subdivision
+				//this piece is too long, we need to split it along a plane that is perpendicular to
+				//the direction to the centroid. Pick a distance along that value to make the plane from
+				//(we want it to be about 25-75% of the polygon)
+				float fPlaneDist = GetUnitRandom() * fProjDist * 0.5f + fProjMin + fProjDist * 0.25f;
 
-				//we still need to perform radial subdivision, determine which plane to use
-				for(uint32 nCurrPlane = 0; nCurrPlane < nNumRadial; nCurrPlane++)
-				{
-					const uint32 nPlaneCode = (1<<nCurrPlane);
-					if(!(pWorkPoly->m_nCode & nPlaneCode))
-					{
-						uint32 nFrontVerts = 0;
-						uint32 nBackVerts = 0;
-                        
-						//this is the plane that we need to subdivide with
-						SplitPoly(RadialPlanes[nCurrPlane], pWorkPoly->m_nNumVerts, pWorkPoly->m_Verts, 
-									nFrontVerts, SplitVerts[0], MAX_DEBRIS_VERTICES,
-									nBackVerts, SplitVerts[1], MAX_DEBRIS_VERTICES);
+				LTPlane SplitPlane(vToCentroid, fPlaneDist);
 
-						//now we can pop off our polygon and add the two new ones
-						PolyStack.PopPoly();
+				//and now split our polygon
+				uint32 nFrontVerts = 0;
+				uint32 nBackVerts = 0;
+
+				//this is the plane that we need to subdivide with
+				SplitPoly(	SplitPlane, pWorkPoly->m_nNumVerts, pWorkPoly->m_Verts, 
+							nFrontVerts, SplitVerts[0], MAX_DEBRIS_VERTICES,
+							nBackVerts, SplitVerts[1], MAX_DEBRIS_VERTICES);
 
-						//also set our working poly to NULL. Much easier to catch NULL pointers than bad mem
-						pWorkPoly = NULL;
+				//now we can pop off our polygon and add the two new ones
+				PolyStack.PopPoly();
 
-						PolyStack.PushPoly(nCurrPolyCode | nPlaneCode, nFrontVerts, SplitVerts[0]);
-						PolyStack.PushPoly(nCurrPolyCode | nPlaneCode, nBackVerts, SplitVerts[1]);
+				//also set our working poly to NULL. Much easier to catch NULL pointers than bad mem
+				pWorkPoly = NULL;
 
-						//no need to test further planes
-						break;
-					}
-				}
+				PolyStack.PushPoly(0, nFrontVerts, SplitVerts[0]);
+				PolyStack.PushPoly(0, nBackVerts, SplitVerts[1]);
 			}
 			else
 			{
-				//-----------------
-				// Shard subdivision
+				//this polygon is small enough to just be used as is
+				LTRigidTransform tCentroid(tObjTransform * vCentroid, Source.m_rDebrisRot);
 
-				//determine the centroid of this polygon which is needed to determine the primary axis
-				//which is used to control how to fracture the shard
-				LTVector vCentroid = CalculateCentroid(pWorkPoly->m_nNumVerts, pWorkPoly->m_Verts);
+				SDebrisPiece* pNewPiece = ConvertWorkingPolyToDebris(*m_pDebrisPool, this, pWorkPoly->m_nNumVerts, pWorkPoly->m_Verts, tCentroid, tObjTransform, Source.m_fBinormalScale);
 
-				//project our polygon along a vector from the point of impact to the centroid
-				LTVector vToCentroid;
-				float fProjMin, fProjMax;
-				CalculateCentroidProjection(vObjHitPos, vCentroid, vNormal, pWorkPoly->m_nNumVerts, 
-											pWorkPoly->m_Verts, vToCentroid, fProjMin, fProjMax);
-				
-				//determine a random length of which we will clip this piece to
-				float fMaxLength = GetUnitRandom() * fPieceLenRange + fMinPieceLen;
-				float fProjDist = fProjMax - fProjMin;
-
-				if(fProjDist > fMaxLength)
-				{
-					//this piece is too long, we need to split it along a plane that is perpendicular to
-					//the direction to the centroid. Pick a distance along that value to make the plane from
-					//(we want it to be about 25-75% of the polygon)
-					float fPlaneDist = GetUnitRandom() * fProjDist * 0.5f + fProjMin + fProjDist * 0.25f;
+				if(!pNewPiece)
+					return false;
 
-					LTPlane SplitPlane(vToCentroid, fPlaneDist);
+				//determine the distance of the centroid from the line of force of the bullet
+				LTVector vPerpImpact = tCentroid.m_vPos - vHitPos;
+				vPerpImpact -= vHitDir * vHitDir.Dot(vPerpImpact);
 
-					//and now split our polygon
-					uint32 nFrontVerts = 0;
-					uint32 nBackVerts = 0;
+				//and now apply a velocity based upon that distance
+				float fCentroidDist = vPerpImpact.Mag();
 
-					//this is the plane that we need to subdivide with
-					SplitPoly(	SplitPlane, pWorkPoly->m_nNumVerts, pWorkPoly->m_Verts, 
-								nFrontVerts, SplitVerts[0], MAX_DEBRIS_VERTICES,
-								nBackVerts, SplitVerts[1], MAX_DEBRIS_VERTICES);
+				if(DoesPolyOverlapCylinder(vObjHitPos, vObjHitDir, fImmediateRadiusSqr, pWorkPoly->m_nNumVerts, pWorkPoly->m_Verts))
+				{
+					//scale the distance accordingly
+					float fScaledDist = fCentroidDist * fVelocityFalloff;
 
-					//now we can pop off our polygon and add the two new ones
-					PolyStack.PopPoly();
+					//determine how much force should be applied
+					float fForce = fImmediateMinVelocity + GetUnitRandom() * (fImmediateMaxVelocity - fImmediateMinVelocity);
 
-					//also set our working poly to NULL. Much easier to catch NULL pointers than bad mem
-					pWorkPoly = NULL;
+					pNewPiece->m_vLinearVel = vHitDir * fForce / LTMAX(fScaledDist, 1.0f);
 
-					PolyStack.PushPoly(nCurrPolyCode, nFrontVerts, SplitVerts[0]);
-					PolyStack.PushPoly(nCurrPolyCode, nBackVerts, SplitVerts[1]);
+					//determine the angular velocity
+					pNewPiece->m_vAngularVel.Init(	GetRangedRandom(fImmediateMinRotation, fImmediateMaxRotation),
+													GetRangedRandom(fImmediateMinRotation, fImmediateMaxRotation),
+													GetRangedRandom(fImmediateMinRotation, fImmediateMaxRotation));
 				}
 				else
 				{
-					//this polygon is small enough to just be used as is
-					LTRigidTransform tCentroid(tObjTransform * vCentroid, rDebrisRot);
-
-					SDebrisPiece* pNewPiece = ConvertWorkingPolyToDebris(pWorkPoly->m_nNumVerts, pWorkPoly->m_Verts, tCentroid, tObjTransform, fBinormalScale);
-
-					if(!pNewPiece)
-						return false;
-
-					//determine the distance of the centroid from the line of force of the bullet
-					LTVector vPerpImpact = tCentroid.m_vPos - vHitPos;
-					vPerpImpact -= vHitDir * vHitDir.Dot(vPerpImpact);
-
-					//and now apply a velocity based upon that distance
-					float fCentroidDist = vPerpImpact.Mag();
-
-					if(DoesPolyOverlapCylinder(vObjHitPos, vObjHitDir, fImmediateRadiusSqr, pWorkPoly->m_nNumVerts, pWorkPoly->m_Verts))
-					{
-						//scale the distance accordingly
-						float fScaledDist = fCentroidDist * fVelocityFalloff;
-
-						//determine how much force should be applied
-						float fForce = fImmediateMinVelocity + GetUnitRandom() * (fImmediateMaxVelocity - fImmediateMinVelocity);
-
-						pNewPiece->m_vLinearVel = vHitDir * fForce / LTMAX(fScaledDist, 1.0f);
-
-						//determine the angular velocity
-						pNewPiece->m_vAngularVel.Init(	GetRangedRandom(fImmediateMinRotation, fImmediateMaxRotation),
-														GetRangedRandom(fImmediateMinRotation, fImmediateMaxRotation),
-														GetRangedRandom(fImmediateMinRotation, fImmediateMaxRotation));
-					}
-					else
-					{
-						//delay this piece from updating for the specified amount of time
-						pNewPiece->m_fUpdateDelayS = fGlassFallDelay + fCentroidDist * fGlassFallDistanceDelay;
-
-						//determine a random velocity for this piece that will take effect after the
-						//delay has expired
-						float fForce = fIndirectMinVelocity + GetUnitRandom() * (fIndirectMaxVelocity - fIndirectMinVelocity);
+					//delay this piece from updating for the specified amount of time
+					pNewPiece->m_fUpdateDelayS = fGlassFallDelay + fCentroidDist * fGlassFallDistanceDelay;
 
-						pNewPiece->m_vLinearVel = vHitDir * fForce;
+					//determine a random velocity for this piece that will take effect after the
+					//delay has expired
+					float fForce = fIndirectMinVelocity + GetUnitRandom() * (fIndirectMaxVelocity - fIndirectMinVelocity);
 
-						//determine the angular velocity
-						pNewPiece->m_vAngularVel.Init(	GetRangedRandom(fIndirectMinRotation, fIndirectMaxRotation),
-														GetRangedRandom(fIndirectMinRotation, fIndirectMaxRotation),
-														GetRangedRandom(fIndirectMinRotation, fIndirectMaxRotation));
-					}										
+					pNewPiece->m_vLinearVel = vHitDir * fForce;
 
-					m_DebrisList.push_back(pNewPiece);
+					//determine the angular velocity
+					pNewPiece->m_vAngularVel.Init(	GetRangedRandom(fIndirectMinRotation, fIndirectMaxRotation),
+													GetRangedRandom(fIndirectMinRotation, fIndirectMaxRotation),
+													GetRangedRandom(fIndirectMinRotation, fIndirectMaxRotation));
+				}										
 
-					//and update our counts
-					m_nNumDebrisPieces++;
-					m_nTotalTris += pNewPiece->m_nNumVerts - 2;
+				//add this onto our list of debris
+				AddDebrisPiece(pNewPiece);
 
-					//now we can pop off our polygon off of the stack
-					PolyStack.PopPoly();
+				//now we can pop off our polygon off of the stack
+				PolyStack.PopPoly();
 
-					//also set our working poly to NULL. Much easier to catch NULL pointers than bad mem
-					pWorkPoly = NULL;
-				}
+				//also set our working poly to NULL. Much easier to catch NULL pointers than bad mem
+				pWorkPoly = NULL;
 			}
 		}
 	}
@@ -1091,7 +1599,7 @@ bool CShatterEffect::ShatterTile(	const uint8* pWMData, const LTRigidTransform&
 				LTVector vCentroid = CalculateCentroid(pWorkPoly->m_nNumVerts, pWorkPoly->m_Verts);
 				LTRigidTransform tCentroid(tObjTransform * vCentroid, rDebrisRot);
 
-				SDebrisPiece* pNewPiece = ConvertWorkingPolyToDebris(pWorkPoly->m_nNumVerts, pWorkPoly->m_Verts, tCentroid, tObjTransform, fBinormalScale);
+				SDebrisPiece* pNewPiece = ConvertWorkingPolyToDebris(*m_pDebrisPool, this, pWorkPoly->m_nNumVerts, pWorkPoly->m_Verts, tCentroid, tObjTransform, fBinormalScale);
 
 				if(!pNewPiece)
 					return false;
@@ -1138,11 +1646,8 @@ bool CShatterEffect::ShatterTile(	const uint8* pWMData, const LTRigidTransform&
 													GetRangedRandom(fIndirectMinRotation, fIndirectMaxRotation));
 				}
 
-				m_DebrisList.push_back(pNewPiece);
-
-				//and update our counts
-				m_nNumDebrisPieces++;
-				m_nTotalTris += pNewPiece->m_nNumVerts - 2;
+				//add this onto our list of debris
+				AddDebrisPiece(pNewPiece);
 
 				//now we can pop off our polygon off of the stack
 				PolyStack.PopPoly();
@@ -1205,7 +1710,7 @@ bool CShatterEffect::ShatterPoly(	const uint8* pWMData, const LTRigidTransform&
 		tCentroid.m_rRot = rDebrisRot;
 
 		//create our actual debris piece from all the data that we have collected
-		SDebrisPiece* pNewPiece = ConvertWorkingPolyToDebris(nNumVerts, pVertices, tCentroid, tObjTransform, fBinormalScale);
+		SDebrisPiece* pNewPiece = ConvertWorkingPolyToDebris(*m_pDebrisPool, this, nNumVerts, pVertices, tCentroid, tObjTransform, fBinormalScale);
 		if(!pNewPiece)
 			return false;
 
@@ -1213,11 +1718,7 @@ bool CShatterEffect::ShatterPoly(	const uint8* pWMData, const LTRigidTransform&
 		pMemFile += sizeof(SDebrisVert) * nNumVerts;
 
         //add this onto our list of debris
-		m_DebrisList.push_back(pNewPiece);
-
-		//and update our counts
-		m_nNumDebrisPieces++;
-		m_nTotalTris += pNewPiece->m_nNumVerts - 2;
+		AddDebrisPiece(pNewPiece);
 	}
 
 	return true;
@@ -13,6 +13,14 @@
 #	include "iltcustomrendercallback.h"
 #endif
 
+//the maximum number of vertices that a piece of debris can have. This is to prevent any incredibly
+//detailed pieces of debris
+#define MAX_DEBRIS_VERTICES		16
+
+//forward declarations
+class CShatterEffect;
+class CDebrisPolyBatch;
+
 //structure representing a single debris vertex
 struct SDebrisVert
 {
@@ -52,6 +60,20 @@ struct SDebrisPiece
 	//the scale we apply to the binormal to handle mirrored tangent space
 	float				m_fBinormalScale;
 
+	//the effect that currently owns this piece, and the index of this piece within that effect's
+	//debris list so that it can be removed quickly when the pool recycles it
+	CShatterEffect*		m_pOwner;
+	uint32				m_nOwnerIndex;
+
+	//links into the pool's list of live pieces, which is ordered from oldest to newest. The next
+	//link is also used for the free list while the piece is not in use
+	SDebrisPiece*		m_pPoolPrev;
+	SDebrisPiece*		m_pPoolNext;
+
+	//whether or not this piece lives in one of the pool's fixed size slots, or was allocated from
+	//the heap because it had too many vertices to fit
+	bool				m_bPooled;
+
 	//the number of vertices associated with this debris piece
 	uint32				m_nNumVerts;
 
@@ -60,6 +82,109 @@ struct SDebrisPiece
 	//NOTE: NOTHING MUST COME AFTER THIS POINT
 };
 
+//a pool of debris pieces shared by all of the shatter effects in a level. Pieces are carved out of
+//fixed size slots that are recycled through a free list, so shattering doesn't need to go to the
+//heap once the pool has grown. The pool can also be given a cap on the number of live pieces, in which
+//case allocating a piece beyond the cap will take the oldest live piece back from its effect
+class CDebrisPool
+{
+public:
+
+	CDebrisPool();
+	~CDebrisPool();
+
+	//called to allocate a piece of debris with room for the specified number of vertices for the
+	//provided effect. This may recycle the oldest live piece if the pool is at its cap
+	SDebrisPiece* AllocatePiece(CShatterEffect* pOwner, uint32 nNumVerts);
+
+	//called to return a piece of debris to the pool once its effect no longer needs it
+	void FreePiece(SDebrisPiece* pPiece);
+
+	//called to set the maximum number of live pieces of debris, or zero for no limit
+	void SetMaxLivePieces(uint32 nMaxLivePieces)	{ m_nMaxLivePieces = nMaxLivePieces; }
+
+	//called to determine the number of pieces currently allocated to effects
+	uint32 GetNumLivePieces() const					{ return m_nNumLivePieces; }
+
+	//called to free all of the memory held by the pool. All pieces must have been freed before this
+	void Term();
+
+private:
+
+	//we don't allow copying of this object
+	PREVENT_OBJECT_COPYING(CDebrisPool);
+
+	//called to allocate a new block of slots and add them onto the free list
+	void AllocateBlock();
+
+	//the size in bytes of a single slot, large enough for a piece with MAX_DEBRIS_VERTICES
+	static uint32 GetSlotSize();
+
+	//the blocks of memory that the slots are carved out of
+	typedef std::vector<uint8*, LTAllocator<uint8*, LT_MEM_TYPE_CLIENTSHELL> > TBlockList;
+	TBlockList		m_Blocks;
+
+	//the list of slots that are not currently in use
+	SDebrisPiece*	m_pFreeList;
+
+	//the list of live pieces, from oldest to newest
+	SDebrisPiece*	m_pOldestPiece;
+	SDebrisPiece*	m_pNewestPiece;
+
+	//the number of live pieces, and the maximum number allowed (zero for no limit)
+	uint32			m_nNumLivePieces;
+	uint32			m_nMaxLivePieces;
+};
+
+//the information from each source polygon that is needed when its radial fragments are turned into debris
+struct SGlassSourcePoly
+{
+	//the object space normal of the polygon
+	LTVector	m_vNormal;
+
+	//the world space rotation to use for the debris
+	LTRotation	m_rDebrisRot;
+
+	//the scale we apply to the binormal to handle mirrored tangent space
+	float		m_fBinormalScale;
+};
+
+//the working memory used while shattering, which is shared by all of the shatter effects in a level
+//and kept between shatters so that it doesn't need to be allocated each time
+class CShatterWorkspace
+{
+public:
+
+	CShatterWorkspace();
+	~CShatterWorkspace();
+
+	//called to free all of the memory held by the workspace
+	void Term();
+
+private:
+
+	//only the shatter effects use the workspace
+	friend class CShatterEffect;
+
+	//we don't allow copying of this object
+	PREVENT_OBJECT_COPYING(CShatterWorkspace);
+
+	//called to access the two batches that the glass radial splits flip between, allocating them
+	//if they haven't been already
+	CDebrisPolyBatch* GetRadialBatches();
+
+	//the source polygons of the glass being shattered
+	typedef std::vector<SGlassSourcePoly, LTAllocator<SGlassSourcePoly, LT_MEM_TYPE_CLIENTSHELL> > TSourcePolyList;
+	TSourcePolyList		m_SourcePolys;
+
+	//the two batches that the glass radial splits flip between
+	CDebrisPolyBatch*	m_pRadialBatches;
+
+	//the glass fragment that is being subdivided
+	typedef std::vector<SDebrisVert, LTAllocator<SDebrisVert, LT_MEM_TYPE_CLIENTSHELL> > TVertList;
+	TVertList			m_FragmentVerts;
+};
+
 //class representing a single shattering effect, which is essentially a colleciton of debris
 //generated from a shattering algorithm
 class CShatterEffect
@@ -69,10 +194,11 @@ public:
 	CShatterEffect();
 	~CShatterEffect();
 
-	//called to create a shatter effect given the provided data
+	//called to create a shatter effect given the provided data. The debris pieces are allocated from
+	//the provided pool, which must outlive this effect, and the workspace is used while shattering
 	bool Init(	const uint8* pWMData, const LTRigidTransform& tObjTransform, 
 				const LTVector& vHitPos, const LTVector& vHitDir,
-				HRECORD hShatterType);
+				HRECORD hShatterType, CDebrisPool& DebrisPool, CShatterWorkspace& Workspace);
 
 	//called to update this shatter effect by the specified time interval. This will return
 	//false when the object should be removed
@@ -81,6 +207,10 @@ public:
 	//called to free up this effect
 	void Term();
 
+	//called by the debris pool when it recycles one of the pieces owned by this effect. This will
+	//remove the piece from the effect and return it to the pool
+	void ReleaseDebrisPiece(SDebrisPiece* pPiece);
+
 private:
 
 	//we don't allow copying of this object
@@ -89,6 +219,9 @@ private:
 	//called to free all the currently allocated debris pieces
 	void FreeDebrisPieces();
 
+	//called to add a newly created piece of debris onto this effect
+	void AddDebrisPiece(SDebrisPiece* pPiece);
+
 	//hook for the custom render object, this will just call into the render function
 	static void CustomRenderCallback(ILTCustomRenderCallback* pInterface, const LTRigidTransform& tCamera, void* pUser);
 
@@ -109,7 +242,7 @@ private:
 
 	//called to apply the glass shattering algorithm and create the debris
 	bool ShatterGlass(	const uint8* pWMData, const LTRigidTransform& tObjTransform, 
-						const LTVector& vHitPos, const LTVector& vHitDir);
+						const LTVector& vHitPos, const LTVector& vHitDir, CShatterWorkspace& Workspace);
 
 	//---------------------------
 	// Tile shattering
@@ -144,7 +277,10 @@ private:
 	//the number of debris pieces that we have
 	uint32		m_nNumDebrisPieces;
 
-	//temporary representation of the debris pieces, will be replaced by a more optimized allocator
+	//the pool that our debris pieces are allocated from
+	CDebrisPool*	m_pDebrisPool;
+
+	//the listing of our debris pieces, each of which is allocated from the debris pool
 	typedef std::vector<SDebrisPiece*> TDebrisList;
 	TDebrisList	m_DebrisList;
 };
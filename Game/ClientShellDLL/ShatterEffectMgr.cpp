@@ -1,6 +1,9 @@
 #include "stdafx.h"
 #include "ShatterEffectMgr.h"
 #include "ShatterEffect.h"
+#include "VarTrack.h"
+#include "ShatterTypeDB.h"
+#include "lttimeutils.h"
 
 #if defined(PLATFORM_XENON)
 // XENON: Necessary code for implementing runtime swapping
@@ -10,6 +13,10 @@
 //unique value to ensure that we don't conflict with other blind object data
 #define SHATTERINFO_BLINDOBJECTID	0x00000a85		// just a random, but constant 32-bit ID
 
+//the maximum number of debris pieces that can be alive across all shatter effects. Once this is reached,
+//the oldest pieces are recycled for new shatters. Zero allows any number of pieces
+static VarTrack g_vtShatterMaxDebris;
+
 
 CShatterEffectMgr::CShatterEffectMgr()
 {
@@ -54,13 +61,27 @@ bool CShatterEffectMgr::CreateShatterEffect(uint32 nShatterDataID, const LTRigid
 	}
 #endif // PLATFORM_XENON
 
+	return CreateShatterEffectFromData(pWMData, tObjTransform, vHitPos, vHitDir, hShatterType);
+}
+
+//called to create a new shatter effect from the provided world model data
+bool CShatterEffectMgr::CreateShatterEffectFromData(const uint8* pWMData, const LTRigidTransform& tObjTransform, 
+													const LTVector& vHitPos, const LTVector& vHitDir,
+													HRECORD hShatterType)
+{
+	//update the debris cap in case it has been changed
+	if(!g_vtShatterMaxDebris.IsInitted())
+		g_vtShatterMaxDebris.Init(g_pLTClient, "ShatterMaxDebris", NULL, 2048.0f);
+
+	m_DebrisPool.SetMaxLivePieces((uint32)LTMAX(g_vtShatterMaxDebris.GetFloat(), 0.0f));
+
 	//create the shatter effect object
 	CShatterEffect* pNewEffect = debug_new(CShatterEffect);
 	if(!pNewEffect)
 		return false;
 
 	//now actually initialize the new effect
-	if(!pNewEffect->Init(pWMData, tObjTransform, vHitPos, vHitDir, hShatterType))
+	if(!pNewEffect->Init(pWMData, tObjTransform, vHitPos, vHitDir, hShatterType, m_DebrisPool, m_Workspace))
 	{
 		debug_delete(pNewEffect);
 		return false;
@@ -104,4 +125,109 @@ void CShatterEffectMgr::FreeShatterEffects()
 		debug_delete(*it);
 	}
 	m_ShatterList.resize(0);
-}
\ No newline at end of file
+
+	//and now that all of the debris has been returned, release the memory for the pool
+	m_DebrisPool.Term();
+
+	//and the working memory used while shattering
+	m_Workspace.Term();
+}
+
+#ifndef _FINAL
+
+//called to append a value onto generated world model data
+template<class T>
+static void AppendBenchmarkData(std::vector<uint8, LTAllocator<uint8, LT_MEM_TYPE_CLIENTSHELL> >& Data, const T& Value)
+{
+	const uint8* pValue = (const uint8*)&Value;
+	Data.insert(Data.end(), pValue, pValue + sizeof(T));
+}
+
+//called to repeatedly shatter a generated pane of glass made from a grid of quads with the named
+//shatter type, and report the time taken to shatter and the debris created
+void CShatterEffectMgr::RunBenchmark(const char* pszShatterType, uint32 nGridSize, uint32 nNumShatters)
+{
+	HRECORD hShatterType = CShatterTypeDB::Instance().GetShatterType(pszShatterType);
+	if(!hShatterType)
+	{
+		g_pLTClient->CPrint("ShatterBenchmark: unknown shatter type %s", pszShatterType);
+		return;
+	}
+
+	if(nGridSize == 0)
+		nGridSize = 8;
+	if(nNumShatters == 0)
+		nNumShatters = 100;
+
+	//build a square pane in the XY plane facing down the Z axis, split into a grid of quads in the
+	//same layout as the blind object data
+	static const float kfPaneSize = 256.0f;
+	float fQuadSize = kfPaneSize / (float)nGridSize;
+
+	std::vector<uint8, LTAllocator<uint8, LT_MEM_TYPE_CLIENTSHELL> > WMData;
+	AppendBenchmarkData(WMData, nGridSize * nGridSize);
+
+	for(uint32 nY = 0; nY < nGridSize; nY++)
+	{
+		for(uint32 nX = 0; nX < nGridSize; nX++)
+		{
+			AppendBenchmarkData(WMData, LTVector(0.0f, 0.0f, -1.0f));
+			AppendBenchmarkData(WMData, LTVector(1.0f, 0.0f, 0.0f));
+			AppendBenchmarkData(WMData, LTVector(0.0f, 1.0f, 0.0f));
+			AppendBenchmarkData(WMData, (uint32)4);
+
+			static const uint32 knCorners[4][2] = { { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 0 } };
+			for(uint32 nCorner = 0; nCorner < 4; nCorner++)
+			{
+				SDebrisVert Vert;
+				Vert.m_vPos.Init((float)(nX + knCorners[nCorner][0]) * fQuadSize - kfPaneSize * 0.5f, (float)(nY + knCorners[nCorner][1]) * fQuadSize - kfPaneSize * 0.5f, 0.0f);
+				Vert.m_vUV.Init((float)(nX + knCorners[nCorner][0]) / (float)nGridSize, (float)(nY + knCorners[nCorner][1]) / (float)nGridSize);
+				AppendBenchmarkData(WMData, Vert);
+			}
+		}
+	}
+
+	//shatter the pane in a manager of its own so that the effects in the level are not disturbed,
+	//hitting it at a different point each time
+	CShatterEffectMgr BenchmarkMgr;
+
+	LTRigidTransform tObjTransform(LTVector(0.0f, 0.0f, 0.0f), LTRotation::GetIdentity());
+	LTVector vHitDir(0.0f, 0.0f, 1.0f);
+
+	uint32 nFailures	= 0;
+	uint32 nMaxDebris	= 0;
+	double fTotalMS		= 0.0;
+	double fMaxMS		= 0.0;
+
+	for(uint32 nShatter = 0; nShatter < nNumShatters; nShatter++)
+	{
+		float fOffset = kfPaneSize * ((float)(nShatter % 7) / 7.0f - 0.5f) * 0.5f;
+		LTVector vHitPos(fOffset, -fOffset * 0.5f, 0.0f);
+
+		uint32 nOldDebris = BenchmarkMgr.m_DebrisPool.GetNumLivePieces();
+
+		TLTPrecisionTime StartTime = LTTimeUtils::GetPrecisionTime();
+		bool bCreated = BenchmarkMgr.CreateShatterEffectFromData(&WMData[0], tObjTransform, vHitPos, vHitDir, hShatterType);
+		double fShatterMS = LTTimeUtils::GetPrecisionTimeIntervalMS(StartTime, LTTimeUtils::GetPrecisionTime());
+
+		if(!bCreated)
+			nFailures++;
+
+		fTotalMS	+= fShatterMS;
+		fMaxMS		= LTMAX(fMaxMS, fShatterMS);
+		nMaxDebris	= LTMAX(nMaxDebris, BenchmarkMgr.m_DebrisPool.GetNumLivePieces() - nOldDebris);
+
+		//free the effects as the level would be left so that the workspace and pool are rebuilt
+		//from time to time as well
+		if((nShatter % 16) == 15)
+			BenchmarkMgr.FreeShatterEffects();
+	}
+
+	BenchmarkMgr.FreeShatterEffects();
+
+	g_pLTClient->CPrint("ShatterBenchmark: %s, %u quads, %u shatters: %.3f ms average, %.3f ms longest, up to %u pieces of debris",
+		pszShatterType, nGridSize * nGridSize, nNumShatters, fTotalMS / (double)nNumShatters, fMaxMS, nMaxDebris);
+	g_pLTClient->CPrint("ShatterBenchmark: %u failures - %s", nFailures, (nFailures == 0) ? "PASSED" : "FAILED");
+}
+
+#endif
\ No newline at end of file
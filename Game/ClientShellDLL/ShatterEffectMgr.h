@@ -9,8 +9,9 @@
 #ifndef __SHATTEREFFECTMGR_H__
 #define __SHATTEREFFECTMGR_H__
 
-//forward declarations
-class CShatterEffect;
+#ifndef __SHATTEREFFECT_H__
+#	include "ShatterEffect.h"
+#endif
 
 class CShatterEffectMgr
 {
@@ -28,18 +29,36 @@ public:
 	//called to update all of the shatter effects
 	void UpdateShatterEffects(float fElapsedS);
 
-	//called to free all of the shatter effect objects
+	//called to free all of the shatter effect objects, along with the debris pool and workspace that they
+	//share. This should be called whenever the world is left
 	void FreeShatterEffects();
 
+#ifndef _FINAL
+	//called to repeatedly shatter a generated pane of glass made from a grid of quads with the named
+	//shatter type, and report the time taken to shatter and the debris created
+	static void RunBenchmark(const char* pszShatterType, uint32 nGridSize, uint32 nNumShatters);
+#endif
+
 private:
 
 	//we don't allow copying of this object
 	PREVENT_OBJECT_COPYING(CShatterEffectMgr);
 
+	//called to create a new shatter effect from the provided world model data
+	bool CreateShatterEffectFromData(	const uint8* pWMData, const LTRigidTransform& tObjTransform, 
+										const LTVector& vHitPos, const LTVector& vHitDir,
+										HRECORD hShatterType);
+
 	//the list of currently allocated shatter effects
 	typedef std::vector<CShatterEffect*> TShatterList;
 	TShatterList	m_ShatterList;
 
+	//the pool that all of the debris pieces for the shatter effects are allocated from
+	CDebrisPool		m_DebrisPool;
+
+	//the working memory that the shatter effects use while shattering
+	CShatterWorkspace	m_Workspace;
+
 };
 
 #endif
@@ -28,6 +28,42 @@ CSpecialFXList::~CSpecialFXList()
 		debug_deletea(m_pAgeArray);
 		m_pAgeArray = NULL;
 	}
+
+	if (m_pKeyArray)
+	{
+		debug_deletea(m_pKeyArray);
+		m_pKeyArray = NULL;
+	}
+
+	if (m_pUsedMask)
+	{
+		debug_deletea(m_pUsedMask);
+		m_pUsedMask = NULL;
+	}
+
+	if (m_pDenseFX)
+	{
+		debug_deletea(m_pDenseFX);
+		m_pDenseFX = NULL;
+	}
+
+	if (m_pDenseSlot)
+	{
+		debug_deletea(m_pDenseSlot);
+		m_pDenseSlot = NULL;
+	}
+
+	if (m_pDensePos)
+	{
+		debug_deletea(m_pDensePos);
+		m_pDensePos = NULL;
+	}
+
+	if (m_pIndex)
+	{
+		debug_deletea(m_pIndex);
+		m_pIndex = NULL;
+	}
 }
 
 bool CSpecialFXList::Add(CSpecialFX* pFX)
@@ -40,7 +76,8 @@ bool CSpecialFXList::Add(CSpecialFX* pFX)
 	{
 		if (!m_pArray[i] && !bFoundSlot)
 		{
-			m_pArray[i]	= pFX;
+			SetSlot(i, pFX);
+			AddToDense(i);
 			m_pAgeArray[i] = 0;
             bFoundSlot = true;
 		}
@@ -76,10 +113,13 @@ bool CSpecialFXList::Add(CSpecialFX* pFX)
 			}
 		}
 
-		// Replace the element at nSlot with the new fx
+		// Replace the element at nSlot with the new fx.  It keeps the old
+		// fx's place in the dense array...
 
 		CSFXMgr::DeleteSFX(m_pArray[nSlot]);
-		m_pArray[nSlot]	= pFX;
+		ClearSlot(nSlot);
+		SetSlot(nSlot, pFX);
+		m_pDenseFX[m_pDensePos[nSlot]] = pFX;
 		m_pAgeArray[nSlot] = 0;
 	}
 	else
@@ -94,17 +134,249 @@ bool CSpecialFXList::Remove(CSpecialFX* pFX)
 {
     if (!pFX || !m_pArray) return false;
 
-	for (unsigned int i=0; i < m_nArraySize; i++)
+	unsigned int nSlot = FindSlot(pFX);
+	if (nSlot >= m_nArraySize) return false;
+
+	CSFXMgr::DeleteSFX(pFX);
+	RemoveFromDense(nSlot);
+	ClearSlot(nSlot);
+	m_pAgeArray[nSlot] = 0;
+	m_nElements--;
+
+    return true;
+}
+
+unsigned int CSpecialFXList::FindSlot(CSpecialFX* pFX) const
+{
+	// Look in the index under the fx's server object first...
+
+	HOBJECT hObj = pFX->GetServerObj();
+	if (hObj)
 	{
-		if (m_pArray[i] == pFX)
+		unsigned int nMask = m_nIndexSize - 1;
+
+		for (unsigned int nProbe = HashObject(hObj) & nMask; m_pIndex[nProbe].m_nSlot != kIndexEmpty; nProbe = (nProbe + 1) & nMask)
 		{
-			CSFXMgr::DeleteSFX(m_pArray[i]);
-            m_pArray[i] = NULL;
-			m_pAgeArray[i] = 0;
-			m_nElements--;
-            return true;
+			const IndexEntry& Entry = m_pIndex[nProbe];
+			if (Entry.m_nSlot != kIndexRemoved && Entry.m_hKey == hObj && m_pArray[Entry.m_nSlot] == pFX)
+			{
+				return Entry.m_nSlot;
+			}
+		}
+	}
+
+	// ...but fx without a server object aren't indexed, and the server
+	// object may have been cleared since the fx was added...
+
+	for (unsigned int i=0; i < m_nElements; i++)
+	{
+		if (m_pDenseFX[i] == pFX)
+		{
+			return m_pDenseSlot[i];
+		}
+	}
+
+	return m_nArraySize;
+}
+
+unsigned int CSpecialFXList::FindSlotByServerObj(HOBJECT hObj, unsigned int nStart) const
+{
+	if (!m_pArray) return m_nArraySize;
+
+	// Special fx without a server object aren't indexed, so look for
+	// them the slow way...
+
+	if (!hObj)
+	{
+		for (unsigned int i=GetNextSlot(nStart); i < m_nArraySize; i=GetNextSlot(i+1))
+		{
+			if (!m_pArray[i]->GetServerObj())
+			{
+				return i;
+			}
+		}
+
+		return m_nArraySize;
+	}
+
+	// Walk the whole probe sequence since several special fx may share the
+	// same server object, and return the lowest matching slot...
+
+	unsigned int nFound = m_nArraySize;
+	unsigned int nMask  = m_nIndexSize - 1;
+
+	for (unsigned int nProbe = HashObject(hObj) & nMask; ; nProbe = (nProbe + 1) & nMask)
+	{
+		const IndexEntry& Entry = m_pIndex[nProbe];
+		if (Entry.m_nSlot == kIndexEmpty)
+		{
+			break;
+		}
+
+		if (Entry.m_nSlot == kIndexRemoved || Entry.m_hKey != hObj)
+		{
+			continue;
+		}
+
+		if (Entry.m_nSlot >= nStart && Entry.m_nSlot < nFound &&
+			m_pArray[Entry.m_nSlot]->GetServerObj() == hObj)
+		{
+			nFound = Entry.m_nSlot;
+		}
+	}
+
+	return nFound;
+}
+
+void CSpecialFXList::SetSlot(unsigned int nSlot, CSpecialFX* pFX)
+{
+	m_pArray[nSlot] = pFX;
+	m_pKeyArray[nSlot] = pFX ? pFX->GetServerObj() : NULL;
+
+	// Index the slot before marking it used so a rebuild of the index
+	// doesn't pick it up twice...
+
+	if (pFX)
+	{
+		AddToIndex(nSlot);
+		m_pUsedMask[nSlot >> 5] |= (1u << (nSlot & 31));
+	}
+}
+
+void CSpecialFXList::ClearSlot(unsigned int nSlot)
+{
+	RemoveFromIndex(nSlot);
+
+	m_pArray[nSlot] = NULL;
+	m_pKeyArray[nSlot] = NULL;
+	m_pUsedMask[nSlot >> 5] &= ~(1u << (nSlot & 31));
+}
+
+void CSpecialFXList::AddToDense(unsigned int nSlot)
+{
+	// Called before m_nElements counts the new fx...
+
+	m_pDenseFX[m_nElements]   = m_pArray[nSlot];
+	m_pDenseSlot[m_nElements] = nSlot;
+	m_pDensePos[nSlot]        = m_nElements;
+}
+
+void CSpecialFXList::RemoveFromDense(unsigned int nSlot)
+{
+	// Called before m_nElements stops counting the fx.  Move the last fx
+	// into the hole...
+
+	unsigned int nPos  = m_pDensePos[nSlot];
+	unsigned int nLast = m_nElements - 1;
+
+	// ...unless an iteration has already visited the hole.  Then the last fx
+	// visited fills the hole instead, so that the visited fx stay together
+	// at the front, and the last fx fills the place it left...
+
+	if (m_bIterating && nPos < m_nVisited)
+	{
+		m_nVisited--;
+		MoveDense(m_nVisited, nPos);
+		nPos = m_nVisited;
+	}
+
+	MoveDense(nLast, nPos);
+
+	m_pDenseFX[nLast] = NULL;
+}
+
+void CSpecialFXList::MoveDense(unsigned int nFrom, unsigned int nTo)
+{
+	// The fx in nFrom may already have been moved out, in which case its
+	// position must not be pointed back here...
+
+	if (nFrom == nTo) return;
+
+	m_pDenseFX[nTo]   = m_pDenseFX[nFrom];
+	m_pDenseSlot[nTo] = m_pDenseSlot[nFrom];
+	m_pDensePos[m_pDenseSlot[nTo]] = nTo;
+}
+
+void CSpecialFXList::ClearIndex()
+{
+	for (unsigned int i=0; i < m_nIndexSize; i++)
+	{
+		m_pIndex[i].m_hKey  = NULL;
+		m_pIndex[i].m_nSlot = kIndexEmpty;
+	}
+
+	m_nIndexUsed = 0;
+}
+
+void CSpecialFXList::AddToIndex(unsigned int nSlot)
+{
+	HOBJECT hKey = m_pKeyArray[nSlot];
+	if (!hKey) return;
+
+	// Removed entries are left behind as markers so that probe sequences
+	// stay intact.  Once they start to fill up the index, start over...
+
+	if ((m_nIndexUsed + 1) * 4 > m_nIndexSize * 3)
+	{
+		RebuildIndex();
+	}
+
+	unsigned int nMask = m_nIndexSize - 1;
+	unsigned int nProbe = HashObject(hKey) & nMask;
+
+	while (m_pIndex[nProbe].m_nSlot != kIndexEmpty && m_pIndex[nProbe].m_nSlot != kIndexRemoved)
+	{
+		nProbe = (nProbe + 1) & nMask;
+	}
+
+	if (m_pIndex[nProbe].m_nSlot == kIndexEmpty)
+	{
+		m_nIndexUsed++;
+	}
+
+	m_pIndex[nProbe].m_hKey  = hKey;
+	m_pIndex[nProbe].m_nSlot = nSlot;
+}
+
+void CSpecialFXList::RemoveFromIndex(unsigned int nSlot)
+{
+	HOBJECT hKey = m_pKeyArray[nSlot];
+	if (!hKey) return;
+
+	unsigned int nMask = m_nIndexSize - 1;
+
+	for (unsigned int nProbe = HashObject(hKey) & nMask; m_pIndex[nProbe].m_nSlot != kIndexEmpty; nProbe = (nProbe + 1) & nMask)
+	{
+		if (m_pIndex[nProbe].m_nSlot == nSlot)
+		{
+			m_pIndex[nProbe].m_hKey  = NULL;
+			m_pIndex[nProbe].m_nSlot = kIndexRemoved;
+			return;
 		}
 	}
 
-    return false;
+	ASSERT( !"CSpecialFXList::RemoveFromIndex:  Slot was not in the index." );
+}
+
+void CSpecialFXList::RebuildIndex()
+{
+	ClearIndex();
+
+	unsigned int nMask = m_nIndexSize - 1;
+
+	for (unsigned int i=GetNextSlot(0); i < m_nArraySize; i=GetNextSlot(i+1))
+	{
+		HOBJECT hKey = m_pKeyArray[i];
+		if (!hKey) continue;
+
+		unsigned int nProbe = HashObject(hKey) & nMask;
+		while (m_pIndex[nProbe].m_nSlot != kIndexEmpty)
+		{
+			nProbe = (nProbe + 1) & nMask;
+		}
+
+		m_pIndex[nProbe].m_hKey  = hKey;
+		m_pIndex[nProbe].m_nSlot = i;
+		m_nIndexUsed++;
+	}
 }
@@ -29,7 +29,17 @@ class CSpecialFXList
             m_nArraySize = NULL;
             m_pArray     = NULL;
             m_pAgeArray  = NULL;
+			m_pKeyArray	 = NULL;
+			m_pUsedMask	 = NULL;
+			m_pDenseFX	 = NULL;
+			m_pDenseSlot = NULL;
+			m_pDensePos	 = NULL;
+			m_pIndex	 = NULL;
+			m_nIndexSize = 0;
+			m_nIndexUsed = 0;
 			m_nElements  = 0;
+			m_nVisited	 = 0;
+			m_bIterating = false;
 		}
 
         bool Create(unsigned int nMaxNum=DEFAULT_MAX_NUM)
@@ -43,10 +53,42 @@ class CSpecialFXList
             m_pAgeArray = debug_newa(uint32, m_nArraySize);
             if (!m_pAgeArray) return false;
 
+			m_pKeyArray = debug_newa(HOBJECT, m_nArraySize);
+			if (!m_pKeyArray) return false;
+
+			m_pUsedMask = debug_newa(uint32, GetUsedMaskSize());
+			if (!m_pUsedMask) return false;
+
+			m_pDenseFX = debug_newa(CSpecialFX*, m_nArraySize);
+			if (!m_pDenseFX) return false;
+
+			m_pDenseSlot = debug_newa(unsigned int, m_nArraySize);
+			if (!m_pDenseSlot) return false;
+
+			m_pDensePos = debug_newa(unsigned int, m_nArraySize);
+			if (!m_pDensePos) return false;
+
+			// Keep the index at most half full of live entries...
+
+			m_nIndexSize = 16;
+			while (m_nIndexSize < m_nArraySize * 2)
+			{
+				m_nIndexSize *= 2;
+			}
+
+			m_pIndex = debug_newa(IndexEntry, m_nIndexSize);
+			if (!m_pIndex) return false;
+
 			m_nElements = 0;
 
 			memset(m_pArray, 0, sizeof(CSpecialFX*)*m_nArraySize);
             memset(m_pAgeArray, 0, sizeof(uint32)*m_nArraySize);
+			memset(m_pKeyArray, 0, sizeof(HOBJECT)*m_nArraySize);
+			memset(m_pUsedMask, 0, sizeof(uint32)*GetUsedMaskSize());
+			memset(m_pDenseFX, 0, sizeof(CSpecialFX*)*m_nArraySize);
+			memset(m_pDenseSlot, 0, sizeof(unsigned int)*m_nArraySize);
+			memset(m_pDensePos, 0, sizeof(unsigned int)*m_nArraySize);
+			ClearIndex();
 
             return true;
 		}
@@ -57,6 +99,86 @@ class CSpecialFXList
 			return m_pArray[nIndex];
 		}
 
+		// Returns the first slot at or after nStart that holds a special fx,
+		// or GetSize() if there are none.  This skips over empty runs of the
+		// array a word at a time, so iterating with it only touches the
+		// special fx that exist.
+
+		unsigned int GetNextSlot(unsigned int nStart) const
+		{
+			while (nStart < m_nArraySize)
+			{
+				uint32 nBits = m_pUsedMask[nStart >> 5] >> (nStart & 31);
+				if (!nBits)
+				{
+					nStart = (nStart | 31) + 1;
+					continue;
+				}
+
+				while (!(nBits & 1))
+				{
+					nBits >>= 1;
+					++nStart;
+				}
+
+				return (nStart < m_nArraySize ? nStart : m_nArraySize);
+			}
+
+			return m_nArraySize;
+		}
+
+		// The special fx are also kept packed at the front of a second array,
+		// 0 to GetNumItems()-1, for loops that want to visit every one of them
+		// without touching empty slots.  Removing a special fx moves the last
+		// one into its place, so a loop that removes the special fx it is on
+		// should visit the same index again rather than moving on.  The
+		// order is not the slot order.  Loops that may remove special fx other
+		// than the one they are on should use BeginIteration instead.
+
+		CSpecialFX* GetDense(unsigned int nIndex) const
+		{
+			return (nIndex < m_nElements ? m_pDenseFX[nIndex] : NULL);
+		}
+
+		unsigned int GetDenseSlot(unsigned int nIndex) const
+		{
+			return (nIndex < m_nElements ? m_pDenseSlot[nIndex] : m_nArraySize);
+		}
+
+		// Visits every special fx once, through the packed array.  Special fx
+		// may be added and removed while iterating, including ones that were
+		// already visited, without any being skipped.  Special fx added while
+		// iterating are visited too.  Only one iteration of a list may be
+		// running at a time.
+
+		void BeginIteration()
+		{
+			ASSERT( !m_bIterating && "CSpecialFXList::BeginIteration:  Already iterating." );
+			m_nVisited   = 0;
+			m_bIterating = true;
+		}
+
+		CSpecialFX* GetNextIteration()
+		{
+			return (m_nVisited < m_nElements ? m_pDenseFX[m_nVisited++] : NULL);
+		}
+
+		void EndIteration()
+		{
+			m_bIterating = false;
+		}
+
+		// Returns the first slot at or after nStart holding a special fx whose
+		// server object is hObj, or GetSize() if there are none.
+
+		unsigned int FindSlotByServerObj(HOBJECT hObj, unsigned int nStart = 0) const;
+
+		CSpecialFX* FindByServerObj(HOBJECT hObj) const
+		{
+			unsigned int nSlot = FindSlotByServerObj(hObj);
+			return (nSlot < m_nArraySize ? m_pArray[nSlot] : NULL);
+		}
+
 		~CSpecialFXList();
 
         bool Add(CSpecialFX* pFX);
@@ -65,10 +187,64 @@ class CSpecialFXList
 
 	private :
 
+		// Entry in the server object index.  Entries are keyed by the server
+		// object the special fx had when it was added.  The server object is
+		// a weak reference that may be cleared later on, so matches are always
+		// checked against the special fx itself.
+
+		struct IndexEntry
+		{
+			HOBJECT			m_hKey;
+			unsigned int	m_nSlot;
+		};
+
+		enum
+		{
+			kIndexEmpty		= 0xFFFFFFFF,
+			kIndexRemoved	= 0xFFFFFFFE,
+		};
+
+		unsigned int GetUsedMaskSize() const { return (m_nArraySize + 31) / 32; }
+
+		void SetSlot(unsigned int nSlot, CSpecialFX* pFX);
+		void ClearSlot(unsigned int nSlot);
+
+		unsigned int FindSlot(CSpecialFX* pFX) const;
+
+		void AddToDense(unsigned int nSlot);
+		void RemoveFromDense(unsigned int nSlot);
+		void MoveDense(unsigned int nFrom, unsigned int nTo);
+
+		void ClearIndex();
+		void AddToIndex(unsigned int nSlot);
+		void RemoveFromIndex(unsigned int nSlot);
+		void RebuildIndex();
+
+		static unsigned int HashObject(HOBJECT hObj)
+		{
+			// Object handles are pointers, so throw away the alignment bits...
+
+			uint32 nHash = (uint32)(size_t)hObj;
+			nHash ^= nHash >> 16;
+			nHash *= 0x45d9f3b;
+			return nHash ^ (nHash >> 16);
+		}
+
 		CSpecialFX**	m_pArray;		// Array of special fx
         uint32*         m_pAgeArray;    // Age special fx in array
+		HOBJECT*		m_pKeyArray;	// Server object each special fx was indexed with
+		uint32*			m_pUsedMask;	// Bit per slot, set if the slot holds a special fx
+		CSpecialFX**	m_pDenseFX;		// The special fx, packed into the first m_nElements entries
+		unsigned int*	m_pDenseSlot;	// Slot of each entry in m_pDenseFX
+		unsigned int*	m_pDensePos;	// Entry in m_pDenseFX of each used slot
 		unsigned int	m_nArraySize;	// Size of array
 		unsigned int	m_nElements;	// Number of elements in array
+		unsigned int	m_nVisited;		// Number of entries in m_pDenseFX already visited by the iteration
+		bool			m_bIterating;	// True between BeginIteration and EndIteration
+
+		IndexEntry*		m_pIndex;		// Open addressing index of slots by server object
+		unsigned int	m_nIndexSize;	// Size of index, always a power of two
+		unsigned int	m_nIndexUsed;	// Number of index entries that are not empty
 };
 
 #endif // __SPECIAL_FX_LIST_H__
\ No newline at end of file
@@ -19,10 +19,21 @@
 #include "ltintersect.h"
 #endif//__LTINTERSECT_H__
 
+#ifndef _ENGINETIMER_H_
+#include "EngineTimer.h"
+#endif//_ENGINETIMER_H_
+
 // **************************************************************************** //
 
 #define OD_INVALID_CLEAR_DELAY			-1000.0f
 
+// How far the source or object can move before a cached line of site result is discarded
+#define OD_LOS_CACHE_TOLERANCE			4.0f
+
+// **************************************************************************** //
+
+ObjectDetector* ObjectDetector::s_pGridDetectors = NULL;
+
 // **************************************************************************** //
 
 ObjectDetectorLink::ObjectDetectorLink()
@@ -31,6 +42,19 @@ ObjectDetectorLink::ObjectDetectorLink()
 	m_pPrev = NULL;
 	m_pNext = NULL;
 	m_pUserData = NULL;
+
+	m_bInGrid = false;
+	m_hGridObject = NULL;
+	m_vGridPos.Init();
+	m_fGridRadius = 0.0f;
+	m_nGridCell[ 0 ] = m_nGridCell[ 1 ] = m_nGridCell[ 2 ] = 0;
+	m_pGridCellNext = NULL;
+	m_pGridObjectNext = NULL;
+
+	m_fLOSCacheTime = 0.0;
+	m_vLOSCacheSource.Init();
+	m_vLOSCacheTarget.Init();
+	m_bLOSCacheResult = false;
 }
 
 // **************************************************************************** //
@@ -66,6 +90,16 @@ ObjectDetector::ObjectDetector()
 
 	m_nRegisteredObjects = 0;
 
+	m_fGridCellSize = 0.0f;
+	m_fGridPadding = 0.0f;
+	m_fGridMaxRadius = 0.0f;
+	memset( m_pGridCells, 0, sizeof( m_pGridCells ) );
+	memset( m_pGridObjects, 0, sizeof( m_pGridObjects ) );
+	m_pGridRefreshLink = NULL;
+	m_pNextGridDetector = NULL;
+
+	m_fLOSCacheTime = 0.0f;
+
 	m_pTrackedLink = NULL;
 	m_vTrackedSpatialPosition.Init();
 	m_vTrackedSpatialDimensions.Init();
@@ -83,6 +117,9 @@ ObjectDetector::~ObjectDetector()
 	{
 		ReleaseLink( *m_iRootLink.m_pNext );
 	}
+
+	// Stop receiving object moves
+	SetBroadphaseParams( 0.0f, 0.0f );
 }
 
 // **************************************************************************** //
@@ -114,6 +151,17 @@ void ObjectDetector::RegisterObject( ObjectDetectorLink& iLink, HOBJECT hObject,
 	}
 
 	m_iRootLink.m_pNext = &iLink;
+
+	// Forget any line of site result from a previous registration
+	iLink.m_fLOSCacheTime = 0.0;
+
+	// Add it to the grid if we have one
+	if( m_fGridCellSize > 0.0f )
+	{
+		LTVector vPos;
+		g_pLTClient->GetObjectPos( hObject, &vPos );
+		GridInsert( &iLink, vPos );
+	}
 }
 
 // **************************************************************************** //
@@ -132,8 +180,18 @@ void ObjectDetector::ReleaseLink( ObjectDetectorLink& iLink )
 
 	if( iLink.m_pDetector )
 	{
+		if( iLink.m_bInGrid )
+		{
+			iLink.m_pDetector->GridRemove( &iLink );
+		}
+
 		--iLink.m_pDetector->m_nRegisteredObjects;
 
+		if( iLink.m_pDetector->m_pGridRefreshLink == &iLink )
+		{
+			iLink.m_pDetector->m_pGridRefreshLink = iLink.m_pNext;
+		}
+
 		if( iLink.m_pDetector->m_pTrackedLink == &iLink )
 		{
 			iLink.m_pDetector->m_pTrackedLink = NULL;
@@ -154,6 +212,99 @@ uint32 ObjectDetector::GetNumRegisteredObjects()
 
 // **************************************************************************** //
 
+void ObjectDetector::SetBroadphaseParams( float fCellSize, float fPadding )
+{
+	// Take everything out of the current grid
+	ObjectDetectorLink* pLink = m_iRootLink.m_pNext;
+
+	while( pLink )
+	{
+		if( pLink->m_bInGrid )
+		{
+			GridRemove( pLink );
+		}
+
+		pLink = pLink->m_pNext;
+	}
+
+	m_fGridMaxRadius = 0.0f;
+	m_pGridRefreshLink = NULL;
+
+	// Remove this detector from the list receiving object moves
+	if( m_fGridCellSize > 0.0f )
+	{
+		ObjectDetector** ppDetector = &s_pGridDetectors;
+
+		while( *ppDetector )
+		{
+			if( *ppDetector == this )
+			{
+				*ppDetector = m_pNextGridDetector;
+				break;
+			}
+
+			ppDetector = &( *ppDetector )->m_pNextGridDetector;
+		}
+
+		m_pNextGridDetector = NULL;
+	}
+
+	m_fGridCellSize = LTMAX( fCellSize, 0.0f );
+	m_fGridPadding = LTMAX( fPadding, 0.0f );
+
+	if( m_fGridCellSize <= 0.0f )
+	{
+		return;
+	}
+
+	m_pNextGridDetector = s_pGridDetectors;
+	s_pGridDetectors = this;
+
+	// Put all the valid objects into the new grid
+	pLink = m_iRootLink.m_pNext;
+
+	while( pLink )
+	{
+		if( pLink->m_hObject.GetData() )
+		{
+			LTVector vPos;
+			g_pLTClient->GetObjectPos( pLink->m_hObject, &vPos );
+			GridInsert( pLink, vPos );
+		}
+
+		pLink = pLink->m_pNext;
+	}
+}
+
+// **************************************************************************** //
+
+void ObjectDetector::OnObjectMove( HOBJECT hObject, const LTVector& vPos )
+{
+	ObjectDetector* pDetector = s_pGridDetectors;
+
+	while( pDetector )
+	{
+		ObjectDetectorLink* pLink = pDetector->m_pGridObjects[ pDetector->GetGridObjectBucket( hObject ) ];
+
+		while( pLink )
+		{
+			// Moving the link can change the bucket order, so get the next one first
+			ObjectDetectorLink* pNext = pLink->m_pGridObjectNext;
+
+			if( pLink->m_hGridObject == hObject )
+			{
+				pDetector->GridMove( pLink, vPos );
+			}
+
+			pLink = pNext;
+		}
+
+		pDetector = pDetector->m_pNextGridDetector;
+	}
+}
+
+// **************************************************************************** //
+
 void ObjectDetector::SetTransform( HOBJECT hObject )
 {
 	if( hObject )
@@ -238,6 +389,13 @@ void ObjectDetector::SetVerifyFailureDelay( uint32 nVerifyFlags, float fSeconds
 
 // **************************************************************************** //
 
+void ObjectDetector::SetLineOfSiteCacheTime( float fSeconds )
+{
+	m_fLOSCacheTime = LTMAX( fSeconds, 0.0f );
+}
+
+// **************************************************************************** //
+
 void ObjectDetector::SetUserFlagVerification( uint32 nFlag )
 {
 	// If we already have an object being tracked, make sure it gets updated
@@ -496,16 +654,10 @@ HOBJECT ObjectDetector::AcquireObject( bool bFromPrevious )
 
 	// Keep track of the links that fit the previous, best, and current requirements
 	ObjectDetectorLink* pPrevTracked = ( bFromPrevious ? m_pTrackedLink : NULL );
-	ObjectDetectorLink* pCurrTracked = NULL;
-	ObjectDetectorLink* pBestTracked = NULL;
 
 	// Requirement ranges and other data tracking variables
 	float fPrevRR = 0.0f;
-	float fCurrRR = 1000000.0f;
-	float fBestRR = 1000000.0f;
-	float fTempRR, fActiveRR;
-	uint32 nAttemptedTests, nPassedTests;
-	bool bContinue;
+	float fTempRR;
 
 	// Get the previously tracked link data... add up the RR values even if the
 	// tests don't pass.  This way we get a relative value to compare to regardless
@@ -552,173 +704,274 @@ HOBJECT ObjectDetector::AcquireObject( bool bFromPrevious )
 		}
 	}
 
-	// Go through each registered object
-	ObjectDetectorLink* pLink = m_iRootLink.m_pNext;
+	AcquireCandidates iCandidates;
 
-	while( pLink )
+	iCandidates.m_pPrevTracked = pPrevTracked;
+	iCandidates.m_pCurrTracked = NULL;
+	iCandidates.m_pBestTracked = NULL;
+	iCandidates.m_fPrevRR = fPrevRR;
+	iCandidates.m_fCurrRR = 1000000.0f;
+	iCandidates.m_fBestRR = 1000000.0f;
+
+	// Go through each registered object that could pass the acquire tests
+	float fRadius;
+
+	if( ( m_fGridCellSize > 0.0f ) && GetAcquireRadius( fRadius ) )
 	{
-		LTVector vPos, vDims;
-		GetObjectSpatialData( pLink, vPos, vDims );
+		AcquireFromGrid( fRadius, iCandidates );
+	}
+	else
+	{
+		ObjectDetectorLink* pLink = m_iRootLink.m_pNext;
 
-		// Ignore the previous tracked link
-		if( pLink == pPrevTracked )
+		while( pLink )
 		{
-			pLink = pLink->m_pNext;
-			continue;
-		}
+			// Get the next link first, in case this one gets released
+			ObjectDetectorLink* pNext = pLink->m_pNext;
 
-		// If this link has invalid object data... release it
-		if( !pLink->m_hObject.GetData() )
-		{
-			ObjectDetectorLink* pRemove = pLink;
-			pLink = pLink->m_pNext;
-			ReleaseLink( *pRemove );
-			continue;
+			AcquireTestLink( pLink, iCandidates );
+
+			// Move on to the next object
+			pLink = pNext;
 		}
+	}
 
-		// Check our user flag verification
-		if( m_nUserFlagVerification )
-		{
-			uint32 nUserFlags;
-			g_pLTClient->Common()->GetObjectFlags( pLink->m_hObject, OFT_User, nUserFlags );
+	// Reset our verification timers
+	memcpy( m_fActiveVerifyFailureDelays, m_fVerifyFailureDelays, sizeof( float ) * ODBF_TESTSAVAILABLE );
 
-			if( ( nUserFlags & m_nUserFlagVerification ) != m_nUserFlagVerification )
-			{
-				continue;
-			}
-		}
+	// Set our tracked link to the proper one
+	if( iCandidates.m_pCurrTracked )
+	{
+		SetLink( iCandidates.m_pCurrTracked );
+	}
+	else if( iCandidates.m_pBestTracked )
+	{
+		SetLink( iCandidates.m_pBestTracked );
+	}
+	else if( !pPrevTracked )
+	{
+		ClearObject();
+	}
 
-		// Zero out our temporary requirement range
-		fActiveRR = 0.0f;
-		nAttemptedTests = 0;
-		nPassedTests = 0;
+	return GetObject();
+}
 
-		// Check all the necessary params
-		if( m_nBehaviorFlags & ODBF_ACQUIREFORWARD )
-		{
-			++nAttemptedTests;
+// **************************************************************************** //
 
-			if( TestParamsForward( pLink, vPos, vDims, fTempRR ) )
-			{
-				fActiveRR += fTempRR;
-				++nPassedTests;
-			}
-		}
+void ObjectDetector::AcquireTestLink( ObjectDetectorLink* pLink, AcquireCandidates& iCandidates )
+{
+	// Ignore the previous tracked link
+	if( pLink == iCandidates.m_pPrevTracked )
+	{
+		return;
+	}
 
-		if( m_nBehaviorFlags & ODBF_ACQUIREDIRECTION )
-		{
-			++nAttemptedTests;
+	// If this link has invalid object data... release it
+	if( !pLink->m_hObject.GetData() )
+	{
+		ReleaseLink( *pLink );
+		return;
+	}
 
-			if( TestParamsDirection( pLink, vPos, vDims, fTempRR ) )
-			{
-				fActiveRR += fTempRR;
-				++nPassedTests;
-			}
-		}
+	// Check our user flag verification
+	if( m_nUserFlagVerification )
+	{
+		uint32 nUserFlags;
+		g_pLTClient->Common()->GetObjectFlags( pLink->m_hObject, OFT_User, nUserFlags );
 
-		if( m_nBehaviorFlags & ODBF_ACQUIREFOV )
+		if( ( nUserFlags & m_nUserFlagVerification ) != m_nUserFlagVerification )
 		{
-			++nAttemptedTests;
-
-			if( TestParamsFOV( pLink, vPos, vDims, fTempRR ) )
-			{
-				fActiveRR += fTempRR;
-				++nPassedTests;
-			}
+			return;
 		}
+	}
 
-		if( m_nBehaviorFlags & ODBF_ACQUIRESPHERE )
-		{
-			++nAttemptedTests;
+	LTVector vPos, vDims;
+	GetObjectSpatialData( pLink, vPos, vDims );
 
-			if( TestParamsSphere( pLink, vPos, vDims, fTempRR ) )
-			{
-				fActiveRR += fTempRR;
-				++nPassedTests;
-			}
-		}
+	// Zero out our temporary requirement range
+	float fTempRR;
+	float fActiveRR = 0.0f;
+	uint32 nAttemptedTests = 0;
+	uint32 nPassedTests = 0;
+	bool bContinue;
 
-		if( m_nBehaviorFlags & ODBF_ACQUIRECYLINDER )
-		{
-			++nAttemptedTests;
+	// Check all the necessary params
+	if( m_nBehaviorFlags & ODBF_ACQUIREFORWARD )
+	{
+		++nAttemptedTests;
 
-			if( TestParamsCylinder( pLink, vPos, vDims, fTempRR ) )
-			{
-				fActiveRR += fTempRR;
-				++nPassedTests;
-			}
+		if( TestParamsForward( pLink, vPos, vDims, fTempRR ) )
+		{
+			fActiveRR += fTempRR;
+			++nPassedTests;
 		}
+	}
 
-		if( m_nBehaviorFlags & ODBF_ACQUIRECUSTOM )
-		{
-			++nAttemptedTests;
+	if( m_nBehaviorFlags & ODBF_ACQUIREDIRECTION )
+	{
+		++nAttemptedTests;
 
-			if( TestParamsCustom( pLink, fTempRR ) )
-			{
-				fActiveRR += fTempRR;
-				++nPassedTests;
-			}
+		if( TestParamsDirection( pLink, vPos, vDims, fTempRR ) )
+		{
+			fActiveRR += fTempRR;
+			++nPassedTests;
 		}
+	}
+
+	if( m_nBehaviorFlags & ODBF_ACQUIREFOV )
+	{
+		++nAttemptedTests;
 
-		// Make sure we passed the required tests...
-		if( m_nBehaviorFlags & ODBF_INCLUSIVEACQUIRE )
+		if( TestParamsFOV( pLink, vPos, vDims, fTempRR ) )
 		{
-			bContinue = ( nPassedTests == nAttemptedTests );
+			fActiveRR += fTempRR;
+			++nPassedTests;
 		}
-		else
+	}
+
+	if( m_nBehaviorFlags & ODBF_ACQUIRESPHERE )
+	{
+		++nAttemptedTests;
+
+		if( TestParamsSphere( pLink, vPos, vDims, fTempRR ) )
 		{
-			bContinue = ( nPassedTests > 0 );
+			fActiveRR += fTempRR;
+			++nPassedTests;
 		}
+	}
 
-		if( bContinue )
+	if( m_nBehaviorFlags & ODBF_ACQUIRECYLINDER )
+	{
+		++nAttemptedTests;
+
+		if( TestParamsCylinder( pLink, vPos, vDims, fTempRR ) )
 		{
-			// Make sure we have a line of site to this object
-			if( m_nBehaviorFlags & ODBF_ACQUIRELINEOFSITE )
-			{
-				bContinue = TestLineOfSite( pLink );
-			}
+			fActiveRR += fTempRR;
+			++nPassedTests;
+		}
+	}
 
-			// If we passed the line of site test...
-			if( bContinue )
-			{
-				// If the active test is better than our best... track it!
-				if( fActiveRR < fBestRR )
-				{
-					fBestRR = fActiveRR;
-					pBestTracked = pLink;
-				}
-
-				// If the active test is after our previous, but better than the current... track it too!
-				if( ( fActiveRR > fPrevRR ) && ( fActiveRR < fCurrRR ) )
-				{
-					fCurrRR = fActiveRR;
-					pCurrTracked = pLink;
-				}
-			}
+	if( m_nBehaviorFlags & ODBF_ACQUIRECUSTOM )
+	{
+		++nAttemptedTests;
+
+		if( TestParamsCustom( pLink, fTempRR ) )
+		{
+			fActiveRR += fTempRR;
+			++nPassedTests;
 		}
+	}
 
-		// Move on to the next object
-		pLink = pLink->m_pNext;
+	// Make sure we passed the required tests...
+	if( m_nBehaviorFlags & ODBF_INCLUSIVEACQUIRE )
+	{
+		bContinue = ( nPassedTests == nAttemptedTests );
+	}
+	else
+	{
+		bContinue = ( nPassedTests > 0 );
 	}
 
-	// Reset our verification timers
-	memcpy( m_fActiveVerifyFailureDelays, m_fVerifyFailureDelays, sizeof( float ) * ODBF_TESTSAVAILABLE );
+	if( !bContinue )
+	{
+		return;
+	}
 
-	// Set our tracked link to the proper one
-	if( pCurrTracked )
+	// Make sure we have a line of site to this object
+	if( ( m_nBehaviorFlags & ODBF_ACQUIRELINEOFSITE ) && !TestLineOfSite( pLink ) )
 	{
-		SetLink( pCurrTracked );
+		return;
 	}
-	else if( pBestTracked )
+
+	// If the active test is better than our best... track it!
+	if( fActiveRR < iCandidates.m_fBestRR )
 	{
-		SetLink( pBestTracked );
+		iCandidates.m_fBestRR = fActiveRR;
+		iCandidates.m_pBestTracked = pLink;
 	}
-	else if( !pPrevTracked )
+
+	// If the active test is after our previous, but better than the current... track it too!
+	if( ( fActiveRR > iCandidates.m_fPrevRR ) && ( fActiveRR < iCandidates.m_fCurrRR ) )
 	{
-		ClearObject();
+		iCandidates.m_fCurrRR = fActiveRR;
+		iCandidates.m_pCurrTracked = pLink;
 	}
+}
 
-	return GetObject();
+// **************************************************************************** //
+
+void ObjectDetector::AcquireFromGrid( float fRadius, AcquireCandidates& iCandidates )
+{
+	// Catch up on any moves that weren't passed to OnObjectMove
+	GridRefresh();
+
+	const LTVector& vSource = m_tTransform.m_vPos;
+
+	// Any object overlapping a cell within this range of the source could pass
+	float fQueryRadius = ( fRadius + m_fGridMaxRadius );
+	float fInvCellSize = ( 1.0f / m_fGridCellSize );
+
+	int32 nMin[ 3 ], nMax[ 3 ];
+
+	nMin[ 0 ] = ( int32 )floorf( ( vSource.x - fQueryRadius ) * fInvCellSize );
+	nMin[ 1 ] = ( int32 )floorf( ( vSource.y - fQueryRadius ) * fInvCellSize );
+	nMin[ 2 ] = ( int32 )floorf( ( vSource.z - fQueryRadius ) * fInvCellSize );
+	nMax[ 0 ] = ( int32 )floorf( ( vSource.x + fQueryRadius ) * fInvCellSize );
+	nMax[ 1 ] = ( int32 )floorf( ( vSource.y + fQueryRadius ) * fInvCellSize );
+	nMax[ 2 ] = ( int32 )floorf( ( vSource.z + fQueryRadius ) * fInvCellSize );
+
+	// If there are more cells in range than buckets, it's cheaper to walk every bucket
+	float fNumCells = ( ( float )( nMax[ 0 ] - nMin[ 0 ] + 1 ) * ( float )( nMax[ 1 ] - nMin[ 1 ] + 1 ) * ( float )( nMax[ 2 ] - nMin[ 2 ] + 1 ) );
+
+	if( fNumCells > ( float )ODBF_GRIDBUCKETS )
+	{
+		for( uint32 nBucket = 0; nBucket < ODBF_GRIDBUCKETS; ++nBucket )
+		{
+			AcquireFromGridBucket( nBucket, NULL, fRadius, iCandidates );
+		}
+
+		return;
+	}
+
+	int32 nCell[ 3 ];
+
+	for( nCell[ 0 ] = nMin[ 0 ]; nCell[ 0 ] <= nMax[ 0 ]; ++nCell[ 0 ] )
+	{
+		for( nCell[ 1 ] = nMin[ 1 ]; nCell[ 1 ] <= nMax[ 1 ]; ++nCell[ 1 ] )
+		{
+			for( nCell[ 2 ] = nMin[ 2 ]; nCell[ 2 ] <= nMax[ 2 ]; ++nCell[ 2 ] )
+			{
+				AcquireFromGridBucket( GetGridCellBucket( nCell ), nCell, fRadius, iCandidates );
+			}
+		}
+	}
+}
+
+// **************************************************************************** //
+
+void ObjectDetector::AcquireFromGridBucket( uint32 nBucket, const int32* pCell, float fRadius, AcquireCandidates& iCandidates )
+{
+	ObjectDetectorLink* pLink = m_pGridCells[ nBucket ];
+
+	while( pLink )
+	{
+		// Get the next link first, in case this one gets released
+		ObjectDetectorLink* pNext = pLink->m_pGridCellNext;
+
+		// Cells can share a bucket, so make sure each link is only visited from its own cell
+		if( !pCell || ( ( pLink->m_nGridCell[ 0 ] == pCell[ 0 ] ) && ( pLink->m_nGridCell[ 1 ] == pCell[ 1 ] ) && ( pLink->m_nGridCell[ 2 ] == pCell[ 2 ] ) ) )
+		{
+			// Skip anything too far away to pass before doing any real work on it
+			float fReach = ( fRadius + pLink->m_fGridRadius );
+
+			if( ( pLink->m_vGridPos - m_tTransform.m_vPos ).MagSqr() <= ( fReach * fReach ) )
+			{
+				AcquireTestLink( pLink, iCandidates );
+			}
+		}
+
+		pLink = pNext;
+	}
 }
 
 // **************************************************************************** //
@@ -841,23 +1094,57 @@ bool ObjectDetector::ClearingObject()
 
 bool ObjectDetector::TestLineOfSite( ObjectDetectorLink* pLink )
 {
+	LTVector vTarget;
+	g_pLTClient->GetObjectPos( pLink->m_hObject, &vTarget );
+
+	// Reuse a recent result if neither end of the test has moved.  A custom test
+	// may depend on more than the positions, so its results aren't kept.
+	bool bCache = ( ( m_fLOSCacheTime > 0.0f ) && !m_pLineOfSiteFn );
+	double fTime = 0.0;
+
+	if( bCache )
+	{
+		fTime = RealTimeTimer::Instance().GetTimerAccumulatedS();
+
+		if( ( pLink->m_fLOSCacheTime > 0.0 ) && ( ( fTime - pLink->m_fLOSCacheTime ) < m_fLOSCacheTime ) &&
+			pLink->m_vLOSCacheSource.NearlyEquals( m_tTransform.m_vPos, OD_LOS_CACHE_TOLERANCE ) &&
+			pLink->m_vLOSCacheTarget.NearlyEquals( vTarget, OD_LOS_CACHE_TOLERANCE ) )
+		{
+			return pLink->m_bLOSCacheResult;
+		}
+	}
+
+	bool bResult;
+
 	// If we have an override line of site test... use that instead
 	if( m_pLineOfSiteFn )
 	{
-		return ( *m_pLineOfSiteFn )( m_tTransform.m_vPos, pLink, m_pLineOfSiteUserData );
+		bResult = ( *m_pLineOfSiteFn )( m_tTransform.m_vPos, pLink, m_pLineOfSiteUserData );
 	}
+	else
+	{
+		// Do a basic line of site test... allowing only world geometry to block the view
+		IntersectQuery iQuery;
+		IntersectInfo iInfo;
+
+		iQuery.m_Flags		= IGNORE_NONSOLID;
+		iQuery.m_FilterFn	= NULL;
+		iQuery.m_pUserData	= NULL;
+		iQuery.m_From		= m_tTransform.m_vPos;
+		iQuery.m_To			= vTarget;
 
-	// Do a basic line of site test... allowing only world geometry to block the view
-	IntersectQuery iQuery;
-	IntersectInfo iInfo;
+		bResult = !g_pLTClient->IntersectSegment( iQuery, &iInfo );
+	}
 
-	iQuery.m_Flags		= IGNORE_NONSOLID;
-	iQuery.m_FilterFn	= NULL;
-	iQuery.m_pUserData	= NULL;
-	iQuery.m_From		= m_tTransform.m_vPos;
-	g_pLTClient->GetObjectPos( pLink->m_hObject, &iQuery.m_To );
+	if( bCache )
+	{
+		pLink->m_fLOSCacheTime = fTime;
+		pLink->m_vLOSCacheSource = m_tTransform.m_vPos;
+		pLink->m_vLOSCacheTarget = vTarget;
+		pLink->m_bLOSCacheResult = bResult;
+	}
 
-	return !g_pLTClient->IntersectSegment( iQuery, &iInfo );
+	return bResult;
 }
 
 // **************************************************************************** //
@@ -1071,3 +1358,185 @@ bool ObjectDetector::TestParamsCustom( ObjectDetectorLink* pLink, float& fMetRR
 
 	return bPassed;
 }
+
+// **************************************************************************** //
+
+bool ObjectDetector::GetAcquireRadius( float& fRadius )
+{
+	bool bInclusive = ( ( m_nBehaviorFlags & ODBF_INCLUSIVEACQUIRE ) != 0 );
+
+	// A custom test can pass objects anywhere, so unless every test needs to pass
+	// there's no limit to where an object could be acquired.
+	if( ( m_nBehaviorFlags & ODBF_ACQUIRECUSTOM ) && !bInclusive )
+	{
+		return false;
+	}
+
+	// The furthest each test could pass an object from the source
+	uint32 nTestFlags[ 5 ] = { ODBF_ACQUIREFORWARD, ODBF_ACQUIREDIRECTION, ODBF_ACQUIREFOV, ODBF_ACQUIRESPHERE, ODBF_ACQUIRECYLINDER };
+	float fTestRadius[ 5 ];
+
+	fTestRadius[ 0 ] = fabs( m_fParamsForward );
+	fTestRadius[ 1 ] = m_vParamsDirection.Mag();
+	fTestRadius[ 2 ] = sqrtf( LTMAX( m_vParamsFOV.w, 0.0f ) );
+	fTestRadius[ 3 ] = sqrtf( LTMAX( m_vParamsSphere.y, 0.0f ) );
+	fTestRadius[ 4 ] = sqrtf( LTMAX( m_vParamsCylinder.y, 0.0f ) + ( m_vParamsCylinder.z * m_vParamsCylinder.z ) );
+
+	// Any test can pass an object unless they all need to, in which case the
+	// smallest range limits it.
+	bool bBounded = false;
+
+	for( uint32 nTest = 0; nTest < 5; ++nTest )
+	{
+		if( !( m_nBehaviorFlags & nTestFlags[ nTest ] ) )
+		{
+			continue;
+		}
+
+		if( !bBounded || ( bInclusive ? ( fTestRadius[ nTest ] < fRadius ) : ( fTestRadius[ nTest ] > fRadius ) ) )
+		{
+			fRadius = fTestRadius[ nTest ];
+		}
+
+		bBounded = true;
+	}
+
+	return bBounded;
+}
+
+// **************************************************************************** //
+
+void ObjectDetector::GridInsert( ObjectDetectorLink* pLink, const LTVector& vPos )
+{
+	// Size the object by its dims and the padding for the spatial function
+	LTVector vDims;
+	g_pLTClient->Physics()->GetObjectDims( pLink->m_hObject, &vDims );
+
+	pLink->m_vGridPos = vPos;
+	pLink->m_fGridRadius = ( vDims.Mag() + m_fGridPadding );
+
+	if( pLink->m_fGridRadius > m_fGridMaxRadius )
+	{
+		m_fGridMaxRadius = pLink->m_fGridRadius;
+	}
+
+	// Hook it up to its cell
+	float fInvCellSize = ( 1.0f / m_fGridCellSize );
+
+	pLink->m_nGridCell[ 0 ] = ( int32 )floorf( vPos.x * fInvCellSize );
+	pLink->m_nGridCell[ 1 ] = ( int32 )floorf( vPos.y * fInvCellSize );
+	pLink->m_nGridCell[ 2 ] = ( int32 )floorf( vPos.z * fInvCellSize );
+
+	uint32 nCellBucket = GetGridCellBucket( pLink->m_nGridCell );
+	pLink->m_pGridCellNext = m_pGridCells[ nCellBucket ];
+	m_pGridCells[ nCellBucket ] = pLink;
+
+	// Hook it up to its object, keeping the handle in case the reference gets cleared
+	pLink->m_hGridObject = pLink->m_hObject;
+
+	uint32 nObjectBucket = GetGridObjectBucket( pLink->m_hGridObject );
+	pLink->m_pGridObjectNext = m_pGridObjects[ nObjectBucket ];
+	m_pGridObjects[ nObjectBucket ] = pLink;
+
+	pLink->m_bInGrid = true;
+}
+
+// **************************************************************************** //
+
+void ObjectDetector::GridRemove( ObjectDetectorLink* pLink )
+{
+	ObjectDetectorLink** ppLink = &m_pGridCells[ GetGridCellBucket( pLink->m_nGridCell ) ];
+
+	while( *ppLink )
+	{
+		if( *ppLink == pLink )
+		{
+			*ppLink = pLink->m_pGridCellNext;
+			break;
+		}
+
+		ppLink = &( *ppLink )->m_pGridCellNext;
+	}
+
+	ppLink = &m_pGridObjects[ GetGridObjectBucket( pLink->m_hGridObject ) ];
+
+	while( *ppLink )
+	{
+		if( *ppLink == pLink )
+		{
+			*ppLink = pLink->m_pGridObjectNext;
+			break;
+		}
+
+		ppLink = &( *ppLink )->m_pGridObjectNext;
+	}
+
+	pLink->m_bInGrid = false;
+	pLink->m_hGridObject = NULL;
+	pLink->m_pGridCellNext = NULL;
+	pLink->m_pGridObjectNext = NULL;
+}
+
+// **************************************************************************** //
+
+void ObjectDetector::GridMove( ObjectDetectorLink* pLink, const LTVector& vPos )
+{
+	float fInvCellSize = ( 1.0f / m_fGridCellSize );
+
+	// If it's still in the same cell, only the position needs to change
+	if( ( pLink->m_nGridCell[ 0 ] == ( int32 )floorf( vPos.x * fInvCellSize ) ) &&
+		( pLink->m_nGridCell[ 1 ] == ( int32 )floorf( vPos.y * fInvCellSize ) ) &&
+		( pLink->m_nGridCell[ 2 ] == ( int32 )floorf( vPos.z * fInvCellSize ) ) )
+	{
+		pLink->m_vGridPos = vPos;
+		return;
+	}
+
+	GridRemove( pLink );
+
+	if( pLink->m_hObject.GetData() )
+	{
+		GridInsert( pLink, vPos );
+	}
+}
+
+// **************************************************************************** //
+
+void ObjectDetector::GridRefresh()
+{
+	uint32 nNumRefresh = LTMIN( ( uint32 )ODBF_GRIDREFRESHCOUNT, m_nRegisteredObjects );
+
+	for( uint32 nRefresh = 0; nRefresh < nNumRefresh; ++nRefresh )
+	{
+		// Start over from the front once the end of the list is reached
+		if( !m_pGridRefreshLink )
+		{
+			m_pGridRefreshLink = m_iRootLink.m_pNext;
+		}
+
+		ObjectDetectorLink* pLink = m_pGridRefreshLink;
+		m_pGridRefreshLink = pLink->m_pNext;
+
+		if( pLink->m_bInGrid && pLink->m_hObject.GetData() )
+		{
+			LTVector vPos;
+			g_pLTClient->GetObjectPos( pLink->m_hObject, &vPos );
+			GridMove( pLink, vPos );
+		}
+	}
+}
+
+// **************************************************************************** //
+
+uint32 ObjectDetector::GetGridCellBucket( const int32* pCell )
+{
+	uint32 nHash = ( ( ( uint32 )pCell[ 0 ] * 73856093 ) ^ ( ( uint32 )pCell[ 1 ] * 19349663 ) ^ ( ( uint32 )pCell[ 2 ] * 83492791 ) );
+	return ( nHash & ( ODBF_GRIDBUCKETS - 1 ) );
+}
+
+// **************************************************************************** //
+
+uint32 ObjectDetector::GetGridObjectBucket( HOBJECT hObject )
+{
+	return ( ( uint32 )( ( size_t )hObject >> 4 ) & ( ODBF_GRIDBUCKETS - 1 ) );
+}
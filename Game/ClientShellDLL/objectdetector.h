@@ -33,6 +33,9 @@ class ObjectDetector;
 // If the object reference becomes invalid, the link will release itself from
 // the registered detector class upon the next attempt at using the link.
 // Otherwise, it will also release itself upon destruction of the link.
+//
+// The grid and line of site members are managed by the detector the link is
+// registered with.
 
 class ObjectDetectorLink
 {
@@ -55,6 +58,21 @@ class ObjectDetectorLink
 		ObjectDetectorLink*		m_pNext;
 		void*					m_pUserData;
 
+		// Broadphase grid data
+		bool					m_bInGrid;
+		HOBJECT					m_hGridObject;
+		LTVector				m_vGridPos;
+		float					m_fGridRadius;
+		int32					m_nGridCell[ 3 ];
+		ObjectDetectorLink*		m_pGridCellNext;
+		ObjectDetectorLink*		m_pGridObjectNext;
+
+		// Cached line of site result
+		double					m_fLOSCacheTime;
+		LTVector				m_vLOSCacheSource;
+		LTVector				m_vLOSCacheTarget;
+		bool					m_bLOSCacheResult;
+
 		friend ObjectDetector;
 };
 
@@ -134,6 +152,12 @@ class ObjectDetector
 
 			ODBF_FORCE32BIT					= 0x7FFFFFFF,
 
+			// Number of hash buckets used by the broadphase grid (must be a power of two)
+			ODBF_GRIDBUCKETS				= 256,
+
+			// Number of links re-read from the engine each time the grid is queried
+			ODBF_GRIDREFRESHCOUNT			= 16,
+
 			// EXAMPLE:  If you wanted to acquire an object from the center of the player camera based on a button press,
 			// and hang onto that object as long as it is within a radius of the camera... you would setup a Detector
 			// using the ACQUIREFORWARD | VERIFYSPHERE flags and set the appropriate Params.  Then you would call AcquireObject()
@@ -158,6 +182,17 @@ class ObjectDetector
 
 		uint32		GetNumRegisteredObjects();
 
+		// Enables a grid of the registered objects so that acquiring only tests the
+		// objects near enough to pass the acquire tests.  The padding is added to the
+		// dims of each object, and should cover any offset applied by the spatial
+		// function.  A cell size of zero disables the grid.  The grid follows the
+		// moves passed to OnObjectMove.  Not every move is guaranteed to be passed
+		// along, so each query also re-reads the positions of a few links in turn.
+		void		SetBroadphaseParams( float fCellSize, float fPadding );
+
+		// Should be called by the client shell whenever the engine moves an object.
+		static void	OnObjectMove( HOBJECT hObject, const LTVector& vPos );
+
 
 		// ---------------------------------------------------------------------------- //
 		// Detection source control
@@ -182,6 +217,12 @@ class ObjectDetector
 		void		SetBehaviorFlags( uint32 nFlags );
 		void		SetVerifyFailureDelay( uint32 nVerifyFlags, float fSeconds );
 
+		// Line of site results are reused for this long, as long as neither the source
+		// nor the object has moved.  Zero disables the cache.  Results from a custom
+		// line of site function are never cached, since they may depend on more than
+		// the two positions.
+		void		SetLineOfSiteCacheTime( float fSeconds );
+
 		// Sets a user flag that will be managed internally on detected objects... this makes it
 		// so you can avoid overlaps in case one object is affected by multiple detectors.
 		void		SetUserFlagVerification( uint32 nFlag );
@@ -252,6 +293,45 @@ class ObjectDetector
 		bool		TestParamsCylinder( ObjectDetectorLink* pLink, LTVector& vPos, LTVector& vDims, float& fMetRR );
 		bool		TestParamsCustom( ObjectDetectorLink* pLink, float& fMetRR );
 
+		// Gets the radius around the source that an object must be within to be acquired.
+		bool		GetAcquireRadius( float& fRadius );
+
+
+	protected:
+
+		// ---------------------------------------------------------------------------- //
+		// Acquiring
+
+		// Links that fit the previous, best, and current requirements
+		struct AcquireCandidates
+		{
+			ObjectDetectorLink*	m_pPrevTracked;
+			ObjectDetectorLink*	m_pCurrTracked;
+			ObjectDetectorLink*	m_pBestTracked;
+
+			float				m_fPrevRR;
+			float				m_fCurrRR;
+			float				m_fBestRR;
+		};
+
+		void		AcquireTestLink( ObjectDetectorLink* pLink, AcquireCandidates& iCandidates );
+		void		AcquireFromGrid( float fRadius, AcquireCandidates& iCandidates );
+
+		// Tests the links in a grid bucket, only those in the given cell if there is one.
+		void		AcquireFromGridBucket( uint32 nBucket, const int32* pCell, float fRadius, AcquireCandidates& iCandidates );
+
+
+		// ---------------------------------------------------------------------------- //
+		// Broadphase grid
+
+		void		GridInsert( ObjectDetectorLink* pLink, const LTVector& vPos );
+		void		GridRemove( ObjectDetectorLink* pLink );
+		void		GridMove( ObjectDetectorLink* pLink, const LTVector& vPos );
+		void		GridRefresh();
+
+		uint32		GetGridCellBucket( const int32* pCell );
+		uint32		GetGridObjectBucket( HOBJECT hObject );
+
 
 	protected:
 
@@ -294,6 +374,33 @@ class ObjectDetector
 		uint32				m_nRegisteredObjects;
 
 
+		// ---------------------------------------------------------------------------- //
+		// Broadphase grid variables
+
+		float				m_fGridCellSize;
+		float				m_fGridPadding;
+
+		// The largest radius of any object in the grid, used to expand queries
+		float				m_fGridMaxRadius;
+
+		// Links hashed by the cell they are in, and by their object
+		ObjectDetectorLink*	m_pGridCells[ ODBF_GRIDBUCKETS ];
+		ObjectDetectorLink*	m_pGridObjects[ ODBF_GRIDBUCKETS ];
+
+		// The next link to re-read the position of when the grid is queried
+		ObjectDetectorLink*	m_pGridRefreshLink;
+
+		// All the detectors with a grid, so object moves can be passed along
+		ObjectDetector*		m_pNextGridDetector;
+		static ObjectDetector*	s_pGridDetectors;
+
+
+		// ---------------------------------------------------------------------------- //
+		// Line of site cache variables
+
+		float				m_fLOSCacheTime;
+
+
 		// ---------------------------------------------------------------------------- //
 		// Object tracking variables
 
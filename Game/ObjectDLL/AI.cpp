@@ -41,6 +41,7 @@
 #include "AINavMeshLinkDoor.h"
 #include "AICommandMgr.h"
 #include "AIPlanner.h"
+#include "AIVisibilityMgr.h"
 #include "SurfaceFunctions.h"
 #include "PhysicsUtilities.h"
 #include "Weapon.h"
@@ -241,6 +242,11 @@ bool CAI::DefaultFilterFn(HOBJECT hObj, void *pUserData)
 	return true;
 }
 
+void CAI::SetFilterAI( HOBJECT hAI )
+{
+	s_hFilterAI = hAI;
+}
+
 bool CAI::ShootThroughFilterFn(HOBJECT hObj, void *pUserData)
 {
     if ( !hObj ) return false;
@@ -1798,24 +1804,27 @@ bool CAI::FindFloorHeight(const LTVector& vPos, float* pfFloorHeight)
 {
 	AIASSERT( pfFloorHeight, m_hObject, "CAI::FindFloorHeight: fFloorHeight is NULL" );
 
-	IntersectQuery IQuery;
-	IntersectInfo IInfo;
+	SAIVisibilityQuery Query;
+	SAIVisibilityResult Result;
 
-	IQuery.m_From = LTVector(vPos.x, vPos.y + m_vDims.y, vPos.z);
-	IQuery.m_To = LTVector(vPos.x, vPos.y - m_vDims.y*10.0f, vPos.z);
+	Query.m_vFrom = LTVector(vPos.x, vPos.y + m_vDims.y, vPos.z);
+	Query.m_vTo = LTVector(vPos.x, vPos.y - m_vDims.y*10.0f, vPos.z);
 
-	IQuery.m_Flags = INTERSECT_OBJECTS | IGNORE_NONSOLID | INTERSECT_HPOLY;
-	IQuery.m_FilterFn = GroundFilterFn;
+	Query.m_dwFlags = INTERSECT_OBJECTS | IGNORE_NONSOLID | INTERSECT_HPOLY;
+	Query.m_fnObjectFilter = GroundFilterFn;
+	Query.m_eQueryClass = kAIVisQuery_Ground;
 
-	g_cIntersectSegmentCalls++;
-    if (g_pLTServer->IntersectSegment(IQuery, &IInfo) && (IsMainWorld(IInfo.m_hObject) || (OT_WORLDMODEL == GetObjectType(IInfo.m_hObject))))
+    if (g_pAIVisibilityMgr->IntersectSegment(Query, &Result) && (IsMainWorld(Result.m_hObject) || (OT_WORLDMODEL == GetObjectType(Result.m_hObject))))
 	{
-		*pfFloorHeight = IInfo.m_Point.y + m_vDims.y;
+		*pfFloorHeight = Result.m_vPoint.y + m_vDims.y;
 
 		// [KLS 8/8/02] Set the standing on surface based on whatever we're standing on.
 		// This is used in CCharacter::HandleModelString() to determine the stimuli
 		// to register for AI walking around...
 
+		IntersectInfo IInfo;
+		IInfo.m_hObject = Result.m_hObject;
+		IInfo.m_hPoly = Result.m_hPoly;
 		m_eStandingOnSurface = GetSurfaceType(IInfo);
 		
 		return true;
@@ -3517,21 +3526,30 @@ bool CAI::IsObjectPositionVisible(ObjectFilterFn ofn, PolyFilterFn pfn, const LT
 		}
 	}
 
-	IntersectQuery IQuery;
-	IntersectInfo IInfo;
+	// Rays go through the visibility manager, so identical rays cast
+	// by several sensors share a single IntersectSegment.
 
-	IQuery.m_From = vSourcePosition;
-	IQuery.m_To = vObjectPosition;
+	SAIVisibilityQuery VisQuery;
+	SAIVisibilityResult VisResult;
 
-	IQuery.m_Flags	  = INTERSECT_OBJECTS | IGNORE_NONSOLID | (pfn ? INTERSECT_HPOLY : 0);
-	IQuery.m_FilterFn = ofn;
-	IQuery.m_PolyFilterFn = pfn;
+	VisQuery.m_hFilterObject = m_hObject;
+	VisQuery.m_vFrom = vSourcePosition;
+	VisQuery.m_vTo = vObjectPosition;
 
-	s_hFilterAI = m_hObject;
+	VisQuery.m_dwFlags	= INTERSECT_OBJECTS | IGNORE_NONSOLID | (pfn ? INTERSECT_HPOLY : 0);
+	VisQuery.m_fnObjectFilter = ofn;
+	VisQuery.m_fnPolyFilter = pfn;
 
-	g_cIntersectSegmentCalls++;
+	if ( ofn == ShootThroughFilterFn )
+	{
+		VisQuery.m_eQueryClass = kAIVisQuery_ShootThrough;
+	}
+	else if ( ofn == SeeThroughFilterFn )
+	{
+		VisQuery.m_eQueryClass = kAIVisQuery_SeeThrough;
+	}
 
-	bool bIntersected = g_pLTServer->IntersectSegment(IQuery, &IInfo);
+	bool bIntersected = g_pAIVisibilityMgr->IntersectSegment(VisQuery, &VisResult);
 
 	if (!hObj)
 	{
@@ -3542,10 +3560,10 @@ bool CAI::IsObjectPositionVisible(ObjectFilterFn ofn, PolyFilterFn pfn, const LT
 	}
 	else
 	{
-		LTASSERT(!IsCharacterHitBox(IInfo.m_hObject), "Intersection does not collide with character hitboxes");
+		LTASSERT(!IsCharacterHitBox(VisResult.m_hObject), "Intersection does not collide with character hitboxes");
 		LTASSERT(!IsCharacterHitBox(hObj), "Intersection does not collide with character hitboxes");
 
-		if ( hObj == IInfo.m_hObject )
+		if ( hObj == VisResult.m_hObject )
 		{
 			return true;
 		}
@@ -3553,7 +3571,7 @@ bool CAI::IsObjectPositionVisible(ObjectFilterFn ofn, PolyFilterFn pfn, const LT
 
 	if( phBlockingObject )
 	{
-		*phBlockingObject = IInfo.m_hObject;
+		*phBlockingObject = VisResult.m_hObject;
 	}
 
     return false;
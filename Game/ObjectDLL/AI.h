@@ -212,6 +212,10 @@ class CAI : public CCharacter
         static bool SeeThroughFilterFn(HOBJECT hObj, void *pUserData);
         static bool SeeThroughPolyFilterFn(HPOLY hPoly, void *pUserData, const LTVector& vIntersectPoint);
 
+		// Set the object the filter functions ignore.
+
+		static void SetFilterAI( HOBJECT hAI );
+
         bool CanSeeThrough() { return m_bSeeThrough; }
         bool CanShootThrough() { return m_bShootThrough; }
 
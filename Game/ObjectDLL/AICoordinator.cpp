@@ -20,6 +20,7 @@
 #include "AIBlackBoard.h"
 #include "Character.h"
 #include "CharacterMgr.h"
+#include "lttimeutils.h"
 
 // Globals / Statics
 
@@ -28,6 +29,18 @@ CAICoordinator* g_pAICoordinator = NULL;
 #define SQUAD_THRESH_WIDTH		800.f
 #define SQUAD_THRESH_HEIGHT		250.f
 
+// Squad generation grid cells are sized so that an AI's clustering box
+// touches at most two cells along each axis.  The cell size is doubled
+// until the grid fits within the maximum cell count.
+
+#define SQUAD_GRID_CELL_SIZE	( 2.f * SQUAD_THRESH_WIDTH )
+#define SQUAD_GRID_MAX_CELLS	4096
+
+// Testing every squad is quicker until there are dozens of squads, which
+// takes a few hundred spread out AI (see RunSquadBenchmark).
+
+#define SQUAD_GRID_MIN_CANDIDATES	256
+
 // ----------------------------------------------------------------------- //
 //
 //	ROUTINE:	CAICoordinator::Con/destructor
@@ -45,6 +58,12 @@ CAICoordinator::CAICoordinator()
 	m_iSquadToUpdate = 0;
 	m_fSquadRegenRate = 1.f;
 	m_fNextSquadRegenTime = 0.f;
+
+	m_fSquadGridOriginX = 0.f;
+	m_fSquadGridOriginZ = 0.f;
+	m_fSquadGridInvCellSize = 1.f / SQUAD_GRID_CELL_SIZE;
+	m_cSquadGridCellsX = 0;
+	m_cSquadGridCellsZ = 0;
 }
 
 CAICoordinator::~CAICoordinator()
@@ -143,24 +162,14 @@ void CAICoordinator::GenerateSquads()
 	CCharacter** pCur;
 	CAI* pCurAI;
 
-	// Create the bounding box representing the clustering area of an AI.
-	// An AI will cluster with any squad that overlaps this box.
-
-	LTRect3f AIAABB;
-	LTVector vDims( SQUAD_THRESH_WIDTH, SQUAD_THRESH_HEIGHT, SQUAD_THRESH_WIDTH );
-	AIAABB.Init( -vDims, vDims );
-
-	ENUM_AI_SQUAD_ID eSquadID;
 	CAISquad* pSquad;
-	CAISquad* pMergeSquad;
-	unsigned int iSquad;
 	ENUM_AIActivitySet eActivitySet;
 	AIDB_ActivitySetRecord* pActivitySetRecord;
+	SAISquadCandidate Candidate;
 
-	m_cSquads = 0;
-	m_iSquadToUpdate = 0;
+	// Gather the AI that may be placed in a squad.
 
-	// Place each AI in a squad.
+	m_lstSquadCandidates.resize( 0 );
 
 	pCur = plstChars->GetItem( TLIT_FIRST );
 	while( pCur )
@@ -210,18 +219,100 @@ void CAICoordinator::GenerateSquads()
 			continue;
 		}
 
+		Candidate.hAI = pCurAI->m_hObject;
+		Candidate.vPos = pCurAI->GetPosition();
+		Candidate.eAlignment = pCurAI->GetAlignment();
+		m_lstSquadCandidates.push_back( Candidate );
+	}
+
+	// Place each AI in a squad.
+
+	PlaceSquadCandidates( m_lstSquadCandidates, m_lstSquadCandidates.size() >= SQUAD_GRID_MIN_CANDIDATES );
+
+	// Compact squads to get rid of squads invalidated due to merging.
+
+	CompactSquads();
+
+	// Initialize squad activities.
+
+	AI_SQUAD_LIST::iterator itSquad;
+	for( itSquad = m_lstSquads.begin(); itSquad != m_lstSquads.end(); ++itSquad )
+	{
+		pSquad = *itSquad;
+		if( pSquad )
+		{
+			pSquad->InitActivities();
+		}
+	}
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAICoordinator::PlaceSquadCandidates
+//
+//	PURPOSE:	Place each candidate AI in a squad, merging squads that
+//				an AI overlaps.  Squads are not compacted.
+//
+// ----------------------------------------------------------------------- //
+
+void CAICoordinator::PlaceSquadCandidates( const AI_SQUAD_CANDIDATE_LIST& lstCandidates, bool bUseSquadGrid )
+{
+	// Create the bounding box representing the clustering area of an AI.
+	// An AI will cluster with any squad that overlaps this box.
+
+	LTRect3f AIAABB;
+	LTVector vDims( SQUAD_THRESH_WIDTH, SQUAD_THRESH_HEIGHT, SQUAD_THRESH_WIDTH );
+	AIAABB.Init( -vDims, vDims );
+
+	ENUM_AI_SQUAD_ID eSquadID;
+	CAISquad* pSquad;
+	CAISquad* pMergeSquad;
+	uint32 iSquad;
+
+	m_cSquads = 0;
+	m_iSquadToUpdate = 0;
+
+	// Size the grid to cover the clustering boxes of all candidates.
+	// There can never be more squads than candidates.
+
+	if( bUseSquadGrid )
+	{
+		InitSquadGrid( lstCandidates );
+	}
+
+	uint32 cCandidates = lstCandidates.size();
+	for( uint32 iCandidate=0; iCandidate < cCandidates; ++iCandidate )
+	{
+		const SAISquadCandidate& Candidate = lstCandidates[iCandidate];
+
 		// Move box to the AI's position.
 
-		AIAABB.Offset( pCurAI->GetPosition() );
+		AIAABB.Offset( Candidate.vPos );
 
 		// Initially AI is not in any squad.
 
 		eSquadID = kSquad_Invalid;
 
-		// Check box against each squad.
+		// Check box against each squad registered in the cells under it.
+		// Squads are visited in ascending order, so the AI joins and
+		// merges squads exactly as it would checking every squad.
 
-		for( iSquad = 0; iSquad < m_cSquads; ++iSquad )
+		if( bUseSquadGrid )
 		{
+			GatherSquadGridSquads( AIAABB, iCandidate + 1 );
+		}
+		else {
+			m_lstSquadGridSquads.resize( 0 );
+			for( iSquad = 0; iSquad < m_cSquads; ++iSquad )
+			{
+				m_lstSquadGridSquads.push_back( iSquad );
+			}
+		}
+
+		AI_SQUAD_INDEX_LIST::iterator itGridSquad;
+		for( itGridSquad = m_lstSquadGridSquads.begin(); itGridSquad != m_lstSquadGridSquads.end(); ++itGridSquad )
+		{
+			iSquad = *itGridSquad;
 			pSquad = m_lstSquads[iSquad];
 
 			// Skip squads that have been invalidated due to merging.
@@ -233,7 +324,7 @@ void CAICoordinator::GenerateSquads()
 
 			// Skip squad if alignment does not match.
 
-			if( pSquad->GetSquadAlignment() != pCurAI->GetAlignment() )
+			if( pSquad->GetSquadAlignment() != Candidate.eAlignment )
 			{
 				continue;
 			}
@@ -248,8 +339,12 @@ void CAICoordinator::GenerateSquads()
 				{
 					// Add AI to squad.
 
-					pSquad->AddSquadMember( pCurAI->m_hObject, AIAABB );
+					pSquad->AddSquadMember( Candidate.hAI, AIAABB );
 					eSquadID = pSquad->GetSquadID();
+					if( bUseSquadGrid )
+					{
+						UpdateSquadGridCells( iSquad );
+					}
 				}
 
 				// AI is already in another squad.
@@ -257,11 +352,13 @@ void CAICoordinator::GenerateSquads()
 				else {
 
 					// Merge this squad with the one the AI is already in.
+					// Squad IDs match squad indices until squads are compacted.
 
-					pMergeSquad = FindSquad( eSquadID );
-					if( pMergeSquad )
+					pMergeSquad = m_lstSquads[eSquadID];
+					pMergeSquad->MergeSquad( pSquad );
+					if( bUseSquadGrid )
 					{
-						pMergeSquad->MergeSquad( pSquad );
+						UpdateSquadGridCells( eSquadID );
 					}
 				}
 			}
@@ -283,31 +380,394 @@ void CAICoordinator::GenerateSquads()
 			// Setup the new squad.
 
 			pSquad = m_lstSquads[m_cSquads];
-			pSquad->InitSquad( ( ENUM_AI_SQUAD_ID )m_cSquads, pCurAI->GetAlignment() );
-			pSquad->AddSquadMember( pCurAI->m_hObject, AIAABB );
+			pSquad->InitSquad( ( ENUM_AI_SQUAD_ID )m_cSquads, Candidate.eAlignment );
+			pSquad->AddSquadMember( Candidate.hAI, AIAABB );
+			if( bUseSquadGrid )
+			{
+				UpdateSquadGridCells( m_cSquads );
+			}
 			++m_cSquads;
 		}
 
-		AIAABB.Offset( -pCurAI->GetPosition() );
+		AIAABB.Offset( -Candidate.vPos );
 	}
+}
 
-	// Compact squads to get rid of squads invalidated due to merging.
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAICoordinator::InitSquadGrid
+//
+//	PURPOSE:	Size and clear the squad generation grid so that it covers
+//				the clustering boxes of all of the candidate AI.
+//
+// ----------------------------------------------------------------------- //
 
-	CompactSquads();
+void CAICoordinator::InitSquadGrid( const AI_SQUAD_CANDIDATE_LIST& lstCandidates )
+{
+	m_lstSquadGridEntries.resize( 0 );
 
-	// Initialize squad activities.
+	// Each candidate may create a squad.
 
-	AI_SQUAD_LIST::iterator itSquad;
-	for( itSquad = m_lstSquads.begin(); itSquad != m_lstSquads.end(); ++itSquad )
+	uint32 cCandidates = lstCandidates.size();
+	m_lstSquadGridRects.resize( cCandidates );
+	m_lstSquadGridStamps.resize( 0 );
+	m_lstSquadGridStamps.resize( cCandidates, 0 );
+
+	if( cCandidates == 0 )
 	{
-		pSquad = *itSquad;
-		if( pSquad )
+		m_cSquadGridCellsX = 0;
+		m_cSquadGridCellsZ = 0;
+		m_lstSquadGridHeads.resize( 0 );
+		return;
+	}
+
+	// Find the extents of the candidates' clustering boxes.
+
+	const LTVector& vFirst = lstCandidates[0].vPos;
+	float fMinX = vFirst.x;
+	float fMinZ = vFirst.z;
+	float fMaxX = vFirst.x;
+	float fMaxZ = vFirst.z;
+
+	AI_SQUAD_CANDIDATE_LIST::const_iterator itCandidate;
+	for( itCandidate = lstCandidates.begin(); itCandidate != lstCandidates.end(); ++itCandidate )
+	{
+		const LTVector& vPos = itCandidate->vPos;
+		fMinX = LTMIN( fMinX, vPos.x );
+		fMinZ = LTMIN( fMinZ, vPos.z );
+		fMaxX = LTMAX( fMaxX, vPos.x );
+		fMaxZ = LTMAX( fMaxZ, vPos.z );
+	}
+
+	m_fSquadGridOriginX = fMinX - SQUAD_THRESH_WIDTH;
+	m_fSquadGridOriginZ = fMinZ - SQUAD_THRESH_WIDTH;
+	float fExtentX = ( fMaxX - fMinX ) + ( 2.f * SQUAD_THRESH_WIDTH );
+	float fExtentZ = ( fMaxZ - fMinZ ) + ( 2.f * SQUAD_THRESH_WIDTH );
+
+	// Grow the cells until the grid fits the cell budget.
+
+	float fCellSize = SQUAD_GRID_CELL_SIZE;
+	while( true )
+	{
+		m_cSquadGridCellsX = (int32)( fExtentX / fCellSize ) + 1;
+		m_cSquadGridCellsZ = (int32)( fExtentZ / fCellSize ) + 1;
+		if( m_cSquadGridCellsX * m_cSquadGridCellsZ <= SQUAD_GRID_MAX_CELLS )
 		{
-			pSquad->InitActivities();
+			break;
+		}
+		fCellSize *= 2.f;
+	}
+	m_fSquadGridInvCellSize = 1.f / fCellSize;
+
+	m_lstSquadGridHeads.resize( 0 );
+	m_lstSquadGridHeads.resize( m_cSquadGridCellsX * m_cSquadGridCellsZ, -1 );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAICoordinator::GetSquadGridRect
+//
+//	PURPOSE:	Return the range of squad grid cells touched by a box.
+//
+// ----------------------------------------------------------------------- //
+
+void CAICoordinator::GetSquadGridRect( const LTRect3f& AABB, SAISquadGridRect* pRect ) const
+{
+	pRect->iMinX = (int32)( ( AABB.m_vMin.x - m_fSquadGridOriginX ) * m_fSquadGridInvCellSize );
+	pRect->iMinZ = (int32)( ( AABB.m_vMin.z - m_fSquadGridOriginZ ) * m_fSquadGridInvCellSize );
+	pRect->iMaxX = (int32)( ( AABB.m_vMax.x - m_fSquadGridOriginX ) * m_fSquadGridInvCellSize );
+	pRect->iMaxZ = (int32)( ( AABB.m_vMax.z - m_fSquadGridOriginZ ) * m_fSquadGridInvCellSize );
+
+	// Boxes always lie within the grid, but guard against round off.
+
+	pRect->iMinX = LTCLAMP( pRect->iMinX, 0, m_cSquadGridCellsX - 1 );
+	pRect->iMinZ = LTCLAMP( pRect->iMinZ, 0, m_cSquadGridCellsZ - 1 );
+	pRect->iMaxX = LTCLAMP( pRect->iMaxX, 0, m_cSquadGridCellsX - 1 );
+	pRect->iMaxZ = LTCLAMP( pRect->iMaxZ, 0, m_cSquadGridCellsZ - 1 );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAICoordinator::UpdateSquadGridCells
+//
+//	PURPOSE:	Register a squad in any grid cells its bounds have grown
+//				into since it was last registered.  A squad with no
+//				registered cells (a new squad) is registered everywhere.
+//
+// ----------------------------------------------------------------------- //
+
+void CAICoordinator::UpdateSquadGridCells( uint32 iSquad )
+{
+	if( iSquad >= m_lstSquadGridRects.size() )
+	{
+		AIASSERT( 0, NULL, "CAICoordinator::UpdateSquadGridCells: More squads than candidates." );
+		return;
+	}
+
+	SAISquadGridRect& OldRect = m_lstSquadGridRects[iSquad];
+
+	// Squads only keep their registration while they grow.  A newly
+	// setup squad may be a recycled squad from a previous generation.
+
+	if( iSquad == m_cSquads )
+	{
+		OldRect.iMinX = 1;
+		OldRect.iMaxX = 0;
+		OldRect.iMinZ = 1;
+		OldRect.iMaxZ = 0;
+	}
+
+	SAISquadGridRect NewRect;
+	GetSquadGridRect( m_lstSquads[iSquad]->GetSquadAABB(), &NewRect );
+
+	SAISquadGridEntry Entry;
+	Entry.iSquad = iSquad;
+
+	for( int32 iZ=NewRect.iMinZ; iZ <= NewRect.iMaxZ; ++iZ )
+	{
+		for( int32 iX=NewRect.iMinX; iX <= NewRect.iMaxX; ++iX )
+		{
+			// Skip cells the squad is already registered in.
+
+			if( ( iX >= OldRect.iMinX ) && ( iX <= OldRect.iMaxX ) &&
+				( iZ >= OldRect.iMinZ ) && ( iZ <= OldRect.iMaxZ ) )
+			{
+				continue;
+			}
+
+			int32 iCell = ( iZ * m_cSquadGridCellsX ) + iX;
+			Entry.iNext = m_lstSquadGridHeads[iCell];
+			m_lstSquadGridHeads[iCell] = (int32)m_lstSquadGridEntries.size();
+			m_lstSquadGridEntries.push_back( Entry );
 		}
 	}
+
+	OldRect = NewRect;
 }
 
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAICoordinator::GatherSquadGridSquads
+//
+//	PURPOSE:	Fill the squad list with the indices of squads registered
+//				in the cells under a box, sorted in ascending order.  The
+//				stamp must be unique to each call during a generation.
+//
+// ----------------------------------------------------------------------- //
+
+void CAICoordinator::GatherSquadGridSquads( const LTRect3f& AABB, uint32 nStamp )
+{
+	m_lstSquadGridSquads.resize( 0 );
+
+	SAISquadGridRect Rect;
+	GetSquadGridRect( AABB, &Rect );
+
+	for( int32 iZ=Rect.iMinZ; iZ <= Rect.iMaxZ; ++iZ )
+	{
+		for( int32 iX=Rect.iMinX; iX <= Rect.iMaxX; ++iX )
+		{
+			int32 iEntry = m_lstSquadGridHeads[( iZ * m_cSquadGridCellsX ) + iX];
+			while( iEntry != -1 )
+			{
+				const SAISquadGridEntry& Entry = m_lstSquadGridEntries[iEntry];
+				if( m_lstSquadGridStamps[Entry.iSquad] != nStamp )
+				{
+					m_lstSquadGridStamps[Entry.iSquad] = nStamp;
+					m_lstSquadGridSquads.push_back( Entry.iSquad );
+				}
+				iEntry = Entry.iNext;
+			}
+		}
+	}
+
+	std::sort( m_lstSquadGridSquads.begin(), m_lstSquadGridSquads.end() );
+}
+
+#ifndef _FINAL
+
+// Squad produced by a placement pass of the squad benchmark.
+
+struct SAISquadBenchmarkResult
+{
+	ENUM_AI_SQUAD_ID		eSquadID;
+	EnumCharacterAlignment	eAlignment;
+	int						cMembers;
+	LTRect3f				AABB;
+};
+
+// How the squad benchmark places its AI.
+
+enum ESquadBenchmarkLayout
+{
+	kSquadBenchmark_Skirmishes,	// Small groups spread over a large level.
+	kSquadBenchmark_Battle,		// Two sides crowded into one area.
+	kSquadBenchmark_Patrol,		// A line of AI just within reach of each other.
+	kSquadBenchmark_Count,
+};
+
+static const char* s_aszSquadBenchmarkLayouts[kSquadBenchmark_Count] =
+{
+	"skirmishes",
+	"battle",
+	"patrol",
+};
+
+static float SquadBenchmarkRandom( uint32& nSeed, float fMin, float fMax )
+{
+	nSeed = nSeed * 1664525 + 1013904223;
+	return fMin + ( fMax - fMin ) * ( float )( nSeed >> 8 ) / ( float )( 1 << 24 );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	GenerateSquadBenchmarkAI
+//
+//	PURPOSE:	Generate AI placements for the squad benchmark.
+//
+// ----------------------------------------------------------------------- //
+
+static void GenerateSquadBenchmarkAI( ESquadBenchmarkLayout eLayout, uint32 cAI, AI_SQUAD_CANDIDATE_LIST& lstCandidates )
+{
+	uint32 nSeed = 12345 + eLayout;
+	LTVector vGroup( 0.f, 0.f, 0.f );
+	EnumCharacterAlignment eGroupAlignment = ( EnumCharacterAlignment )0;
+
+	lstCandidates.resize( cAI );
+	for( uint32 iAI=0; iAI < cAI; ++iAI )
+	{
+		SAISquadCandidate& Candidate = lstCandidates[iAI];
+		Candidate.hAI = NULL;
+
+		switch( eLayout )
+		{
+			case kSquadBenchmark_Skirmishes:
+				if( ( iAI % 4 ) == 0 )
+				{
+					vGroup.Init( SquadBenchmarkRandom( nSeed, -40000.f, 40000.f ), SquadBenchmarkRandom( nSeed, -500.f, 500.f ), SquadBenchmarkRandom( nSeed, -40000.f, 40000.f ) );
+					eGroupAlignment = ( EnumCharacterAlignment )( ( iAI / 4 ) % 3 );
+				}
+				Candidate.vPos = vGroup + LTVector( SquadBenchmarkRandom( nSeed, -600.f, 600.f ), SquadBenchmarkRandom( nSeed, -100.f, 100.f ), SquadBenchmarkRandom( nSeed, -600.f, 600.f ) );
+				Candidate.eAlignment = eGroupAlignment;
+				break;
+
+			case kSquadBenchmark_Battle:
+				Candidate.vPos.Init( SquadBenchmarkRandom( nSeed, -3000.f, 3000.f ), SquadBenchmarkRandom( nSeed, -300.f, 300.f ), SquadBenchmarkRandom( nSeed, -3000.f, 3000.f ) );
+				Candidate.eAlignment = ( EnumCharacterAlignment )( iAI % 2 );
+				break;
+
+			default:
+				Candidate.vPos.Init( ( float )iAI * 1500.f + SquadBenchmarkRandom( nSeed, -50.f, 50.f ), 0.f, SquadBenchmarkRandom( nSeed, -400.f, 400.f ) );
+				Candidate.eAlignment = ( EnumCharacterAlignment )0;
+				break;
+		}
+	}
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAICoordinator::RunSquadBenchmark
+//
+//	PURPOSE:	Place generated AI in squads with and without the grid,
+//				and make sure both give the same squads.
+//
+// ----------------------------------------------------------------------- //
+
+void CAICoordinator::RunSquadBenchmark( uint32 cAI, uint32 nIterations )
+{
+	if( cAI == 0 )
+	{
+		cAI = 64;
+	}
+	if( nIterations == 0 )
+	{
+		nIterations = 100;
+	}
+
+	// Set the real squads aside.
+
+	AI_SQUAD_LIST lstSavedSquads;
+	lstSavedSquads.swap( m_lstSquads );
+	uint32 cSavedSquads = m_cSquads;
+	uint32 iSavedSquadToUpdate = m_iSquadToUpdate;
+
+	uint32 nFailures = 0;
+	AI_SQUAD_CANDIDATE_LIST lstCandidates;
+	std::vector<SAISquadBenchmarkResult> aResults[2];
+
+	for( uint32 iLayout=0; iLayout < kSquadBenchmark_Count; ++iLayout )
+	{
+		GenerateSquadBenchmarkAI( ( ESquadBenchmarkLayout )iLayout, cAI, lstCandidates );
+
+		double fMS[2];
+		for( uint32 iPass=0; iPass < 2; ++iPass )
+		{
+			bool bUseSquadGrid = ( iPass == 0 );
+
+			TLTPrecisionTime StartTime = LTTimeUtils::GetPrecisionTime();
+			for( uint32 iIteration=0; iIteration < nIterations; ++iIteration )
+			{
+				PlaceSquadCandidates( lstCandidates, bUseSquadGrid );
+			}
+			fMS[iPass] = LTTimeUtils::GetPrecisionTimeIntervalMS( StartTime, LTTimeUtils::GetPrecisionTime() ) / nIterations;
+
+			aResults[iPass].resize( m_cSquads );
+			for( uint32 iSquad=0; iSquad < m_cSquads; ++iSquad )
+			{
+				CAISquad* pSquad = m_lstSquads[iSquad];
+				aResults[iPass][iSquad].eSquadID = pSquad->GetSquadID();
+				aResults[iPass][iSquad].eAlignment = pSquad->GetSquadAlignment();
+				aResults[iPass][iSquad].cMembers = pSquad->GetNumSquadMembers();
+				aResults[iPass][iSquad].AABB = pSquad->GetSquadAABB();
+			}
+		}
+
+		// Both passes must build the same squads, including those invalidated by merging.
+
+		bool bMatch = ( aResults[0].size() == aResults[1].size() );
+		uint32 cValidSquads = 0;
+		for( uint32 iSquad=0; bMatch && ( iSquad < aResults[0].size() ); ++iSquad )
+		{
+			const SAISquadBenchmarkResult& Grid = aResults[0][iSquad];
+			const SAISquadBenchmarkResult& Brute = aResults[1][iSquad];
+			bMatch = ( Grid.eSquadID == Brute.eSquadID ) &&
+				( Grid.eSquadID == kSquad_Invalid || 
+					( ( Grid.eAlignment == Brute.eAlignment ) &&
+					( Grid.cMembers == Brute.cMembers ) &&
+					( Grid.AABB.m_vMin == Brute.AABB.m_vMin ) &&
+					( Grid.AABB.m_vMax == Brute.AABB.m_vMax ) ) );
+
+			if( Grid.eSquadID != kSquad_Invalid )
+			{
+				++cValidSquads;
+			}
+		}
+
+		if( !bMatch )
+		{
+			++nFailures;
+		}
+
+		g_pLTServer->CPrint( "SquadBenchmark: %s, %u AI, %u squads: grid %.3f ms, every squad %.3f ms%s",
+			s_aszSquadBenchmarkLayouts[iLayout], cAI, cValidSquads, fMS[0], fMS[1], bMatch ? "" : " - squads differ" );
+	}
+
+	// Put the real squads back.
+
+	AI_SQUAD_LIST::iterator itSquad;
+	for( itSquad = m_lstSquads.begin(); itSquad != m_lstSquads.end(); ++itSquad )
+	{
+		CAISquad* pSquad = *itSquad;
+		AI_FACTORY_DELETE( pSquad );
+	}
+	m_lstSquads.swap( lstSavedSquads );
+	m_cSquads = cSavedSquads;
+	m_iSquadToUpdate = iSavedSquadToUpdate;
+
+	g_pLTServer->CPrint( "SquadBenchmark: %u failures - %s", nFailures, ( nFailures == 0 ) ? "PASSED" : "FAILED" );
+}
+
+#endif // _FINAL
+
 // ----------------------------------------------------------------------- //
 //
 //	ROUTINE:	CAICoordinator::FindSquad
@@ -23,6 +23,42 @@ class	CAISquad;
 
 // ----------------------------------------------------------------------- //
 
+// Cell range of the uniform grid used during squad generation.
+// An empty range has iMinX greater than iMaxX.
+
+struct SAISquadGridRect
+{
+	int32	iMinX;
+	int32	iMinZ;
+	int32	iMaxX;
+	int32	iMaxZ;
+};
+
+// Entry in a squad grid cell's linked list of squads.
+
+struct SAISquadGridEntry
+{
+	uint32	iSquad;
+	int32	iNext;
+};
+
+// AI that may be placed in a squad.
+
+struct SAISquadCandidate
+{
+	HOBJECT					hAI;
+	LTVector				vPos;
+	EnumCharacterAlignment	eAlignment;
+};
+
+typedef std::vector<SAISquadCandidate, LTAllocator<SAISquadCandidate, LT_MEM_TYPE_OBJECTSHELL> > AI_SQUAD_CANDIDATE_LIST;
+typedef std::vector<SAISquadGridRect, LTAllocator<SAISquadGridRect, LT_MEM_TYPE_OBJECTSHELL> > AI_SQUAD_GRID_RECT_LIST;
+typedef std::vector<SAISquadGridEntry, LTAllocator<SAISquadGridEntry, LT_MEM_TYPE_OBJECTSHELL> > AI_SQUAD_GRID_ENTRY_LIST;
+typedef std::vector<int32, LTAllocator<int32, LT_MEM_TYPE_OBJECTSHELL> > AI_SQUAD_GRID_HEAD_LIST;
+typedef std::vector<uint32, LTAllocator<uint32, LT_MEM_TYPE_OBJECTSHELL> > AI_SQUAD_INDEX_LIST;
+
+// ----------------------------------------------------------------------- //
+
 extern CAICoordinator* g_pAICoordinator;
 
 // ----------------------------------------------------------------------- //
@@ -59,6 +95,28 @@ class CAICoordinator
 		ENUM_AI_SQUAD_ID	GetSquadID( HOBJECT hAI ) const;
 		HOBJECT				FindAlly( HOBJECT hAI, HOBJECT hVisibleTarget );
 
+#ifndef _FINAL
+		// Places generated AI in squads through the grid and by testing every
+		// squad, compares the squads and reports the time taken by each.
+		// The current squads are restored afterwards.
+
+		void		RunSquadBenchmark( uint32 cAI, uint32 nIterations );
+#endif // _FINAL
+
+	protected:
+
+		// Place the candidates in squads.  Without the grid each AI is
+		// tested against every squad.
+
+		void		PlaceSquadCandidates( const AI_SQUAD_CANDIDATE_LIST& lstCandidates, bool bUseSquadGrid );
+
+		// Squad generation grid.
+
+		void		InitSquadGrid( const AI_SQUAD_CANDIDATE_LIST& lstCandidates );
+		void		GetSquadGridRect( const LTRect3f& AABB, SAISquadGridRect* pRect ) const;
+		void		UpdateSquadGridCells( uint32 iSquad );
+		void		GatherSquadGridSquads( const LTRect3f& AABB, uint32 nStamp );
+
 	protected:
 
 		AI_SQUAD_LIST				m_lstSquads;
@@ -66,6 +124,22 @@ class CAICoordinator
 		uint32						m_iSquadToUpdate;
 		float						m_fSquadRegenRate;
 		double						m_fNextSquadRegenTime;
+
+		// Scratch data for squad generation.  Squads register themselves
+		// in every grid cell their bounds touch, so an AI only needs to
+		// be tested against the squads found in the cells under its box.
+
+		AI_SQUAD_CANDIDATE_LIST		m_lstSquadCandidates;
+		float						m_fSquadGridOriginX;
+		float						m_fSquadGridOriginZ;
+		float						m_fSquadGridInvCellSize;
+		int32						m_cSquadGridCellsX;
+		int32						m_cSquadGridCellsZ;
+		AI_SQUAD_GRID_HEAD_LIST		m_lstSquadGridHeads;
+		AI_SQUAD_GRID_ENTRY_LIST	m_lstSquadGridEntries;
+		AI_SQUAD_GRID_RECT_LIST		m_lstSquadGridRects;
+		AI_SQUAD_INDEX_LIST			m_lstSquadGridStamps;
+		AI_SQUAD_INDEX_LIST			m_lstSquadGridSquads;
 };
 
 // ----------------------------------------------------------------------- //
@@ -42,11 +42,15 @@ enum ENUM_NMEdgeType
 	kNMEdgeType_Shared,
 };
 
+// The packed NavMesh is position-independent.  References between
+// sections are stored as element indices into the referenced list, and
+// are resolved at access time, so the data is never modified at run-time.
+
 struct AIREGION_DATA
 {
 	ENUM_AIRegionID		eAIRegionID;
 	uint32				cNMPolys;
-	ENUM_NMPolyID*		pNMPolyIDs;
+	uint32				iNMPolyList;
 	LTVector			vBoundingSphereCenter;
 	float				fBoundingSphereRadius;
 };
@@ -55,12 +59,12 @@ struct NAVMESH_LINK_DATA
 {
 	ENUM_NMLinkID	eNMlinkID;
 	uint32			cBoundaryVerts;
-	LTVector*		pBoundaryVerts;
+	uint32			iBoundaryVertList;
 };
 
 struct AINODE_CLUSTER_DATA
 {
-	const char*				pszName;
+	uint32					iName;
 	EnumAINodeClusterID		eAINodeClusterID;
 };
 
@@ -16,6 +16,7 @@
 #include "AIActionMgr.h"
 #include "AIStimulusMgr.h"
 #include "AISoundMgr.h"
+#include "AIVisibilityMgr.h"
 #include "AINodeMgr.h"
 #include "AINavMesh.h"
 #include "AINavMeshGen.h"
@@ -170,6 +171,7 @@ CAIMgr::CAIMgr()
 	m_pAIActionMgr = debug_new( CAIActionMgr );
 	m_pAIStimulusMgr = debug_new( CAIStimulusMgr );
 	m_pAISoundMgr = debug_new( CAISoundMgr );
+	m_pAIVisibilityMgr = debug_new( CAIVisibilityMgr );
 	m_pAINodeMgr = debug_new( CAINodeMgr );
 	m_pAINavMesh = debug_new( CAINavMesh );
 	m_pAIQuadTree = debug_new( CAIQuadTree );
@@ -187,6 +189,7 @@ CAIMgr::~CAIMgr()
 	debug_delete( m_pAIActionMgr );
 	debug_delete( m_pAIStimulusMgr );
 	debug_delete( m_pAISoundMgr );
+	debug_delete( m_pAIVisibilityMgr );
 	debug_delete( m_pAINodeMgr );
 	debug_delete( m_pAINavMesh );
 	debug_delete( m_pAIQuadTree );
@@ -248,6 +251,7 @@ void CAIMgr::PreStartWorld( bool bSwitchingWorlds )
 	m_pAICoordinator->TermAICoordinator();
 	m_pAIStimulusMgr->Term();
 	m_pAISoundMgr->TermAISoundMgr();
+	m_pAIVisibilityMgr->TermAIVisibilityMgr();
 	m_pAIPathMgrNavMesh->TermPathMgrNavMesh();
 	m_pAICentralMemory->Term();
 }
@@ -269,12 +273,14 @@ void CAIMgr::PostStartWorld()
 	m_pAICoordinator->InitAICoordinator();
 	m_pAIStimulusMgr->Init();
 	m_pAISoundMgr->InitAISoundMgr();
+	m_pAIVisibilityMgr->InitAIVisibilityMgr();
 	m_pAICentralMemory->Init();
 	m_pAIPathMgrNavMesh->InitPathMgrNavMesh();
 	m_pAINodeMgr->Init();
 
 #ifndef _FINAL
 	m_pAINodeMgr->Verify();
+	m_pAIQuadTree->Verify();
 #endif
 
 	m_hNextAI = NULL;
@@ -310,7 +316,7 @@ void CAIMgr::SetupNavMesh()
 		if( !CAINavMesh::GetNavMeshBlindObjectData(pDataRaw, nDataRawSize) )
 		{
 			m_pAINavMesh->TermNavMesh();
-			m_pAIQuadTree->SetQuadTreeRoot( NULL );
+			m_pAIQuadTree->SetQuadTreeNodes( NULL, 0, NULL );
 			return;
 		}
 
@@ -333,7 +339,7 @@ void CAIMgr::SetupNavMesh()
 			#endif // PLATFORM_XENON
 
 			// it's already processed
-			m_pAINavMesh->RuntimeSetup( pNavMeshData, false );
+			m_pAINavMesh->RuntimeSetup( pNavMeshData, nNavMeshDataSize, false );
 		}
 		else
 		{
@@ -344,7 +350,7 @@ void CAIMgr::SetupNavMesh()
 				if(!pProcessedStream)
 				{
 					m_pAINavMesh->TermNavMesh();
-					m_pAIQuadTree->SetQuadTreeRoot( NULL );
+					m_pAIQuadTree->SetQuadTreeNodes( NULL, 0, NULL );
 					return;
 				}
 
@@ -352,7 +358,7 @@ void CAIMgr::SetupNavMesh()
 				if(!pProcessedConverter)
 				{
 					m_pAINavMesh->TermNavMesh();
-					m_pAIQuadTree->SetQuadTreeRoot( NULL );
+					m_pAIQuadTree->SetQuadTreeNodes( NULL, 0, NULL );
 					return;
 				}
 
@@ -360,7 +366,7 @@ void CAIMgr::SetupNavMesh()
 				if( !AINavMeshGen.ExportPackedNavMesh(*pProcessedConverter) )
 				{
 					m_pAINavMesh->TermNavMesh();
-					m_pAIQuadTree->SetQuadTreeRoot( NULL );
+					m_pAIQuadTree->SetQuadTreeNodes( NULL, 0, NULL );
 					return;
 				}
 				AINavMeshGen.TermNavMeshGen();
@@ -374,13 +380,13 @@ void CAIMgr::SetupNavMesh()
 				if( !pDataBuffer )
 				{
 					m_pAINavMesh->TermNavMesh();
-					m_pAIQuadTree->SetQuadTreeRoot( NULL );
+					m_pAIQuadTree->SetQuadTreeNodes( NULL, 0, NULL );
 					return;
 				}
 				memcpy( pDataBuffer, &ProcessedData[0], nDataSize );
 
 				// Initialize the run-time NavMesh with the packed data.
-				m_pAINavMesh->RuntimeSetup( pDataBuffer, true );
+				m_pAINavMesh->RuntimeSetup( pDataBuffer, nDataSize, true );
 			}
 		}
 	}
@@ -441,6 +447,10 @@ void CAIMgr::Update()
 	//track our performance
 
 	CTimedSystemBlock TimingBlock(g_tsAIMgr);
+
+	// Start a new frame of line-of-sight queries.
+
+	g_pAIVisibilityMgr->UpdateAIVisibilityMgr();
 	
 	// Update the AI's senses.
 
@@ -588,6 +598,7 @@ void CAIMgr::OnDebugCmd( HOBJECT hSender, const CParsedMsg &crParsedMsg )
 	// Hand the message to the correct subsystem.
 
 	static CParsedMsg::CToken s_cTok_AIStimulusMgr("AIStimulusMgr");
+	static CParsedMsg::CToken s_cTok_AIVisibilityMgr("AIVisibilityMgr");
 	static CParsedMsg::CToken s_cTok_AIWorkingMemoryCentral("AIWorkingMemoryCentral");
 	static CParsedMsg::CToken s_cTok_ListGoals("ListGoals");
 	static CParsedMsg::CToken s_cTok_ListUnusedActions("ListUnusedActions");
@@ -597,6 +608,10 @@ void CAIMgr::OnDebugCmd( HOBJECT hSender, const CParsedMsg &crParsedMsg )
 	{
 		m_pAIStimulusMgr->OnAIDebugCmd( hSender, crParsedMsg );
 	}
+	else if ( crParsedMsg.GetArg(0) == s_cTok_AIVisibilityMgr )
+	{
+		m_pAIVisibilityMgr->OnAIDebugCmd( hSender, crParsedMsg );
+	}
 	else if ( crParsedMsg.GetArg(0) == s_cTok_AIWorkingMemoryCentral )
 	{
 		m_pAICentralMemory->OnAIDebugCmd( hSender, crParsedMsg );
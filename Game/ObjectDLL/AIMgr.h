@@ -20,6 +20,7 @@ class	CAIPlanner;
 class	CAIActionMgr;
 class	CAIStimulusMgr;
 class	CAISoundMgr;
+class	CAIVisibilityMgr;
 class	CAINodeMgr;
 class	CAINavMesh;
 class	CAIQuadTree;
@@ -76,6 +77,7 @@ class CAIMgr
 		CAITargetSelectMgr*		m_pAITargetSelectMgr;
 		CAIStimulusMgr*			m_pAIStimulusMgr;
 		CAISoundMgr*			m_pAISoundMgr;
+		CAIVisibilityMgr*		m_pAIVisibilityMgr;
 		CAINodeMgr*				m_pAINodeMgr;
 		CAINavMesh*				m_pAINavMesh;
 		CAIQuadTree*			m_pAIQuadTree;
@@ -25,6 +25,7 @@
 #include "AIBlackBoard.h"
 #include "AITarget.h"
 #include "AIMovementUtils.h"
+#include "AIVisibilityMgr.h"
 
 // ----------------------------------------------------------------------- //
 //
@@ -482,21 +483,22 @@ float CAIMovement::UpdateParabola()
 
 	if(!m_bParabolaPeaked && (fDist > m_fParabolaPeakDist))
 	{
-		IntersectQuery IQuery;
-		IntersectInfo IInfo;
+		SAIVisibilityQuery Query;
+		SAIVisibilityResult Result;
 
-		IQuery.m_From = m_vDest;
-		IQuery.m_To = m_vDest;
-		IQuery.m_From.y += m_pAI->GetDims().y;
-		IQuery.m_To.y -= m_pAI->GetDims().y * 10.f;
+		Query.m_vFrom = m_vDest;
+		Query.m_vTo = m_vDest;
+		Query.m_vFrom.y += m_pAI->GetDims().y;
+		Query.m_vTo.y -= m_pAI->GetDims().y * 10.f;
 
-		IQuery.m_Flags = INTERSECT_OBJECTS | IGNORE_NONSOLID | INTERSECT_HPOLY;
-		IQuery.m_FilterFn = GroundFilterFn;
+		Query.m_dwFlags = INTERSECT_OBJECTS | IGNORE_NONSOLID | INTERSECT_HPOLY;
+		Query.m_fnObjectFilter = GroundFilterFn;
+		Query.m_eQueryClass = kAIVisQuery_Ground;
 
 		float fHeight = m_vDest.y;
-		if( g_pLTServer->IntersectSegment(IQuery, &IInfo) && ( IsMainWorld(IInfo.m_hObject) || ( OT_WORLDMODEL == GetObjectType(IInfo.m_hObject) ) ) )
+		if( g_pAIVisibilityMgr->IntersectSegment(Query, &Result) && ( IsMainWorld(Result.m_hObject) || ( OT_WORLDMODEL == GetObjectType(Result.m_hObject) ) ) )
 		{
-			fHeight = IInfo.m_Point.y;
+			fHeight = Result.m_vPoint.y;
 		}
 
 		m_fParabolaPeakHeight += m_vParabolaOrigin.y - ( fHeight + m_pAI->GetDims().y );
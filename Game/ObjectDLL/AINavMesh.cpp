@@ -33,6 +33,11 @@
 #define AINAVMESH_BLINDOBJECTID			0x83f47c31		// ID for AINavMesh blind object data
 #define INVALID_NAV_MESH_DATA_INDEX		0xffffffff
 
+#ifndef _FINAL
+static void NavMeshValidateCB( int argc, char** argv );
+static void NavMeshCompareTestCB( int argc, char** argv );
+#endif // _FINAL
+
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
 
@@ -40,6 +45,8 @@
 // CAINavMeshPoly
 //
 
+const uint32* CAINavMeshPoly::sm_pNMPolyCharTypeMasks = NULL;
+
 CAINavMeshPoly::CAINavMeshPoly()
 {
 	m_eNMPolyID = kNMPoly_Invalid;
@@ -50,46 +57,13 @@ CAINavMeshPoly::CAINavMeshPoly()
 
 	m_eNMComponentID = kNMComponent_Invalid;
 
-	m_dwNMCharTypeMask = 0;
+	m_iNMCharTypeMask = 0;
 
 	m_cNMPolyEdges = 0;
-	m_pNMPolyEdgeList = NULL;
+	m_iNMPolyEdgeList = 0;
 
 	m_cAIRegions = 0;
-	m_pAIRegionList = NULL;
-}
-
-//----------------------------------------------------------------------------
-//              
-//	ROUTINE:	CAINavMeshPoly::FixUpNavMeshPointers()
-//              
-//	PURPOSE:	Fix-up pointers from raw NavMesh data.
-//              
-//----------------------------------------------------------------------------
-
-void CAINavMeshPoly::FixUpNavMeshPointers( ENUM_NMEdgeID* pAINavMeshEdgeLists, ENUM_AIRegionID* pAIRegionLists )
-{
-	// Sanity check.
-
-	if( !( pAINavMeshEdgeLists && pAIRegionLists ) )
-	{
-		return;
-	}
-
-	// Convert the parent NavMesh ID into the character type mask.
-
-	uint32 iNavMesh = m_dwNMCharTypeMask;
-	m_dwNMCharTypeMask = g_pAINavMesh->GetNMCharTypeMask( iNavMesh );
-
-	// Convert index to pointer into edge lists.
-
-	uint32 iNMPolyEdgeList = (uint32)m_pNMPolyEdgeList;
-	m_pNMPolyEdgeList = pAINavMeshEdgeLists + iNMPolyEdgeList;
-
-	// Convert index to pointer into region lists.
-
-	uint32 iAIRegionList = (uint32)m_pAIRegionList;
-	m_pAIRegionList = pAIRegionLists + iAIRegionList;
+	m_iAIRegionList = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -106,7 +80,7 @@ CAINavMeshEdge*	CAINavMeshPoly::GetNMPolyEdge( int iEdge )
 
 	if( ( iEdge >= 0 ) && ( iEdge < m_cNMPolyEdges ) )
 	{
-		return g_pAINavMesh->GetNMEdge( m_pNMPolyEdgeList[iEdge] );
+		return g_pAINavMesh->GetNMEdge( GetNMPolyEdgeList()[iEdge] );
 	}
 
 	return NULL;
@@ -131,7 +105,7 @@ CAINavMeshPoly*	CAINavMeshPoly::GetNMPolyNeighborAtEdge( int iNeighbor )
 	{
 		// Find edge with matching neighbor index.
 
-		pEdge = g_pAINavMesh->GetNMEdge( m_pNMPolyEdgeList[iNeighbor] );
+		pEdge = g_pAINavMesh->GetNMEdge( GetNMPolyEdgeList()[iNeighbor] );
 		if( pEdge )
 		{
 			// Determine if edge has a neighbor.
@@ -164,7 +138,7 @@ CAINavMeshEdge*	CAINavMeshPoly::GetNMPolyNeighborEdge( ENUM_NMPolyID eNMPolyNeig
 
 	for( int iEdge=0; iEdge < m_cNMPolyEdges; ++iEdge )
 	{
-		pEdge = g_pAINavMesh->GetNMEdge( m_pNMPolyEdgeList[iEdge] );
+		pEdge = g_pAINavMesh->GetNMEdge( GetNMPolyEdgeList()[iEdge] );
 		if( pEdge )
 		{
 			// Determine if edge has specified neighbor.
@@ -197,7 +171,7 @@ ENUM_AIRegionID	CAINavMeshPoly::GetAIRegion( int iAIRegion )
 		return kAIRegion_Invalid;
 	}
 
-	return m_pAIRegionList[iAIRegion];
+	return GetAIRegionList()[iAIRegion];
 }
 
 //----------------------------------------------------------------------------
@@ -222,7 +196,7 @@ bool CAINavMeshPoly::IsContainedByAIRegion( ENUM_AIRegionID eAIRegion )
 
 	for( int iAIRegion=0; iAIRegion < m_cAIRegions; ++iAIRegion )
 	{
-		if( eAIRegion == m_pAIRegionList[iAIRegion] )
+		if( eAIRegion == GetAIRegionList()[iAIRegion] )
 		{
 			return true;
 		}
@@ -261,7 +235,7 @@ bool CAINavMeshPoly::ContainsPoint2D( const LTVector& vPos )
 
 	for( int iEdge=0; iEdge < m_cNMPolyEdges; ++iEdge )
 	{
-		pEdge = g_pAINavMesh->GetNMEdge( m_pNMPolyEdgeList[iEdge] );
+		pEdge = g_pAINavMesh->GetNMEdge( GetNMPolyEdgeList()[iEdge] );
 
 		vTest = pEdge->GetNMEdgeMidPt() - vPos;
 		vTest.y = 0.f;
@@ -307,7 +281,7 @@ bool CAINavMeshPoly::RayIntersectPoly2D( const LTVector& vRay0, const LTVector&
 	LTVector vLineSeg0, vLineSeg1;
 	for( int iEdge=0; iEdge < m_cNMPolyEdges; ++iEdge )
 	{
-		pEdge = g_pAINavMesh->GetNMEdge( m_pNMPolyEdgeList[iEdge] );
+		pEdge = g_pAINavMesh->GetNMEdge( GetNMPolyEdgeList()[iEdge] );
 		if( pEdge )
 		{
 			vL0 = pEdge->GetNMEdge0();
@@ -345,11 +319,11 @@ void CAINavMeshPoly::PrintVerts()
 	CAINavMeshEdge* pEdge;
 	CAINavMeshEdge* pEdgeLast;
 
-	pEdgeLast = g_pAINavMesh->GetNMEdge( m_pNMPolyEdgeList[m_cNMPolyEdges - 1] );
+	pEdgeLast = g_pAINavMesh->GetNMEdge( GetNMPolyEdgeList()[m_cNMPolyEdges - 1] );
 
 	for( int iEdge=0; iEdge < m_cNMPolyEdges; ++iEdge )
 	{
-		pEdge = g_pAINavMesh->GetNMEdge( m_pNMPolyEdgeList[iEdge] );
+		pEdge = g_pAINavMesh->GetNMEdge( GetNMPolyEdgeList()[iEdge] );
 
 		if( ( pEdge->GetNMEdge0() != pEdgeLast->GetNMEdge0() ) &&
 			( pEdge->GetNMEdge0() != pEdgeLast->GetNMEdge1() ) )
@@ -391,7 +365,7 @@ void CAINavMeshPoly::DrawSelf()
 		ENUM_AIAttributesID eID = g_pAIDB->GetAIAttributesRecordID( pszFilterString );
 		if ( kAIAttributesID_Invalid != eID )
 		{
-			if ( 0 == ( m_dwNMCharTypeMask & ( 1 << eID ) ) )
+			if ( 0 == ( GetNMCharTypeMask() & ( 1 << eID ) ) )
 			{
 				return;
 			}
@@ -440,7 +414,7 @@ void CAINavMeshPoly::DrawSelf()
 	CAINavMeshEdge* pEdge;
 	for( int iEdge=0; iEdge < m_cNMPolyEdges; ++iEdge )
 	{
-		pEdge = g_pAINavMesh->GetNMEdge( m_pNMPolyEdgeList[iEdge] );
+		pEdge = g_pAINavMesh->GetNMEdge( GetNMPolyEdgeList()[iEdge] );
 		if( !pEdge )
 		{
 			continue;
@@ -531,7 +505,7 @@ void CAINavMeshPoly::DrawSelfInAIRegion( AIRegion* pAIRegion, bool bDrawName )
 	CAINavMeshEdge* pEdge;
 	for( int iEdge=0; iEdge < m_cNMPolyEdges; ++iEdge )
 	{
-		pEdge = g_pAINavMesh->GetNMEdge( m_pNMPolyEdgeList[iEdge] );
+		pEdge = g_pAINavMesh->GetNMEdge( GetNMPolyEdgeList()[iEdge] );
 		if( !pEdge )
 		{
 			continue;
@@ -667,30 +641,7 @@ CAINavMeshComponent::CAINavMeshComponent()
 	m_eNMSensoryComponentID = kNMSensoryComponent_Invalid;
 
 	m_cNMComponentNeighbors = 0;
-	m_pNMComponentNeighborList = NULL;
-}
-
-//----------------------------------------------------------------------------
-//              
-//	ROUTINE:	CAINavMeshComponent::FixUpNavMeshPointers()
-//              
-//	PURPOSE:	Fix-up pointers from raw NavMesh data.
-//              
-//----------------------------------------------------------------------------
-
-void CAINavMeshComponent::FixUpNavMeshPointers( ENUM_NMComponentID* pAINavMeshComponentNeighborLists )
-{
-	// Sanity check.
-
-	if( !pAINavMeshComponentNeighborLists )
-	{
-		return;
-	}
-
-	// Convert index to pointer into component neighbor lists.
-
-	uint32 iNMComponentNeighborList = (uint32)m_pNMComponentNeighborList;
-	m_pNMComponentNeighborList = pAINavMeshComponentNeighborLists + iNMComponentNeighborList;
+	m_iNMComponentNeighborList = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -711,7 +662,7 @@ CAINavMeshComponent* CAINavMeshComponent::GetNMComponentNeighbor( int iNeighbor
 	{
 		// Find component with matching neighbor index.
 
-		ENUM_NMComponentID eNeighbor = m_pNMComponentNeighborList[iNeighbor];
+		ENUM_NMComponentID eNeighbor = g_pAINavMesh->GetNMComponentNeighborList( m_iNMComponentNeighborList )[iNeighbor];
 		pNeighbor = g_pAINavMesh->GetNMComponent( eNeighbor );
 	}
 
@@ -1022,6 +973,7 @@ CAINavMesh::CAINavMesh()
 
 	m_pAINavMeshObject = NULL;
 	m_pPackedNavMeshData = NULL;
+	m_nPackedNavMeshDataSize = 0;
 	m_bDeletePackedNavMeshData = false;
 
 	m_bNMInitialized = false;
@@ -1071,10 +1023,20 @@ CAINavMesh::CAINavMesh()
 
 	m_cAIQuadTreeNMPolyLists = 0;
 	m_pAIQuadTreeNMPolyLists = NULL;
+
+#ifndef _FINAL
+	g_pLTServer->RegisterConsoleProgram( "NavMeshValidate", NavMeshValidateCB );
+	g_pLTServer->RegisterConsoleProgram( "NavMeshCompareTest", NavMeshCompareTestCB );
+#endif // _FINAL
 }
 
 CAINavMesh::~CAINavMesh()
 {
+#ifndef _FINAL
+	g_pLTServer->UnregisterConsoleProgram( "NavMeshValidate" );
+	g_pLTServer->UnregisterConsoleProgram( "NavMeshCompareTest" );
+#endif // _FINAL
+
 	TermNavMesh();
 
 	g_pAINavMesh = NULL;
@@ -1108,9 +1070,13 @@ void CAINavMesh::TermNavMesh()
 	if( m_bDeletePackedNavMeshData )
 	{
 		debug_deletea( m_pPackedNavMeshData );
-		m_pPackedNavMeshData = NULL;
 		m_bDeletePackedNavMeshData = false;
 	}
+	m_pPackedNavMeshData = NULL;
+	m_nPackedNavMeshDataSize = 0;
+	m_SharedNavMeshData.Unmap();
+
+	CAINavMeshPoly::sm_pNMPolyCharTypeMasks = NULL;
 
 	m_pAINavMeshPolys = NULL;
 	m_cAINavMeshPolys = 0;
@@ -1139,17 +1105,22 @@ void CAINavMesh::TermNavMesh()
 	m_lstAINavMeshLinks.resize( 0 );
 	m_lstAIRegions.resize( 0 );
 	m_lstAINavMeshCharTypeMasks.resize( 0 );
+	m_lstAINavMeshPolyCharTypeMasks.resize( 0 );
 }
 
 //----------------------------------------------------------------------------
 //              
 //	ROUTINE:	CAINavMesh::RuntimeSetup()
 //              
-//	PURPOSE:	Setup the NavMesh for run-time.
+//	PURPOSE:	Setup the NavMesh for run-time.  The packed data is
+//				accessed in place and is never written to.  Data packed
+//				in-game is mapped read-only from a cache file shared
+//				with other servers running the same level where
+//				possible.
 //              
 //----------------------------------------------------------------------------
 
-void CAINavMesh::RuntimeSetup( uint8* pData, bool bDelete )
+void CAINavMesh::RuntimeSetup( uint8* pData, uint32 nDataSize, bool bDelete )
 {
 	// Sanity check.
 
@@ -1175,363 +1146,500 @@ void CAINavMesh::RuntimeSetup( uint8* pData, bool bDelete )
 		return;
 	}
 
-	m_pPackedNavMeshData = pData;
-	m_bDeletePackedNavMeshData = bDelete;
-
-	uint32 nSizeInt = sizeof(uint32);
-	uint32 nSizeVector = sizeof(LTVector);
+	// Bail if the packed data is truncated, or references
+	// data outside of its own lists.
 
-
-	//
-	// Read header.
-	//
-
-	uint8* pCur = pData;
-	uint32 nVersion = *(uint32*)pCur;
-	pCur += nSizeInt;
-
-	// Bail if incorrect version.
-
-	if( nVersion != AINAVMESH_VERSION_NUMBER )
+	AINAVMESH_PACKED_DATA Packed;
+	if( !( ReadPackedNavMesh( pData, nDataSize, &Packed ) &&
+		   ValidatePackedNavMesh( pData, nDataSize ) ) )
 	{
-		AIASSERT2( 0, NULL, "CAINavMesh::InitNavMesh: Packed NavMesh is incorrect version: %d != %d", nVersion, AINAVMESH_VERSION_NUMBER );
+		AIASSERT( 0, NULL, "CAINavMesh::RuntimeSetup: Packed NavMesh is invalid." );
+		if( bDelete )
+		{
+			debug_deletea( pData );
+		}
 		return;
 	}
 
-	// Read fixed-up flag.  This flag allows us to keep BlindObjectData in memory,
-	// even after massaging it.
+	// Switch a copy packed in-game to the shared copy, and free it.  Blind
+	// data belongs to the engine, which keeps it until the world is
+	// unloaded, so mapping another copy of that would only add to the
+	// memory used.  It is used in place instead.
 
-	m_pbAINavMeshFixedUp = (bool*)pCur;
-	pCur += nSizeInt;
+	if( bDelete )
+	{
+		const uint8* pSharedData = m_SharedNavMeshData.MapSharedCopy( "NavMesh", pData, nDataSize );
+		if( pSharedData )
+		{
+			debug_deletea( pData );
+			bDelete = false;
 
-	//
-	// Read edges.
-	//
+			pData = const_cast<uint8*>( pSharedData );
+			ReadPackedNavMesh( pData, nDataSize, &Packed );
+		}
+	}
 
-	m_cAINavMeshEdges = *(uint32*)pCur;
-	pCur += nSizeInt;
+	m_pPackedNavMeshData = pData;
+	m_nPackedNavMeshDataSize = nDataSize;
+	m_bDeletePackedNavMeshData = bDelete;
 
-	m_pAINavMeshEdges = (CAINavMeshEdge*)pCur;
-	pCur += m_cAINavMeshEdges * sizeof( CAINavMeshEdge );
+	SetPackedSections( Packed );
 
+	// Polys reference their parent NavMesh by index.  Resolve the
+	// character type masks into a side table, indexed by poly ID.
 
-	//
-	// Read polys.
-	//
-
-	// Edge lists.
-
-	m_cAINavMeshEdgeLists = *(uint32*)pCur;
-	pCur += nSizeInt;
+	m_lstAINavMeshPolyCharTypeMasks.resize( m_cAINavMeshPolys );
+	for( int iPoly=0; iPoly < m_cAINavMeshPolys; ++iPoly )
+	{
+		m_lstAINavMeshPolyCharTypeMasks[iPoly] = GetNMCharTypeMask( m_pAINavMeshPolys[iPoly].GetNMCharTypeMaskIndex() );
+	}
+	CAINavMeshPoly::sm_pNMPolyCharTypeMasks = m_lstAINavMeshPolyCharTypeMasks.empty() ? NULL : &m_lstAINavMeshPolyCharTypeMasks[0];
 
-	m_pAINavMeshEdgeLists = (ENUM_NMEdgeID*)pCur;
-	pCur += m_cAINavMeshEdgeLists * nSizeInt;
+	// Setup NavMeshLink Bounds.
 
-	// Region lists.
+	AINavMeshLinkAbstract* pNMLink;
+	NAVMESH_LINK_DATA* pNMLinkData;
+	for( uint32 iNMLink=0; iNMLink < m_cAINavMeshLinks; ++iNMLink )
+	{
+		pNMLinkData = &( m_pAINavMeshLinkData[iNMLink] );
 
-	m_cAIRegionLists = *(uint32*)pCur;
-	pCur += nSizeInt;
+		// Setup the actual NavMeshLink object.
 
-	m_pAIRegionLists = (ENUM_AIRegionID*)pCur;
-	pCur += m_cAIRegionLists * nSizeInt;
+		pNMLink = GetNMLink( pNMLinkData->eNMlinkID );
+		if( pNMLink )
+		{
+			pNMLink->SetNMLinkBounds( pNMLinkData->cBoundaryVerts, m_pAINavMeshLinkBoundaryVerts + pNMLinkData->iBoundaryVertList );
+		}
+	}
 
-	// Poly normals.
+	//
+	// Setup AIRegions.
+	//
 
-	m_cAINavMeshPolyNormals = *(uint32*)pCur;
-	pCur += nSizeInt;
+	AIREGION_DATA* pAIRegionData;
+	for( uint32 iRegion=0; iRegion < m_cAIRegions; ++iRegion )
+	{
+		// Skip invalid regions.
 
-	m_pAINavMeshPolyNormals = (LTVector*)pCur;
-	pCur += m_cAINavMeshPolyNormals * nSizeVector;
+		pAIRegionData = &( m_pAIRegionData[iRegion] );
+		if( (uint32)pAIRegionData->eAIRegionID < m_lstAIRegions.size() )
+		{
+			AIRegion* pAIRegion = m_lstAIRegions[pAIRegionData->eAIRegionID];
+			pAIRegion->SetupAIRegion( pAIRegionData->vBoundingSphereCenter,
+				pAIRegionData->fBoundingSphereRadius,
+				pAIRegionData->cNMPolys,
+				m_pNMPolyLists + pAIRegionData->iNMPolyList );
+		}
+	}
 
-	// Polys.
+	// Setup node clusters.
 
-	m_cAINavMeshPolys = *(uint32*)pCur;
-	pCur += nSizeInt;
+	SetupNodeClusters();
 
-	m_pAINavMeshPolys = (CAINavMeshPoly*)pCur;
-	pCur += m_cAINavMeshPolys * sizeof( CAINavMeshPoly );
+	// Setup the quad tree.
 
+	g_pAIQuadTree->SetQuadTreeNodes( m_pAIQuadTreeNodes, m_cAIQuadTreeNodes, m_pAIQuadTreeNMPolyLists );
 
-	//
-	// Read regions.
-	//
+	// Runtime, notify the navmeshdata object that the navmesh has been
+	// constructed, so that it may reflect the change and provide a flag set.
+	m_pAINavMeshObject->OnNavMeshCreated(m_cAINavMeshPolys);
 
-	// Region poly lists.
+	// Connect the navmesh links
+	ConnectNMLinks();
 
-	m_cNMPolyLists = *(uint32*)pCur;
-	pCur += nSizeInt;
+	// Initialization complete.
 
-	m_pNMPolyLists = (ENUM_NMPolyID*)pCur;
-	pCur += m_cNMPolyLists * nSizeInt;
+	m_bNMInitialized = true;
+}
 
-	// Regions.
+//----------------------------------------------------------------------------
+//              
+//	ROUTINE:	CAINavMesh::SetPackedSections()
+//              
+//	PURPOSE:	Point the NavMesh at each section of packed data.
+//              
+//----------------------------------------------------------------------------
 
-	m_cAIRegions = *(uint32*)pCur;
-	pCur += nSizeInt;
+void CAINavMesh::SetPackedSections( const AINAVMESH_PACKED_DATA& Packed )
+{
+	m_cAINavMeshEdges = Packed.cEdges;
+	m_pAINavMeshEdges = Packed.pEdges;
 
-	m_pAIRegionData = (AIREGION_DATA*)pCur;
-	pCur += m_cAIRegions * sizeof( AIREGION_DATA );
+	m_cAINavMeshEdgeLists = Packed.cEdgeLists;
+	m_pAINavMeshEdgeLists = Packed.pEdgeLists;
 
+	m_cAIRegionLists = Packed.cAIRegionLists;
+	m_pAIRegionLists = Packed.pAIRegionLists;
 
-	//
-	// Read components.
-	//
+	m_cAINavMeshPolyNormals = Packed.cPolyNormals;
+	m_pAINavMeshPolyNormals = Packed.pPolyNormals;
 
-	// Components.
+	m_cAINavMeshPolys = Packed.cPolys;
+	m_pAINavMeshPolys = Packed.pPolys;
 
-	m_cAINavMeshComponents = *(uint32*)pCur;
-	pCur += nSizeInt;
+	m_cNMPolyLists = Packed.cNMPolyLists;
+	m_pNMPolyLists = Packed.pNMPolyLists;
 
-	m_pAINavMeshComponents = (CAINavMeshComponent*)pCur;
-	pCur += m_cAINavMeshComponents * sizeof( CAINavMeshComponent );
+	m_cAIRegions = Packed.cAIRegions;
+	m_pAIRegionData = Packed.pAIRegionData;
 
-	// Component neighbor lists.
+	m_cAINavMeshComponents = Packed.cComponents;
+	m_pAINavMeshComponents = Packed.pComponents;
 
-	m_cAINavMeshComponentNeighborLists = *(uint32*)pCur;
-	pCur += nSizeInt;
+	m_cAINavMeshComponentNeighborLists = Packed.cComponentNeighborLists;
+	m_pAINavMeshComponentNeighborLists = Packed.pComponentNeighborLists;
 
-	m_pAINavMeshComponentNeighborLists = (ENUM_NMComponentID*)pCur;
-	pCur += m_cAINavMeshComponentNeighborLists * nSizeInt;
+	m_cAINavMeshLinks = Packed.cLinks;
+	m_pAINavMeshLinkData = Packed.pLinkData;
 
+	m_cAINavMeshLinkBoundaryVerts = Packed.cLinkBoundaryVerts;
+	m_pAINavMeshLinkBoundaryVerts = Packed.pLinkBoundaryVerts;
 
-	//
-	// Read NavMeshLinks.
-	//
+	m_cClusteredAINodes = Packed.cClusteredAINodes;
+	m_pClusteredAINodes = Packed.pClusteredAINodes;
 
-	// NavMeshLinks.
+	m_pszClusteredAINodeNameList = Packed.pszNameList;
 
-	m_cAINavMeshLinks = *(uint32*)pCur;
-	pCur += nSizeInt;
+	m_cAIQuadTreeNodes = Packed.cQuadTreeNodes;
+	m_pAIQuadTreeNodes = Packed.pQuadTreeNodes;
 
-	m_pAINavMeshLinkData = (NAVMESH_LINK_DATA*)pCur;
-	pCur += m_cAINavMeshLinks * sizeof( NAVMESH_LINK_DATA );
+	m_cAIQuadTreeNMPolyLists = Packed.cQuadTreeNMPolyLists;
+	m_pAIQuadTreeNMPolyLists = Packed.pQuadTreeNMPolyLists;
+}
 
-	// Boundary verts.
+//----------------------------------------------------------------------------
+//              
+//	ROUTINE:	ReadPackedSection()
+//              
+//	PURPOSE:	Read a count-prefixed section of packed NavMesh data.
+//				Returns false if the section extends past the end of
+//				the data.
+//              
+//----------------------------------------------------------------------------
 
-	m_cAINavMeshLinkBoundaryVerts = *(uint32*)pCur;
-	pCur += nSizeInt;
+template<typename T>
+static bool ReadPackedSection( uint8*& pCur, const uint8* pEnd, uint32* pcElements, T** ppSection )
+{
+	if( (uint32)( pEnd - pCur ) < sizeof( uint32 ) )
+	{
+		return false;
+	}
 
-	m_pAINavMeshLinkBoundaryVerts = (LTVector*)pCur;
-	pCur += m_cAINavMeshLinkBoundaryVerts * nSizeVector;
+	*pcElements = *(uint32*)pCur;
+	pCur += sizeof( uint32 );
 
+	if( (uint32)( pEnd - pCur ) / sizeof( T ) < *pcElements )
+	{
+		return false;
+	}
 
-	//
-	// Read node clusters.
-	//
+	*ppSection = (T*)pCur;
+	pCur += *pcElements * sizeof( T );
 
-	// Nodes.
+	return true;
+}
 
-	m_cClusteredAINodes = *(uint32*)pCur;
-	pCur += nSizeInt;
+//----------------------------------------------------------------------------
+//              
+//	ROUTINE:	CAINavMesh::ReadPackedNavMesh()
+//              
+//	PURPOSE:	Locate each section of packed NavMesh data.
+//              
+//----------------------------------------------------------------------------
 
-	m_pClusteredAINodes = (AINODE_CLUSTER_DATA*)pCur;
-	pCur += m_cClusteredAINodes * sizeof( AINODE_CLUSTER_DATA );
+bool CAINavMesh::ReadPackedNavMesh( uint8* pData, uint32 nDataSize, AINAVMESH_PACKED_DATA* pPacked )
+{
+	// Sanity check.
 
-	// Name list.
+	if( !( pData && pPacked ) )
+	{
+		return false;
+	}
 
-	uint32 nNameListSize = *(uint32*)pCur;
-	pCur += nSizeInt;
+	if( nDataSize < 2 * sizeof( uint32 ) )
+	{
+		return false;
+	}
 
-	m_pszClusteredAINodeNameList = (char*)pCur;
-	pCur += nNameListSize;
+	uint8* pCur = pData;
+	const uint8* pEnd = pData + nDataSize;
 
 
 	//
-	// Read quad tree.
+	// Read header.
 	//
 
-	// Quad tree nodes.
+	uint32 nVersion = *(uint32*)pCur;
+	pCur += sizeof( uint32 );
 
-	m_cAIQuadTreeNodes = *(uint32*)pCur;
-	pCur += nSizeInt;
+	// Bail if incorrect version.
 
-	m_pAIQuadTreeNodes = (CAIQuadTreeNode*)pCur;
-	pCur += m_cAIQuadTreeNodes * sizeof( CAIQuadTreeNode );
+	if( nVersion != AINAVMESH_VERSION_NUMBER )
+	{
+		AIASSERT2( 0, NULL, "CAINavMesh::ReadPackedNavMesh: Packed NavMesh is incorrect version: %d != %d", nVersion, AINAVMESH_VERSION_NUMBER );
+		return false;
+	}
 
-	// Quad tree poly references.
+	// Skip the reserved word.  This used to flag data whose pointers had
+	// been fixed-up in place, but the data is no longer modified.
 
-	m_cAIQuadTreeNMPolyLists = *(uint32*)pCur;
-	pCur += nSizeInt;
+	pCur += sizeof( uint32 );
 
-	m_pAIQuadTreeNMPolyLists = (ENUM_NMPolyID*)pCur;
-	pCur += m_cAIQuadTreeNMPolyLists * nSizeInt;
+	// Edges, then polys.
 
+	if( !( ReadPackedSection( pCur, pEnd, &pPacked->cEdges, &pPacked->pEdges ) &&
+		   ReadPackedSection( pCur, pEnd, &pPacked->cEdgeLists, &pPacked->pEdgeLists ) &&
+		   ReadPackedSection( pCur, pEnd, &pPacked->cAIRegionLists, &pPacked->pAIRegionLists ) &&
+		   ReadPackedSection( pCur, pEnd, &pPacked->cPolyNormals, &pPacked->pPolyNormals ) &&
+		   ReadPackedSection( pCur, pEnd, &pPacked->cPolys, &pPacked->pPolys ) ) )
+	{
+		return false;
+	}
 
-	// Fix-up pass on raw data.
-	// Only necessary if BlindObjectData was not already in memory.
+	// Regions.
 
-	if( !( *m_pbAINavMeshFixedUp ) )
+	if( !( ReadPackedSection( pCur, pEnd, &pPacked->cNMPolyLists, &pPacked->pNMPolyLists ) &&
+		   ReadPackedSection( pCur, pEnd, &pPacked->cAIRegions, &pPacked->pAIRegionData ) ) )
 	{
-		FixUpNavMeshPointers();
+		return false;
 	}
 
-	// Setup NavMeshLink Bounds.
+	// Components.
 
-	AINavMeshLinkAbstract* pNMLink;
-	NAVMESH_LINK_DATA* pNMLinkData;
-	for( uint32 iNMLink=0; iNMLink < m_cAINavMeshLinks; ++iNMLink )
+	if( !( ReadPackedSection( pCur, pEnd, &pPacked->cComponents, &pPacked->pComponents ) &&
+		   ReadPackedSection( pCur, pEnd, &pPacked->cComponentNeighborLists, &pPacked->pComponentNeighborLists ) ) )
 	{
-		pNMLinkData = &( m_pAINavMeshLinkData[iNMLink] );
+		return false;
+	}
 
-		// Setup the actual NavMeshLink object.
+	// NavMeshLinks.
 
-		pNMLink = GetNMLink( pNMLinkData->eNMlinkID );
-		if( pNMLink )
-		{
-			pNMLink->SetNMLinkBounds( pNMLinkData->cBoundaryVerts, pNMLinkData->pBoundaryVerts );
-		}
+	if( !( ReadPackedSection( pCur, pEnd, &pPacked->cLinks, &pPacked->pLinkData ) &&
+		   ReadPackedSection( pCur, pEnd, &pPacked->cLinkBoundaryVerts, &pPacked->pLinkBoundaryVerts ) ) )
+	{
+		return false;
 	}
 
-	//
-	// Setup AIRegions.
-	//
+	// Node clusters.
 
-	AIREGION_DATA* pAIRegionData;
-	for( uint32 iRegion=0; iRegion < m_cAIRegions; ++iRegion )
+	if( !( ReadPackedSection( pCur, pEnd, &pPacked->cClusteredAINodes, &pPacked->pClusteredAINodes ) &&
+		   ReadPackedSection( pCur, pEnd, &pPacked->nNameListSize, &pPacked->pszNameList ) ) )
 	{
-		// Skip invalid regions.
+		return false;
+	}
 
-		pAIRegionData = &( m_pAIRegionData[iRegion] );
-		if( (uint32)pAIRegionData->eAIRegionID < m_lstAIRegions.size() )
-		{
-			AIRegion* pAIRegion = m_lstAIRegions[pAIRegionData->eAIRegionID];
-			pAIRegion->SetupAIRegion( pAIRegionData->vBoundingSphereCenter,
-				pAIRegionData->fBoundingSphereRadius,
-				pAIRegionData->cNMPolys,
-				pAIRegionData->pNMPolyIDs );
-		}
+	// Quad tree.
+
+	if( !( ReadPackedSection( pCur, pEnd, &pPacked->cQuadTreeNodes, &pPacked->pQuadTreeNodes ) &&
+		   ReadPackedSection( pCur, pEnd, &pPacked->cQuadTreeNMPolyLists, &pPacked->pQuadTreeNMPolyLists ) ) )
+	{
+		return false;
 	}
 
-	// Runtime, notify the navmeshdata object that the navmesh has been
-	// constructed, so that it may reflect the change and provide a flag set.
-	m_pAINavMeshObject->OnNavMeshCreated(m_cAINavMeshPolys);
+	return true;
+}
 
-	// Connect the navmesh links
-	ConnectNMLinks();
+//----------------------------------------------------------------------------
+//              
+//	ROUTINE:	IsValidPackedList() / IsValidPackedID()
+//              
+//	PURPOSE:	Range checks for indices stored in packed NavMesh data.
+//              
+//----------------------------------------------------------------------------
 
-	// Initialization complete.
+static bool IsValidPackedList( uint32 iList, int cElements, uint32 cListSize )
+{
+	return ( cElements >= 0 ) && ( iList <= cListSize ) && ( (uint32)cElements <= cListSize - iList );
+}
 
-	m_bNMInitialized = true;
+static bool IsValidPackedID( int nID, uint32 cIDs, bool bAllowInvalid )
+{
+	if( nID == -1 )
+	{
+		return bAllowInvalid;
+	}
+
+	return ( nID >= 0 ) && ( (uint32)nID < cIDs );
 }
 
 //----------------------------------------------------------------------------
 //              
-//	ROUTINE:	CAINavMesh::FixUpNavMeshPointers()
+//	ROUTINE:	CAINavMesh::ValidatePackedNavMesh()
 //              
-//	PURPOSE:	Fix-up pass on raw NavMesh data.
+//	PURPOSE:	Verify that every index stored in packed NavMesh data
+//				refers to an element inside the data.  Data that passes
+//				may be accessed in place without further checks.
 //              
 //----------------------------------------------------------------------------
 
-void CAINavMesh::FixUpNavMeshPointers()
+bool CAINavMesh::ValidatePackedNavMesh( uint8* pData, uint32 nDataSize )
 {
-	//
-	// Indicate that this BlindObjectData has already been fixed-up
-	// and does not need to be fixed up again.
-	//
+	AINAVMESH_PACKED_DATA Packed;
+	if( !ReadPackedNavMesh( pData, nDataSize, &Packed ) )
+	{
+		return false;
+	}
 
-	*m_pbAINavMeshFixedUp = true;
+	// Edges.
 
-	//
-	// Fix up polys.
-	//
+	uint32 iEdge;
+	for( iEdge=0; iEdge < Packed.cEdges; ++iEdge )
+	{
+		const CAINavMeshEdge& Edge = Packed.pEdges[iEdge];
+		if( ( (uint32)Edge.GetNMEdgeID() != iEdge ) ||
+			!IsValidPackedID( Edge.GetNMPolyIDA(), Packed.cPolys, true ) ||
+			!IsValidPackedID( Edge.GetNMPolyIDB(), Packed.cPolys, true ) )
+		{
+			return false;
+		}
+	}
 
-	CAINavMeshPoly* pNMPoly;
-	for( int iPoly=0; iPoly < m_cAINavMeshPolys; ++iPoly )
+	for( iEdge=0; iEdge < Packed.cEdgeLists; ++iEdge )
 	{
-		pNMPoly = &( m_pAINavMeshPolys[iPoly] );
-		pNMPoly->FixUpNavMeshPointers( m_pAINavMeshEdgeLists, m_pAIRegionLists );
+		if( !IsValidPackedID( Packed.pEdgeLists[iEdge], Packed.cEdges, false ) )
+		{
+			return false;
+		}
 	}
 
+	// Polys.  Poly IDs must match their index, as per-poly run-time
+	// state is kept in side tables indexed by poly ID.
 
-	//
-	// Fix up regions.
-	//
+	for( uint32 iPoly=0; iPoly < Packed.cPolys; ++iPoly )
+	{
+		const CAINavMeshPoly& Poly = Packed.pPolys[iPoly];
+		if( ( (uint32)Poly.GetNMPolyID() != iPoly ) ||
+			!IsValidPackedID( Poly.GetNMNormalID(), Packed.cPolyNormals, true ) ||
+			!IsValidPackedID( Poly.GetNMComponentID(), Packed.cComponents, true ) ||
+			!IsValidPackedList( Poly.m_iNMPolyEdgeList, Poly.m_cNMPolyEdges, Packed.cEdgeLists ) ||
+			!IsValidPackedList( Poly.m_iAIRegionList, Poly.m_cAIRegions, Packed.cAIRegionLists ) )
+		{
+			return false;
+		}
+	}
 
-	AIREGION_DATA* pAIRegionData;
-	for( uint32 iRegion=0; iRegion < m_cAIRegions; ++iRegion )
+	// Regions.
+
+	uint32 iPolyRef;
+	for( iPolyRef=0; iPolyRef < Packed.cNMPolyLists; ++iPolyRef )
 	{
-		// Skip invalid regions.
+		if( !IsValidPackedID( Packed.pNMPolyLists[iPolyRef], Packed.cPolys, false ) )
+		{
+			return false;
+		}
+	}
 
-		pAIRegionData = &( m_pAIRegionData[iRegion] );
-		if( (uint32)pAIRegionData->eAIRegionID < m_lstAIRegions.size() )
+	for( uint32 iRegion=0; iRegion < Packed.cAIRegions; ++iRegion )
+	{
+		const AIREGION_DATA& Region = Packed.pAIRegionData[iRegion];
+		if( !IsValidPackedList( Region.iNMPolyList, (int)Region.cNMPolys, Packed.cNMPolyLists ) )
 		{
-			// Convert poly list index into pointer.
+			return false;
+		}
+	}
+
+	// Components.
 
-			uint32 iPolyList = (uint32)pAIRegionData->pNMPolyIDs;
-			pAIRegionData->pNMPolyIDs = m_pNMPolyLists + iPolyList;
+	for( uint32 iComponent=0; iComponent < Packed.cComponents; ++iComponent )
+	{
+		const CAINavMeshComponent& Component = Packed.pComponents[iComponent];
+		if( !IsValidPackedList( Component.m_iNMComponentNeighborList, Component.m_cNMComponentNeighbors, Packed.cComponentNeighborLists ) )
+		{
+			return false;
 		}
 	}
 
+	for( uint32 iNeighbor=0; iNeighbor < Packed.cComponentNeighborLists; ++iNeighbor )
+	{
+		if( !IsValidPackedID( Packed.pComponentNeighborLists[iNeighbor], Packed.cComponents, false ) )
+		{
+			return false;
+		}
+	}
 
-	//
-	// Fix up components.
-	//
+	// NavMeshLinks.
 
-	CAINavMeshComponent* pNMComponent;
-	for( int iComponent=0; iComponent < m_cAINavMeshComponents; ++iComponent )
+	for( uint32 iNMLink=0; iNMLink < Packed.cLinks; ++iNMLink )
 	{
-		pNMComponent = &( m_pAINavMeshComponents[iComponent] );
-		pNMComponent->FixUpNavMeshPointers( m_pAINavMeshComponentNeighborLists );
+		const NAVMESH_LINK_DATA& Link = Packed.pLinkData[iNMLink];
+		if( !IsValidPackedList( Link.iBoundaryVertList, (int)Link.cBoundaryVerts, Packed.cLinkBoundaryVerts ) )
+		{
+			return false;
+		}
 	}
 
+	// Node clusters.  Names must be terminated within the name list.
 
-	//
-	// Fix up NavMeshLinks.
-	//
+	for( uint32 iNode=0; iNode < Packed.cClusteredAINodes; ++iNode )
+	{
+		uint32 iName = Packed.pClusteredAINodes[iNode].iName;
+		if( ( iName >= Packed.nNameListSize ) ||
+			!memchr( Packed.pszNameList + iName, 0, Packed.nNameListSize - iName ) )
+		{
+			return false;
+		}
+	}
 
-	NAVMESH_LINK_DATA* pNMLinkData;
-	for( uint32 iNMLink=0; iNMLink < m_cAINavMeshLinks; ++iNMLink )
+	// Quad tree.  Children are always created after their parent, so
+	// a child ID that is not greater than its parent's would form a cycle.
+
+	for( uint32 iQTNode=0; iQTNode < Packed.cQuadTreeNodes; ++iQTNode )
 	{
-		pNMLinkData = &( m_pAINavMeshLinkData[iNMLink] );
+		const CAIQuadTreeNode& QTNode = Packed.pQuadTreeNodes[iQTNode];
+		if( ( (uint32)QTNode.m_eQTNodeID != iQTNode ) ||
+			!IsValidPackedList( QTNode.m_iNMPolyList, QTNode.m_cNMPolyListSize, Packed.cQuadTreeNMPolyLists ) )
+		{
+			return false;
+		}
 
-		// Convert bounds list index into pointer.
+		for( int iChild=0; iChild < 4; ++iChild )
+		{
+			ENUM_QTNodeID eChild = QTNode.m_eQTNodeChild[iChild];
+			if( !IsValidPackedID( eChild, Packed.cQuadTreeNodes, true ) ||
+				( ( eChild != kQTNode_Invalid ) && ( (uint32)eChild <= iQTNode ) ) )
+			{
+				return false;
+			}
+		}
+	}
 
-		uint32 iBoundsList = (uint32)pNMLinkData->pBoundaryVerts;
-		pNMLinkData->pBoundaryVerts = m_pAINavMeshLinkBoundaryVerts + iBoundsList;
+	for( iPolyRef=0; iPolyRef < Packed.cQuadTreeNMPolyLists; ++iPolyRef )
+	{
+		if( !IsValidPackedID( Packed.pQuadTreeNMPolyLists[iPolyRef], Packed.cPolys, false ) )
+		{
+			return false;
+		}
 	}
 
+	return true;
+}
 
-	//
-	// Fix up node clusters.
-	//
+//----------------------------------------------------------------------------
+//              
+//	ROUTINE:	CAINavMesh::SetupNodeClusters()
+//              
+//	PURPOSE:	Set the cluster ID of each clustered AINode.
+//              
+//----------------------------------------------------------------------------
 
+void CAINavMesh::SetupNodeClusters()
+{
 	AINode* pNode;
 	HOBJECT hNode;
+	const char* pszName;
 	AINODE_CLUSTER_DATA* pNodeClusterData;
 	for( uint32 iNode=0; iNode < m_cClusteredAINodes; ++iNode )
 	{
-		// Convert name list index into string pointer.
-
-		pNodeClusterData = &( m_pClusteredAINodes[iNode] );
-		uint32 iNameList = (uint32)pNodeClusterData->pszName;
-		pNodeClusterData->pszName = m_pszClusteredAINodeNameList + iNameList;
-
 		// Find node by name, and set cluster ID.
 
-		if( LT_OK == FindNamedObject( pNodeClusterData->pszName, hNode ) )
+		pNodeClusterData = &( m_pClusteredAINodes[iNode] );
+		pszName = m_pszClusteredAINodeNameList + pNodeClusterData->iName;
+		if( LT_OK == FindNamedObject( pszName, hNode ) )
 		{
 			pNode = (AINode*)g_pLTServer->HandleToObject( hNode );
 			pNode->SetAINodeClusterID( pNodeClusterData->eAINodeClusterID );
 		}
 	}
-
-
-	//
-	// Fix up quad tree.
-	//
-
-	// Set the tree's root.
-
-	g_pAIQuadTree->SetQuadTreeRoot( m_pAIQuadTreeNodes );
-
-	// Fix up pointers.
-
-	CAIQuadTreeNode* pQTNode;
-	for( uint32 iQTNode=0; iQTNode < m_cAIQuadTreeNodes; ++iQTNode )
-	{
-		pQTNode = &( m_pAIQuadTreeNodes[iQTNode] );
-		pQTNode->FixUpNavMeshPointers( m_pAIQuadTreeNodes, m_pAIQuadTreeNMPolyLists );
-	}
 }
 
 //----------------------------------------------------------------------------
@@ -2095,3 +2203,216 @@ bool CAINavMesh::IsNavMeshBlindDataProcessed( uint8* blindData, uint32 nSize )
 
 	return (((uint32*)blindData)[0] != 0);
 }
+
+#ifndef _FINAL
+
+//----------------------------------------------------------------------------
+//              
+//	ROUTINE:	CAINavMesh::RunNavMeshValidate
+//              
+//	PURPOSE:	Validate the packed data of the current NavMesh, or of a
+//				NavMesh cache file, and print its section sizes.
+//              
+//----------------------------------------------------------------------------
+
+void CAINavMesh::RunNavMeshValidate( const char* pszFilename )
+{
+	CSharedFileMapping FileMapping;
+	uint8* pData = m_pPackedNavMeshData;
+	uint32 nDataSize = m_nPackedNavMeshDataSize;
+	const char* pszSource = m_SharedNavMeshData.IsMapped() ? m_SharedNavMeshData.GetFilename() : "private copy";
+
+	if( pszFilename )
+	{
+		pData = const_cast<uint8*>( FileMapping.MapFile( pszFilename ) );
+		nDataSize = FileMapping.GetDataSize();
+		pszSource = pszFilename;
+	}
+
+	if( !pData )
+	{
+		g_pLTServer->CPrint( "NavMeshValidate: No NavMesh data to validate." );
+		return;
+	}
+
+	AINAVMESH_PACKED_DATA Packed;
+	bool bRead = ReadPackedNavMesh( pData, nDataSize, &Packed );
+	bool bValid = bRead && ValidatePackedNavMesh( pData, nDataSize );
+
+	g_pLTServer->CPrint( "NavMeshValidate: %s (%u bytes) is %s.", pszSource, nDataSize, bValid ? "valid" : "INVALID" );
+	if( bRead )
+	{
+		g_pLTServer->CPrint( "  Polys %u, Edges %u, Components %u, AIRegions %u, Links %u, QuadTreeNodes %u",
+			Packed.cPolys, Packed.cEdges, Packed.cComponents, Packed.cAIRegions, Packed.cLinks, Packed.cQuadTreeNodes );
+	}
+}
+
+//----------------------------------------------------------------------------
+//              
+//	ROUTINE:	CAINavMesh::CollectNavMeshQueryResults
+//              
+//	PURPOSE:	Run point and neighbor queries over the current packed
+//				data, and append the results to the list.  The points
+//				come from a fixed seed, so two runs over equal data
+//				produce equal lists.
+//              
+//----------------------------------------------------------------------------
+
+void CAINavMesh::CollectNavMeshQueryResults( uint32 nSamples, CHAR_TYPE_MASK_LIST* plstResults )
+{
+	// Every poly's packed references.
+
+	for( int iPoly=0; iPoly < m_cAINavMeshPolys; ++iPoly )
+	{
+		CAINavMeshPoly* pPoly = GetNMPoly( (ENUM_NMPolyID)iPoly );
+		plstResults->push_back( pPoly->GetNMCharTypeMask() );
+		plstResults->push_back( pPoly->GetNMComponentID() );
+		plstResults->push_back( pPoly->GetNMNormalID() );
+
+		for( int iEdge=0; iEdge < pPoly->GetNumNMPolyEdges(); ++iEdge )
+		{
+			CAINavMeshPoly* pNeighbor = pPoly->GetNMPolyNeighborAtEdge( iEdge );
+			plstResults->push_back( pNeighbor ? pNeighbor->GetNMPolyID() : kNMPoly_Invalid );
+		}
+
+		for( int iRegion=0; iRegion < pPoly->GetNumAIRegions(); ++iRegion )
+		{
+			plstResults->push_back( pPoly->GetAIRegion( iRegion ) );
+		}
+	}
+
+	if( m_cAINavMeshPolys == 0 )
+	{
+		return;
+	}
+
+	// Containing polys at points in and around random polys, through
+	// both the cell grid and the quad tree.
+
+	uint32 nSeed = 0x1f3a7c55;
+	CAIQuadTreeNode* pRoot = g_pAIQuadTree->GetQTNode( (ENUM_QTNodeID)0 );
+	for( uint32 iSample=0; iSample < nSamples; ++iSample )
+	{
+		nSeed = nSeed * 1664525 + 1013904223;
+		CAINavMeshPoly* pPoly = GetNMPoly( (ENUM_NMPolyID)( ( nSeed >> 8 ) % m_cAINavMeshPolys ) );
+
+		const SAABB* pAABB = pPoly->GetNMPolyAABB();
+		LTVector vMin = pAABB->vMin - LTVector( 16.f, 32.f, 16.f );
+		LTVector vMax = pAABB->vMax + LTVector( 16.f, 128.f, 16.f );
+
+		LTVector vPos;
+		nSeed = nSeed * 1664525 + 1013904223;
+		vPos.x = vMin.x + ( vMax.x - vMin.x ) * ( (float)( nSeed >> 8 ) / 16777216.f );
+		nSeed = nSeed * 1664525 + 1013904223;
+		vPos.y = vMin.y + ( vMax.y - vMin.y ) * ( (float)( nSeed >> 8 ) / 16777216.f );
+		nSeed = nSeed * 1664525 + 1013904223;
+		vPos.z = vMin.z + ( vMax.z - vMin.z ) * ( (float)( nSeed >> 8 ) / 16777216.f );
+
+		plstResults->push_back( g_pAIQuadTree->GetContainingNMPoly( vPos, ALL_CHAR_TYPES, kNMPoly_Invalid ) );
+		plstResults->push_back( pRoot ? pRoot->GetContainingNMPoly( vPos, ALL_CHAR_TYPES ) : kNMPoly_Invalid );
+	}
+}
+
+//----------------------------------------------------------------------------
+//              
+//	ROUTINE:	CAINavMesh::RunNavMeshCompareTest
+//              
+//	PURPOSE:	Run the same queries over the live packed data and over a
+//				private heap copy of it, and report any difference.  When
+//				the live data is the shared mapping, this checks that the
+//				mapped copy behaves exactly like an unshared one.
+//              
+//----------------------------------------------------------------------------
+
+void CAINavMesh::RunNavMeshCompareTest( uint32 nSamples )
+{
+	if( !( m_bNMInitialized && m_pPackedNavMeshData && g_pAIQuadTree->IsAIQuadTreeInitialized() ) )
+	{
+		g_pLTServer->CPrint( "NavMeshCompareTest: No NavMesh is loaded." );
+		return;
+	}
+
+	if( nSamples == 0 )
+	{
+		nSamples = 16384;
+	}
+
+	g_pLTServer->CPrint( "NavMeshCompareTest: Live data is %s.", 
+		m_SharedNavMeshData.IsMapped() ? m_SharedNavMeshData.GetFilename() : "a private copy" );
+
+	// The processed blind data is the source of the live data.
+
+	uint8* pBlindData = NULL;
+	uint32 nBlindDataSize = 0;
+	if( GetNavMeshBlindObjectData( pBlindData, nBlindDataSize ) &&
+		( nBlindDataSize == m_nPackedNavMeshDataSize + sizeof( uint32 ) ) )
+	{
+		bool bMatch = ( memcmp( pBlindData + sizeof( uint32 ), m_pPackedNavMeshData, m_nPackedNavMeshDataSize ) == 0 );
+		g_pLTServer->CPrint( "NavMeshCompareTest: Live data %s the blind data.", bMatch ? "matches" : "DIFFERS FROM" );
+	}
+
+	uint8* pCopy = debug_newa( uint8, m_nPackedNavMeshDataSize );
+	memcpy( pCopy, m_pPackedNavMeshData, m_nPackedNavMeshDataSize );
+
+	AINAVMESH_PACKED_DATA LivePacked;
+	AINAVMESH_PACKED_DATA CopyPacked;
+	ReadPackedNavMesh( m_pPackedNavMeshData, m_nPackedNavMeshDataSize, &LivePacked );
+	ReadPackedNavMesh( pCopy, m_nPackedNavMeshDataSize, &CopyPacked );
+
+	CHAR_TYPE_MASK_LIST lstLiveResults;
+	CollectNavMeshQueryResults( nSamples, &lstLiveResults );
+
+	// Repoint the NavMesh and quad tree at the copy, then back.
+
+	SetPackedSections( CopyPacked );
+	g_pAIQuadTree->SetQuadTreeNodes( m_pAIQuadTreeNodes, m_cAIQuadTreeNodes, m_pAIQuadTreeNMPolyLists );
+
+	CHAR_TYPE_MASK_LIST lstCopyResults;
+	CollectNavMeshQueryResults( nSamples, &lstCopyResults );
+
+	SetPackedSections( LivePacked );
+	g_pAIQuadTree->SetQuadTreeNodes( m_pAIQuadTreeNodes, m_cAIQuadTreeNodes, m_pAIQuadTreeNMPolyLists );
+
+	debug_deletea( pCopy );
+
+	uint32 nMismatches = 0;
+	for( uint32 iResult=0; iResult < lstLiveResults.size() && iResult < lstCopyResults.size(); ++iResult )
+	{
+		if( lstLiveResults[iResult] != lstCopyResults[iResult] )
+		{
+			++nMismatches;
+		}
+	}
+	if( lstLiveResults.size() != lstCopyResults.size() )
+	{
+		++nMismatches;
+	}
+
+	g_pLTServer->CPrint( "NavMeshCompareTest: %u results over %d polys and %u points, %u mismatches.",
+		(uint32)lstLiveResults.size(), m_cAINavMeshPolys, nSamples, nMismatches );
+}
+
+//----------------------------------------------------------------------------
+
+static void NavMeshValidateCB( int argc, char** argv )
+{
+	if( !g_pAINavMesh )
+	{
+		return;
+	}
+
+	g_pAINavMesh->RunNavMeshValidate( ( argc > 0 ) ? argv[0] : NULL );
+}
+
+static void NavMeshCompareTestCB( int argc, char** argv )
+{
+	if( !g_pAINavMesh )
+	{
+		return;
+	}
+
+	uint32 nSamples = ( argc > 0 ) ? (uint32)atoi( argv[0] ) : 0;
+	g_pAINavMesh->RunNavMeshCompareTest( nSamples );
+}
+
+#endif // _FINAL
@@ -18,6 +18,7 @@
 #include "AIEnumNavMeshLinkTypes.h"
 #include "AIRegion.h"
 #include "AICharacterTypeRestrictions.h"
+#include "SharedFileMapping.h"
 
 LINKTO_MODULE( AINavMesh );
 
@@ -144,6 +145,59 @@ private:
 
 //-----------------------------------------------------------------
 
+// Section table of a packed NavMesh, as read by CAINavMesh::ReadPackedNavMesh.
+// Each pointer addresses the first element of a section in the packed data.
+
+struct AINAVMESH_PACKED_DATA
+{
+	uint32					cEdges;
+	CAINavMeshEdge*			pEdges;
+
+	uint32					cEdgeLists;
+	ENUM_NMEdgeID*			pEdgeLists;
+
+	uint32					cAIRegionLists;
+	ENUM_AIRegionID*		pAIRegionLists;
+
+	uint32					cPolyNormals;
+	LTVector*				pPolyNormals;
+
+	uint32					cPolys;
+	CAINavMeshPoly*			pPolys;
+
+	uint32					cNMPolyLists;
+	ENUM_NMPolyID*			pNMPolyLists;
+
+	uint32					cAIRegions;
+	AIREGION_DATA*			pAIRegionData;
+
+	uint32					cComponents;
+	CAINavMeshComponent*	pComponents;
+
+	uint32					cComponentNeighborLists;
+	ENUM_NMComponentID*		pComponentNeighborLists;
+
+	uint32					cLinks;
+	NAVMESH_LINK_DATA*		pLinkData;
+
+	uint32					cLinkBoundaryVerts;
+	LTVector*				pLinkBoundaryVerts;
+
+	uint32					cClusteredAINodes;
+	AINODE_CLUSTER_DATA*	pClusteredAINodes;
+
+	uint32					nNameListSize;
+	const char*				pszNameList;
+
+	uint32					cQuadTreeNodes;
+	CAIQuadTreeNode*		pQuadTreeNodes;
+
+	uint32					cQuadTreeNMPolyLists;
+	ENUM_NMPolyID*			pQuadTreeNMPolyLists;
+};
+
+//-----------------------------------------------------------------
+
 class CAINavMesh
 {
 friend class CAINavMeshGen;
@@ -160,7 +214,8 @@ public:
 	void	SetAINavMeshObject( AINavMesh* pAINavMesh ) { m_pAINavMeshObject = pAINavMesh; }
 	void	AddNMCharTypeMask( uint32 iMaskIndex, uint32 dwMask );
 	void	SortAINavMeshLinks();
-	void	RuntimeSetup( uint8* pData, bool bDelete );
+	void	RuntimeSetup( uint8* pData, uint32 nDataSize, bool bDelete );
+	bool	IsNavMeshDataShared() const { return m_SharedNavMeshData.IsMapped(); }
 
 	void	AddAINavMeshLink( AINavMeshLinkAbstract* pLink );
 	void	AddAIRegion( AIRegion* pAIRegion );
@@ -176,6 +231,7 @@ public:
 	bool					IsNavMeshInitialized() const { return m_bNMInitialized; }
 
 	uint32					GetNMCharTypeMask( uint32 iMaskIndex );
+	uint32					GetNMPolyCharTypeMask( ENUM_NMPolyID ePoly ) const { return m_lstAINavMeshPolyCharTypeMasks[ePoly]; }
 
 	int						GetNumNMPolys() { return m_cAINavMeshPolys; }
 	CAINavMeshPoly*			GetNMPoly( ENUM_NMPolyID ePoly );
@@ -193,9 +249,27 @@ public:
 
 	AIRegion*				GetAIRegion( ENUM_AIRegionID eRegion );
 
+	// Packed list access.  Lists are addressed by the element indices
+	// stored in the packed data.
+
+	const ENUM_NMEdgeID*		GetNMEdgeList( uint32 iList ) const { return m_pAINavMeshEdgeLists + iList; }
+	const ENUM_AIRegionID*		GetAIRegionList( uint32 iList ) const { return m_pAIRegionLists + iList; }
+	const ENUM_NMComponentID*	GetNMComponentNeighborList( uint32 iList ) const { return m_pAINavMeshComponentNeighborLists + iList; }
+
 	static bool				GetNavMeshBlindObjectData( uint8*& blindData, uint32& blindDataSize );
 	static bool				IsNavMeshBlindDataProcessed( uint8* blindData, uint32 nSize );
 
+	// Packed data.
+
+	static bool				ReadPackedNavMesh( uint8* pData, uint32 nDataSize, AINAVMESH_PACKED_DATA* pPacked );
+	static bool				ValidatePackedNavMesh( uint8* pData, uint32 nDataSize );
+
+#ifndef _FINAL
+	// Console programs.
+
+	void	RunNavMeshValidate( const char* pszFilename );
+	void	RunNavMeshCompareTest( uint32 nSamples );
+#endif // _FINAL
 
 	// Debug rendering.
 
@@ -209,22 +283,32 @@ public:
 
 protected:
 
-	void	FixUpNavMeshPointers();
+	void	SetPackedSections( const AINAVMESH_PACKED_DATA& Packed );
+	void	SetupNodeClusters();
 
 	void	ConnectNMLinks();
 
+#ifndef _FINAL
+	void	CollectNavMeshQueryResults( uint32 nSamples, CHAR_TYPE_MASK_LIST* plstResults );
+#endif // _FINAL
+
 protected:
 
 	bool					m_bNMInitialized;
 	bool					m_bDrawingNavMesh;
 	bool					m_bDrawingAIRegions;
-	bool*					m_pbAINavMeshFixedUp;
 
 	AINavMesh*				m_pAINavMeshObject;
 	uint8*					m_pPackedNavMeshData;
+	uint32					m_nPackedNavMeshDataSize;
 	bool					m_bDeletePackedNavMeshData;
 
+	// Mapped copy of the packed data, shared with other servers
+	// running the same level.
+	CSharedFileMapping		m_SharedNavMeshData;
+
 	CHAR_TYPE_MASK_LIST		m_lstAINavMeshCharTypeMasks;
+	CHAR_TYPE_MASK_LIST		m_lstAINavMeshPolyCharTypeMasks;
 
 	int						m_cAINavMeshPolys;
 	CAINavMeshPoly*			m_pAINavMeshPolys;
@@ -277,23 +361,21 @@ protected:
 
 class CAINavMeshPoly
 {
+friend class CAINavMesh;
 friend class CAINavMeshGen;
 friend class CAINavMeshGenQuadTreeNode;
 public:
 
 	CAINavMeshPoly();
 
-	// NavMesh construction.
-
-	void				FixUpNavMeshPointers( ENUM_NMEdgeID* pAINavMeshEdgeLists, ENUM_AIRegionID* pAIRegionLists );
-
 	// Data Access.
 
 	ENUM_NMPolyID		GetNMPolyID() const { return m_eNMPolyID; }
 	ENUM_NMNormalID		GetNMNormalID() const { return m_eNMNormalID; }
 	ENUM_NMComponentID	GetNMComponentID() const { return m_eNMComponentID; }
 	ENUM_NMLinkID		GetNMLinkID() const { return m_eNMLinkID; }
-	uint32				GetNMCharTypeMask() const { return m_dwNMCharTypeMask; }
+	uint32				GetNMCharTypeMaskIndex() const { return m_iNMCharTypeMask; }
+	uint32				GetNMCharTypeMask() const { return sm_pNMPolyCharTypeMasks[m_eNMPolyID]; }
 	const LTVector&		GetNMPolyCenter() const { return m_vNMPolyCenter; }
 	float				GetNMBoundingRadius() const { return (m_aabbNMPolyBounds.vMax - m_aabbNMPolyBounds.vMin).Mag() / 2.f; }
 	SAABB*				GetNMPolyAABB() { return &m_aabbNMPolyBounds; }
@@ -329,6 +411,16 @@ public:
 
 protected:
 
+	const ENUM_NMEdgeID*	GetNMPolyEdgeList() const { return g_pAINavMesh->GetNMEdgeList( m_iNMPolyEdgeList ); }
+	const ENUM_AIRegionID*	GetAIRegionList() const { return g_pAINavMesh->GetAIRegionList( m_iAIRegionList ); }
+
+protected:
+
+	// Character type masks of the current NavMesh, indexed by poly ID.
+	// Set by CAINavMesh::RuntimeSetup.
+
+	static const uint32*	sm_pNMPolyCharTypeMasks;
+
 	// IMPORTANT:  This data must remain in sync with data packed from NavMeshGen.
 
 	ENUM_NMPolyID		m_eNMPolyID;
@@ -336,16 +428,16 @@ protected:
 	ENUM_NMComponentID	m_eNMComponentID;
 	ENUM_NMLinkID		m_eNMLinkID;
 
-	uint32				m_dwNMCharTypeMask;
+	uint32				m_iNMCharTypeMask;
 
 	LTVector			m_vNMPolyCenter;
 	SAABB				m_aabbNMPolyBounds;
 
 	int					m_cNMPolyEdges;
-	ENUM_NMEdgeID*		m_pNMPolyEdgeList;
+	uint32				m_iNMPolyEdgeList;
 
 	int					m_cAIRegions;
-	ENUM_AIRegionID*	m_pAIRegionList;
+	uint32				m_iAIRegionList;
 };
 
 //-----------------------------------------------------------------
@@ -396,15 +488,12 @@ protected:
 
 class CAINavMeshComponent
 {
+	friend class CAINavMesh;
 	friend class CAINavMeshGen;
 public:
 
 	CAINavMeshComponent();
 
-	// NavMesh construction.
-
-	void						FixUpNavMeshPointers( ENUM_NMComponentID* pAINavMeshComponentNeighborLists );
-
 	// Neighbor Access.
 
 	int							GetNumNMComponentNeighbors() const { return m_cNMComponentNeighbors; }
@@ -423,7 +512,7 @@ protected:
 	ENUM_NMSensoryComponentID	m_eNMSensoryComponentID;
 	
 	int							m_cNMComponentNeighbors;
-	ENUM_NMComponentID*			m_pNMComponentNeighborList;
+	uint32						m_iNMComponentNeighborList;
 };
 
 //-----------------------------------------------------------------
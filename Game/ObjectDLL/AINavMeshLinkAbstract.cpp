@@ -21,6 +21,7 @@
 #include "AIQuadTree.h"
 #include "AIAssert.h"
 #include "AIUtils.h"
+#include "AIVisibilityMgr.h"
 #include <algorithm>
 
 
@@ -388,8 +389,14 @@ void AINavMeshLinkAbstract::InitialUpdate()
 
 		if( pSmartObject->fFindFloorOffset != 0.f )
 		{
-			m_fFloorTop = FindFloor( m_vMidPtLinkEdgeA, -m_vLinkDirXZ, pSmartObject->fFindFloorOffset );
-			m_fFloorBottom = FindFloor( m_vMidPtLinkEdgeB, m_vLinkDirXZ, pSmartObject->fFindFloorOffset );
+			// Both probes are cast together as one batch.
+
+			uint32 iTopQuery = QueueFindFloor( m_vMidPtLinkEdgeA, -m_vLinkDirXZ, pSmartObject->fFindFloorOffset );
+			uint32 iBottomQuery = QueueFindFloor( m_vMidPtLinkEdgeB, m_vLinkDirXZ, pSmartObject->fFindFloorOffset );
+			g_pAIVisibilityMgr->ProcessQueuedQueries( (uint32)-1 );
+
+			m_fFloorTop = GetFoundFloor( iTopQuery, m_vMidPtLinkEdgeA );
+			m_fFloorBottom = GetFoundFloor( iBottomQuery, m_vMidPtLinkEdgeB );
 		}
 		else {
 			m_fFloorTop = m_vMidPtLinkEdgeA.y;
@@ -400,27 +407,44 @@ void AINavMeshLinkAbstract::InitialUpdate()
 
 //----------------------------------------------------------------------------
 //              
-//	ROUTINE:	AINavMeshLinkAbstract::FindFloor
+//	ROUTINE:	AINavMeshLinkAbstract::QueueFindFloor
 //              
-//	PURPOSE:	Return the height of the floor under some position.
+//	PURPOSE:	Queue a ray to find the floor under some position.
 //              
 //----------------------------------------------------------------------------
 
-float AINavMeshLinkAbstract::FindFloor( const LTVector& vPos, const LTVector& vDir, float fOffset )
+uint32 AINavMeshLinkAbstract::QueueFindFloor( const LTVector& vPos, const LTVector& vDir, float fOffset )
 {
-	IntersectQuery IQuery;
-	IntersectInfo IInfo;
+	SAIVisibilityQuery Query;
+
+	Query.m_vFrom = vPos + ( vDir * fOffset );
+	Query.m_vTo = Query.m_vFrom;
+	Query.m_vTo.y -= 10000.f;
 
-	IQuery.m_From = vPos + ( vDir * fOffset );
-	IQuery.m_To = IQuery.m_From;
-	IQuery.m_To.y -= 10000.f;
+	Query.m_dwFlags = INTERSECT_OBJECTS | IGNORE_NONSOLID | INTERSECT_HPOLY;
+	Query.m_fnObjectFilter = GroundFilterFn;
+	Query.m_eQueryClass = kAIVisQuery_Ground;
 
-	IQuery.m_Flags = INTERSECT_OBJECTS | IGNORE_NONSOLID | INTERSECT_HPOLY;
-	IQuery.m_FilterFn = GroundFilterFn;
+	return g_pAIVisibilityMgr->QueueQuery( Query );
+}
 
-	if( g_pLTServer->IntersectSegment(IQuery, &IInfo) && (IsMainWorld(IInfo.m_hObject) || (OT_WORLDMODEL == GetObjectType(IInfo.m_hObject) ) ) )
+//----------------------------------------------------------------------------
+//              
+//	ROUTINE:	AINavMeshLinkAbstract::GetFoundFloor
+//              
+//	PURPOSE:	Return the height of the floor found by a queued ray,
+//				or the height of the position if no floor was found.
+//              
+//----------------------------------------------------------------------------
+
+float AINavMeshLinkAbstract::GetFoundFloor( uint32 iQuery, const LTVector& vPos )
+{
+	SAIVisibilityResult Result;
+	if( g_pAIVisibilityMgr->GetQueuedResult( iQuery, &Result )
+		&& Result.m_bIntersected
+		&& (IsMainWorld(Result.m_hObject) || (OT_WORLDMODEL == GetObjectType(Result.m_hObject) ) ) )
 	{
-		return IInfo.m_Point.y;
+		return Result.m_vPoint.y;
 	}
 
 	return vPos.y;
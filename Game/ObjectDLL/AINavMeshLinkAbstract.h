@@ -141,7 +141,8 @@ protected:
 	// Setup.
 
 	CAINavMeshEdge*					FindMatchingPolyEdge( const LTVector& v0, const LTVector& v1 );
-	float							FindFloor( const LTVector& vPos, const LTVector& vDir, float fOffset );
+	uint32							QueueFindFloor( const LTVector& vPos, const LTVector& vDir, float fOffset );
+	float							GetFoundFloor( uint32 iQuery, const LTVector& vPos );
 
 	// Pathfinding.
 
@@ -14,6 +14,7 @@
 #include "AINavMeshLinkFlyThru.h"
 #include "AINavMesh.h"
 #include "FxDefs.h"
+#include "AIVisibilityMgr.h"
 
 
 // WorldEdit
@@ -207,34 +208,35 @@ void AINavMeshLinkFlyThru::CreateFlyThruFX( CAI* pAI, float fDirMult, const char
 
 	// Intersect the wall we are flying thru.
 
-	IntersectQuery IQuery;
-	IntersectInfo IInfo;
+	SAIVisibilityQuery Query;
+	SAIVisibilityResult Result;
 
-	IQuery.m_From = pAI->GetPosition() + fDirMult * ( pAI->GetForwardVector() * pAI->GetRadius() );
-	IQuery.m_To = pAI->GetPosition() - fDirMult * ( pAI->GetForwardVector() * pAI->GetRadius() );
+	Query.m_vFrom = pAI->GetPosition() + fDirMult * ( pAI->GetForwardVector() * pAI->GetRadius() );
+	Query.m_vTo = pAI->GetPosition() - fDirMult * ( pAI->GetForwardVector() * pAI->GetRadius() );
 
-	IQuery.m_Flags = INTERSECT_OBJECTS | IGNORE_NONSOLID | INTERSECT_HPOLY;
-	IQuery.m_FilterFn = GroundFilterFn;
+	Query.m_dwFlags = INTERSECT_OBJECTS | IGNORE_NONSOLID | INTERSECT_HPOLY;
+	Query.m_fnObjectFilter = GroundFilterFn;
+	Query.m_eQueryClass = kAIVisQuery_Ground;
 
 	// No intersection.
 
-	if( !g_pLTServer->IntersectSegment(IQuery, &IInfo) )
+	if( !g_pAIVisibilityMgr->IntersectSegment(Query, &Result) )
 	{
 		return;
 	}
 
 	// Not intersecting a wall.
 
-	if( !( IsMainWorld(IInfo.m_hObject) || 
-		 ( OT_WORLDMODEL == GetObjectType(IInfo.m_hObject) ) ) )
+	if( !( IsMainWorld(Result.m_hObject) || 
+		 ( OT_WORLDMODEL == GetObjectType(Result.m_hObject) ) ) )
 	{
 		return;
 	}
 
 	// Found an intersection.
 
-	LTVector vPos = IInfo.m_Point + ( IInfo.m_Plane.m_Normal * 1.f );
-	LTRotation rRot( IInfo.m_Plane.m_Normal, LTVector( 0.f, 1.f, 0.f ) );
+	LTVector vPos = Result.m_vPoint + ( Result.m_vNormal * 1.f );
+	LTRotation rRot( Result.m_vNormal, LTVector( 0.f, 1.f, 0.f ) );
 
 	CAutoMessage cMsg;
 	cMsg.Writeuint8( SFX_CLIENTFXGROUPINSTANT );
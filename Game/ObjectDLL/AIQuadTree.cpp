@@ -14,6 +14,15 @@
 #include "AIQuadTree.h"
 #include "AINavMesh.h"
 #include "AINavMeshLinkAbstract.h"
+#include "AIUtils.h"
+#include <algorithm>
+
+// The edge planes are tested four at a time with SSE where it is available.
+
+#if defined( PLATFORM_WIN32 ) || ( defined( PLATFORM_LINUX ) && defined( __SSE__ ) )
+	#define AIQT_USE_SSE
+	#include <xmmintrin.h>
+#endif
 
 
 // Globals
@@ -42,10 +51,10 @@ CAIQuadTreeNode::CAIQuadTreeNode()
 
 	for( int iNode=0; iNode < 4; ++iNode )
 	{
-		m_pQTNodeChild[iNode] = NULL;
+		m_eQTNodeChild[iNode] = kQTNode_Invalid;
 	}
 
-	m_pNMPolyList = NULL;
+	m_iNMPolyList = 0;
 	m_cNMPolyListSize = 0;
 }
 
@@ -53,45 +62,6 @@ CAIQuadTreeNode::~CAIQuadTreeNode()
 {
 }
 
-//----------------------------------------------------------------------------
-//              
-//	ROUTINE:	CAIQuadTreeNode::FixUpNavMeshPointers
-//              
-//	PURPOSE:	Fix-up pointers from raw NavMesh data.
-//              
-//----------------------------------------------------------------------------
-
-void CAIQuadTreeNode::FixUpNavMeshPointers( CAIQuadTreeNode* pAIQuadTreeNodes, ENUM_NMPolyID* pAIQuadTreeNMPolyLists )
-{
-	// Sanity check.
-
-	if( !( pAIQuadTreeNodes && pAIQuadTreeNMPolyLists ) )
-	{
-		return;
-	}
-
-	// Convert poly list index into pointer.
-
-	uint32 iPolyList = (uint32)m_pNMPolyList;
-	m_pNMPolyList = pAIQuadTreeNMPolyLists + iPolyList;
-
-	// Convert child IDs into pointers.
-
-	ENUM_QTNodeID eQTNodeID;
-	for( uint32 iChild=0; iChild < 4; ++iChild )
-	{
-		eQTNodeID = (ENUM_QTNodeID)(uint32)m_pQTNodeChild[iChild];
-		if( eQTNodeID == kQTNode_Invalid )
-		{
-			m_pQTNodeChild[iChild] = NULL;
-		}
-		else 
-		{
-			m_pQTNodeChild[iChild] = &( pAIQuadTreeNodes[eQTNodeID] );
-		}
-	}
-}
-
 //----------------------------------------------------------------------------
 //              
 //	ROUTINE:	CAIQuadTreeNode::GetContainingNMPoly
@@ -111,12 +81,19 @@ ENUM_NMPolyID CAIQuadTreeNode::GetContainingNMPoly( const LTVector& vPos, uint32
 
 	// Recurse to check children for containment.
 
-	if( m_pQTNodeChild[0] )
+	if( m_eQTNodeChild[0] != kQTNode_Invalid )
 	{
 		ENUM_NMPolyID eNMPoly;
+		CAIQuadTreeNode* pQTNodeChild;
 		for( int iNode=0; iNode < 4; ++iNode )
 		{
-			eNMPoly = m_pQTNodeChild[iNode]->GetContainingNMPoly( vPos, dwCharTypeMask );
+			pQTNodeChild = g_pAIQuadTree->GetQTNode( m_eQTNodeChild[iNode] );
+			if( !pQTNodeChild )
+			{
+				continue;
+			}
+
+			eNMPoly = pQTNodeChild->GetContainingNMPoly( vPos, dwCharTypeMask, pAI );
 			if( eNMPoly != kNMPoly_Invalid )
 			{
 				return eNMPoly;
@@ -126,7 +103,7 @@ ENUM_NMPolyID CAIQuadTreeNode::GetContainingNMPoly( const LTVector& vPos, uint32
 
 	// This leaf contains no NavMesh polys.
 
-	if( !m_pNMPolyList )
+	if( !m_cNMPolyListSize )
 	{
 		return kNMPoly_Invalid;
 	}
@@ -141,11 +118,12 @@ ENUM_NMPolyID CAIQuadTreeNode::GetContainingNMPoly( const LTVector& vPos, uint32
 	// or the lowest poly above the point.
 
 	CAINavMeshPoly* pPoly;
+	const ENUM_NMPolyID* pNMPolyList = g_pAIQuadTree->GetQTNMPolyList( m_iNMPolyList );
 	for( int iPoly=0; iPoly < m_cNMPolyListSize; ++iPoly )
 	{
 		// Skip poly if it does not exist in NavMesh.
 
-		pPoly = g_pAINavMesh->GetNMPoly( m_pNMPolyList[iPoly] );
+		pPoly = g_pAINavMesh->GetNMPoly( pNMPolyList[iPoly] );
 		if( !pPoly )
 		{
 			continue;
@@ -196,11 +174,13 @@ void CAIQuadTreeNode::PrintQTNodes()
 {
 	TRACE( "QTNode: %d\n", m_eQTNodeID );
 
-	if( m_pQTNodeChild[0] )
+	CAIQuadTreeNode* pQTNodeChild;
+	for( int iNode=0; iNode < 4; ++iNode )
 	{
-		for( int iNode=0; iNode < 4; ++iNode )
+		pQTNodeChild = g_pAIQuadTree->GetQTNode( m_eQTNodeChild[iNode] );
+		if( pQTNodeChild )
 		{
-			m_pQTNodeChild[iNode]->PrintQTNodes();
+			pQTNodeChild->PrintQTNodes();
 		}
 	}
 }
@@ -225,8 +205,17 @@ CAIQuadTree::CAIQuadTree()
 	g_pAIQuadTree = this;
 
 	m_pQTNodeRoot = NULL;
+	m_pQTNodes = NULL;
+	m_cQTNodes = 0;
+	m_pQTNMPolyLists = NULL;
 
 	m_bQTInitialized = false;
+
+	m_bCellGridInitialized = false;
+	m_fCellSize = 0.f;
+	m_fInvCellSize = 0.f;
+	m_cCellsX = 0;
+	m_cCellsZ = 0;
 }
 
 CAIQuadTree::~CAIQuadTree()
@@ -247,6 +236,8 @@ CAIQuadTree::~CAIQuadTree()
 void CAIQuadTree::InitQuadTree()
 {
 	m_bQTInitialized = true;
+
+	InitCellGrid();
 }
 
 //----------------------------------------------------------------------------
@@ -260,6 +251,32 @@ void CAIQuadTree::InitQuadTree()
 void CAIQuadTree::TermQuadTree()
 {
 	m_bQTInitialized = false;
+
+	TermCellGrid();
+}
+
+//----------------------------------------------------------------------------
+//              
+//	ROUTINE:	CAIQuadTree::SetQuadTreeNodes()
+//              
+//	PURPOSE:	Set the packed quad tree nodes and poly lists.
+//				The first node is the root.
+//              
+//----------------------------------------------------------------------------
+
+void CAIQuadTree::SetQuadTreeNodes( CAIQuadTreeNode* pQTNodes, uint32 cQTNodes, const ENUM_NMPolyID* pQTNMPolyLists )
+{
+	if( !( pQTNodes && cQTNodes ) )
+	{
+		pQTNodes = NULL;
+		cQTNodes = 0;
+	}
+
+	m_pQTNodes = pQTNodes;
+	m_cQTNodes = cQTNodes;
+	m_pQTNMPolyLists = pQTNMPolyLists;
+
+	m_pQTNodeRoot = pQTNodes;
 }
 
 //----------------------------------------------------------------------------
@@ -290,7 +307,7 @@ ENUM_NMPolyID CAIQuadTree::GetContainingNMPoly( const LTVector& vPos, uint32 dwC
   		// The hint poly still contains the point.
   
   		if( ( pPoly->GetNMCharTypeMask() & dwCharTypeMask ) &&
-			pPoly->ContainsPoint2D( vPos ) && 
+			NMPolyContainsPoint2D( pPoly, vPos ) && 
 			CanTraverseLink(*pPoly, pAI) )
   		{
 			return ePolyHint;
@@ -305,7 +322,7 @@ ENUM_NMPolyID CAIQuadTree::GetContainingNMPoly( const LTVector& vPos, uint32 dwC
   			pNeighbor = pPoly->GetNMPolyNeighborAtEdge( iNeighbor );
   			if( pNeighbor && 
 				( pNeighbor->GetNMCharTypeMask() & dwCharTypeMask ) &&
-				pNeighbor->ContainsPoint2D( vPos ) &&
+				NMPolyContainsPoint2D( pNeighbor, vPos ) &&
 				CanTraverseLink(*pNeighbor, pAI) )
   			{
   				return pNeighbor->GetNMPolyID();
@@ -313,6 +330,13 @@ ENUM_NMPolyID CAIQuadTree::GetContainingNMPoly( const LTVector& vPos, uint32 dwC
   		}
   	}
 
+	// Search the cell grid for the containing poly.
+
+	if( m_bCellGridInitialized )
+	{
+		return GetContainingNMPolyFromCellGrid( vPos, dwCharTypeMask, pAI );
+	}
+
 	// Search the quad tree for the containing poly.
 
 	if( m_pQTNodeRoot )
@@ -350,3 +374,468 @@ bool CAIQuadTree::CanTraverseLink( const CAINavMeshPoly& poly, CAI* pAI )
 
 	return true;
 }
+
+//----------------------------------------------------------------------------
+
+// Sorts poly IDs by descending height.
+
+struct SAIQT_POLY_HEIGHT_GREATER
+{
+	SAIQT_POLY_HEIGHT_GREATER( const AIQT_POLY_BOUNDS_LIST& lstPolyBounds ) : m_plstPolyBounds( &lstPolyBounds ) {}
+
+	bool operator()( ENUM_NMPolyID ePolyA, ENUM_NMPolyID ePolyB ) const
+	{
+		return ( *m_plstPolyBounds )[ePolyA].fMinY > ( *m_plstPolyBounds )[ePolyB].fMinY;
+	}
+
+	const AIQT_POLY_BOUNDS_LIST* m_plstPolyBounds;
+};
+
+// Returns the cell along one axis containing the position.
+
+static inline uint32 GetAIQTCell( float fPos, float fGridMin, float fInvCellSize, uint32 cCells )
+{
+	float fCell = ( fPos - fGridMin ) * fInvCellSize;
+	if( fCell <= 0.f )
+	{
+		return 0;
+	}
+
+	uint32 iCell = (uint32)fCell;
+	return ( iCell < cCells ) ? iCell : cCells - 1;
+}
+
+//----------------------------------------------------------------------------
+//              
+//	ROUTINE:	CAIQuadTree::InitCellGrid
+//              
+//	PURPOSE:	Pack the poly edges and build the cell grid.
+//              
+//----------------------------------------------------------------------------
+
+void CAIQuadTree::InitCellGrid()
+{
+	TermCellGrid();
+
+	// Sanity check.
+
+	if( !( m_pQTNodeRoot && g_pAINavMesh ) )
+	{
+		return;
+	}
+
+	int cPolys = g_pAINavMesh->GetNumNMPolys();
+	if( cPolys <= 0 )
+	{
+		return;
+	}
+
+	//
+	// Pack the bounds and edge planes of every poly.
+	//
+
+	m_lstPolyBounds.resize( cPolys );
+
+	CAINavMeshPoly* pPoly;
+	CAINavMeshEdge* pEdge;
+	LTVector vEdgeN;
+	for( int iPoly=0; iPoly < cPolys; ++iPoly )
+	{
+		SAIQT_POLY_BOUNDS& Bounds = m_lstPolyBounds[iPoly];
+		Bounds.fMinX = 0.f;
+		Bounds.fMinZ = 0.f;
+		Bounds.fMaxX = 0.f;
+		Bounds.fMaxZ = 0.f;
+		Bounds.fMinY = 0.f;
+		Bounds.iEdgePlanes = m_lstEdgePlanes.size();
+		Bounds.cEdgePlanes = 0;
+		Bounds.bContainsNothing = true;
+
+		pPoly = g_pAINavMesh->GetNMPoly( (ENUM_NMPolyID)iPoly );
+		if( !pPoly )
+		{
+			continue;
+		}
+
+		const SAABB* pAABB = pPoly->GetNMPolyAABB();
+		Bounds.fMinX = pAABB->vMin.x;
+		Bounds.fMinZ = pAABB->vMin.z;
+		Bounds.fMaxX = pAABB->vMax.x;
+		Bounds.fMaxZ = pAABB->vMax.z;
+		Bounds.fMinY = pAABB->vMin.y;
+		Bounds.bContainsNothing = false;
+
+		int cEdges = pPoly->GetNumNMPolyEdges();
+		for( int iEdge=0; iEdge < cEdges; ++iEdge )
+		{
+			// Start a new set of planes every four edges.
+
+			uint32 iLane = iEdge % 4;
+			if( iLane == 0 )
+			{
+				SAIQT_EDGE_PLANES Planes;
+				memset( &Planes, 0, sizeof( Planes ) );
+				m_lstEdgePlanes.push_back( Planes );
+				++Bounds.cEdgePlanes;
+			}
+
+			// A poly with an edge that has no normal for it never contains a point.
+
+			pEdge = pPoly->GetNMPolyEdge( iEdge );
+			if( !( pEdge && pEdge->GetNMEdgeN( pPoly->GetNMPolyID(), &vEdgeN ) ) )
+			{
+				Bounds.bContainsNothing = true;
+				break;
+			}
+
+			SAIQT_EDGE_PLANES& Planes = m_lstEdgePlanes.back();
+			Planes.fMidX[iLane] = pEdge->GetNMEdgeMidPt().x;
+			Planes.fMidZ[iLane] = pEdge->GetNMEdgeMidPt().z;
+			Planes.fNX[iLane] = vEdgeN.x;
+			Planes.fNZ[iLane] = vEdgeN.z;
+		}
+	}
+
+	//
+	// Size the grid to cover the quad tree, with roughly two cells per poly.
+	//
+
+	static const uint32 kcMaxCells = 256 * 256;
+	static const uint32 kcMaxCellsPerAxis = 1024;
+
+	m_aabbCellGridBounds = m_pQTNodeRoot->m_aabbQTBounds;
+
+	float fWidth = m_aabbCellGridBounds.vMax.x - m_aabbCellGridBounds.vMin.x;
+	float fDepth = m_aabbCellGridBounds.vMax.z - m_aabbCellGridBounds.vMin.z;
+	float fTargetCells = (float)LTMIN( (uint32)cPolys * 2, kcMaxCells );
+
+	m_fCellSize = (float)sqrt( ( fWidth * fDepth ) / fTargetCells );
+	if( m_fCellSize <= 0.f )
+	{
+		m_fCellSize = LTMAX( LTMAX( fWidth, fDepth ), 1.f );
+	}
+	m_fInvCellSize = 1.f / m_fCellSize;
+
+	m_cCellsX = LTCLAMP( (uint32)ceil( fWidth * m_fInvCellSize ), 1, kcMaxCellsPerAxis );
+	m_cCellsZ = LTCLAMP( (uint32)ceil( fDepth * m_fInvCellSize ), 1, kcMaxCellsPerAxis );
+
+	//
+	// Count the polys overlapping each cell, then fill in the cell lists.
+	//
+
+	uint32 cCells = m_cCellsX * m_cCellsZ;
+	m_lstCellStart.resize( cCells + 1, 0 );
+
+	uint32 iCellX, iCellZ;
+	for( int iPass=0; iPass < 2; ++iPass )
+	{
+		for( int iPoly=0; iPoly < cPolys; ++iPoly )
+		{
+			const SAIQT_POLY_BOUNDS& Bounds = m_lstPolyBounds[iPoly];
+			if( Bounds.bContainsNothing )
+			{
+				continue;
+			}
+
+			uint32 iMinX = GetAIQTCell( Bounds.fMinX, m_aabbCellGridBounds.vMin.x, m_fInvCellSize, m_cCellsX );
+			uint32 iMaxX = GetAIQTCell( Bounds.fMaxX, m_aabbCellGridBounds.vMin.x, m_fInvCellSize, m_cCellsX );
+			uint32 iMinZ = GetAIQTCell( Bounds.fMinZ, m_aabbCellGridBounds.vMin.z, m_fInvCellSize, m_cCellsZ );
+			uint32 iMaxZ = GetAIQTCell( Bounds.fMaxZ, m_aabbCellGridBounds.vMin.z, m_fInvCellSize, m_cCellsZ );
+
+			for( iCellZ = iMinZ; iCellZ <= iMaxZ; ++iCellZ )
+			{
+				for( iCellX = iMinX; iCellX <= iMaxX; ++iCellX )
+				{
+					uint32 iCell = iCellZ * m_cCellsX + iCellX;
+
+					// First pass counts, second pass fills from the end of each cell.
+
+					if( iPass == 0 )
+					{
+						++m_lstCellStart[iCell + 1];
+					}
+					else
+					{
+						m_lstCellPolys[--m_lstCellStart[iCell + 1]] = (ENUM_NMPolyID)iPoly;
+					}
+				}
+			}
+		}
+
+		// Convert the counts into the end of each cell.
+
+		if( iPass == 0 )
+		{
+			for( uint32 iCell=0; iCell < cCells; ++iCell )
+			{
+				m_lstCellStart[iCell + 1] += m_lstCellStart[iCell];
+			}
+			m_lstCellPolys.resize( m_lstCellStart[cCells] );
+		}
+	}
+
+	// Filling from the end leaves each cell's entry pointing at the start of
+	// the next cell, so shift them into place.
+
+	for( uint32 iCell=0; iCell < cCells; ++iCell )
+	{
+		m_lstCellStart[iCell] = m_lstCellStart[iCell + 1];
+	}
+	m_lstCellStart[cCells] = m_lstCellPolys.size();
+
+	// Sort each cell's polys in descending height, as the quad tree leaves are.
+
+	SAIQT_POLY_HEIGHT_GREATER HeightGreater( m_lstPolyBounds );
+	for( uint32 iCell=0; iCell < cCells; ++iCell )
+	{
+		std::stable_sort( m_lstCellPolys.begin() + m_lstCellStart[iCell], 
+						  m_lstCellPolys.begin() + m_lstCellStart[iCell + 1],
+						  HeightGreater );
+	}
+
+	m_bCellGridInitialized = true;
+}
+
+//----------------------------------------------------------------------------
+//              
+//	ROUTINE:	CAIQuadTree::TermCellGrid
+//              
+//	PURPOSE:	Free the cell grid.
+//              
+//----------------------------------------------------------------------------
+
+void CAIQuadTree::TermCellGrid()
+{
+	m_bCellGridInitialized = false;
+	m_cCellsX = 0;
+	m_cCellsZ = 0;
+
+	AIQT_CELL_INDEX_LIST().swap( m_lstCellStart );
+	AIQT_CELL_POLY_LIST().swap( m_lstCellPolys );
+	AIQT_POLY_BOUNDS_LIST().swap( m_lstPolyBounds );
+	AIQT_EDGE_PLANES_LIST().swap( m_lstEdgePlanes );
+}
+
+//----------------------------------------------------------------------------
+//              
+//	ROUTINE:	CAIQuadTree::GetContainingNMPolyFromCellGrid
+//              
+//	PURPOSE:	Find the NavMesh poly that contains the specified point, 
+//              using the same rules as CAIQuadTreeNode::GetContainingNMPoly.
+//              
+//----------------------------------------------------------------------------
+
+ENUM_NMPolyID CAIQuadTree::GetContainingNMPolyFromCellGrid( const LTVector& vPos, uint32 dwCharTypeMask, CAI* pAI )
+{
+	// The point is not within the NavMesh.
+
+	if( !m_aabbCellGridBounds.IntersectPoint( vPos ) )
+	{
+		return kNMPoly_Invalid;
+	}
+
+	uint32 iCellX = GetAIQTCell( vPos.x, m_aabbCellGridBounds.vMin.x, m_fInvCellSize, m_cCellsX );
+	uint32 iCellZ = GetAIQTCell( vPos.z, m_aabbCellGridBounds.vMin.z, m_fInvCellSize, m_cCellsZ );
+	uint32 iCell = iCellZ * m_cCellsX + iCellX;
+
+	// Polys are sorted in decending height, so this will
+	// drill down and find the first poly that the point is above,
+	// or the lowest poly above the point.
+
+	ENUM_NMPolyID eBestPoly = kNMPoly_Invalid;
+
+	CAINavMeshPoly* pPoly;
+	uint32 iEnd = m_lstCellStart[iCell + 1];
+	for( uint32 iPoly = m_lstCellStart[iCell]; iPoly < iEnd; ++iPoly )
+	{
+		pPoly = g_pAINavMesh->GetNMPoly( m_lstCellPolys[iPoly] );
+		if( !pPoly )
+		{
+			continue;
+		}
+
+		// Skip poly if it does not have the requested character type flags.
+
+		if( !( pPoly->GetNMCharTypeMask() & dwCharTypeMask ) )
+		{
+			continue;
+		}
+
+		// Skip poly if it's associated with a link the AI can't traverse.
+
+		if( !CanTraverseLink( *pPoly, pAI ) )
+		{
+			continue;
+		}
+
+		// Determine if poly contains the point.
+
+		if( NMPolyContainsPoint2D( pPoly, vPos ) )
+		{
+			eBestPoly = pPoly->GetNMPolyID();
+
+			if( m_lstPolyBounds[eBestPoly].fMinY < vPos.y )
+			{
+				break;
+			}
+		}
+	}
+
+	return eBestPoly;
+}
+
+//----------------------------------------------------------------------------
+//              
+//	ROUTINE:	CAIQuadTree::NMPolyContainsPoint2D
+//              
+//	PURPOSE:	Returns true if poly contains point.  Equivalent to 
+//              CAINavMeshPoly::ContainsPoint2D, using the packed edges.
+//              
+//----------------------------------------------------------------------------
+
+bool CAIQuadTree::NMPolyContainsPoint2D( CAINavMeshPoly* pPoly, const LTVector& vPos )
+{
+	ENUM_NMPolyID ePoly = pPoly->GetNMPolyID();
+	if( !m_bCellGridInitialized || ( (uint32)ePoly >= m_lstPolyBounds.size() ) )
+	{
+		return pPoly->ContainsPoint2D( vPos );
+	}
+
+	const SAIQT_POLY_BOUNDS& Bounds = m_lstPolyBounds[ePoly];
+
+	// First test the pos against the poly's bounding box.
+
+	if( ( Bounds.fMinX > vPos.x ) ||
+		( Bounds.fMaxX < vPos.x ) ||
+		( Bounds.fMinZ > vPos.z ) ||
+		( Bounds.fMaxZ < vPos.z ) )
+	{
+		return false;
+	}
+
+	if( Bounds.bContainsNothing )
+	{
+		return false;
+	}
+
+	if( Bounds.cEdgePlanes == 0 )
+	{
+		return true;
+	}
+
+	// Determine if point is on the outside of any
+	// of the poly's edges.
+
+	static const float kfEpsilon = 0.01f;
+	const SAIQT_EDGE_PLANES* pPlanes = &( m_lstEdgePlanes[Bounds.iEdgePlanes] );
+
+#if defined( AIQT_USE_SSE )
+
+	__m128 vPosX = _mm_set1_ps( vPos.x );
+	__m128 vPosZ = _mm_set1_ps( vPos.z );
+	__m128 vEpsilon = _mm_set1_ps( kfEpsilon );
+
+	for( uint32 iPlanes=0; iPlanes < Bounds.cEdgePlanes; ++iPlanes, ++pPlanes )
+	{
+		__m128 vDist = _mm_add_ps( 
+			_mm_mul_ps( _mm_loadu_ps( pPlanes->fNX ), _mm_sub_ps( _mm_loadu_ps( pPlanes->fMidX ), vPosX ) ),
+			_mm_mul_ps( _mm_loadu_ps( pPlanes->fNZ ), _mm_sub_ps( _mm_loadu_ps( pPlanes->fMidZ ), vPosZ ) ) );
+
+		if( _mm_movemask_ps( _mm_cmpgt_ps( vDist, vEpsilon ) ) )
+		{
+			return false;
+		}
+	}
+
+#else
+
+	for( uint32 iPlanes=0; iPlanes < Bounds.cEdgePlanes; ++iPlanes, ++pPlanes )
+	{
+		for( int iLane=0; iLane < 4; ++iLane )
+		{
+			float fDist = pPlanes->fNX[iLane] * ( pPlanes->fMidX[iLane] - vPos.x ) + 
+						  pPlanes->fNZ[iLane] * ( pPlanes->fMidZ[iLane] - vPos.z );
+			if( fDist > kfEpsilon )
+			{
+				return false;
+			}
+		}
+	}
+
+#endif
+
+	return true;
+}
+
+// Returns a pseudo random number in [0, 1) and advances the seed.
+
+static inline float GetAIQTRandomUnit( uint32& nSeed )
+{
+	nSeed = nSeed * 1664525 + 1013904223;
+	return (float)( nSeed >> 8 ) / 16777216.f;
+}
+
+//----------------------------------------------------------------------------
+//              
+//	ROUTINE:	CAIQuadTree::Verify
+//              
+//	PURPOSE:	Compare the cell grid against the quad tree at random 
+//              points over the NavMesh, and warn if they disagree.
+//              
+//----------------------------------------------------------------------------
+
+void CAIQuadTree::Verify()
+{
+	if( !( m_bCellGridInitialized && m_pQTNodeRoot ) )
+	{
+		return;
+	}
+
+	// Use a private generator so the game's random sequence is unaffected.
+
+	uint32 nSeed = 0x2b1d5f37;
+
+	static const int kcSamples = 4096;
+
+	int cPolys = g_pAINavMesh->GetNumNMPolys();
+	int cMismatches = 0;
+	LTVector vMismatch;
+
+	for( int iSample=0; iSample < kcSamples; ++iSample )
+	{
+		// Pick a point in and around a random poly's bounds.
+
+		int iPoly = (int)( GetAIQTRandomUnit( nSeed ) * cPolys ) % cPolys;
+		CAINavMeshPoly* pPoly = g_pAINavMesh->GetNMPoly( (ENUM_NMPolyID)iPoly );
+		if( !pPoly )
+		{
+			continue;
+		}
+
+		const SAABB* pAABB = pPoly->GetNMPolyAABB();
+		LTVector vMin = pAABB->vMin - LTVector( 16.f, 32.f, 16.f );
+		LTVector vMax = pAABB->vMax + LTVector( 16.f, 128.f, 16.f );
+
+		LTVector vPos;
+		vPos.x = vMin.x + ( vMax.x - vMin.x ) * GetAIQTRandomUnit( nSeed );
+		vPos.y = vMin.y + ( vMax.y - vMin.y ) * GetAIQTRandomUnit( nSeed );
+		vPos.z = vMin.z + ( vMax.z - vMin.z ) * GetAIQTRandomUnit( nSeed );
+
+		ENUM_NMPolyID eTreePoly = m_pQTNodeRoot->GetContainingNMPoly( vPos, ALL_CHAR_TYPES, NULL );
+		ENUM_NMPolyID eGridPoly = GetContainingNMPolyFromCellGrid( vPos, ALL_CHAR_TYPES, NULL );
+		if( eTreePoly != eGridPoly )
+		{
+			if( cMismatches == 0 )
+			{
+				vMismatch = vPos;
+			}
+			++cMismatches;
+		}
+	}
+
+	if( cMismatches > 0 )
+	{
+		Warn( "CAIQuadTree: Cell grid disagreed with the quad tree at %d of %d points, first at %.2f %.2f %.2f", 
+			cMismatches, kcSamples, vMismatch.x, vMismatch.y, vMismatch.z );
+	}
+}
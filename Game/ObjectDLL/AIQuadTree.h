@@ -32,16 +32,14 @@ enum ENUM_QTNodeID { kQTNode_Invalid = -1, };
 
 class CAIQuadTreeNode
 {
+friend class CAINavMesh;
 friend class CAINavMeshGenQuadTreeNode;
+friend class CAIQuadTree;
 public:
 
 	 CAIQuadTreeNode();
 	~CAIQuadTreeNode();
 
-	// Construction.
-
-	void			FixUpNavMeshPointers( CAIQuadTreeNode* pAIQuadTreeNodes, ENUM_NMPolyID* pAIQuadTreeNMPolyLists );
-
 	// Query.
 
 	ENUM_NMPolyID	GetContainingNMPoly( const LTVector& vPos, uint32 dwCharTypeMask, CAI* pAI = NULL );
@@ -52,18 +50,56 @@ public:
 
 protected:
 
+	// IMPORTANT:  This data must remain in sync with data packed from NavMeshGen.
+
 	ENUM_QTNodeID		m_eQTNodeID;
 	SAABB				m_aabbQTBounds;
 
 	int					m_cNMPolyListSize;
-	ENUM_NMPolyID*		m_pNMPolyList;
+	uint32				m_iNMPolyList;
 
-	CAIQuadTreeNode*	m_pQTNodeChild[4];
+	ENUM_QTNodeID		m_eQTNodeChild[4];
 };
 
 //-----------------------------------------------------------------
 //-----------------------------------------------------------------
 
+// 2D edge planes for up to four edges of a NavMesh poly, packed so
+// that all four can be tested at once.  A point is outside an edge when
+// N.x * ( Mid.x - Pos.x ) + N.z * ( Mid.z - Pos.z ) > epsilon, which is
+// the same test CAINavMeshPoly::ContainsPoint2D performs.  Unused lanes
+// are zero, so they never reject a point.
+
+struct SAIQT_EDGE_PLANES
+{
+	float	fMidX[4];
+	float	fMidZ[4];
+	float	fNX[4];
+	float	fNZ[4];
+};
+
+// Bounds and edge planes of a NavMesh poly, indexed by poly ID.
+
+struct SAIQT_POLY_BOUNDS
+{
+	float	fMinX;
+	float	fMinZ;
+	float	fMaxX;
+	float	fMaxZ;
+	float	fMinY;
+
+	uint32	iEdgePlanes;
+	uint32	cEdgePlanes;
+	bool	bContainsNothing;
+};
+
+typedef std::vector<SAIQT_EDGE_PLANES, LTAllocator<SAIQT_EDGE_PLANES, LT_MEM_TYPE_OBJECTSHELL> >	AIQT_EDGE_PLANES_LIST;
+typedef std::vector<SAIQT_POLY_BOUNDS, LTAllocator<SAIQT_POLY_BOUNDS, LT_MEM_TYPE_OBJECTSHELL> >	AIQT_POLY_BOUNDS_LIST;
+typedef std::vector<uint32, LTAllocator<uint32, LT_MEM_TYPE_OBJECTSHELL> >							AIQT_CELL_INDEX_LIST;
+typedef std::vector<ENUM_NMPolyID, LTAllocator<ENUM_NMPolyID, LT_MEM_TYPE_OBJECTSHELL> >			AIQT_CELL_POLY_LIST;
+
+//-----------------------------------------------------------------
+
 class CAIQuadTree
 {
 friend class CAINavMeshGen;
@@ -75,7 +111,12 @@ public:
 	void	InitQuadTree();
 	void	TermQuadTree();
 
-	void	SetQuadTreeRoot( CAIQuadTreeNode* pQTNodeRoot ) { m_pQTNodeRoot = pQTNodeRoot; }
+	void	SetQuadTreeNodes( CAIQuadTreeNode* pQTNodes, uint32 cQTNodes, const ENUM_NMPolyID* pQTNMPolyLists );
+
+	// Node access.  Nodes reference their children and polys by index.
+
+	CAIQuadTreeNode*		GetQTNode( ENUM_QTNodeID eQTNode ) { return ( (uint32)eQTNode < m_cQTNodes ) ? &( m_pQTNodes[eQTNode] ) : NULL; }
+	const ENUM_NMPolyID*	GetQTNMPolyList( uint32 iList ) const { return m_pQTNMPolyLists + iList; }
 
 	// Query.
 
@@ -83,10 +124,45 @@ public:
 	ENUM_NMPolyID	GetContainingNMPoly( const LTVector& vPos, uint32 dwCharTypeMask, ENUM_NMPolyID ePolyHint, CAI* pAI = NULL );
 	static bool		CanTraverseLink( const CAINavMeshPoly& poly, CAI* pAI );
 
+	// Debug.
+
+	void			Verify();
+
+protected:
+
+	// Cell grid.
+
+	void			InitCellGrid();
+	void			TermCellGrid();
+	ENUM_NMPolyID	GetContainingNMPolyFromCellGrid( const LTVector& vPos, uint32 dwCharTypeMask, CAI* pAI );
+	bool			NMPolyContainsPoint2D( CAINavMeshPoly* pPoly, const LTVector& vPos );
+
 protected:
 
-	bool				m_bQTInitialized;
-	CAIQuadTreeNode*	m_pQTNodeRoot;
+	bool					m_bQTInitialized;
+	CAIQuadTreeNode*		m_pQTNodeRoot;
+	CAIQuadTreeNode*		m_pQTNodes;
+	uint32					m_cQTNodes;
+	const ENUM_NMPolyID*	m_pQTNMPolyLists;
+
+	// Flat 2D grid over the NavMesh.  Each cell lists the polys whose
+	// bounds overlap it, sorted by descending height like the quad tree
+	// leaves.  Cell N's polys are m_lstCellPolys[m_lstCellStart[N]] up
+	// to m_lstCellPolys[m_lstCellStart[N+1]].
+
+	bool					m_bCellGridInitialized;
+	SAABB					m_aabbCellGridBounds;
+	float					m_fCellSize;
+	float					m_fInvCellSize;
+	uint32					m_cCellsX;
+	uint32					m_cCellsZ;
+	AIQT_CELL_INDEX_LIST	m_lstCellStart;
+	AIQT_CELL_POLY_LIST		m_lstCellPolys;
+
+	// Packed poly bounds and edge planes.
+
+	AIQT_POLY_BOUNDS_LIST	m_lstPolyBounds;
+	AIQT_EDGE_PLANES_LIST	m_lstEdgePlanes;
 };
 
 //-----------------------------------------------------------------
@@ -12,6 +12,7 @@
 #include "Stdafx.h"
 #include "AISensorFlashlight.h"
 #include "AIStimulusMgr.h"
+#include "AIVisibilityMgr.h"
 #include "ServerSoundMgr.h"
 
 DEFINE_AI_FACTORY_CLASS_SPECIFIC( Sensor, CAISensorFlashlight, kSensor_Flashlight );
@@ -383,32 +384,34 @@ return false;
 
 	// Cast a ray from the Player to the AI to see if anything obstructs the beam.
 
-	IntersectQuery IQuery;
-	IntersectInfo IInfo;
+	// The AI is the target of the ray, so nothing is filtered out.
 
-	IQuery.m_From = vPosition;
-	IQuery.m_To = m_pAI->GetPosition();
+	SAIVisibilityQuery VisQuery;
+	SAIVisibilityResult VisResult;
+
+	VisQuery.m_hFilterObject = NULL;
+	VisQuery.m_vFrom = vPosition;
+	VisQuery.m_vTo = m_pAI->GetPosition();
 
 	if ( m_pAI->CanSeeThrough() )
 	{
-		IQuery.m_Flags	  = INTERSECT_OBJECTS | IGNORE_NONSOLID | INTERSECT_HPOLY;
-		IQuery.m_FilterFn = CAI::SeeThroughFilterFn;
-		IQuery.m_PolyFilterFn = CAI::SeeThroughPolyFilterFn;
+		VisQuery.m_dwFlags	  = INTERSECT_OBJECTS | IGNORE_NONSOLID | INTERSECT_HPOLY;
+		VisQuery.m_fnObjectFilter = CAI::SeeThroughFilterFn;
+		VisQuery.m_fnPolyFilter = CAI::SeeThroughPolyFilterFn;
+		VisQuery.m_eQueryClass = kAIVisQuery_SeeThrough;
 	}
 	else 
 	{
-		IQuery.m_Flags	  = INTERSECT_OBJECTS | IGNORE_NONSOLID;
-		IQuery.m_FilterFn = CAI::DefaultFilterFn;
-		IQuery.m_PolyFilterFn = NULL;
+		VisQuery.m_dwFlags	  = INTERSECT_OBJECTS | IGNORE_NONSOLID;
+		VisQuery.m_fnObjectFilter = CAI::DefaultFilterFn;
+		VisQuery.m_fnPolyFilter = NULL;
 	}
 
-	g_cIntersectSegmentCalls++;
-
 	// Beam hits AI if the ray intersects nothing, or the AI itself.
 
-	bool bVisible = !g_pLTServer->IntersectSegment(IQuery, &IInfo);
+	bool bVisible = !g_pAIVisibilityMgr->IntersectSegment(VisQuery, &VisResult);
 	if( ( !bVisible ) && 
-		( IInfo.m_hObject == m_pAI->m_hObject ) )
+		( VisResult.m_hObject == m_pAI->m_hObject ) )
 	{
 		bVisible = true;
 	}
@@ -16,6 +16,9 @@
 #include "AIBlackBoard.h"
 #include "AIUtils.h"
 
+#include <algorithm>
+#include <functional>
+
 DEFINE_AI_FACTORY_CLASS(CAISoundRecord);
 
 
@@ -23,6 +26,13 @@ DEFINE_AI_FACTORY_CLASS(CAISoundRecord);
 
 CAISoundMgr* g_pAISoundMgr = NULL;
 
+#ifndef _FINAL
+static void AISoundReplayTestCB( int argc, char** argv );
+
+// Number of requests kept for AISoundReplayTest.
+static const uint32 kAISoundReplayEvents = 4096;
+#endif // _FINAL
+
 //
 // CAISoundRecord functions.
 //
@@ -44,6 +54,9 @@ CAISoundRecord::CAISoundRecord()
 	m_fSoundRequestTime = 0.f;	
 	m_fSoundDelayTime = 0.f;	
 	m_fSoundCompletionTime = 0.f;	
+	m_hSoundSequenceAIPrior = NULL;
+	m_eSoundSequenceTypePrior = kAIS_InvalidType;
+	m_eSoundSequenceTypeFirst = kAIS_InvalidType;
 	m_bSoundDeleted = false;
 }
 
@@ -70,12 +83,20 @@ CAISoundMgr::CAISoundMgr()
 	g_pAISoundMgr = this;
 
 	InitAISoundMgr();
+
+#ifndef _FINAL
+	g_pLTServer->RegisterConsoleProgram( "AISoundReplayTest", AISoundReplayTestCB );
+#endif // _FINAL
 }
 
 CAISoundMgr::~CAISoundMgr()
 {
 	ASSERT(g_pAISoundMgr != NULL);
 
+#ifndef _FINAL
+	g_pLTServer->UnregisterConsoleProgram( "AISoundReplayTest" );
+#endif // _FINAL
+
 	TermAISoundMgr();
 
 	g_pAISoundMgr = NULL;
@@ -104,6 +125,17 @@ void CAISoundMgr::InitAISoundMgr()
 	m_fLastCheckInTime = -DBL_MAX;
 	m_fLastDisturbanceTime = -DBL_MAX;
 	m_fLastManDownTime = -DBL_MAX;
+
+	m_fRequestedSoundsTime = -DBL_MAX;
+
+	for( uint32 iType=0; iType < kAIS_Count; ++iType )
+	{
+		m_abSuppressedSoundTypes[iType] = false;
+	}
+
+#ifndef _FINAL
+	m_iNextReplayEvent = 0;
+#endif // _FINAL
 }
 
 // ----------------------------------------------------------------------- //
@@ -152,6 +184,30 @@ void CAISoundMgr::TermAISoundMgr()
 		}
 	}
 	m_lstActiveSounds.resize( 0 );
+
+	// Clear indexes.
+
+	m_setRequestedSounds.clear();
+	m_lstActiveSoundKeys.resize( 0 );
+	m_lstFreeActiveSlots.resize( 0 );
+	m_mapActiveByCategoryTarget.clear();
+	m_mapActiveBySpeaker.clear();
+	m_mapActiveByTime.clear();
+	m_mapActiveByLastTime.clear();
+	m_lstActiveSoundTimers.resize( 0 );
+	m_lstPendingCompletionSlots.resize( 0 );
+
+	AISOUND_TYPE_LIST::iterator itType;
+	for( itType = m_lstSuppressedSoundTypes.begin(); itType != m_lstSuppressedSoundTypes.end(); ++itType )
+	{
+		m_abSuppressedSoundTypes[*itType] = false;
+	}
+	m_lstSuppressedSoundTypes.resize( 0 );
+
+#ifndef _FINAL
+	m_lstReplayEvents.resize( 0 );
+	m_iNextReplayEvent = 0;
+#endif // _FINAL
 }
 
 // ----------------------------------------------------------------------- //
@@ -171,20 +227,38 @@ void CAISoundMgr::RequestAISound( HOBJECT hAI, EnumAISoundType eSoundType, EnumA
 		return;
 	}
 
+#ifndef _FINAL
+	RecordReplayEvent( kAISndReplay_Request, hAI, eSoundType, NULL, kAIS_InvalidType, eSoundCategory, hTarget, fDelay );
+#endif // _FINAL
+
 	// Insure the sound is not a duplicate (AI emitting more than 1 damage
 	// sound a frame for instance when hit by shotgun)
-	
-	for (AISOUND_LIST::iterator it = m_lstRequestedSounds.begin(); it != m_lstRequestedSounds.end(); ++it)
+
+	double fCurTime = g_pLTServer->GetTime();
+	if( m_fRequestedSoundsTime != fCurTime )
 	{
-		CAISoundRecord* pRecord = *it;
+		m_setRequestedSounds.clear();
+		m_fRequestedSoundsTime = fCurTime;
+	}
+
+	if( !m_setRequestedSounds.insert( AISOUND_REQUEST_KEY( hAI, eSoundType ) ).second )
+	{
+		return;
+	}
+
+	// Reject sounds the frequency limits already rule out, without creating
+	// a record.  These limits only move forward as sounds play, so a sound
+	// limited now stays limited for the rest of the frame.  The request
+	// still clears conflicting sequences, as a rejected request does.
 
-		if (pRecord 
-			&& pRecord->m_fSoundRequestTime == g_pLTServer->GetTime()
-			&& pRecord->m_eSoundType == eSoundType
-			&& pRecord->m_hAI == hAI)
+	if( IsAISoundFrequencyLimited( eSoundType, eSoundCategory, fCurTime ) )
+	{
+		if( !m_abSuppressedSoundTypes[eSoundType] )
 		{
-			return;
+			m_abSuppressedSoundTypes[eSoundType] = true;
+			m_lstSuppressedSoundTypes.push_back( eSoundType );
 		}
+		return;
 	}
 
 	AITRACE( AIShowSounds, ( hAI, "Requesting AISound: %s", s_aszAISoundTypes[eSoundType] ) );
@@ -234,10 +308,31 @@ void CAISoundMgr::RequestAISound( HOBJECT hAI, EnumAISoundType eSoundType, EnumA
 void CAISoundMgr::ClearPendingAISounds( HOBJECT hAI )
 {
 	CAISoundRecord* pSoundRecord;
-	AISOUND_LIST::iterator itSound;
-	for( itSound = m_lstActiveSounds.begin(); itSound != m_lstActiveSounds.end(); ++itSound )
+
+#ifndef _FINAL
+	RecordReplayEvent( kAISndReplay_ClearPending, hAI, kAIS_InvalidType, NULL, kAIS_InvalidType, kAISndCat_Always, NULL, 0.f );
+#endif // _FINAL
+
+	// Speakers that have been removed are not indexed.
+
+	if( !hAI )
 	{
-		pSoundRecord = *itSound;
+		AISOUND_LIST::iterator itSound;
+		for( itSound = m_lstActiveSounds.begin(); itSound != m_lstActiveSounds.end(); ++itSound )
+		{
+			pSoundRecord = *itSound;
+			if( pSoundRecord && pSoundRecord->m_hAI == hAI )
+			{
+				pSoundRecord->m_bSoundDeleted = true;
+			}
+		}
+		return;
+	}
+
+	std::pair<AISOUND_SPEAKER_MAP::iterator, AISOUND_SPEAKER_MAP::iterator> itRange = m_mapActiveBySpeaker.equal_range( hAI );
+	for( AISOUND_SPEAKER_MAP::iterator itSlot = itRange.first; itSlot != itRange.second; ++itSlot )
+	{
+		pSoundRecord = m_lstActiveSounds[itSlot->second];
 		if( pSoundRecord && pSoundRecord->m_hAI == hAI )
 		{
 			pSoundRecord->m_bSoundDeleted = true;
@@ -257,6 +352,10 @@ void CAISoundMgr::RequestAISoundSequence( HOBJECT hAI, EnumAISoundType eSoundTyp
 {
 	AITRACE( AIShowSounds, ( hAI, "Requesting sequence AISound: %s", s_aszAISoundTypes[eSoundType] ) );
 
+#ifndef _FINAL
+	RecordReplayEvent( kAISndReplay_Sequence, hAI, eSoundType, hAIPrior, eSoundTypePrior, eSoundCategory, hTarget, fDelay );
+#endif // _FINAL
+
 	// Create a new record for the request.
 
 	CAISoundRecord* pSoundRecord = AI_FACTORY_NEW( CAISoundRecord );
@@ -317,6 +416,16 @@ void CAISoundMgr::RequestAISoundSequence( HOBJECT hAI, EnumAISoundType eSoundTyp
 
 void CAISoundMgr::UpdateAISoundMgr()
 {
+	// Requests rejected as they were made clear waiting sequences.
+
+	AISOUND_TYPE_LIST::iterator itType;
+	for( itType = m_lstSuppressedSoundTypes.begin(); itType != m_lstSuppressedSoundTypes.end(); ++itType )
+	{
+		ClearAISoundSequences( *itType );
+		m_abSuppressedSoundTypes[*itType] = false;
+	}
+	m_lstSuppressedSoundTypes.resize( 0 );
+
 	// Iterate over requests.
 
 	CAI* pAI;
@@ -332,7 +441,7 @@ void CAISoundMgr::UpdateAISoundMgr()
 
 		// Clear any waiting sequences.
 
-		ClearAISoundSequences( pSoundRecord );
+		ClearAISoundSequences( pSoundRecord->m_eSoundType );
 
 		// Play sound if possible.
 
@@ -361,6 +470,7 @@ void CAISoundMgr::UpdateAISoundMgr()
 	// Clear the request list.
 
 	m_lstRequestedSounds.resize( 0 );
+	m_setRequestedSounds.clear();
 
 	// Play delayed sounds, and clear expired sounds.
 
@@ -462,54 +572,98 @@ void CAISoundMgr::UpdateActiveAISounds()
 {
 	CAI* pAI;
 	CAISoundRecord* pSoundRecord;
-	AISOUND_LIST::iterator itSound;
-	for( itSound = m_lstActiveSounds.begin(); itSound != m_lstActiveSounds.end(); ++itSound )
+	uint32 iSlot;
+	double fCurTime = g_pLTServer->GetTime();
+
+	// Delete active sounds associated with a dead AI.
+
+	for( iSlot = 0; iSlot < m_lstActiveSounds.size(); ++iSlot )
 	{
-		pSoundRecord = *itSound;
-		if( !pSoundRecord )
+		pSoundRecord = m_lstActiveSounds[iSlot];
+		if( pSoundRecord && IsDeadAI( pSoundRecord->m_hAI ) )
 		{
-			continue;
+			DeleteActiveSound( iSlot );
 		}
-	
-		// Delete active sounds associated with a dead AI.
+	}
+
+	// Find delayed sounds that are due.  Timers left behind by records
+	// that have since been replaced are discarded.
+
+	static AISOUND_SLOT_LIST s_lstDueSlots;
+	s_lstDueSlots.resize( 0 );
 
-		if( IsDeadAI( pSoundRecord->m_hAI ) )
+	while( !m_lstActiveSoundTimers.empty() && m_lstActiveSoundTimers.front().m_fTime <= fCurTime )
+	{
+		SAISoundTimer Timer = m_lstActiveSoundTimers.front();
+		std::pop_heap( m_lstActiveSoundTimers.begin(), m_lstActiveSoundTimers.end() );
+		m_lstActiveSoundTimers.pop_back();
+
+		pSoundRecord = m_lstActiveSounds[Timer.m_iSlot];
+		if( pSoundRecord 
+			&& pSoundRecord->m_fSoundDelayTime > 0.f
+			&& pSoundRecord->m_fSoundDelayTime == Timer.m_fTime )
 		{
-			AI_FACTORY_DELETE( pSoundRecord );
-			*itSound = NULL;
-			continue;
+			s_lstDueSlots.push_back( Timer.m_iSlot );
 		}
+	}
+
+	// Play delayed sounds, in the order they appear in the list.
 
-		// Play delayed sound.
+	std::sort( s_lstDueSlots.begin(), s_lstDueSlots.end() );
+	s_lstDueSlots.erase( std::unique( s_lstDueSlots.begin(), s_lstDueSlots.end() ), s_lstDueSlots.end() );
 
-		if( pSoundRecord->m_fSoundDelayTime > 0.f )
+	AISOUND_SLOT_LIST::iterator itSlot;
+	for( itSlot = s_lstDueSlots.begin(); itSlot != s_lstDueSlots.end(); ++itSlot )
+	{
+		pSoundRecord = m_lstActiveSounds[*itSlot];
+		pAI = (CAI*)g_pLTServer->HandleToObject( pSoundRecord->m_hAI );
+		if( pAI && CanPlayAISound( pAI, pSoundRecord ) )
 		{
-			if( pSoundRecord->m_fSoundDelayTime <= g_pLTServer->GetTime() )
-			{
-				pAI = (CAI*)g_pLTServer->HandleToObject( pSoundRecord->m_hAI );
-				if( pAI && CanPlayAISound( pAI, pSoundRecord ) )
-				{
-					PlayActiveAISound( pSoundRecord );
-				}
-				else {
-					AI_FACTORY_DELETE( pSoundRecord );
-					*itSound = NULL;
-				}
-			}
-			continue;
+			PlayActiveAISound( pSoundRecord );
+			IndexActiveSoundLastTime( *itSlot );
+		}
+		else {
+			DeleteActiveSound( *itSlot );
 		}
+	}
 
-		// Record completion times.
+	// Record completion times.
 
-		if( pSoundRecord->m_fSoundCompletionTime == 0.f )
+	uint32 iPending = 0;
+	for( uint32 iCheck = 0; iCheck < m_lstPendingCompletionSlots.size(); ++iCheck )
+	{
+		iSlot = m_lstPendingCompletionSlots[iCheck];
+
+		pSoundRecord = m_lstActiveSounds[iSlot];
+		if( pSoundRecord 
+			&& pSoundRecord->m_fSoundDelayTime == 0.f
+			&& pSoundRecord->m_fSoundCompletionTime == 0.f )
 		{
 			pAI = (CAI*)g_pLTServer->HandleToObject( pSoundRecord->m_hAI );
 			if( pAI && !pAI->IsPlayingDialogSound() )
 			{
-				pSoundRecord->m_fSoundCompletionTime = g_pLTServer->GetTime();
+				pSoundRecord->m_fSoundCompletionTime = fCurTime;
+				IndexActiveSoundLastTime( iSlot );
+			}
+			else {
+				m_lstPendingCompletionSlots[iPending++] = iSlot;
 				continue;
 			}
 		}
+
+		m_lstActiveSoundKeys[iSlot].m_bPendingCompletion = false;
+	}
+	m_lstPendingCompletionSlots.resize( iPending );
+
+	// Sounds that just finished their delay start waiting for their
+	// speaker on the next update.
+
+	for( itSlot = s_lstDueSlots.begin(); itSlot != s_lstDueSlots.end(); ++itSlot )
+	{
+		if( m_lstActiveSounds[*itSlot] )
+		{
+			SetPendingCompletion( *itSlot );
+		}
 	}
 }
 
@@ -543,7 +697,8 @@ void CAISoundMgr::UpdateSequencedAISounds()
 			continue;
 		}
 
-		CAISoundRecord* pPriorSoundRecord = FindActiveSoundForTime( pSoundRecord->m_fSoundRequestTime );
+		int32 iPriorSlot = FindActiveSlotForTime( pSoundRecord->m_fSoundRequestTime );
+		CAISoundRecord* pPriorSoundRecord = ( iPriorSlot < 0 ) ? NULL : m_lstActiveSounds[iPriorSlot];
 		if( !pPriorSoundRecord )
 		{
 			AI_FACTORY_DELETE( pSoundRecord );
@@ -572,13 +727,17 @@ void CAISoundMgr::UpdateSequencedAISounds()
 		{
 			PlayActiveAISound( pSoundRecord );
 
+			UnindexActiveSound( iPriorSlot );
 			*pPriorSoundRecord = *pSoundRecord;
+			IndexActiveSound( iPriorSlot );
 			AI_FACTORY_DELETE( pSoundRecord );
 			*itSound = NULL;
 		}
 		else {
+			UnindexActiveSound( iPriorSlot );
 			*pPriorSoundRecord = *pSoundRecord;
 			pPriorSoundRecord->m_fSoundDelayTime += g_pLTServer->GetTime();
+			IndexActiveSound( iPriorSlot );
 			AI_FACTORY_DELETE( pSoundRecord );
 			*itSound = NULL;
 		}
@@ -593,7 +752,7 @@ void CAISoundMgr::UpdateSequencedAISounds()
 //
 // ----------------------------------------------------------------------- //
 
-void CAISoundMgr::ClearAISoundSequences( CAISoundRecord* pRequestSoundRecord )
+void CAISoundMgr::ClearAISoundSequences( EnumAISoundType eRequestSoundType )
 {
 	CAISoundRecord* pSoundRecord;
 	AISOUND_LIST::iterator itSound;
@@ -623,17 +782,17 @@ void CAISoundMgr::ClearAISoundSequences( CAISoundRecord* pRequestSoundRecord )
 			}
 		}
 
-		if( pSoundRecord->m_eSoundType == pRequestSoundRecord->m_eSoundType )
+		if( pSoundRecord->m_eSoundType == eRequestSoundType )
 		{
 			continue;
 		}
 
-		if( pSoundRecord->m_eSoundSequenceTypePrior == pRequestSoundRecord->m_eSoundType )
+		if( pSoundRecord->m_eSoundSequenceTypePrior == eRequestSoundType )
 		{
 			continue;
 		}
 
-		if( pSoundRecord->m_eSoundSequenceTypeFirst == pRequestSoundRecord->m_eSoundType )
+		if( pSoundRecord->m_eSoundSequenceTypeFirst == eRequestSoundType )
 		{
 			continue;
 		}
@@ -704,13 +863,7 @@ bool CAISoundMgr::CanPlayAISound( CAI* pAI, CAISoundRecord* pSoundRecord )
 	float fFreq;
 	if( eSoundCategory == kAISndCat_InterruptMelee )
 	{
-  		double fCurTime = g_pLTServer->GetTime();
-		fFreq = g_pAIDB->GetAIConstantsRecord()->fAISoundFrequencyMelee;
-		if( (float)(fCurTime - m_afLastEventTime[pSoundRecord->m_eSoundType]) < fFreq )
-		{
-			return false;
-		}
-		else return true;
+		return !IsAISoundFrequencyLimited( pSoundRecord->m_eSoundType, eSoundCategory, g_pLTServer->GetTime() );
 	}
 
 	// [KLS 7/2/02] - If too many AI sounds are playing, don't play the sound.
@@ -769,63 +922,89 @@ bool CAISoundMgr::CanPlayAISound( CAI* pAI, CAISoundRecord* pSoundRecord )
 			break;
 
 		case kAISndCat_Event:
-			fFreq = g_pAIDB->GetAIConstantsRecord()->fAISoundFrequencyEvent;
-			if( (float)(fCurTime - m_afLastEventTime[pSoundRecord->m_eSoundType]) < fFreq )
+		case kAISndCat_Location:
+		case kAISndCat_LimitedWarnAlly:
+		case kAISndCat_DisturbanceHeard:
+		case kAISndCat_DisturbanceSeen:
+		case kAISndCat_CheckIn:
+		case kAISndCat_ManDown:
+			if( IsAISoundFrequencyLimited( pSoundRecord->m_eSoundType, eSoundCategory, fCurTime ) )
 			{
 				return false;
 			}
 			break;
 
+		default:
+			AIASSERT( 0, NULL, "Unrecognized sound category." );
+			break;
+	}
+
+
+	// Play the sound.
+
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAISoundMgr::IsAISoundFrequencyLimited()
+//
+//	PURPOSE:	Return true if a sound of this category played too recently
+//				for another to play.  Only covers categories whose limit is
+//				measured from a time that is set to the current time when
+//				a sound plays, so a limited sound stays limited until the
+//				current time advances.
+//
+// ----------------------------------------------------------------------- //
+
+bool CAISoundMgr::IsAISoundFrequencyLimited( EnumAISoundType eSoundType, EnumAISoundCategory eSoundCategory, double fCurTime )
+{
+	float fFreq;
+	double fLastTime;
+
+	switch( eSoundCategory )
+	{
+		case kAISndCat_InterruptMelee:
+			fFreq = g_pAIDB->GetAIConstantsRecord()->fAISoundFrequencyMelee;
+			fLastTime = m_afLastEventTime[eSoundType];
+			break;
+
+		case kAISndCat_Event:
+			fFreq = g_pAIDB->GetAIConstantsRecord()->fAISoundFrequencyEvent;
+			fLastTime = m_afLastEventTime[eSoundType];
+			break;
+
 		case kAISndCat_Location:
 			fFreq = g_pAIDB->GetAIConstantsRecord()->fAISoundFrequencyLocation;
-			if( (float)(fCurTime - m_afLastEventTime[pSoundRecord->m_eSoundType]) < fFreq )
-			{
-				return false;
-			}
+			fLastTime = m_afLastEventTime[eSoundType];
 			break;
-	
+
 		case kAISndCat_LimitedWarnAlly:
 			fFreq = g_pAIDB->GetAIConstantsRecord()->fAISoundFrequencyEvent;
-			if( (float)(fCurTime - m_fLastLimitedWarnAllyTime) < fFreq )
-			{
-				return false;
-			}
+			fLastTime = m_fLastLimitedWarnAllyTime;
 			break;
 
 		case kAISndCat_DisturbanceHeard:
 		case kAISndCat_DisturbanceSeen:
 			fFreq = g_pAIDB->GetAIConstantsRecord()->fAISoundFrequencyChatter;
-			if( (float)(fCurTime - m_fLastDisturbanceTime) < fFreq )
-			{
-				return false;
-			}
+			fLastTime = m_fLastDisturbanceTime;
 			break;
 
 		case kAISndCat_CheckIn:
 			fFreq = g_pAIDB->GetAIConstantsRecord()->fAISoundFrequencyChatter;
-			if( (float)(fCurTime - m_fLastCheckInTime) < fFreq )
-			{
-				return false;
-			}
+			fLastTime = m_fLastCheckInTime;
 			break;
 
 		case kAISndCat_ManDown:
 			fFreq = g_pAIDB->GetAIConstantsRecord()->fAISoundFrequencyEvent;
-			if( (float)(fCurTime - m_fLastManDownTime) < fFreq )
-			{
-				return false;
-			}
+			fLastTime = m_fLastManDownTime;
 			break;
 
 		default:
-			AIASSERT( 0, NULL, "Unrecognized sound category." );
-			break;
+			return false;
 	}
 
-
-	// Play the sound.
-
-	return true;
+	return (float)(fCurTime - fLastTime) < fFreq;
 }
 
 // ----------------------------------------------------------------------- //
@@ -840,177 +1019,499 @@ void CAISoundMgr::RecordActiveAISound( CAISoundRecord* pSoundRecord )
 {
 	// Find an existing active sound for the same AI.
 
-	CAISoundRecord* pActiveSoundRecord;
-	AISOUND_LIST::iterator itSound;
-	for( itSound = m_lstActiveSounds.begin(); itSound != m_lstActiveSounds.end(); ++itSound )
-	{
-		pActiveSoundRecord = *itSound;
-		if( !pActiveSoundRecord )
-		{
-			continue;
-		}
-
-		if( pActiveSoundRecord->m_hAI == pSoundRecord->m_hAI )
-		{
-			*pActiveSoundRecord = *pSoundRecord;
-			AI_FACTORY_DELETE( pSoundRecord );
-			return;
-		}
-	}
-
-	// Find a NULL active sound slot.
-
-	for( itSound = m_lstActiveSounds.begin(); itSound != m_lstActiveSounds.end(); ++itSound )
+	int32 iSlot = FindActiveSlotForSpeaker( pSoundRecord->m_hAI );
+	if( iSlot >= 0 )
 	{
-		pActiveSoundRecord = *itSound;
-		if( !pActiveSoundRecord )
-		{
-			*itSound = pSoundRecord;
-			return;
-		}
+		UnindexActiveSound( iSlot );
+		*m_lstActiveSounds[iSlot] = *pSoundRecord;
+		IndexActiveSound( iSlot );
+		AI_FACTORY_DELETE( pSoundRecord );
+		return;
 	}
 
 	// Add a new active sound.
 
-	m_lstActiveSounds.push_back( pSoundRecord );
+	AddActiveSound( pSoundRecord );
 }
 
 // ----------------------------------------------------------------------- //
 //
-//	ROUTINE:	CAISoundMgr::FindActiveSound()
+//	ROUTINE:	CAISoundMgr::AddActiveSound()
 //
-//	PURPOSE:	Return an active sound with the specified sound type and target.
+//	PURPOSE:	Add a record to the first free active sound slot.
 //
 // ----------------------------------------------------------------------- //
 
-CAISoundRecord* CAISoundMgr::FindActiveSound( EnumAISoundCategory eSoundCategory, HOBJECT hTarget )
+uint32 CAISoundMgr::AddActiveSound( CAISoundRecord* pSoundRecord )
 {
-	CAISoundRecord* pSoundRecord;
-	AISOUND_LIST::iterator itSound;
-	for( itSound = m_lstActiveSounds.begin(); itSound != m_lstActiveSounds.end(); ++itSound )
+	uint32 iSlot;
+	if( !m_lstFreeActiveSlots.empty() )
 	{
-		pSoundRecord = *itSound;
-		if( !pSoundRecord )
-		{
-			continue;
-		}
+		std::pop_heap( m_lstFreeActiveSlots.begin(), m_lstFreeActiveSlots.end(), std::greater<uint32>() );
+		iSlot = m_lstFreeActiveSlots.back();
+		m_lstFreeActiveSlots.pop_back();
 
-		if( ( pSoundRecord->m_eSoundCategory == eSoundCategory ) &&
-			( pSoundRecord->m_hSoundTarget == hTarget ) )
-		{
-			return pSoundRecord;
-		}
+		m_lstActiveSounds[iSlot] = pSoundRecord;
+	}
+	else {
+		iSlot = m_lstActiveSounds.size();
+		m_lstActiveSounds.push_back( pSoundRecord );
+		m_lstActiveSoundKeys.push_back( SAISoundSlotKeys() );
 	}
 
-	return NULL;
+	IndexActiveSound( iSlot );
+
+	return iSlot;
 }
 
 // ----------------------------------------------------------------------- //
 //
-//	ROUTINE:	CAISoundMgr::FindLastActiveSoundForTarget()
+//	ROUTINE:	CAISoundMgr::DeleteActiveSound()
 //
-//	PURPOSE:	Return the most recent active sound with the specified target.
+//	PURPOSE:	Delete the record in an active sound slot.
 //
 // ----------------------------------------------------------------------- //
 
-CAISoundRecord* CAISoundMgr::FindLastActiveSoundForTarget( HOBJECT hTarget )
+void CAISoundMgr::DeleteActiveSound( uint32 iSlot )
 {
-	if( !hTarget )
+	CAISoundRecord* pSoundRecord = m_lstActiveSounds[iSlot];
+	if( !pSoundRecord )
 	{
-////		return NULL;
+		return;
 	}
 
-	double fTime = 0.f;
-
-	CAISoundRecord* pLastSoundRecord = NULL;
-	CAISoundRecord* pSoundRecord;
-	AISOUND_LIST::iterator itSound;
-	for( itSound = m_lstActiveSounds.begin(); itSound != m_lstActiveSounds.end(); ++itSound )
-	{
-		pSoundRecord = *itSound;
-		if( !pSoundRecord )
-		{
-			continue;
-		}
-
-		if( pSoundRecord->m_hSoundTarget != hTarget )
-		{
-////			continue;
-		}
-
-		// Ignore delayed sounds.
-
-		if( pSoundRecord->m_fSoundDelayTime > 0.f )
-		{
-			continue;
-		}
-
-		if( fTime < pSoundRecord->m_fSoundCompletionTime )
-		{
-			fTime = pSoundRecord->m_fSoundCompletionTime;
-			pLastSoundRecord = pSoundRecord;
-		}
+	UnindexActiveSound( iSlot );
 
-		else if( fTime < pSoundRecord->m_fSoundRequestTime )
-		{
-			fTime = pSoundRecord->m_fSoundRequestTime;
-			pLastSoundRecord = pSoundRecord;
-		}
-	}
+	AI_FACTORY_DELETE( pSoundRecord );
+	m_lstActiveSounds[iSlot] = NULL;
 
-	return pLastSoundRecord;
+	m_lstFreeActiveSlots.push_back( iSlot );
+	std::push_heap( m_lstFreeActiveSlots.begin(), m_lstFreeActiveSlots.end(), std::greater<uint32>() );
 }
 
 // ----------------------------------------------------------------------- //
 //
-//	ROUTINE:	CAISoundMgr::FindActiveSoundForSpeaker()
+//	ROUTINE:	CAISoundMgr::IndexActiveSound()
 //
-//	PURPOSE:	Return an active sound with the specified speaker.
+//	PURPOSE:	Add an active sound slot to the indexes, keyed by the
+//				current contents of its record.
 //
 // ----------------------------------------------------------------------- //
 
-CAISoundRecord* CAISoundMgr::FindActiveSoundForSpeaker( HOBJECT hSpeaker )
+void CAISoundMgr::IndexActiveSound( uint32 iSlot )
 {
-	CAISoundRecord* pSoundRecord;
-	AISOUND_LIST::iterator itSound;
-	for( itSound = m_lstActiveSounds.begin(); itSound != m_lstActiveSounds.end(); ++itSound )
-	{
-		pSoundRecord = *itSound;
-		if( !pSoundRecord )
-		{
-			continue;
-		}
+	CAISoundRecord* pSoundRecord = m_lstActiveSounds[iSlot];
+	SAISoundSlotKeys& Keys = m_lstActiveSoundKeys[iSlot];
 
-		if( pSoundRecord->m_hAI == hSpeaker )
-		{
-			return pSoundRecord;
-		}
+	AIASSERT( !Keys.m_bIndexed, pSoundRecord->m_hAI, "CAISoundMgr::IndexActiveSound: Slot is already indexed." );
+
+	Keys.m_bIndexed = true;
+	Keys.m_hAI = pSoundRecord->m_hAI;
+	Keys.m_eSoundCategory = pSoundRecord->m_eSoundCategory;
+	Keys.m_hSoundTarget = pSoundRecord->m_hSoundTarget;
+	Keys.m_fSoundRequestTime = pSoundRecord->m_fSoundRequestTime;
+
+	m_mapActiveByCategoryTarget.insert( AISOUND_CATEGORY_TARGET_MAP::value_type( AISOUND_CATEGORY_TARGET( Keys.m_eSoundCategory, Keys.m_hSoundTarget ), iSlot ) );
+	m_mapActiveBySpeaker.insert( AISOUND_SPEAKER_MAP::value_type( Keys.m_hAI, iSlot ) );
+	m_mapActiveByTime.insert( AISOUND_TIME_MAP::value_type( Keys.m_fSoundRequestTime, iSlot ) );
+
+	// Delayed sounds wait on a timer, others wait for the speaker to finish.
+
+	if( pSoundRecord->m_fSoundDelayTime > 0.f )
+	{
+		SAISoundTimer Timer;
+		Timer.m_fTime = pSoundRecord->m_fSoundDelayTime;
+		Timer.m_iSlot = iSlot;
+		m_lstActiveSoundTimers.push_back( Timer );
+		std::push_heap( m_lstActiveSoundTimers.begin(), m_lstActiveSoundTimers.end() );
+	}
+	else if( pSoundRecord->m_fSoundCompletionTime == 0.f )
+	{
+		SetPendingCompletion( iSlot );
 	}
 
-	return NULL;
+	IndexActiveSoundLastTime( iSlot );
 }
 
 // ----------------------------------------------------------------------- //
 //
-//	ROUTINE:	CAISoundMgr::FindActiveSoundForTime()
+//	ROUTINE:	CAISoundMgr::UnindexActiveSound()
 //
-//	PURPOSE:	Return an active sound with the specified request time.
+//	PURPOSE:	Remove an active sound slot from the indexes.
 //
 // ----------------------------------------------------------------------- //
 
-CAISoundRecord* CAISoundMgr::FindActiveSoundForTime( double fTime )
+template< typename TMap >
+static void EraseAISoundSlot( TMap& mapIndex, const typename TMap::key_type& Key, uint32 iSlot )
 {
+	std::pair<typename TMap::iterator, typename TMap::iterator> itRange = mapIndex.equal_range( Key );
+	for( typename TMap::iterator itSlot = itRange.first; itSlot != itRange.second; ++itSlot )
+	{
+		if( itSlot->second == iSlot )
+		{
+			mapIndex.erase( itSlot );
+			return;
+		}
+	}
+}
+
+void CAISoundMgr::UnindexActiveSound( uint32 iSlot )
+{
+	SAISoundSlotKeys& Keys = m_lstActiveSoundKeys[iSlot];
+	if( !Keys.m_bIndexed )
+	{
+		return;
+	}
+
+	EraseAISoundSlot( m_mapActiveByCategoryTarget, AISOUND_CATEGORY_TARGET( Keys.m_eSoundCategory, Keys.m_hSoundTarget ), iSlot );
+	EraseAISoundSlot( m_mapActiveBySpeaker, Keys.m_hAI, iSlot );
+	EraseAISoundSlot( m_mapActiveByTime, Keys.m_fSoundRequestTime, iSlot );
+
+	if( Keys.m_bLastTimeIndexed )
+	{
+		EraseAISoundSlot( m_mapActiveByLastTime, Keys.m_fLastTime, iSlot );
+		Keys.m_bLastTimeIndexed = false;
+	}
+
+	// Any timer or pending completion left behind is discarded once it
+	// no longer matches the slot's record.
+
+	Keys.m_bIndexed = false;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAISoundMgr::SetPendingCompletion()
+//
+//	PURPOSE:	Wait for the speaker of an active sound to finish.
+//
+// ----------------------------------------------------------------------- //
+
+void CAISoundMgr::SetPendingCompletion( uint32 iSlot )
+{
+	SAISoundSlotKeys& Keys = m_lstActiveSoundKeys[iSlot];
+	if( !Keys.m_bPendingCompletion )
+	{
+		Keys.m_bPendingCompletion = true;
+		m_lstPendingCompletionSlots.push_back( iSlot );
+	}
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAISoundMgr::IndexActiveSoundLastTime()
+//
+//	PURPOSE:	Re-key an active sound slot by the time its record last
+//				changed.  Must be called when a delayed sound plays or a
+//				sound completes.  Delayed sounds are not indexed.
+//
+// ----------------------------------------------------------------------- //
+
+void CAISoundMgr::IndexActiveSoundLastTime( uint32 iSlot )
+{
+	SAISoundSlotKeys& Keys = m_lstActiveSoundKeys[iSlot];
+	if( Keys.m_bLastTimeIndexed )
+	{
+		EraseAISoundSlot( m_mapActiveByLastTime, Keys.m_fLastTime, iSlot );
+		Keys.m_bLastTimeIndexed = false;
+	}
+
+	CAISoundRecord* pSoundRecord = m_lstActiveSounds[iSlot];
+	if( !pSoundRecord || pSoundRecord->m_fSoundDelayTime > 0.f )
+	{
+		return;
+	}
+
+	// A record completes after it was requested, so the later of the two
+	// is the completion time once there is one.
+
+	Keys.m_bLastTimeIndexed = true;
+	Keys.m_fLastTime = LTMAX( pSoundRecord->m_fSoundCompletionTime, pSoundRecord->m_fSoundRequestTime );
+	m_mapActiveByLastTime.insert( AISOUND_TIME_MAP::value_type( Keys.m_fLastTime, iSlot ) );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAISoundMgr::FindActiveSlot*()
+//
+//	PURPOSE:	Return the first slot in the list of active sounds whose
+//				record matches, or -1.  Index entries are checked against
+//				the record, as its object references may have been cleared.
+//
+// ----------------------------------------------------------------------- //
+
+int32 CAISoundMgr::FindActiveSlotForSpeaker( HOBJECT hSpeaker )
+{
+	int32 iFound = -1;
 	CAISoundRecord* pSoundRecord;
-	AISOUND_LIST::iterator itSound;
-	for( itSound = m_lstActiveSounds.begin(); itSound != m_lstActiveSounds.end(); ++itSound )
+
+	if( !hSpeaker )
 	{
-		pSoundRecord = *itSound;
-		if( !pSoundRecord )
+		for( uint32 iSlot = 0; iSlot < m_lstActiveSounds.size(); ++iSlot )
 		{
-			continue;
+			pSoundRecord = m_lstActiveSounds[iSlot];
+			if( pSoundRecord && pSoundRecord->m_hAI == hSpeaker )
+			{
+				return iSlot;
+			}
+		}
+		return -1;
+	}
+
+	std::pair<AISOUND_SPEAKER_MAP::iterator, AISOUND_SPEAKER_MAP::iterator> itRange = m_mapActiveBySpeaker.equal_range( hSpeaker );
+	for( AISOUND_SPEAKER_MAP::iterator itSlot = itRange.first; itSlot != itRange.second; ++itSlot )
+	{
+		pSoundRecord = m_lstActiveSounds[itSlot->second];
+		if( ( iFound < 0 || (int32)itSlot->second < iFound ) && pSoundRecord->m_hAI == hSpeaker )
+		{
+			iFound = itSlot->second;
+		}
+	}
+
+	return iFound;
+}
+
+int32 CAISoundMgr::FindActiveSlotForTime( double fTime )
+{
+	int32 iFound = -1;
+
+	std::pair<AISOUND_TIME_MAP::iterator, AISOUND_TIME_MAP::iterator> itRange = m_mapActiveByTime.equal_range( fTime );
+	for( AISOUND_TIME_MAP::iterator itSlot = itRange.first; itSlot != itRange.second; ++itSlot )
+	{
+		if( iFound < 0 || (int32)itSlot->second < iFound )
+		{
+			iFound = itSlot->second;
 		}
+	}
+
+	return iFound;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAISoundMgr::FindActiveSound()
+//
+//	PURPOSE:	Return an active sound with the specified sound type and target.
+//
+// ----------------------------------------------------------------------- //
+
+CAISoundRecord* CAISoundMgr::FindActiveSound( EnumAISoundCategory eSoundCategory, HOBJECT hTarget )
+{
+	CAISoundRecord* pSoundRecord;
+
+	// Targets that have been removed are not indexed.
 
-		if( pSoundRecord->m_fSoundRequestTime == fTime )
+	if( !hTarget )
+	{
+		AISOUND_LIST::iterator itSound;
+		for( itSound = m_lstActiveSounds.begin(); itSound != m_lstActiveSounds.end(); ++itSound )
+		{
+			pSoundRecord = *itSound;
+			if( !pSoundRecord )
+			{
+				continue;
+			}
+
+			if( ( pSoundRecord->m_eSoundCategory == eSoundCategory ) &&
+				( pSoundRecord->m_hSoundTarget == hTarget ) )
+			{
+				return pSoundRecord;
+			}
+		}
+
+		return NULL;
+	}
+
+	int32 iFound = -1;
+
+	std::pair<AISOUND_CATEGORY_TARGET_MAP::iterator, AISOUND_CATEGORY_TARGET_MAP::iterator> itRange = m_mapActiveByCategoryTarget.equal_range( AISOUND_CATEGORY_TARGET( eSoundCategory, hTarget ) );
+	for( AISOUND_CATEGORY_TARGET_MAP::iterator itSlot = itRange.first; itSlot != itRange.second; ++itSlot )
+	{
+		pSoundRecord = m_lstActiveSounds[itSlot->second];
+		if( ( iFound < 0 || (int32)itSlot->second < iFound ) && pSoundRecord->m_hSoundTarget == hTarget )
+		{
+			iFound = itSlot->second;
+		}
+	}
+
+	return ( iFound < 0 ) ? NULL : m_lstActiveSounds[iFound];
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAISoundMgr::FindLastActiveSoundForTarget()
+//
+//	PURPOSE:	Return the most recent active sound with the specified target.
+//
+// ----------------------------------------------------------------------- //
+
+CAISoundRecord* CAISoundMgr::FindLastActiveSoundForTarget( HOBJECT hTarget )
+{
+	// The target filter has been disabled, so this is the most recent
+	// active sound for any target.  Delayed sounds are not indexed.
+
+	if( m_mapActiveByLastTime.empty() )
+	{
+		return NULL;
+	}
+
+	AISOUND_TIME_MAP::iterator itLast = m_mapActiveByLastTime.end();
+	--itLast;
+
+	double fTime = itLast->first;
+	if( fTime <= 0.f )
+	{
+		return NULL;
+	}
+
+	int32 iFound = -1;
+
+	std::pair<AISOUND_TIME_MAP::iterator, AISOUND_TIME_MAP::iterator> itRange = m_mapActiveByLastTime.equal_range( fTime );
+	for( AISOUND_TIME_MAP::iterator itSlot = itRange.first; itSlot != itRange.second; ++itSlot )
+	{
+		if( iFound < 0 || (int32)itSlot->second < iFound )
+		{
+			iFound = itSlot->second;
+		}
+	}
+
+	return m_lstActiveSounds[iFound];
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAISoundMgr::FindActiveSoundForSpeaker()
+//
+//	PURPOSE:	Return an active sound with the specified speaker.
+//
+// ----------------------------------------------------------------------- //
+
+CAISoundRecord* CAISoundMgr::FindActiveSoundForSpeaker( HOBJECT hSpeaker )
+{
+	int32 iSlot = FindActiveSlotForSpeaker( hSpeaker );
+	return ( iSlot < 0 ) ? NULL : m_lstActiveSounds[iSlot];
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAISoundMgr::FindActiveSoundForTime()
+//
+//	PURPOSE:	Return an active sound with the specified request time.
+//
+// ----------------------------------------------------------------------- //
+
+CAISoundRecord* CAISoundMgr::FindActiveSoundForTime( double fTime )
+{
+	int32 iSlot = FindActiveSlotForTime( fTime );
+	return ( iSlot < 0 ) ? NULL : m_lstActiveSounds[iSlot];
+}
+
+
+#ifndef _FINAL
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAISoundMgr::RecordReplayEvent()
+//
+//	PURPOSE:	Keep the most recent requests for AISoundReplayTest.
+//
+// ----------------------------------------------------------------------- //
+
+void CAISoundMgr::RecordReplayEvent( EnumAISoundReplayOp eOp, HOBJECT hAI, EnumAISoundType eSoundType, HOBJECT hAIPrior, EnumAISoundType eSoundTypePrior, EnumAISoundCategory eSoundCategory, HOBJECT hTarget, float fDelay )
+{
+	SAISoundReplayEvent Event;
+	Event.m_eOp = eOp;
+	Event.m_hAI = hAI;
+	Event.m_hTarget = hTarget;
+	Event.m_hAIPrior = hAIPrior;
+	Event.m_eSoundType = eSoundType;
+	Event.m_eSoundTypePrior = eSoundTypePrior;
+	Event.m_eSoundCategory = eSoundCategory;
+	Event.m_fTime = g_pLTServer->GetTime();
+	Event.m_fDelay = fDelay;
+
+	if( m_lstReplayEvents.size() < kAISoundReplayEvents )
+	{
+		m_lstReplayEvents.push_back( Event );
+	}
+	else {
+		m_lstReplayEvents[m_iNextReplayEvent] = Event;
+	}
+
+	m_iNextReplayEvent = ( m_iNextReplayEvent + 1 ) % kAISoundReplayEvents;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAISoundMgr::SwapActiveSoundState()
+//
+//	PURPOSE:	Exchange the active sounds and their indexes with a copy.
+//
+// ----------------------------------------------------------------------- //
+
+void CAISoundMgr::SwapActiveSoundState( SAISoundActiveState& State )
+{
+	m_lstActiveSounds.swap( State.m_lstActiveSounds );
+	m_lstActiveSoundKeys.swap( State.m_lstActiveSoundKeys );
+	m_lstFreeActiveSlots.swap( State.m_lstFreeActiveSlots );
+	m_mapActiveByCategoryTarget.swap( State.m_mapActiveByCategoryTarget );
+	m_mapActiveBySpeaker.swap( State.m_mapActiveBySpeaker );
+	m_mapActiveByTime.swap( State.m_mapActiveByTime );
+	m_mapActiveByLastTime.swap( State.m_mapActiveByLastTime );
+	m_lstActiveSoundTimers.swap( State.m_lstActiveSoundTimers );
+	m_lstPendingCompletionSlots.swap( State.m_lstPendingCompletionSlots );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ScanActiveSound*()
+//
+//	PURPOSE:	Reference lookups, walking the whole list of active sounds
+//				as CAISoundMgr did before the list was indexed.
+//
+// ----------------------------------------------------------------------- //
+
+static const uint32 kAISoundCategories = kAISndCat_TargetVisible + 1;
+
+static CAISoundRecord* ScanActiveSound( const AISOUND_LIST& lstActiveSounds, EnumAISoundCategory eSoundCategory, HOBJECT hTarget )
+{
+	AISOUND_LIST::const_iterator itSound;
+	for( itSound = lstActiveSounds.begin(); itSound != lstActiveSounds.end(); ++itSound )
+	{
+		CAISoundRecord* pSoundRecord = *itSound;
+		if( pSoundRecord 
+			&& ( pSoundRecord->m_eSoundCategory == eSoundCategory )
+			&& ( pSoundRecord->m_hSoundTarget == hTarget ) )
+		{
+			return pSoundRecord;
+		}
+	}
+
+	return NULL;
+}
+
+static CAISoundRecord* ScanActiveSoundForSpeaker( const AISOUND_LIST& lstActiveSounds, HOBJECT hSpeaker )
+{
+	AISOUND_LIST::const_iterator itSound;
+	for( itSound = lstActiveSounds.begin(); itSound != lstActiveSounds.end(); ++itSound )
+	{
+		CAISoundRecord* pSoundRecord = *itSound;
+		if( pSoundRecord && ( pSoundRecord->m_hAI == hSpeaker ) )
+		{
+			return pSoundRecord;
+		}
+	}
+
+	return NULL;
+}
+
+static CAISoundRecord* ScanActiveSoundForTime( const AISOUND_LIST& lstActiveSounds, double fTime )
+{
+	AISOUND_LIST::const_iterator itSound;
+	for( itSound = lstActiveSounds.begin(); itSound != lstActiveSounds.end(); ++itSound )
+	{
+		CAISoundRecord* pSoundRecord = *itSound;
+		if( pSoundRecord && ( pSoundRecord->m_fSoundRequestTime == fTime ) )
 		{
 			return pSoundRecord;
 		}
@@ -1019,3 +1520,355 @@ CAISoundRecord* CAISoundMgr::FindActiveSoundForTime( double fTime )
 	return NULL;
 }
 
+static CAISoundRecord* ScanLastActiveSound( const AISOUND_LIST& lstActiveSounds )
+{
+	double fTime = 0.f;
+	CAISoundRecord* pLastSoundRecord = NULL;
+
+	AISOUND_LIST::const_iterator itSound;
+	for( itSound = lstActiveSounds.begin(); itSound != lstActiveSounds.end(); ++itSound )
+	{
+		CAISoundRecord* pSoundRecord = *itSound;
+		if( !pSoundRecord || pSoundRecord->m_fSoundDelayTime > 0.f )
+		{
+			continue;
+		}
+
+		if( fTime < pSoundRecord->m_fSoundCompletionTime )
+		{
+			fTime = pSoundRecord->m_fSoundCompletionTime;
+			pLastSoundRecord = pSoundRecord;
+		}
+
+		else if( fTime < pSoundRecord->m_fSoundRequestTime )
+		{
+			fTime = pSoundRecord->m_fSoundRequestTime;
+			pLastSoundRecord = pSoundRecord;
+		}
+	}
+
+	return pLastSoundRecord;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAISoundMgr::CheckActiveSoundIndexes()
+//
+//	PURPOSE:	Return the number of lookups whose indexed result differs
+//				from a scan of the list of active sounds.
+//
+// ----------------------------------------------------------------------- //
+
+uint32 CAISoundMgr::CheckActiveSoundIndexes( const HOBJECT* pObjects, uint32 nObjects, double fTime )
+{
+	uint32 nMismatches = 0;
+
+	// Every object, and no object at all.
+
+	for( uint32 iObject=0; iObject <= nObjects; ++iObject )
+	{
+		HOBJECT hObject = ( iObject < nObjects ) ? pObjects[iObject] : NULL;
+
+		for( uint32 iCategory=0; iCategory < kAISoundCategories; ++iCategory )
+		{
+			if( FindActiveSound( (EnumAISoundCategory)iCategory, hObject ) != ScanActiveSound( m_lstActiveSounds, (EnumAISoundCategory)iCategory, hObject ) )
+			{
+				++nMismatches;
+			}
+		}
+
+		if( FindActiveSoundForSpeaker( hObject ) != ScanActiveSoundForSpeaker( m_lstActiveSounds, hObject ) )
+		{
+			++nMismatches;
+		}
+
+		if( FindLastActiveSoundForTarget( hObject ) != ScanLastActiveSound( m_lstActiveSounds ) )
+		{
+			++nMismatches;
+		}
+	}
+
+	// Every request time in the list, and the current time.
+
+	AISOUND_LIST::iterator itSound;
+	for( itSound = m_lstActiveSounds.begin(); itSound != m_lstActiveSounds.end(); ++itSound )
+	{
+		if( *itSound && FindActiveSoundForTime( (*itSound)->m_fSoundRequestTime ) != ScanActiveSoundForTime( m_lstActiveSounds, (*itSound)->m_fSoundRequestTime ) )
+		{
+			++nMismatches;
+		}
+	}
+
+	if( FindActiveSoundForTime( fTime ) != ScanActiveSoundForTime( m_lstActiveSounds, fTime ) )
+	{
+		++nMismatches;
+	}
+
+	return nMismatches;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAISoundMgr::RunAISoundReplayTest()
+//
+//	PURPOSE:	Replay a stream of requests against an empty set of active
+//				sounds, with delayed sounds playing, sounds completing and
+//				speakers dying along the way, and check every indexed
+//				lookup against a scan after each request.  The stream is
+//				the recorded requests, or nSynthesizedEvents random requests
+//				between objects in the world if a count is given or nothing
+//				has been recorded.  The live active sounds are untouched.
+//
+// ----------------------------------------------------------------------- //
+
+static uint32 NextAISoundReplayRandom( uint32* pnSeed )
+{
+	*pnSeed = *pnSeed * 1664525 + 1013904223;
+	return *pnSeed >> 8;
+}
+
+void CAISoundMgr::RunAISoundReplayTest( uint32 nSynthesizedEvents )
+{
+	enum { kMaxObjects = 32 };
+	HOBJECT ahObjects[kMaxObjects];
+	uint32 nObjects = 0;
+	uint32 nSeed = 1;
+
+	// Requests made during the replay are not recorded.
+
+	AISOUND_REPLAY_LIST lstRecorded;
+	lstRecorded.swap( m_lstReplayEvents );
+	uint32 iNextRecorded = m_iNextReplayEvent;
+
+	AISOUND_REPLAY_LIST lstEvents;
+	bool bRecorded = ( nSynthesizedEvents == 0 ) && !lstRecorded.empty();
+	if( bRecorded )
+	{
+		uint32 iFirst = ( lstRecorded.size() < kAISoundReplayEvents ) ? 0 : iNextRecorded;
+		for( uint32 iEvent=0; iEvent < lstRecorded.size(); ++iEvent )
+		{
+			const SAISoundReplayEvent& Event = lstRecorded[( iFirst + iEvent ) % lstRecorded.size()];
+			lstEvents.push_back( Event );
+
+			HOBJECT ahEventObjects[2] = { Event.m_hAI, Event.m_hTarget };
+			for( uint32 iEventObject=0; iEventObject < 2; ++iEventObject )
+			{
+				HOBJECT hObject = ahEventObjects[iEventObject];
+				if( hObject && nObjects < kMaxObjects 
+					&& std::find( ahObjects, ahObjects + nObjects, hObject ) == ahObjects + nObjects )
+				{
+					ahObjects[nObjects++] = hObject;
+				}
+			}
+		}
+	}
+	else {
+		if( nSynthesizedEvents == 0 )
+		{
+			nSynthesizedEvents = 2000;
+		}
+
+		// Records hold engine references, so the requests are made
+		// between real objects.
+
+		for( HOBJECT hObject = g_pLTServer->GetNextObject( NULL ); hObject && nObjects < kMaxObjects; hObject = g_pLTServer->GetNextObject( hObject ) )
+		{
+			ahObjects[nObjects++] = hObject;
+		}
+
+		if( nObjects == 0 )
+		{
+			g_pLTServer->CPrint( "AISoundReplayTest: no objects to make requests between" );
+			lstRecorded.swap( m_lstReplayEvents );
+			return;
+		}
+
+		double fTime = 1.0;
+		for( uint32 iEvent=0; iEvent < nSynthesizedEvents; ++iEvent )
+		{
+			uint32 nRandom = NextAISoundReplayRandom( &nSeed );
+
+			SAISoundReplayEvent Event;
+			Event.m_eOp = ( nRandom % 16 == 0 ) ? kAISndReplay_ClearPending : ( ( nRandom % 16 < 4 ) ? kAISndReplay_Sequence : kAISndReplay_Request );
+			Event.m_hAI = ahObjects[( nRandom >> 4 ) % nObjects];
+			Event.m_hTarget = ( ( nRandom >> 8 ) % 4 == 0 ) ? NULL : ahObjects[( nRandom >> 10 ) % nObjects];
+			Event.m_hAIPrior = ahObjects[( nRandom >> 14 ) % nObjects];
+			Event.m_eSoundType = (EnumAISoundType)( NextAISoundReplayRandom( &nSeed ) % kAIS_Count );
+			Event.m_eSoundTypePrior = kAIS_InvalidType;
+			Event.m_eSoundCategory = (EnumAISoundCategory)( NextAISoundReplayRandom( &nSeed ) % kAISoundCategories );
+			Event.m_fDelay = ( ( nRandom >> 18 ) % 4 == 0 ) ? 0.5f : 0.f;
+
+			// Several requests share each frame.
+
+			if( ( nRandom >> 20 ) % 3 == 0 )
+			{
+				fTime += 0.1;
+			}
+			Event.m_fTime = fTime;
+
+			lstEvents.push_back( Event );
+		}
+	}
+
+	// Replay into an empty set of active sounds.
+
+	SAISoundActiveState LiveState;
+	SwapActiveSoundState( LiveState );
+
+	CAISoundRecord* pSoundRecord;
+	uint32 iSlot;
+	uint32 nMismatches = 0;
+
+	AISOUND_REPLAY_LIST::iterator itEvent;
+	for( itEvent = lstEvents.begin(); itEvent != lstEvents.end(); ++itEvent )
+	{
+		const SAISoundReplayEvent& Event = *itEvent;
+		double fTime = Event.m_fTime;
+
+		// Delayed sounds that are due start playing.
+
+		while( !m_lstActiveSoundTimers.empty() && m_lstActiveSoundTimers.front().m_fTime <= fTime )
+		{
+			SAISoundTimer Timer = m_lstActiveSoundTimers.front();
+			std::pop_heap( m_lstActiveSoundTimers.begin(), m_lstActiveSoundTimers.end() );
+			m_lstActiveSoundTimers.pop_back();
+
+			pSoundRecord = m_lstActiveSounds[Timer.m_iSlot];
+			if( pSoundRecord 
+				&& pSoundRecord->m_fSoundDelayTime > 0.f
+				&& pSoundRecord->m_fSoundDelayTime == Timer.m_fTime )
+			{
+				pSoundRecord->m_fSoundDelayTime = 0.f;
+				IndexActiveSoundLastTime( Timer.m_iSlot );
+				SetPendingCompletion( Timer.m_iSlot );
+			}
+		}
+
+		// About half of the speakers still talking finish.
+
+		uint32 iPending = 0;
+		for( uint32 iCheck = 0; iCheck < m_lstPendingCompletionSlots.size(); ++iCheck )
+		{
+			iSlot = m_lstPendingCompletionSlots[iCheck];
+
+			pSoundRecord = m_lstActiveSounds[iSlot];
+			if( pSoundRecord 
+				&& pSoundRecord->m_fSoundDelayTime == 0.f
+				&& pSoundRecord->m_fSoundCompletionTime == 0.f )
+			{
+				if( NextAISoundReplayRandom( &nSeed ) % 2 == 0 )
+				{
+					pSoundRecord->m_fSoundCompletionTime = fTime;
+					IndexActiveSoundLastTime( iSlot );
+				}
+				else {
+					m_lstPendingCompletionSlots[iPending++] = iSlot;
+					continue;
+				}
+			}
+
+			m_lstActiveSoundKeys[iSlot].m_bPendingCompletion = false;
+		}
+		m_lstPendingCompletionSlots.resize( iPending );
+
+		// Apply the request.
+
+		switch( Event.m_eOp )
+		{
+			case kAISndReplay_Request:
+			case kAISndReplay_Sequence:
+				{
+					CAISoundRecord SoundRecord;
+					SoundRecord.m_hAI = Event.m_hAI;
+					SoundRecord.m_eSoundType = Event.m_eSoundType;
+					SoundRecord.m_eSoundCategory = Event.m_eSoundCategory;
+					SoundRecord.m_hSoundTarget = Event.m_hTarget;
+					SoundRecord.m_fSoundRequestTime = fTime;
+					SoundRecord.m_fSoundDelayTime = ( Event.m_fDelay > 0.f ) ? fTime + Event.m_fDelay : 0.f;
+					SoundRecord.m_fSoundCompletionTime = 0.f;
+
+					if( Event.m_eOp == kAISndReplay_Request )
+					{
+						pSoundRecord = AI_FACTORY_NEW( CAISoundRecord );
+						*pSoundRecord = SoundRecord;
+						RecordActiveAISound( pSoundRecord );
+						break;
+					}
+
+					// A sequence takes over the slot of the sound it follows.
+
+					SoundRecord.m_hSoundSequenceAIPrior = Event.m_hAIPrior;
+					SoundRecord.m_eSoundSequenceTypePrior = Event.m_eSoundTypePrior;
+
+					int32 iPriorSlot = FindActiveSlotForTime( fTime );
+					if( iPriorSlot >= 0 )
+					{
+						UnindexActiveSound( iPriorSlot );
+						*m_lstActiveSounds[iPriorSlot] = SoundRecord;
+						IndexActiveSound( iPriorSlot );
+					}
+				}
+				break;
+
+			case kAISndReplay_ClearPending:
+				{
+					ClearPendingAISounds( Event.m_hAI );
+
+					for( iSlot = 0; iSlot < m_lstActiveSounds.size(); ++iSlot )
+					{
+						pSoundRecord = m_lstActiveSounds[iSlot];
+						if( pSoundRecord && pSoundRecord->m_bSoundDeleted )
+						{
+							DeleteActiveSound( iSlot );
+						}
+					}
+				}
+				break;
+		}
+
+		// Now and then a speaker dies.
+
+		if( !m_lstActiveSounds.empty() && NextAISoundReplayRandom( &nSeed ) % 8 == 0 )
+		{
+			DeleteActiveSound( NextAISoundReplayRandom( &nSeed ) % m_lstActiveSounds.size() );
+		}
+
+		nMismatches += CheckActiveSoundIndexes( ahObjects, nObjects, fTime );
+	}
+
+	// Put the live active sounds and recorded requests back.
+
+	for( iSlot = 0; iSlot < m_lstActiveSounds.size(); ++iSlot )
+	{
+		DeleteActiveSound( iSlot );
+	}
+
+	SwapActiveSoundState( LiveState );
+	lstRecorded.swap( m_lstReplayEvents );
+	m_iNextReplayEvent = iNextRecorded;
+
+	g_pLTServer->CPrint( "AISoundReplayTest: replayed %u %s requests between %u objects, %u mismatched lookups - %s", 
+		(uint32)lstEvents.size(), bRecorded ? "recorded" : "random", nObjects, nMismatches,
+		( nMismatches == 0 ) ? "PASSED" : "FAILED" );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	AISoundReplayTestCB()
+//
+//	PURPOSE:	Console program "AISoundReplayTest [<random requests>]".
+//
+// ----------------------------------------------------------------------- //
+
+static void AISoundReplayTestCB( int argc, char** argv )
+{
+	if( !g_pAISoundMgr )
+	{
+		return;
+	}
+
+	uint32 nSynthesizedEvents = ( argc > 0 ) ? (uint32)atoi( argv[0] ) : 0;
+	g_pAISoundMgr->RunAISoundReplayTest( nSynthesizedEvents );
+}
+
+#endif // _FINAL
@@ -15,6 +15,9 @@
 #include "AIClassFactory.h"
 #include "AISounds.h"
 
+#include <map>
+#include <set>
+
 
 // Forward declarations.
 
@@ -77,6 +80,134 @@ class CAISoundRecord : public CAIClassAbstract
 //
 typedef std::vector<CAISoundRecord*, LTAllocator<CAISoundRecord*, LT_MEM_TYPE_OBJECTSHELL> > AISOUND_LIST;
 
+//
+// MAPS: Indexes into the list of active sounds.  Each maps a key to the
+//       slots in the list that held a record with that key when the
+//       record was added.
+//
+typedef std::pair<EnumAISoundCategory, HOBJECT> AISOUND_CATEGORY_TARGET;
+
+typedef std::multimap<
+			AISOUND_CATEGORY_TARGET,
+			uint32,
+			std::less<AISOUND_CATEGORY_TARGET>,
+			LTAllocator<std::pair<const AISOUND_CATEGORY_TARGET, uint32>, LT_MEM_TYPE_OBJECTSHELL>
+		> AISOUND_CATEGORY_TARGET_MAP;
+
+typedef std::multimap<
+			HOBJECT,
+			uint32,
+			std::less<HOBJECT>,
+			LTAllocator<std::pair<const HOBJECT, uint32>, LT_MEM_TYPE_OBJECTSHELL>
+		> AISOUND_SPEAKER_MAP;
+
+typedef std::multimap<
+			double,
+			uint32,
+			std::less<double>,
+			LTAllocator<std::pair<const double, uint32>, LT_MEM_TYPE_OBJECTSHELL>
+		> AISOUND_TIME_MAP;
+
+//
+// STRUCT: Keys an active sound slot is indexed under.
+//
+struct SAISoundSlotKeys
+{
+	SAISoundSlotKeys()
+		: m_bIndexed( false )
+		, m_bPendingCompletion( false )
+		, m_bLastTimeIndexed( false )
+		, m_hAI( NULL )
+		, m_eSoundCategory( kAISndCat_Always )
+		, m_hSoundTarget( NULL )
+		, m_fSoundRequestTime( 0.f )
+		, m_fLastTime( 0.f )
+	{
+	}
+
+	bool				m_bIndexed;
+	bool				m_bPendingCompletion;
+	bool				m_bLastTimeIndexed;
+	HOBJECT				m_hAI;
+	EnumAISoundCategory	m_eSoundCategory;
+	HOBJECT				m_hSoundTarget;
+	double				m_fSoundRequestTime;
+	double				m_fLastTime;
+};
+
+//
+// STRUCT: Time at which a delayed active sound should play.
+//
+struct SAISoundTimer
+{
+	double	m_fTime;
+	uint32	m_iSlot;
+
+	// Ordered so the standard heap functions keep the earliest on top.
+
+	bool operator<( const SAISoundTimer& rhs ) const { return m_fTime > rhs.m_fTime; }
+};
+
+typedef std::vector<SAISoundSlotKeys, LTAllocator<SAISoundSlotKeys, LT_MEM_TYPE_OBJECTSHELL> > AISOUND_SLOT_KEY_LIST;
+typedef std::vector<SAISoundTimer, LTAllocator<SAISoundTimer, LT_MEM_TYPE_OBJECTSHELL> > AISOUND_TIMER_LIST;
+typedef std::vector<uint32, LTAllocator<uint32, LT_MEM_TYPE_OBJECTSHELL> > AISOUND_SLOT_LIST;
+typedef std::vector<EnumAISoundType, LTAllocator<EnumAISoundType, LT_MEM_TYPE_OBJECTSHELL> > AISOUND_TYPE_LIST;
+
+typedef std::pair<HOBJECT, EnumAISoundType> AISOUND_REQUEST_KEY;
+
+typedef std::set<
+			AISOUND_REQUEST_KEY,
+			std::less<AISOUND_REQUEST_KEY>,
+			LTAllocator<AISOUND_REQUEST_KEY, LT_MEM_TYPE_OBJECTSHELL>
+		> AISOUND_REQUEST_SET;
+
+#ifndef _FINAL
+
+//
+// STRUCT: A request made of the sound manager, kept so the request
+//         stream can be replayed by the AISoundReplayTest console program.
+//
+enum EnumAISoundReplayOp
+{
+	kAISndReplay_Request,
+	kAISndReplay_Sequence,
+	kAISndReplay_ClearPending,
+};
+
+struct SAISoundReplayEvent
+{
+	EnumAISoundReplayOp		m_eOp;
+	LTObjRef				m_hAI;
+	LTObjRef				m_hTarget;
+	LTObjRef				m_hAIPrior;
+	EnumAISoundType			m_eSoundType;
+	EnumAISoundType			m_eSoundTypePrior;
+	EnumAISoundCategory		m_eSoundCategory;
+	double					m_fTime;
+	float					m_fDelay;
+};
+
+typedef std::vector<SAISoundReplayEvent, LTAllocator<SAISoundReplayEvent, LT_MEM_TYPE_OBJECTSHELL> > AISOUND_REPLAY_LIST;
+
+//
+// STRUCT: Active sounds and their indexes, swapped out of the manager
+//         while a replay runs.
+//
+struct SAISoundActiveState
+{
+	AISOUND_LIST				m_lstActiveSounds;
+	AISOUND_SLOT_KEY_LIST		m_lstActiveSoundKeys;
+	AISOUND_SLOT_LIST			m_lstFreeActiveSlots;
+	AISOUND_CATEGORY_TARGET_MAP	m_mapActiveByCategoryTarget;
+	AISOUND_SPEAKER_MAP			m_mapActiveBySpeaker;
+	AISOUND_TIME_MAP			m_mapActiveByTime;
+	AISOUND_TIME_MAP			m_mapActiveByLastTime;
+	AISOUND_TIMER_LIST			m_lstActiveSoundTimers;
+	AISOUND_SLOT_LIST			m_lstPendingCompletionSlots;
+};
+
+#endif // _FINAL
+
 
 //
 // CLASS: Global manager of active and requested sounds.
@@ -99,7 +230,7 @@ class CAISoundMgr
 		// Sequences.
 
 		void	RequestAISoundSequence( HOBJECT hAI, EnumAISoundType eSoundType, HOBJECT hAIPrior, EnumAISoundType eSoundTypePrior, EnumAISoundType eSoundTypeFirst, EnumAISoundCategory eSoundCategory, HOBJECT hTarget, float fDelay );
-		void	ClearAISoundSequences( CAISoundRecord* pRequestSoundRecord );
+		void	ClearAISoundSequences( EnumAISoundType eRequestSoundType );
 
 		// Skip AI sound.
 
@@ -109,12 +240,20 @@ class CAISoundMgr
 
 		void	UpdateAISoundMgr();
 
+#ifndef _FINAL
+		// Replays the recorded request stream against the active sound
+		// indexes, checking every lookup against a scan of the list.
+
+		void	RunAISoundReplayTest( uint32 nSynthesizedEvents );
+#endif // _FINAL
+
 	protected:
 
 		void			UpdateActiveAISounds();
 		void			UpdateSequencedAISounds();
 
 		bool			CanPlayAISound( CAI* pAI, CAISoundRecord* pSoundRecord );
+		bool			IsAISoundFrequencyLimited( EnumAISoundType eSoundType, EnumAISoundCategory eSoundCategory, double fCurTime );
 		void			RecordActiveAISound( CAISoundRecord* pSoundRecord );
 
 		void			PlayActiveAISound( CAISoundRecord* pSoundRecord );
@@ -124,12 +263,64 @@ class CAISoundMgr
 		CAISoundRecord* FindActiveSoundForSpeaker( HOBJECT hSpeaker );
 		CAISoundRecord* FindActiveSoundForTime( double fTime );
 
+		// Active sound slots.
+
+		uint32			AddActiveSound( CAISoundRecord* pSoundRecord );
+		void			DeleteActiveSound( uint32 iSlot );
+		void			IndexActiveSound( uint32 iSlot );
+		void			UnindexActiveSound( uint32 iSlot );
+		void			SetPendingCompletion( uint32 iSlot );
+		void			IndexActiveSoundLastTime( uint32 iSlot );
+
+		int32			FindActiveSlotForSpeaker( HOBJECT hSpeaker );
+		int32			FindActiveSlotForTime( double fTime );
+
 	protected:
 
 		AISOUND_LIST		m_lstRequestedSounds;
 		AISOUND_LIST		m_lstSequencedSounds;
 		AISOUND_LIST		m_lstActiveSounds;
 
+		// Requests already made this frame, used to drop duplicates.
+
+		AISOUND_REQUEST_SET	m_setRequestedSounds;
+		double				m_fRequestedSoundsTime;
+
+		// Active sound indexes.  Slots of deleted active sounds are reused
+		// lowest first, so the lists keep the order a scan would find.
+
+		AISOUND_SLOT_KEY_LIST		m_lstActiveSoundKeys;
+		AISOUND_SLOT_LIST			m_lstFreeActiveSlots;
+		AISOUND_CATEGORY_TARGET_MAP	m_mapActiveByCategoryTarget;
+		AISOUND_SPEAKER_MAP			m_mapActiveBySpeaker;
+		AISOUND_TIME_MAP			m_mapActiveByTime;
+
+		// Active sounds that are not delayed, keyed by the time they
+		// completed, or the time they were requested if still playing.
+
+		AISOUND_TIME_MAP			m_mapActiveByLastTime;
+
+		// Delayed active sounds waiting to play, and active sounds waiting
+		// for their speaker to finish.
+
+		AISOUND_TIMER_LIST			m_lstActiveSoundTimers;
+		AISOUND_SLOT_LIST			m_lstPendingCompletionSlots;
+
+		// Types of requests rejected by the frequency limits as they were
+		// made.  They still clear conflicting sequences on the next update.
+
+		AISOUND_TYPE_LIST	m_lstSuppressedSoundTypes;
+		bool				m_abSuppressedSoundTypes[kAIS_Count];
+
+#ifndef _FINAL
+		AISOUND_REPLAY_LIST	m_lstReplayEvents;
+		uint32				m_iNextReplayEvent;
+
+		void	RecordReplayEvent( EnumAISoundReplayOp eOp, HOBJECT hAI, EnumAISoundType eSoundType, HOBJECT hAIPrior, EnumAISoundType eSoundTypePrior, EnumAISoundCategory eSoundCategory, HOBJECT hTarget, float fDelay );
+		void	SwapActiveSoundState( SAISoundActiveState& State );
+		uint32	CheckActiveSoundIndexes( const HOBJECT* pObjects, uint32 nObjects, double fTime );
+#endif // _FINAL
+
 		CAISoundRecord		m_LastPlayedSoundRecord;
 		double				m_afLastEventTime[kAIS_Count];
 		double				m_fLastLimitedWarnAllyTime;
@@ -0,0 +1,392 @@
+// ----------------------------------------------------------------------- //
+//
+// MODULE  : AIVisibilityMgr.cpp
+//
+// PURPOSE : AIVisibilityMgr implementation
+//
+// CREATED : 10/18/26
+//
+// (c) 2026 Monolith Productions, Inc.  All Rights Reserved
+// ----------------------------------------------------------------------- //
+
+#include "Stdafx.h"
+#include "AIVisibilityMgr.h"
+#include "AI.h"
+#include "AIUtils.h"
+
+
+// Globals / Statics
+
+CAIVisibilityMgr* g_pAIVisibilityMgr = NULL;
+
+// Number of cached rays.  Must be a power of two.
+
+static const uint32 s_nAIVisibilityCacheSize = 1024;
+
+// Seconds a cached ray stays valid, per query class.  A lifetime of zero
+// still lets identical rays cast in the same frame share one result.
+
+static const double s_afAIVisibilityCacheLifetime[kAIVisQuery_Count] =
+{
+	0.1,	// kAIVisQuery_Default
+	0.1,	// kAIVisQuery_SeeThrough
+	0.0,	// kAIVisQuery_ShootThrough
+	0.0,	// kAIVisQuery_Ground
+};
+
+// ----------------------------------------------------------------------- //
+
+static inline uint32 HashAIVisibilityBits( uint32 nHash, const void* pData, uint32 nSize )
+{
+	// FNV-1a.
+
+	const uint8* pBytes = (const uint8*)pData;
+	for( uint32 iByte=0; iByte < nSize; ++iByte )
+	{
+		nHash ^= pBytes[iByte];
+		nHash *= 16777619;
+	}
+
+	return nHash;
+}
+
+static inline bool IsSameAIVisibilityQuery( const SAIVisibilityQuery& A, const SAIVisibilityQuery& B )
+{
+	return ( A.m_hFilterObject == B.m_hFilterObject )
+		&& ( A.m_vFrom == B.m_vFrom )
+		&& ( A.m_vTo == B.m_vTo )
+		&& ( A.m_dwFlags == B.m_dwFlags )
+		&& ( A.m_fnObjectFilter == B.m_fnObjectFilter )
+		&& ( A.m_fnPolyFilter == B.m_fnPolyFilter )
+		&& ( A.m_eQueryClass == B.m_eQueryClass );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAIVisibilityMgr::CAIVisibilityMgr()
+//
+//	PURPOSE:	Con/destructor
+//
+// ----------------------------------------------------------------------- //
+
+CAIVisibilityMgr::CAIVisibilityMgr()
+{
+	ASSERT(g_pAIVisibilityMgr == NULL);
+	g_pAIVisibilityMgr = this;
+
+	m_iNextQueuedQuery = 0;
+
+	InitAIVisibilityMgr();
+}
+
+CAIVisibilityMgr::~CAIVisibilityMgr()
+{
+	ASSERT(g_pAIVisibilityMgr != NULL);
+
+	TermAIVisibilityMgr();
+
+	g_pAIVisibilityMgr = NULL;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAIVisibilityMgr::InitAIVisibilityMgr()
+//
+//	PURPOSE:	Init object
+//
+// ----------------------------------------------------------------------- //
+
+void CAIVisibilityMgr::InitAIVisibilityMgr()
+{
+	ASSERT(g_pAIVisibilityMgr != NULL);
+
+	m_lstCache.resize( s_nAIVisibilityCacheSize );
+
+	m_FrameStats.Clear();
+	m_TotalStats.Clear();
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAIVisibilityMgr::TermAIVisibilityMgr()
+//
+//	PURPOSE:	Terminate object
+//
+// ----------------------------------------------------------------------- //
+
+void CAIVisibilityMgr::TermAIVisibilityMgr()
+{
+	// Cached rays refer to the old world's geometry and objects.
+
+	AIVISIBILITY_CACHE::iterator itEntry;
+	for( itEntry = m_lstCache.begin(); itEntry != m_lstCache.end(); ++itEntry )
+	{
+		itEntry->m_bValid = false;
+		itEntry->m_hObject = NULL;
+	}
+
+	ClearQueuedQueries();
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAIVisibilityMgr::UpdateAIVisibilityMgr()
+//
+//	PURPOSE:	Start a new frame of queries.
+//
+// ----------------------------------------------------------------------- //
+
+void CAIVisibilityMgr::UpdateAIVisibilityMgr()
+{
+	m_FrameStats.Clear();
+
+	// Results from last frame's batches are no longer wanted.
+
+	ClearQueuedQueries();
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAIVisibilityMgr::IntersectSegment()
+//
+//	PURPOSE:	Return the result of a ray, casting it only if an identical
+//				ray is not already cached.  Returns true if the ray hit
+//				something.
+//
+// ----------------------------------------------------------------------- //
+
+bool CAIVisibilityMgr::IntersectSegment( const SAIVisibilityQuery& Query, SAIVisibilityResult* pResult )
+{
+	SAIVisibilityResult Result;
+	double fCurTime = g_pLTServer->GetTime();
+
+	++m_FrameStats.m_nQueries;
+	++m_TotalStats.m_nQueries;
+
+	if( !LookupCache( Query, fCurTime, &Result ) )
+	{
+		CastRay( Query, fCurTime, &Result );
+	}
+
+	if( pResult )
+	{
+		*pResult = Result;
+	}
+
+	return Result.m_bIntersected;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAIVisibilityMgr::*Queued*()
+//
+//	PURPOSE:	Queue up rays to be resolved together.
+//
+// ----------------------------------------------------------------------- //
+
+uint32 CAIVisibilityMgr::QueueQuery( const SAIVisibilityQuery& Query )
+{
+	SQueuedQuery QueuedQuery;
+	QueuedQuery.m_Query = Query;
+	QueuedQuery.m_bResolved = false;
+
+	m_lstQueuedQueries.push_back( QueuedQuery );
+
+	++m_FrameStats.m_nQueries;
+	++m_TotalStats.m_nQueries;
+
+	return m_lstQueuedQueries.size() - 1;
+}
+
+bool CAIVisibilityMgr::ProcessQueuedQueries( uint32 nMaxRays )
+{
+	double fCurTime = g_pLTServer->GetTime();
+
+	// Duplicates within the batch are answered by the cache entry
+	// left behind by the first of them.
+
+	uint32 nRaysCast = 0;
+	while( m_iNextQueuedQuery < m_lstQueuedQueries.size() )
+	{
+		SQueuedQuery& QueuedQuery = m_lstQueuedQueries[m_iNextQueuedQuery];
+
+		if( !LookupCache( QueuedQuery.m_Query, fCurTime, &QueuedQuery.m_Result ) )
+		{
+			if( nRaysCast >= nMaxRays )
+			{
+				return false;
+			}
+
+			CastRay( QueuedQuery.m_Query, fCurTime, &QueuedQuery.m_Result );
+			++nRaysCast;
+		}
+
+		QueuedQuery.m_bResolved = true;
+		++m_iNextQueuedQuery;
+	}
+
+	return true;
+}
+
+bool CAIVisibilityMgr::GetQueuedResult( uint32 iQuery, SAIVisibilityResult* pResult ) const
+{
+	if( iQuery >= m_lstQueuedQueries.size()
+		|| !m_lstQueuedQueries[iQuery].m_bResolved )
+	{
+		return false;
+	}
+
+	if( pResult )
+	{
+		*pResult = m_lstQueuedQueries[iQuery].m_Result;
+	}
+
+	return true;
+}
+
+void CAIVisibilityMgr::ClearQueuedQueries()
+{
+	m_lstQueuedQueries.resize( 0 );
+	m_iNextQueuedQuery = 0;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAIVisibilityMgr::GetCacheEntry()
+//
+//	PURPOSE:	Return the cache entry a query maps to.
+//
+// ----------------------------------------------------------------------- //
+
+CAIVisibilityMgr::SCacheEntry& CAIVisibilityMgr::GetCacheEntry( const SAIVisibilityQuery& Query )
+{
+	uint32 nHash = 2166136261u;
+	nHash = HashAIVisibilityBits( nHash, &Query.m_hFilterObject, sizeof( Query.m_hFilterObject ) );
+	nHash = HashAIVisibilityBits( nHash, &Query.m_vFrom, sizeof( Query.m_vFrom ) );
+	nHash = HashAIVisibilityBits( nHash, &Query.m_vTo, sizeof( Query.m_vTo ) );
+	nHash = HashAIVisibilityBits( nHash, &Query.m_dwFlags, sizeof( Query.m_dwFlags ) );
+	nHash = HashAIVisibilityBits( nHash, &Query.m_fnObjectFilter, sizeof( Query.m_fnObjectFilter ) );
+	nHash = HashAIVisibilityBits( nHash, &Query.m_fnPolyFilter, sizeof( Query.m_fnPolyFilter ) );
+	nHash = HashAIVisibilityBits( nHash, &Query.m_eQueryClass, sizeof( Query.m_eQueryClass ) );
+
+	return m_lstCache[nHash & ( s_nAIVisibilityCacheSize - 1 )];
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAIVisibilityMgr::LookupCache()
+//
+//	PURPOSE:	Return true if an identical ray was cast recently enough
+//				to reuse its result.
+//
+// ----------------------------------------------------------------------- //
+
+bool CAIVisibilityMgr::LookupCache( const SAIVisibilityQuery& Query, double fCurTime, SAIVisibilityResult* pResult )
+{
+	SCacheEntry& Entry = GetCacheEntry( Query );
+
+	if( !Entry.m_bValid
+		|| Entry.m_fExpirationTime < fCurTime
+		|| !IsSameAIVisibilityQuery( Entry.m_Query, Query ) )
+	{
+		return false;
+	}
+
+	// The object hit has since been removed, so the ray needs recasting.
+
+	if( Entry.m_bIntersected && !Entry.m_hObject )
+	{
+		Entry.m_bValid = false;
+		return false;
+	}
+
+	pResult->m_bIntersected = Entry.m_bIntersected;
+	pResult->m_hObject = Entry.m_hObject;
+	pResult->m_vPoint = Entry.m_vPoint;
+	pResult->m_vNormal = Entry.m_vNormal;
+	pResult->m_hPoly = Entry.m_hPoly;
+
+	++m_FrameStats.m_nCacheHits;
+	++m_TotalStats.m_nCacheHits;
+
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAIVisibilityMgr::CastRay()
+//
+//	PURPOSE:	Cast a ray and cache the result.
+//
+// ----------------------------------------------------------------------- //
+
+void CAIVisibilityMgr::CastRay( const SAIVisibilityQuery& Query, double fCurTime, SAIVisibilityResult* pResult )
+{
+	IntersectQuery IQuery;
+	IntersectInfo IInfo;
+
+	IQuery.m_From = Query.m_vFrom;
+	IQuery.m_To = Query.m_vTo;
+	IQuery.m_Flags = Query.m_dwFlags;
+	IQuery.m_FilterFn = Query.m_fnObjectFilter;
+	IQuery.m_PolyFilterFn = Query.m_fnPolyFilter;
+
+	CAI::SetFilterAI( Query.m_hFilterObject );
+
+	g_cIntersectSegmentCalls++;
+
+	pResult->m_bIntersected = g_pLTServer->IntersectSegment( IQuery, &IInfo );
+	pResult->m_hObject = IInfo.m_hObject;
+	pResult->m_vPoint = IInfo.m_Point;
+	pResult->m_vNormal = IInfo.m_Plane.m_Normal;
+	pResult->m_hPoly = IInfo.m_hPoly;
+
+	++m_FrameStats.m_nRaysCast;
+	++m_TotalStats.m_nRaysCast;
+
+	// Cache the result.
+
+	EnumAIVisibilityQueryClass eQueryClass = Query.m_eQueryClass;
+	if( eQueryClass < 0 || eQueryClass >= kAIVisQuery_Count )
+	{
+		eQueryClass = kAIVisQuery_Default;
+	}
+
+	SCacheEntry& Entry = GetCacheEntry( Query );
+	Entry.m_bValid = true;
+	Entry.m_fExpirationTime = fCurTime + s_afAIVisibilityCacheLifetime[eQueryClass];
+	Entry.m_Query = Query;
+	Entry.m_bIntersected = pResult->m_bIntersected;
+	Entry.m_hObject = IInfo.m_hObject;
+	Entry.m_vPoint = IInfo.m_Point;
+	Entry.m_vNormal = IInfo.m_Plane.m_Normal;
+	Entry.m_hPoly = IInfo.m_hPoly;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAIVisibilityMgr::OnAIDebugCmd()
+//
+//	PURPOSE:	Handle AIDebug console commands.
+//
+// ----------------------------------------------------------------------- //
+
+void CAIVisibilityMgr::OnAIDebugCmd( HOBJECT hSender, const CParsedMsg& cParsedMsg )
+{
+	static CParsedMsg::CToken s_cTok_Stats("Stats");
+
+	if ( s_cTok_Stats == cParsedMsg.GetArg(1) )
+	{
+		uint32 nTotalQueries = LTMAX( m_TotalStats.m_nQueries, 1 );
+
+		g_pLTServer->CPrint( "AIVisibilityMgr stats - Frame queries: %d, cache hits: %d, rays cast: %d",
+			m_FrameStats.m_nQueries, m_FrameStats.m_nCacheHits, m_FrameStats.m_nRaysCast );
+		g_pLTServer->CPrint( "\tTotal queries: %d, cache hits: %d (%.1f%%), rays cast: %d",
+			m_TotalStats.m_nQueries, m_TotalStats.m_nCacheHits,
+			100.f * (float)m_TotalStats.m_nCacheHits / (float)nTotalQueries, m_TotalStats.m_nRaysCast );
+	}
+	else
+	{
+		g_pLTServer->CPrint( "AIVisibilityMgr commands: Stats" );
+	}
+}
@@ -0,0 +1,204 @@
+// ----------------------------------------------------------------------- //
+//
+// MODULE  : AIVisibilityMgr.h
+//
+// PURPOSE : AIVisibilityMgr class definition
+//
+// CREATED : 10/18/26
+//
+// (c) 2026 Monolith Productions, Inc.  All Rights Reserved
+// ----------------------------------------------------------------------- //
+
+#ifndef __AIVISIBILITY_MGR_H__
+#define __AIVISIBILITY_MGR_H__
+
+#include "ltobjref.h"
+
+#pragma warning (disable : 4786)
+#include <vector>
+
+
+// Forward declarations.
+
+class	CAIVisibilityMgr;
+class	CParsedMsg;
+
+extern CAIVisibilityMgr *g_pAIVisibilityMgr;
+
+
+// Query classes.  Each class has its own cache lifetime, so checks
+// that feed quick decisions can be kept fresher than the others.
+
+enum EnumAIVisibilityQueryClass
+{
+	kAIVisQuery_Default,
+	kAIVisQuery_SeeThrough,
+	kAIVisQuery_ShootThrough,
+	kAIVisQuery_Ground,
+	kAIVisQuery_Count,
+};
+
+
+//
+// STRUCT: Description of a single line-of-sight ray.
+//
+struct SAIVisibilityQuery
+{
+	SAIVisibilityQuery()
+		: m_hFilterObject( NULL )
+		, m_vFrom( 0.f, 0.f, 0.f )
+		, m_vTo( 0.f, 0.f, 0.f )
+		, m_dwFlags( 0 )
+		, m_fnObjectFilter( NULL )
+		, m_fnPolyFilter( NULL )
+		, m_eQueryClass( kAIVisQuery_Default )
+	{
+	}
+
+	// Object the CAI filter functions ignore (usually the AI looking).
+
+	HOBJECT						m_hFilterObject;
+
+	LTVector					m_vFrom;
+	LTVector					m_vTo;
+	uint32						m_dwFlags;
+	ObjectFilterFn				m_fnObjectFilter;
+	PolyFilterFn				m_fnPolyFilter;
+	EnumAIVisibilityQueryClass	m_eQueryClass;
+};
+
+
+//
+// STRUCT: Outcome of a line-of-sight ray.
+//
+struct SAIVisibilityResult
+{
+	SAIVisibilityResult()
+		: m_bIntersected( false )
+		, m_hObject( NULL )
+		, m_vPoint( 0.f, 0.f, 0.f )
+		, m_vNormal( 0.f, 0.f, 0.f )
+		, m_hPoly( INVALID_HPOLY )
+	{
+	}
+
+	bool		m_bIntersected;
+	HOBJECT		m_hObject;
+
+	// Where the ray hit, and the poly it hit if INTERSECT_HPOLY was set.
+
+	LTVector	m_vPoint;
+	LTVector	m_vNormal;
+	HPOLY		m_hPoly;
+};
+
+
+//
+// STRUCT: Query counts, per frame and since the world started.
+//
+struct SAIVisibilityStats
+{
+	SAIVisibilityStats() { Clear(); }
+
+	void Clear()
+	{
+		m_nQueries = 0;
+		m_nCacheHits = 0;
+		m_nRaysCast = 0;
+	}
+
+	uint32		m_nQueries;
+	uint32		m_nCacheHits;
+	uint32		m_nRaysCast;
+};
+
+
+//
+// CLASS: Central service for AI line-of-sight rays.  Identical rays
+//        cast within a query class's lifetime are answered from a
+//        cache rather than re-cast.  Queries may be issued one at a
+//        time, or queued and processed as a batch.
+//
+class CAIVisibilityMgr
+{
+	public : // Public methods
+
+		 CAIVisibilityMgr();
+		~CAIVisibilityMgr();
+
+		void	InitAIVisibilityMgr();
+		void	TermAIVisibilityMgr();
+
+		// Update.
+
+		void	UpdateAIVisibilityMgr();
+
+		// Immediate queries.
+
+		bool	IntersectSegment( const SAIVisibilityQuery& Query, SAIVisibilityResult* pResult );
+
+		// Batched queries.  Queued queries are resolved in the order they
+		// were queued.  ProcessQueuedQueries casts at most nMaxRays rays
+		// and returns true once every queued query has a result.  The
+		// queue is emptied at the start of every frame, so results must
+		// be collected in the frame they were queued.
+
+		uint32	QueueQuery( const SAIVisibilityQuery& Query );
+		bool	ProcessQueuedQueries( uint32 nMaxRays );
+		bool	GetQueuedResult( uint32 iQuery, SAIVisibilityResult* pResult ) const;
+		void	ClearQueuedQueries();
+
+		// Statistics.
+
+		const SAIVisibilityStats&	GetFrameStats() const { return m_FrameStats; }
+		const SAIVisibilityStats&	GetTotalStats() const { return m_TotalStats; }
+
+		// Debugging.
+
+		void	OnAIDebugCmd( HOBJECT hSender, const CParsedMsg& cParsedMsg );
+
+	protected:
+
+		struct SCacheEntry
+		{
+			SCacheEntry()
+				: m_bValid( false )
+				, m_fExpirationTime( 0.f )
+			{
+			}
+
+			bool				m_bValid;
+			double				m_fExpirationTime;
+			SAIVisibilityQuery	m_Query;
+			bool				m_bIntersected;
+			LTObjRef			m_hObject;
+			LTVector			m_vPoint;
+			LTVector			m_vNormal;
+			HPOLY				m_hPoly;
+		};
+
+		struct SQueuedQuery
+		{
+			SAIVisibilityQuery	m_Query;
+			SAIVisibilityResult	m_Result;
+			bool				m_bResolved;
+		};
+
+		typedef std::vector<SCacheEntry, LTAllocator<SCacheEntry, LT_MEM_TYPE_OBJECTSHELL> > AIVISIBILITY_CACHE;
+		typedef std::vector<SQueuedQuery, LTAllocator<SQueuedQuery, LT_MEM_TYPE_OBJECTSHELL> > AIVISIBILITY_QUEUE;
+
+		SCacheEntry&	GetCacheEntry( const SAIVisibilityQuery& Query );
+		bool			LookupCache( const SAIVisibilityQuery& Query, double fCurTime, SAIVisibilityResult* pResult );
+		void			CastRay( const SAIVisibilityQuery& Query, double fCurTime, SAIVisibilityResult* pResult );
+
+	protected:
+
+		AIVISIBILITY_CACHE	m_lstCache;
+		AIVISIBILITY_QUEUE	m_lstQueuedQueries;
+		uint32				m_iNextQueuedQuery;
+
+		SAIVisibilityStats	m_FrameStats;
+		SAIVisibilityStats	m_TotalStats;
+};
+
+#endif
@@ -18,6 +18,70 @@
 
 const char* const szBanFile = "BanIPList.txt";
 
+#ifndef _FINAL
+static void BanIPCompatTestCB( int argc, char** argv );
+#endif // _FINAL
+
+// Gets the mask covering the first nPrefixLength bits of an address.
+static inline uint32 GetPrefixMask( uint32 nPrefixLength )
+{
+	return nPrefixLength ? ( 0xFFFFFFFF << ( 32 - nPrefixLength )) : 0;
+}
+
+// Gets bit nBit of an address, counting from the high bit.
+static inline uint32 GetAddressBit( uint32 nAddress, uint32 nBit )
+{
+	return ( nAddress >> ( 31 - nBit )) & 1;
+}
+
+// ----------------------------------------------------------------------- //
+//
+// class BanIPTrie
+//
+// Path compressed binary radix trie of banned address prefixes.  Checking
+// an address visits at most one node per address bit, regardless of how
+// many bans there are.
+//
+// ----------------------------------------------------------------------- //
+class BanIPTrie
+{
+	public:
+
+		BanIPTrie( ) { Clear( ); }
+
+		// Removes all prefixes.
+		void Clear( );
+
+		// Adds a prefix.
+		void Insert( uint32 nAddress, uint32 nPrefixLength );
+
+		// Checks if an address falls within any prefix.
+		bool Contains( uint32 nAddress ) const;
+
+		// Exchanges contents with another trie.
+		void Swap( BanIPTrie& other ) { m_lstNodes.swap( other.m_lstNodes ); }
+
+	private:
+
+		enum { kInvalidNode = ( uint32 )-1 };
+
+		struct Node
+		{
+			uint32	m_nAddress;
+			uint32	m_nPrefixLength;
+			uint32	m_nChild[2];
+			bool	m_bBanned;
+		};
+
+		// Creates a node and returns its index.
+		uint32 AddNode( uint32 nAddress, uint32 nPrefixLength, bool bBanned );
+
+		// Nodes are referenced by index.  The root, with an empty prefix, is
+		// always the first node.
+		typedef std::vector< Node, LTAllocator<Node, LT_MEM_TYPE_OBJECTSHELL> > NodeList;
+		NodeList m_lstNodes;
+};
+
 class BanIPMgr_Impl : public BanIPMgr
 {
 	friend class BanIPMgr;
@@ -56,13 +120,28 @@ class BanIPMgr_Impl : public BanIPMgr
 		// Get the list of bans.
 		virtual BanList const& GetBanList( ) { return m_BanList; }
 
+		// Rereads the ban file.
+		virtual bool ReloadBans( );
+
+#ifndef _FINAL
+		// Checks the ban parser and trie against the wildcard matching they
+		// replaced, using randomly generated bans and addresses.
+		void RunBanIPCompatTest( uint32 nBans );
+#endif // _FINAL
+
 	protected:
 
+		// Checks if a ban is allowed.
+		static bool IsValidBan( ClientIP const& bannedIP );
+
 		// Checks if the client matches banned IP's.
 		bool IsClientBanned( HCLIENT hClient );
 
-		// Reads current bans from ini file.
-		bool ReadBans( );
+		// Kicks all clients that match banned IP's.
+		void KickBannedClients( );
+
+		// Reads bans from ini file into a list and trie.
+		bool ReadBans( BanList& banList, BanIPTrie& banTrie );
 
 		// Writes current bans to ini file.
 		bool WriteBans( );
@@ -72,8 +151,18 @@ class BanIPMgr_Impl : public BanIPMgr
 		bool m_bInitialized;
 		BanList	m_BanList;
 
+		// Index of m_BanList used to check clients.
+		BanIPTrie m_BanTrie;
+
 	private:
 
+		// bans being read by ReadBans
+		struct ReadBansData
+		{
+			BanList*	m_pBanList;
+			BanIPTrie*	m_pBanTrie;
+		};
+
 		// callback for processing each line of the ban file
 		static bool ReadBansProcessLineFn(const char* strLine, void* pProcessLineUserData);
 
@@ -115,19 +204,39 @@ BanIPMgr& BanIPMgr::Instance( )
 
 bool BanIPMgr::ConvertClientIPFromString( char const* pszBanIP, ClientIP& bannedIP )
 {
-	// Default to all parts banned.
-	bannedIP.m_nPart[0] = ( uint8 )-1;
-	bannedIP.m_nPart[1] = ( uint8 )-1;
-	bannedIP.m_nPart[2] = ( uint8 )-1;
-	bannedIP.m_nPart[3] = ( uint8 )-1;
+	// Default to an empty ban.
+	bannedIP.m_nPart[0] = 0;
+	bannedIP.m_nPart[1] = 0;
+	bannedIP.m_nPart[2] = 0;
+	bannedIP.m_nPart[3] = 0;
+	bannedIP.m_nPrefixLength = 0;
 
 	// Check inputs.
 	if( !pszBanIP || !pszBanIP[0] )
 		return false;
 
 	// Copy the string so we can strtok.
-	char szBanIP[16] = "";
-	strncpy( szBanIP, pszBanIP, ARRAY_LEN( szBanIP ));
+	char szBanIP[32] = "";
+	LTStrCpy( szBanIP, pszBanIP, LTARRAYSIZE( szBanIP ));
+
+	// Split off the CIDR prefix length, if there is one.
+	int nCIDRPrefixLength = -1;
+	char* pszCIDR = strchr( szBanIP, '/' );
+	if( pszCIDR )
+	{
+		*pszCIDR = '\0';
+		pszCIDR++;
+		if( !isdigit(( unsigned char )pszCIDR[0] ))
+			return false;
+
+		// The whole rest of the string must be the number.
+		char* pszCIDREnd = NULL;
+		unsigned long nPrefixLength = strtoul( pszCIDR, &pszCIDREnd, 10 );
+		if( *pszCIDREnd != '\0' || nPrefixLength > 32 )
+			return false;
+
+		nCIDRPrefixLength = ( int )nPrefixLength;
+	}
 
 	// Break the string up into the four parts.
 	char* pszToken = strtok( szBanIP, "." );
@@ -159,6 +268,26 @@ bool BanIPMgr::ConvertClientIPFromString( char const* pszBanIP, ClientIP& banned
 	if( !bWildCard && i < 4 )
 		return false;
 
+	// A wildcard bans everything after the parts before it.  It can't be
+	// combined with a CIDR prefix.
+	if( bWildCard )
+	{
+		if( nCIDRPrefixLength >= 0 )
+			return false;
+
+		bannedIP.m_nPrefixLength = ( uint8 )( i * 8 );
+		return true;
+	}
+
+	bannedIP.m_nPrefixLength = ( uint8 )(( nCIDRPrefixLength >= 0 ) ? nCIDRPrefixLength : 32 );
+
+	// Clear the bits past the prefix so equal bans compare equal.
+	uint32 nAddress = bannedIP.GetAddress( ) & GetPrefixMask( bannedIP.m_nPrefixLength );
+	bannedIP.m_nPart[0] = ( uint8 )( nAddress >> 24 );
+	bannedIP.m_nPart[1] = ( uint8 )( nAddress >> 16 );
+	bannedIP.m_nPart[2] = ( uint8 )( nAddress >> 8 );
+	bannedIP.m_nPart[3] = ( uint8 )nAddress;
+
 	return true;
 }
 
@@ -180,10 +309,14 @@ bool BanIPMgr::ConvertClientIPToString( ClientIP const& bannedIP, char* pszClien
 
 	std::string sClientIP = "";
 
+	// Prefixes on a part boundary are written with a wildcard, which older
+	// servers can read.  Anything else is written in CIDR form.
+	bool bWildCard = ( bannedIP.m_nPrefixLength < 32 ) && (( bannedIP.m_nPrefixLength % 8 ) == 0 );
+
 	for( int i = 0; i < 4; i++ )
 	{
 		// Check if this part is using a wildcard.
-		if( bannedIP.m_nPart[i] == ( uint8 )-1 )
+		if( bWildCard && i * 8 == bannedIP.m_nPrefixLength )
 		{
 			sClientIP += "*";
 			break;
@@ -203,6 +336,13 @@ bool BanIPMgr::ConvertClientIPToString( ClientIP const& bannedIP, char* pszClien
 		}
 	}
 
+	if( !bWildCard && bannedIP.m_nPrefixLength < 32 )
+	{
+		char szPrefix[16] = "";
+		LTSNPrintF( szPrefix, LTARRAYSIZE( szPrefix ), "/%d", bannedIP.m_nPrefixLength );
+		sClientIP += szPrefix;
+	}
+
 	// If there isn't room, then return failure.
 	if( sClientIP.length( ) > nSize - 1 )
 		return false;
@@ -213,6 +353,143 @@ bool BanIPMgr::ConvertClientIPToString( ClientIP const& bannedIP, char* pszClien
 }
 
 
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	BanIPTrie::Clear
+//
+//	PURPOSE:	Removes all prefixes.
+//
+// ----------------------------------------------------------------------- //
+
+void BanIPTrie::Clear( )
+{
+	m_lstNodes.clear( );
+	AddNode( 0, 0, false );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	BanIPTrie::AddNode
+//
+//	PURPOSE:	Creates a node and returns its index.
+//
+// ----------------------------------------------------------------------- //
+
+uint32 BanIPTrie::AddNode( uint32 nAddress, uint32 nPrefixLength, bool bBanned )
+{
+	Node node;
+	node.m_nAddress = nAddress;
+	node.m_nPrefixLength = nPrefixLength;
+	node.m_nChild[0] = kInvalidNode;
+	node.m_nChild[1] = kInvalidNode;
+	node.m_bBanned = bBanned;
+
+	m_lstNodes.push_back( node );
+	return ( uint32 )( m_lstNodes.size( ) - 1 );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	BanIPTrie::Insert
+//
+//	PURPOSE:	Adds a prefix.
+//
+// ----------------------------------------------------------------------- //
+
+void BanIPTrie::Insert( uint32 nAddress, uint32 nPrefixLength )
+{
+	nAddress &= GetPrefixMask( nPrefixLength );
+
+	// Walk down from the root.  The current node's prefix is always a
+	// prefix of the one being inserted.
+	uint32 nNode = 0;
+	for( ;; )
+	{
+		uint32 nNodePrefixLength = m_lstNodes[nNode].m_nPrefixLength;
+		if( nNodePrefixLength == nPrefixLength )
+		{
+			m_lstNodes[nNode].m_bBanned = true;
+			return;
+		}
+
+		uint32 nBit = GetAddressBit( nAddress, nNodePrefixLength );
+		uint32 nChild = m_lstNodes[nNode].m_nChild[nBit];
+		if( nChild == kInvalidNode )
+		{
+			uint32 nLeaf = AddNode( nAddress, nPrefixLength, true );
+			m_lstNodes[nNode].m_nChild[nBit] = nLeaf;
+			return;
+		}
+
+		// Count the bits the new prefix shares with the child's.  The bit
+		// used to pick the child is known to match.
+		uint32 nChildAddress = m_lstNodes[nChild].m_nAddress;
+		uint32 nChildPrefixLength = m_lstNodes[nChild].m_nPrefixLength;
+		uint32 nMaxCommon = LTMIN( nPrefixLength, nChildPrefixLength );
+		uint32 nDifference = nAddress ^ nChildAddress;
+		uint32 nCommon = nNodePrefixLength + 1;
+		while( nCommon < nMaxCommon && !GetAddressBit( nDifference, nCommon ))
+			nCommon++;
+
+		// The child's prefix is a prefix of the new one, keep going.
+		if( nCommon == nChildPrefixLength )
+		{
+			nNode = nChild;
+			continue;
+		}
+
+		// Split the edge to the child.  If the new prefix ends at the split
+		// it becomes the split node, otherwise it hangs off a new branch.
+		uint32 nSplit;
+		if( nCommon == nPrefixLength )
+		{
+			nSplit = AddNode( nAddress, nPrefixLength, true );
+		}
+		else
+		{
+			nSplit = AddNode( nAddress & GetPrefixMask( nCommon ), nCommon, false );
+			uint32 nLeaf = AddNode( nAddress, nPrefixLength, true );
+			m_lstNodes[nSplit].m_nChild[GetAddressBit( nAddress, nCommon )] = nLeaf;
+		}
+
+		m_lstNodes[nSplit].m_nChild[GetAddressBit( nChildAddress, nCommon )] = nChild;
+		m_lstNodes[nNode].m_nChild[nBit] = nSplit;
+		return;
+	}
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	BanIPTrie::Contains
+//
+//	PURPOSE:	Checks if an address falls within any prefix.
+//
+// ----------------------------------------------------------------------- //
+
+bool BanIPTrie::Contains( uint32 nAddress ) const
+{
+	uint32 nNode = 0;
+	for( ;; )
+	{
+		Node const& node = m_lstNodes[nNode];
+		if( node.m_bBanned )
+			return true;
+
+		if( node.m_nPrefixLength == 32 )
+			return false;
+
+		nNode = node.m_nChild[GetAddressBit( nAddress, node.m_nPrefixLength )];
+		if( nNode == kInvalidNode )
+			return false;
+
+		// Stop if the address leaves the child's prefix.
+		Node const& child = m_lstNodes[nNode];
+		if(( nAddress ^ child.m_nAddress ) & GetPrefixMask( child.m_nPrefixLength ))
+			return false;
+	}
+}
+
+
 // ----------------------------------------------------------------------- //
 //
 //	ROUTINE:	BanIPMgr_Impl::BanIPMgr_Impl
@@ -224,6 +501,13 @@ bool BanIPMgr::ConvertClientIPToString( ClientIP const& bannedIP, char* pszClien
 BanIPMgr_Impl::BanIPMgr_Impl( )
 {
 	m_bInitialized = false;
+
+#ifndef _FINAL
+	if( g_pLTServer )
+	{
+		g_pLTServer->RegisterConsoleProgram( "BanIPCompatTest", BanIPCompatTestCB );
+	}
+#endif // _FINAL
 }
 
 // ----------------------------------------------------------------------- //
@@ -237,6 +521,13 @@ BanIPMgr_Impl::BanIPMgr_Impl( )
 BanIPMgr_Impl::~BanIPMgr_Impl( )
 {
 	Term( );
+
+#ifndef _FINAL
+	if( g_pLTServer )
+	{
+		g_pLTServer->UnregisterConsoleProgram( "BanIPCompatTest" );
+	}
+#endif // _FINAL
 }
 
 
@@ -254,7 +545,7 @@ bool BanIPMgr_Impl::Init( )
 	Term( );
 
 	// Read in the bans from the ini.
-	if( !ReadBans( ))
+	if( !ReloadBans( ))
 		return false;
 
 	m_bInitialized = true;
@@ -279,6 +570,7 @@ void BanIPMgr_Impl::Term( )
 	m_bInitialized = false;
 
 	m_BanList.clear( );
+	m_BanTrie.Clear( );
 }
 
 // ----------------------------------------------------------------------- //
@@ -324,35 +616,17 @@ bool BanIPMgr_Impl::AddBan( char const* pszBanIP )
 
 bool BanIPMgr_Impl::AddBan( ClientIP const& bannedIP )
 {
-	// Don't allow banning of everyone.
-	if( bannedIP.m_nPart[0] == 255 )
-	{
-		return false;
-	}
-
-	// Don't allow banning of local host, which has a special IP.
-	if( bannedIP.m_nPart[0] == 0 && bannedIP.m_nPart[1] == 0 && 
-		bannedIP.m_nPart[2] == 0 && bannedIP.m_nPart[3] == 0 )
-	{
+	if( !IsValidBan( bannedIP ))
 		return false;
-	}
 
 	// Add it to the list.
-	m_BanList.insert( bannedIP );
-
-	// Iterate over all the clients and see if any match the new banned IP.
-    HCLIENT hIterClient = g_pLTServer->GetNextClient( NULL );
-    while( hIterClient )
+	if( m_BanList.insert( bannedIP ).second )
 	{
-		HCLIENT hNextIterClient = g_pLTServer->GetNextClient( hIterClient );
-
-		if( IsClientBanned( hIterClient ))
-		{
-			g_pLTServer->KickClient( hIterClient );
-		}
-
-	    hIterClient = hNextIterClient;
+		m_BanTrie.Insert( bannedIP.GetAddress( ), bannedIP.m_nPrefixLength );
 	}
+
+	// Kick any clients that match the new banned IP.
+	KickBannedClients( );
 	
 	return true;
 }
@@ -388,7 +662,67 @@ bool BanIPMgr_Impl::RemoveBan( char const* pszBanIP )
 
 bool BanIPMgr_Impl::RemoveBan( ClientIP const& bannedIP )
 {
-	m_BanList.erase( bannedIP );
+	if( !m_BanList.erase( bannedIP ))
+		return true;
+
+	// Removing bans is rare, so just rebuild the trie from the list.
+	m_BanTrie.Clear( );
+	for( BanList::iterator iter = m_BanList.begin( ); iter != m_BanList.end( ); iter++ )
+	{
+		m_BanTrie.Insert( iter->GetAddress( ), iter->m_nPrefixLength );
+	}
+
+	return true;
+}
+
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	BanIPMgr_Impl::ReloadBans
+//
+//	PURPOSE:	Rereads the ban file.  The bans are read into a new list
+//				and trie, which replace the current ones only on success.
+//
+// ----------------------------------------------------------------------- //
+
+bool BanIPMgr_Impl::ReloadBans( )
+{
+	BanList banList;
+	BanIPTrie banTrie;
+	if( !ReadBans( banList, banTrie ))
+		return false;
+
+	m_BanList.swap( banList );
+	m_BanTrie.Swap( banTrie );
+
+	// Kick any clients that match the new bans.
+	KickBannedClients( );
+
+	return true;
+}
+
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	BanIPMgr_Impl::IsValidBan
+//
+//	PURPOSE:	Checks if a ban is allowed.
+//
+// ----------------------------------------------------------------------- //
+
+bool BanIPMgr_Impl::IsValidBan( ClientIP const& bannedIP )
+{
+	// Don't allow banning of everyone.
+	if( bannedIP.m_nPrefixLength == 0 )
+	{
+		return false;
+	}
+
+	// Don't allow banning of local host, which has a special IP.
+	if( bannedIP.GetAddress( ) == 0 )
+	{
+		return false;
+	}
 
 	return true;
 }
@@ -409,33 +743,39 @@ bool BanIPMgr_Impl::IsClientBanned( HCLIENT hClient )
 	uint16 nPort;
 	g_pLTServer->GetClientAddr( hClient, aClientIP, &nPort );
 
-	// Look through list of banned ip's.
-	for( BanList::iterator iter = m_BanList.begin( ); iter != m_BanList.end( ); iter++ )
+	uint32 nClientAddress = (( uint32 )aClientIP[0] << 24 ) | (( uint32 )aClientIP[1] << 16 ) | 
+		(( uint32 )aClientIP[2] << 8 ) | ( uint32 )aClientIP[3];
+
+	return m_BanTrie.Contains( nClientAddress );
+}
+
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	BanIPMgr_Impl::KickBannedClients
+//
+//	PURPOSE:	Kicks all clients that match banned IP's.
+//
+// ----------------------------------------------------------------------- //
+
+void BanIPMgr_Impl::KickBannedClients( )
+{
+	if( !g_pLTServer )
+		return;
+
+	// Iterate over all the clients and see if any match the banned IP's.
+    HCLIENT hIterClient = g_pLTServer->GetNextClient( NULL );
+    while( hIterClient )
 	{
-		ClientIP const& bannedIP = *iter;
-		bool bBanned = false;
-		int i;
-		for( i = 0; i < 4; i++ )
-		{
-			// Check if no IP's allowed with this part.
-			if( bannedIP.m_nPart[i] == ( uint8 )-1 )
-			{
-				bBanned = true;
-				break;
-			}
+		HCLIENT hNextIterClient = g_pLTServer->GetNextClient( hIterClient );
 
-			// Check if this part doesn't match.
-			if( bannedIP.m_nPart[i] != aClientIP[i] )
-				break;
+		if( IsClientBanned( hIterClient ))
+		{
+			g_pLTServer->KickClient( hIterClient );
 		}
 
-		// Check if they matched the ban.
-		if( bBanned || i == 4 )
-			return true;
+	    hIterClient = hNextIterClient;
 	}
-
-	// Client not banned.
-	return false;
 }
 
 // ----------------------------------------------------------------------- //
@@ -448,21 +788,31 @@ bool BanIPMgr_Impl::IsClientBanned( HCLIENT hClient )
 
 bool BanIPMgr_Impl::ReadBansProcessLineFn(const char* strLine, void* pProcessLineUserData)
 {
-	BanIPMgr_Impl* pBanIPMgr = (BanIPMgr_Impl*)pProcessLineUserData;
+	ReadBansData* pReadBansData = (ReadBansData*)pProcessLineUserData;
+
+	// convert and validate the ban
+	ClientIP bannedIP;
+	if( !ConvertClientIPFromString( strLine, bannedIP ) || !IsValidBan( bannedIP ))
+		return false;
+
+	// add the ban, skipping duplicates
+	if( pReadBansData->m_pBanList->insert( bannedIP ).second )
+	{
+		pReadBansData->m_pBanTrie->Insert( bannedIP.GetAddress( ), bannedIP.m_nPrefixLength );
+	}
 
-	// add the ban
-	return pBanIPMgr->AddBan(strLine);
+	return true;
 }
 
 // ----------------------------------------------------------------------- //
 //
 //	ROUTINE:	BanIPMgr_Impl::ReadBans
 //
-//	PURPOSE:	Reads current bans.
+//	PURPOSE:	Reads bans into a list and trie.
 //
 // ----------------------------------------------------------------------- //
 
-bool BanIPMgr_Impl::ReadBans( )
+bool BanIPMgr_Impl::ReadBans( BanList& banList, BanIPTrie& banTrie )
 {
 	// build the file name by prepending the user directory
 	char szFilename[MAX_PATH];
@@ -473,8 +823,11 @@ bool BanIPMgr_Impl::ReadBans( )
 	if( !LTFileOperations::FileExists( szFilename ))
 		return true;
 
-	// read in the current set of bans
-	return LTFileOperations::ParseTextFile(szFilename, ReadBansProcessLineFn, this);
+	// read in the set of bans
+	ReadBansData readBansData;
+	readBansData.m_pBanList = &banList;
+	readBansData.m_pBanTrie = &banTrie;
+	return LTFileOperations::ParseTextFile(szFilename, ReadBansProcessLineFn, &readBansData);
 }
 
 // ----------------------------------------------------------------------- //
@@ -512,11 +865,12 @@ bool BanIPMgr_Impl::WriteBans( )
 		ClientIP const& bannedIP = *iter;
 
 		// Convert it to a string.
-		char szClientIP[16] = "";
+		char szClientIP[32] = "";
 		if( !ConvertClientIPToString( bannedIP, szClientIP, ARRAY_LEN( szClientIP )))
 			return false;
 
-		// Write the banned IP.
+		// Write the banned IP on its own line.
+		LTStrCat( szClientIP, "\n", ARRAY_LEN( szClientIP ));
 		if (!cBanFile.Write(szClientIP, LTStrLen(szClientIP)))
 		{
 			return false;
@@ -525,3 +879,357 @@ bool BanIPMgr_Impl::WriteBans( )
 
 	return true;
 }
+
+#ifndef _FINAL
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	LegacyConvertClientIPFromString
+//
+//	PURPOSE:	The wildcard ban parser used before bans were prefixes.
+//				Parts set to 255 are wildcards.
+//
+// ----------------------------------------------------------------------- //
+
+static bool LegacyConvertClientIPFromString( char const* pszBanIP, uint8* pnPart )
+{
+	pnPart[0] = pnPart[1] = pnPart[2] = pnPart[3] = ( uint8 )-1;
+
+	if( !pszBanIP || !pszBanIP[0] )
+		return false;
+
+	char szBanIP[16] = "";
+	strncpy( szBanIP, pszBanIP, ARRAY_LEN( szBanIP ));
+	szBanIP[ARRAY_LEN( szBanIP ) - 1] = '\0';
+
+	char* pszToken = strtok( szBanIP, "." );
+	bool bWildCard = false;
+	int i;
+	for( i = 0; i < 4 && pszToken; i++ )
+	{
+		if( strstr( pszToken, "*" ))
+		{
+			bWildCard = true;
+			break;
+		}
+
+		int nNum = atoi( pszToken );
+		if( nNum < 0 || nNum > 255 )
+			return false;
+
+		pnPart[i] = ( uint8 )nNum;
+		pszToken = strtok( NULL, "." );
+	}
+
+	if( !bWildCard && i < 4 )
+		return false;
+
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	LegacyIsValidBan
+//
+//	PURPOSE:	The ban validation used before bans were prefixes.
+//
+// ----------------------------------------------------------------------- //
+
+static bool LegacyIsValidBan( uint8 const* pnPart )
+{
+	if( pnPart[0] == 255 )
+		return false;
+
+	if( pnPart[0] == 0 && pnPart[1] == 0 && pnPart[2] == 0 && pnPart[3] == 0 )
+		return false;
+
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	LegacyIsBanned
+//
+//	PURPOSE:	The per ban wildcard match used before bans were prefixes.
+//
+// ----------------------------------------------------------------------- //
+
+static bool LegacyIsBanned( uint8 const* pnPart, uint32 nAddress )
+{
+	for( int i = 0; i < 4; i++ )
+	{
+		if( pnPart[i] == ( uint8 )-1 )
+			return true;
+
+		if( pnPart[i] != ( uint8 )( nAddress >> ( 24 - i * 8 )))
+			return false;
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	BanIPMgr_Impl::RunBanIPCompatTest
+//
+//	PURPOSE:	Checks the ban parser and trie against the wildcard matching
+//				they replaced.
+//
+//	Bans with a part of 255 and wildcard bans under 0.* are left out of the
+//	random bans.  The old code read 255 as a wildcard and accepted 0.*, and
+//	neither is kept on purpose.  Those, and the CIDR prefix lengths that only
+//	the new parser reads, are checked against fixed results instead.
+//
+// ----------------------------------------------------------------------- //
+
+void BanIPMgr_Impl::RunBanIPCompatTest( uint32 nBans )
+{
+	if( nBans == 0 )
+	{
+		nBans = 2000;
+	}
+
+	uint32 nSeed = 0x1B873593;
+	uint32 nMismatches = 0;
+
+	// Only the first few mismatches are printed.
+	const uint32 knMaxPrintedMismatches = 16;
+
+	// Hand picked strings, including ones both parsers reject.
+	static char const* const s_aszFixedBans[] =
+	{
+		"10.1.2.3", "10.1.2.*", "10.1.*", "10.*", "10.1.2*", "10.1*.5.6",
+		"*", "0.0.0.0", "1.2.3", "1.2.3.4.5", "256.1.1.1", "", "a.b.c.d",
+	};
+
+	// Strings that only the new parser reads, or that it reads differently
+	// on purpose, with the ban they must give.
+	struct ParseCase
+	{
+		char const*	m_pszBan;
+		bool		m_bValid;
+		uint32		m_nAddress;
+		uint32		m_nPrefixLength;
+	};
+	static ParseCase const s_aParseCases[] =
+	{
+		{ "10.1.2.3/16", true, 0x0A010000, 16 },
+		{ "10.1.2.3/08", true, 0x0A000000, 8 },
+		{ "10.1.2.3/32", true, 0x0A010203, 32 },
+		{ "10.1.2.3/0", false, 0, 0 },
+		{ "10.1.2.3/33", false, 0, 0 },
+		{ "10.1.2.3/4294967304", false, 0, 0 },
+		{ "10.1.2.3/8x", false, 0, 0 },
+		{ "10.1.2.3/8.5", false, 0, 0 },
+		{ "10.1.2.3/ 8", false, 0, 0 },
+		{ "10.1.2.3/-8", false, 0, 0 },
+		{ "10.1.2.3/", false, 0, 0 },
+		{ "10.*/8", false, 0, 0 },
+
+		// A part of 255 is a number, not a wildcard.
+		{ "10.255.1.2", true, 0x0AFF0102, 32 },
+		{ "255.1.2.3", true, 0xFF010203, 32 },
+
+		// Wildcards under 0.* would cover the local host address.
+		{ "0.*", false, 0, 0 },
+		{ "0.0.*", false, 0, 0 },
+		{ "0.1.*", true, 0x00010000, 16 },
+	};
+
+	for( uint32 iCase = 0; iCase < LTARRAYSIZE( s_aParseCases ); ++iCase )
+	{
+		ParseCase const& parseCase = s_aParseCases[iCase];
+
+		ClientIP bannedIP;
+		bool bValid = ConvertClientIPFromString( parseCase.m_pszBan, bannedIP ) && IsValidBan( bannedIP );
+		bool bPassed = ( bValid == parseCase.m_bValid );
+
+		// The ban must cover its address and nothing just past its prefix.
+		if( bPassed && bValid )
+		{
+			BanIPTrie caseTrie;
+			caseTrie.Insert( bannedIP.GetAddress( ), bannedIP.m_nPrefixLength );
+
+			uint32 nOutside = parseCase.m_nAddress ^ ( 1u << ( 32 - parseCase.m_nPrefixLength ));
+			bPassed = ( bannedIP.GetAddress( ) == parseCase.m_nAddress ) && 
+				( bannedIP.m_nPrefixLength == parseCase.m_nPrefixLength ) &&
+				caseTrie.Contains( parseCase.m_nAddress ) && !caseTrie.Contains( nOutside );
+		}
+
+		if( !bPassed )
+		{
+			if( nMismatches < knMaxPrintedMismatches )
+			{
+				g_pLTServer->CPrint( "BanIPCompatTest: '%s' should be %s, got %s /%u", parseCase.m_pszBan, 
+					parseCase.m_bValid ? "valid" : "invalid", bValid ? "valid" : "invalid", ( uint32 )bannedIP.m_nPrefixLength );
+			}
+			++nMismatches;
+		}
+	}
+
+	// Legacy bans, four parts each.
+	typedef std::vector< uint8, LTAllocator<uint8, LT_MEM_TYPE_OBJECTSHELL> > LegacyBanList;
+	LegacyBanList lstLegacyBans;
+	BanIPTrie banTrie;
+	BanIPTrie cidrTrie;
+
+	// Random CIDR bans, kept for a brute force check.
+	typedef std::vector< ClientIP, LTAllocator<ClientIP, LT_MEM_TYPE_OBJECTSHELL> > CIDRBanList;
+	CIDRBanList lstCIDRBans;
+
+	uint32 nFixedBans = LTARRAYSIZE( s_aszFixedBans );
+	for( uint32 iBan = 0; iBan < nFixedBans + nBans; ++iBan )
+	{
+		char szBan[32] = "";
+		if( iBan < nFixedBans )
+		{
+			LTStrCpy( szBan, s_aszFixedBans[iBan], LTARRAYSIZE( szBan ));
+		}
+		else
+		{
+			nSeed = nSeed * 1664525 + 1013904223;
+			uint32 nRandom = nSeed >> 4;
+
+			// Parts come from small ranges, so bans overlap and share trie
+			// nodes while leaving some addresses unbanned.
+			uint32 nParts = 2 + (( nRandom & 3 ) % 3 );
+			nRandom >>= 2;
+			for( uint32 iPart = 0; iPart < nParts; ++iPart )
+			{
+				uint32 nPart = ( iPart == 0 ) ? ( 1 + ( nRandom & 63 )) : ( nRandom & 31 );
+				nRandom >>= ( iPart == 0 ) ? 6 : 5;
+
+				char szPart[8] = "";
+				LTSNPrintF( szPart, LTARRAYSIZE( szPart ), ( iPart == 0 ) ? "%u" : ".%u", nPart );
+				LTStrCat( szBan, szPart, LTARRAYSIZE( szBan ));
+			}
+			if( nParts < 4 )
+			{
+				LTStrCat( szBan, ".*", LTARRAYSIZE( szBan ));
+			}
+		}
+
+		// Both parsers must accept and reject the same strings and bans.
+		uint8 nLegacyPart[4];
+		ClientIP bannedIP;
+		bool bLegacyValid = LegacyConvertClientIPFromString( szBan, nLegacyPart ) && LegacyIsValidBan( nLegacyPart );
+		bool bValid = ConvertClientIPFromString( szBan, bannedIP ) && IsValidBan( bannedIP );
+		if( bLegacyValid != bValid )
+		{
+			if( nMismatches < knMaxPrintedMismatches )
+			{
+				g_pLTServer->CPrint( "BanIPCompatTest: '%s' is %s but was %s", szBan, 
+					bValid ? "valid" : "invalid", bLegacyValid ? "valid" : "invalid" );
+			}
+			++nMismatches;
+			continue;
+		}
+
+		if( !bValid )
+		{
+			continue;
+		}
+
+		// Wildcard bans must still be written in wildcard form.
+		char szWritten[32] = "";
+		ClientIP readIP;
+		if( !ConvertClientIPToString( bannedIP, szWritten, LTARRAYSIZE( szWritten )) ||
+			!ConvertClientIPFromString( szWritten, readIP ) || 
+			( readIP < bannedIP ) || ( bannedIP < readIP ) || 
+			(( strchr( szBan, '*' ) != NULL ) != ( strchr( szWritten, '*' ) != NULL )))
+		{
+			if( nMismatches < knMaxPrintedMismatches )
+			{
+				g_pLTServer->CPrint( "BanIPCompatTest: '%s' was written as '%s'", szBan, szWritten );
+			}
+			++nMismatches;
+		}
+
+		lstLegacyBans.insert( lstLegacyBans.end( ), nLegacyPart, nLegacyPart + 4 );
+		banTrie.Insert( bannedIP.GetAddress( ), bannedIP.m_nPrefixLength );
+
+		// Add a CIDR ban on a random bit boundary near every fourth ban.
+		if(( iBan & 3 ) == 0 )
+		{
+			char szCIDR[32] = "";
+			LTSNPrintF( szCIDR, LTARRAYSIZE( szCIDR ), "%u.%u.%u.%u/%u", 
+				( uint32 )nLegacyPart[0], ( uint32 )( uint8 )( nSeed >> 8 ), ( uint32 )( uint8 )( nSeed >> 16 ), 
+				( uint32 )( uint8 )( nSeed >> 24 ), 8 + (( nSeed >> 3 ) % 25 ));
+
+			ClientIP cidrIP;
+			if( ConvertClientIPFromString( szCIDR, cidrIP ) && IsValidBan( cidrIP ))
+			{
+				lstCIDRBans.push_back( cidrIP );
+				cidrTrie.Insert( cidrIP.GetAddress( ), cidrIP.m_nPrefixLength );
+			}
+		}
+	}
+
+	// Check addresses inside the banned ranges, next to them and elsewhere.
+	uint32 nLegacyBans = ( uint32 )( lstLegacyBans.size( ) / 4 );
+	uint32 nAddresses = nBans * 20;
+	uint32 nBannedAddresses = 0;
+	for( uint32 iAddress = 0; iAddress < nAddresses; ++iAddress )
+	{
+		nSeed = nSeed * 1664525 + 1013904223;
+		uint32 nAddress = ( nSeed & 0x3F1F1F1F ) + 0x01000000;
+		if(( iAddress & 1 ) && nLegacyBans )
+		{
+			uint8 const* pnPart = &lstLegacyBans[( nSeed >> 5 ) % nLegacyBans * 4];
+			for( int i = 0; i < 4 && pnPart[i] != ( uint8 )-1; i++ )
+			{
+				nAddress = ( nAddress & ~( 0xFF000000 >> ( i * 8 ))) | (( uint32 )pnPart[i] << ( 24 - i * 8 ));
+			}
+		}
+
+		bool bLegacyBanned = false;
+		for( uint32 iBan = 0; iBan < nLegacyBans && !bLegacyBanned; ++iBan )
+		{
+			bLegacyBanned = LegacyIsBanned( &lstLegacyBans[iBan * 4], nAddress );
+		}
+
+		bool bCIDRBanned = false;
+		for( CIDRBanList::iterator iter = lstCIDRBans.begin( ); iter != lstCIDRBans.end( ) && !bCIDRBanned; iter++ )
+		{
+			bCIDRBanned = ((( nAddress ^ iter->GetAddress( )) & GetPrefixMask( iter->m_nPrefixLength )) == 0 );
+		}
+
+		if( bLegacyBanned )
+		{
+			++nBannedAddresses;
+		}
+
+		if(( banTrie.Contains( nAddress ) != bLegacyBanned ) || ( cidrTrie.Contains( nAddress ) != bCIDRBanned ))
+		{
+			if( nMismatches < knMaxPrintedMismatches )
+			{
+				g_pLTServer->CPrint( "BanIPCompatTest: %u.%u.%u.%u is %s/%s by the tries, %s/%s by the checks", 
+					nAddress >> 24, ( nAddress >> 16 ) & 0xFF, ( nAddress >> 8 ) & 0xFF, nAddress & 0xFF,
+					banTrie.Contains( nAddress ) ? "banned" : "allowed", cidrTrie.Contains( nAddress ) ? "banned" : "allowed",
+					bLegacyBanned ? "banned" : "allowed", bCIDRBanned ? "banned" : "allowed" );
+			}
+			++nMismatches;
+		}
+	}
+
+	g_pLTServer->CPrint( "BanIPCompatTest: %u old form and %u CIDR bans, %u addresses (%u banned), %u mismatches - %s", 
+		nLegacyBans, ( uint32 )lstCIDRBans.size( ), nAddresses, nBannedAddresses, nMismatches,
+		( nMismatches == 0 ) ? "PASSED" : "FAILED" );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	BanIPCompatTestCB()
+//
+//	PURPOSE:	Console program "BanIPCompatTest [<random bans>]".
+//
+// ----------------------------------------------------------------------- //
+
+static void BanIPCompatTestCB( int argc, char** argv )
+{
+	uint32 nBans = ( argc > 0 ) ? ( uint32 )atoi( argv[0] ) : 0;
+	BanIPMgr_Impl& banIPMgr = ( BanIPMgr_Impl& )BanIPMgr::Instance( );
+	banIPMgr.RunBanIPCompatTest( nBans );
+}
+
+#endif // _FINAL
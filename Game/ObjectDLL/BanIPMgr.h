@@ -33,7 +33,8 @@ class BanIPMgr
 
 	public:
 
-		// Defines the banned IP.
+		// Defines the banned IP.  A ban covers every address sharing the first
+		// m_nPrefixLength bits of m_nPart.  Parts past the prefix are zero.
 		struct ClientIP
 		{
 			// Used for sorting in std::set comparisons.
@@ -41,14 +42,22 @@ class BanIPMgr
 			{
 				for( int i = 0; i < 4; i++ )
 				{
-					if( m_nPart[i] < y.m_nPart[i] )
-						return true;
+					if( m_nPart[i] != y.m_nPart[i] )
+						return ( m_nPart[i] < y.m_nPart[i] );
 				}
 
-				return false;
+				return ( m_nPrefixLength < y.m_nPrefixLength );
+			}
+
+			// Gets the address as a 32 bit value, first part in the high bits.
+			uint32 GetAddress( ) const
+			{
+				return (( uint32 )m_nPart[0] << 24 ) | (( uint32 )m_nPart[1] << 16 ) | 
+					(( uint32 )m_nPart[2] << 8 ) | ( uint32 )m_nPart[3];
 			}
 
 			uint8	m_nPart[4];
+			uint8	m_nPrefixLength;
 		};
 
 		// Type for list of banned ip's.
@@ -83,7 +92,12 @@ class BanIPMgr
 		// Get the list of bans.
 		virtual BanList const& GetBanList( ) = 0;
 
-		// Converts a string to a ClientIP.
+		// Rereads the ban file.  The current bans are only replaced if the
+		// whole file is read successfully.
+		virtual bool ReloadBans( ) = 0;
+
+		// Converts a string to a ClientIP.  Accepts full addresses, trailing
+		// wildcards ("10.1.*") and CIDR prefixes ("10.1.0.0/16").
 		static bool ConvertClientIPFromString( char const* pszClientIP, ClientIP& bannedIP );
 
 		// Converts a ClientIP to a string.
@@ -16,6 +16,7 @@
 #include "PlayerObj.h"
 #include "EngineTimer.h"
 #include "GameModeMgr.h"
+#include "lttimeutils.h"
 
 CCommandMgr* g_pCmdMgr = NULL;
 
@@ -26,6 +27,15 @@ extern VarTrack	g_ShowMessagesFilter;
 
 static TCmdMgr_ClassDescArray *s_pVecClassDesc = NULL;
 
+// Open addressed table of the class descriptions, keyed by the class name hash.
+// Built from s_pVecClassDesc on the first lookup after a class registers...
+static TCmdMgr_ClassDescArray s_aClassDescTable;
+static uint32 s_nClassDescTableCount = 0;
+
+#ifndef _FINAL
+static void CommandMgrBenchmarkCB( int argc, char** argv );
+#endif // _FINAL
+
 #define INITIAL_CMDS_PER_FRAME	32
 #define INITIAL_PENDING_CMDS	16
 #define INITIAL_SCRIPT_CMDS		8
@@ -557,6 +567,44 @@ static eExpressionVal CheckExpression( ConParse &cpExpression )
 	return kExpress_ERROR;
 }
 
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	BuildClassDescTable
+//
+//  PURPOSE:	Fill the class description lookup table from the registered classes
+//
+// ----------------------------------------------------------------------- //
+
+static void BuildClassDescTable( )
+{
+	// Keep the table at most half full so searches stay short...
+	uint32 nTableSize = 16;
+	while( nTableSize < s_pVecClassDesc->size() * 2 )
+	{
+		nTableSize <<= 1;
+	}
+
+	s_aClassDescTable.clear( );
+	s_aClassDescTable.resize( nTableSize, NULL );
+	uint32 nMask = nTableSize - 1;
+
+	TCmdMgr_ClassDescArray::iterator iter;
+	for( iter = s_pVecClassDesc->begin(); iter != s_pVecClassDesc->end(); ++iter )
+	{
+		CCmdMgr_ClassDesc *pClassDesc = *iter;
+
+		uint32 nSlot = pClassDesc->m_cTok_ClassName.GetHashKey() & nMask;
+		while( s_aClassDescTable[nSlot] )
+		{
+			nSlot = (nSlot + 1) & nMask;
+		}
+
+		s_aClassDescTable[nSlot] = pClassDesc;
+	}
+
+	s_nClassDescTableCount = s_pVecClassDesc->size();
+}
+
 // ----------------------------------------------------------------------- //
 //
 //  ROUTINE:	GetCmdmgrClassDescription
@@ -570,17 +618,26 @@ CCmdMgr_ClassDesc *GetCmdmgrClassDescription( const char *pClassName )
 	if( !pClassName || !s_pVecClassDesc )
 		return NULL;
 
-	CCmdMgr_ClassDesc	*pClassDesc;
+	// Rebuild the lookup table if classes have registered since it was last built...
+	if( s_nClassDescTableCount != s_pVecClassDesc->size() )
+	{
+		BuildClassDescTable( );
+	}
+
 	CParsedMsg::CToken	cTok_ClassName( pClassName );
-    
-	TCmdMgr_ClassDescArray::iterator iter;
-	for( iter = s_pVecClassDesc->begin(); iter != s_pVecClassDesc->end(); ++iter )
+	uint32 nMask = s_aClassDescTable.size() - 1;
+	uint32 nSlot = cTok_ClassName.GetHashKey() & nMask;
+
+	// Search until an empty slot is found...
+	while( s_aClassDescTable[nSlot] )
 	{
-		pClassDesc = *iter;
+		CCmdMgr_ClassDesc *pClassDesc = s_aClassDescTable[nSlot];
 		if( pClassDesc->m_cTok_ClassName == cTok_ClassName )
 		{
 			return pClassDesc;	
 		}
+
+		nSlot = (nSlot + 1) & nMask;
 	}
 
 	return NULL;
@@ -628,7 +685,14 @@ uint32 GetNumCmdmgrClassDescriptions()
 
 CCmdMgr_ClassDesc::CCmdMgr_ClassDesc( const char *pClassName, const char *pParentClass, uint32 nNumMsgs,
 									 CCmdMgr_MsgDesc *pMsgs, uint32 dwFlags, THandleMsgFn pHandleFn )
-:	ICommandClassDef( pClassName, pParentClass, nNumMsgs )
+:	ICommandClassDef			( pClassName, pParentClass, nNumMsgs ),
+	m_pMsgs						( NULL ),
+	m_dwFlags					( 0 ),
+	m_pHandleFn					( NULL ),
+	m_nMsgTableMultiplier		( 0 ),
+	m_nMsgTableShift			( 0 ),
+	m_pParentClassDesc			( NULL ),
+	m_bParentClassDescResolved	( false )
 {
 	if( nNumMsgs < CMDMGR_MIN_CLASSMSGS )
 		return;
@@ -645,11 +709,149 @@ CCmdMgr_ClassDesc::CCmdMgr_ClassDesc( const char *pClassName, const char *pParen
 	m_dwFlags			= dwFlags;
 	m_pHandleFn			= pHandleFn;
 
+	BuildMsgTable( );
+
 	// Add the class description.
 
 	s_vecClassDesc.push_back( this );
 }
 
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CCmdMgr_ClassDesc::BuildMsgTable
+//
+//  PURPOSE:	Find a multiplier that gives each message of the class its own
+//				slot in the dispatch table.  This runs at static init for every
+//				class, so the message descriptions are already constructed.
+//
+// ----------------------------------------------------------------------- //
+
+void CCmdMgr_ClassDesc::BuildMsgTable( )
+{
+	m_aMsgTable.clear( );
+
+	if( !m_pMsgs || m_nNumMsgs <= CMDMGR_MIN_CLASSMSGS || m_nNumMsgs > 0xFFFF )
+		return;
+
+	// A message declared more than once is only ever handled by its first
+	// declaration, so only that one goes in the table.  Different names with
+	// the same hash key can never get separate slots, so those classes are searched...
+	for( uint32 nMsg = CMDMGR_MIN_CLASSMSGS; nMsg < m_nNumMsgs; ++nMsg )
+	{
+		for( uint32 nOther = CMDMGR_MIN_CLASSMSGS; nOther < nMsg; ++nOther )
+		{
+			if( (m_pMsgs[nMsg].m_cTok_MsgName.GetHashKey() == m_pMsgs[nOther].m_cTok_MsgName.GetHashKey()) &&
+				(m_pMsgs[nMsg].m_cTok_MsgName != m_pMsgs[nOther].m_cTok_MsgName) )
+			{
+				return;
+			}
+		}
+	}
+
+	// Start with a table about twice the number of messages and grow it until
+	// one of the candidate multipliers maps the messages without collisions...
+	const uint32 kMaxMultipliers = 256;
+	const uint32 kMaxTableBits = 16;
+
+	uint32 nTableBits = 1;
+	while( (1U << nTableBits) < (m_nNumMsgs - CMDMGR_MIN_CLASSMSGS) * 2 )
+	{
+		++nTableBits;
+	}
+
+	for( ; nTableBits <= kMaxTableBits; ++nTableBits )
+	{
+		uint32 nShift = 32 - nTableBits;
+		m_aMsgTable.resize( 1 << nTableBits );
+
+		// Odd multipliers spread from the golden ratio...
+		uint32 nMultiplier = 0x9E3779B1;
+		for( uint32 nTry = 0; nTry < kMaxMultipliers; ++nTry, nMultiplier += 0x7F4A7C16 )
+		{
+			std::fill( m_aMsgTable.begin(), m_aMsgTable.end(), 0 );
+
+			bool bPerfect = true;
+			for( uint32 nMsg = CMDMGR_MIN_CLASSMSGS; nMsg < m_nNumMsgs; ++nMsg )
+			{
+				uint32 nSlot = (m_pMsgs[nMsg].m_cTok_MsgName.GetHashKey() * nMultiplier) >> nShift;
+				if( m_aMsgTable[nSlot] == 0 )
+				{
+					m_aMsgTable[nSlot] = (uint16)nMsg;
+				}
+				else if( m_pMsgs[m_aMsgTable[nSlot]].m_cTok_MsgName != m_pMsgs[nMsg].m_cTok_MsgName )
+				{
+					bPerfect = false;
+					break;
+				}
+			}
+
+			if( bPerfect )
+			{
+				m_nMsgTableMultiplier = nMultiplier;
+				m_nMsgTableShift = nShift;
+				return;
+			}
+		}
+	}
+
+	// Fall back to searching the messages...
+	m_aMsgTable.clear( );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CCmdMgr_ClassDesc::FindMsg
+//
+//  PURPOSE:	Find the message description for the message name in this class
+//
+// ----------------------------------------------------------------------- //
+
+const CCmdMgr_MsgDesc* CCmdMgr_ClassDesc::FindMsg( const CParsedMsg::CToken &cTok_MsgName ) const
+{
+	if( !m_pMsgs )
+		return NULL;
+
+	if( !m_aMsgTable.empty() )
+	{
+		uint32 nMsg = m_aMsgTable[(cTok_MsgName.GetHashKey() * m_nMsgTableMultiplier) >> m_nMsgTableShift];
+		if( nMsg && (cTok_MsgName == m_pMsgs[nMsg].m_cTok_MsgName) )
+		{
+			return &m_pMsgs[nMsg];
+		}
+
+		return NULL;
+	}
+
+	for( uint32 nMsg = CMDMGR_MIN_CLASSMSGS; nMsg < m_nNumMsgs; ++nMsg )
+	{
+		if( cTok_MsgName == m_pMsgs[nMsg].m_cTok_MsgName )
+		{
+			return &m_pMsgs[nMsg];
+		}
+	}
+
+	return NULL;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CCmdMgr_ClassDesc::GetParentClassDesc
+//
+//  PURPOSE:	Get the description of the parent class
+//
+// ----------------------------------------------------------------------- //
+
+CCmdMgr_ClassDesc* CCmdMgr_ClassDesc::GetParentClassDesc( ) const
+{
+	if( !m_bParentClassDescResolved )
+	{
+		m_pParentClassDesc = GetCmdmgrClassDescription( m_cTok_ParentClass.c_str() );
+		m_bParentClassDescResolved = true;
+	}
+
+	return m_pParentClassDesc;
+}
+
 // ----------------------------------------------------------------------- //
 //
 //	ROUTINE:	CCommandMgr::CCommandMgr()
@@ -667,6 +869,13 @@ CCommandMgr::CCommandMgr()
 	g_pCmdMgr = this;
 
 	Init( );
+
+#ifndef _FINAL
+	if( g_pLTServer )
+	{
+		g_pLTServer->RegisterConsoleProgram( "CommandMgrBenchmark", CommandMgrBenchmarkCB );
+	}
+#endif // _FINAL
 }
 
 // ----------------------------------------------------------------------- //
@@ -682,6 +891,13 @@ CCommandMgr::~CCommandMgr()
     g_pCmdMgr = NULL;
 
 	Term( );
+
+#ifndef _FINAL
+	if( g_pLTServer )
+	{
+		g_pLTServer->UnregisterConsoleProgram( "CommandMgrBenchmark" );
+	}
+#endif // _FINAL
 }
 
 // ----------------------------------------------------------------------- //
@@ -1080,18 +1296,111 @@ static void ParseMsg_Target(char *pName, char **pResultClass, char **pResultName
 	*pResultName = pClassEnd + 1;
 }
 
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ParseMsgArgs()
+//
+//	PURPOSE:	Parse the message of a message command into its name and
+//				arguments.  Fills nothing in for other commands...
+//
+// ----------------------------------------------------------------------- //
+
+static bool ParseMsgArgs( const CParsedMsg::CToken &cTok_CmdName, const StringArray &saArgs, StringArray &saMsgArgs )
+{
+	static CParsedMsg::CToken s_cTok_Msg( "MSG" );
+	static CParsedMsg::CToken s_cTok_VMsg( "VMSG" );
+
+	saMsgArgs.resize( 0 );
+
+	if( (cTok_CmdName != s_cTok_Msg) && (cTok_CmdName != s_cTok_VMsg) )
+		return false;
+
+	if( saArgs.size() < 2 || saArgs[1].empty() )
+		return false;
+
+	ConParse cpMsg( saArgs[1].c_str() );
+	if( g_pCommonLT->Parse( &cpMsg ) != LT_OK )
+		return false;
+	
+	// Ignore any empty messages...
+	if( (cpMsg.m_nArgs == 0) || !cpMsg.m_Args[0] )
+		return false;
+
+	saMsgArgs.resize( cpMsg.m_nArgs );
+	for( int nArg = 0; nArg < cpMsg.m_nArgs; ++nArg )
+	{
+		saMsgArgs[nArg] = cpMsg.m_Args[nArg] ? cpMsg.m_Args[nArg] : "";
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CParsedCmd::ParseMsg()
+//
+//	PURPOSE:	Parse the message of a message command...
+//
+// ----------------------------------------------------------------------- //
+
+void CParsedCmd::ParseMsg( )
+{
+	ParseMsgArgs( m_cTok_CmdName, m_saArgs, m_saMsgArgs );
+	InitParsedMsg( );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CParsedCmd::SetMsgArgs()
+//
+//	PURPOSE:	Use message arguments that were already parsed...
+//
+// ----------------------------------------------------------------------- //
+
+void CParsedCmd::SetMsgArgs( const StringArray &saMsgArgs )
+{
+	// Assign each string so the buffers of a recycled command are reused...
+	m_saMsgArgs.resize( saMsgArgs.size() );
+	for( uint32 nArg = 0; nArg < saMsgArgs.size(); ++nArg )
+	{
+		m_saMsgArgs[nArg] = saMsgArgs[nArg];
+	}
+
+	InitParsedMsg( );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CParsedCmd::InitParsedMsg()
+//
+//	PURPOSE:	Point the parsed message tokens at the message arguments...
+//
+// ----------------------------------------------------------------------- //
+
+void CParsedCmd::InitParsedMsg( )
+{
+	const char *aArgs[PARSE_MAXTOKENS];
+	uint32 nNumArgs = LTMIN( (uint32)m_saMsgArgs.size(), (uint32)PARSE_MAXTOKENS );
+	for( uint32 nArg = 0; nArg < nNumArgs; ++nArg )
+	{
+		aArgs[nArg] = m_saMsgArgs[nArg].c_str();
+	}
+
+	m_cParsedMsg.Init( nNumArgs, aArgs );
+}
+
 // ----------------------------------------------------------------------- //
 //
 //	ROUTINE:	CCommandMgr::SendMessageToObject()
 //
 //	PURPOSE:	Using the class description of the object let the target
-//				target handle the message.
+//				target handle the already parsed message.
 //
 // ----------------------------------------------------------------------- //
 
-bool CCommandMgr::SendMessageToObject( ILTBaseClass *pSender, ILTBaseClass *pTarget, const char *pszMsg )
+bool CCommandMgr::SendMessageToObject( ILTBaseClass *pSender, ILTBaseClass *pTarget, const CParsedMsg &cParsedMsg )
 {
-	if( !pTarget || !pszMsg || !pszMsg[0] )
+	if( !pTarget || (cParsedMsg.GetArgCount() == 0) )
 		return false;
 	
 	if( !IsGameBase( pTarget->m_hObject ))
@@ -1122,26 +1431,12 @@ bool CCommandMgr::SendMessageToObject( ILTBaseClass *pSender, ILTBaseClass *pTar
 		return false;
 	}
 
-	// Parse the message into its name and arguments and let the object handle the 
-	// message if it's valid...
-
-	ConParse cpMsg( pszMsg );
-	if( g_pCommonLT->Parse( &cpMsg ) != LT_OK )
-	{
-		DevPrint( "ERROR - SendMessageToObject: Could not parse message %s", pszMsg );
-		return false;
-	}
-	
-	// Ignore any empty messages...
-	if( (cpMsg.m_nArgs == 0) || !cpMsg.m_Args[0] )
-	{
-		DevPrint( "ERROR - SendMessageToObject: Empty message encountered." );
-		return false;
-	}
-
 	// Show debug information for the message...
 	if( g_ShowMessagesTrack.GetFloat() != 0.0f )
 	{
+		char szMsg[CMDMGR_MAX_COMMAND_LENGTH] = {0};
+		cParsedMsg.ReCreateMsg( szMsg, LTARRAYSIZE(szMsg), 0 );
+
 		char szTargetName[256] = {0};
 		const char *pszTargetName = NULL;
 
@@ -1170,22 +1465,19 @@ bool CCommandMgr::SendMessageToObject( ILTBaseClass *pSender, ILTBaseClass *pTar
 		bool bPrintMsg = (!pFilter || !pFilter[0]);
 		if( !bPrintMsg )
 		{
-			bPrintMsg = (pszMsg ? LTSubStrIEquals( pFilter, pszMsg, LTStrLen(pszMsg) ) : true);
+			bPrintMsg = LTSubStrIEquals( pFilter, szMsg, LTStrLen(szMsg) );
 		}
 
 		if (bPrintMsg)
 		{
 			g_pLTServer->CPrint(" ");
-			g_pLTServer->CPrint("Message:    %s", pszMsg ? pszMsg : "NULL");
+			g_pLTServer->CPrint("Message:    %s", szMsg);
 			g_pLTServer->CPrint("Sent from: '%s' to '%s'", pszSenderName, pszTargetName ? pszTargetName : "OBJECT NOT FOUND");
 			g_pLTServer->CPrint(" ");
 		}
 
 	}
 
-	// Set up a Parsed message...
-	CParsedMsg cParsedMsg( cpMsg.m_nArgs, cpMsg.m_Args );
-
 	// Look for the message name within the targets class description.  If the message is not
 	// found, check the parent class messages...
 
@@ -1195,7 +1487,7 @@ bool CCommandMgr::SendMessageToObject( ILTBaseClass *pSender, ILTBaseClass *pTar
 		if( CallMessageHandler( pTargetClassDesc, pSender, pTarget, NULL, cParsedMsg ))
 			break;
 
-		pTargetClassDesc = GetCmdmgrClassDescription( pTargetClassDesc->m_cTok_ParentClass.c_str() );
+		pTargetClassDesc = pTargetClassDesc->GetParentClassDesc( );
 	}
 
 	// The message now meeds to be sent to all of the object's aggregates to handle...
@@ -1212,7 +1504,7 @@ bool CCommandMgr::SendMessageToObject( ILTBaseClass *pSender, ILTBaseClass *pTar
 				if( CallMessageHandler( pTargetClassDesc, pSender, pTarget, pAggregate, cParsedMsg ))
 					break;
 
-				pTargetClassDesc = GetCmdmgrClassDescription( pTargetClassDesc->m_cTok_ParentClass.c_str() );
+				pTargetClassDesc = pTargetClassDesc->GetParentClassDesc( );
 			}
 		}
 		else
@@ -1248,75 +1540,73 @@ bool CCommandMgr::CallMessageHandler( const CCmdMgr_ClassDesc *pClassDesc, ILTBa
 		pClassDesc->m_pHandleFn( (pSender ? pSender->m_hObject : NULL), pTargetObj, pTargetAgg, cParsedMsg );
 	}
 
-	CCmdMgr_MsgDesc *pTargetMsgs = pClassDesc->m_pMsgs;
-	if( !pTargetMsgs )
+	if( !pClassDesc->m_pMsgs )
 		return false;
 
 	GameBase *pGameObj = dynamic_cast<GameBase*>(pTargetObj);
 	if( !pGameObj )
 		return false;
 		
-	CParsedMsg::CToken cTok_MsgName( cParsedMsg.GetArg(0) );
+	const CParsedMsg::CToken &cTok_MsgName = cParsedMsg.GetArg(0);
 	int32 nArgCount = cParsedMsg.GetArgCount();
 
 	bool bWasScripted = false;
 
-	for( uint32 nMsg = CMDMGR_MIN_CLASSMSGS; nMsg <= pClassDesc->m_nNumMsgs; ++nMsg )
+	// Look the message up in the class dispatch table...
+	const CCmdMgr_MsgDesc *pMsgDesc = pClassDesc->FindMsg( cTok_MsgName );
+	if( pMsgDesc )
 	{
-		if( cTok_MsgName == pTargetMsgs[nMsg].m_cTok_MsgName )
+		// Make sure the message is valid and then let the object handle it...
+
+		// TODO: Send to a validate function?
+		if( (pMsgDesc->m_nMinArgs < 0) ||
+			((nArgCount >= pMsgDesc->m_nMinArgs) &&
+			(nArgCount <= pMsgDesc->m_nMaxArgs)) )
 		{
-			// Make sure the message is valid and then let the object handle it...
+			if( !pMsgDesc->m_pHandleFn )
+			{
+				DevPrint( "ERROR - Msg %s in class %s does not have a handler function!", cTok_MsgName.c_str(), pClassDesc->m_cTok_ClassName.c_str() );
+				return false;
+			}
 
-			// TODO: Send to a validate function?
-			if( (pTargetMsgs[nMsg].m_nMinArgs < 0) ||
-				((nArgCount >= pTargetMsgs[nMsg].m_nMinArgs) &&
-				(nArgCount <= pTargetMsgs[nMsg].m_nMaxArgs)) )
+			// If the object is currently being scripted then we must interupt the script...
+			if( pGameObj->IsScripted() )
 			{
-				if( !pTargetMsgs[nMsg].m_pHandleFn )
-				{
-					DevPrint( "ERROR - Msg %s in class %s does not have a handler function!", cTok_MsgName.c_str(), pClassDesc->m_cTok_ClassName.c_str() );
-					return false;
-				}
+				bWasScripted = true;
+				pGameObj->InterruptScript();
+			}
+			
+			if( bWasScripted )
+			{
+				// The object was scripted so we need to kill every 
+				// script that the object was being scripted by...
 
-				// If the object is currently being scripted then we must interupt the script...
-				if( pGameObj->IsScripted() )
+				CCmdScript *pCmdScript = NULL;
+				TCmdScriptArray::iterator iter;
+				for( iter = m_CmdScripts.begin(); iter != m_CmdScripts.end(); ++iter )
 				{
-					bWasScripted = true;
-					pGameObj->InterruptScript();
-				}
-				
-				if( bWasScripted )
-				{
-					// The object was scripted so we need to kill every 
-					// script that the object was being scripted by...
-
-					CCmdScript *pCmdScript = NULL;
-					TCmdScriptArray::iterator iter;
-					for( iter = m_CmdScripts.begin(); iter != m_CmdScripts.end(); ++iter )
+					pCmdScript = *iter;
+					if( pCmdScript->m_pScriptedObj == pTargetObj )
 					{
-						pCmdScript = *iter;
-						if( pCmdScript->m_pScriptedObj == pTargetObj )
-						{
-							pCmdScript->Kill();
-						}
+						pCmdScript->Kill();
 					}
 				}
+			}
 
-				// When the message is a blocking message, the objet is about to begin scripting...
-				if( pTargetMsgs[nMsg].m_dwFlags & CMDMGR_MF_BLOCKINGMSG )
-				{
-					pGameObj->SetScripted();
-				}
-
-				pTargetMsgs[nMsg].m_pHandleFn( (pSender ? pSender->m_hObject : NULL), pTargetObj, pTargetAgg, cParsedMsg );
-
-				// The message was found in the class so stop looking...
-				return true;
+			// When the message is a blocking message, the objet is about to begin scripting...
+			if( pMsgDesc->m_dwFlags & CMDMGR_MF_BLOCKINGMSG )
+			{
+				pGameObj->SetScripted();
 			}
 
-			DevPrint( "ERROR - Invalid number of arguments for message %s", cTok_MsgName.c_str() );
-			return false;
+			pMsgDesc->m_pHandleFn( (pSender ? pSender->m_hObject : NULL), pTargetObj, pTargetAgg, cParsedMsg );
+
+			// The message was found in the class so stop looking...
+			return true;
 		}
+
+		DevPrint( "ERROR - Invalid number of arguments for message %s", cTok_MsgName.c_str() );
+		return false;
 	}
 
 	// No error, the message just wasn't in this class description... 
@@ -1340,6 +1630,15 @@ bool CCommandMgr::ProcessMsg( const CParsedCmd *pParsedCmd, bool bObjVar)
     if( !pObjectNames || !pMsg )
 		return false;
 
+	// The message was parsed when the command was queued...
+	const CParsedMsg &cParsedMsg = pParsedCmd->GetParsedMsg( );
+	if( cParsedMsg.GetArgCount() == 0 )
+	{
+		DevPrint( "CCommandMgr::ProcessMsg() ERROR!" );
+		DevPrint( "    Could not parse message '%s'!", pMsg );
+		return false;
+	}
+
 	// If the sender is a player, then store it
 	// as the ActivePlayer.  Triggers can now be sent to an object called "ActivePlayer"
 	// and it will go to this object.  Triggers sent to "OtherPlayers" will go
@@ -1386,7 +1685,7 @@ bool CCommandMgr::ProcessMsg( const CParsedCmd *pParsedCmd, bool bObjVar)
 
 					// Send the message
 					bResult = true;
-					SendMessageToObject( m_pActiveSender, pVar->m_pObjVal, pMsg );
+					SendMessageToObject( m_pActiveSender, pVar->m_pObjVal, cParsedMsg );
 				}
 				else
 				{
@@ -1424,7 +1723,7 @@ bool CCommandMgr::ProcessMsg( const CParsedCmd *pParsedCmd, bool bObjVar)
 						for( uint32 nObj = 0; nObj < nNumObjects; ++nObj )
 						{
 							ILTBaseClass *pTargetObj = g_pLTServer->HandleToObject( objArray.GetObject(nObj) );
-							SendMessageToObject( m_pActiveSender, pTargetObj, pMsg );
+							SendMessageToObject( m_pActiveSender, pTargetObj, cParsedMsg );
 						}
 					}
 										
@@ -2428,6 +2727,64 @@ bool CCommandMgr::AddPendingCommand( const CPendingCmd &crPendingCmd )
 	return true;
 }
 
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CCommandMgr::GetFreeParsedCmd()
+//
+//	PURPOSE:	Get a free command from the pool, allocating one if needed...
+//
+// ----------------------------------------------------------------------- //
+
+CParsedCmd* CCommandMgr::GetFreeParsedCmd( )
+{
+	// See if a new command needs to be allocated...
+	if( m_CommandPool.empty() )
+	{
+		CParsedCmd *pNewCmd = debug_new( CParsedCmd );
+		if( pNewCmd )
+		{
+			m_CommandPool.push_back( pNewCmd );
+			++m_dwCommandAllocations;
+		}
+	}
+
+	LTASSERT( !m_CommandPool.empty(), "Failed to allocate new CParsedCmd on to pool!" );
+	if( m_CommandPool.empty() )
+		return NULL;
+
+	return m_CommandPool.back();
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CCommandMgr::QueueParsedCmd()
+//
+//	PURPOSE:	Move the command from the pool on to a queue...
+//
+// ----------------------------------------------------------------------- //
+
+void CCommandMgr::QueueParsedCmd( CParsedCmd *pParsedCmd, ILTBaseClass *pSender, ILTBaseClass *pTarget )
+{
+	LTASSERT( !m_CommandPool.empty() && (m_CommandPool.back() == pParsedCmd), "Queueing a command that is not the free command!" );
+
+	pParsedCmd->SetActiveSender( pSender );
+	pParsedCmd->SetActiveTarget( pTarget );
+
+	if( m_bCommandQueueLocked )
+	{
+		// When the main command queue is locked add it to the secondary...
+		m_SecondaryQueue.push_back( pParsedCmd );
+	}
+	else
+	{
+		// The queue is not locked so add it...
+		m_CommandQueue.push_back( pParsedCmd );
+	}
+
+	// Remove it form the pool...
+	m_CommandPool.pop_back();
+}
+
 // ----------------------------------------------------------------------- //
 //
 //	ROUTINE:	CCommandMgr::QueueCommand()
@@ -2451,28 +2808,10 @@ bool CCommandMgr::QueueCommand( const char *pszCommand, ILTBaseClass *pSender, I
 	{
 		if( cpCommand.m_nArgs > 0 )
 		{
-			// See if a new command needs to be allocated...
-			if( m_CommandPool.empty() )
-			{
-				CParsedCmd *pNewCmd = debug_new( CParsedCmd );
-				if( pNewCmd )
-				{
-					m_CommandPool.push_back( pNewCmd );
-					++m_dwCommandAllocations;
-				}
-			}
-
-			LTASSERT( !m_CommandPool.empty(), "Failed to allocate new CParsedCmd on to pool!" );
-			if( m_CommandPool.empty() )
-				continue;
-
 			// Grab a free command from the pool...
-			pParsedCmd = m_CommandPool.back();
+			pParsedCmd = GetFreeParsedCmd( );
 			if( !pParsedCmd )
-			{
-				LTERROR( "CCommandMgr::QueueCommand() - Failed to create new CParsedCmd." );
-				return false;
-			}
+				continue;
 
 			// Save the pre-parsed command name...
 			pParsedCmd->SetCommandName( cpCommand.m_Args[0] );
@@ -2497,29 +2836,98 @@ bool CCommandMgr::QueueCommand( const char *pszCommand, ILTBaseClass *pSender, I
 			}
 
 			// The command is valid, finish initializing it and push it on a queue...
+			pParsedCmd->ParseMsg( );
+			QueueParsedCmd( pParsedCmd, pSender, pTarget );
+		}
+	}
 
-			pParsedCmd->SetActiveSender( pSender );
-			pParsedCmd->SetActiveTarget( pTarget );
+	return true;
+}
 
-			if( m_bCommandQueueLocked )
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CCommandMgr::ParseCommandList()
+//
+//	PURPOSE:	Break the command string into its commands once, so it can be
+//				queued many times without being parsed again...
+//
+// ----------------------------------------------------------------------- //
+
+bool CCommandMgr::ParseCommandList( const char *pszCommand, CParsedCmdList &cmdList )
+{
+	cmdList.Clear( );
+	cmdList.m_bParsed = true;
+
+	if( !pszCommand || !pszCommand[0] )
+		return false;
+
+	// Validate each command the same way queueing the string would...
+	CParsedCmd cParsedCmd;
+	ConParse cpCommand( pszCommand );
+	
+	while( g_pCommonLT->Parse( &cpCommand ) == LT_OK )
+	{
+		if( cpCommand.m_nArgs > 0 )
+		{
+			cParsedCmd.SetCommandName( cpCommand.m_Args[0] );
+
+			uint32 nNumArgs = cpCommand.m_nArgs - 1;
+			cParsedCmd.m_saArgs.resize( nNumArgs );
+			for( uint32 nArg = 0; nArg < nNumArgs; ++nArg )
 			{
-				// When the main command queue is locked add it to the secondary...
-				m_SecondaryQueue.push_back( pParsedCmd );
+				cParsedCmd.m_saArgs[nArg] = cpCommand.m_Args[nArg + 1];
 			}
-			else
+
+			if( !ValidateParsedCmd( &cParsedCmd, !GLOBAL ))
 			{
-				// The queue is not locked so add it...
-				m_CommandQueue.push_back( pParsedCmd );
+				DevPrint( "Failed to validate command: %s", cpCommand.m_Args[0] );
+				return false;
 			}
 
-			// Remove it form the pool...
-			m_CommandPool.pop_back();
+			cmdList.m_lstCmds.push_back( CParsedCmdList::ParsedCmdDesc() );
+			CParsedCmdList::ParsedCmdDesc &cmdDesc = cmdList.m_lstCmds.back();
+			cmdDesc.m_sCmdName = cpCommand.m_Args[0];
+			cmdDesc.m_saArgs = cParsedCmd.m_saArgs;
+			ParseMsgArgs( cParsedCmd.m_cTok_CmdName, cParsedCmd.m_saArgs, cmdDesc.m_saMsgArgs );
 		}
 	}
 
 	return true;
 }
 
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CCommandMgr::QueueCommand()
+//
+//	PURPOSE:	Queue pre-parsed commands for later processing...
+//
+// ----------------------------------------------------------------------- //
+
+bool CCommandMgr::QueueCommand( const CParsedCmdList &cmdList, ILTBaseClass *pSender, ILTBaseClass *pTarget )
+{
+	CParsedCmdList::TParsedCmdDescArray::const_iterator iter;
+	for( iter = cmdList.m_lstCmds.begin(); iter != cmdList.m_lstCmds.end(); ++iter )
+	{
+		CParsedCmd *pParsedCmd = GetFreeParsedCmd( );
+		if( !pParsedCmd )
+			return false;
+
+		// Copy each string so the buffers of a recycled command are reused...
+		const CParsedCmdList::ParsedCmdDesc &cmdDesc = *iter;
+		pParsedCmd->SetCommandName( cmdDesc.m_sCmdName.c_str() );
+		pParsedCmd->m_saArgs.resize( cmdDesc.m_saArgs.size() );
+		for( uint32 nArg = 0; nArg < cmdDesc.m_saArgs.size(); ++nArg )
+		{
+			pParsedCmd->m_saArgs[nArg] = cmdDesc.m_saArgs[nArg];
+		}
+		pParsedCmd->SetMsgArgs( cmdDesc.m_saMsgArgs );
+
+		QueueParsedCmd( pParsedCmd, pSender, pTarget );
+	}
+
+	return true;
+}
+
 // ----------------------------------------------------------------------- //
 //
 //	ROUTINE:	CCommandMgr::QueueMessage()
@@ -2538,10 +2946,25 @@ bool CCommandMgr::QueueMessage( ILTBaseClass *pSender, ILTBaseClass *pTarget, co
 	char szTargetName[128] = {0};
 	g_pLTServer->GetObjectName( pTarget->m_hObject, szTargetName, LTARRAYSIZE(szTargetName) );
 	
-	// Develop a message command to queue...
-	char szCmd[512] = {0};
-	LTSNPrintF( szCmd, LTARRAYSIZE(szCmd), "msg %s (%s)", szTargetName, pszMessage );
-	if( !QueueCommand( szCmd, pSender, pTarget ))
+	// Set up the message command directly rather than building a command string
+	// that would just be parsed back into the same arguments...
+	CParsedCmd *pParsedCmd = GetFreeParsedCmd( );
+	if( !pParsedCmd )
+		return false;
+
+	pParsedCmd->SetCommandName( "msg" );
+	pParsedCmd->m_saArgs.resize( 2 );
+	pParsedCmd->m_saArgs[0] = szTargetName;
+	pParsedCmd->m_saArgs[1] = pszMessage;
+
+	bool bValid = ValidateParsedCmd( pParsedCmd, !GLOBAL );
+	if( bValid )
+	{
+		pParsedCmd->ParseMsg( );
+		bValid = (pParsedCmd->GetParsedMsg().GetArgCount() > 0);
+	}
+
+	if( !bValid )
 	{
 		DevPrint( "CCommandMgr::QueueMessage() ERROR!" );
 		DevPrint( "    Message, %s, is invalid.", pszMessage );
@@ -2549,6 +2972,8 @@ bool CCommandMgr::QueueMessage( ILTBaseClass *pSender, ILTBaseClass *pTarget, co
 		return false;
 	}
 
+	QueueParsedCmd( pParsedCmd, pSender, pTarget );
+
 	return true;
 }
 
@@ -2596,6 +3021,7 @@ bool CCommandMgr::AddGlobalCommand( const char *pszCommand, ILTBaseClass *pSende
 			}
 
 			ParsedCmd.m_bGlobal = true;
+			ParsedCmd.ParseMsg( );
 			
 			// The command is valid, finish initializing it and immediately process it...
 			ParsedCmd.SetActiveSender( pSender );
@@ -2930,26 +3356,11 @@ void CCommandMgr::Load( ILTMessage_Read *pMsg )
 	CParsedCmd *pParsedCmd = NULL;
 	for( uint32 nCommand = 0; nCommand < nNumCommands; ++nCommand )
 	{
-		// See if a new command needs to be allocated...
-		if( m_CommandPool.empty() )
-		{
-			CParsedCmd *pNewCmd = debug_new( CParsedCmd );
-			if( pNewCmd )
-			{
-				m_CommandPool.push_back( pNewCmd );
-				++m_dwCommandAllocations;
-			}
-		}
-
-		LTASSERT( !m_CommandPool.empty(), "Failed to allocate new CParsedCmd on to pool!" );
-		if( m_CommandPool.empty() )
-			continue;
-
 		// Grab a free command from the pool...
-		pParsedCmd = m_CommandPool.back();
+		pParsedCmd = GetFreeParsedCmd( );
 		if( !pParsedCmd )
 		{
-			LTERROR( "CCommandMgr::QueueCommand() - Failed to create new CParsedCmd." );
+			LTERROR( "CCommandMgr::Load() - Failed to create new CParsedCmd." );
 			return;
 		}
 
@@ -3418,24 +3829,21 @@ void CCmdScript::Update()
 
 					while( pTargetClassDesc && !bMsgFound )
 					{
-						for( uint32 nMsg = CMDMGR_MIN_CLASSMSGS; nMsg <= pTargetClassDesc->m_nNumMsgs; ++nMsg )
+						const CCmdMgr_MsgDesc *pMsgDesc = pTargetClassDesc->FindMsg( cTok_MsgName );
+						if( pMsgDesc )
 						{
-							if( cTok_MsgName == pTargetClassDesc->m_pMsgs[nMsg].m_cTok_MsgName )
+							// See if this is a blocking message...
+							if( pMsgDesc->m_dwFlags & CMDMGR_MF_BLOCKINGMSG )
 							{
-								// See if this is a blocking message...
-								if( pTargetClassDesc->m_pMsgs[nMsg].m_dwFlags & CMDMGR_MF_BLOCKINGMSG )
-								{
-									// Save the target object as the scripted object...
-									SetScriptedObject( pScriptObj );
-								}
-
-								// The message was found so stop looking...
-								bMsgFound = true;
-								break;
+								// Save the target object as the scripted object...
+								SetScriptedObject( pScriptObj );
 							}
+
+							// The message was found so stop looking...
+							bMsgFound = true;
 						}
 
-						pTargetClassDesc = GetCmdmgrClassDescription( pTargetClassDesc->m_cTok_ParentClass.c_str() );
+						pTargetClassDesc = pTargetClassDesc->GetParentClassDesc( );
 					}
 
 					// If the message was not found in the class or any of it's bases, check the aggragates...
@@ -3446,24 +3854,21 @@ void CCmdScript::Update()
 						pTargetClassDesc = GetCmdmgrClassDescription( pAggregate->GetType() );
 						while( pTargetClassDesc && !bMsgFound )
 						{
-							for( uint32 nMsg = CMDMGR_MIN_CLASSMSGS; nMsg <= pTargetClassDesc->m_nNumMsgs; ++nMsg )
+							const CCmdMgr_MsgDesc *pMsgDesc = pTargetClassDesc->FindMsg( cTok_MsgName );
+							if( pMsgDesc )
 							{
-								if( cTok_MsgName == pTargetClassDesc->m_pMsgs[nMsg].m_cTok_MsgName )
+								// See if this is a blocking message...
+								if( pMsgDesc->m_dwFlags & CMDMGR_MF_BLOCKINGMSG )
 								{
-									// See if this is a blocking message...
-									if( pTargetClassDesc->m_pMsgs[nMsg].m_dwFlags & CMDMGR_MF_BLOCKINGMSG )
-									{
-										// Save the target object as the scripted object...
-										SetScriptedObject( pScriptObj );
-									}
-
-									// The message was found so stop looking...
-									bMsgFound = true;
-									break;
+									// Save the target object as the scripted object...
+									SetScriptedObject( pScriptObj );
 								}
+
+								// The message was found so stop looking...
+								bMsgFound = true;
 							}
 
-							pTargetClassDesc = GetCmdmgrClassDescription( pTargetClassDesc->m_cTok_ParentClass.c_str() );
+							pTargetClassDesc = pTargetClassDesc->GetParentClassDesc( );
 						}
 
 						// Even if this aggregate handled the message all other aggregates need to check, so keep going...
@@ -6149,3 +6554,224 @@ bool CCommandMgrPlugin::CommandExists( const char *pCmd )
 
 	return false;
 }
+
+#ifndef _FINAL
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CCommandMgr::RunBenchmark()
+//
+//	PURPOSE:	Check that pre-parsed commands queue the same commands as
+//				command strings and that the message dispatch tables find the
+//				same messages as a linear search, and time both...
+//
+// ----------------------------------------------------------------------- //
+
+void CCommandMgr::RunBenchmark( uint32 nIterations )
+{
+	if( nIterations == 0 )
+	{
+		nIterations = 10000;
+	}
+
+	if( m_bCommandQueueLocked )
+	{
+		g_pLTServer->CPrint( "CommandMgrBenchmark: command queue is locked - FAILED" );
+		return;
+	}
+
+	// Commands like the ones triggers and keyframers send...
+	static const char* s_aCommands[] =
+	{
+		"msg Door01 (On)",
+		"msg Light01;Light02 (Off); msg Door02 (Lock)",
+		"msg Player (Damage 10 Bullet 0 0 1)",
+		"delay 1.5 (msg Door01 Off)",
+		"msg (Spawner01, Spawner02) (Spawn AI_Soldier01 Patrol)",
+	};
+	const uint32 knNumCommands = LTARRAYSIZE( s_aCommands );
+
+	CParsedCmdList aCmdLists[knNumCommands];
+	for( uint32 nCommand = 0; nCommand < knNumCommands; ++nCommand )
+	{
+		ParseCommandList( s_aCommands[nCommand], aCmdLists[nCommand] );
+	}
+
+	// Queue each command both ways and compare what was queued...
+	uint32 nMismatches = 0;
+	uint32 nQueued = m_CommandQueue.size();
+	for( uint32 nCommand = 0; nCommand < knNumCommands; ++nCommand )
+	{
+		QueueCommand( s_aCommands[nCommand], (ILTBaseClass*)NULL, (ILTBaseClass*)NULL );
+		uint32 nStringCmds = m_CommandQueue.size() - nQueued;
+		QueueCommand( aCmdLists[nCommand], (ILTBaseClass*)NULL, (ILTBaseClass*)NULL );
+		uint32 nListCmds = m_CommandQueue.size() - nQueued - nStringCmds;
+
+		if( (nStringCmds == 0) || (nStringCmds != nListCmds) )
+		{
+			++nMismatches;
+		}
+		else
+		{
+			for( uint32 nCmd = 0; nCmd < nStringCmds; ++nCmd )
+			{
+				const CParsedCmd *pStringCmd = m_CommandQueue[nQueued + nCmd];
+				const CParsedCmd *pListCmd = m_CommandQueue[nQueued + nStringCmds + nCmd];
+				const CParsedMsg &cStringMsg = pStringCmd->GetParsedMsg( );
+				const CParsedMsg &cListMsg = pListCmd->GetParsedMsg( );
+
+				bool bMatch = (pStringCmd->m_cTok_CmdName == pListCmd->m_cTok_CmdName) &&
+							  (pStringCmd->m_saArgs == pListCmd->m_saArgs) &&
+							  (cStringMsg.GetArgCount() == cListMsg.GetArgCount());
+
+				for( uint32 nArg = 0; bMatch && (nArg < cStringMsg.GetArgCount()); ++nArg )
+				{
+					bMatch = (LTStrCmp( cStringMsg.GetArg(nArg).c_str(), cListMsg.GetArg(nArg).c_str() ) == 0);
+				}
+
+				if( !bMatch )
+				{
+					++nMismatches;
+				}
+			}
+		}
+
+		// Return the queued commands to the pool...
+		while( m_CommandQueue.size() > nQueued )
+		{
+			m_CommandPool.push_back( m_CommandQueue.back() );
+			m_CommandQueue.pop_back();
+		}
+	}
+
+	// Time queueing the command strings against the pre-parsed commands...
+	TLTPrecisionTime StartTime = LTTimeUtils::GetPrecisionTime();
+	for( uint32 nIteration = 0; nIteration < nIterations; ++nIteration )
+	{
+		QueueCommand( s_aCommands[nIteration % knNumCommands], (ILTBaseClass*)NULL, (ILTBaseClass*)NULL );
+		while( m_CommandQueue.size() > nQueued )
+		{
+			m_CommandPool.push_back( m_CommandQueue.back() );
+			m_CommandQueue.pop_back();
+		}
+	}
+	double fStringMS = LTTimeUtils::GetPrecisionTimeIntervalMS( StartTime, LTTimeUtils::GetPrecisionTime() );
+
+	StartTime = LTTimeUtils::GetPrecisionTime();
+	for( uint32 nIteration = 0; nIteration < nIterations; ++nIteration )
+	{
+		QueueCommand( aCmdLists[nIteration % knNumCommands], (ILTBaseClass*)NULL, (ILTBaseClass*)NULL );
+		while( m_CommandQueue.size() > nQueued )
+		{
+			m_CommandPool.push_back( m_CommandQueue.back() );
+			m_CommandQueue.pop_back();
+		}
+	}
+	double fListMS = LTTimeUtils::GetPrecisionTimeIntervalMS( StartTime, LTTimeUtils::GetPrecisionTime() );
+
+	// Look up every message of every class, and a name no class handles, with the
+	// dispatch tables and with a linear search of the message descriptions...
+	static CParsedMsg::CToken s_cTok_Unknown( "CommandMgrBenchmarkUnknownMsg" );
+
+	uint32 nNumClasses = GetNumCmdmgrClassDescriptions();
+	uint32 nLookups = 0;
+	for( uint32 nClass = 0; nClass < nNumClasses; ++nClass )
+	{
+		const CCmdMgr_ClassDesc *pClassDesc = GetCmdmgrClassDescription( nClass );
+		if( !pClassDesc )
+			continue;
+
+		for( uint32 nMsg = 0; nMsg <= pClassDesc->m_nNumMsgs; ++nMsg )
+		{
+			const CParsedMsg::CToken &cTok_MsgName = (nMsg < pClassDesc->m_nNumMsgs) ? pClassDesc->m_pMsgs[nMsg].m_cTok_MsgName : s_cTok_Unknown;
+
+			const CCmdMgr_MsgDesc *pLinearDesc = NULL;
+			for( uint32 nSearch = 0; nSearch < pClassDesc->m_nNumMsgs; ++nSearch )
+			{
+				if( pClassDesc->m_pMsgs[nSearch].m_cTok_MsgName == cTok_MsgName )
+				{
+					pLinearDesc = &pClassDesc->m_pMsgs[nSearch];
+					break;
+				}
+			}
+
+			if( pClassDesc->FindMsg( cTok_MsgName ) != pLinearDesc )
+			{
+				++nMismatches;
+			}
+
+			++nLookups;
+		}
+	}
+
+	uint32 nTableFound = 0;
+	StartTime = LTTimeUtils::GetPrecisionTime();
+	for( uint32 nIteration = 0; nIteration < nIterations; ++nIteration )
+	{
+		const CCmdMgr_ClassDesc *pClassDesc = GetCmdmgrClassDescription( nIteration % LTMAX( nNumClasses, (uint32)1 ));
+		if( !pClassDesc )
+			continue;
+
+		for( uint32 nMsg = 0; nMsg < pClassDesc->m_nNumMsgs; ++nMsg )
+		{
+			if( pClassDesc->FindMsg( pClassDesc->m_pMsgs[nMsg].m_cTok_MsgName ))
+			{
+				++nTableFound;
+			}
+		}
+	}
+	double fTableMS = LTTimeUtils::GetPrecisionTimeIntervalMS( StartTime, LTTimeUtils::GetPrecisionTime() );
+
+	uint32 nLinearFound = 0;
+	StartTime = LTTimeUtils::GetPrecisionTime();
+	for( uint32 nIteration = 0; nIteration < nIterations; ++nIteration )
+	{
+		const CCmdMgr_ClassDesc *pClassDesc = GetCmdmgrClassDescription( nIteration % LTMAX( nNumClasses, (uint32)1 ));
+		if( !pClassDesc )
+			continue;
+
+		for( uint32 nMsg = 0; nMsg < pClassDesc->m_nNumMsgs; ++nMsg )
+		{
+			for( uint32 nSearch = 0; nSearch < pClassDesc->m_nNumMsgs; ++nSearch )
+			{
+				if( pClassDesc->m_pMsgs[nSearch].m_cTok_MsgName == pClassDesc->m_pMsgs[nMsg].m_cTok_MsgName )
+				{
+					++nLinearFound;
+					break;
+				}
+			}
+		}
+	}
+	double fLinearMS = LTTimeUtils::GetPrecisionTimeIntervalMS( StartTime, LTTimeUtils::GetPrecisionTime() );
+
+	if( nTableFound != nLinearFound )
+	{
+		++nMismatches;
+	}
+
+	g_pLTServer->CPrint( "CommandMgrBenchmark: %u command strings queued in %.3f ms, pre-parsed in %.3f ms", 
+		nIterations, fStringMS, fListMS );
+	g_pLTServer->CPrint( "CommandMgrBenchmark: %u messages of %u classes found %u times by table in %.3f ms, by linear search in %.3f ms", 
+		nLookups, nNumClasses, nTableFound, fTableMS, fLinearMS );
+	g_pLTServer->CPrint( "CommandMgrBenchmark: %u mismatches - %s", 
+		nMismatches, ( nMismatches == 0 ) ? "PASSED" : "FAILED" );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CommandMgrBenchmarkCB()
+//
+//	PURPOSE:	Console program "CommandMgrBenchmark [<iterations>]".
+//
+// ----------------------------------------------------------------------- //
+
+static void CommandMgrBenchmarkCB( int argc, char** argv )
+{
+	if( !g_pCmdMgr )
+		return;
+
+	uint32 nIterations = ( argc > 0 ) ? ( uint32 )atoi( argv[0] ) : 0;
+	g_pCmdMgr->RunBenchmark( nIterations );
+}
+
+#endif // _FINAL
@@ -456,8 +456,22 @@ class CParsedCmd : public ILTObjRefReceiver
 			LOAD_bool( m_bGlobal );
 			LOAD_STDSTRING( m_sCmdName );
 			m_cTok_CmdName = m_sCmdName.c_str( );
+
+			ParseMsg( );
 		}
 
+		// For message commands, parse the message once when the command is set up
+		// so it can be sent to each target without being parsed again.  Call this
+		// after the command name and arguments are set...
+		void ParseMsg( );
+
+		// Use message arguments that were already parsed from the command...
+		void SetMsgArgs( const StringArray &saMsgArgs );
+
+		// The parsed message of a message command.  Has no arguments for other
+		// commands or if the message could not be parsed...
+		const CParsedMsg& GetParsedMsg( ) const { return m_cParsedMsg; }
+
 
 	private:	// Methods...
 
@@ -485,11 +499,57 @@ class CParsedCmd : public ILTObjRefReceiver
 		bool				m_bGlobal;
 
 
+	private :	// Methods...
+
+		// Point the parsed message tokens at the message arguments...
+		void InitParsedMsg( );
+
 	private :	// Members...
 	  
 		// The buffer for the name of the command...
 		std::string			m_sCmdName;
 
+		// The buffers for the arguments of the parsed message...
+		StringArray			m_saMsgArgs;
+		CParsedMsg			m_cParsedMsg;
+};
+
+// A command string broken into its commands once, for objects that queue the same
+// commands every time they fire, like triggers and keyframer keys.  Queueing it
+// copies the commands onto the queue instead of parsing the string again...
+class CParsedCmdList
+{
+	public :	// Methods...
+
+		CParsedCmdList()
+		:	m_bParsed	( false )
+		{ }
+
+		// Has the command string been parsed yet...
+		bool IsParsed( ) const { return m_bParsed; }
+
+		void Clear( )
+		{
+			m_lstCmds.clear( );
+			m_bParsed = false;
+		}
+
+	private :	// Members...
+
+		friend class CCommandMgr;
+
+		struct ParsedCmdDesc
+		{
+			std::string		m_sCmdName;
+			StringArray		m_saArgs;
+			
+			// Parsed message arguments of message commands...
+			StringArray		m_saMsgArgs;
+		};
+
+		typedef std::vector<ParsedCmdDesc, LTAllocator<ParsedCmdDesc, LT_MEM_TYPE_OBJECTSHELL> > TParsedCmdDescArray;
+		TParsedCmdDescArray	m_lstCmds;
+		bool				m_bParsed;
 };
 
 class CCmdScript : public ILTObjRefReceiver
@@ -610,6 +670,17 @@ class CCommandMgr
 			return QueueCommand( pszCommand, g_pLTServer->HandleToObject( hSender ), g_pLTServer->HandleToObject( hTarget ));
 		}
 
+		// Break the command string into its commands once, so it can be queued many times
+		// without being parsed again.  Commands up to the first invalid one are kept...
+		bool	ParseCommandList( const char *pszCommand, CParsedCmdList &cmdList );
+
+		// Place the pre-parsed commands on the queue for later processing.
+		bool	QueueCommand( const CParsedCmdList &cmdList, ILTBaseClass *pSender, ILTBaseClass *pTarget );
+		bool	QueueCommand( const CParsedCmdList &cmdList, HOBJECT hSender, HOBJECT hTarget )
+		{
+			return QueueCommand( cmdList, g_pLTServer->HandleToObject( hSender ), g_pLTServer->HandleToObject( hTarget ));
+		}
+
 		// Specifically queue a message command to the target.
 		bool	QueueMessage( ILTBaseClass *pSender, ILTBaseClass *pTarget, const char *pszMessage );
 		bool	QueueMessage( HOBJECT hSender, HOBJECT hTarget, const char *pszMessage )
@@ -626,6 +697,19 @@ class CCommandMgr
 
 		bool	Update();
 		void	Clear();
+
+		// Immediately send an already parsed message to the target.  Message commands
+		// are parsed when they are queued and sent to each target through this.
+		// Internal senders that know the message can use it to skip building and
+		// queueing a message command.  Keep the message tokens static so their hash
+		// keys are only calculated once...
+		bool	SendMessageToObject( ILTBaseClass *pSender, ILTBaseClass *pTarget, const CParsedMsg &cParsedMsg );
+
+#ifndef _FINAL
+		// Times queueing command strings against pre-parsed command lists, and class
+		// message lookups against a search of the messages...
+		void	RunBenchmark( uint32 nIterations );
+#endif // _FINAL
 		
 		// The following methods should only be called via the static cmdmgr_XXX
 		// functions...
@@ -670,6 +754,13 @@ class CCommandMgr
 		// Process a single pre-parsed commands.
 		bool	ProcessParsedCmd( CParsedCmd *pParsedCmd );
 
+		// Get a free command from the pool, allocating one if needed.  The command
+		// stays in the pool until QueueParsedCmd is called with it...
+		CParsedCmd*	GetFreeParsedCmd( );
+
+		// Move a command from the pool to the queue...
+		void	QueueParsedCmd( CParsedCmd *pParsedCmd, ILTBaseClass *pSender, ILTBaseClass *pTarget );
+
 		// Make sure the parsed command is valid.
 		bool	ValidateParsedCmd( const CParsedCmd *pParsedCmd, bool bGlobal );
 
@@ -693,7 +784,6 @@ class CCommandMgr
 
 		void	VarChanged( VAR_STRUCT *pVar );
 
-		bool	SendMessageToObject( ILTBaseClass *pSender, ILTBaseClass *pTarget, const char *pszMsg );
 		bool	CallMessageHandler( const CCmdMgr_ClassDesc *pClassDesc, ILTBaseClass *pSender, ILTBaseClass *pTargetObj, IAggregate *pTargetAgg, const CParsedMsg &cParsedMsg );
 
 		// Utility function for filling an object list with objects that will recieve a message... 
@@ -806,6 +896,19 @@ class CCmdMgr_ClassDesc : public ICommandClassDef
 		CCmdMgr_ClassDesc( const char *pClassName, const char *pParentClass, uint32 nNumMsgs,
 							CCmdMgr_MsgDesc *pMsgs, uint32 dwFlags, THandleMsgFn pHandleFn  );
 
+		// Find the message description for the message name in this class only.
+		// Returns NULL if this class does not handle the message...
+		const CCmdMgr_MsgDesc* FindMsg( const CParsedMsg::CToken &cTok_MsgName ) const;
+
+		// Get the description of the parent class, or NULL if there is none...
+		CCmdMgr_ClassDesc* GetParentClassDesc( ) const;
+
+
+	private :	// Methods...
+
+		// Build the dispatch table for the message descriptions...
+		void	BuildMsgTable( );
+
 
 	public :	// Members...
 
@@ -814,6 +917,23 @@ class CCmdMgr_ClassDesc : public ICommandClassDef
 		CCmdMgr_MsgDesc		*m_pMsgs;
 		uint32				m_dwFlags;
 		THandleMsgFn		m_pHandleFn;
+
+
+	private :	// Members...
+
+		// Dispatch table of message description indices, indexed by the message name
+		// hash key multiplied by m_nMsgTableMultiplier and shifted down by m_nMsgTableShift.
+		// The multiplier is chosen so every message of the class has its own slot, so a
+		// lookup is a single probe.  Empty slots hold 0, which is never a real message.
+		// If no perfect table could be built the table is empty and the messages are searched...
+		std::vector<uint16>	m_aMsgTable;
+		uint32				m_nMsgTableMultiplier;
+		uint32				m_nMsgTableShift;
+
+		// Cached parent class description, resolved on first use since the parent
+		// may register after this class...
+		mutable CCmdMgr_ClassDesc	*m_pParentClassDesc;
+		mutable bool				m_bParentClassDescResolved;
 };
 
 typedef std::vector<CCmdMgr_ClassDesc*, LTAllocator<CCmdMgr_ClassDesc*, LT_MEM_TYPE_OBJECTSHELL> > TCmdMgr_ClassDescArray;
@@ -456,8 +456,13 @@ void CommandObject::Update( )
 
 				if( !pEvntCmdStruct->m_sCommand.empty() )
 				{
+					if( !pEvntCmdStruct->m_cParsedCmd.IsParsed() )
+					{
+						g_pCmdMgr->ParseCommandList( pEvntCmdStruct->m_sCommand.c_str(), pEvntCmdStruct->m_cParsedCmd );
+					}
+
 					ILTBaseClass* pSender = g_pLTServer->HandleToObject(m_hActivator);
-					g_pCmdMgr->QueueCommand( pEvntCmdStruct->m_sCommand.c_str(), pSender, pSender );
+					g_pCmdMgr->QueueCommand( pEvntCmdStruct->m_cParsedCmd, pSender, pSender );
 				}
 			}
 		}
@@ -48,6 +48,10 @@ struct EVENT_CMD_STRUCT
 	std::string	m_sCommand;
 	float		m_fTime;
 	bool		m_bProcessed;
+
+	// m_sCommand parsed the first time it is sent, so sending it again when the
+	// command object is turned on again just queues copies of the commands...
+	CParsedCmdList	m_cParsedCmd;
 };
 
 class CommandObject : public GameBase
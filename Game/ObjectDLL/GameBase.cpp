@@ -20,6 +20,7 @@
 #include "ParsedMsg.h"
 #include "ObjectTemplateMgr.h"
 #include "PlayerObj.h"
+#include "ServerFrameRecorder.h"
 #include "EngineLODPropUtil.h"
 
 static CParsedMsg::CToken s_cTok_1("1");
@@ -512,6 +513,17 @@ uint32 GameBase::EngineMessageFn(uint32 messageID, void *pData, float fData)
 		}
 		break;
 
+		case MID_UPDATE:
+		{
+			// Derived classes pass MID_UPDATE down after handling it, so this
+			// marks the end of the object's update.
+			if( ServerFrameRecorder::Instance( ).IsRecording( ))
+			{
+				ServerFrameRecorder::Instance( ).RecordObjectUpdate( m_hObject );
+			}
+		}
+		break;
+
         case MID_PRECREATE:
 		{
             uint32 dwRet = BaseClass::EngineMessageFn(messageID, pData, fData);
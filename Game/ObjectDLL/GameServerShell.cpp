@@ -34,6 +34,7 @@
 #include "GlobalServerMgr.h"
 #include "ObjectTemplateMgr.h"
 #include "AIMgr.h"
+#include "AICoordinator.h"
 #include "BanIPMgr.h"
 #include "BanUserMgr.h"
 #include "ServerMissionMgr.h"
@@ -66,6 +67,12 @@
 #include "CLTFileToILTInStream.h"
 #include "ServerVoteMgr.h"
 #include "TeamBalancer.h"
+#include "ServerFrameRecorder.h"
+#include "ltperfeventlog.h"
+#include "ltprofileutils.h"
+#ifndef _FINAL
+#include "ltperfeventloganalyzer.h"
+#endif // _FINAL
 
 #include <time.h>
 #include <algorithm>
@@ -144,6 +151,17 @@ extern VarTrack g_vtFlickerDisableMessages;
 
 static void BuildSendInstantDamageTypeList( CGameServerShell::InstantDamageTypes& lstInstantDamageTypes );
 static void BuildSendDeathDamageTypeList( CGameServerShell::DeathDamageTypes& lstDeathDamageTypes );
+#ifndef _FINAL
+static void ServerFrameReplayCheckCB( int argc, char** argv );
+static void PerfEventLogReportCB( int argc, char** argv );
+static void EventCasterBenchmarkCB( int argc, char** argv );
+static void FileReadBenchmarkCB( int argc, char** argv );
+static void SaveDirRoundTripTestCB( int argc, char** argv );
+static void SquadBenchmarkCB( int argc, char** argv );
+#if defined(PLATFORM_LINUX)
+static void ProfileCompareTestCB( int argc, char** argv );
+#endif // PLATFORM_LINUX
+#endif // _FINAL
 
 LTRESULT CGameServerShell::OnServerInitialized()
 {
@@ -279,10 +297,11 @@ LTRESULT CGameServerShell::OnServerInitialized()
 			// make sure the file exists
 			if (LTFileOperations::FileExists(strCustomizationsFile.c_str()))
 			{
-				// create a CLTFileToLTInStream wrapper and open the file
+				// create a CLTFileToLTInStream wrapper and open the file.  It isn't mapped since
+				// the file may be edited while the server is running.
 				CLTFileToILTInStream* pOverridesFile = NULL;
 				LT_MEM_TRACK_ALLOC(pOverridesFile = new CLTFileToILTInStream(), LT_MEM_TYPE_GAMECODE);
-				if (!pOverridesFile->Open(strCustomizationsFile.c_str()))
+				if (!pOverridesFile->Open(strCustomizationsFile.c_str(), false))
 				{
 					delete pOverridesFile;
 				}
@@ -447,15 +466,71 @@ LTRESULT CGameServerShell::OnServerInitialized()
 	// Seed the random number generator so GetRandom() isn't the same each game.
 	// IMPORTANT: reseeding the random number generator should not happen all the time
 	// as it can lead to GetRandom() not acting as random as you might think.
+	uint32 nRandomSeed = 0;
 	if( pNetGameInfo->m_bPerformanceTest )
 	{
-		srand(123); // Same as client, doesn't really matter...
+		nRandomSeed = 123; // Same as client, doesn't really matter...
 	}
 	else
 	{
-		srand(time(NULL));
+		nRandomSeed = ( uint32 )time(NULL);
+	}
+
+	// Replay recorded server frames if requested, with the seed they were
+	// recorded with.
+	VarTrack vtReplayServerFrames;
+	vtReplayServerFrames.Init( g_pLTServer, "ReplayServerFrames", "", 0.0f );
+	char const* pszReplayServerFrames = vtReplayServerFrames.GetStr( "" );
+	if( pszReplayServerFrames && pszReplayServerFrames[0] )
+	{
+		char szReplayFilename[MAX_PATH];
+		LTFileOperations::GetUserDirectory( szReplayFilename, LTARRAYSIZE( szReplayFilename ));
+		LTStrCat( szReplayFilename, pszReplayServerFrames, LTARRAYSIZE( szReplayFilename ));
+		if( m_ServerFrameReplay.Start( szReplayFilename, &m_ServerFrameReplayTarget ))
+		{
+			nRandomSeed = m_ServerFrameReplay.GetRandomSeed( );
+		}
+	}
+
+	srand(nRandomSeed);
+
+	// Record the server frames if requested.  The seed is kept in the
+	// recording so a replay runs with the same random numbers.
+	VarTrack vtRecordServerFrames;
+	vtRecordServerFrames.Init( g_pLTServer, "RecordServerFrames", "", 0.0f );
+	char const* pszRecordServerFrames = vtRecordServerFrames.GetStr( "" );
+	if( pszRecordServerFrames && pszRecordServerFrames[0] )
+	{
+		char szRecordFilename[MAX_PATH];
+		LTFileOperations::GetUserDirectory( szRecordFilename, LTARRAYSIZE( szRecordFilename ));
+		LTStrCat( szRecordFilename, pszRecordServerFrames, LTARRAYSIZE( szRecordFilename ));
+		ServerFrameRecorder::Instance( ).Start( szRecordFilename, nRandomSeed );
+	}
+
+	// Log the server frame markers and system scopes to a binary performance log if requested.
+	VarTrack vtPerfEventLog;
+	vtPerfEventLog.Init( g_pLTServer, "PerfEventLog", "", 0.0f );
+	char const* pszPerfEventLog = vtPerfEventLog.GetStr( "" );
+	if( pszPerfEventLog && pszPerfEventLog[0] )
+	{
+		char szPerfEventLogFilename[MAX_PATH];
+		LTFileOperations::GetUserDirectory( szPerfEventLogFilename, LTARRAYSIZE( szPerfEventLogFilename ));
+		LTStrCat( szPerfEventLogFilename, pszPerfEventLog, LTARRAYSIZE( szPerfEventLogFilename ));
+		CLTPerfEventLog::Instance( ).Start( szPerfEventLogFilename );
 	}
 
+#ifndef _FINAL
+	g_pLTServer->RegisterConsoleProgram( "ServerFrameReplayCheck", ServerFrameReplayCheckCB );
+	g_pLTServer->RegisterConsoleProgram( "PerfEventLogReport", PerfEventLogReportCB );
+	g_pLTServer->RegisterConsoleProgram( "EventCasterBenchmark", EventCasterBenchmarkCB );
+	g_pLTServer->RegisterConsoleProgram( "FileReadBenchmark", FileReadBenchmarkCB );
+	g_pLTServer->RegisterConsoleProgram( "SaveDirRoundTripTest", SaveDirRoundTripTestCB );
+	g_pLTServer->RegisterConsoleProgram( "SquadBenchmark", SquadBenchmarkCB );
+#if defined(PLATFORM_LINUX)
+	g_pLTServer->RegisterConsoleProgram( "ProfileCompareTest", ProfileCompareTestCB );
+#endif // PLATFORM_LINUX
+#endif // _FINAL
+
 	// Build the list of instant damage types we need to send to the client when characters take that type of damage.
 	BuildSendInstantDamageTypeList( m_lstSendInstantDamageTypes );
 
@@ -635,6 +710,22 @@ void CGameServerShell::OnServerTerm()
 	// Track the current execution shell scope for proper SEM behavior
 	CServerShellScopeTracker cScopeTracker;
 
+	ServerFrameRecorder::Instance( ).Stop( );
+	m_ServerFrameReplay.Stop( );
+	CLTPerfEventLog::Instance( ).Stop( );
+
+#ifndef _FINAL
+	g_pLTServer->UnregisterConsoleProgram( "ServerFrameReplayCheck" );
+	g_pLTServer->UnregisterConsoleProgram( "PerfEventLogReport" );
+	g_pLTServer->UnregisterConsoleProgram( "EventCasterBenchmark" );
+	g_pLTServer->UnregisterConsoleProgram( "FileReadBenchmark" );
+	g_pLTServer->UnregisterConsoleProgram( "SaveDirRoundTripTest" );
+	g_pLTServer->UnregisterConsoleProgram( "SquadBenchmark" );
+#if defined(PLATFORM_LINUX)
+	g_pLTServer->UnregisterConsoleProgram( "ProfileCompareTest" );
+#endif // PLATFORM_LINUX
+#endif // _FINAL
+
 #if !defined(PLATFORM_LINUX)
 	CAssertMgr::Disable();
 #endif // !PLATFORM_LINUX
@@ -797,6 +888,8 @@ void CGameServerShell::OnAddClient(HCLIENT hClient)
 	// Track the current execution shell scope for proper SEM behavior
 	CServerShellScopeTracker cScopeTracker;
 
+	ServerFrameRecorder::Instance( ).RecordClientAdded( hClient );
+
 	ServerConnectionMgr::Instance().OnAddClient( hClient );
 }
 
@@ -813,6 +906,8 @@ void CGameServerShell::OnRemoveClient(HCLIENT hClient)
 	// Track the current execution shell scope for proper SEM behavior
 	CServerShellScopeTracker cScopeTracker;
 
+	ServerFrameRecorder::Instance( ).RecordClientRemoved( hClient );
+
 	// Notify observers about client getting removed.
 	RemoveClientNotifyParams cParams(RemoveClient, hClient);
 	RemoveClient.DoNotify(cParams);
@@ -1110,6 +1205,9 @@ void CGameServerShell::OnMessage(HCLIENT hSender, ILTMessage_Read *pMsg)
 	if( !pMsg )
 		return;
 
+	ServerFrameRecorder::Instance( ).RecordClientMessage( hSender, *pMsg );
+	ServerFrameRecorder::SystemTimer cSystemTimer( eServerFrameSystem_Messages );
+
 	if( ServerConnectionMgr::Instance().OnMessage( hSender, *pMsg ))
 		return;
 
@@ -3496,16 +3594,29 @@ void CGameServerShell::Update(float /*timeElapsed*/)
 		FirstUpdate();
 	}
 
+	// Hand the replayed inputs for this frame to the shell before the
+	// game systems update.
+	if( m_ServerFrameReplay.IsReplaying( ) && !m_ServerFrameReplay.BeginFrame( ))
+	{
+		m_ServerFrameReplay.Stop( );
+	}
+
 	// Update the switching worlds state machine.
 	UpdateSwitchingWorlds();
 
 	// Update the AI systems.
 
-	m_pAIMgr->Update();
+	{
+		ServerFrameRecorder::SystemTimer cSystemTimer( eServerFrameSystem_AI );
+		m_pAIMgr->Update();
+	}
 
 	// Update the command mgr...
 
-	m_CmdMgr.Update();
+	{
+		ServerFrameRecorder::SystemTimer cSystemTimer( eServerFrameSystem_Commands );
+		m_CmdMgr.Update();
+	}
 
 	// Update the light editor
 	CLightEditor::Singleton().Update();
@@ -3554,23 +3665,38 @@ void CGameServerShell::Update(float /*timeElapsed*/)
 		m_SayTrack.SetStr("");
 	}
 
-	g_pServerMissionMgr->Update( );
+	{
+		ServerFrameRecorder::SystemTimer cSystemTimer( eServerFrameSystem_Mission );
+		g_pServerMissionMgr->Update( );
+	}
 
-	g_pServerSaveLoadMgr->Update( );
+	{
+		ServerFrameRecorder::SystemTimer cSystemTimer( eServerFrameSystem_SaveLoad );
+		g_pServerSaveLoadMgr->Update( );
+	}
 
-	ServerPhysicsCollisionMgr::Instance().Update( );
+	{
+		ServerFrameRecorder::SystemTimer cSystemTimer( eServerFrameSystem_Collisions );
+		ServerPhysicsCollisionMgr::Instance().Update( );
+	}
 
 	// Update our slowmo state.
 	UpdateSlowMo();
 
-	ServerConnectionMgr::Instance().Update( );
+	{
+		ServerFrameRecorder::SystemTimer cSystemTimer( eServerFrameSystem_Connections );
+		ServerConnectionMgr::Instance().Update( );
+	}
 
 
 	if( IsMultiplayerGameServer( ))
 	{
 		// Update multiplayer stuff...
+		ServerFrameRecorder::SystemTimer cSystemTimer( eServerFrameSystem_Multiplayer );
 		UpdateMultiplayer();
 	}
+
+	ServerFrameRecorder::Instance( ).EndUpdate( );
 }
 
 // ----------------------------------------------------------------------- //
@@ -3583,6 +3709,16 @@ void CGameServerShell::Update(float /*timeElapsed*/)
 
 void CGameServerShell::PostUpdate()
 {
+	// Objects have updated, so the frame is complete.
+	ServerFrameRecorder::Instance( ).EndFrame( );
+
+	if( m_ServerFrameReplay.IsReplaying( ))
+	{
+		uint32 nNumObjects = 0;
+		uint32 nChecksum = ServerFrameRecorder::Instance( ).CalcWorldChecksum( nNumObjects );
+		m_ServerFrameReplay.EndFrame( nNumObjects, nChecksum );
+	}
+
 	// Note : This extra server shell scope update makes sure that the object updates are also covered
 	// in the server shell scope
 	ExitServerShell();
@@ -5213,6 +5349,8 @@ LTRESULT CGameServerShell::ProcessPacket(ILTMessage_Read *pMsg, uint8 senderAddr
 	// Track the current execution shell scope for proper SEM behavior
 	CServerShellScopeTracker cScopeTracker;
 
+	ServerFrameRecorder::Instance( ).RecordPacket( *pMsg );
+
 // XENON: Currently disabled in Xenon builds
 #if !defined(PLATFORM_XENON)
 
@@ -6026,4 +6164,270 @@ bool CGameServerShell::ShouldRemoveBasedOnClientSettings( uint32 nUserFlags )
 	return false;
 }
 
+#ifndef _FINAL
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameReplayCheckCB()
+//
+//	PURPOSE:	Console program "ServerFrameReplayCheck <recording>".  The
+//				recording is found in the user directory.
+//
+// ----------------------------------------------------------------------- //
+
+static void ServerFrameReplayCheckCB( int argc, char** argv )
+{
+	if( argc < 1 )
+	{
+		g_pLTServer->CPrint( "ServerFrameReplayCheck <recording>" );
+		return;
+	}
+
+	char szFilename[MAX_PATH];
+	LTFileOperations::GetUserDirectory( szFilename, LTARRAYSIZE( szFilename ));
+	LTStrCat( szFilename, argv[0], LTARRAYSIZE( szFilename ));
+	ServerFrameReplay::RunReplayCheck( szFilename );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	PerfEventLogReportCB()
+//
+//	PURPOSE:	Console program "PerfEventLogReport <log>".  Prints the
+//				frame, scope and counter distributions of a performance
+//				event log in the user directory, and writes its scopes next
+//				to it as <log>.csv and as folded stacks in <log>.folded for
+//				a flame graph.
+//
+// ----------------------------------------------------------------------- //
+
+static void PerfEventLogReportCB( int argc, char** argv )
+{
+	if( argc < 1 )
+	{
+		g_pLTServer->CPrint( "PerfEventLogReport <log>" );
+		return;
+	}
+
+	char szFilename[MAX_PATH];
+	LTFileOperations::GetUserDirectory( szFilename, LTARRAYSIZE( szFilename ));
+	LTStrCat( szFilename, argv[0], LTARRAYSIZE( szFilename ));
+
+	// A log that is still being written can be read, up to its last whole record.
+	CLTPerfEventLogAnalyzer cAnalyzer;
+	if( !cAnalyzer.Load( szFilename ))
+	{
+		g_pLTServer->CPrint( "PerfEventLogReport: could not read %s", szFilename );
+		return;
+	}
+
+	g_pLTServer->CPrint( "PerfEventLogReport: %u events from %u threads, %u dropped, %u unmatched scopes%s",
+		cAnalyzer.GetNumEvents( ), cAnalyzer.GetNumThreads( ), cAnalyzer.GetNumDropped( ), cAnalyzer.GetNumUnmatched( ),
+		cAnalyzer.IsTruncated( ) ? ", ends part way through a record" : "" );
+
+	g_pLTServer->CPrint( "%-24s %8s %10s %10s %10s %10s %10s %12s", "ms", "Count", "Mean", "Median", "95%", "99%", "Max", "Total" );
+	for( uint32 nStats = 0; nStats <= cAnalyzer.GetNumScopes( ); ++nStats )
+	{
+		CLTPerfEventLogAnalyzer::SStats const& stats = ( nStats == 0 ) ? cAnalyzer.GetFrameStats( ) : cAnalyzer.GetScopeStats( nStats - 1 );
+		g_pLTServer->CPrint( "%-24s %8u %10.3f %10.3f %10.3f %10.3f %10.3f %12.1f", stats.m_sName.c_str( ), stats.GetCount( ),
+			stats.GetMean( ), stats.GetPercentile( 50.0f ), stats.GetPercentile( 95.0f ), stats.GetPercentile( 99.0f ),
+			stats.GetMax( ), stats.m_fTotal );
+	}
+
+	if( cAnalyzer.GetNumCounters( ))
+	{
+		g_pLTServer->CPrint( "%-24s %8s %10s %10s %10s %10s", "Counter", "Count", "Mean", "Min", "Median", "Max" );
+		for( uint32 nCounter = 0; nCounter < cAnalyzer.GetNumCounters( ); ++nCounter )
+		{
+			CLTPerfEventLogAnalyzer::SStats const& stats = cAnalyzer.GetCounterStats( nCounter );
+			g_pLTServer->CPrint( "%-24s %8u %10.1f %10.0f %10.0f %10.0f", stats.m_sName.c_str( ), stats.GetCount( ),
+				stats.GetMean( ), stats.GetMin( ), stats.GetPercentile( 50.0f ), stats.GetMax( ));
+		}
+	}
+
+	char szOutputFilename[MAX_PATH];
+	LTSNPrintF( szOutputFilename, LTARRAYSIZE( szOutputFilename ), "%s.csv", szFilename );
+	if( !cAnalyzer.WriteCSV( szOutputFilename ))
+		g_pLTServer->CPrint( "PerfEventLogReport: could not write %s", szOutputFilename );
+
+	LTSNPrintF( szOutputFilename, LTARRAYSIZE( szOutputFilename ), "%s.folded", szFilename );
+	if( !cAnalyzer.WriteFoldedStacks( szOutputFilename ))
+		g_pLTServer->CPrint( "PerfEventLogReport: could not write %s", szOutputFilename );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCasterBenchmarkCB()
+//
+//	PURPOSE:	Console program "EventCasterBenchmark [<iterations>]".
+//
+// ----------------------------------------------------------------------- //
+
+static void EventCasterBenchmarkCB( int argc, char** argv )
+{
+	uint32 nIterations = ( argc > 0 ) ? ( uint32 )atoi( argv[0] ) : 0;
+	EventCaster::RunBenchmark( nIterations );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	FileReadBenchmarkCB()
+//
+//	PURPOSE:	Console program "FileReadBenchmark <file> [<readsize>]".
+//				Reads the whole file through the loader stream three ways,
+//				buffered, mapped and copied, and mapped in place, and prints
+//				the throughput of each.  The file is read once first so all
+//				three read it from the file cache.
+//
+// ----------------------------------------------------------------------- //
+
+static void FileReadBenchmarkCB( int argc, char** argv )
+{
+	if( argc < 1 )
+	{
+		g_pLTServer->CPrint( "FileReadBenchmark <file> [<readsize>]" );
+		return;
+	}
+
+	uint32 nReadSize = ( argc > 1 ) ? ( uint32 )atoi( argv[1] ) : 0;
+	if( nReadSize == 0 )
+		nReadSize = 64;
+
+	uint8* pBuffer = debug_newa( uint8, nReadSize );
+	if( !pBuffer )
+		return;
+
+	static char const* const s_aszPassNames[] = { "warm up", "buffered", "mapped", "in place" };
+	uint32 nWarmUpChecksum = 0;
+	uint32 nFailures = 0;
+
+	for( uint32 nPass = 0; nPass < LTARRAYSIZE( s_aszPassNames ); ++nPass )
+	{
+		CLTFileToILTInStream InFile;
+		if( !InFile.Open( argv[0], ( nPass >= 2 )))
+		{
+			g_pLTServer->CPrint( "FileReadBenchmark: could not open %s", argv[0] );
+			debug_deletea( pBuffer );
+			return;
+		}
+
+		uint64 nFileSize = InFile.GetLen( );
+		uint32 nChecksum = 0;
+		uint32 nNumMapped = 0;
+
+		TLTPrecisionTime StartTime = LTTimeUtils::GetPrecisionTime( );
+		for( uint64 nPos = 0; nPos < nFileSize; nPos += nReadSize )
+		{
+			uint32 nSize = ( uint32 )LTMIN( ( uint64 )nReadSize, nFileSize - nPos );
+
+			// Sum the data so every byte is touched, however it was read.
+			uint8 const* pData = ( nPass == 3 ) ? ( uint8 const* )InFile.GetMappedData( nSize ) : NULL;
+			if( pData )
+			{
+				++nNumMapped;
+			}
+			else
+			{
+				InFile.Read( pBuffer, nSize );
+				pData = pBuffer;
+			}
+
+			for( uint32 nByte = 0; nByte < nSize; ++nByte )
+				nChecksum = ( nChecksum * 31 ) + pData[nByte];
+		}
+		double fReadMS = LTTimeUtils::GetPrecisionTimeIntervalMS( StartTime, LTTimeUtils::GetPrecisionTime( ));
+
+		if( nPass == 0 )
+			nWarmUpChecksum = nChecksum;
+
+		if( InFile.HasErrorOccurred( ) || ( nChecksum != nWarmUpChecksum ))
+			++nFailures;
+
+		if( nPass > 0 )
+		{
+			g_pLTServer->CPrint( "FileReadBenchmark: %s, %u byte reads: %.3f ms, %.1f MB/s%s", s_aszPassNames[nPass], nReadSize, fReadMS,
+				( fReadMS > 0.0 ) ? ( double )nFileSize / ( 1024.0 * 1024.0 ) / ( fReadMS / 1000.0 ) : 0.0,
+				(( nPass == 3 ) && ( nNumMapped == 0 )) ? " (file not mapped, read instead)" : "" );
+		}
+	}
+
+	debug_deletea( pBuffer );
+
+	g_pLTServer->CPrint( "FileReadBenchmark: %u failures - %s", nFailures, ( nFailures == 0 ) ? "PASSED" : "FAILED" );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	SaveDirRoundTripTestCB()
+//
+//	PURPOSE:	Console program "SaveDirRoundTripTest [<files>]".  Saves
+//				generated working dirs with CSaveDirWriter and reads them
+//				back, using a folder in the user directory.
+//
+// ----------------------------------------------------------------------- //
+
+static void SaveDirRoundTripTestCB( int argc, char** argv )
+{
+	uint32 nNumFiles = ( argc > 0 ) ? ( uint32 )atoi( argv[0] ) : 0;
+	CSaveDirWriter::RunRoundTripTest( nNumFiles );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	SquadBenchmarkCB()
+//
+//	PURPOSE:	Console program "SquadBenchmark [<ai> [<iterations>]]".
+//				Compares and times squad generation with and without the
+//				grid on generated AI placements.  Needs a loaded level.
+//
+// ----------------------------------------------------------------------- //
+
+static void SquadBenchmarkCB( int argc, char** argv )
+{
+	if( !g_pAICoordinator )
+	{
+		g_pLTServer->CPrint( "SquadBenchmark: no AI coordinator, load a level first" );
+		return;
+	}
+
+	uint32 cAI = ( argc > 0 ) ? ( uint32 )atoi( argv[0] ) : 0;
+	uint32 nIterations = ( argc > 1 ) ? ( uint32 )atoi( argv[1] ) : 0;
+	g_pAICoordinator->RunSquadBenchmark( cAI, nIterations );
+}
+
+#if defined(PLATFORM_LINUX)
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ProfileCompareTestCB()
+//
+//	PURPOSE:	Console program "ProfileCompareTest [<files>]".  Compares the
+//				profile reader with the one it replaced, and checks that
+//				profile writes reach the file straight away, using files
+//				generated in the user directory.
+//
+// ----------------------------------------------------------------------- //
+
+static void ProfileCompareTestReport( char const* pszMessage )
+{
+	g_pLTServer->CPrint( "ProfileCompareTest: %s", pszMessage );
+}
+
+static void ProfileCompareTestCB( int argc, char** argv )
+{
+	uint32 nNumFiles = ( argc > 0 ) ? ( uint32 )atoi( argv[0] ) : 0;
+	if( nNumFiles == 0 )
+		nNumFiles = 50;
+
+	char szFolder[MAX_PATH];
+	LTFileOperations::GetUserDirectory( szFolder, LTARRAYSIZE( szFolder ));
+
+	uint32 nFailures = LTProfileUtils::RunCompareTest( szFolder, nNumFiles, ProfileCompareTestReport );
+	g_pLTServer->CPrint( "ProfileCompareTest: %u files, %u failures - %s", nNumFiles, nFailures, ( nFailures == 0 ) ? "PASSED" : "FAILED" );
+}
+
+#endif // PLATFORM_LINUX
+
+#endif // _FINAL
+
 // EOF
@@ -30,6 +30,7 @@
 #include "EngineTimer.h"
 #include "ltfilewrite.h"
 #include "ScmdConsoleDriver_PunkBuster.h"
+#include "ServerFrameReplay.h"
 #ifdef PLATFORM_WIN32
 #include <winsock.h>
 #endif
@@ -59,6 +60,9 @@ class CGameServerShell : public IServerShellStub
 
 		declare_interface(CGameServerShell);
 
+		// Replayed inputs are handed to the protected message handlers.
+		friend class ServerFrameReplayShellTarget;
+
 		CGameServerShell();
 		virtual ~CGameServerShell();
 
@@ -476,6 +480,10 @@ class CGameServerShell : public IServerShellStub
 
 		// SCMD console driver for PunkBuster web interface
 		ScmdConsoleDriver_PunkBuster m_cScmdPunkBusterDriver;		
+
+		// Replays recorded server frames when ReplayServerFrames is set.
+		ServerFrameReplay				m_ServerFrameReplay;
+		ServerFrameReplayShellTarget	m_ServerFrameReplayTarget;
 };
 
 extern class CGameServerShell* g_pGameServerShell;
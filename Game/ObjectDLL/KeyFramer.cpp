@@ -614,6 +614,8 @@ bool KeyFramer::CreateKeyList()
 	m_pKeys		= (const KeyData*)pKeyData;
 	m_nNumKeys	= KeyHeader.m_nNumKeys;
 
+	m_lstKeyCommands.resize( m_nNumKeys );
+
 #if defined(PLATFORM_XENON)
 	// XENON: Swap data at runtime
 	LittleEndianToNative(const_cast<KeyData*>(m_pKeys), KeyHeader.m_nNumKeys);
@@ -665,6 +667,8 @@ void KeyFramer::FreeKeys()
 	m_fTotalDistance	= 0.0f;
 	m_fEndTime			= 0.0f;
 	m_nNumKeys			= 0;
+
+	m_lstKeyCommands.clear();
 }
 
 // ----------------------------------------------------------------------- //
@@ -743,7 +747,13 @@ bool KeyFramer::HandleKeyEvents(const KeyData* pKey)
 		const char* pszCommand = m_pCommandBuffer + pKey->m_nCommandIndex;
 		if(!LTStrEmpty(pszCommand))
 		{
-			g_pCmdMgr->QueueCommand( pszCommand, m_hObject, m_hObject );
+			CParsedCmdList& cmdList = m_lstKeyCommands[GetKeyIndex(pKey)];
+			if(!cmdList.IsParsed())
+			{
+				g_pCmdMgr->ParseCommandList( pszCommand, cmdList );
+			}
+
+			g_pCmdMgr->QueueCommand( cmdList, m_hObject, m_hObject );
 		}
 
 		//move past the command to the sound
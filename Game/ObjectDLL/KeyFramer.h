@@ -15,6 +15,7 @@
 #include "CommonUtilities.h"
 #include "iobjectplugin.h"
 #include "GameBase.h"
+#include "CommandMgr.h"
 
 LINKTO_MODULE( KeyFramer );
 
@@ -299,6 +300,11 @@ class KeyFramer : public GameBase
 		//the number of keys in our list
 		uint32			m_nNumKeys;
 
+		//the command of each key, parsed the first time the key is passed so passing it
+		//again just queues copies of the commands
+		typedef std::vector<CParsedCmdList, LTAllocator<CParsedCmdList, LT_MEM_TYPE_OBJECTSHELL> > TParsedCmdListArray;
+		TParsedCmdListArray	m_lstKeyCommands;
+
 		//determines if we need to setup object references once the objects become available
 		bool			m_bInitializedObjRefs;
 
@@ -27,6 +27,7 @@
 #include "GameStartPoint.h"
 #include "ltfileoperations.h"
 #include "GameStartPointMgr.h"
+#include "lttimeutils.h"
 
 #if !defined(PLATFORM_XENON)
 #include "iltgameutil.h"
@@ -56,6 +57,10 @@ VarTrack	g_vtServerDisableCRCCheck;
 VarTrack	g_vtServerDisableCDKeyCheck;
 #endif // _SERVERBUILD && !_FINAL
 
+#ifndef _FINAL
+static void ClientIndexChurnTestCB( int argc, char** argv );
+#endif // _FINAL
+
 #if defined(PLATFORM_LINUX)
 const unsigned int k_nWin32WcharSize		    = 2;
 const unsigned int k_nLinuxWcharSize         = sizeof(wchar_t);
@@ -1847,6 +1852,22 @@ ServerConnectionMgr::ServerConnectionMgr( )
 
 	LT_MEM_TRACK_ALLOC(m_ppGameClientDataSlotArray = new GameClientData*[m_nMaxPlayers], LT_MEM_TYPE_GAMECODE);
 	memset(m_ppGameClientDataSlotArray, 0, sizeof(GameClientData*) * m_nMaxPlayers);
+
+	// size the HCLIENT hash table to a power of two that keeps it at most half full
+	uint32 nClientHashTableSize = 8;
+	while( nClientHashTableSize < m_nMaxPlayers * 2 )
+		nClientHashTableSize <<= 1;
+	m_nClientHashTableMask = nClientHashTableSize - 1;
+
+	LT_MEM_TRACK_ALLOC(m_pClientHashTable = new ClientHashEntry[nClientHashTableSize], LT_MEM_TYPE_GAMECODE);
+	memset(m_pClientHashTable, 0, sizeof(ClientHashEntry) * nClientHashTableSize);
+
+#ifndef _FINAL
+	if( g_pLTServer )
+	{
+		g_pLTServer->RegisterConsoleProgram( "ClientIndexChurnTest", ClientIndexChurnTestCB );
+	}
+#endif // _FINAL
 }
 
 // ----------------------------------------------------------------------- //
@@ -1859,6 +1880,14 @@ ServerConnectionMgr::ServerConnectionMgr( )
 ServerConnectionMgr::~ServerConnectionMgr( )
 {
 	delete [] m_ppGameClientDataSlotArray;
+	delete [] m_pClientHashTable;
+
+#ifndef _FINAL
+	if( g_pLTServer )
+	{
+		g_pLTServer->UnregisterConsoleProgram( "ClientIndexChurnTest" );
+	}
+#endif // _FINAL
 }
 
 
@@ -1882,6 +1911,9 @@ void ServerConnectionMgr::OnAddClient( HCLIENT hClient )
 	}
 	m_GameClientDataList.push_back(pGameClientData);
 
+	// index the client by HCLIENT for fast lookups by handle
+	AddClientHashEntry(hClient, pGameClientData);
+
 	// add the pointer to our slot based list for fast lookups by client ID
 	uint32 nSlotID = g_pLTServer->GetClientID(hClient);
 	LTASSERT(m_ppGameClientDataSlotArray[nSlotID] == NULL, "Attempt to add new client to a non-null slot");
@@ -2060,11 +2092,16 @@ void ServerConnectionMgr::OnRemoveClient(HCLIENT hClient)
 
 #endif // !PLATFORM_XENON
 
-	GameClientDataList::iterator iter = GetGameClientDataIter( hClient );
-	if( iter != m_GameClientDataList.end( ))
+	GameClientData* pGameClientData = GetGameClientData( hClient );
+	if( pGameClientData )
 	{
-		GameClientData* pGameClientData = *iter;
-		m_GameClientDataList.erase( iter );
+		RemoveClientHashEntry( hClient );
+
+		// Erase rather than swap with the back, so the list stays in connection order.
+		GameClientDataList::iterator iter = std::find( m_GameClientDataList.begin( ), m_GameClientDataList.end( ), pGameClientData );
+		if( iter != m_GameClientDataList.end( ))
+			m_GameClientDataList.erase( iter );
+
 		delete pGameClientData;
 	}
 
@@ -2097,26 +2134,99 @@ void ServerConnectionMgr::Update()
 
 // ----------------------------------------------------------------------- //
 //
-//	ROUTINE:	ServerConnectionMgr::GetClientDataIter
+//	ROUTINE:	ServerConnectionMgr::GetClientHashHome
 //
-//	PURPOSE:	Gets the gameclientdata iterator given a HCLIENT.
+//	PURPOSE:	Gets the preferred hash table entry for a HCLIENT.
 //
 // ----------------------------------------------------------------------- //
 
-ServerConnectionMgr::GameClientDataList::iterator ServerConnectionMgr::GetGameClientDataIter( HCLIENT hClient )
+uint32 ServerConnectionMgr::GetClientHashHome( HCLIENT hClient ) const
 {
-	// Find the client in our list.
-	GameClientDataList::iterator iter = m_GameClientDataList.begin( );
-	for( ; iter != m_GameClientDataList.end( ); iter++ )
+	// Client handles are heap pointers, so the low bits carry little
+	// information.  Mix the rest before masking.
+	uint32 nHash = ( uint32 )(( size_t )hClient >> 4 );
+	nHash *= 0x9E3779B1;
+	nHash ^= nHash >> 16;
+	return nHash & m_nClientHashTableMask;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerConnectionMgr::FindClientHashEntry
+//
+//	PURPOSE:	Gets the hash table entry holding a HCLIENT, or the empty
+//				entry that ends its probe sequence if it isn't indexed.
+//
+// ----------------------------------------------------------------------- //
+
+uint32 ServerConnectionMgr::FindClientHashEntry( HCLIENT hClient ) const
+{
+	uint32 nEntry = GetClientHashHome( hClient );
+	while( m_pClientHashTable[nEntry].m_hClient && m_pClientHashTable[nEntry].m_hClient != hClient )
 	{
-		GameClientData* pGameClientData = *iter;
-		if( pGameClientData->GetClient( ) == hClient )
-		{
+		nEntry = ( nEntry + 1 ) & m_nClientHashTableMask;
+	}
+
+	return nEntry;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerConnectionMgr::AddClientHashEntry
+//
+//	PURPOSE:	Indexes a gameclientdata by its HCLIENT.
+//
+// ----------------------------------------------------------------------- //
+
+void ServerConnectionMgr::AddClientHashEntry( HCLIENT hClient, GameClientData* pGameClientData )
+{
+	if( !hClient )
+		return;
+
+	uint32 nEntry = FindClientHashEntry( hClient );
+	LTASSERT( m_pClientHashTable[nEntry].m_hClient == NULL, "Attempt to add a client that is already indexed" );
+
+	m_pClientHashTable[nEntry].m_hClient = hClient;
+	m_pClientHashTable[nEntry].m_pGameClientData = pGameClientData;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerConnectionMgr::RemoveClientHashEntry
+//
+//	PURPOSE:	Removes a HCLIENT from the hash index.  Entries later in the
+//				probe sequence are shifted back so no tombstones are needed.
+//
+// ----------------------------------------------------------------------- //
+
+void ServerConnectionMgr::RemoveClientHashEntry( HCLIENT hClient )
+{
+	if( !hClient )
+		return;
+
+	uint32 nHole = FindClientHashEntry( hClient );
+	if( !m_pClientHashTable[nHole].m_hClient )
+		return;
+
+	uint32 nEntry = nHole;
+	for( ;; )
+	{
+		nEntry = ( nEntry + 1 ) & m_nClientHashTableMask;
+		if( !m_pClientHashTable[nEntry].m_hClient )
 			break;
-		}
+
+		// Move the entry into the hole unless its home lies cyclically
+		// between the hole and the entry, in which case it must stay put.
+		uint32 nHome = GetClientHashHome( m_pClientHashTable[nEntry].m_hClient );
+		if((( nEntry - nHome ) & m_nClientHashTableMask ) < (( nEntry - nHole ) & m_nClientHashTableMask ))
+			continue;
+
+		m_pClientHashTable[nHole] = m_pClientHashTable[nEntry];
+		nHole = nEntry;
 	}
 
-	return iter;
+	m_pClientHashTable[nHole].m_hClient = NULL;
+	m_pClientHashTable[nHole].m_pGameClientData = NULL;
 }
 
 // ----------------------------------------------------------------------- //
@@ -2129,12 +2239,10 @@ ServerConnectionMgr::GameClientDataList::iterator ServerConnectionMgr::GetGameCl
 
 GameClientData* ServerConnectionMgr::GetGameClientData( HCLIENT hClient )
 {
-	// Find the client in our list.
-	GameClientDataList::iterator iter = GetGameClientDataIter( hClient );
-	if( iter == m_GameClientDataList.end( ))
+	if( !hClient )
 		return NULL;
 
-	return *iter;
+	return m_pClientHashTable[FindClientHashEntry( hClient )].m_pGameClientData;
 }
 
 // ----------------------------------------------------------------------- //
@@ -2147,11 +2255,198 @@ GameClientData* ServerConnectionMgr::GetGameClientData( HCLIENT hClient )
 
 GameClientData* ServerConnectionMgr::GetGameClientDataByClientId( uint32 nClientId )
 {
+	if( nClientId >= m_nMaxPlayers )
+		return NULL;
+
 	// return the GameClientData pointer at the specified slot in the array
 	// (NULL indicates there is no player currently in this slot)
 	return m_ppGameClientDataSlotArray[nClientId];
 }
 
+#ifndef _FINAL
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerConnectionMgr::RunClientIndexChurnTest
+//
+//	PURPOSE:	Drives the HCLIENT hash index through random connects and
+//				disconnects, checking every handle after each step.
+//
+// ----------------------------------------------------------------------- //
+
+void ServerConnectionMgr::RunClientIndexChurnTest( uint32 nOperations )
+{
+	if( nOperations == 0 )
+	{
+		nOperations = 100000;
+	}
+
+	// Swap in a scratch table of the same size, so connected clients keep
+	// their entries while the test runs.
+	uint32 nTableSize = m_nClientHashTableMask + 1;
+	ClientHashEntry* pLiveTable = m_pClientHashTable;
+	LT_MEM_TRACK_ALLOC(m_pClientHashTable = new ClientHashEntry[nTableSize], LT_MEM_TYPE_GAMECODE);
+	memset(m_pClientHashTable, 0, sizeof(ClientHashEntry) * nTableSize);
+
+	// The pool holds four handles per player, so disconnected handles come
+	// back later the way the engine reuses freed client blocks.  Half the pool
+	// is spaced like heap pointers.  The other half is picked so every handle
+	// hashes to the first two entries, which builds the long probe runs that
+	// backward shift deletion has to repair.
+	uint32 nMaxClients = LTMAX( m_nMaxPlayers, ( uint32 )1 );
+	uint32 nPoolSize = nMaxClients * 4;
+
+	HCLIENT* pPool = NULL;
+	GameClientData** ppExpected = NULL;
+	uint32* pConnected = NULL;
+	LT_MEM_TRACK_ALLOC(pPool = new HCLIENT[nPoolSize], LT_MEM_TYPE_GAMECODE);
+	LT_MEM_TRACK_ALLOC(ppExpected = new GameClientData*[nPoolSize], LT_MEM_TYPE_GAMECODE);
+	LT_MEM_TRACK_ALLOC(pConnected = new uint32[nPoolSize], LT_MEM_TYPE_GAMECODE);
+	memset(ppExpected, 0, sizeof(GameClientData*) * nPoolSize);
+
+	uint32 iPool = 0;
+	for( ; iPool < nPoolSize / 2; ++iPool )
+	{
+		pPool[iPool] = ( HCLIENT )( size_t )( 0x10000000 + iPool * 0x130 );
+	}
+	for( size_t nCandidate = 0x20000000; iPool < nPoolSize; nCandidate += 0x10 )
+	{
+		if( GetClientHashHome(( HCLIENT )nCandidate ) < 2 )
+		{
+			pPool[iPool++] = ( HCLIENT )nCandidate;
+		}
+	}
+
+	uint32 nConnected = 0;
+	uint32 nMismatches = 0;
+	uint32 nLongestProbe = 0;
+	uint32 nSeed = 0x2545F491;
+
+	for( uint32 iOperation = 0; iOperation < nOperations; ++iOperation )
+	{
+		nSeed = nSeed * 1664525 + 1013904223;
+		uint32 nRandom = nSeed >> 8;
+
+		bool bConnect = ( nConnected == 0 ) || (( nConnected < nMaxClients ) && ( nRandom & 1 ));
+		nRandom >>= 1;
+
+		uint32 iClient = 0;
+		if( bConnect )
+		{
+			// The data pointers are never dereferenced, they only need to
+			// differ between connections.
+			iClient = nRandom % nPoolSize;
+			while( ppExpected[iClient] )
+			{
+				iClient = ( iClient + 1 ) % nPoolSize;
+			}
+
+			ppExpected[iClient] = ( GameClientData* )( size_t )(( iOperation + 1 ) << 4 );
+			pConnected[nConnected++] = iClient;
+			AddClientHashEntry( pPool[iClient], ppExpected[iClient] );
+		}
+		else
+		{
+			uint32 iConnected = nRandom % nConnected;
+			iClient = pConnected[iConnected];
+			pConnected[iConnected] = pConnected[--nConnected];
+			ppExpected[iClient] = NULL;
+			RemoveClientHashEntry( pPool[iClient] );
+		}
+
+		for( iPool = 0; iPool < nPoolSize; ++iPool )
+		{
+			if( GetGameClientData( pPool[iPool] ) != ppExpected[iPool] )
+			{
+				++nMismatches;
+			}
+		}
+
+		// The table must hold exactly the connected clients, each reachable
+		// from its home entry without crossing an empty one.
+		uint32 nEntries = 0;
+		for( uint32 iEntry = 0; iEntry < nTableSize; ++iEntry )
+		{
+			if( !m_pClientHashTable[iEntry].m_hClient )
+			{
+				continue;
+			}
+
+			++nEntries;
+			uint32 nHome = GetClientHashHome( m_pClientHashTable[iEntry].m_hClient );
+			for( uint32 iProbe = nHome; iProbe != iEntry; iProbe = ( iProbe + 1 ) & m_nClientHashTableMask )
+			{
+				if( !m_pClientHashTable[iProbe].m_hClient )
+				{
+					++nMismatches;
+					break;
+				}
+			}
+			nLongestProbe = LTMAX( nLongestProbe, ( iEntry - nHome ) & m_nClientHashTableMask );
+		}
+		if( nEntries != nConnected )
+		{
+			++nMismatches;
+		}
+
+		// Stop at the first bad step.  Entries left behind by a broken delete
+		// would otherwise fill the table and stall the probes.
+		if( nMismatches > 0 )
+		{
+			g_pLTServer->CPrint( "ClientIndexChurnTest: index broken after %s of handle %u at operation %u", 
+				bConnect ? "connect" : "disconnect", iClient, iOperation );
+			nOperations = iOperation + 1;
+			break;
+		}
+	}
+
+	// Time lookups for every handle in the pool against the final table.
+	const uint32 knTimedPasses = 1000;
+	uint32 nFound = 0;
+	TLTPrecisionTime StartTime = LTTimeUtils::GetPrecisionTime();
+	for( uint32 iPass = 0; iPass < knTimedPasses; ++iPass )
+	{
+		for( iPool = 0; iPool < nPoolSize; ++iPool )
+		{
+			if( GetGameClientData( pPool[iPool] ))
+			{
+				++nFound;
+			}
+		}
+	}
+	double fLookupMS = LTTimeUtils::GetPrecisionTimeIntervalMS( StartTime, LTTimeUtils::GetPrecisionTime() );
+
+	delete [] m_pClientHashTable;
+	m_pClientHashTable = pLiveTable;
+
+	delete [] pPool;
+	delete [] ppExpected;
+	delete [] pConnected;
+
+	g_pLTServer->CPrint( "ClientIndexChurnTest: %u connects/disconnects over %u handles, table size %u, longest probe %u", 
+		nOperations, nPoolSize, nTableSize, nLongestProbe );
+	g_pLTServer->CPrint( "ClientIndexChurnTest: %u lookups (%u found) in %.3f ms", 
+		knTimedPasses * nPoolSize, nFound, fLookupMS );
+	g_pLTServer->CPrint( "ClientIndexChurnTest: %u mismatches - %s", 
+		nMismatches, ( nMismatches == 0 ) ? "PASSED" : "FAILED" );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ClientIndexChurnTestCB()
+//
+//	PURPOSE:	Console program "ClientIndexChurnTest [<operations>]".
+//
+// ----------------------------------------------------------------------- //
+
+static void ClientIndexChurnTestCB( int argc, char** argv )
+{
+	uint32 nOperations = ( argc > 0 ) ? ( uint32 )atoi( argv[0] ) : 0;
+	ServerConnectionMgr::Instance( ).RunClientIndexChurnTest( nOperations );
+}
+
+#endif // _FINAL
+
 // ----------------------------------------------------------------------- //
 //
 //	ROUTINE:	ServerConnectionMgr::OnMessage()
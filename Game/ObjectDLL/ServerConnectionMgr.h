@@ -218,10 +218,19 @@ class ServerConnectionMgr
 		// Boots the client and sends the reason to them.
 		bool BootWithReason( GameClientData& gameClientData, EClientConnectionError eConnectionError, const char* pszMessage );
 
+#ifndef _FINAL
+		// Drives the HCLIENT hash index through random connects and disconnects
+		// on a scratch table, checking every lookup against the expected result.
+		void RunClientIndexChurnTest( uint32 nOperations );
+#endif // _FINAL
+
 	private:
 
-		// Gets the iterator to a gameclientdata based on HCLIENT;
-		GameClientDataList::iterator GetGameClientDataIter( HCLIENT hClient );
+		// HCLIENT hash index maintenance.
+		uint32 GetClientHashHome( HCLIENT hClient ) const;
+		uint32 FindClientHashEntry( HCLIENT hClient ) const;
+		void AddClientHashEntry( HCLIENT hClient, GameClientData* pGameClientData );
+		void RemoveClientHashEntry( HCLIENT hClient );
 
 		// Updates clients waiting for authorization to join.
 		bool UpdateClientsWaitingForAuth( );
@@ -237,12 +246,24 @@ class ServerConnectionMgr
 
 	private:
 
-		// List of clients currently connected.
+		// List of clients currently connected, in connection order.  This is
+		// the dense list used for iterating over every client.
 		GameClientDataList	m_GameClientDataList;
 
 		// slot-based index into the list of game client data
 		GameClientData**	m_ppGameClientDataSlotArray;
 
+		// Open addressed hash index into the list of game client data keyed by
+		// HCLIENT.  The table size is a power of two at least twice the maximum
+		// number of players, so probe sequences stay short.
+		struct ClientHashEntry
+		{
+			HCLIENT			m_hClient;
+			GameClientData*	m_pGameClientData;
+		};
+		ClientHashEntry*	m_pClientHashTable;
+		uint32				m_nClientHashTableMask;
+
 		// maximum number of players allowed by the server
 		uint32 m_nMaxPlayers;
 
@@ -0,0 +1,723 @@
+// ----------------------------------------------------------------------- //
+//
+// MODULE  : ServerFrameRecorder.cpp
+//
+// PURPOSE : Records the inputs and timings of each server frame.
+//
+// CREATED : 10/18/26
+//
+// (c) 2026 Monolith Productions, Inc.  All Rights Reserved
+//
+// ----------------------------------------------------------------------- //
+
+#include "Stdafx.h"
+#include "ServerFrameRecorder.h"
+#include "crc32utils.h"
+#include "EngineTimer.h"
+#include "ltperfeventlog.h"
+#include "MsgIDs.h"
+
+// Names used in the report and the performance log, in EServerFrameSystem order.
+static char const* const s_aszSystemNames[kNumServerFrameSystems] =
+{
+	"Messages",
+	"AI",
+	"Commands",
+	"Mission",
+	"SaveLoad",
+	"Collisions",
+	"Connections",
+	"Multiplayer",
+	"Objects",
+};
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameTimeHistogram::Clear
+//
+//	PURPOSE:	Removes all frame times.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameTimeHistogram::Clear( )
+{
+	memset( m_nBuckets, 0, sizeof( m_nBuckets ));
+	m_nCount = 0;
+	m_fSumMS = 0.0;
+	m_fMinMS = 0.0f;
+	m_fMaxMS = 0.0f;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameTimeHistogram::Add
+//
+//	PURPOSE:	Adds a frame time in milliseconds.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameTimeHistogram::Add( float fMS )
+{
+	if( !m_nCount || fMS < m_fMinMS )
+		m_fMinMS = fMS;
+	if( !m_nCount || fMS > m_fMaxMS )
+		m_fMaxMS = fMS;
+
+	++m_nBuckets[GetBucket( fMS )];
+	++m_nCount;
+	m_fSumMS += fMS;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameTimeHistogram::GetPercentile
+//
+//	PURPOSE:	Gets the time that fPercent percent of the frames are at or
+//				below.  The middle of the bucket holding that frame is used,
+//				kept within the smallest and largest time seen.
+//
+// ----------------------------------------------------------------------- //
+float ServerFrameTimeHistogram::GetPercentile( float fPercent ) const
+{
+	if( !m_nCount )
+		return 0.0f;
+
+	uint32 nRank = ( uint32 )(( m_nCount - 1 ) * LTCLAMP( fPercent, 0.0f, 100.0f ) / 100.0f );
+	uint32 nBelow = 0;
+	for( uint32 nBucket = 0; nBucket < kNumBuckets; ++nBucket )
+	{
+		nBelow += m_nBuckets[nBucket];
+		if( nBelow > nRank )
+		{
+			return LTCLAMP( GetBucketMiddle( nBucket ), m_fMinMS, m_fMaxMS );
+		}
+	}
+
+	return m_fMaxMS;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameTimeHistogram::GetBucket
+//
+//	PURPOSE:	Gets the bucket holding a time.
+//
+// ----------------------------------------------------------------------- //
+uint32 ServerFrameTimeHistogram::GetBucket( float fMS )
+{
+	if( !( fMS >= ldexp( 1.0, kMinExponent )))
+		return 0;
+
+	// fMS is fMantissa * 2^nExponent, with fMantissa in [0.5, 1).
+	int nExponent = 0;
+	double fMantissa = frexp( fMS, &nExponent );
+
+	int nOctave = nExponent - 1 - kMinExponent;
+	if( nOctave >= kNumOctaves )
+		return kNumBuckets - 1;
+
+	uint32 nStep = ( uint32 )(( fMantissa * 2.0 - 1.0 ) * kBucketsPerOctave );
+	return 1 + nOctave * kBucketsPerOctave + LTMIN( nStep, ( uint32 )kBucketsPerOctave - 1 );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameTimeHistogram::GetBucketMiddle
+//
+//	PURPOSE:	Gets the time in the middle of a bucket.  The first and last
+//				buckets are open ended, so they return their inner edge.
+//
+// ----------------------------------------------------------------------- //
+float ServerFrameTimeHistogram::GetBucketMiddle( uint32 nBucket )
+{
+	if( nBucket == 0 )
+		return ( float )ldexp( 1.0, kMinExponent );
+
+	if( nBucket == kNumBuckets - 1 )
+		return ( float )ldexp( 1.0, kMinExponent + kNumOctaves );
+
+	uint32 nOctave = ( nBucket - 1 ) / kBucketsPerOctave;
+	uint32 nStep = ( nBucket - 1 ) % kBucketsPerOctave;
+	return ( float )ldexp( 1.0 + ( nStep + 0.5 ) / kBucketsPerOctave, ( int )nOctave + kMinExponent );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::ServerFrameRecorder
+//
+//	PURPOSE:	ctor
+//
+// ----------------------------------------------------------------------- //
+ServerFrameRecorder::ServerFrameRecorder( )
+{
+	m_bRecording = false;
+	m_bObjectsScopeOpen = false;
+	m_nFrame = 0;
+
+	for( uint32 nSystem = 0; nSystem < kNumServerFrameSystems; ++nSystem )
+	{
+		m_fSystemMS[nSystem] = 0.0f;
+	}
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::~ServerFrameRecorder
+//
+//	PURPOSE:	dtor
+//
+// ----------------------------------------------------------------------- //
+ServerFrameRecorder::~ServerFrameRecorder( )
+{
+	Stop( );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::Start
+//
+//	PURPOSE:	Starts writing a recording.
+//
+// ----------------------------------------------------------------------- //
+bool ServerFrameRecorder::Start( char const* pszFilename, uint32 nRandomSeed )
+{
+	Stop( );
+
+	if( !pszFilename || !pszFilename[0] )
+		return false;
+
+	if( !m_cFile.Open( pszFilename, false ))
+		return false;
+
+	m_sFilename = pszFilename;
+	m_bRecording = true;
+	m_nFrame = 0;
+	m_tmStart = LTTimeUtils::GetPrecisionTime( );
+	m_tmUpdateEnd = m_tmStart;
+
+	for( uint32 nSystem = 0; nSystem < kNumServerFrameSystems; ++nSystem )
+	{
+		m_fSystemMS[nSystem] = 0.0f;
+		m_SystemFrameMS[nSystem].Clear( );
+	}
+	m_FrameMS.Clear( );
+	m_lstObjectClassStats.clear( );
+	m_mapObjectClassIndices.clear( );
+
+	// Write the header.
+	uint32 nFileID = SERVERFRAMERECORDER_FILEID;
+	uint32 nFileVersion = SERVERFRAMERECORDER_VERSION;
+	uint32 nNumSystems = kNumServerFrameSystems;
+	m_lstFrameBuffer.clear( );
+	Write( &nFileID, sizeof( nFileID ));
+	Write( &nFileVersion, sizeof( nFileVersion ));
+	Write( &nRandomSeed, sizeof( nRandomSeed ));
+	Write( &nNumSystems, sizeof( nNumSystems ));
+	Flush( );
+
+	g_pLTServer->CPrint( "ServerFrameRecorder: recording to %s", pszFilename );
+
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::Stop
+//
+//	PURPOSE:	Stops recording and writes the frame time report.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecorder::Stop( )
+{
+	if( !m_bRecording )
+		return;
+
+	// Inputs received since the last frame are kept, so a replay sees them.
+	Flush( );
+	m_cFile.Close( );
+	m_bRecording = false;
+
+	WriteReport( );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::EndUpdate
+//
+//	PURPOSE:	Called at the end of CGameServerShell::Update.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecorder::EndUpdate( )
+{
+	// The scope is only ended if it was begun, so a log started before
+	// EndFrame doesn't get an end without a begin.
+	m_bObjectsScopeOpen = CLTPerfEventLog::Instance( ).IsActive( );
+	if( m_bObjectsScopeOpen )
+		CLTPerfEventLog::Instance( ).BeginScope( s_aszSystemNames[eServerFrameSystem_Objects] );
+
+	if( !m_bRecording )
+		return;
+
+	m_tmUpdateEnd = LTTimeUtils::GetPrecisionTime( );
+	m_tmObjectUpdateEnd = m_tmUpdateEnd;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::EndFrame
+//
+//	PURPOSE:	Writes the end of frame record.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecorder::EndFrame( )
+{
+	// The performance log is marked every frame, whether or not a recording is being made.
+	if( m_bObjectsScopeOpen )
+	{
+		CLTPerfEventLog::Instance( ).EndScope( s_aszSystemNames[eServerFrameSystem_Objects] );
+		m_bObjectsScopeOpen = false;
+	}
+	CLTPerfEventLog::Instance( ).Frame( );
+
+	if( !m_bRecording )
+		return;
+
+	// The engine updates objects between the shell's Update and PostUpdate.
+	m_fSystemMS[eServerFrameSystem_Objects] = ( float )LTTimeUtils::GetPrecisionTimeIntervalMS( m_tmUpdateEnd, LTTimeUtils::GetPrecisionTime( ));
+
+	uint32 nNumObjects = 0;
+	uint32 nChecksum = CalcWorldChecksum( nNumObjects );
+
+	double fSimulationTime = SimulationTimer::Instance( ).GetTimerAccumulatedS( );
+	float fElapsedTime = SimulationTimer::Instance( ).GetTimerElapsedS( );
+
+	WriteRecordHeader( eRecord_FrameEnd );
+	Write( &m_nFrame, sizeof( m_nFrame ));
+	Write( &fSimulationTime, sizeof( fSimulationTime ));
+	Write( &fElapsedTime, sizeof( fElapsedTime ));
+	Write( &nNumObjects, sizeof( nNumObjects ));
+	Write( &nChecksum, sizeof( nChecksum ));
+	Write( m_fSystemMS, sizeof( m_fSystemMS ));
+	Flush( );
+
+	// Keep the timings for the report and start the next frame.
+	float fFrameMS = 0.0f;
+	for( uint32 nSystem = 0; nSystem < kNumServerFrameSystems; ++nSystem )
+	{
+		m_SystemFrameMS[nSystem].Add( m_fSystemMS[nSystem] );
+		fFrameMS += m_fSystemMS[nSystem];
+		m_fSystemMS[nSystem] = 0.0f;
+	}
+	m_FrameMS.Add( fFrameMS );
+
+	++m_nFrame;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::BeginSystem
+//
+//	PURPOSE:	Starts timing a system.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecorder::BeginSystem( EServerFrameSystem eSystem )
+{
+	CLTPerfEventLog::Instance( ).BeginScope( s_aszSystemNames[eSystem] );
+
+	if( !m_bRecording )
+		return;
+
+	m_tmSystemStart[eSystem] = LTTimeUtils::GetPrecisionTime( );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::EndSystem
+//
+//	PURPOSE:	Adds the time since BeginSystem to the system's frame time.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecorder::EndSystem( EServerFrameSystem eSystem )
+{
+	CLTPerfEventLog::Instance( ).EndScope( s_aszSystemNames[eSystem] );
+
+	if( !m_bRecording )
+		return;
+
+	m_fSystemMS[eSystem] += ( float )LTTimeUtils::GetPrecisionTimeIntervalMS( m_tmSystemStart[eSystem], LTTimeUtils::GetPrecisionTime( ));
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::RecordClientAdded
+//
+//	PURPOSE:	Records a client connecting.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecorder::RecordClientAdded( HCLIENT hClient )
+{
+	if( !m_bRecording )
+		return;
+
+	uint32 nClientId = g_pLTServer->GetClientID( hClient );
+	WriteRecordHeader( eRecord_ClientAdded );
+	Write( &nClientId, sizeof( nClientId ));
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::RecordClientRemoved
+//
+//	PURPOSE:	Records a client disconnecting.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecorder::RecordClientRemoved( HCLIENT hClient )
+{
+	if( !m_bRecording )
+		return;
+
+	uint32 nClientId = g_pLTServer->GetClientID( hClient );
+	WriteRecordHeader( eRecord_ClientRemoved );
+	Write( &nClientId, sizeof( nClientId ));
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::RecordClientMessage
+//
+//	PURPOSE:	Records a message from a client.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecorder::RecordClientMessage( HCLIENT hSender, ILTMessage_Read& msg )
+{
+	if( !m_bRecording )
+		return;
+
+	uint32 nClientId = hSender ? g_pLTServer->GetClientID( hSender ) : ( uint32 )-1;
+	WriteRecordHeader( eRecord_ClientMessage );
+	Write( &nClientId, sizeof( nClientId ));
+
+	// Keep only the id of private messages.
+	if( msg.Size( ) >= 8 )
+	{
+		uint32 nPos = msg.Tell( );
+		msg.SeekTo( 0 );
+		uint8 nMessageId = msg.Readuint8( );
+		msg.SeekTo( nPos );
+
+		if( IsPrivateMessage( nMessageId ))
+		{
+			uint32 nSizeBits = 8;
+			Write( &nSizeBits, sizeof( nSizeBits ));
+			Write( &nMessageId, sizeof( nMessageId ));
+			return;
+		}
+	}
+
+	WriteMessageData( msg );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::RecordPacket
+//
+//	PURPOSE:	Records the arrival of a connectionless packet.  Packets
+//				carry server queries and logins, and their senders are
+//				player addresses, so only the size is kept.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecorder::RecordPacket( ILTMessage_Read& msg )
+{
+	if( !m_bRecording )
+		return;
+
+	uint32 nSizeBits = msg.Size( );
+	WriteRecordHeader( eRecord_Packet );
+	Write( &nSizeBits, sizeof( nSizeBits ));
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::IsPrivateMessage
+//
+//	PURPOSE:	Checks if a client message may hold a password, key or
+//				other data that must not be written to a recording.
+//
+// ----------------------------------------------------------------------- //
+bool ServerFrameRecorder::IsPrivateMessage( uint8 nMessageId )
+{
+	switch( nMessageId )
+	{
+		// The handshake carries the game password and key data.
+		case MID_CLIENTCONNECTION:
+
+		// Admin commands carry the admin password.
+		case MID_SCMD_COMMAND:
+
+		// Anti-cheat traffic.
+		case MID_PUNKBUSTER_MSG:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::RecordObjectUpdate
+//
+//	PURPOSE:	Records an object finishing its update.  The time since the
+//				previous object finished is charged to this one, so engine
+//				work between the two updates is included.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecorder::RecordObjectUpdate( HOBJECT hObject )
+{
+	if( !m_bRecording || !hObject )
+		return;
+
+	TLTPrecisionTime tmNow = LTTimeUtils::GetPrecisionTime( );
+	float fUpdateMS = ( float )LTTimeUtils::GetPrecisionTimeIntervalMS( m_tmObjectUpdateEnd, tmNow );
+	m_tmObjectUpdateEnd = tmNow;
+
+	uint16 nClassIndex = GetObjectClassIndex( hObject );
+	WriteRecordHeader( eRecord_ObjectUpdate );
+	Write( &nClassIndex, sizeof( nClassIndex ));
+	Write( &fUpdateMS, sizeof( fUpdateMS ));
+
+	ObjectClassStats& stats = m_lstObjectClassStats[nClassIndex];
+	++stats.m_nUpdates;
+	stats.m_fTotalMS += fUpdateMS;
+	stats.m_fMaxMS = LTMAX( stats.m_fMaxMS, fUpdateMS );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::GetObjectClassIndex
+//
+//	PURPOSE:	Gets the index of an object's class, recording the class
+//				name the first time it is seen.
+//
+// ----------------------------------------------------------------------- //
+uint16 ServerFrameRecorder::GetObjectClassIndex( HOBJECT hObject )
+{
+	HCLASS hClass = g_pLTServer->GetObjectClass( hObject );
+	ObjectClassIndexMap::iterator iter = m_mapObjectClassIndices.find( hClass );
+	if( iter != m_mapObjectClassIndices.end( ))
+		return iter->second;
+
+	ObjectClassStats stats;
+	memset( &stats, 0, sizeof( stats ));
+	if( !hClass || ( g_pLTServer->GetClassName( hClass, stats.m_szName, LTARRAYSIZE( stats.m_szName )) != LT_OK ))
+	{
+		LTStrCpy( stats.m_szName, "Unknown", LTARRAYSIZE( stats.m_szName ));
+	}
+
+	// There are far fewer classes than indices, but don't wrap if that changes.
+	if( m_lstObjectClassStats.size( ) >= 0xFFFF )
+	{
+		LTERROR( "ServerFrameRecorder: too many object classes" );
+		return 0;
+	}
+
+	uint16 nClassIndex = ( uint16 )m_lstObjectClassStats.size( );
+	m_lstObjectClassStats.push_back( stats );
+	m_mapObjectClassIndices[hClass] = nClassIndex;
+
+	uint8 nNameLength = ( uint8 )LTStrLen( stats.m_szName );
+	WriteRecordHeader( eRecord_ObjectClass );
+	Write( &nClassIndex, sizeof( nClassIndex ));
+	Write( &nNameLength, sizeof( nNameLength ));
+	Write( stats.m_szName, nNameLength );
+
+	return nClassIndex;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::Write
+//
+//	PURPOSE:	Appends data to the current frame's buffer.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecorder::Write( void const* pData, uint32 nSize )
+{
+	uint8 const* pBytes = ( uint8 const* )pData;
+	m_lstFrameBuffer.insert( m_lstFrameBuffer.end( ), pBytes, pBytes + nSize );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::WriteRecordHeader
+//
+//	PURPOSE:	Writes the type and time that start every record.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecorder::WriteRecordHeader( ERecordType eType )
+{
+	uint8 nType = ( uint8 )eType;
+	float fTime = ( float )LTTimeUtils::GetPrecisionTimeIntervalS( m_tmStart, LTTimeUtils::GetPrecisionTime( ));
+	Write( &nType, sizeof( nType ));
+	Write( &fTime, sizeof( fTime ));
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::WriteMessageData
+//
+//	PURPOSE:	Writes the size and contents of a message, leaving its read
+//				position unchanged.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecorder::WriteMessageData( ILTMessage_Read& msg )
+{
+	uint32 nSizeBits = msg.Size( );
+	Write( &nSizeBits, sizeof( nSizeBits ));
+	if( !nSizeBits )
+		return;
+
+	m_lstMessageData.resize(( nSizeBits + 7 ) / 8 );
+	uint32 nPos = msg.Tell( );
+	msg.SeekTo( 0 );
+	msg.ReadData( &m_lstMessageData[0], nSizeBits );
+	msg.SeekTo( nPos );
+
+	Write( &m_lstMessageData[0], ( uint32 )m_lstMessageData.size( ));
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::Flush
+//
+//	PURPOSE:	Writes the buffered frame to the recording.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecorder::Flush( )
+{
+	if( m_lstFrameBuffer.empty( ))
+		return;
+
+	if( !m_cFile.Write( &m_lstFrameBuffer[0], ( uint32 )m_lstFrameBuffer.size( )))
+	{
+		// Don't leave a recording that silently drops frames.
+		g_pLTServer->CPrint( "ServerFrameRecorder: failed to write %s, recording stopped", m_sFilename.c_str( ));
+		m_lstFrameBuffer.clear( );
+		m_cFile.Close( );
+		m_bRecording = false;
+		return;
+	}
+
+	m_lstFrameBuffer.clear( );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::CalcWorldChecksum
+//
+//	PURPOSE:	Calculates the checksum of the active objects' positions and
+//				rotations.
+//
+// ----------------------------------------------------------------------- //
+uint32 ServerFrameRecorder::CalcWorldChecksum( uint32& nNumObjects )
+{
+	m_lstChecksumData.clear( );
+	nNumObjects = 0;
+
+	LTVector vPos;
+	LTRotation rRot;
+	HOBJECT hObject = g_pLTServer->GetNextObject( NULL );
+	while( hObject )
+	{
+		g_pLTServer->GetObjectPos( hObject, &vPos );
+		g_pLTServer->GetObjectRotation( hObject, &rRot );
+
+		m_lstChecksumData.push_back( vPos.x );
+		m_lstChecksumData.push_back( vPos.y );
+		m_lstChecksumData.push_back( vPos.z );
+		m_lstChecksumData.push_back( rRot.m_Quat[0] );
+		m_lstChecksumData.push_back( rRot.m_Quat[1] );
+		m_lstChecksumData.push_back( rRot.m_Quat[2] );
+		m_lstChecksumData.push_back( rRot.m_Quat[3] );
+
+		++nNumObjects;
+		hObject = g_pLTServer->GetNextObject( hObject );
+	}
+
+	if( m_lstChecksumData.empty( ))
+		return 0;
+
+	return CRC32Utils::CalcDataCRC( &m_lstChecksumData[0], ( uint32 )( m_lstChecksumData.size( ) * sizeof( float )));
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::GetSystemName
+//
+//	PURPOSE:	Gets the name of a system, as used in the report.
+//
+// ----------------------------------------------------------------------- //
+char const* ServerFrameRecorder::GetSystemName( EServerFrameSystem eSystem )
+{
+	if( eSystem < 0 || eSystem >= kNumServerFrameSystems )
+		return "";
+
+	return s_aszSystemNames[eSystem];
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecorder::WriteReport
+//
+//	PURPOSE:	Writes the frame time distribution of each system.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecorder::WriteReport( )
+{
+	if( !m_FrameMS.GetCount( ))
+		return;
+
+	std::string sReportFilename = m_sFilename + ".txt";
+	CLTFileWrite cReportFile;
+	if( !cReportFile.Open( sReportFilename.c_str( ), false ))
+		return;
+
+	char szLine[256];
+	LTSNPrintF( szLine, LTARRAYSIZE( szLine ), "%u frames\n%-12s %10s %10s %10s %10s %10s %10s\n",
+		m_FrameMS.GetCount( ), "System", "Mean", "Min", "Median", "95%", "99%", "Max" );
+	cReportFile.Write( szLine, LTStrLen( szLine ));
+
+	for( uint32 nSystem = 0; nSystem <= kNumServerFrameSystems; ++nSystem )
+	{
+		bool bTotal = ( nSystem == kNumServerFrameSystems );
+		ServerFrameTimeHistogram const& histogram = bTotal ? m_FrameMS : m_SystemFrameMS[nSystem];
+
+		LTSNPrintF( szLine, LTARRAYSIZE( szLine ), "%-12s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+			bTotal ? "Total" : s_aszSystemNames[nSystem],
+			histogram.GetMean( ),
+			histogram.GetMin( ),
+			histogram.GetPercentile( 50.0f ),
+			histogram.GetPercentile( 95.0f ),
+			histogram.GetPercentile( 99.0f ),
+			histogram.GetMax( ));
+		cReportFile.Write( szLine, LTStrLen( szLine ));
+	}
+
+	// Object classes, most expensive first.
+	ObjectClassStatsList lstClasses = m_lstObjectClassStats;
+	std::sort( lstClasses.begin( ), lstClasses.end( ), IsSlowerObjectClass );
+
+	LTSNPrintF( szLine, LTARRAYSIZE( szLine ), "\n%-32s %10s %10s %10s %10s\n",
+		"Object class", "Updates", "Total", "Mean", "Max" );
+	cReportFile.Write( szLine, LTStrLen( szLine ));
+
+	for( ObjectClassStatsList::iterator iter = lstClasses.begin( ); iter != lstClasses.end( ); ++iter )
+	{
+		LTSNPrintF( szLine, LTARRAYSIZE( szLine ), "%-32s %10u %10.3f %10.3f %10.3f\n",
+			iter->m_szName, iter->m_nUpdates, iter->m_fTotalMS, 
+			iter->m_nUpdates ? iter->m_fTotalMS / iter->m_nUpdates : 0.0, iter->m_fMaxMS );
+		cReportFile.Write( szLine, LTStrLen( szLine ));
+	}
+
+	cReportFile.Close( );
+
+	g_pLTServer->CPrint( "ServerFrameRecorder: wrote frame time report to %s", sReportFilename.c_str( ));
+}
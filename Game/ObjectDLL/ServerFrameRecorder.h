@@ -0,0 +1,283 @@
+// ----------------------------------------------------------------------- //
+//
+// MODULE  : ServerFrameRecorder.h
+//
+// PURPOSE : Records the inputs and timings of each server frame.
+//
+// CREATED : 10/18/26
+//
+// (c) 2026 Monolith Productions, Inc.  All Rights Reserved
+//
+// ----------------------------------------------------------------------- //
+
+#ifndef __SERVERFRAMERECORDER_H__
+#define __SERVERFRAMERECORDER_H__
+
+#include "ltfilewrite.h"
+#include "lttimeutils.h"
+
+// Identifies the recording format.
+#define SERVERFRAMERECORDER_FILEID		LTMakeFourCC( 'S', 'F', 'R', 'C' )
+#define SERVERFRAMERECORDER_VERSION		3
+
+// Game systems timed separately within a server frame.
+enum EServerFrameSystem
+{
+	eServerFrameSystem_Messages,
+	eServerFrameSystem_AI,
+	eServerFrameSystem_Commands,
+	eServerFrameSystem_Mission,
+	eServerFrameSystem_SaveLoad,
+	eServerFrameSystem_Collisions,
+	eServerFrameSystem_Connections,
+	eServerFrameSystem_Multiplayer,
+	eServerFrameSystem_Objects,
+
+	kNumServerFrameSystems,
+};
+
+// ----------------------------------------------------------------------- //
+//
+// class ServerFrameTimeHistogram
+//
+// Distribution of frame times.  Buckets are a sixteenth of a power of two
+// wide and cover a microsecond to sixteen seconds, so percentiles are within
+// about three percent and the memory used doesn't grow with the recording.
+//
+// ----------------------------------------------------------------------- //
+class ServerFrameTimeHistogram
+{
+	public:
+
+		ServerFrameTimeHistogram( ) { Clear( ); }
+
+		void	Clear( );
+
+		// Adds a frame time in milliseconds.
+		void	Add( float fMS );
+
+		uint32	GetCount( ) const { return m_nCount; }
+		float	GetMean( ) const { return m_nCount ? ( float )( m_fSumMS / m_nCount ) : 0.0f; }
+		float	GetMin( ) const { return m_fMinMS; }
+		float	GetMax( ) const { return m_fMaxMS; }
+
+		// Gets the time that fPercent percent of the frames are at or below.
+		float	GetPercentile( float fPercent ) const;
+
+	private:
+
+		enum
+		{
+			kBucketsPerOctave	= 16,
+			kNumOctaves			= 24,
+			kMinExponent		= -10,
+
+			// Times below 2^kMinExponent ms go in the first bucket and times of
+			// 2^(kMinExponent+kNumOctaves) ms or more in the last.
+			kNumBuckets			= kNumOctaves * kBucketsPerOctave + 2,
+		};
+
+		static uint32	GetBucket( float fMS );
+		static float	GetBucketMiddle( uint32 nBucket );
+
+		uint32	m_nBuckets[kNumBuckets];
+		uint32	m_nCount;
+		double	m_fSumMS;
+		float	m_fMinMS;
+		float	m_fMaxMS;
+};
+
+// ----------------------------------------------------------------------- //
+//
+// class ServerFrameRecorder
+//
+// Writes the client messages, connection packets and client connects and
+// disconnects the server shell receives to a recording, in order and with
+// the real time at which they arrived.  Object updates are recorded as each
+// object finishes handling MID_UPDATE.  Each frame ends with the simulation
+// time, the time spent in each game system and a checksum of the position
+// and rotation of every active object.
+//
+// Recordings are written in the clear to the user directory, so nothing
+// that may hold a password, key or address is kept.  Messages that carry
+// the connection handshake, admin commands or anti-cheat data are cut down
+// to their message id, and of a connectionless packet only its size is
+// kept.
+//
+// When recording stops, the distribution of frame times for each system and
+// the update time of each object class are written to a report next to the
+// recording.
+//
+// ----------------------------------------------------------------------- //
+class ServerFrameRecorder
+{
+	DECLARE_SINGLETON( ServerFrameRecorder );
+
+	public:
+
+		// Record types in the recording.  Each record is a uint8 type, a
+		// float real time in seconds since recording started, and the data
+		// listed here.
+		enum ERecordType
+		{
+			// uint32 client id.
+			eRecord_ClientAdded,
+
+			// uint32 client id.
+			eRecord_ClientRemoved,
+
+			// uint32 client id, uint32 size in bits, message data.  Private
+			// messages are cut down to their 8 bit message id.
+			eRecord_ClientMessage,
+
+			// uint32 size in bits.
+			eRecord_Packet,
+
+			// uint32 frame, double simulation time, float elapsed simulation
+			// time, uint32 number of active objects, uint32 world checksum,
+			// float milliseconds for each of the kNumServerFrameSystems.
+			eRecord_FrameEnd,
+
+			// uint16 class index, uint8 name length, name characters.  Written
+			// before the first update of each object class.
+			eRecord_ObjectClass,
+
+			// uint16 class index, float milliseconds since the previous
+			// object update finished, or since the shell's Update for the
+			// first object in a frame.
+			eRecord_ObjectUpdate,
+		};
+
+	public:
+
+		// Starts writing a recording.  The random seed the server was started
+		// with is stored in the header so a replay can use the same one.
+		bool	Start( char const* pszFilename, uint32 nRandomSeed );
+
+		// Stops recording and writes the frame time report.
+		void	Stop( );
+
+		bool	IsRecording( ) const { return m_bRecording; }
+
+		// Called at the end of CGameServerShell::Update.  Object updates are
+		// timed from here to EndFrame.
+		void	EndUpdate( );
+
+		// Called from CGameServerShell::PostUpdate once objects have updated.
+		void	EndFrame( );
+
+		// Accumulates time spent in a system this frame.
+		void	BeginSystem( EServerFrameSystem eSystem );
+		void	EndSystem( EServerFrameSystem eSystem );
+
+		// Records server shell inputs.
+		void	RecordClientAdded( HCLIENT hClient );
+		void	RecordClientRemoved( HCLIENT hClient );
+		void	RecordClientMessage( HCLIENT hSender, ILTMessage_Read& msg );
+		void	RecordPacket( ILTMessage_Read& msg );
+
+		// Checks if a client message may hold a password, key or other data
+		// that must not be written to a recording.
+		static bool	IsPrivateMessage( uint8 nMessageId );
+
+		// Called from GameBase when an object has finished handling MID_UPDATE.
+		void	RecordObjectUpdate( HOBJECT hObject );
+
+		// Calculates the checksum of the active objects' positions and rotations.
+		uint32	CalcWorldChecksum( uint32& nNumObjects );
+
+		// Gets the name of a system, as used in the report.
+		static char const*	GetSystemName( EServerFrameSystem eSystem );
+
+		// Times a system for the life of the object.
+		class SystemTimer
+		{
+			public:
+
+				SystemTimer( EServerFrameSystem eSystem )
+					: m_eSystem( eSystem )
+				{
+					ServerFrameRecorder::Instance( ).BeginSystem( m_eSystem );
+				}
+
+				~SystemTimer( )
+				{
+					ServerFrameRecorder::Instance( ).EndSystem( m_eSystem );
+				}
+
+			private:
+
+				EServerFrameSystem	m_eSystem;
+		};
+
+	private:
+
+		// Appends data to the current frame's buffer.
+		void	Write( void const* pData, uint32 nSize );
+		void	WriteRecordHeader( ERecordType eType );
+		void	WriteMessageData( ILTMessage_Read& msg );
+
+		// Writes the buffered frame to the recording.
+		void	Flush( );
+
+		// Gets the index of an object's class, recording the class name the
+		// first time it is seen.
+		uint16	GetObjectClassIndex( HOBJECT hObject );
+
+		// Writes the frame time distribution of each system.
+		void	WriteReport( );
+
+	private:
+
+		typedef std::vector< uint8, LTAllocator<uint8, LT_MEM_TYPE_GAMECODE> > ByteBuffer;
+		typedef std::vector< float, LTAllocator<float, LT_MEM_TYPE_GAMECODE> > FloatList;
+
+		bool				m_bRecording;
+
+		// Set while the performance log has an objects scope open.
+		bool				m_bObjectsScopeOpen;
+		CLTFileWrite		m_cFile;
+		std::string			m_sFilename;
+
+		// Records for the current frame, written out as one block.
+		ByteBuffer			m_lstFrameBuffer;
+
+		// Scratch space for message data and checksum input.
+		ByteBuffer			m_lstMessageData;
+		FloatList			m_lstChecksumData;
+
+		// Frames recorded since Start.
+		uint32				m_nFrame;
+		TLTPrecisionTime	m_tmStart;
+		TLTPrecisionTime	m_tmSystemStart[kNumServerFrameSystems];
+		TLTPrecisionTime	m_tmUpdateEnd;
+
+		// Milliseconds spent in each system this frame.
+		float				m_fSystemMS[kNumServerFrameSystems];
+
+		// Distribution of the time spent in each system and in all of them.
+		ServerFrameTimeHistogram	m_SystemFrameMS[kNumServerFrameSystems];
+		ServerFrameTimeHistogram	m_FrameMS;
+
+		// Update times of each object class, in class index order.
+		struct ObjectClassStats
+		{
+			char	m_szName[64];
+			uint32	m_nUpdates;
+			double	m_fTotalMS;
+			float	m_fMaxMS;
+		};
+		typedef std::vector< ObjectClassStats, LTAllocator<ObjectClassStats, LT_MEM_TYPE_GAMECODE> > ObjectClassStatsList;
+		ObjectClassStatsList	m_lstObjectClassStats;
+
+		// Sorts object classes by total update time, largest first.
+		static bool	IsSlowerObjectClass( ObjectClassStats const& a, ObjectClassStats const& b ) { return a.m_fTotalMS > b.m_fTotalMS; }
+
+		typedef std::map< HCLASS, uint16, std::less<HCLASS>, LTAllocator<std::pair<const HCLASS, uint16>, LT_MEM_TYPE_GAMECODE> > ObjectClassIndexMap;
+		ObjectClassIndexMap		m_mapObjectClassIndices;
+
+		// When the last object update finished.
+		TLTPrecisionTime	m_tmObjectUpdateEnd;
+};
+
+#endif // __SERVERFRAMERECORDER_H__
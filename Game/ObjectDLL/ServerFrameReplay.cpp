@@ -0,0 +1,636 @@
+// ----------------------------------------------------------------------- //
+//
+// MODULE  : ServerFrameReplay.cpp
+//
+// PURPOSE : Reads and replays recordings made by ServerFrameRecorder.
+//
+// CREATED : 10/18/26
+//
+// (c) 2026 Monolith Productions, Inc.  All Rights Reserved
+//
+// ----------------------------------------------------------------------- //
+
+#include "Stdafx.h"
+#include "ServerFrameReplay.h"
+#include "GameServerShell.h"
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecordingReader::ServerFrameRecordingReader
+//
+//	PURPOSE:	ctor
+//
+// ----------------------------------------------------------------------- //
+ServerFrameRecordingReader::ServerFrameRecordingReader( )
+{
+	m_bOpen = false;
+	m_bCorrupt = false;
+	m_nFileSize = 0;
+	m_nRandomSeed = 0;
+	m_nNumSystems = 0;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecordingReader::~ServerFrameRecordingReader
+//
+//	PURPOSE:	dtor
+//
+// ----------------------------------------------------------------------- //
+ServerFrameRecordingReader::~ServerFrameRecordingReader( )
+{
+	Close( );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecordingReader::Open
+//
+//	PURPOSE:	Opens a recording and reads its header.
+//
+// ----------------------------------------------------------------------- //
+bool ServerFrameRecordingReader::Open( char const* pszFilename )
+{
+	Close( );
+
+	if( !pszFilename || !pszFilename[0] )
+		return false;
+
+	if( !m_cFile.Open( pszFilename ))
+		return false;
+
+	m_bOpen = true;
+
+	uint32 nFileID = 0;
+	uint32 nFileVersion = 0;
+	if( !m_cFile.GetFileSize( m_nFileSize ) ||
+		!Read( &nFileID, sizeof( nFileID )) ||
+		!Read( &nFileVersion, sizeof( nFileVersion )) ||
+		!Read( &m_nRandomSeed, sizeof( m_nRandomSeed )) ||
+		!Read( &m_nNumSystems, sizeof( m_nNumSystems )) ||
+		( nFileID != SERVERFRAMERECORDER_FILEID ) ||
+		( nFileVersion != SERVERFRAMERECORDER_VERSION ) ||
+		( m_nNumSystems != kNumServerFrameSystems ))
+	{
+		Close( );
+		return false;
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecordingReader::Close
+//
+//	PURPOSE:	Closes the recording.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameRecordingReader::Close( )
+{
+	if( m_bOpen )
+	{
+		m_cFile.Close( );
+	}
+
+	m_bOpen = false;
+	m_bCorrupt = false;
+	m_nFileSize = 0;
+	m_nRandomSeed = 0;
+	m_nNumSystems = 0;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecordingReader::Read
+//
+//	PURPOSE:	Reads data from the recording.
+//
+// ----------------------------------------------------------------------- //
+bool ServerFrameRecordingReader::Read( void* pData, uint32 nSize )
+{
+	if( !nSize )
+		return true;
+
+	uint64 nPos = 0;
+	if( !m_cFile.GetPos( nPos ) || ( nPos + nSize > m_nFileSize ))
+		return false;
+
+	return m_cFile.Read( pData, nSize );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameRecordingReader::ReadRecord
+//
+//	PURPOSE:	Reads the next record.
+//
+// ----------------------------------------------------------------------- //
+bool ServerFrameRecordingReader::ReadRecord( ServerFrameRecord& record )
+{
+	if( !m_bOpen || m_bCorrupt )
+		return false;
+
+	// A recording that ends between records ended cleanly.
+	uint64 nPos = 0;
+	if( !m_cFile.GetPos( nPos ))
+	{
+		m_bCorrupt = true;
+		return false;
+	}
+	if( nPos == m_nFileSize )
+		return false;
+
+	uint8 nType = 0;
+	bool bRead = Read( &nType, sizeof( nType )) && Read( &record.m_fTime, sizeof( record.m_fTime ));
+	record.m_eType = ( ServerFrameRecorder::ERecordType )nType;
+
+	if( bRead )
+	{
+		switch( record.m_eType )
+		{
+			case ServerFrameRecorder::eRecord_ClientAdded:
+			case ServerFrameRecorder::eRecord_ClientRemoved:
+			{
+				bRead = Read( &record.m_nClientId, sizeof( record.m_nClientId ));
+			}
+			break;
+
+			case ServerFrameRecorder::eRecord_Packet:
+			{
+				bRead = Read( &record.m_nDataBits, sizeof( record.m_nDataBits ));
+				record.m_lstData.clear( );
+			}
+			break;
+
+			case ServerFrameRecorder::eRecord_ClientMessage:
+			{
+				bRead = Read( &record.m_nClientId, sizeof( record.m_nClientId )) &&
+					Read( &record.m_nDataBits, sizeof( record.m_nDataBits ));
+
+				// Don't trust the size further than the end of the file.
+				uint32 nDataBytes = ( record.m_nDataBits + 7 ) / 8;
+				if( bRead && m_cFile.GetPos( nPos ) && ( nPos + nDataBytes <= m_nFileSize ))
+				{
+					record.m_lstData.resize( nDataBytes );
+					bRead = !nDataBytes || Read( &record.m_lstData[0], nDataBytes );
+				}
+				else
+				{
+					bRead = false;
+				}
+			}
+			break;
+
+			case ServerFrameRecorder::eRecord_FrameEnd:
+			{
+				bRead = Read( &record.m_nFrame, sizeof( record.m_nFrame )) &&
+					Read( &record.m_fSimulationTime, sizeof( record.m_fSimulationTime )) &&
+					Read( &record.m_fElapsedTime, sizeof( record.m_fElapsedTime )) &&
+					Read( &record.m_nNumObjects, sizeof( record.m_nNumObjects )) &&
+					Read( &record.m_nChecksum, sizeof( record.m_nChecksum )) &&
+					Read( record.m_fSystemMS, sizeof( record.m_fSystemMS ));
+			}
+			break;
+
+			case ServerFrameRecorder::eRecord_ObjectClass:
+			{
+				uint8 nNameLength = 0;
+				bRead = Read( &record.m_nClassIndex, sizeof( record.m_nClassIndex )) &&
+					Read( &nNameLength, sizeof( nNameLength )) &&
+					Read( record.m_szClassName, nNameLength );
+				record.m_szClassName[bRead ? nNameLength : 0] = '\0';
+			}
+			break;
+
+			case ServerFrameRecorder::eRecord_ObjectUpdate:
+			{
+				bRead = Read( &record.m_nClassIndex, sizeof( record.m_nClassIndex )) &&
+					Read( &record.m_fUpdateMS, sizeof( record.m_fUpdateMS ));
+			}
+			break;
+
+			default:
+			{
+				bRead = false;
+			}
+			break;
+		}
+	}
+
+	if( !bRead )
+	{
+		m_bCorrupt = true;
+		return false;
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameReplayShellTarget::OnClientAdded
+//
+//	PURPOSE:	Clients can't be created without a connection, so a replayed
+//				connect is never delivered.
+//
+// ----------------------------------------------------------------------- //
+bool ServerFrameReplayShellTarget::OnClientAdded( uint32 nClientId )
+{
+	return false;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameReplayShellTarget::OnClientRemoved
+//
+//	PURPOSE:	Disconnects are left to the real clients, so a replayed
+//				disconnect is never delivered.
+//
+// ----------------------------------------------------------------------- //
+bool ServerFrameReplayShellTarget::OnClientRemoved( uint32 nClientId )
+{
+	return false;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameReplayShellTarget::OnClientMessage
+//
+//	PURPOSE:	Hands a recorded message the server sent itself to the
+//				server shell.  Messages from clients are not delivered,
+//				since the recorded client isn't connected.
+//
+// ----------------------------------------------------------------------- //
+bool ServerFrameReplayShellTarget::OnClientMessage( uint32 nClientId, uint8 const* pData, uint32 nDataBits )
+{
+	if( nClientId != ( uint32 )-1 )
+		return false;
+
+	CAutoMessage cMsg;
+	cMsg.WriteData( pData, nDataBits );
+	CLTMsgRef_Read cReadMsg = cMsg.Read( );
+	g_pGameServerShell->OnMessage( NULL, cReadMsg );
+
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameReplay::ServerFrameReplay
+//
+//	PURPOSE:	ctor
+//
+// ----------------------------------------------------------------------- //
+ServerFrameReplay::ServerFrameReplay( )
+{
+	m_pTarget = NULL;
+	m_bReplaying = false;
+	m_nFrames = 0;
+	m_nUncheckedFrames = 0;
+	m_nDivergentFrames = 0;
+	m_nFirstDivergentFrame = 0;
+	m_nFrameGaps = 0;
+	m_nUndeliveredInputs = 0;
+	m_nPackets = 0;
+	memset( &m_FrameEnd.m_fSystemMS, 0, sizeof( m_FrameEnd.m_fSystemMS ));
+	m_FrameEnd.m_nFrame = 0;
+	m_FrameEnd.m_nNumObjects = 0;
+	m_FrameEnd.m_nChecksum = 0;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameReplay::~ServerFrameReplay
+//
+//	PURPOSE:	dtor
+//
+// ----------------------------------------------------------------------- //
+ServerFrameReplay::~ServerFrameReplay( )
+{
+	Stop( );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameReplay::Start
+//
+//	PURPOSE:	Starts replaying a recording into pTarget.
+//
+// ----------------------------------------------------------------------- //
+bool ServerFrameReplay::Start( char const* pszFilename, IServerFrameReplayTarget* pTarget )
+{
+	Stop( );
+
+	if( !pTarget || !m_Reader.Open( pszFilename ))
+	{
+		g_pLTServer->CPrint( "ServerFrameReplay: could not read %s", pszFilename ? pszFilename : "" );
+		return false;
+	}
+
+	m_pTarget = pTarget;
+	m_bReplaying = true;
+	m_nFrames = 0;
+	m_nUncheckedFrames = 0;
+	m_nDivergentFrames = 0;
+	m_nFirstDivergentFrame = 0;
+	m_nFrameGaps = 0;
+	m_nUndeliveredInputs = 0;
+	m_nPackets = 0;
+
+	for( uint32 nSystem = 0; nSystem < kNumServerFrameSystems; ++nSystem )
+	{
+		m_RecordedSystemMS[nSystem].Clear( );
+	}
+	m_RecordedFrameMS.Clear( );
+	m_ReplayedFrameMS.Clear( );
+
+	g_pLTServer->CPrint( "ServerFrameReplay: replaying %s", pszFilename );
+
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameReplay::Stop
+//
+//	PURPOSE:	Stops replaying and prints the results.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameReplay::Stop( )
+{
+	if( !m_bReplaying )
+		return;
+
+	if( m_Reader.IsCorrupt( ))
+	{
+		g_pLTServer->CPrint( "ServerFrameReplay: the recording is damaged after frame %u", m_FrameEnd.m_nFrame );
+	}
+
+	m_Reader.Close( );
+	m_pTarget = NULL;
+	m_bReplaying = false;
+
+	g_pLTServer->CPrint( "ServerFrameReplay: %u frames, %u compared, %u diverged (first %u), %u frame gaps, %u packets",
+		m_nFrames, m_nFrames - m_nUncheckedFrames, m_nDivergentFrames, m_nFirstDivergentFrame, m_nFrameGaps, m_nPackets );
+	if( m_nUndeliveredInputs )
+	{
+		g_pLTServer->CPrint( "ServerFrameReplay: %u client inputs could not be delivered, so the %u frames from the first of them on were not compared",
+			m_nUndeliveredInputs, m_nUncheckedFrames );
+	}
+	g_pLTServer->CPrint( "%-12s %10s %10s %10s %10s %10s %10s", "Frame ms", "Mean", "Min", "Median", "95%", "99%", "Max" );
+
+	for( uint32 nRow = 0; nRow < kNumServerFrameSystems + 2; ++nRow )
+	{
+		ServerFrameTimeHistogram const* pHistogram = NULL;
+		char const* pszName = NULL;
+		if( nRow < kNumServerFrameSystems )
+		{
+			pHistogram = &m_RecordedSystemMS[nRow];
+			pszName = ServerFrameRecorder::GetSystemName(( EServerFrameSystem )nRow );
+		}
+		else if( nRow == kNumServerFrameSystems )
+		{
+			pHistogram = &m_RecordedFrameMS;
+			pszName = "Recorded";
+		}
+		else
+		{
+			pHistogram = &m_ReplayedFrameMS;
+			pszName = "Replayed";
+		}
+
+		g_pLTServer->CPrint( "%-12s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f", pszName,
+			pHistogram->GetMean( ), pHistogram->GetMin( ), pHistogram->GetPercentile( 50.0f ),
+			pHistogram->GetPercentile( 95.0f ), pHistogram->GetPercentile( 99.0f ), pHistogram->GetMax( ));
+	}
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameReplay::BeginFrame
+//
+//	PURPOSE:	Hands the inputs recorded before the next frame ended to the
+//				target.
+//
+// ----------------------------------------------------------------------- //
+bool ServerFrameReplay::BeginFrame( )
+{
+	if( !m_bReplaying )
+		return false;
+
+	m_tmFrameStart = LTTimeUtils::GetPrecisionTime( );
+
+	while( m_Reader.ReadRecord( m_Record ))
+	{
+		bool bDelivered = true;
+		switch( m_Record.m_eType )
+		{
+			case ServerFrameRecorder::eRecord_ClientAdded:
+			{
+				bDelivered = m_pTarget->OnClientAdded( m_Record.m_nClientId );
+			}
+			break;
+
+			case ServerFrameRecorder::eRecord_ClientRemoved:
+			{
+				bDelivered = m_pTarget->OnClientRemoved( m_Record.m_nClientId );
+			}
+			break;
+
+			case ServerFrameRecorder::eRecord_ClientMessage:
+			{
+				bDelivered = m_pTarget->OnClientMessage( m_Record.m_nClientId,
+					m_Record.m_lstData.empty( ) ? NULL : &m_Record.m_lstData[0], m_Record.m_nDataBits );
+			}
+			break;
+
+			// Only the arrival of a packet is recorded.
+			case ServerFrameRecorder::eRecord_Packet:
+			{
+				++m_nPackets;
+			}
+			break;
+
+			case ServerFrameRecorder::eRecord_FrameEnd:
+			{
+				if( m_nFrames && ( m_Record.m_nFrame != m_FrameEnd.m_nFrame + 1 ))
+				{
+					++m_nFrameGaps;
+				}
+
+				m_FrameEnd.m_nFrame = m_Record.m_nFrame;
+				m_FrameEnd.m_fSimulationTime = m_Record.m_fSimulationTime;
+				m_FrameEnd.m_fElapsedTime = m_Record.m_fElapsedTime;
+				m_FrameEnd.m_nNumObjects = m_Record.m_nNumObjects;
+				m_FrameEnd.m_nChecksum = m_Record.m_nChecksum;
+				memcpy( m_FrameEnd.m_fSystemMS, m_Record.m_fSystemMS, sizeof( m_FrameEnd.m_fSystemMS ));
+
+				float fFrameMS = 0.0f;
+				for( uint32 nSystem = 0; nSystem < kNumServerFrameSystems; ++nSystem )
+				{
+					m_RecordedSystemMS[nSystem].Add( m_FrameEnd.m_fSystemMS[nSystem] );
+					fFrameMS += m_FrameEnd.m_fSystemMS[nSystem];
+				}
+				m_RecordedFrameMS.Add( fFrameMS );
+
+				return true;
+			}
+			break;
+
+			// Object updates are results of the frame, not inputs.
+			default:
+			break;
+		}
+
+		if( !bDelivered )
+		{
+			++m_nUndeliveredInputs;
+		}
+	}
+
+	return false;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameReplay::EndFrame
+//
+//	PURPOSE:	Compares the frame with the recording.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameReplay::EndFrame( uint32 nNumObjects, uint32 nChecksum )
+{
+	if( !m_bReplaying )
+		return;
+
+	m_ReplayedFrameMS.Add(( float )LTTimeUtils::GetPrecisionTimeIntervalMS( m_tmFrameStart, LTTimeUtils::GetPrecisionTime( )));
+	++m_nFrames;
+
+	// The frame can't match the recording once an input was missed.
+	if( m_nUndeliveredInputs )
+	{
+		++m_nUncheckedFrames;
+		return;
+	}
+
+	if(( nNumObjects != m_FrameEnd.m_nNumObjects ) || ( nChecksum != m_FrameEnd.m_nChecksum ))
+	{
+		if( !m_nDivergentFrames )
+		{
+			m_nFirstDivergentFrame = m_FrameEnd.m_nFrame;
+			g_pLTServer->CPrint( "ServerFrameReplay: frame %u diverged, %u objects (recorded %u), checksum %08x (recorded %08x)",
+				m_FrameEnd.m_nFrame, nNumObjects, m_FrameEnd.m_nNumObjects, nChecksum, m_FrameEnd.m_nChecksum );
+		}
+
+		++m_nDivergentFrames;
+	}
+}
+
+#ifndef _FINAL
+
+// ----------------------------------------------------------------------- //
+//
+// class ServerFrameReplayStubTarget
+//
+// Stands in for the engine when a recording is checked on its own.  Inputs
+// are checked against the client connects and disconnects seen so far.
+//
+// ----------------------------------------------------------------------- //
+class ServerFrameReplayStubTarget : public IServerFrameReplayTarget
+{
+	public:
+
+		ServerFrameReplayStubTarget( )
+		{
+			memset( m_bConnected, 0, sizeof( m_bConnected ));
+			m_nMessages = 0;
+			m_nBadInputs = 0;
+		}
+
+		virtual bool OnClientAdded( uint32 nClientId )
+		{
+			if( !IsValidClientId( nClientId ) || m_bConnected[nClientId] )
+			{
+				++m_nBadInputs;
+				return false;
+			}
+
+			m_bConnected[nClientId] = true;
+			return true;
+		}
+
+		virtual bool OnClientRemoved( uint32 nClientId )
+		{
+			// Clients connected before recording started have no connect record.
+			if( !IsValidClientId( nClientId ))
+			{
+				++m_nBadInputs;
+				return false;
+			}
+
+			m_bConnected[nClientId] = false;
+			return true;
+		}
+
+		virtual bool OnClientMessage( uint32 nClientId, uint8 const* pData, uint32 nDataBits )
+		{
+			++m_nMessages;
+			if((( nClientId != ( uint32 )-1 ) && !IsValidClientId( nClientId )) || ( !pData && nDataBits ))
+			{
+				++m_nBadInputs;
+				return false;
+			}
+
+			return true;
+		}
+
+		uint32	m_nMessages;
+		uint32	m_nBadInputs;
+
+	private:
+
+		enum { kMaxClientId = 256 };
+
+		static bool IsValidClientId( uint32 nClientId ) { return ( nClientId < kMaxClientId ); }
+
+		bool	m_bConnected[kMaxClientId];
+};
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ServerFrameReplay::RunReplayCheck
+//
+//	PURPOSE:	Replays a recording into a stub target.  Every frame is
+//				ended with its recorded results, so this only checks that
+//				the recording is well formed and consistent.  Nothing is
+//				run, so no verdict on the replay itself is given.
+//
+// ----------------------------------------------------------------------- //
+void ServerFrameReplay::RunReplayCheck( char const* pszFilename )
+{
+	ServerFrameReplayStubTarget cStubTarget;
+	ServerFrameReplay cReplay;
+	if( !cReplay.Start( pszFilename, &cStubTarget ))
+	{
+		g_pLTServer->CPrint( "ServerFrameReplayCheck: could not read the recording" );
+		return;
+	}
+
+	while( cReplay.BeginFrame( ))
+	{
+		ServerFrameRecord const& frameEnd = cReplay.GetRecordedFrame( );
+		cReplay.EndFrame( frameEnd.m_nNumObjects, frameEnd.m_nChecksum );
+	}
+
+	bool bCorrupt = cReplay.m_Reader.IsCorrupt( );
+	uint32 nFrameGaps = cReplay.m_nFrameGaps;
+	uint32 nPackets = cReplay.m_nPackets;
+	cReplay.Stop( );
+
+	g_pLTServer->CPrint( "ServerFrameReplayCheck: %u messages, %u packets, %u bad inputs, the recording is %s",
+		cStubTarget.m_nMessages, nPackets, cStubTarget.m_nBadInputs,
+		( !bCorrupt && !nFrameGaps && !cStubTarget.m_nBadInputs ) ? "well formed" : "damaged" );
+}
+
+#endif // _FINAL
@@ -0,0 +1,213 @@
+// ----------------------------------------------------------------------- //
+//
+// MODULE  : ServerFrameReplay.h
+//
+// PURPOSE : Reads and replays recordings made by ServerFrameRecorder.
+//
+// CREATED : 10/18/26
+//
+// (c) 2026 Monolith Productions, Inc.  All Rights Reserved
+//
+// ----------------------------------------------------------------------- //
+
+#ifndef __SERVERFRAMEREPLAY_H__
+#define __SERVERFRAMEREPLAY_H__
+
+#include "ServerFrameRecorder.h"
+#include "ltfileread.h"
+
+// One record read back from a recording.  Only the members for the record's
+// type are filled in.
+struct ServerFrameRecord
+{
+	typedef std::vector< uint8, LTAllocator<uint8, LT_MEM_TYPE_GAMECODE> > ByteBuffer;
+
+	ServerFrameRecorder::ERecordType	m_eType;
+
+	// Real time in seconds since recording started.
+	float		m_fTime;
+
+	// eRecord_ClientAdded, eRecord_ClientRemoved, eRecord_ClientMessage.
+	uint32		m_nClientId;
+
+	// eRecord_ClientMessage, eRecord_Packet.  Packets have no data.
+	uint32		m_nDataBits;
+	ByteBuffer	m_lstData;
+
+	// eRecord_FrameEnd.
+	uint32		m_nFrame;
+	double		m_fSimulationTime;
+	float		m_fElapsedTime;
+	uint32		m_nNumObjects;
+	uint32		m_nChecksum;
+	float		m_fSystemMS[kNumServerFrameSystems];
+
+	// eRecord_ObjectClass, eRecord_ObjectUpdate.
+	uint16		m_nClassIndex;
+	char		m_szClassName[256];
+	float		m_fUpdateMS;
+};
+
+// ----------------------------------------------------------------------- //
+//
+// class ServerFrameRecordingReader
+//
+// Reads the records of a recording in order.
+//
+// ----------------------------------------------------------------------- //
+class ServerFrameRecordingReader
+{
+	public:
+
+		ServerFrameRecordingReader( );
+		~ServerFrameRecordingReader( );
+
+		// Opens a recording and reads its header.
+		bool	Open( char const* pszFilename );
+		void	Close( );
+
+		bool	IsOpen( ) const { return m_bOpen; }
+		uint32	GetRandomSeed( ) const { return m_nRandomSeed; }
+
+		// Reads the next record.  Returns false at the end of the recording,
+		// or if the rest of it can't be read, in which case IsCorrupt is true.
+		bool	ReadRecord( ServerFrameRecord& record );
+		bool	IsCorrupt( ) const { return m_bCorrupt; }
+
+	private:
+
+		bool	Read( void* pData, uint32 nSize );
+
+		CLTFileRead		m_cFile;
+		bool			m_bOpen;
+		bool			m_bCorrupt;
+		uint64			m_nFileSize;
+		uint32			m_nRandomSeed;
+		uint32			m_nNumSystems;
+
+		PREVENT_OBJECT_COPYING( ServerFrameRecordingReader );
+};
+
+// ----------------------------------------------------------------------- //
+//
+// class IServerFrameReplayTarget
+//
+// Receives the inputs of a replayed recording.  ServerFrameReplayShellTarget
+// hands them to the game server shell.  A stub target can stand in for the
+// engine when only the recording itself is being checked.  Connectionless
+// packets are recorded without their contents, so they are not inputs.
+//
+// ----------------------------------------------------------------------- //
+class IServerFrameReplayTarget
+{
+	public:
+
+		virtual ~IServerFrameReplayTarget( ) { }
+
+		// Each returns false if the input could not be delivered.
+		virtual bool	OnClientAdded( uint32 nClientId ) = 0;
+		virtual bool	OnClientRemoved( uint32 nClientId ) = 0;
+		virtual bool	OnClientMessage( uint32 nClientId, uint8 const* pData, uint32 nDataBits ) = 0;
+};
+
+// ----------------------------------------------------------------------- //
+//
+// class ServerFrameReplayShellTarget
+//
+// Hands replayed inputs to CGameServerShell.  Clients can't be created
+// without a connection, so only the messages the server sent itself can be
+// delivered.  Client connects, disconnects and messages are not delivered,
+// even if a live client happens to have the recorded id.
+//
+// ----------------------------------------------------------------------- //
+class ServerFrameReplayShellTarget : public IServerFrameReplayTarget
+{
+	public:
+
+		virtual bool	OnClientAdded( uint32 nClientId );
+		virtual bool	OnClientRemoved( uint32 nClientId );
+		virtual bool	OnClientMessage( uint32 nClientId, uint8 const* pData, uint32 nDataBits );
+};
+
+// ----------------------------------------------------------------------- //
+//
+// class ServerFrameReplay
+//
+// Replays a recording frame by frame.  BeginFrame hands the inputs recorded
+// before the next frame ended to the target, and EndFrame compares the
+// world with the checksum recorded for that frame.  Once an input could not
+// be delivered the replay no longer matches the recording, so the frames
+// after it are not compared.  When the replay stops, the recorded and
+// replayed frame times and the first frame that diverged are printed.
+//
+// ----------------------------------------------------------------------- //
+class ServerFrameReplay
+{
+	public:
+
+		ServerFrameReplay( );
+		~ServerFrameReplay( );
+
+		// Starts replaying a recording into pTarget.
+		bool	Start( char const* pszFilename, IServerFrameReplayTarget* pTarget );
+
+		// Stops replaying and prints the results.
+		void	Stop( );
+
+		bool	IsReplaying( ) const { return m_bReplaying; }
+
+		// The random seed the recording was made with.
+		uint32	GetRandomSeed( ) const { return m_Reader.GetRandomSeed( ); }
+
+		// Hands the inputs for the next frame to the target.  Returns false
+		// once the recording has no more frames.
+		bool	BeginFrame( );
+
+		// Compares the frame with the recording.
+		void	EndFrame( uint32 nNumObjects, uint32 nChecksum );
+
+		// The recorded results of the current frame.
+		ServerFrameRecord const& GetRecordedFrame( ) const { return m_FrameEnd; }
+
+		uint32	GetNumFrames( ) const { return m_nFrames; }
+		uint32	GetNumUncheckedFrames( ) const { return m_nUncheckedFrames; }
+		uint32	GetNumDivergentFrames( ) const { return m_nDivergentFrames; }
+		uint32	GetNumUndeliveredInputs( ) const { return m_nUndeliveredInputs; }
+
+#ifndef _FINAL
+		// Replays a recording into a stub target, checking the recording is
+		// well formed and printing its frame time distributions.  Nothing is
+		// run, so this says nothing about whether a replay would match.
+		static void	RunReplayCheck( char const* pszFilename );
+#endif // _FINAL
+
+	private:
+
+		ServerFrameRecordingReader	m_Reader;
+		IServerFrameReplayTarget*	m_pTarget;
+		bool						m_bReplaying;
+
+		// Scratch record and the end of the current frame.
+		ServerFrameRecord			m_Record;
+		ServerFrameRecord			m_FrameEnd;
+
+		TLTPrecisionTime			m_tmFrameStart;
+
+		uint32						m_nFrames;
+		uint32						m_nUncheckedFrames;
+		uint32						m_nDivergentFrames;
+		uint32						m_nFirstDivergentFrame;
+		uint32						m_nFrameGaps;
+		uint32						m_nUndeliveredInputs;
+		uint32						m_nPackets;
+
+		// Distribution of the recorded times of each system and of the
+		// recorded and replayed frames.
+		ServerFrameTimeHistogram	m_RecordedSystemMS[kNumServerFrameSystems];
+		ServerFrameTimeHistogram	m_RecordedFrameMS;
+		ServerFrameTimeHistogram	m_ReplayedFrameMS;
+
+		PREVENT_OBJECT_COPYING( ServerFrameReplay );
+};
+
+#endif // __SERVERFRAMEREPLAY_H__
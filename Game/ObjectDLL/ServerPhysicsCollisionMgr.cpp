@@ -207,22 +207,15 @@ float ServerPhysicsCollisionMgr::FindStimulusRadius( CollisionResponse const& co
 
 	uint32 nIndexFound;
 	uint32 nImpulseFound;
-	if( !FindImpulseInTable( collisionResponse.GetImpulse( ), hStruct, AIStimulusRadiusImpulseAccessCB, nIndexFound, nImpulseFound ))
+	uint32 nMaxImpulse;
+	if( !FindImpulseRangeInTable( collisionResponse.GetImpulse( ), hStruct, AIStimulusRadiusImpulseAccessCB, nIndexFound, nImpulseFound, nMaxImpulse ))
 		return 0.f;
 
 	// Get the minimum radius to use.
 	float fMinRadius = (float)DATABASE_CATEGORY( CollisionProperty ).GETSTRUCTATTRIB( AIStimulusRadius, hStruct, nIndexFound, Radius );
 
-	// If there are no more struct entries, then just use the minimum radius.
-	uint32 nNumStructs = g_pLTDatabase->GetNumValues( hStruct );
-	if( nIndexFound + 1 == nNumStructs )
-	{
-		return fMinRadius;
-	}
-
-	// Get the  maximum impulse from the next higher struct entry.
-	uint32 nMaxImpulse = DATABASE_CATEGORY( CollisionProperty ).GETSTRUCTATTRIB( AIStimulusRadius, hStruct, nIndexFound + 1, Impulse );
-	// If it's infinite, then just use the minimum.
+	// If there are no more struct entries, or the next higher struct entry
+	// is infinite, then just use the minimum radius.
 	if( nMaxImpulse == ( uint32 )-1 )
 		return fMinRadius;
 
@@ -25,6 +25,7 @@
 #include "ltfileoperations.h"
 #include "iltfilemgr.h"
 #include "ServerConnectionMgr.h"
+#include "ltinterlockedoperations.h"
 
 // 
 // Globals...
@@ -57,6 +58,7 @@ CServerSaveLoadMgr::CServerSaveLoadMgr( )
 	m_bWaitingForAutoLoadResponses = false;
 	m_bLoadingLevel = false;
 	m_bCanSaveOverride = true;
+	m_nSaveDirWriteFailed = 0;
 }
 
 
@@ -97,6 +99,10 @@ bool CServerSaveLoadMgr::Init( char const* pszProfileName, bool bUseMultiplayerF
 
 	m_eSaveDataState = eSaveDataStateNone;
 	m_bPlayerTrackerAborted = false;
+	m_nSaveDirWriteFailed = 0;
+
+	// Find out about saves that fail after FinishSaveGame has returned.
+	m_delegateSaveDirWriterFinished.Attach( this, &GetSaveDirWriter( ), GetSaveDirWriter( ).Finished );
 
 	// Clear working dir since we're starting fresh.
 	ClearWorkingDir( );
@@ -116,6 +122,8 @@ bool CServerSaveLoadMgr::Init( char const* pszProfileName, bool bUseMultiplayerF
 void CServerSaveLoadMgr::Term( )
 {
 	CSaveLoadMgr::Term( );
+
+	m_delegateSaveDirWriterFinished.Detach( );
 }
 
 
@@ -687,6 +695,34 @@ void CServerSaveLoadMgr::Update( )
 			FinishAutoLoad( );
 		}
 	}
+
+	// Tell the clients about a save that failed to copy in the background.
+	if( LTInterlockedOperations::InterlockedExchange( &m_nSaveDirWriteFailed, 0 ))
+	{
+		CAutoMessage cMsg;
+		cMsg.Writeuint8( MID_SAVE_GAME );
+		cMsg.Writebool( false );
+		cMsg.Writebool( false );
+		g_pLTServer->SendToClient( cMsg.Read(), NULL, MESSAGE_GUARANTEED );
+	}
+}
+
+// --------------------------------------------------------------------------- //
+//
+//	ROUTINE:	CServerSaveLoadMgr::OnSaveDirWriterFinished
+//
+//	PURPOSE:	Called on the save dir writer's thread when a save has
+//				finished copying.  Only flags the failure, Update reports it.
+//
+// --------------------------------------------------------------------------- //
+
+void CServerSaveLoadMgr::OnSaveDirWriterFinished( CServerSaveLoadMgr* pServerSaveLoadMgr, CSaveDirWriter* pSaveDirWriter, EventCaster::NotifyParams& notifyParams )
+{
+	CSaveDirWriter::FinishedNotifyParams& finishedParams = ( CSaveDirWriter::FinishedNotifyParams& )notifyParams;
+	if( !finishedParams.m_bResult )
+	{
+		LTInterlockedOperations::InterlockedExchange( &pServerSaveLoadMgr->m_nSaveDirWriteFailed, 1 );
+	}
 }
 
 // ----------------------------------------------------------------------- //
@@ -1246,6 +1282,9 @@ bool CServerSaveLoadMgr::FinishTransitionLevels( )
 	g_pLTBase->FileMgr()->GetAbsoluteUserFileName( GetWorldSaveFile( m_sSaveDataNewLevel.c_str(), g_pServerSaveLoadMgr->GetProfileName() ), 
 		szAbsFile, LTARRAYSIZE( szAbsFile ));
 
+	// The last save may still be reading the working dir.
+	WaitForWorkingDirCopy( );
+
 	// See if we have already visited the level we are transitioning to.
 	bool bRestoreLevel = CWinUtil::FileExist( szAbsFile );
 
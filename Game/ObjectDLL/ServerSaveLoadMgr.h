@@ -152,6 +152,10 @@ class CServerSaveLoadMgr : public CSaveLoadMgr, public IPlayerTrackerReceiver
 		// One of the clients couldn't save
 		void			HandleSaveFailed();
 
+		// Called on the save dir writer's thread when a save has finished copying.
+		static void		OnSaveDirWriterFinished( CServerSaveLoadMgr* pServerSaveLoadMgr, CSaveDirWriter* pSaveDirWriter, EventCaster::NotifyParams& notifyParams );
+		Delegate< CServerSaveLoadMgr, CSaveDirWriter, CServerSaveLoadMgr::OnSaveDirWriterFinished > m_delegateSaveDirWriterFinished;
+
 
 
 	// Data.
@@ -185,6 +189,9 @@ class CServerSaveLoadMgr : public CSaveLoadMgr, public IPlayerTrackerReceiver
 
 		// Override to disallow saving.
 		bool			m_bCanSaveOverride;
+
+		// Set by OnSaveDirWriterFinished when a save failed to copy.  Update polls for it.
+		uint32			m_nSaveDirWriteFailed;
 };
 
 #endif // __SERVERSAVELOADMGR_H__
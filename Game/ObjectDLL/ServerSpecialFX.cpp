@@ -581,8 +581,9 @@ struct SEffectHeader
 				
 bool SpecialFXPlugin::ParseEffectFile(const char *pszFilename, char **aszStrings, uint32 *pcStrings, const uint32 cMaxStrings, const uint32 cMaxStringLength )
 {
+	//map the file where the platform supports it so that the tables can be used in place
 	CLTFileRead cFileRead;
-	if (!cFileRead.Open(pszFilename))
+	if (!cFileRead.OpenMapped(pszFilename, ILTFileRead::eAccessRandom))
 	{
 		return false;
 	}
@@ -601,52 +602,78 @@ bool SpecialFXPlugin::ParseEffectFile(const char *pszFilename, char **aszStrings
 		return false;
 	}
 
-	//now allocate and load the whole table
-	char* pszStringTable = debug_newa(char, Header.m_nStringTableSize);
-	if(!pszStringTable)
+	//the string table must end with a terminator so that no string runs off the end of it
+	if (Header.m_nStringTableSize == 0)
 	{
 		return false;
 	}
 
-	//read in the string table
-	if (!cFileRead.Seek(Header.m_nStringTableOffset))
+	//use the string table in place if the file is mapped, otherwise allocate and load it
+	char* pszLoadedStringTable = NULL;
+	const char* pszStringTable = (const char*)cFileRead.GetMappedRange(Header.m_nStringTableOffset, Header.m_nStringTableSize);
+	if (!pszStringTable)
 	{
-		return false;
+		pszLoadedStringTable = debug_newa(char, Header.m_nStringTableSize);
+		if(!pszLoadedStringTable)
+		{
+			return false;
+		}
+
+		if (!cFileRead.Seek(Header.m_nStringTableOffset) || !cFileRead.Read(pszLoadedStringTable, Header.m_nStringTableSize))
+		{
+			debug_deletea(pszLoadedStringTable);
+			return false;
+		}
+
+		pszStringTable = pszLoadedStringTable;
 	}
 
-	if (!cFileRead.Read(pszStringTable, Header.m_nStringTableSize))
+	if (pszStringTable[Header.m_nStringTableSize - 1] != '\0')
 	{
+		debug_deletea(pszLoadedStringTable);
 		return false;
 	}
-	
-	//now read in the effect list
-	if (!cFileRead.Seek(Header.m_nEffectListOffset))
+
+	//now read in the effect list, again in place if the file is mapped
+	const uint32* pMappedIndices = (const uint32*)cFileRead.GetMappedRange(Header.m_nEffectListOffset, (uint64)Header.m_nTotalEffects * sizeof(uint32));
+	if (!pMappedIndices && !cFileRead.Seek(Header.m_nEffectListOffset))
 	{
+		debug_deletea(pszLoadedStringTable);
 		return false;
 	}
 
+	bool bSuccess = true;
 	for(uint32 nCurrEffect = 0; nCurrEffect < Header.m_nTotalEffects; nCurrEffect++)
 	{
 		//read in the index into the string table
 		uint32 nIndex = 0;
-		if (!cFileRead.Read(&nIndex, sizeof(nIndex)))
+		if (pMappedIndices)
 		{
-			return false;
+			nIndex = pMappedIndices[nCurrEffect];
+		}
+		else if (!cFileRead.Read(&nIndex, sizeof(nIndex)))
+		{
+			bSuccess = false;
+			break;
 		}
 
 		//make sure we have room
 		if(*pcStrings >= cMaxStrings)
 			break;
 
+		//skip any index that is outside of the string table
+		if(nIndex >= Header.m_nStringTableSize)
+			continue;
+
 		//and add this string to our list of strings
 		LTStrCpy( aszStrings[(*pcStrings)++], &pszStringTable[nIndex], cMaxStringLength );
 	}
 
 	//free up everything
-	delete [] pszStringTable;
+	debug_deletea(pszLoadedStringTable);
 	cFileRead.Close();
 
-	return true;
+	return bSuccess;
 }
 
 // ----------------------------------------------------------------------- //
@@ -196,7 +196,8 @@ Trigger::Trigger()
 	m_bSendTriggerFXMsg			( false ),
 	m_nTeamID					( INVALID_TEAM ),
 	m_pTriggerCS				( NULL ),
-	m_saCommands				( )
+	m_saCommands				( ),
+	m_lstParsedCommands			( )
 {
 	m_dwFlags				= (FLAG_TOUCH_NOTIFY | FLAG_GOTHRUWORLD);
 	
@@ -782,15 +783,28 @@ bool Trigger::Activate()
 		}
 	}
 
+	// Parse the commands once so activating again just queues copies of them...
+
+	if( m_lstParsedCommands.size() != m_saCommands.size() )
+	{
+		m_lstParsedCommands.clear();
+		m_lstParsedCommands.resize( m_saCommands.size() );
+	}
+
 	// Loop through the commands and execute them...
 
-	StringArray::iterator iter;
-	for( iter = m_saCommands.begin(); iter != m_saCommands.end(); ++iter )
+	for( uint32 nCommand = 0; nCommand < m_saCommands.size(); ++nCommand )
 	{
-		if( !(*iter).empty() )
+		if( m_saCommands[nCommand].empty() )
+			continue;
+
+		CParsedCmdList &cmdList = m_lstParsedCommands[nCommand];
+		if( !cmdList.IsParsed() )
 		{
-			g_pCmdMgr->QueueCommand( (*iter).c_str(), m_hTouchObject, m_hTouchObject );
+			g_pCmdMgr->ParseCommandList( m_saCommands[nCommand].c_str(), cmdList );
 		}
+
+		g_pCmdMgr->QueueCommand( cmdList, m_hTouchObject, m_hTouchObject );
 	}
 
 	// Clear the toucher.
@@ -955,6 +969,7 @@ void Trigger::Load(ILTMessage_Read *pMsg, uint32 dwLoadFlags)
 
 	m_saCommands.clear();
 	m_saCommands.resize( nSize );
+	m_lstParsedCommands.clear();
 
 	for( uint32 i=0; i < nSize; ++i )
 	{
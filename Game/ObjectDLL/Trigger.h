@@ -57,6 +57,10 @@ class Trigger : public GameBase
 
 		StringArray	m_saCommands;			// Commands to execute
 
+		// Each command of m_saCommands parsed the first time the trigger activates...
+		typedef std::vector<CParsedCmdList, LTAllocator<CParsedCmdList, LT_MEM_TYPE_OBJECTSHELL> > TParsedCmdListArray;
+		TParsedCmdListArray	m_lstParsedCommands;
+
 		LTObjRef	m_hTouchObject;				// Object that touched me
 
 		bool		m_bPlayerTriggerable;	// Can the Player trigger me?
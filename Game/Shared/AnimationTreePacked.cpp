@@ -26,6 +26,7 @@
 CAnimationTreePacked::CAnimationTreePacked()
 {
 	m_pDataBlock = NULL;
+	m_nDataBlockSize = 0;
 
 	m_eTreeID = kATTreeID_Invalid;
 
@@ -68,11 +69,27 @@ CAnimationTreePacked::CAnimationTreePacked()
 
 CAnimationTreePacked::~CAnimationTreePacked()
 {
-	// All member pointers point into this block of data.
+	// All member pointers point into this block of data, or into
+	// the shared mapping, which is released by its destructor.
 
 	delete [] m_pDataBlock;
 }
 
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAnimationTreePacked::GetBlendData
+//
+//	PURPOSE:	Resolve packed blend data.
+//
+// ----------------------------------------------------------------------- //
+
+void CAnimationTreePacked::GetBlendData( const AT_BLENDDATA& PackedBlendData, BLENDDATA& outBlendData ) const
+{
+	outBlendData.fBlendDuration = PackedBlendData.fBlendDuration;
+	outBlendData.szBlendWeightSet = GetStringFromTableByOffset( PackedBlendData.iBlendWeightSet );
+	outBlendData.iBlendFlags = PackedBlendData.iBlendFlags;
+}
+
 // ----------------------------------------------------------------------- //
 //
 //	ROUTINE:	CAnimationTreePacked::GetAnimationProps
@@ -83,27 +100,20 @@ CAnimationTreePacked::~CAnimationTreePacked()
 
 bool CAnimationTreePacked::GetAnimationProps( AT_ANIMATION_ID eAnimation, CAnimationProps &rProps )
 {
-	AT_ANIMATION* pAnim = GetAnimation( eAnimation );
-	if( !pAnim )
+	if( !GetAnimation( eAnimation ) )
 	{
 		return false;
 	}
 
-	// Clear any existing props.
-	rProps.Clear( );
-
-	// Retrieve a prop for each group defined in the tree.
+	// An animation's props are those of the pattern that lists it.
 
-	EnumAnimProp eProp;
-	EnumAnimPropGroup eGroup;
-	for( uint32 iGroup=0; iGroup < m_cAnimPropGroups; ++iGroup )
+	uint32 iPattern = m_lstAnimationPatterns[eAnimation];
+	if( iPattern == AT_INVALID_INDEX )
 	{
-		eGroup = m_aAnimPropGroups[iGroup].eAnimPropGroup;
-		eProp = pAnim->aAnimationAnimProps[iGroup];
-		rProps.Set( eGroup, eProp );
+		return false;
 	}
 
-	return true;
+	return GetPatternProps( &( m_aPatterns[iPattern] ), &rProps );
 }
 
 // ----------------------------------------------------------------------- //
@@ -116,7 +126,7 @@ bool CAnimationTreePacked::GetAnimationProps( AT_ANIMATION_ID eAnimation, CAnima
 
 bool CAnimationTreePacked::GetAnimationDescriptors( AT_ANIMATION_ID eAnimation, CAnimationDescriptors &rDescs )
 {
-	AT_ANIMATION* pAnim = GetAnimation( eAnimation );
+	const AT_ANIMATION* pAnim = GetAnimation( eAnimation );
 	if( !pAnim )
 	{
 		return false;
@@ -129,10 +139,11 @@ bool CAnimationTreePacked::GetAnimationDescriptors( AT_ANIMATION_ID eAnimation,
 
 	EnumAnimDesc eDesc;
 	EnumAnimDescGroup eGroup;
+	const uint32* aAnimDescs = m_aAnimationAnimDescs + pAnim->iAnimationAnimDescs;
 	for( uint32 iGroup=0; iGroup < m_cAnimDescGroups; ++iGroup )
 	{
-		eGroup = m_aAnimDescGroups[iGroup].eAnimDescGroup;
-		eDesc = pAnim->aAnimationAnimDescs[iGroup];
+		eGroup = m_lstAnimDescGroups[iGroup];
+		eDesc = m_lstAnimDescs[aAnimDescs[iGroup]];
 		rDescs.Set( eGroup, eDesc );
 	}
 
@@ -151,13 +162,13 @@ bool CAnimationTreePacked::GetAnimationBlendData( AT_ANIMATION_ID eAnimation, BL
 {
 	// Sanity check.
 
-	AT_ANIMATION* pAnim = GetAnimation( eAnimation );
+	const AT_ANIMATION* pAnim = GetAnimation( eAnimation );
 	if( !pAnim )
 	{
 		return false;
 	}
 
-	outBlendData = pAnim->BlendData;
+	GetBlendData( pAnim->BlendData, outBlendData );
 	return true;
 }
 
@@ -175,7 +186,7 @@ bool CAnimationTreePacked::GetAnimationRate( AT_ANIMATION_ID eAnimation, float&
 {
 	// Sanity check.
 
-	AT_ANIMATION* pAnim = GetAnimation( eAnimation );
+	const AT_ANIMATION* pAnim = GetAnimation( eAnimation );
 	if( !pAnim )
 	{
 		return false;
@@ -197,13 +208,13 @@ const char* CAnimationTreePacked::GetAnimationName( AT_ANIMATION_ID eAnimation )
 {
 	// Sanity check.
 
-	AT_ANIMATION* pAnim = GetAnimation( eAnimation );
+	const AT_ANIMATION* pAnim = GetAnimation( eAnimation );
 	if( !pAnim )
 	{
 		return "";
 	}
 
-	return pAnim->szName;
+	return GetStringFromTableByOffset( pAnim->iName );
 }
 
 // ----------------------------------------------------------------------- //
@@ -214,7 +225,7 @@ const char* CAnimationTreePacked::GetAnimationName( AT_ANIMATION_ID eAnimation )
 //
 // ----------------------------------------------------------------------- //
 
-AT_ANIMATION* CAnimationTreePacked::GetAnimation( AT_ANIMATION_ID eAnimation )
+const AT_ANIMATION* CAnimationTreePacked::GetAnimation( AT_ANIMATION_ID eAnimation ) const
 {
 	if( ( eAnimation != kATAnimID_Invalid ) &&
 		( (uint32)eAnimation < m_cAnimations ) )
@@ -280,7 +291,7 @@ AT_ANIMATION_ID CAnimationTreePacked::FindAnimation( const CAnimationProps& Prop
 {
 	// Search the tree for a matching pattern.
 
-	AT_PATTERN* pPattern = RecurseFindPattern( m_pRoot, Props );
+	const AT_PATTERN* pPattern = RecurseFindPattern( m_pRoot, Props );
 	if( !pPattern )
 	{
 		return kATAnimID_Invalid;
@@ -306,9 +317,10 @@ AT_ANIMATION_ID CAnimationTreePacked::FindAnimation( const CAnimationProps& Prop
 
 	// Only one anim exists with this pattern.
 
+	const AT_ANIMATION* aAnimations = m_aAnimations + pPattern->iAnimations;
 	if( cAnims == 1 )
 	{
-		return pPattern->aAnimations[0].eAnimationID;
+		return aAnimations[0].eAnimationID;
 	}
 
 	//
@@ -329,26 +341,40 @@ AT_ANIMATION_ID CAnimationTreePacked::FindAnimation( const CAnimationProps& Prop
 	{
 		// Pick a number between zero and the total of all of the random weights.
 
-		float fTotal = pPattern->aAnimations[cAnims-1].fRandomWeightUpperLimit;
+		float fTotal = 0.f;
+		for( iAnim=0; iAnim < cAnims; ++iAnim )
+		{
+			fTotal += aAnimations[iAnim].fRandomWeight;
+		}
 		float fRandom = GetRandom( 0.f, fTotal );
 
 		// Search for the anim that includes the random number in it's range.
+		// Each anim's range ends at the running total of the weights.
 
+		float fUpperLimit = 0.f;
 		for( iAnim=0; iAnim < cAnims; ++iAnim )	
 		{
-			if( fRandom <= pPattern->aAnimations[iAnim].fRandomWeightUpperLimit )
+			fUpperLimit += aAnimations[iAnim].fRandomWeight;
+			if( fRandom <= fUpperLimit )
 			{
 				break;
 			}
 		}
 
+		// Guard against rounding leaving the random number past the last range.
+
+		if( iAnim == cAnims )
+		{
+			iAnim = cAnims - 1;
+		}
+
 		if( piRandomSeed )
 		{
 			*piRandomSeed = iAnim;
 		}
 	}
 
-	return pPattern->aAnimations[iAnim].eAnimationID;
+	return aAnimations[iAnim].eAnimationID;
 }
 
 // ----------------------------------------------------------------------- //
@@ -363,7 +389,7 @@ uint32 CAnimationTreePacked::CountAnimations( const CAnimationProps& Props )
 {
 	// Search the tree for a matching pattern.
 
-	AT_PATTERN* pPattern = RecurseFindPattern( m_pRoot, Props );
+	const AT_PATTERN* pPattern = RecurseFindPattern( m_pRoot, Props );
 	if( !pPattern )
 	{
 		return 0;
@@ -391,7 +417,7 @@ uint32 CAnimationTreePacked::CountAnimations( const CAnimationProps& Props )
 //
 // ----------------------------------------------------------------------- //
 
-AT_PATTERN* CAnimationTreePacked::RecurseFindPattern( AT_TREE_NODE* pNode, const CAnimationProps& Props )
+const AT_PATTERN* CAnimationTreePacked::RecurseFindPattern( const AT_TREE_NODE* pNode, const CAnimationProps& Props )
 {
 	// Sanity check.
 
@@ -402,25 +428,25 @@ AT_PATTERN* CAnimationTreePacked::RecurseFindPattern( AT_TREE_NODE* pNode, const
 
 	// This is a leaf node.
 
-	if( !pNode->pNodePositive )
+	if( pNode->iSplittingAnimProp == AT_INVALID_INDEX )
 	{
 		// There should always be a pattern at a leaf!
 
-		LTASSERT( pNode->pPattern, "RecurseFindPattern::RecurseFindAnimation: Leaf node has no pattern!" );
-		return pNode->pPattern;
+		LTASSERT( pNode->iPattern < m_cPatterns, "RecurseFindPattern::RecurseFindAnimation: Leaf node has no pattern!" );
+		return ( pNode->iPattern < m_cPatterns ) ? &( m_aPatterns[pNode->iPattern] ) : NULL;
 	}
 
 	// Positive match.
 
-	EnumAnimProp eProp = Props.Get( pNode->eSplittingAnimPropGroup );
-	if( eProp == pNode->eSplittingAnimProp )
+	EnumAnimProp eProp = Props.Get( m_lstAnimPropGroups[pNode->iSplittingAnimPropGroup] );
+	if( eProp == m_lstAnimProps[pNode->iSplittingAnimProp] )
 	{
-		return RecurseFindPattern( pNode->pNodePositive, Props );
+		return RecurseFindPattern( GetTreeNode( pNode->iNodePositive ), Props );
 	}
 
 	// Negative match (mismatch).
 
-	return RecurseFindPattern( pNode->pNodeNegative, Props );
+	return RecurseFindPattern( GetTreeNode( pNode->iNodeNegative ), Props );
 }
 
 // ----------------------------------------------------------------------- //
@@ -431,11 +457,11 @@ AT_PATTERN* CAnimationTreePacked::RecurseFindPattern( AT_TREE_NODE* pNode, const
 //
 // ----------------------------------------------------------------------- //
 
-bool CAnimationTreePacked::GetPatternProps( AT_PATTERN* pPattern, CAnimationProps* pProps )
+bool CAnimationTreePacked::GetPatternProps( const AT_PATTERN* pPattern, CAnimationProps* pProps )
 {
 	// Sanity check.
 
-	if( !( pPattern && pProps && pPattern->aAnimProps ) )
+	if( !( pPattern && pProps ) )
 	{
 		return false;
 	}
@@ -448,10 +474,11 @@ bool CAnimationTreePacked::GetPatternProps( AT_PATTERN* pPattern, CAnimationProp
 
 	EnumAnimProp eProp;
 	EnumAnimPropGroup eGroup;
+	const uint32* aAnimProps = m_aPatternAnimProps + pPattern->iAnimProps;
 	for( uint32 iGroup=0; iGroup < m_cAnimPropGroups; ++iGroup )
 	{
-		eGroup = m_aAnimPropGroups[iGroup].eAnimPropGroup;
-		eProp = pPattern->aAnimProps[iGroup];
+		eGroup = m_lstAnimPropGroups[iGroup];
+		eProp = m_lstAnimProps[aAnimProps[iGroup]];
 		pProps->Set( eGroup, eProp );
 	}
 
@@ -470,10 +497,10 @@ bool CAnimationTreePacked::PropExistsInGroup( EnumAnimPropGroup eGroup, EnumAnim
 {
 	// Find the specified AnimProp group.
 
-	AT_ANIM_PROP_GROUP* pGroup = NULL;
+	const AT_ANIM_PROP_GROUP* pGroup = NULL;
 	for( uint32 iGroup=0; iGroup < m_cAnimPropGroups; ++iGroup )
 	{
-		if( m_aAnimPropGroups[iGroup].eAnimPropGroup == eGroup )
+		if( m_lstAnimPropGroups[iGroup] == eGroup )
 		{
 			pGroup = &( m_aAnimPropGroups[iGroup] );
 			break;
@@ -491,7 +518,7 @@ bool CAnimationTreePacked::PropExistsInGroup( EnumAnimPropGroup eGroup, EnumAnim
 
 	for( uint32 iProp=0; iProp < pGroup->cAnimProps; ++iProp )
 	{
-		if( eProp == pGroup->aAnimProps[iProp] )
+		if( eProp == m_lstAnimProps[pGroup->iAnimProps + iProp] )
 		{
 			return true;
 		}
@@ -528,11 +555,12 @@ bool CAnimationTreePacked::GetTransitionDescriptors( AT_TRANSITION_ID eTransitio
 
 	EnumAnimDesc eDesc;
 	EnumAnimDescGroup eGroup;
-	AT_TRANSITION* pTrans = &( m_aTransitions[eTransition] );
+	const AT_TRANSITION* pTrans = &( m_aTransitions[eTransition] );
+	const uint32* aAnimDescs = m_aTransitionAnimDescs + pTrans->iTransitionAnimDescs;
 	for( uint32 iGroup=0; iGroup < m_cAnimDescGroups; ++iGroup )
 	{
-		eGroup = m_aAnimDescGroups[iGroup].eAnimDescGroup;
-		eDesc = pTrans->aTransitionAnimDescs[iGroup];
+		eGroup = m_lstAnimDescGroups[iGroup];
+		eDesc = m_lstAnimDescs[aAnimDescs[iGroup]];
 		rDescs.Set( eGroup, eDesc );
 	}
 
@@ -551,13 +579,13 @@ bool CAnimationTreePacked::GetTransitionBlendData( AT_TRANSITION_ID eTransition,
 {
 	// Sanity check.
 
-	AT_TRANSITION* pTrans = GetTransition( eTransition );
+	const AT_TRANSITION* pTrans = GetTransition( eTransition );
 	if ( !pTrans )
 	{
 		return false;
 	}
 
-	outBlendData = pTrans->BlendData;
+	GetBlendData( pTrans->BlendData, outBlendData );
 	return true;
 }
 
@@ -575,7 +603,7 @@ bool CAnimationTreePacked::GetTransitionRate( AT_TRANSITION_ID eTransition, floa
 {
 	// Sanity check.
 
-	AT_TRANSITION* pTrans = GetTransition( eTransition );
+	const AT_TRANSITION* pTrans = GetTransition( eTransition );
 	if ( !pTrans )
 	{
 		return false;
@@ -597,13 +625,13 @@ const char* CAnimationTreePacked::GetTransitionName( AT_TRANSITION_ID eTransitio
 {
 	// Sanity check.
 
-	AT_TRANSITION* pTrans = GetTransition( eTransition );
+	const AT_TRANSITION* pTrans = GetTransition( eTransition );
 	if( !pTrans )
 	{
 		return "";
 	}
 
-	return pTrans->szName;
+	return GetStringFromTableByOffset( pTrans->iName );
 }
 
 // ----------------------------------------------------------------------- //
@@ -614,7 +642,7 @@ const char* CAnimationTreePacked::GetTransitionName( AT_TRANSITION_ID eTransitio
 //
 // ----------------------------------------------------------------------- //
 
-AT_TRANSITION* CAnimationTreePacked::GetTransition( AT_TRANSITION_ID eTransition )
+const AT_TRANSITION* CAnimationTreePacked::GetTransition( AT_TRANSITION_ID eTransition ) const
 {
 	if( ( eTransition != kATTransID_Invalid ) &&
 		( (uint32)eTransition < m_cTransitions ) )
@@ -625,6 +653,25 @@ AT_TRANSITION* CAnimationTreePacked::GetTransition( AT_TRANSITION_ID eTransition
 	return NULL;
 }
 
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAnimationTreePacked::GetGlobalTransitionID
+//
+//	PURPOSE:	Return the global ID of the transition with the specified ID.
+//
+// ----------------------------------------------------------------------- //
+
+AT_GLOBAL_TRANSITION_ID CAnimationTreePacked::GetGlobalTransitionID( AT_TRANSITION_ID eTransition ) const
+{
+	if( ( eTransition != kATTransID_Invalid ) &&
+		( (uint32)eTransition < m_lstGlobalTransitionIDs.size() ) )
+	{
+		return m_lstGlobalTransitionIDs[eTransition];
+	}
+
+	return kATGlobalTransID_Invalid;
+}
+
 
 
 
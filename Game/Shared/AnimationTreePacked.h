@@ -15,6 +15,7 @@
 
 #include "AnimationTreePackedTypes.h"
 #include "AnimationDescriptors.h"
+#include "SharedFileMapping.h"
 
 
 //
@@ -42,6 +43,13 @@ enum BlendFlags
 // Do NOT add any data to these structures.
 // They are read from disk exactly as they are packed
 // by the packer!
+//
+// The packed data is position-independent.  References are stored as
+// string table offsets or as element indices into the tree's lists, and
+// are resolved at access time, so the data is never modified after it
+// is loaded.
+
+#define AT_INVALID_INDEX	((uint32)-1)
 
 struct AT_HEADER
 {
@@ -51,73 +59,82 @@ struct AT_HEADER
 
 struct AT_ANIM_PROP_GROUP
 {
-	EnumAnimPropGroup	eAnimPropGroup;
+	uint32				iName;
 	uint32				cAnimProps;
-	EnumAnimProp*		aAnimProps;
+	uint32				iAnimProps;
 };
 
 struct AT_ANIM_DESC_GROUP
 {
-	EnumAnimDescGroup	eAnimDescGroup;
+	uint32				iName;
 	uint32				cAnimDesc;
-	EnumAnimDesc*		aAnimDescs;
+	uint32				iAnimDescs;
 };
 
 // Blend data is shared by both the transition and the animation.  Moved 
 // common attributes out to this struct.  Like the other structs in this 
 // file, this order must match the animation tree packer defined order.
-struct BLENDDATA
+struct AT_BLENDDATA
 {
 	float				fBlendDuration;
-	const char*			szBlendWeightSet;
+	uint32				iBlendWeightSet;
 	uint32				iBlendFlags;
 };
 
 struct AT_TRANSITION
 {
-	const char*				szName;
+	uint32					iName;
 	AT_TRANSITION_ID		eTransitionID;
-	AT_GLOBAL_TRANSITION_ID	eGlobalTransitionID;
-	EnumAnimDesc*			aTransitionAnimDescs;
-	BLENDDATA				BlendData;
+	AT_GLOBAL_TRANSITION_ID	eGlobalTransitionID;	// Unused, see CAnimationTreePacked::GetGlobalTransitionID.
+	uint32					iTransitionAnimDescs;
+	AT_BLENDDATA			BlendData;
 	float					fRate;
 };
 
 struct AT_TRANSITION_SET
 {
-	AT_TRANSITION**		aTransitions;
+	uint32				iTransitions;
 	uint32				cTransitions;
 };
 
 struct AT_ANIMATION
 {
-	const char*			szName;
+	uint32				iName;
 	AT_ANIMATION_ID		eAnimationID;
-	float				fRandomWeightUpperLimit;
-	EnumAnimProp*		aAnimationAnimProps;
-	EnumAnimDesc*		aAnimationAnimDescs;
-	BLENDDATA			BlendData;
+	float				fRandomWeight;
+	uint32				iAnimationAnimProps;	// Unused, see CAnimationTreePacked::GetAnimationProps.
+	uint32				iAnimationAnimDescs;
+	AT_BLENDDATA		BlendData;
 	float				fRate;
-	AT_TRANSITION*		pDefaultTransitionIn;
-	AT_TRANSITION*		pDefaultTransitionOut;
-	AT_TRANSITION_SET*	pTransitionSetIn;
-	AT_TRANSITION_SET*	pTransitionSetOut;
+	uint32				iDefaultTransitionIn;
+	uint32				iDefaultTransitionOut;
+	uint32				iTransitionSetIn;
+	uint32				iTransitionSetOut;
 };
 
 struct AT_PATTERN
 {
-	EnumAnimProp*		aAnimProps;
-	AT_ANIMATION*		aAnimations;
+	uint32				iAnimProps;
+	uint32				iAnimations;
 	uint32				cAnimations;
 };
 
 struct AT_TREE_NODE
 {
-	EnumAnimProp		eSplittingAnimProp;
-	EnumAnimPropGroup	eSplittingAnimPropGroup;
-	AT_PATTERN*			pPattern;
-	AT_TREE_NODE*		pNodePositive;
-	AT_TREE_NODE*		pNodeNegative;
+	uint32				iSplittingAnimProp;
+	uint32				iSplittingAnimPropGroup;
+	uint32				iPattern;
+	uint32				iNodePositive;
+	uint32				iNodeNegative;
+};
+
+// Blend data with its weight set resolved, as returned to callers.
+
+struct BLENDDATA
+{
+	float				fBlendDuration;
+	const char*			szBlendWeightSet;
+	uint32				iBlendFlags;
 };
 
 
@@ -143,7 +160,7 @@ class CAnimationTreePacked
 		bool				GetAnimationBlendData( AT_ANIMATION_ID eAnimation, BLENDDATA& outBlendData );
 		bool				GetAnimationRate( AT_ANIMATION_ID eAnimation, float& outRate );
 		const char*			GetAnimationName( AT_ANIMATION_ID eAnimation );
-		AT_ANIMATION*		GetAnimation( AT_ANIMATION_ID eAnimation );
+		const AT_ANIMATION*	GetAnimation( AT_ANIMATION_ID eAnimation ) const;
 		bool				VerifyAnimationProps( const CAnimationProps& Props, EnumAnimPropGroup* pInvalidPropGroup, EnumAnimProp* pInvalidProp );
 		AT_ANIMATION_ID		FindAnimation( const CAnimationProps& Props, uint32* piRandomSeed );
 		uint32				CountAnimations( const CAnimationProps& Props );
@@ -153,11 +170,16 @@ class CAnimationTreePacked
 		bool				GetTransitionBlendData( AT_TRANSITION_ID eAnimation, BLENDDATA& outBlendData );
 		bool				GetTransitionRate( AT_TRANSITION_ID eTransition, float& outRate );
 		const char*			GetTransitionName( AT_TRANSITION_ID eTransition );
-		AT_TRANSITION*		GetTransition( AT_TRANSITION_ID eTransition );
+		const AT_TRANSITION*	GetTransition( AT_TRANSITION_ID eTransition ) const;
+		const AT_TRANSITION*	GetTransitionByIndex( uint32 iTransition ) const { return ( iTransition < m_cTransitions ) ? &( m_aTransitions[iTransition] ) : NULL; }
+		AT_GLOBAL_TRANSITION_ID	GetGlobalTransitionID( AT_TRANSITION_ID eTransition ) const;
+
+		const AT_TRANSITION_SET*	GetTransitionSet( uint32 iSet ) const { return ( iSet < m_cTransitionSets ) ? &( m_aTransitionSets[iSet] ) : NULL; }
+		const AT_TRANSITION*		GetTransitionSetTransition( const AT_TRANSITION_SET& Set, uint32 iTransition ) const { return GetTransitionByIndex( m_aTransitionSetTransitions[Set.iTransitions + iTransition] ); }
 
 		// Helper function to make sure string table accessing remains in bounds.
 
-		const char* const	GetStringFromTableByOffset( uint32 iOffset )
+		const char* const	GetStringFromTableByOffset( uint32 iOffset ) const
 		{
 			if ( iOffset >= m_nStringTableSize )
 			{
@@ -169,56 +191,83 @@ class CAnimationTreePacked
 
 	private:
 
-		AT_PATTERN*			RecurseFindPattern( AT_TREE_NODE* pNode, const CAnimationProps& Props );
-		bool				GetPatternProps( AT_PATTERN* pPattern, CAnimationProps* pProps );
+		const AT_TREE_NODE*	GetTreeNode( uint32 iNode ) const { return ( iNode < m_cTreeNodes ) ? &( m_aTreeNodes[iNode] ) : NULL; }
+		const AT_PATTERN*	RecurseFindPattern( const AT_TREE_NODE* pNode, const CAnimationProps& Props );
+		bool				GetPatternProps( const AT_PATTERN* pPattern, CAnimationProps* pProps );
 		bool				PropExistsInGroup( EnumAnimPropGroup eGroup, EnumAnimProp eProp );
+		void				GetBlendData( const AT_BLENDDATA& PackedBlendData, BLENDDATA& outBlendData ) const;
 
 	private:
 
+		typedef std::vector<EnumAnimProp, LTAllocator<EnumAnimProp, LT_MEM_TYPE_GAMECODE> >							ANIM_PROP_LIST;
+		typedef std::vector<EnumAnimPropGroup, LTAllocator<EnumAnimPropGroup, LT_MEM_TYPE_GAMECODE> >				ANIM_PROP_GROUP_LIST;
+		typedef std::vector<EnumAnimDesc, LTAllocator<EnumAnimDesc, LT_MEM_TYPE_GAMECODE> >							ANIM_DESC_LIST;
+		typedef std::vector<EnumAnimDescGroup, LTAllocator<EnumAnimDescGroup, LT_MEM_TYPE_GAMECODE> >				ANIM_DESC_GROUP_LIST;
+		typedef std::vector<uint32, LTAllocator<uint32, LT_MEM_TYPE_GAMECODE> >										INDEX_LIST;
+		typedef std::vector<AT_GLOBAL_TRANSITION_ID, LTAllocator<AT_GLOBAL_TRANSITION_ID, LT_MEM_TYPE_GAMECODE> >	GLOBAL_TRANSITION_ID_LIST;
+
 		friend class CAnimationTreePackedLoader;
 		friend class CAnimationTreePackedMgr;
 
+		// The packed file, either read into a private block or mapped from
+		// a cache file shared with other processes loading the same tree.
+
 		uint8*					m_pDataBlock;
+		uint32					m_nDataBlockSize;
+		CSharedFileMapping		m_SharedDataBlock;
 
 		std::string				m_strFilename;
 		AT_TREE_ID				m_eTreeID;
 
+		// Packed data.  None of this is modified after loading.
+
 		const char*				m_szAnimTreeName;
 		const char*				m_pszStringTable;
 		uint32					m_nStringTableSize;
 
-		uint32					m_cAnimPropGroups;
-		AT_ANIM_PROP_GROUP*		m_aAnimPropGroups;
+		uint32						m_cAnimPropGroups;
+		const AT_ANIM_PROP_GROUP*	m_aAnimPropGroups;
 
-		uint32					m_cAnimDescGroups;
-		AT_ANIM_DESC_GROUP*		m_aAnimDescGroups;
+		uint32						m_cAnimDescGroups;
+		const AT_ANIM_DESC_GROUP*	m_aAnimDescGroups;
 
 		uint32					m_cAnimProps;
-		EnumAnimProp*			m_aAnimProps;
+		const uint32*			m_aAnimProps;
 
 		uint32					m_cAnimDescs;
-		EnumAnimDesc*			m_aAnimDescs;
+		const uint32*			m_aAnimDescs;
 
 		uint32					m_cTransitions;
-		AT_TRANSITION*			m_aTransitions;
-		EnumAnimDesc*			m_aTransitionAnimDescs;
+		const AT_TRANSITION*	m_aTransitions;
+		const uint32*			m_aTransitionAnimDescs;
 
-		uint32					m_cTransitionSets;
-		AT_TRANSITION_SET*		m_aTransitionSets;
-		uint32					m_cTransitionSetTransitions;
-		AT_TRANSITION**			m_aTransitionSetTransitions;
+		uint32						m_cTransitionSets;
+		const AT_TRANSITION_SET*	m_aTransitionSets;
+		uint32						m_cTransitionSetTransitions;
+		const uint32*				m_aTransitionSetTransitions;
 
 		uint32					m_cAnimations;
-		AT_ANIMATION*			m_aAnimations;
-		EnumAnimDesc*			m_aAnimationAnimDescs;
+		const AT_ANIMATION*		m_aAnimations;
+		const uint32*			m_aAnimationAnimDescs;
 
 		uint32					m_cPatterns;
-		AT_PATTERN*				m_aPatterns;
-		EnumAnimProp*			m_aPatternAnimProps;
+		const AT_PATTERN*		m_aPatterns;
+		const uint32*			m_aPatternAnimProps;
 
 		uint32					m_cTreeNodes;
-		AT_TREE_NODE*			m_aTreeNodes;
-		AT_TREE_NODE*			m_pRoot;
+		const AT_TREE_NODE*		m_aTreeNodes;
+		const AT_TREE_NODE*		m_pRoot;
+
+		// Run-time data.  Names in the packed data resolve to enums that
+		// are specific to this process, so they are kept here, along with
+		// the pattern that owns each animation and global transition IDs.
+
+		ANIM_PROP_GROUP_LIST		m_lstAnimPropGroups;
+		ANIM_DESC_GROUP_LIST		m_lstAnimDescGroups;
+		ANIM_PROP_LIST				m_lstAnimProps;
+		ANIM_DESC_LIST				m_lstAnimDescs;
+		INDEX_LIST					m_lstAnimationPatterns;
+		GLOBAL_TRANSITION_ID_LIST	m_lstGlobalTransitionIDs;
 };
 
 #endif
@@ -32,22 +32,6 @@ DATATYPE_TO_ENDIANFORMAT(AT_HEADER, "ii");
 #define ANIM_TREE_FILE_VERSION	3
 
 
-// ----------------------------------------------------------------------- //
-//
-//	ROUTINE:	FixUpBlendData()
-//
-//	PURPOSE:	Helper function to handle fixing up blend data.  This is 
-//				used as blend data is used by transitions and animations 
-//				both.
-//
-// ----------------------------------------------------------------------- //
-
-static void FixUpBlendData( CAnimationTreePacked* pAnimTree, BLENDDATA& rInOutBlendData )
-{
-	uint32 iOffset = (uint32)rInOutBlendData.szBlendWeightSet;
-	rInOutBlendData.szBlendWeightSet = pAnimTree->GetStringFromTableByOffset( iOffset );
-}
-
 // ----------------------------------------------------------------------- //
 //
 //	ROUTINE:	CAnimationTreePackedLoader::Con/destructor
@@ -72,7 +56,7 @@ CAnimationTreePackedLoader::~CAnimationTreePackedLoader()
 //
 // ----------------------------------------------------------------------- //
 
-bool CAnimationTreePackedLoader::LoadAnimationTreePacked( CAnimationTreePacked* pAnimTree, const char* pszFilename )
+bool CAnimationTreePackedLoader::LoadAnimationTreePacked( CAnimationTreePacked* pAnimTree, const char* pszFilename, bool bShareData )
 {
 	// Sanity check.
 
@@ -129,6 +113,7 @@ bool CAnimationTreePackedLoader::LoadAnimationTreePacked( CAnimationTreePacked*
 	// Bail if allocation fails.
 
 	uint32 nDataBlockSize = (uint32)pStream->GetLen() - ( sizeof(AT_HEADER) );
+	pAnimTree->m_nDataBlockSize = nDataBlockSize;
 	LT_MEM_TRACK_ALLOC( pAnimTree->m_pDataBlock = new uint8[nDataBlockSize], LT_MEM_TYPE_GAMECODE );
 	if( !pAnimTree->m_pDataBlock )
 	{
@@ -147,12 +132,41 @@ bool CAnimationTreePackedLoader::LoadAnimationTreePacked( CAnimationTreePacked*
 	}
 
 	// Assign pointers to structures within the data.
+	// The data is accessed in place, and is not modified after this point.
+
+	if( !( SetupAnimTreeData( pAnimTree, pAnimTree->m_pDataBlock, nDataBlockSize ) &&
+		   ValidateAnimTreeData( pAnimTree ) ) )
+	{
+		LTASSERT_PARAM1( 0, "Animation Tree: %s has errors.  Repack the animation database and verify that there are no errors.", pszFilename );
+		LTSafeRelease(pStream);
+		return false;
+	}
 
-	SetupAnimTreeData( pAnimTree, nDataBlockSize );
+	// Switch to a copy shared with every other process that loads the same
+	// tree.  The first process to load it writes the cache file, and later
+	// ones map that file after checking it against their own data.  The
+	// data is swapped in place on Xenon, which runs a single process anyway.
 
-	// Fix up the raw data into a useable form.
+#if !defined(PLATFORM_XENON)
+	if( bShareData && g_pLTBase )
+	{
+		const uint8* pSharedData = pAnimTree->m_SharedDataBlock.MapSharedCopy( "AnimTree", pAnimTree->m_pDataBlock, nDataBlockSize );
+		if( pSharedData )
+		{
+			delete [] pAnimTree->m_pDataBlock;
+			pAnimTree->m_pDataBlock = NULL;
+
+			// The mapped copy matches the validated data, so only the section
+			// pointers need to be set up again.
+
+			SetupAnimTreeData( pAnimTree, const_cast<uint8*>( pSharedData ), nDataBlockSize );
+		}
+	}
+#endif // PLATFORM_XENON
 
-	FixUpAnimTreeData( pAnimTree, pszFilename );
+	// Resolve names into enums.
+
+	SetupRunTimeData( pAnimTree );
 
 	// Loaded successfully.
 
@@ -162,6 +176,40 @@ bool CAnimationTreePackedLoader::LoadAnimationTreePacked( CAnimationTreePacked*
 	return true;
 }
 
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	ReadAnimTreeCount() / ReadAnimTreeSection()
+//
+//	PURPOSE:	Read an element count or a section of elements from the 
+//				packed data.  Return false if the data is too short.
+//
+// ----------------------------------------------------------------------- //
+
+static bool ReadAnimTreeCount( const uint8* pDataBlock, uint32 nDataSize, uint32& iOffset, uint32& nCount )
+{
+	if( ( iOffset > nDataSize ) || ( nDataSize - iOffset < sizeof(uint32) ) )
+	{
+		return false;
+	}
+
+	nCount = *(const uint32*)( pDataBlock + iOffset );
+	iOffset += sizeof(uint32);
+	return true;
+}
+
+template < typename T >
+static bool ReadAnimTreeSection( const uint8* pDataBlock, uint32 nDataSize, uint32& iOffset, uint32 cElements, const T*& pSection )
+{
+	if( ( iOffset > nDataSize ) || ( ( nDataSize - iOffset ) / sizeof(T) < cElements ) )
+	{
+		return false;
+	}
+
+	pSection = (const T*)( pDataBlock + iOffset );
+	iOffset += cElements * sizeof(T);
+	return true;
+}
+
 // ----------------------------------------------------------------------- //
 //
 //	ROUTINE:	CAnimationTreePackedLoader::SetupAnimTreeData
@@ -170,27 +218,32 @@ bool CAnimationTreePackedLoader::LoadAnimationTreePacked( CAnimationTreePacked*
 //
 // ----------------------------------------------------------------------- //
 
-void CAnimationTreePackedLoader::SetupAnimTreeData( CAnimationTreePacked* pAnimTree, uint32 nDataSize )
+bool CAnimationTreePackedLoader::SetupAnimTreeData( CAnimationTreePacked* pAnimTree, uint8* pDataBlock, uint32 nDataSize )
 {
 	// Sanity check.
 
-	if( !pAnimTree )
+	if( !( pAnimTree && pDataBlock ) )
 	{
-		return;
+		return false;
 	}
-	uint8* pDataBlock = pAnimTree->m_pDataBlock;
 
 	// String table.
 
 	uint32 iOffset = 0;
+	if( nDataSize < sizeof(uint32) )
+	{
+		return false;
+	}
 	pAnimTree->m_nStringTableSize = *(uint32*)pDataBlock;
 #if defined(PLATFORM_XENON)
 	// XENON: Swap data at runtime
 	LittleEndianToNative( &pAnimTree->m_nStringTableSize );
 #endif // PLATFORM_XENON
 	iOffset += sizeof(uint32);
-	pAnimTree->m_pszStringTable = (const char*)( pDataBlock + iOffset );
-	iOffset += pAnimTree->m_nStringTableSize;
+	if( !ReadAnimTreeSection( pDataBlock, nDataSize, iOffset, pAnimTree->m_nStringTableSize, pAnimTree->m_pszStringTable ) )
+	{
+		return false;
+	}
 
 #if defined(PLATFORM_XENON)
 	// XENON: Swap data at runtime
@@ -205,367 +258,310 @@ void CAnimationTreePackedLoader::SetupAnimTreeData( CAnimationTreePacked* pAnimT
 
 	pAnimTree->m_szAnimTreeName = pAnimTree->m_pszStringTable;
 
-	// AnimPropGroups.
-
-	pAnimTree->m_cAnimPropGroups = *(uint32*)( pDataBlock + iOffset );
-	iOffset += sizeof(uint32);
-	pAnimTree->m_aAnimPropGroups = (AT_ANIM_PROP_GROUP*)( pDataBlock + iOffset );
-	iOffset += pAnimTree->m_cAnimPropGroups * sizeof(AT_ANIM_PROP_GROUP);
-
-	// AnimDescGroups.
-
-	pAnimTree->m_cAnimDescGroups = *(uint32*)( pDataBlock + iOffset );
-	iOffset += sizeof(uint32);
-	pAnimTree->m_aAnimDescGroups = (AT_ANIM_DESC_GROUP*)( pDataBlock + iOffset );
-	iOffset += pAnimTree->m_cAnimDescGroups * sizeof(AT_ANIM_DESC_GROUP);
-
-	// AnimProps.
-
-	pAnimTree->m_cAnimProps = *(uint32*)( pDataBlock + iOffset );
-	iOffset += sizeof(uint32);
-	pAnimTree->m_aAnimProps = (EnumAnimProp*)( pDataBlock + iOffset );
-	iOffset += pAnimTree->m_cAnimProps * sizeof(EnumAnimProp);
+	// AnimPropGroups, AnimDescGroups, AnimProps and AnimDescs.
 
-	// AnimDescs.
-
-	pAnimTree->m_cAnimDescs = *(uint32*)( pDataBlock + iOffset );
-	iOffset += sizeof(uint32);
-	pAnimTree->m_aAnimDescs = (EnumAnimDesc*)( pDataBlock + iOffset );
-	iOffset += pAnimTree->m_cAnimDescs * sizeof(EnumAnimDesc);
+	if( !( ReadAnimTreeCount( pDataBlock, nDataSize, iOffset, pAnimTree->m_cAnimPropGroups ) &&
+		   ReadAnimTreeSection( pDataBlock, nDataSize, iOffset, pAnimTree->m_cAnimPropGroups, pAnimTree->m_aAnimPropGroups ) &&
+		   ReadAnimTreeCount( pDataBlock, nDataSize, iOffset, pAnimTree->m_cAnimDescGroups ) &&
+		   ReadAnimTreeSection( pDataBlock, nDataSize, iOffset, pAnimTree->m_cAnimDescGroups, pAnimTree->m_aAnimDescGroups ) &&
+		   ReadAnimTreeCount( pDataBlock, nDataSize, iOffset, pAnimTree->m_cAnimProps ) &&
+		   ReadAnimTreeSection( pDataBlock, nDataSize, iOffset, pAnimTree->m_cAnimProps, pAnimTree->m_aAnimProps ) &&
+		   ReadAnimTreeCount( pDataBlock, nDataSize, iOffset, pAnimTree->m_cAnimDescs ) &&
+		   ReadAnimTreeSection( pDataBlock, nDataSize, iOffset, pAnimTree->m_cAnimDescs, pAnimTree->m_aAnimDescs ) ) )
+	{
+		return false;
+	}
 
 	// Transitions.
 
-	pAnimTree->m_cTransitions = *(uint32*)( pDataBlock + iOffset );
-	iOffset += sizeof(uint32);
-	pAnimTree->m_aTransitionAnimDescs = (EnumAnimDesc*)( pDataBlock + iOffset );
-	iOffset += pAnimTree->m_cTransitions * pAnimTree->m_cAnimDescGroups * sizeof(EnumAnimDesc);
-	pAnimTree->m_aTransitions = (AT_TRANSITION*)( pDataBlock + iOffset );
-	iOffset += pAnimTree->m_cTransitions * sizeof(AT_TRANSITION);
+	if( !( ReadAnimTreeCount( pDataBlock, nDataSize, iOffset, pAnimTree->m_cTransitions ) &&
+		   ReadAnimTreeSection( pDataBlock, nDataSize, iOffset, pAnimTree->m_cTransitions * pAnimTree->m_cAnimDescGroups, pAnimTree->m_aTransitionAnimDescs ) &&
+		   ReadAnimTreeSection( pDataBlock, nDataSize, iOffset, pAnimTree->m_cTransitions, pAnimTree->m_aTransitions ) ) )
+	{
+		return false;
+	}
 
 	// Transition sets.
 
-	pAnimTree->m_cTransitionSetTransitions = *(uint32*)( pDataBlock + iOffset );
-	iOffset += sizeof(uint32);
-	pAnimTree->m_aTransitionSetTransitions = (AT_TRANSITION**)( pDataBlock + iOffset );
-	iOffset += pAnimTree->m_cTransitionSetTransitions * sizeof(AT_TRANSITION*);
-	pAnimTree->m_cTransitionSets = *(uint32*)( pDataBlock + iOffset );
-	iOffset += sizeof(uint32);
-	pAnimTree->m_aTransitionSets = (AT_TRANSITION_SET*)( pDataBlock + iOffset );
-	iOffset += pAnimTree->m_cTransitionSets * sizeof(AT_TRANSITION_SET);
+	if( !( ReadAnimTreeCount( pDataBlock, nDataSize, iOffset, pAnimTree->m_cTransitionSetTransitions ) &&
+		   ReadAnimTreeSection( pDataBlock, nDataSize, iOffset, pAnimTree->m_cTransitionSetTransitions, pAnimTree->m_aTransitionSetTransitions ) &&
+		   ReadAnimTreeCount( pDataBlock, nDataSize, iOffset, pAnimTree->m_cTransitionSets ) &&
+		   ReadAnimTreeSection( pDataBlock, nDataSize, iOffset, pAnimTree->m_cTransitionSets, pAnimTree->m_aTransitionSets ) ) )
+	{
+		return false;
+	}
 
 	// Animations.
 
-	pAnimTree->m_cAnimations = *(uint32*)( pDataBlock + iOffset );
-	iOffset += sizeof(uint32);
-	pAnimTree->m_aAnimationAnimDescs = (EnumAnimDesc*)( pDataBlock + iOffset );
-	iOffset += pAnimTree->m_cAnimations * pAnimTree->m_cAnimDescGroups * sizeof(EnumAnimDesc);
-	pAnimTree->m_aAnimations = (AT_ANIMATION*)( pDataBlock + iOffset );
-	iOffset += pAnimTree->m_cAnimations * sizeof(AT_ANIMATION);
+	if( !( ReadAnimTreeCount( pDataBlock, nDataSize, iOffset, pAnimTree->m_cAnimations ) &&
+		   ReadAnimTreeSection( pDataBlock, nDataSize, iOffset, pAnimTree->m_cAnimations * pAnimTree->m_cAnimDescGroups, pAnimTree->m_aAnimationAnimDescs ) &&
+		   ReadAnimTreeSection( pDataBlock, nDataSize, iOffset, pAnimTree->m_cAnimations, pAnimTree->m_aAnimations ) ) )
+	{
+		return false;
+	}
 
 	// Patterns.
 
-	pAnimTree->m_cPatterns = *(uint32*)( pDataBlock + iOffset );
-	iOffset += sizeof(uint32);
-	pAnimTree->m_aPatternAnimProps = (EnumAnimProp*)( pDataBlock + iOffset );
-	iOffset += pAnimTree->m_cPatterns * pAnimTree->m_cAnimPropGroups * sizeof(EnumAnimProp);
-	pAnimTree->m_aPatterns = (AT_PATTERN*)( pDataBlock + iOffset );
-	iOffset += pAnimTree->m_cPatterns * sizeof(AT_PATTERN);
+	if( !( ReadAnimTreeCount( pDataBlock, nDataSize, iOffset, pAnimTree->m_cPatterns ) &&
+		   ReadAnimTreeSection( pDataBlock, nDataSize, iOffset, pAnimTree->m_cPatterns * pAnimTree->m_cAnimPropGroups, pAnimTree->m_aPatternAnimProps ) &&
+		   ReadAnimTreeSection( pDataBlock, nDataSize, iOffset, pAnimTree->m_cPatterns, pAnimTree->m_aPatterns ) ) )
+	{
+		return false;
+	}
 
 	// Tree nodes.
 
-	pAnimTree->m_cTreeNodes = *(uint32*)( pDataBlock + iOffset );
-	iOffset += sizeof(uint32);
-	pAnimTree->m_aTreeNodes = (AT_TREE_NODE*)( pDataBlock + iOffset );
-	iOffset += pAnimTree->m_cTreeNodes * sizeof(AT_TREE_NODE);
-	pAnimTree->m_pRoot = pAnimTree->m_aTreeNodes;
+	if( !( ReadAnimTreeCount( pDataBlock, nDataSize, iOffset, pAnimTree->m_cTreeNodes ) &&
+		   ReadAnimTreeSection( pDataBlock, nDataSize, iOffset, pAnimTree->m_cTreeNodes, pAnimTree->m_aTreeNodes ) ) )
+	{
+		return false;
+	}
+	pAnimTree->m_pRoot = pAnimTree->m_cTreeNodes ? pAnimTree->m_aTreeNodes : NULL;
+
+	return true;
 }
 
 // ----------------------------------------------------------------------- //
 //
-//	ROUTINE:	CAnimationTreePacked::FixUpAnimTreeData
+//	ROUTINE:	IsValidIndexList()
 //
-//	PURPOSE:	Fix up the raw data into a useable form.
+//	PURPOSE:	Return true if every index in the list is below nLimit.
 //
 // ----------------------------------------------------------------------- //
 
-// This is a helper function to help fix up resources in the animation tree.
-// An animation tree without an animations previously was causing a crash 
-// due to lack of bounds checking (there were 0 animations, but one node, 
-// resulting in a pointer into the middle of the animation data.  Ideally,
-// fixup in here would be ranged checked to avoid such issues in the future.
-
-template < typename ResourceType >
-static void LookupResource(ResourceType** ppOutResource, int iResourceOffset,
-						   ResourceType* paResources, int nResourceCount,
-						   const char* const pszFileName )
+static bool IsValidIndexList( const uint32* aIndices, uint32 cIndices, uint32 nLimit )
 {
-	// Verify that our index is in range.  If it isn't, nullify the pointer and
-	// assert.
-
-	if ( iResourceOffset < 0 || iResourceOffset >= nResourceCount )
+	for( uint32 iIndex=0; iIndex < cIndices; ++iIndex )
 	{
-		LTASSERT_PARAM1( 0, "Animation Tree: %s has errors.  Repack the animation database and verify that there are no errors.", pszFileName );
-		*ppOutResource = NULL;
-	}
-	else
-	{
-		*ppOutResource = paResources + iResourceOffset;
+		if( aIndices[iIndex] >= nLimit )
+		{
+			return false;
+		}
 	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	IsValidRange()
+//
+//	PURPOSE:	Return true if the range [iFirst, iFirst + cCount) lies 
+//				within a list of cListSize elements.
+//
+// ----------------------------------------------------------------------- //
+
+static bool IsValidRange( uint32 iFirst, uint32 cCount, uint32 cListSize )
+{
+	return ( iFirst <= cListSize ) && ( cCount <= cListSize - iFirst );
 }
 
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAnimationTreePackedLoader::ValidateAnimTreeData
+//
+//	PURPOSE:	Verify that every index in the packed data refers to an 
+//				element inside the data, so that it may be accessed in 
+//				place.  Tree node links are checked when the tree is 
+//				searched.
+//
+// ----------------------------------------------------------------------- //
 
-void CAnimationTreePackedLoader::FixUpAnimTreeData( CAnimationTreePacked* pAnimTree, const char* pszFilename )
+bool CAnimationTreePackedLoader::ValidateAnimTreeData( CAnimationTreePacked* pAnimTree )
 {
 	// Sanity check.
 
 	if( !pAnimTree )
 	{
-		return;
+		return false;
 	}
 
-	// AnimProps.
-	// Convert strings to enums.
-
-	uint32 iEnum;
-	const char* pszName;
-	for( iEnum=0; iEnum < pAnimTree->m_cAnimProps; ++iEnum )
-	{
-		pszName = pAnimTree->m_pszStringTable + pAnimTree->m_aAnimProps[iEnum];
-		pAnimTree->m_aAnimProps[iEnum] = AnimPropUtils::Enum( pszName );
-	}
+	uint32 cStrings = pAnimTree->m_nStringTableSize;
+	uint32 cPropGroups = pAnimTree->m_cAnimPropGroups;
+	uint32 cDescGroups = pAnimTree->m_cAnimDescGroups;
 
-	// AnimDescs.
-	// Convert strings to enums.
+	// AnimProps and AnimDescs are string table offsets.
 
-	for( iEnum=0; iEnum < pAnimTree->m_cAnimDescs; ++iEnum )
+	if( !( IsValidIndexList( pAnimTree->m_aAnimProps, pAnimTree->m_cAnimProps, cStrings ) &&
+		   IsValidIndexList( pAnimTree->m_aAnimDescs, pAnimTree->m_cAnimDescs, cStrings ) ) )
 	{
-		pszName = pAnimTree->m_pszStringTable + pAnimTree->m_aAnimDescs[iEnum];
-		pAnimTree->m_aAnimDescs[iEnum] = GetAnimationDescriptorFromName( pszName );
+		return false;
 	}
 
-	// AnimPropGroups.
-	// Convert strings to enums and set pointers into enum array.
+	// AnimPropGroups and AnimDescGroups.
 
 	uint32 iGroup;
-	uint32 iEnumOffset;
-	for( iGroup=0; iGroup < pAnimTree->m_cAnimPropGroups; ++iGroup )
+	for( iGroup=0; iGroup < cPropGroups; ++iGroup )
 	{
-		pszName = pAnimTree->m_pszStringTable + pAnimTree->m_aAnimPropGroups[iGroup].eAnimPropGroup;
-		pAnimTree->m_aAnimPropGroups[iGroup].eAnimPropGroup = GetAnimationPropGroupFromName( pszName );
-
-		iEnumOffset = (uint32)( pAnimTree->m_aAnimPropGroups[iGroup].aAnimProps );
-		pAnimTree->m_aAnimPropGroups[iGroup].aAnimProps = pAnimTree->m_aAnimProps + iEnumOffset;
+		const AT_ANIM_PROP_GROUP& Group = pAnimTree->m_aAnimPropGroups[iGroup];
+		if( ( Group.iName >= cStrings ) ||
+			!IsValidRange( Group.iAnimProps, Group.cAnimProps, pAnimTree->m_cAnimProps ) )
+		{
+			return false;
+		}
 	}
 
-	// AnimDescGroups.
-	// Convert strings to enums and set pointers into enum array.
-
-	for( iGroup=0; iGroup < pAnimTree->m_cAnimDescGroups; ++iGroup )
+	for( iGroup=0; iGroup < cDescGroups; ++iGroup )
 	{
-		pszName = pAnimTree->m_pszStringTable + pAnimTree->m_aAnimDescGroups[iGroup].eAnimDescGroup;
-		pAnimTree->m_aAnimDescGroups[iGroup].eAnimDescGroup = GetAnimationDescriptorGroupFromName( pszName );
-
-		iEnumOffset = (uint32)( pAnimTree->m_aAnimDescGroups[iGroup].aAnimDescs );
-		pAnimTree->m_aAnimDescGroups[iGroup].aAnimDescs = pAnimTree->m_aAnimDescs + iEnumOffset;
+		const AT_ANIM_DESC_GROUP& Group = pAnimTree->m_aAnimDescGroups[iGroup];
+		if( ( Group.iName >= cStrings ) ||
+			!IsValidRange( Group.iAnimDescs, Group.cAnimDesc, pAnimTree->m_cAnimDescs ) )
+		{
+			return false;
+		}
 	}
 
-	// Transition AnimDescs.
-	// Convert AnimDesc indices into enums.
+	// Transitions.
 
-	uint32 cEnums = pAnimTree->m_cTransitions * pAnimTree->m_cAnimDescGroups;
-	for( iEnum=0; iEnum < cEnums; ++iEnum )
+	uint32 cTransitionAnimDescs = pAnimTree->m_cTransitions * cDescGroups;
+	if( !IsValidIndexList( pAnimTree->m_aTransitionAnimDescs, cTransitionAnimDescs, pAnimTree->m_cAnimDescs ) )
 	{
-		iEnumOffset = pAnimTree->m_aTransitionAnimDescs[iEnum];
-		pAnimTree->m_aTransitionAnimDescs[iEnum] = pAnimTree->m_aAnimDescs[iEnumOffset];
+		return false;
 	}
 
-	// Transitions.
-	// Convert name string table indices to pointers.
-	// Convert enum list indices into pointers.
-	// Convert blend data
-
 	uint32 iTrans;
 	for( iTrans=0; iTrans < pAnimTree->m_cTransitions; ++iTrans )
 	{
-		pszName = pAnimTree->m_pszStringTable + (uint32)pAnimTree->m_aTransitions[iTrans].szName;
-		pAnimTree->m_aTransitions[iTrans].szName = pszName;
-
-		iEnumOffset = (uint32)pAnimTree->m_aTransitions[iTrans].aTransitionAnimDescs;
-		pAnimTree->m_aTransitions[iTrans].aTransitionAnimDescs = pAnimTree->m_aTransitionAnimDescs + iEnumOffset;
-
-		FixUpBlendData( pAnimTree, pAnimTree->m_aTransitions[iTrans].BlendData );
+		const AT_TRANSITION& Trans = pAnimTree->m_aTransitions[iTrans];
+		if( !IsValidRange( Trans.iTransitionAnimDescs, cDescGroups, cTransitionAnimDescs ) )
+		{
+			return false;
+		}
 	}
 
-	// Transition set transitions.
-	// Convert transition IDs into pointers.
+	// Transition sets.
 
-	for( iTrans=0; iTrans < pAnimTree->m_cTransitionSetTransitions; ++iTrans )
+	if( !IsValidIndexList( pAnimTree->m_aTransitionSetTransitions, pAnimTree->m_cTransitionSetTransitions, pAnimTree->m_cTransitions ) )
 	{
-		iEnumOffset = (uint32)pAnimTree->m_aTransitionSetTransitions[iTrans];
-		pAnimTree->m_aTransitionSetTransitions[iTrans] = pAnimTree->m_aTransitions + iEnumOffset;
+		return false;
 	}
 
-	// Transition sets.
-	// Convert transition ID list indices into pointers.
-
-	uint32 iSetOffset;
 	for( uint32 iSet=0; iSet < pAnimTree->m_cTransitionSets; ++iSet )
 	{
-		iSetOffset = (uint32)pAnimTree->m_aTransitionSets[iSet].aTransitions;
-		pAnimTree->m_aTransitionSets[iSet].aTransitions = pAnimTree->m_aTransitionSetTransitions + iSetOffset;
+		const AT_TRANSITION_SET& Set = pAnimTree->m_aTransitionSets[iSet];
+		if( !IsValidRange( Set.iTransitions, Set.cTransitions, pAnimTree->m_cTransitionSetTransitions ) )
+		{
+			return false;
+		}
 	}
 
-	// Animation AnimDescs.
-	// Convert AnimDesc indices into enums.
+	// Animations.  Default transitions and transition sets are optional.
 
-	cEnums = pAnimTree->m_cAnimations * pAnimTree->m_cAnimDescGroups;
-	for( iEnum=0; iEnum < cEnums; ++iEnum )
+	uint32 cAnimationAnimDescs = pAnimTree->m_cAnimations * cDescGroups;
+	if( !IsValidIndexList( pAnimTree->m_aAnimationAnimDescs, cAnimationAnimDescs, pAnimTree->m_cAnimDescs ) )
 	{
-		iEnumOffset = pAnimTree->m_aAnimationAnimDescs[iEnum];
-		pAnimTree->m_aAnimationAnimDescs[iEnum] = pAnimTree->m_aAnimDescs[iEnumOffset];
+		return false;
 	}
 
-	// Animations.
-	// Convert name string table indices to pointers.
-	// Convert enum list indices into pointers.
-	// Convert default transition IDs into pointers.
-	// Convert transition set IDs into pointers.
-	// Convert blend data
-
-	uint32 iAnim;
-	uint32 iTransOffset;
-	for( iAnim=0; iAnim < pAnimTree->m_cAnimations; ++iAnim )
+	for( uint32 iAnim=0; iAnim < pAnimTree->m_cAnimations; ++iAnim )
 	{
-		pszName = pAnimTree->m_pszStringTable + (uint32)pAnimTree->m_aAnimations[iAnim].szName;
-		pAnimTree->m_aAnimations[iAnim].szName = pszName;
-
-		iEnumOffset = (uint32)pAnimTree->m_aAnimations[iAnim].aAnimationAnimDescs;
-		pAnimTree->m_aAnimations[iAnim].aAnimationAnimDescs = pAnimTree->m_aAnimationAnimDescs + iEnumOffset;
-
-		iTransOffset = (uint32)pAnimTree->m_aAnimations[iAnim].pDefaultTransitionIn;
-		pAnimTree->m_aAnimations[iAnim].pDefaultTransitionIn = NULL;
-		if( iTransOffset != -1 )
+		const AT_ANIMATION& Anim = pAnimTree->m_aAnimations[iAnim];
+		if( !IsValidRange( Anim.iAnimationAnimDescs, cDescGroups, cAnimationAnimDescs ) ||
+			( ( Anim.iDefaultTransitionIn != AT_INVALID_INDEX ) && ( Anim.iDefaultTransitionIn >= pAnimTree->m_cTransitions ) ) ||
+			( ( Anim.iDefaultTransitionOut != AT_INVALID_INDEX ) && ( Anim.iDefaultTransitionOut >= pAnimTree->m_cTransitions ) ) ||
+			( ( Anim.iTransitionSetIn != AT_INVALID_INDEX ) && ( Anim.iTransitionSetIn >= pAnimTree->m_cTransitionSets ) ) ||
+			( ( Anim.iTransitionSetOut != AT_INVALID_INDEX ) && ( Anim.iTransitionSetOut >= pAnimTree->m_cTransitionSets ) ) )
 		{
-			pAnimTree->m_aAnimations[iAnim].pDefaultTransitionIn = pAnimTree->m_aTransitions + iTransOffset;
+			return false;
 		}
+	}
 
-		iTransOffset = (uint32)pAnimTree->m_aAnimations[iAnim].pDefaultTransitionOut;
-		pAnimTree->m_aAnimations[iAnim].pDefaultTransitionOut = NULL;
-		if( iTransOffset != -1 )
-		{
-			pAnimTree->m_aAnimations[iAnim].pDefaultTransitionOut = pAnimTree->m_aTransitions + iTransOffset;
-		}
+	// Patterns.
 
-		iSetOffset = (uint32)pAnimTree->m_aAnimations[iAnim].pTransitionSetIn;
-		pAnimTree->m_aAnimations[iAnim].pTransitionSetIn = NULL;
-		if( iSetOffset != -1 )
-		{
-			pAnimTree->m_aAnimations[iAnim].pTransitionSetIn = pAnimTree->m_aTransitionSets + iSetOffset;
-		}
+	uint32 cPatternAnimProps = pAnimTree->m_cPatterns * cPropGroups;
+	if( !IsValidIndexList( pAnimTree->m_aPatternAnimProps, cPatternAnimProps, pAnimTree->m_cAnimProps ) )
+	{
+		return false;
+	}
 
-		iSetOffset = (uint32)pAnimTree->m_aAnimations[iAnim].pTransitionSetOut;
-		pAnimTree->m_aAnimations[iAnim].pTransitionSetOut = NULL;
-		if( iSetOffset != -1 )
+	for( uint32 iPattern=0; iPattern < pAnimTree->m_cPatterns; ++iPattern )
+	{
+		const AT_PATTERN& Pattern = pAnimTree->m_aPatterns[iPattern];
+		if( !IsValidRange( Pattern.iAnimProps, cPropGroups, cPatternAnimProps ) ||
+			!IsValidRange( Pattern.iAnimations, Pattern.cAnimations, pAnimTree->m_cAnimations ) )
 		{
-			pAnimTree->m_aAnimations[iAnim].pTransitionSetOut = pAnimTree->m_aTransitionSets + iSetOffset;
+			return false;
 		}
-
-		FixUpBlendData( pAnimTree, pAnimTree->m_aAnimations[iAnim].BlendData );
 	}
 
-	// Pattern AnimProps.
-	// Convert AnimProp list indices into enums.
+	// Branch nodes.
 
-	cEnums = pAnimTree->m_cPatterns * pAnimTree->m_cAnimPropGroups;
-	for( iEnum=0; iEnum < cEnums; ++iEnum )
+	for( uint32 iNode=0; iNode < pAnimTree->m_cTreeNodes; ++iNode )
 	{
-		iEnumOffset = pAnimTree->m_aPatternAnimProps[iEnum];
-		pAnimTree->m_aPatternAnimProps[iEnum] = pAnimTree->m_aAnimProps[iEnumOffset];
+		const AT_TREE_NODE& Node = pAnimTree->m_aTreeNodes[iNode];
+		if( ( Node.iSplittingAnimProp != AT_INVALID_INDEX ) &&
+			( ( Node.iSplittingAnimProp >= pAnimTree->m_cAnimProps ) ||
+			  ( Node.iSplittingAnimPropGroup >= cPropGroups ) ) )
+		{
+			return false;
+		}
 	}
 
-	// Patterns.
-	// Convert enum list indices into pointers.
-	// Convert anim list indices into pointers.
+	return true;
+}
 
-	float fTotalWeight;
-	uint32 iAnimOffset;
-	AT_ANIMATION* pAnim;
-	for( uint32 iPattern=0; iPattern < pAnimTree->m_cPatterns; ++iPattern )
-	{
-		iEnumOffset = (uint32)pAnimTree->m_aPatterns[iPattern].aAnimProps;
-		pAnimTree->m_aPatterns[iPattern].aAnimProps = pAnimTree->m_aPatternAnimProps + iEnumOffset;
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAnimationTreePackedLoader::SetupRunTimeData
+//
+//	PURPOSE:	Resolve names in the packed data into this process's 
+//				enums.  The packed data itself is left untouched.
+//
+// ----------------------------------------------------------------------- //
 
-		iAnimOffset = (uint32)pAnimTree->m_aPatterns[iPattern].aAnimations;
-		pAnimTree->m_aPatterns[iPattern].aAnimations = pAnimTree->m_aAnimations + iAnimOffset;
+void CAnimationTreePackedLoader::SetupRunTimeData( CAnimationTreePacked* pAnimTree )
+{
+	// Sanity check.
 
-		// Fixup pointers inside of anim structs to pattern's anim prop list.
-		// Convert the random weights into random upper limits.
+	if( !pAnimTree )
+	{
+		return;
+	}
 
-		fTotalWeight = 0.f;
-		for( iAnim=0; iAnim < pAnimTree->m_aPatterns[iPattern].cAnimations; ++iAnim )
-		{
-			pAnim = &( pAnimTree->m_aPatterns[iPattern].aAnimations[iAnim] );
-			pAnim->aAnimationAnimProps = pAnimTree->m_aPatterns[iPattern].aAnimProps;
+	// AnimProps.
 
-			fTotalWeight += pAnim->fRandomWeightUpperLimit;
-			pAnim->fRandomWeightUpperLimit = fTotalWeight;
-		}
+	uint32 iEnum;
+	pAnimTree->m_lstAnimProps.resize( pAnimTree->m_cAnimProps );
+	for( iEnum=0; iEnum < pAnimTree->m_cAnimProps; ++iEnum )
+	{
+		pAnimTree->m_lstAnimProps[iEnum] = AnimPropUtils::Enum( pAnimTree->m_pszStringTable + pAnimTree->m_aAnimProps[iEnum] );
 	}
 
-	// Tree nodes.
-	// Convert AnimProp list indices into enums.
-	// Convert AnimPropGroup list indices into enums.
-	// Convert pattern list indices into pointers.
-	// Convert node list indices into pointers.
+	// AnimDescs.
 
-	uint32 iPatternOffset;
-	uint32 iNodeOffset;
-	for( uint32 iNode=0; iNode < pAnimTree->m_cTreeNodes; ++iNode )
+	pAnimTree->m_lstAnimDescs.resize( pAnimTree->m_cAnimDescs );
+	for( iEnum=0; iEnum < pAnimTree->m_cAnimDescs; ++iEnum )
 	{
-		// Branch node.
-
-		iEnumOffset = pAnimTree->m_aTreeNodes[iNode].eSplittingAnimProp;
-		if( iEnumOffset != -1 )
-		{
-			pAnimTree->m_aTreeNodes[iNode].eSplittingAnimProp = pAnimTree->m_aAnimProps[iEnumOffset];
+		pAnimTree->m_lstAnimDescs[iEnum] = GetAnimationDescriptorFromName( pAnimTree->m_pszStringTable + pAnimTree->m_aAnimDescs[iEnum] );
+	}
 
-			iEnumOffset = pAnimTree->m_aTreeNodes[iNode].eSplittingAnimPropGroup;
-			pAnimTree->m_aTreeNodes[iNode].eSplittingAnimPropGroup = pAnimTree->m_aAnimPropGroups[iEnumOffset].eAnimPropGroup;
+	// AnimPropGroups.
 
-			pAnimTree->m_aTreeNodes[iNode].pPattern = NULL;
+	uint32 iGroup;
+	pAnimTree->m_lstAnimPropGroups.resize( pAnimTree->m_cAnimPropGroups );
+	for( iGroup=0; iGroup < pAnimTree->m_cAnimPropGroups; ++iGroup )
+	{
+		pAnimTree->m_lstAnimPropGroups[iGroup] = GetAnimationPropGroupFromName( pAnimTree->m_pszStringTable + pAnimTree->m_aAnimPropGroups[iGroup].iName );
+	}
 
-			iNodeOffset = (uint32)pAnimTree->m_aTreeNodes[iNode].pNodePositive;
-			LookupResource(
-				&pAnimTree->m_aTreeNodes[iNode].pNodePositive, iNodeOffset,
-				pAnimTree->m_aTreeNodes, pAnimTree->m_cTreeNodes, 
-				pszFilename );
+	// AnimDescGroups.
 
-			iNodeOffset = (uint32)pAnimTree->m_aTreeNodes[iNode].pNodeNegative;
-			LookupResource( 
-				&pAnimTree->m_aTreeNodes[iNode].pNodeNegative, iNodeOffset,
-				pAnimTree->m_aTreeNodes, pAnimTree->m_cTreeNodes, 
-				pszFilename );
-		}
+	pAnimTree->m_lstAnimDescGroups.resize( pAnimTree->m_cAnimDescGroups );
+	for( iGroup=0; iGroup < pAnimTree->m_cAnimDescGroups; ++iGroup )
+	{
+		pAnimTree->m_lstAnimDescGroups[iGroup] = GetAnimationDescriptorGroupFromName( pAnimTree->m_pszStringTable + pAnimTree->m_aAnimDescGroups[iGroup].iName );
+	}
 
-		// Leaf node.
+	// Record the pattern that lists each animation, as an animation's
+	// props are the props of its pattern.
 
-		else 
+	pAnimTree->m_lstAnimationPatterns.resize( pAnimTree->m_cAnimations, AT_INVALID_INDEX );
+	for( uint32 iPattern=0; iPattern < pAnimTree->m_cPatterns; ++iPattern )
+	{
+		const AT_PATTERN& Pattern = pAnimTree->m_aPatterns[iPattern];
+		for( uint32 iAnim=0; iAnim < Pattern.cAnimations; ++iAnim )
 		{
-			pAnimTree->m_aTreeNodes[iNode].eSplittingAnimProp = kAP_Invalid;
-			pAnimTree->m_aTreeNodes[iNode].eSplittingAnimPropGroup = kAPG_Invalid;
-
-			iPatternOffset = (uint32)pAnimTree->m_aTreeNodes[iNode].pPattern;
-			LookupResource( 
-				&pAnimTree->m_aTreeNodes[iNode].pPattern, iPatternOffset, 
-				pAnimTree->m_aPatterns, pAnimTree->m_cPatterns, 
-				pszFilename );
-
-			pAnimTree->m_aTreeNodes[iNode].pNodePositive = NULL;
-			pAnimTree->m_aTreeNodes[iNode].pNodeNegative = NULL;
+			pAnimTree->m_lstAnimationPatterns[Pattern.iAnimations + iAnim] = iPattern;
 		}
 	}
 }
-
-
-
-
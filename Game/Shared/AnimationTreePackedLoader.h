@@ -32,12 +32,16 @@ class CAnimationTreePackedLoader
 		 CAnimationTreePackedLoader();
 		~CAnimationTreePackedLoader();
 
-		bool	LoadAnimationTreePacked( CAnimationTreePacked* pAnimTree, const char* pszFilename );
+		// The tree's data is mapped from a cache file shared with other
+		// processes, unless bShareData is false or the mapping fails.
+
+		bool	LoadAnimationTreePacked( CAnimationTreePacked* pAnimTree, const char* pszFilename, bool bShareData = true );
 
 	private:
 
-		void	SetupAnimTreeData( CAnimationTreePacked* pAnimTree, uint32 nDataSize );
-		void	FixUpAnimTreeData( CAnimationTreePacked* pAnimTree, const char* pszFilename );
+		bool	SetupAnimTreeData( CAnimationTreePacked* pAnimTree, uint8* pDataBlock, uint32 nDataSize );
+		bool	ValidateAnimTreeData( CAnimationTreePacked* pAnimTree );
+		void	SetupRunTimeData( CAnimationTreePacked* pAnimTree );
 };
 
 #endif
@@ -15,7 +15,12 @@
 #include "AnimationTreePackedLoader.h"
 #include "AnimationTreePacked.h"
 #include "AnimationContext.h"
+#include "lttimeutils.h"
 
+#ifndef _FINAL
+static void AnimTreeCompareCB( int argc, char** argv );
+static void AnimTreeLoadBenchmarkCB( int argc, char** argv );
+#endif // _FINAL
 
 //
 // Globals...
@@ -59,6 +64,15 @@ bool CAnimationTreePackedMgr::InitAnimationTreePackedMgr()
 	// Set the global pointer...
 
 	g_pAnimationTreePackedMgr = this;
+
+#ifndef _FINAL
+	if( g_pLTBase )
+	{
+		g_pLTBase->RegisterConsoleProgram( "AnimTreeCompare", AnimTreeCompareCB );
+		g_pLTBase->RegisterConsoleProgram( "AnimTreeLoadBenchmark", AnimTreeLoadBenchmarkCB );
+	}
+#endif // _FINAL
+
 	return true;
 }
 
@@ -83,6 +97,14 @@ void CAnimationTreePackedMgr::TermAnimationTreePackedMgr()
 	}
 	m_lstAnimTrees.resize( 0 );
 
+#ifndef _FINAL
+	if( g_pLTBase && ( g_pAnimationTreePackedMgr == this ) )
+	{
+		g_pLTBase->UnregisterConsoleProgram( "AnimTreeCompare" );
+		g_pLTBase->UnregisterConsoleProgram( "AnimTreeLoadBenchmark" );
+	}
+#endif // _FINAL
+
 	// Clear the global pointer...
 
 	g_pAnimationTreePackedMgr = NULL;
@@ -205,14 +227,12 @@ void CAnimationTreePackedMgr::AssignGlobalTransitionIDs( CAnimationTreePacked* p
 	// Assign global IDs.
 	// Global transition IDs allow searching for transitions across multiple trees.
 
-	AT_TRANSITION* pTrans;
+	// The IDs are kept by the tree rather than written into its packed data.
+
+	pTree->m_lstGlobalTransitionIDs.resize( pTree->GetNumTransitions(), kATGlobalTransID_Invalid );
 	for( uint32 iTrans=0; iTrans < pTree->GetNumTransitions(); ++iTrans )
 	{
-		pTrans = pTree->GetTransition( (AT_TRANSITION_ID)iTrans );
-		if( pTrans )
-		{
-			pTrans->eGlobalTransitionID = GetGlobalTransitionID( pTrans->szName );
-		}
+		pTree->m_lstGlobalTransitionIDs[iTrans] = GetGlobalTransitionID( pTree->GetTransitionName( (AT_TRANSITION_ID)iTrans ) );
 	}
 }
 
@@ -293,8 +313,8 @@ bool CAnimationTreePackedMgr::FindTransition( const ANIM_TREE_INDEX &IndexAnimat
 
 	AT_ANIMATION_ID eAnimFrom = (AT_ANIMATION_ID)IndexAnimationFrom.iAnimation;
 	AT_ANIMATION_ID eAnimTo = (AT_ANIMATION_ID)IndexAnimationTo.iAnimation;
-	AT_ANIMATION* pAnimFrom = pTreeFrom->GetAnimation( eAnimFrom );
-	AT_ANIMATION* pAnimTo = pTreeTo->GetAnimation( eAnimTo );
+	const AT_ANIMATION* pAnimFrom = pTreeFrom->GetAnimation( eAnimFrom );
+	const AT_ANIMATION* pAnimTo = pTreeTo->GetAnimation( eAnimTo );
 	if( !( pAnimFrom && pAnimTo ) )
 	{
 		return false;
@@ -302,26 +322,26 @@ bool CAnimationTreePackedMgr::FindTransition( const ANIM_TREE_INDEX &IndexAnimat
 
 	// Search for a transition listed as an Out of the From and an In of the To.
 
-	AT_TRANSITION* pTransIn;
-	AT_TRANSITION* pTransOut;
-	AT_TRANSITION_SET* pSetOut = pAnimFrom->pTransitionSetOut;
-	AT_TRANSITION_SET* pSetIn = pAnimTo->pTransitionSetIn;
+	const AT_TRANSITION* pTransIn;
+	const AT_TRANSITION* pTransOut;
+	const AT_TRANSITION_SET* pSetOut = pTreeFrom->GetTransitionSet( pAnimFrom->iTransitionSetOut );
+	const AT_TRANSITION_SET* pSetIn = pTreeTo->GetTransitionSet( pAnimTo->iTransitionSetIn );
 	if( pSetOut && pSetIn )
 	{
 		uint32 iIn;
 		for( uint32 iOut=0; iOut < pSetOut->cTransitions; ++iOut )
 		{
-			pTransOut = pSetOut->aTransitions[iOut];
+			pTransOut = pTreeFrom->GetTransitionSetTransition( *pSetOut, iOut );
 			for( iIn=0; iIn < pSetIn->cTransitions; ++iIn )
 			{
-				pTransIn = pSetIn->aTransitions[iIn];
+				pTransIn = pTreeTo->GetTransitionSetTransition( *pSetIn, iIn );
 				if( pTransOut && pTransIn && 
-					pTransOut->eGlobalTransitionID == pTransIn->eGlobalTransitionID )
+					pTreeFrom->GetGlobalTransitionID( pTransOut->eTransitionID ) == pTreeTo->GetGlobalTransitionID( pTransIn->eTransitionID ) )
 				{
 					rTransResults.Index.iAnimTree = IndexAnimationFrom.iAnimTree;
 					rTransResults.Index.iAnimation = pTransOut->eTransitionID;
-					rTransResults.pszName = pTransOut->szName;
-					rTransResults.BlendData = pTransOut->BlendData;
+					rTransResults.pszName = pTreeFrom->GetTransitionName( pTransOut->eTransitionID );
+					pTreeFrom->GetTransitionBlendData( pTransOut->eTransitionID, rTransResults.BlendData );
 					pTreeFrom->GetTransitionDescriptors( pTransOut->eTransitionID, rTransResults.Descriptors );
 
 					return true;
@@ -333,24 +353,24 @@ bool CAnimationTreePackedMgr::FindTransition( const ANIM_TREE_INDEX &IndexAnimat
 	// No match found between the Out and In animations, so look
 	// for default transitions.
 
-	if( pAnimFrom->pDefaultTransitionOut )
+	pTransOut = pTreeFrom->GetTransitionByIndex( pAnimFrom->iDefaultTransitionOut );
+	if( pTransOut )
 	{
-		pTransOut = pAnimFrom->pDefaultTransitionOut;
 		rTransResults.Index.iAnimTree = IndexAnimationFrom.iAnimTree;
 		rTransResults.Index.iAnimation = pTransOut->eTransitionID;
-		rTransResults.pszName = pTransOut->szName;
-		rTransResults.BlendData = pTransOut->BlendData;
+		rTransResults.pszName = pTreeFrom->GetTransitionName( pTransOut->eTransitionID );
+		pTreeFrom->GetTransitionBlendData( pTransOut->eTransitionID, rTransResults.BlendData );
 		pTreeFrom->GetTransitionDescriptors( pTransOut->eTransitionID, rTransResults.Descriptors );
 		return true;
 	}
 
-	if( pAnimTo->pDefaultTransitionIn )
+	pTransIn = pTreeTo->GetTransitionByIndex( pAnimTo->iDefaultTransitionIn );
+	if( pTransIn )
 	{
-		pTransIn = pAnimTo->pDefaultTransitionIn;
 		rTransResults.Index.iAnimTree = IndexAnimationTo.iAnimTree;
 		rTransResults.Index.iAnimation = pTransIn->eTransitionID;
-		rTransResults.pszName = pTransIn->szName;
-		rTransResults.BlendData = pTransIn->BlendData;
+		rTransResults.pszName = pTreeTo->GetTransitionName( pTransIn->eTransitionID );
+		pTreeTo->GetTransitionBlendData( pTransIn->eTransitionID, rTransResults.BlendData );
 		pTreeTo->GetTransitionDescriptors( pTransIn->eTransitionID, rTransResults.Descriptors );
 		return true;
 	}
@@ -360,3 +380,228 @@ bool CAnimationTreePackedMgr::FindTransition( const ANIM_TREE_INDEX &IndexAnimat
 	return false;
 }
 
+
+#ifndef _FINAL
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	SameBlendData()
+//
+//	PURPOSE:	Return true if two resolved blend data are equal.
+//
+// ----------------------------------------------------------------------- //
+
+static bool SameBlendData( const BLENDDATA& BlendA, const BLENDDATA& BlendB )
+{
+	return ( BlendA.fBlendDuration == BlendB.fBlendDuration ) &&
+		   ( BlendA.iBlendFlags == BlendB.iBlendFlags ) &&
+		   LTStrEquals( BlendA.szBlendWeightSet, BlendB.szBlendWeightSet );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAnimationTreePackedMgr::CompareAnimationTrees
+//
+//	PURPOSE:	Run every query on two loads of the same tree, and return 
+//				the number of results that differ.
+//
+// ----------------------------------------------------------------------- //
+
+uint32 CAnimationTreePackedMgr::CompareAnimationTrees( CAnimationTreePacked* pTreeA, CAnimationTreePacked* pTreeB )
+{
+	if( ( pTreeA->GetNumAnimations() != pTreeB->GetNumAnimations() ) ||
+		( pTreeA->GetNumTransitions() != pTreeB->GetNumTransitions() ) )
+	{
+		return 1;
+	}
+
+	uint32 nMismatches = 0;
+
+	CAnimationProps PropsA, PropsB;
+	CAnimationDescriptors DescsA, DescsB;
+	BLENDDATA BlendA, BlendB;
+	float fRateA, fRateB;
+
+	for( uint32 iAnim=0; iAnim < pTreeA->GetNumAnimations(); ++iAnim )
+	{
+		AT_ANIMATION_ID eAnim = (AT_ANIMATION_ID)iAnim;
+		const AT_ANIMATION* pAnimA = pTreeA->GetAnimation( eAnim );
+		const AT_ANIMATION* pAnimB = pTreeB->GetAnimation( eAnim );
+
+		PropsA.Clear();
+		PropsB.Clear();
+		bool bSame = ( pTreeA->GetAnimationProps( eAnim, PropsA ) == pTreeB->GetAnimationProps( eAnim, PropsB ) ) && ( PropsA == PropsB );
+		bSame = bSame && ( pTreeA->GetAnimationDescriptors( eAnim, DescsA ) == pTreeB->GetAnimationDescriptors( eAnim, DescsB ) ) && ( DescsA == DescsB );
+		bSame = bSame && pTreeA->GetAnimationBlendData( eAnim, BlendA ) && pTreeB->GetAnimationBlendData( eAnim, BlendB ) && SameBlendData( BlendA, BlendB );
+		bSame = bSame && pTreeA->GetAnimationRate( eAnim, fRateA ) && pTreeB->GetAnimationRate( eAnim, fRateB ) && ( fRateA == fRateB );
+		bSame = bSame && LTStrEquals( pTreeA->GetAnimationName( eAnim ), pTreeB->GetAnimationName( eAnim ) );
+		bSame = bSame && ( pAnimA->iDefaultTransitionIn == pAnimB->iDefaultTransitionIn ) &&
+				( pAnimA->iDefaultTransitionOut == pAnimB->iDefaultTransitionOut ) &&
+				( pAnimA->iTransitionSetIn == pAnimB->iTransitionSetIn ) &&
+				( pAnimA->iTransitionSetOut == pAnimB->iTransitionSetOut );
+
+		// Searching with an animation's own props finds the same animation
+		// with the same seed, and counts the same alternatives.
+
+		uint32 iSeedA = iAnim;
+		uint32 iSeedB = iAnim;
+		bSame = bSame && ( pTreeA->FindAnimation( PropsA, &iSeedA ) == pTreeB->FindAnimation( PropsB, &iSeedB ) ) && ( iSeedA == iSeedB );
+		bSame = bSame && ( pTreeA->CountAnimations( PropsA ) == pTreeB->CountAnimations( PropsB ) );
+
+		if( !bSame )
+		{
+			++nMismatches;
+		}
+	}
+
+	for( uint32 iTrans=0; iTrans < pTreeA->GetNumTransitions(); ++iTrans )
+	{
+		AT_TRANSITION_ID eTrans = (AT_TRANSITION_ID)iTrans;
+
+		bool bSame = ( pTreeA->GetTransitionDescriptors( eTrans, DescsA ) == pTreeB->GetTransitionDescriptors( eTrans, DescsB ) ) && ( DescsA == DescsB );
+		bSame = bSame && pTreeA->GetTransitionBlendData( eTrans, BlendA ) && pTreeB->GetTransitionBlendData( eTrans, BlendB ) && SameBlendData( BlendA, BlendB );
+		bSame = bSame && pTreeA->GetTransitionRate( eTrans, fRateA ) && pTreeB->GetTransitionRate( eTrans, fRateB ) && ( fRateA == fRateB );
+		bSame = bSame && LTStrEquals( pTreeA->GetTransitionName( eTrans ), pTreeB->GetTransitionName( eTrans ) );
+
+		if( !bSame )
+		{
+			++nMismatches;
+		}
+	}
+
+	return nMismatches;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAnimationTreePackedMgr::RunAnimTreeCompare
+//
+//	PURPOSE:	Load a private, unshared copy of every loaded tree and 
+//				compare the results of every query against the loaded one.
+//
+// ----------------------------------------------------------------------- //
+
+void CAnimationTreePackedMgr::RunAnimTreeCompare()
+{
+	uint32 nTotalMismatches = 0;
+
+	ANIM_TREE_PACKED_LIST::iterator itTree;
+	for( itTree = m_lstAnimTrees.begin(); itTree != m_lstAnimTrees.end(); ++itTree )
+	{
+		CAnimationTreePacked* pTree = *itTree;
+
+		CAnimationTreePacked* pPrivateTree = debug_new( CAnimationTreePacked );
+		CAnimationTreePackedLoader Loader;
+		if( !Loader.LoadAnimationTreePacked( pPrivateTree, pTree->GetFilename(), false ) )
+		{
+			g_pLTBase->CPrint( "AnimTreeCompare: %s failed to load.", pTree->GetFilename() );
+			debug_delete( pPrivateTree );
+			++nTotalMismatches;
+			continue;
+		}
+
+		uint32 nMismatches = CompareAnimationTrees( pTree, pPrivateTree );
+		g_pLTBase->CPrint( "AnimTreeCompare: %s (%s, %u bytes) %u animations, %u transitions, %u mismatches.", 
+			pTree->GetFilename(), pTree->m_SharedDataBlock.IsMapped() ? "shared" : "private", pTree->m_nDataBlockSize, 
+			pTree->GetNumAnimations(), pTree->GetNumTransitions(), nMismatches );
+		nTotalMismatches += nMismatches;
+
+		debug_delete( pPrivateTree );
+	}
+
+	g_pLTBase->CPrint( "AnimTreeCompare: %u trees, %u mismatches.", (uint32)m_lstAnimTrees.size(), nTotalMismatches );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CAnimationTreePackedMgr::RunAnimTreeLoadBenchmark
+//
+//	PURPOSE:	Time loads of every loaded tree into a private block and
+//				through the shared cache file.
+//
+// ----------------------------------------------------------------------- //
+
+void CAnimationTreePackedMgr::RunAnimTreeLoadBenchmark( uint32 nLoads )
+{
+	if( nLoads == 0 )
+	{
+		nLoads = 20;
+	}
+
+	double fPrivateMS = 0.0;
+	double fSharedMS = 0.0;
+	uint32 nPrivateBytes = 0;
+	uint32 nSharedBytes = 0;
+
+	for( uint32 iLoad=0; iLoad < nLoads; ++iLoad )
+	{
+		ANIM_TREE_PACKED_LIST::iterator itTree;
+		for( itTree = m_lstAnimTrees.begin(); itTree != m_lstAnimTrees.end(); ++itTree )
+		{
+			for( uint32 iShared=0; iShared < 2; ++iShared )
+			{
+				CAnimationTreePacked* pTree = debug_new( CAnimationTreePacked );
+				CAnimationTreePackedLoader Loader;
+
+				TLTPrecisionTime StartTime = LTTimeUtils::GetPrecisionTime();
+				bool bLoaded = Loader.LoadAnimationTreePacked( pTree, (*itTree)->GetFilename(), ( iShared != 0 ) );
+				double fLoadMS = LTTimeUtils::GetPrecisionTimeIntervalMS( StartTime, LTTimeUtils::GetPrecisionTime() );
+
+				if( bLoaded && ( iLoad == 0 ) )
+				{
+					if( pTree->m_SharedDataBlock.IsMapped() )
+					{
+						nSharedBytes += pTree->m_nDataBlockSize;
+					}
+					else
+					{
+						nPrivateBytes += pTree->m_nDataBlockSize;
+					}
+				}
+				if( iShared )
+				{
+					fSharedMS += fLoadMS;
+				}
+				else
+				{
+					fPrivateMS += fLoadMS;
+				}
+
+				debug_delete( pTree );
+			}
+		}
+	}
+
+	uint32 nTreeLoads = nLoads * (uint32)m_lstAnimTrees.size();
+	if( nTreeLoads == 0 )
+	{
+		g_pLTBase->CPrint( "AnimTreeLoadBenchmark: No trees are loaded." );
+		return;
+	}
+
+	g_pLTBase->CPrint( "AnimTreeLoadBenchmark: %u trees x %u loads.", (uint32)m_lstAnimTrees.size(), nLoads );
+	g_pLTBase->CPrint( "  private: %8.3f ms per tree", fPrivateMS / nTreeLoads );
+	g_pLTBase->CPrint( "  shared:  %8.3f ms per tree", fSharedMS / nTreeLoads );
+	g_pLTBase->CPrint( "  %u bytes mapped from the shared cache, %u bytes private per process.", nSharedBytes, nPrivateBytes );
+}
+
+// ----------------------------------------------------------------------- //
+
+static void AnimTreeCompareCB( int argc, char** argv )
+{
+	if( g_pAnimationTreePackedMgr )
+	{
+		g_pAnimationTreePackedMgr->RunAnimTreeCompare();
+	}
+}
+
+static void AnimTreeLoadBenchmarkCB( int argc, char** argv )
+{
+	if( g_pAnimationTreePackedMgr )
+	{
+		uint32 nLoads = ( argc > 0 ) ? (uint32)atoi( argv[0] ) : 0;
+		g_pAnimationTreePackedMgr->RunAnimTreeLoadBenchmark( nLoads );
+	}
+}
+
+#endif // _FINAL
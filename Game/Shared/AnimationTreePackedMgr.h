@@ -75,6 +75,13 @@ class CAnimationTreePackedMgr
 												const ANIM_TREE_PACKED_LIST &lstAnimTreePacked, 
 												TRANS_QUERY_RESULTS &rTransResults ) const;
 
+#ifndef _FINAL
+		// Console programs.
+
+		void					RunAnimTreeCompare();
+		void					RunAnimTreeLoadBenchmark( uint32 nLoads );
+#endif // _FINAL
+
 	private:
 
 		CAnimationTreePacked*	FindAnimationTreePacked( const char* pszFilename );
@@ -83,6 +90,10 @@ class CAnimationTreePackedMgr
 		void					AssignGlobalTransitionIDs( CAnimationTreePacked* pTree );
 		AT_GLOBAL_TRANSITION_ID	GetGlobalTransitionID( const char* pszName );
 
+#ifndef _FINAL
+		static uint32			CompareAnimationTrees( CAnimationTreePacked* pTreeA, CAnimationTreePacked* pTreeB );
+#endif // _FINAL
+
 	private:
 
 		ANIM_TREE_PACKED_LIST					m_lstAnimTrees;
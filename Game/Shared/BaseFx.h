@@ -140,6 +140,7 @@ typedef void			(*FX_SETAPPFOCUS)(bool bAppFocus);
 typedef void			(*FX_FREEPROPLIST)(CBaseFXProps* pPropList);
 typedef void			(*FX_INITDLLRUNTIME)();
 typedef void			(*FX_TERMDLLRUNTIME)();
+typedef void			(*FX_SETPARALLELUPDATE)(bool bParallelUpdate);
 
 // FX Base data structure, all FX need these
 struct FX_BASEDATA
@@ -214,6 +215,10 @@ struct CLIENTFX_CREATESTRUCT
 	//the name of the client effect to create
 	char				m_sName[MAX_CLIENTFX_NAME_LEN + 1];
 
+	//an optional handle to the effect named above, which if valid will be used instead of
+	//looking the effect up by name
+	HFXGROUP			m_hGroup;
+
 	//flags to specify for the client effect, a combination of the FXFLAG_ flags
 	uint32				m_dwFlags;
 
@@ -243,6 +248,7 @@ private:
 		memset(this, 0, sizeof(CLIENTFX_CREATESTRUCT));
 		LTStrCpy(m_sName, pszName, LTARRAYSIZE(m_sName));
 		m_dwFlags			= nFlags;
+		m_hGroup			= INVALID_FX_GROUP;
 		m_hNode				= INVALID_MODEL_NODE;
 		m_hSocket			= INVALID_MODEL_SOCKET;
 		m_hParentRigidBody	= INVALID_PHYSICS_RIGID_BODY;
@@ -15,13 +15,36 @@ public:
 	CLTFileToILTInStream() : m_bError(true)		{}
 	~CLTFileToILTInStream()						{}
 
-	bool Open(const char* pszAbsoluteFile)
+	bool Open(const char* pszAbsoluteFile, bool bMapped = true)
 	{
-		//open up our file, and reset our error state
-		m_bError = !m_InFile.Open(pszAbsoluteFile);
+		//open up our file, and reset our error state.  The file is mapped where the
+		//platform supports it since the loaders using this read it front to back.
+		//Files that may be rewritten while they are open, such as user edited settings,
+		//should not be mapped (see ILTFileRead::OpenMapped).
+		if(bMapped)
+			m_bError = !m_InFile.OpenMapped(pszAbsoluteFile, ILTFileRead::eAccessSequential);
+		else
+			m_bError = !m_InFile.Open(pszAbsoluteFile);
+
 		return !m_bError;
 	}	
 
+	//returns a pointer to the next size bytes of the file and moves past them without
+	//copying them.  This returns NULL if the file isn't mapped or is too short, in which
+	//case the data must be read with Read.  The pointer is valid until the stream is released.
+	const void* GetMappedData(uint32 size)
+	{
+		if(m_bError)
+			return NULL;
+
+		uint64 nPos = GetPos();
+		const void* pData = m_InFile.GetMappedRange(nPos, size);
+		if(pData)
+			m_InFile.Seek(nPos + size);
+
+		return pData;
+	}
+
 	virtual void Release()
 	{
 		delete this;
@@ -5,6 +5,7 @@
 #include "iltfilemgr.h"
 #include "ltfileoperations.h"
 #include "CLTFileToILTInStream.h"
+#include "lttimeutils.h"
 
 #if defined(PLATFORM_XENON)
 // XENON: Necessary code for implementing runtime swapping
@@ -212,6 +213,120 @@ private:
 	CClientFXDB::TFxResourceList&	m_ResourceList;
 };
 
+//-----------------------------------------------------------------
+// Name index utilities
+//-----------------------------------------------------------------
+
+//the value of an empty slot in a name index
+static const uint32 knInvalidNameIndex = (uint32)-1;
+
+//case insensitive FNV-1a hash of an effect name
+static uint32 HashFxName(const char* pszName)
+{
+	uint32 nHash = 2166136261u;
+	for(; *pszName; pszName++)
+	{
+		nHash ^= (uint32)tolower((uint8)*pszName);
+		nHash *= 16777619u;
+	}
+	return nHash;
+}
+
+//accessors for the names of the items that are indexed
+struct SEffectGroupName
+{
+	SEffectGroupName(const FX_GROUP* const* ppGroups) : m_ppGroups(ppGroups) {}
+	const char* operator()(uint32 nIndex) const		{ return m_ppGroups[nIndex]->m_sName; }
+	const FX_GROUP* const* m_ppGroups;
+};
+
+struct SEffectTypeName
+{
+	SEffectTypeName(const FX_REF* pTypes) : m_pTypes(pTypes) {}
+	const char* operator()(uint32 nIndex) const		{ return m_pTypes[nIndex].m_sName; }
+	const FX_REF* m_pTypes;
+};
+
+template<class THandle>
+struct SGroupHandleName
+{
+	SGroupHandleName(const THandle* pHandles) : m_pHandles(pHandles) {}
+	const char* operator()(uint32 nIndex) const		{ return m_pHandles[nIndex].m_sName.c_str(); }
+	const THandle* m_pHandles;
+};
+
+//finds the index of the item with the specified name in the table, or knInvalidNameIndex if it is not present
+template<class TNameTable, class TGetName>
+static uint32 FindInNameIndex(const TNameTable& Table, const char* pszName, const TGetName& GetName)
+{
+	if(Table.empty())
+		return knInvalidNameIndex;
+
+	//the table size is always a power of two, so the probe can just wrap with a mask
+	uint32 nMask = (uint32)Table.size() - 1;
+	for(uint32 nSlot = HashFxName(pszName) & nMask; ; nSlot = (nSlot + 1) & nMask)
+	{
+		uint32 nIndex = Table[nSlot];
+		if(nIndex == knInvalidNameIndex)
+			return knInvalidNameIndex;
+
+		if(LTStrIEquals(pszName, GetName(nIndex)))
+			return nIndex;
+	}
+}
+
+//builds a table for the specified number of items. If multiple items share a name, the
+//earliest one is indexed.
+template<class TNameTable, class TGetName>
+static void BuildNameIndex(TNameTable& Table, uint32 nNumItems, const TGetName& GetName)
+{
+	Table.clear();
+	if(nNumItems == 0)
+		return;
+
+	//keep the table at most half full so that the probe sequences stay short
+	uint32 nTableSize = 16;
+	while(nTableSize < nNumItems * 2)
+		nTableSize *= 2;
+
+	Table.resize(nTableSize, knInvalidNameIndex);
+	uint32 nMask = nTableSize - 1;
+
+	for(uint32 nCurrItem = 0; nCurrItem < nNumItems; nCurrItem++)
+	{
+		const char* pszName = GetName(nCurrItem);
+		uint32 nSlot = HashFxName(pszName) & nMask;
+		while(Table[nSlot] != knInvalidNameIndex)
+		{
+			if(LTStrIEquals(pszName, GetName(Table[nSlot])))
+				break;
+			nSlot = (nSlot + 1) & nMask;
+		}
+
+		if(Table[nSlot] == knInvalidNameIndex)
+			Table[nSlot] = nCurrItem;
+	}
+}
+
+//adds the last of the specified number of items to a table, which must not already hold its
+//name. The table is rebuilt larger when it would become more than half full.
+template<class TNameTable, class TGetName>
+static void AddToNameIndex(TNameTable& Table, uint32 nNumItems, const TGetName& GetName)
+{
+	if(Table.size() < nNumItems * 2)
+	{
+		BuildNameIndex(Table, nNumItems, GetName);
+		return;
+	}
+
+	uint32 nMask = (uint32)Table.size() - 1;
+	uint32 nSlot = HashFxName(GetName(nNumItems - 1)) & nMask;
+	while(Table[nSlot] != knInvalidNameIndex)
+		nSlot = (nSlot + 1) & nMask;
+
+	Table[nSlot] = nNumItems - 1;
+}
+
 //-----------------------------------------------------------------
 // CClientFXDB construction
 //-----------------------------------------------------------------
@@ -226,6 +341,7 @@ CClientFXDB::CClientFXDB()
 
 	m_pfnDeleteFX			= NULL;
 	m_pfnGetVersion			= NULL;
+	m_pfnSetParallelUpdate	= NULL;
 
 }
 
@@ -284,9 +400,9 @@ bool CClientFXDB::LoadFxFilesInDir(ILTCSBase* pLTCSBase, const char* pszRelDirec
 	// Free the List we obtained
 	pLTCSBase->FileMgr()->FreeFileList( pFiles );
 
-	//now that we have loaded in all of the effects we can now sort them so that we can find
-	//the effects quickly later
-	std::sort(m_Effects.begin(), m_Effects.end(), SortEffectNameCallback);
+	//now that we have loaded in all of the effects we can now sort and index them so that we
+	//can find the effects quickly later
+	OnEffectsChanged();
 
 #ifndef _FINAL
 	//we also need to run through and bring up a console error for every naming conflict we find
@@ -347,9 +463,9 @@ bool CClientFXDB::LoadToolFxFilesInDir(const char* pszAbsoluteDirectory)
 		LTFileOperations::FindClose(hCurrFile);
 	}
 
-	//now that we have loaded in all of the effects we can now sort them so that we can find
-	//the effects quickly later
-	std::sort(m_Effects.begin(), m_Effects.end(), SortEffectNameCallback);
+	//now that we have loaded in all of the effects we can now sort and index them so that we
+	//can find the effects quickly later
+	OnEffectsChanged();
 
 	//success
 	return true;
@@ -382,6 +498,7 @@ void CClientFXDB::UnloadFxFiles()
 		FreeFxGroup(**it);
 	}
 	m_Effects.clear();
+	OnEffectsChanged();
 
 	//and now all of our data blocks
 	for(TStringTableList::iterator it = m_DataBlocks.begin(); it != m_DataBlocks.end(); it++)
@@ -406,6 +523,7 @@ extern "C"
 	void fxSetPlayer(HOBJECT hPlayer);
 	void fxInitDLLRuntime();
 	void fxTermDLLRuntime();
+	void fxSetParallelUpdate(bool bParallelUpdate);
 }
 #endif // PLATFORM_SEM
 
@@ -426,6 +544,7 @@ bool CClientFXDB::LoadFxDll(const char* pszClientFxFile, bool bUseEngineFileSyst
 	m_pfnFreePropList		= fxFreePropList;
 	m_pfnGetVersion			= fxGetVersion;
 	m_pfnTermDLLRuntime		= fxTermDLLRuntime;
+	m_pfnSetParallelUpdate	= fxSetParallelUpdate;
 
 #else // PLATFORM_SEM
 
@@ -472,10 +591,11 @@ bool CClientFXDB::LoadFxDll(const char* pszClientFxFile, bool bUseEngineFileSyst
 	m_pfnDeleteFX			= (FX_DELETEFUNC)LTLibraryLoader::GetProcAddress(m_hClientFxModule, "fxDelete");
 	m_pfnFreePropList		= (FX_FREEPROPLIST)LTLibraryLoader::GetProcAddress(m_hClientFxModule, "fxFreePropList");
 	m_pfnGetVersion			= (FX_GETVERSION)LTLibraryLoader::GetProcAddress(m_hClientFxModule, "fxGetVersion");
+	m_pfnSetParallelUpdate	= (FX_SETPARALLELUPDATE)LTLibraryLoader::GetProcAddress(m_hClientFxModule, "fxSetParallelUpdate");
 
 	//validate all the functions were properly loaded
 	if (!pfnNum || !pfnRef || !pfnInitDLLRuntime || !m_pfnTermDLLRuntime || 
-		!m_pfnDeleteFX || !m_pfnFreePropList || !m_pfnGetVersion) 
+		!m_pfnDeleteFX || !m_pfnFreePropList || !m_pfnGetVersion || !m_pfnSetParallelUpdate) 
 	{
 		//failed to get all of the DLL entry points, so fail
 		UnloadFxDll();
@@ -506,6 +626,9 @@ bool CClientFXDB::LoadFxDll(const char* pszClientFxFile, bool bUseEngineFileSyst
 		m_pEffectTypes[nCurrEffect] = pfnRef(nCurrEffect);
 	}
 
+	//and index the types by name for FindFX
+	BuildNameIndex(m_EffectTypeIndex, m_nNumEffectTypes, SEffectTypeName(m_pEffectTypes));
+
 	// Success !!
 	return true;
 }
@@ -548,11 +671,13 @@ void CClientFXDB::UnloadFxDll()
 	m_pfnGetVersion			= NULL;
 	m_pfnTermDLLRuntime		= NULL;
 	m_pfnFreePropList		= NULL;
+	m_pfnSetParallelUpdate	= NULL;
 	
 	//cleanup our list of effect definitions
 	debug_deletea(m_pEffectTypes);
 	m_pEffectTypes		= NULL;
 	m_nNumEffectTypes	= 0;
+	m_EffectTypeIndex.clear();
 }
 
 //-----------------------------------------------------------------
@@ -787,50 +912,199 @@ const FX_GROUP* CClientFXDB::FindGroupFX(const char *sName) const
 	if(!sName || !sName[0] ) 
 		return NULL;
 
-	// Locate the group using a binary search since all of our effects have been sorted
-	//based upon name already
-	int32 nMin = 0; 
-	int32 nMax = (int32)m_Effects.size() - 1;
+	uint32 nEffect = FindInNameIndex(m_EffectIndex, sName, SEffectGroupName(m_Effects.empty() ? NULL : &m_Effects[0]));
+	if(nEffect == knInvalidNameIndex)
+		return NULL;
+
+	return m_Effects[nEffect];
+}
+
+//resolves an effect name to a handle that can be used to find the effect without any string comparisons
+HFXGROUP CClientFXDB::ResolveGroupFX(const char* pszName)
+{
+	//bail if we don't have a valid name
+	if(!pszName || !pszName[0])
+		return INVALID_FX_GROUP;
+
+	//see if this name has already been resolved
+	uint32 nHandle = FindInNameIndex(m_GroupHandleIndex, pszName, SGroupHandleName<SGroupHandle>(m_GroupHandles.empty() ? NULL : &m_GroupHandles[0]));
+	if(nHandle != knInvalidNameIndex)
+		return (HFXGROUP)nHandle;
+
+	//add a new handle and bind it to the effect if it is loaded
+	SGroupHandle NewHandle;
+	NewHandle.m_sName	= pszName;
+	NewHandle.m_pGroup	= FindGroupFX(pszName);
+	m_GroupHandles.push_back(NewHandle);
+
+	AddToNameIndex(m_GroupHandleIndex, (uint32)m_GroupHandles.size(), SGroupHandleName<SGroupHandle>(&m_GroupHandles[0]));
+
+	return (HFXGROUP)(m_GroupHandles.size() - 1);
+}
+
+//returns the effect a handle refers to
+const FX_GROUP* CClientFXDB::GetGroupFX(HFXGROUP hGroup) const
+{
+	if(hGroup >= m_GroupHandles.size())
+		return NULL;
+
+	return m_GroupHandles[hGroup].m_pGroup;
+}
+
+#ifndef _FINAL
+
+//finds the first effect with a name in the sorted effect list, the way FindGroupFX did before
+//the name index
+struct SEffectNameLess
+{
+	bool operator()(const FX_GROUP* pGroup, const char* pszName) const		{ return LTStrICmp(pGroup->m_sName, pszName) < 0; }
+	bool operator()(const char* pszName, const FX_GROUP* pGroup) const		{ return LTStrICmp(pszName, pGroup->m_sName) < 0; }
+	bool operator()(const FX_GROUP* pLhs, const FX_GROUP* pRhs) const		{ return LTStrICmp(pLhs->m_sName, pRhs->m_sName) < 0; }
+};
+
+//the ways that the lookup benchmark finds an effect
+enum ELookupPath
+{
+	eLookupPath_BinarySearch,
+	eLookupPath_NameIndex,
+	eLookupPath_Resolve,
+	eLookupPath_Handle,
+
+	eLookupPath_Count
+};
+
+static const char* s_aszLookupPathNames[eLookupPath_Count] =
+{
+	"binary search",
+	"name index",
+	"resolve",
+	"handle",
+};
+
+uint32 CClientFXDB::RunLookupBenchmark(uint32 nIterations, TReportFn pfnReport)
+{
+	char szMessage[256];
+
+	if(nIterations == 0)
+		nIterations = 100;
 
-	while(nMin <= nMax)
+	uint32 nNumEffects = (uint32)m_Effects.size();
+	if(nNumEffects == 0)
 	{
-		int32 nMid = (nMin + nMax) / 2;
-		int32 nKey = stricmp(sName, m_Effects[nMid]->m_sName);
+		pfnReport("no effects are loaded");
+		return 1;
+	}
 
-		//check for a match
-		if(nKey == 0)
-		{
-			return m_Effects[nMid];
-		}
+	//look up copies of the names, so that nothing can be found by pointer
+	std::vector<std::string> Names(nNumEffects);
+	for(uint32 nEffect = 0; nEffect < nNumEffects; nEffect++)
+		Names[nEffect] = m_Effects[nEffect]->m_sName;
 
-		//no match, continue the binary search
-		if(nKey < 0)
-		{
-			//bottom half
-			nMax = nMid - 1;
-		}
+	//every way of finding an effect should find the first one in the sorted list with that name
+	std::vector<const FX_GROUP*> Expected(nNumEffects);
+	for(uint32 nEffect = 0; nEffect < nNumEffects; nEffect++)
+	{
+		if((nEffect > 0) && LTStrIEquals(m_Effects[nEffect - 1]->m_sName, m_Effects[nEffect]->m_sName))
+			Expected[nEffect] = Expected[nEffect - 1];
 		else
+			Expected[nEffect] = m_Effects[nEffect];
+	}
+
+	//resolve into a separate set of handles so that the real ones are not changed
+	TGroupHandleList SavedHandles;
+	TNameIndex SavedHandleIndex;
+	SavedHandles.swap(m_GroupHandles);
+	SavedHandleIndex.swap(m_GroupHandleIndex);
+
+	TLTPrecisionTime StartTime = LTTimeUtils::GetPrecisionTime();
+	std::vector<HFXGROUP> Handles(nNumEffects);
+	for(uint32 nEffect = 0; nEffect < nNumEffects; nEffect++)
+		Handles[nEffect] = ResolveGroupFX(Names[nEffect].c_str());
+	double fFirstResolveMS = LTTimeUtils::GetPrecisionTimeIntervalMS(StartTime, LTTimeUtils::GetPrecisionTime());
+
+	uint32 nFailures = 0;
+	for(uint32 nPath = 0; nPath < eLookupPath_Count; nPath++)
+	{
+		StartTime = LTTimeUtils::GetPrecisionTime();
+		for(uint32 nIteration = 0; nIteration < nIterations; nIteration++)
 		{
-			//top half
-			nMin = nMid + 1;
+			for(uint32 nEffect = 0; nEffect < nNumEffects; nEffect++)
+			{
+				const char* pszName = Names[nEffect].c_str();
+				const FX_GROUP* pGroup = NULL;
+				switch(nPath)
+				{
+				case eLookupPath_BinarySearch:
+					{
+						TEffectList::const_iterator itGroup = std::lower_bound(m_Effects.begin(), m_Effects.end(), pszName, SEffectNameLess());
+						if((itGroup != m_Effects.end()) && LTStrIEquals((*itGroup)->m_sName, pszName))
+							pGroup = *itGroup;
+					}
+					break;
+				case eLookupPath_NameIndex:
+					pGroup = FindGroupFX(pszName);
+					break;
+				case eLookupPath_Resolve:
+					pGroup = GetGroupFX(ResolveGroupFX(pszName));
+					break;
+				default:
+					pGroup = GetGroupFX(Handles[nEffect]);
+					break;
+				}
+
+				if((nIteration == 0) && (pGroup != Expected[nEffect]))
+					nFailures++;
+			}
 		}
+		double fMS = LTTimeUtils::GetPrecisionTimeIntervalMS(StartTime, LTTimeUtils::GetPrecisionTime());
+
+		LTSNPrintF(szMessage, LTARRAYSIZE(szMessage), "%s: %.1f ns per lookup", s_aszLookupPathNames[nPath], fMS * 1000000.0 / ((double)nIterations * nNumEffects));
+		pfnReport(szMessage);
 	}
 
-	//No match was found
-	return NULL;
+	LTSNPrintF(szMessage, LTARRAYSIZE(szMessage), "%u effects, resolving each name the first time: %.1f ns per name", nNumEffects, fFirstResolveMS * 1000000.0 / nNumEffects);
+	pfnReport(szMessage);
+
+	//every resolve after the first must have found the existing handle
+	if(m_GroupHandles.size() > nNumEffects)
+		nFailures++;
+
+	SavedHandles.swap(m_GroupHandles);
+	SavedHandleIndex.swap(m_GroupHandleIndex);
+
+	return nFailures;
 }
 
-//Finds an effect of the appropraite type
-const FX_REF* CClientFXDB::FindFX(const char *sName) const
+#endif
+
+//called once the effect list has changed to sort it and rebuild the name index and handles
+void CClientFXDB::OnEffectsChanged()
 {
-	for(uint32 nCurrEffect = 0; nCurrEffect < m_nNumEffectTypes; nCurrEffect++)
+	//sort the effects by name. This is no longer needed for finding the effects, but keeps
+	//duplicate names adjacent for reporting conflicts
+	std::sort(m_Effects.begin(), m_Effects.end(), SortEffectNameCallback);
+
+	BuildNameIndex(m_EffectIndex, (uint32)m_Effects.size(), SEffectGroupName(m_Effects.empty() ? NULL : &m_Effects[0]));
+
+	//and rebind all of the handles to the new effects
+	for(TGroupHandleList::iterator it = m_GroupHandles.begin(); it != m_GroupHandles.end(); it++)
 	{
-		if (LTStrIEquals(sName, m_pEffectTypes[nCurrEffect].m_sName)) 
-			return &m_pEffectTypes[nCurrEffect];
+		it->m_pGroup = FindGroupFX(it->m_sName.c_str());
 	}
+}
+
+//Finds an effect of the appropraite type
+const FX_REF* CClientFXDB::FindFX(const char *sName) const
+{
+	//bail if we don't have a valid name
+	if(!sName)
+		return NULL;
 
-	// Failure !!
-	return NULL;
+	uint32 nEffectType = FindInNameIndex(m_EffectTypeIndex, sName, SEffectTypeName(m_pEffectTypes));
+	if(nEffectType == knInvalidNameIndex)
+		return NULL;
+
+	return &m_pEffectTypes[nEffectType];
 }
 
 //given a resource name, this will collect all of the resources that are reference by that effect.
@@ -873,6 +1147,14 @@ void CClientFXDB::DeleteEffect(CBaseFX* pFx)
 	}
 }
 
+void CClientFXDB::SetParallelUpdate(bool bParallelUpdate)
+{
+	if(m_pfnSetParallelUpdate)
+	{
+		m_pfnSetParallelUpdate(bParallelUpdate);
+	}
+}
+
 //------------------------------------------------------------------
 // CClientFXDB Singleton support
 //------------------------------------------------------------------
@@ -108,9 +108,29 @@ public:
 	//used for finding specific effects for creation
 	const FX_GROUP*		FindGroupFX(const char *sName) const;
 
+	//resolves an effect name to a handle once so that the effect can later be found without
+	//any string comparisons. The effect does not need to be loaded yet, in which case the
+	//handle will be bound when it is loaded. Returns INVALID_FX_GROUP for an empty name.
+	HFXGROUP			ResolveGroupFX(const char* pszName);
+
+	//returns the effect a handle refers to, or NULL if it is not currently loaded
+	const FX_GROUP*		GetGroupFX(HFXGROUP hGroup) const;
+
+#ifndef _FINAL
+	//times finding every loaded effect by name, with the binary search that the name index
+	//replaced, by resolving the name, and by handle, and checks that they all find the same
+	//effect. The handles already resolved are left alone. Returns the number of failures.
+	typedef void (*TReportFn)(const char* pszMessage);
+	uint32				RunLookupBenchmark(uint32 nIterations, TReportFn pfnReport);
+#endif
+
 	//called to delete an effect
 	void				DeleteEffect(CBaseFX* pFx);
 
+	//called before and after the work queued by effects is run on the worker threads, so that
+	//the effect DLL can protect the data that this work shares between effects
+	void				SetParallelUpdate(bool bParallelUpdate);
+
 	//sets up the parameters for the effect
 	void				SetAppFocus(bool bAppFocus);
 
@@ -133,6 +153,29 @@ private:
 	typedef std::vector<uint8*, LTAllocator<uint8*, LT_MEM_TYPE_CLIENTSHELL> >		TStringTableList;
 	TStringTableList	m_DataBlocks;
 
+	//an open addressing hash table, keyed case insensitively by name, that holds indices
+	//into a list of named items. Empty slots hold an invalid index of -1.
+	typedef std::vector<uint32, LTAllocator<uint32, LT_MEM_TYPE_CLIENTSHELL> >		TNameIndex;
+
+	//the name index for m_Effects and m_pEffectTypes
+	TNameIndex			m_EffectIndex;
+	TNameIndex			m_EffectTypeIndex;
+
+	//the names that have been resolved to handles, and the effect each handle is bound to
+	struct SGroupHandle
+	{
+		std::string		m_sName;
+		const FX_GROUP*	m_pGroup;
+	};
+	typedef std::vector<SGroupHandle, LTAllocator<SGroupHandle, LT_MEM_TYPE_CLIENTSHELL> >	TGroupHandleList;
+	TGroupHandleList	m_GroupHandles;
+
+	//the name index for m_GroupHandles
+	TNameIndex			m_GroupHandleIndex;
+
+	//called once the effect list has changed to sort it and rebuild the name index and handles
+	void				OnEffectsChanged();
+
 	//called to free an effect group object that has been constructed (note that it does not
 	//delete the memory since it assumes that it was created in place)
 	void				FreeFxGroup(FX_GROUP& FxGroup);
@@ -163,6 +206,7 @@ private:
 	FX_FREEPROPLIST		m_pfnFreePropList;
 	FX_DELETEFUNC		m_pfnDeleteFX;
 	FX_TERMDLLRUNTIME	m_pfnTermDLLRuntime;
+	FX_SETPARALLELUPDATE	m_pfnSetParallelUpdate;
 
 	//this is only intended for use as a singleton so prevent instantiation
 	CClientFXDB();
@@ -0,0 +1,899 @@
+// ----------------------------------------------------------------------- //
+//
+// MODULE  : EventCaster.cpp
+//
+// PURPOSE : EventCaster - implementation of casting events to delegates.
+//
+// CREATED : 10/18/26
+//
+// (c) 2026 Monolith Productions, Inc.  All Rights Reserved
+//
+// ----------------------------------------------------------------------- //
+
+#include "Stdafx.h"
+#include "EventCaster.h"
+#include "ltautocriticalsection.h"
+#include "ltinterlockedoperations.h"
+#include "ltthreadutils.h"
+#include "ltthread.h"
+#include "lttimeutils.h"
+
+#if defined(PLATFORM_LINUX)
+	#define EVENTCASTER_THREADLOCAL __thread
+#else
+	#define EVENTCASTER_THREADLOCAL __declspec(thread)
+#endif
+
+// Lists of thread safe events that each thread is notifying with.  A notify stores its
+// list in the next slot of its thread before walking it, and a replaced list is not freed
+// while any thread has it in a slot.  Each thread only writes its own slots, so notifies
+// on different threads never wait on each other, and a list only has to wait for the
+// notifies that were already using it when it was replaced.  Each notify has a second
+// slot for the published list while looking up delegates in it.
+//
+// A thread takes a record when its outermost notify starts and gives it back when that
+// notify ends, so threads that only notify once, like the save writer's, don't use up
+// the records.  A thread tries the record it had last first, which is usually still
+// free.  A thread that can't get a record, or with every slot in use, holds the event's
+// lock for the whole notify instead.
+enum
+{
+	kMaxSharedNotifyThreads	= 64,
+	kMaxSharedNotifyDepth	= 8,
+};
+
+struct SharedNotifyThread
+{
+	void* volatile	m_aLists[kMaxSharedNotifyDepth * 2];
+
+	// Non-zero while a thread has the record.  Only changed with interlocked exchanges.
+	uint32 volatile	m_nTaken;
+
+	// Notifies using the slots.  Only used by the thread that has the record.
+	uint32			m_nDepth;
+};
+
+static SharedNotifyThread s_aSharedNotifyThreads[kMaxSharedNotifyThreads];
+
+// Records that have ever been taken.  Only these are searched.  This can go a little
+// past kMaxSharedNotifyThreads when threads race for the last record.
+static uint32 s_nNumSharedNotifyThreads = 0;
+
+static EVENTCASTER_THREADLOCAL SharedNotifyThread* s_pSharedNotifyThread = NULL;
+static EVENTCASTER_THREADLOCAL SharedNotifyThread* s_pLastSharedNotifyThread = NULL;
+
+// Returns true if the record was free and is now taken by the current thread.
+static bool TakeSharedNotifyThread( SharedNotifyThread* pThread )
+{
+	if( LTInterlockedOperations::InterlockedExchange(( uint32* )&pThread->m_nTaken, 1 ) != 0 )
+		return false;
+
+	s_pSharedNotifyThread = pThread;
+	s_pLastSharedNotifyThread = pThread;
+	return true;
+}
+
+// Returns the current thread's record, taking one if this is its outermost notify.
+// NULL if there are none free.
+static SharedNotifyThread* GetSharedNotifyThread( )
+{
+	if( s_pSharedNotifyThread )
+		return s_pSharedNotifyThread;
+
+	if( s_pLastSharedNotifyThread && TakeSharedNotifyThread( s_pLastSharedNotifyThread ))
+		return s_pSharedNotifyThread;
+
+	for( ;; )
+	{
+		uint32 nNumThreads = LTMIN( s_nNumSharedNotifyThreads, ( uint32 )kMaxSharedNotifyThreads );
+		for( uint32 nThread = 0; nThread < nNumThreads; ++nThread )
+		{
+			if( !s_aSharedNotifyThreads[nThread].m_nTaken && TakeSharedNotifyThread( &s_aSharedNotifyThreads[nThread] ))
+				return s_pSharedNotifyThread;
+		}
+
+		if( s_nNumSharedNotifyThreads >= kMaxSharedNotifyThreads )
+			break;
+
+		// Another thread may find the new record before this one takes it, so
+		// search again if it has gone.
+		uint32 nThread = LTInterlockedOperations::InterlockedIncrement( &s_nNumSharedNotifyThreads ) - 1;
+		if( nThread < kMaxSharedNotifyThreads && TakeSharedNotifyThread( &s_aSharedNotifyThreads[nThread] ))
+			return s_pSharedNotifyThread;
+	}
+
+	LTASSERT( false, "EventCaster: Too many threads notifying thread safe events at once." );
+	return NULL;
+}
+
+// Gives the current thread's record back once its outermost notify has finished.
+static void ReleaseSharedNotifyThread( SharedNotifyThread* pThread )
+{
+	s_pSharedNotifyThread = NULL;
+	LTInterlockedOperations::InterlockedExchange(( uint32* )&pThread->m_nTaken, 0 );
+}
+
+// Returns true if a thread other than pIgnoreThread is notifying with the list.
+static bool IsSharedListInUse( void const* pList, SharedNotifyThread const* pIgnoreThread )
+{
+	uint32 nNumThreads = LTMIN( s_nNumSharedNotifyThreads, ( uint32 )kMaxSharedNotifyThreads );
+	for( uint32 nThread = 0; nThread < nNumThreads; ++nThread )
+	{
+		SharedNotifyThread const& thread = s_aSharedNotifyThreads[nThread];
+		if( &thread == pIgnoreThread )
+			continue;
+
+		for( uint32 nSlot = 0; nSlot < LTARRAYSIZE( thread.m_aLists ); ++nSlot )
+		{
+			if( thread.m_aLists[nSlot] == pList )
+				return true;
+		}
+	}
+
+	return false;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::EventCaster
+//
+//	PURPOSE:	Construct the event, optionally thread safe.
+//
+// ----------------------------------------------------------------------- //
+EventCaster::EventCaster( bool bThreadSafe )
+{
+	m_pDelegates = m_aLocalDelegates;
+	m_nNumDelegates = 0;
+	m_nMaxDelegates = kNumLocalDelegates;
+	m_nNumDetached = 0;
+	m_nNotifyDepth = 0;
+	m_pSharedList = NULL;
+	m_nNumRetiredSharedLists = 0;
+	m_nLockedSharedNotifies = 0;
+	m_pSharedCS = bThreadSafe ? debug_new( CLTCriticalSection ) : NULL;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::~EventCaster
+//
+//	PURPOSE:	Let the attached delegates know the event is going away.
+//
+// ----------------------------------------------------------------------- //
+EventCaster::~EventCaster( )
+{
+	if( m_pSharedCS )
+	{
+		// The delegates detach themselves, each replacing the list, so walk a
+		// list that is no longer published.
+		SharedList* pList = m_pSharedList;
+		m_pSharedList = NULL;
+		if( pList )
+		{
+			for( uint32 nDelegate = 0; nDelegate < pList->m_nNumDelegates; ++nDelegate )
+			{
+				pList->m_aDelegates[nDelegate]->OnDestroy( *this );
+			}
+			debug_deletea(( uint8* )pList );
+		}
+
+		// No other thread can be notifying an event that is being destroyed.
+		for( uint32 nList = 0; nList < m_lstRetiredSharedLists.size( ); ++nList )
+		{
+			debug_deletea(( uint8* )m_lstRetiredSharedLists[nList] );
+		}
+		m_lstRetiredSharedLists.clear( );
+		m_nNumRetiredSharedLists = 0;
+
+		debug_delete( m_pSharedCS );
+		m_pSharedCS = NULL;
+		return;
+	}
+
+	// Hold off compacting while the delegates detach themselves.
+	++m_nNotifyDepth;
+	for( uint32 nDelegate = 0; nDelegate < m_nNumDelegates; ++nDelegate )
+	{
+		if( m_pDelegates[nDelegate] )
+		{
+			m_pDelegates[nDelegate]->OnDestroy( *this );
+		}
+	}
+	--m_nNotifyDepth;
+
+	if( m_pDelegates != m_aLocalDelegates )
+	{
+		debug_deletea( m_pDelegates );
+	}
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::Attach / Detach / DoNotify
+//
+//	PURPOSE:	Dispatch to the single threaded or thread safe version.
+//
+// ----------------------------------------------------------------------- //
+void EventCaster::Attach( DelegateBase& delegate )
+{
+	if( m_pSharedCS )
+		AttachShared( delegate );
+	else
+		AttachLocal( delegate );
+}
+
+void EventCaster::Detach( DelegateBase& delegate )
+{
+	if( m_pSharedCS )
+		DetachShared( delegate );
+	else
+		DetachLocal( delegate );
+}
+
+void EventCaster::DoNotify( NotifyParams& notifyParams )
+{
+	if( m_pSharedCS )
+		DoNotifyShared( notifyParams );
+	else
+		DoNotifyLocal( notifyParams );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::AttachLocal
+//
+//	PURPOSE:	Add the delegate to the end of the slots.
+//
+// ----------------------------------------------------------------------- //
+void EventCaster::AttachLocal( DelegateBase& delegate )
+{
+	if( m_nNumDelegates == m_nMaxDelegates )
+	{
+		// Reuse the slots of detached delegates before growing.
+		CompactLocal( );
+
+		if( m_nNumDelegates == m_nMaxDelegates )
+		{
+			uint32 nMaxDelegates = m_nMaxDelegates * 2;
+			DelegateBase** pDelegates = debug_newa( DelegateBase*, nMaxDelegates );
+			memcpy( pDelegates, m_pDelegates, m_nNumDelegates * sizeof( DelegateBase* ));
+
+			if( m_pDelegates != m_aLocalDelegates )
+			{
+				debug_deletea( m_pDelegates );
+			}
+
+			m_pDelegates = pDelegates;
+			m_nMaxDelegates = nMaxDelegates;
+		}
+	}
+
+	delegate.m_nEventCasterSlot = m_nNumDelegates;
+	m_pDelegates[m_nNumDelegates] = &delegate;
+	++m_nNumDelegates;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::DetachLocal
+//
+//	PURPOSE:	Clear the delegate's slot.
+//
+// ----------------------------------------------------------------------- //
+void EventCaster::DetachLocal( DelegateBase& delegate )
+{
+	uint32 nSlot = delegate.m_nEventCasterSlot;
+
+	// The slot is only known to be this event's if the delegate is in it.  A
+	// delegate base attached to more than one event needs to be searched for.
+	if( nSlot >= m_nNumDelegates || m_pDelegates[nSlot] != &delegate )
+	{
+		for( nSlot = 0; nSlot < m_nNumDelegates; ++nSlot )
+		{
+			if( m_pDelegates[nSlot] == &delegate )
+				break;
+		}
+
+		if( nSlot == m_nNumDelegates )
+			return;
+	}
+
+	m_pDelegates[nSlot] = NULL;
+	++m_nNumDetached;
+
+	// Keep the slots dense once more than half are empty.
+	if( m_nNumDetached * 2 > m_nNumDelegates )
+	{
+		CompactLocal( );
+	}
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::CompactLocal
+//
+//	PURPOSE:	Remove the empty slots, keeping the delegates in attach order.
+//
+// ----------------------------------------------------------------------- //
+void EventCaster::CompactLocal( )
+{
+	// Notifies in progress index the slots directly.
+	if( m_nNotifyDepth > 0 || m_nNumDetached == 0 )
+		return;
+
+	uint32 nNumDelegates = 0;
+	for( uint32 nDelegate = 0; nDelegate < m_nNumDelegates; ++nDelegate )
+	{
+		DelegateBase* pDelegate = m_pDelegates[nDelegate];
+		if( pDelegate )
+		{
+			pDelegate->m_nEventCasterSlot = nNumDelegates;
+			m_pDelegates[nNumDelegates] = pDelegate;
+			++nNumDelegates;
+		}
+	}
+
+	m_nNumDelegates = nNumDelegates;
+	m_nNumDetached = 0;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::DoNotifyLocal
+//
+//	PURPOSE:	Call each delegate attached when the notify started.
+//
+// ----------------------------------------------------------------------- //
+void EventCaster::DoNotifyLocal( NotifyParams& notifyParams )
+{
+	++m_nNotifyDepth;
+
+	// The slots may be reallocated by delegates attaching during the
+	// event, so index them each time rather than holding a pointer.
+	uint32 nNumDelegates = m_nNumDelegates;
+	for( uint32 nDelegate = 0; nDelegate < nNumDelegates; ++nDelegate )
+	{
+		DelegateBase* pDelegate = m_pDelegates[nDelegate];
+		if( pDelegate )
+		{
+			pDelegate->OnEvent( notifyParams );
+		}
+	}
+
+	--m_nNotifyDepth;
+
+	if( m_nNumDetached * 2 > m_nNumDelegates )
+	{
+		CompactLocal( );
+	}
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::AttachShared
+//
+//	PURPOSE:	Publish a copy of the list with the delegate added.
+//
+// ----------------------------------------------------------------------- //
+void EventCaster::AttachShared( DelegateBase& delegate )
+{
+	SharedList* pOldList = NULL;
+
+	{
+		CLTAutoCriticalSection cAutoCS( *m_pSharedCS );
+
+		pOldList = m_pSharedList;
+		uint32 nNumDelegates = pOldList ? pOldList->m_nNumDelegates : 0;
+
+		SharedList* pNewList = ( SharedList* )debug_newa( uint8, sizeof( SharedList ) + nNumDelegates * sizeof( DelegateBase* ));
+		pNewList->m_nNumDelegates = nNumDelegates + 1;
+		if( nNumDelegates )
+		{
+			memcpy( pNewList->m_aDelegates, pOldList->m_aDelegates, nNumDelegates * sizeof( DelegateBase* ));
+		}
+		pNewList->m_aDelegates[nNumDelegates] = &delegate;
+
+		LTInterlockedOperations::InterlockedExchangePtr(( void* volatile* )&m_pSharedList, pNewList );
+	}
+
+	// Notifies still using the old list only miss the new delegate, so there is
+	// no need to wait for them.
+	ReleaseSharedList( pOldList, false );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::DetachShared
+//
+//	PURPOSE:	Publish a copy of the list with the delegate removed.
+//
+// ----------------------------------------------------------------------- //
+void EventCaster::DetachShared( DelegateBase& delegate )
+{
+	SharedList* pOldList = NULL;
+
+	{
+		CLTAutoCriticalSection cAutoCS( *m_pSharedCS );
+
+		pOldList = m_pSharedList;
+		if( !pOldList )
+			return;
+
+		uint32 nSlot = 0;
+		for( ; nSlot < pOldList->m_nNumDelegates; ++nSlot )
+		{
+			if( pOldList->m_aDelegates[nSlot] == &delegate )
+				break;
+		}
+
+		if( nSlot == pOldList->m_nNumDelegates )
+			return;
+
+		SharedList* pNewList = NULL;
+		uint32 nNumDelegates = pOldList->m_nNumDelegates - 1;
+		if( nNumDelegates )
+		{
+			pNewList = ( SharedList* )debug_newa( uint8, sizeof( SharedList ) + ( nNumDelegates - 1 ) * sizeof( DelegateBase* ));
+			pNewList->m_nNumDelegates = nNumDelegates;
+			memcpy( pNewList->m_aDelegates, pOldList->m_aDelegates, nSlot * sizeof( DelegateBase* ));
+			memcpy( pNewList->m_aDelegates + nSlot, pOldList->m_aDelegates + nSlot + 1, ( nNumDelegates - nSlot ) * sizeof( DelegateBase* ));
+		}
+
+		LTInterlockedOperations::InterlockedExchangePtr(( void* volatile* )&m_pSharedList, pNewList );
+	}
+
+	// The delegate may be destroyed once this returns, so wait for the notifies
+	// on other threads that may still call it from the old list.
+	ReleaseSharedList( pOldList, true );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::ReleaseSharedList
+//
+//	PURPOSE:	Retire a list that has just been replaced and free the retired
+//				lists that are no longer in use.  Waiting is done outside of
+//				m_pSharedCS so the delegates being waited on can attach and
+//				detach meanwhile.
+//
+// ----------------------------------------------------------------------- //
+void EventCaster::ReleaseSharedList( SharedList* pOldList, bool bWait )
+{
+	if( !pOldList )
+		return;
+
+	// The new list was published with a full barrier, so a notify that marks the
+	// old list after this point sees the new one and lets the old one go.  Only
+	// the notifies that were already using the old list are waited on, however
+	// often the event is signaled meanwhile.  Notifies further up this thread's
+	// stack can't finish until this returns, so they aren't waited on; they skip
+	// delegates detached since their list was replaced.  Notifies don't take
+	// m_pSharedCS while they have a list marked, so this can't wait on a notify
+	// that is waiting for the lock.
+	if( bWait )
+	{
+		while( IsSharedListInUse( pOldList, s_pSharedNotifyThread ))
+		{
+			LTThreadUtils::RelinquishTimeslice( );
+		}
+	}
+
+	CLTAutoCriticalSection cAutoCS( *m_pSharedCS );
+
+	m_lstRetiredSharedLists.push_back( pOldList );
+	FreeRetiredSharedLists( );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::FreeRetiredSharedLists
+//
+//	PURPOSE:	Free the retired lists that no thread is notifying with.
+//
+// ----------------------------------------------------------------------- //
+void EventCaster::FreeRetiredSharedLists( )
+{
+	// Notifies holding the lock don't mark their list.
+	if( m_nLockedSharedNotifies == 0 )
+	{
+		uint32 nNumRetired = 0;
+		for( uint32 nList = 0; nList < m_lstRetiredSharedLists.size( ); ++nList )
+		{
+			SharedList* pList = m_lstRetiredSharedLists[nList];
+			if( IsSharedListInUse( pList, NULL ))
+			{
+				m_lstRetiredSharedLists[nNumRetired] = pList;
+				++nNumRetired;
+			}
+			else
+			{
+				debug_deletea(( uint8* )pList );
+			}
+		}
+
+		m_lstRetiredSharedLists.resize( nNumRetired );
+	}
+
+	m_nNumRetiredSharedLists = ( uint32 )m_lstRetiredSharedLists.size( );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::IsInSharedList
+//
+//	PURPOSE:	Check if the delegate is in a list.
+//
+// ----------------------------------------------------------------------- //
+bool EventCaster::IsInSharedList( SharedList const* pList, DelegateBase* pDelegate )
+{
+	if( !pList )
+		return false;
+
+	for( uint32 nDelegate = 0; nDelegate < pList->m_nNumDelegates; ++nDelegate )
+	{
+		if( pList->m_aDelegates[nDelegate] == pDelegate )
+			return true;
+	}
+
+	return false;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::DoNotifyShared
+//
+//	PURPOSE:	Mark the published list as in use by this thread and call
+//				its delegates without locking.
+//
+// ----------------------------------------------------------------------- //
+void EventCaster::DoNotifyShared( NotifyParams& notifyParams )
+{
+	SharedNotifyThread* pThread = GetSharedNotifyThread( );
+	if( !pThread || pThread->m_nDepth == kMaxSharedNotifyDepth )
+	{
+		// No slot to mark the list with, so keep it from being replaced instead.
+		CLTAutoCriticalSection cAutoCS( *m_pSharedCS );
+
+		++m_nLockedSharedNotifies;
+		NotifySharedList( m_pSharedList, NULL, notifyParams );
+		--m_nLockedSharedNotifies;
+
+		FreeRetiredSharedLists( );
+		return;
+	}
+
+	void* volatile* ppSlots = &pThread->m_aLists[pThread->m_nDepth * 2];
+	++pThread->m_nDepth;
+
+	SharedList* pList = MarkSharedList( &ppSlots[0] );
+	NotifySharedList( pList, &ppSlots[1], notifyParams );
+
+	// Finish with the lists before the slots are seen to be free.
+	LTInterlockedOperations::InterlockedExchangePtr( &ppSlots[1], NULL );
+	LTInterlockedOperations::InterlockedExchangePtr( &ppSlots[0], NULL );
+	--pThread->m_nDepth;
+	if( pThread->m_nDepth == 0 )
+	{
+		ReleaseSharedNotifyThread( pThread );
+	}
+
+	// Free any lists that were kept for this notify.
+	if( m_nNumRetiredSharedLists > 0 )
+	{
+		CLTAutoCriticalSection cAutoCS( *m_pSharedCS );
+		FreeRetiredSharedLists( );
+	}
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::MarkSharedList
+//
+//	PURPOSE:	Mark the published list as in use by this thread and return it.
+//
+// ----------------------------------------------------------------------- //
+EventCaster::SharedList* EventCaster::MarkSharedList( void* volatile* ppSlot )
+{
+	// Mark the list, then make sure it is still the published one.  A list that
+	// was replaced before the mark was visible may already be freed, so try
+	// again with the new one.
+	SharedList* pList = m_pSharedList;
+	for( ;; )
+	{
+		LTInterlockedOperations::InterlockedExchangePtr( ppSlot, pList );
+
+		SharedList* pPublishedList = m_pSharedList;
+		if( pPublishedList == pList )
+			return pList;
+
+		pList = pPublishedList;
+	}
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::NotifySharedList
+//
+//	PURPOSE:	Call each delegate of the list.
+//
+// ----------------------------------------------------------------------- //
+void EventCaster::NotifySharedList( SharedList* pList, void* volatile* ppCheckSlot, NotifyParams& notifyParams )
+{
+	if( !pList )
+		return;
+
+	for( uint32 nDelegate = 0; nDelegate < pList->m_nNumDelegates; ++nDelegate )
+	{
+		// If the list was replaced during this notify, skip the delegates
+		// that have since been detached.  Without a slot to mark the
+		// published list with, the caller holds m_pSharedCS instead.
+		DelegateBase* pDelegate = pList->m_aDelegates[nDelegate];
+		if( pList != m_pSharedList )
+		{
+			SharedList* pPublishedList = ppCheckSlot ? MarkSharedList( ppCheckSlot ) : m_pSharedList;
+			if( !IsInSharedList( pPublishedList, pDelegate ))
+				continue;
+		}
+
+		pDelegate->OnEvent( notifyParams );
+	}
+}
+
+#ifndef _FINAL
+
+// ----------------------------------------------------------------------- //
+//
+//	Benchmark support.  Delegate callbacks need external linkage to be
+//	template arguments, so these aren't static.
+//
+// ----------------------------------------------------------------------- //
+namespace
+{
+	struct BenchmarkObserver
+	{
+		BenchmarkObserver( ) : m_nCalls( 0 ), m_nCallsWhileDetached( 0 ), m_bDetached( false ), m_nWork( 0 ) {}
+
+		uint32			m_nCalls;
+		uint32			m_nCallsWhileDetached;
+		bool volatile	m_bDetached;
+
+		// Busy work done by each call, to give other threads time to detach.
+		uint32			m_nWork;
+	};
+
+	struct BenchmarkSubject
+	{
+		EventCaster*	m_pEvent;
+	};
+
+	void OnBenchmarkEvent( BenchmarkObserver* pObserver, BenchmarkSubject* pSubject, EventCaster::NotifyParams& notifyParams )
+	{
+		LTInterlockedOperations::InterlockedIncrement( &pObserver->m_nCalls );
+
+		uint32 volatile nWork = 0;
+		while( nWork < pObserver->m_nWork )
+		{
+			++nWork;
+		}
+
+		if( pObserver->m_bDetached )
+		{
+			LTInterlockedOperations::InterlockedIncrement( &pObserver->m_nCallsWhileDetached );
+		}
+	}
+
+	typedef Delegate< BenchmarkObserver, BenchmarkSubject, OnBenchmarkEvent > TBenchmarkDelegate;
+
+	// Times signaling an event with three delegates.
+	double TimeNotifies( EventCaster& event, BenchmarkObserver& observer, uint32 nIterations )
+	{
+		BenchmarkSubject subject;
+		subject.m_pEvent = &event;
+
+		TBenchmarkDelegate aDelegates[3];
+		for( uint32 nDelegate = 0; nDelegate < LTARRAYSIZE( aDelegates ); ++nDelegate )
+		{
+			aDelegates[nDelegate].Attach( &observer, &subject, event );
+		}
+
+		TLTPrecisionTime StartTime = LTTimeUtils::GetPrecisionTime( );
+		for( uint32 nIteration = 0; nIteration < nIterations; ++nIteration )
+		{
+			event.DoNotify( );
+		}
+		return LTTimeUtils::GetPrecisionTimeIntervalMS( StartTime, LTTimeUtils::GetPrecisionTime( ));
+	}
+
+	// Times the old way of signaling, which copied the delegates first.
+	double TimeCopyingNotifies( BenchmarkObserver& observer, uint32 nIterations )
+	{
+		EventCaster event;
+		BenchmarkSubject subject;
+		subject.m_pEvent = &event;
+
+		TBenchmarkDelegate aDelegates[3];
+		std::vector<DelegateBase*> lstDelegates;
+		for( uint32 nDelegate = 0; nDelegate < LTARRAYSIZE( aDelegates ); ++nDelegate )
+		{
+			lstDelegates.push_back( &aDelegates[nDelegate] );
+			aDelegates[nDelegate].Attach( &observer, &subject, event );
+		}
+
+		EventCaster::NotifyParams cParams( event );
+		TLTPrecisionTime StartTime = LTTimeUtils::GetPrecisionTime( );
+		for( uint32 nIteration = 0; nIteration < nIterations; ++nIteration )
+		{
+			std::vector<DelegateBase*> lstCopy = lstDelegates;
+			for( uint32 nDelegate = 0; nDelegate < lstCopy.size( ); ++nDelegate )
+			{
+				lstCopy[nDelegate]->OnEvent( cParams );
+			}
+		}
+		return LTTimeUtils::GetPrecisionTimeIntervalMS( StartTime, LTTimeUtils::GetPrecisionTime( ));
+	}
+
+	// Signals a thread safe event until told to stop.
+	struct BenchmarkNotifier
+	{
+		EventCaster*	m_pEvent;
+		uint32 volatile	m_bStop;
+		uint32			m_nNotifies;
+
+		static uint32 ThreadFunction( void* pArgument )
+		{
+			BenchmarkNotifier* pNotifier = ( BenchmarkNotifier* )pArgument;
+			while( !pNotifier->m_bStop )
+			{
+				pNotifier->m_pEvent->DoNotify( );
+				++pNotifier->m_nNotifies;
+			}
+			return 0;
+		}
+	};
+
+	// Signals a thread safe event once and exits, like the save writer.
+	uint32 NotifyOnceThreadFunction( void* pArgument )
+	{
+		(( EventCaster* )pArgument )->DoNotify( );
+		return 0;
+	}
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	EventCaster::RunBenchmark
+//
+//	PURPOSE:	Check and time signaling events.
+//
+// ----------------------------------------------------------------------- //
+void EventCaster::RunBenchmark( uint32 nIterations )
+{
+	if( nIterations == 0 )
+	{
+		nIterations = 100000;
+	}
+
+	uint32 nFailures = 0;
+
+	// Signaling with each kind of event calls every delegate once per signal.
+	BenchmarkObserver localObserver;
+	BenchmarkObserver sharedObserver;
+	BenchmarkObserver copyObserver;
+	double fLocalMS = 0.0;
+	double fSharedMS = 0.0;
+	{
+		EventCaster localEvent;
+		fLocalMS = TimeNotifies( localEvent, localObserver, nIterations );
+	}
+	{
+		EventCaster sharedEvent( true );
+		fSharedMS = TimeNotifies( sharedEvent, sharedObserver, nIterations );
+	}
+	double fCopyMS = TimeCopyingNotifies( copyObserver, nIterations );
+
+	if( localObserver.m_nCalls != nIterations * 3 || sharedObserver.m_nCalls != nIterations * 3 )
+	{
+		++nFailures;
+	}
+
+	DebugCPrint( 0, "EventCasterBenchmark: %u signals of 3 delegates: %.3f ms single threaded, %.3f ms thread safe, %.3f ms copying the delegates", 
+		nIterations, fLocalMS, fSharedMS, fCopyMS );
+
+	// Attach and detach a delegate while other threads signal the event.  It
+	// must never be called once Detach has returned, and Detach must not wait
+	// long however often the others signal.  The delegate attached first works
+	// a little, so the others often call the churning delegate after Detach
+	// has replaced the list.
+	EventCaster sharedEvent( true );
+	BenchmarkSubject subject;
+	subject.m_pEvent = &sharedEvent;
+
+	BenchmarkObserver steadyObserver;
+	steadyObserver.m_nWork = 1000;
+	TBenchmarkDelegate steadyDelegate;
+	steadyDelegate.Attach( &steadyObserver, &subject, sharedEvent );
+
+	enum { kNumNotifiers = 4 };
+	BenchmarkNotifier aNotifiers[kNumNotifiers];
+	CLTThread aThreads[kNumNotifiers];
+	for( uint32 nThread = 0; nThread < kNumNotifiers; ++nThread )
+	{
+		aNotifiers[nThread].m_pEvent = &sharedEvent;
+		aNotifiers[nThread].m_bStop = false;
+		aNotifiers[nThread].m_nNotifies = 0;
+		aThreads[nThread].Create( BenchmarkNotifier::ThreadFunction, &aNotifiers[nThread] );
+	}
+
+	uint32 nChurns = LTMAX( nIterations / 1000, ( uint32 )100 );
+	uint32 nCallsWhileDetached = 0;
+	double fMaxDetachMS = 0.0;
+	TLTPrecisionTime StartTime = LTTimeUtils::GetPrecisionTime( );
+	for( uint32 nChurn = 0; nChurn < nChurns; ++nChurn )
+	{
+		BenchmarkObserver churnObserver;
+		TBenchmarkDelegate churnDelegate;
+		churnDelegate.Attach( &churnObserver, &subject, sharedEvent );
+
+		// Detach while the notifiers are using the list with the delegate in it.
+		while( churnObserver.m_nCalls == 0 )
+		{
+			LTThreadUtils::RelinquishTimeslice( );
+		}
+
+		TLTPrecisionTime DetachTime = LTTimeUtils::GetPrecisionTime( );
+		churnDelegate.Detach( );
+		fMaxDetachMS = LTMAX( fMaxDetachMS, LTTimeUtils::GetPrecisionTimeIntervalMS( DetachTime, LTTimeUtils::GetPrecisionTime( )));
+		churnObserver.m_bDetached = true;
+
+		// Give the notifiers a chance to call the detached delegate.
+		LTThreadUtils::RelinquishTimeslice( );
+		nCallsWhileDetached += churnObserver.m_nCallsWhileDetached;
+	}
+	double fChurnMS = LTTimeUtils::GetPrecisionTimeIntervalMS( StartTime, LTTimeUtils::GetPrecisionTime( ));
+
+	uint32 nNotifies = 0;
+	for( uint32 nThread = 0; nThread < kNumNotifiers; ++nThread )
+	{
+		aNotifiers[nThread].m_bStop = true;
+		aThreads[nThread].WaitForExit( );
+		nNotifies += aNotifiers[nThread].m_nNotifies;
+	}
+
+	if( nCallsWhileDetached != 0 || steadyObserver.m_nCalls != nNotifies )
+	{
+		++nFailures;
+	}
+
+	DebugCPrint( 0, "EventCasterBenchmark: %u attach/detach pairs in %.3f ms against %u signals on %u threads, longest detach %.3f ms, %u calls after detach", 
+		nChurns, fChurnMS, nNotifies, kNumNotifiers, fMaxDetachMS, nCallsWhileDetached );
+
+	// Signal from many threads that each signal once.  They must give their
+	// records back, or the later ones run out and fall back to locking.
+	enum { kNumOneShotThreads = kMaxSharedNotifyThreads * 2 };
+	BenchmarkObserver oneShotObserver;
+	{
+		TBenchmarkDelegate oneShotDelegate;
+		oneShotDelegate.Attach( &oneShotObserver, &subject, sharedEvent );
+
+		StartTime = LTTimeUtils::GetPrecisionTime( );
+		for( uint32 nThread = 0; nThread < kNumOneShotThreads; ++nThread )
+		{
+			CLTThread oneShotThread;
+			oneShotThread.Create( NotifyOnceThreadFunction, &sharedEvent );
+			oneShotThread.WaitForExit( );
+		}
+	}
+	double fOneShotMS = LTTimeUtils::GetPrecisionTimeIntervalMS( StartTime, LTTimeUtils::GetPrecisionTime( ));
+
+	if( oneShotObserver.m_nCalls != kNumOneShotThreads || s_nNumSharedNotifyThreads >= kMaxSharedNotifyThreads )
+	{
+		++nFailures;
+	}
+
+	DebugCPrint( 0, "EventCasterBenchmark: %u threads signaling once in %.3f ms, %u of %u records used", 
+		( uint32 )kNumOneShotThreads, fOneShotMS, LTMIN( s_nNumSharedNotifyThreads, ( uint32 )kMaxSharedNotifyThreads ), ( uint32 )kMaxSharedNotifyThreads );
+	DebugCPrint( 0, "EventCasterBenchmark: %u failures - %s", 
+		nFailures, ( nFailures == 0 ) ? "PASSED" : "FAILED" );
+}
+
+#endif // _FINAL
@@ -16,8 +16,8 @@
 #define __EVENTCASTER_H__
 
 #include "stdafx.h"
+#include "ltcriticalsection.h"
 #include <vector>
-#include <algorithm>
 
 class DelegateBase;
 
@@ -31,24 +31,29 @@ class DelegateBase;
 //     MyEvent.DoNotify();
 // 3.  Observers can attach/detach delegates by calling <MyEvent>.Attach() or <MyEvent>.Detach().
 // 4.  Subject can signal event by calling <MyEvent>.DoNotify().
+//
+// Delegates may be attached and detached while the event is being signaled.  A delegate
+// detached during the event is not called after it is detached, and a delegate attached
+// during the event is first called on the next signal.
+//
+// Events declared with DECLARE_THREADSAFE_EVENT may also be signaled from worker threads.
+// The delegate list is then copied on every attach and detach and replaced as a whole, so
+// signaling never takes a lock.  Each thread marks the list it is signaling with, and a
+// replaced list is freed once no thread has it marked.  Detach waits for the signals that
+// were already using the replaced list, but not for signals started after it, so a delegate
+// is never called once Detach returns.  Delegates may attach and detach from within their
+// own event, but not from within the same event on two threads at once, since each would
+// wait for the other to finish.
 class EventCaster
 {
 public:
+	explicit EventCaster( bool bThreadSafe = false );
 	virtual ~EventCaster( );
 
 	// Observer calls to attach a delegate.
-	virtual void Attach( DelegateBase& delegate )
-	{
-		m_lstDelegates.push_back( &delegate );
-	}
+	virtual void Attach( DelegateBase& delegate );
 	// Observer calls to detach a delegate.
-	virtual void Detach( DelegateBase& delegate )
-	{
-		DelegateList::iterator iter = std::find( m_lstDelegates.begin(), m_lstDelegates.end( ), &delegate );
-		if( iter == m_lstDelegates.end( ))
-			return;
-		m_lstDelegates.erase( iter );
-	}
+	virtual void Detach( DelegateBase& delegate );
 
 	// Default parameters to send with notification event.  Subjects can derive from this
 	// to send specialized data.
@@ -71,20 +76,105 @@ public:
 	// Subject calls to signal event with specialized notifyparams.
 	virtual void DoNotify( NotifyParams& notifyParams );
 
+	bool IsThreadSafe( ) const { return ( m_pSharedCS != NULL ); }
+
+#ifndef _FINAL
+	// Checks and times signaling single threaded and thread safe events, including
+	// detaching while other threads signal.  Prints PASSED or FAILED.
+	static void RunBenchmark( uint32 nIterations );
+#endif // _FINAL
+
 private:
 
-	// List of delegates attached.
-	typedef std::vector< DelegateBase* > DelegateList;
-	DelegateList m_lstDelegates;
+	// Not copyable, delegates refer back to the event they are attached to.
+	EventCaster( EventCaster const& );
+	EventCaster& operator=( EventCaster const& );
+
+	// Single threaded attach, detach and notify.
+	void AttachLocal( DelegateBase& delegate );
+	void DetachLocal( DelegateBase& delegate );
+	void DoNotifyLocal( NotifyParams& notifyParams );
+
+	// Removes the slots of detached delegates once no notify is using them.
+	void CompactLocal( );
+
+	// Thread safe attach, detach and notify.
+	void AttachShared( DelegateBase& delegate );
+	void DetachShared( DelegateBase& delegate );
+	void DoNotifyShared( NotifyParams& notifyParams );
+
+	// Marks the published list as in use in one of this thread's slots and returns it.
+	struct SharedList;
+	SharedList* MarkSharedList( void* volatile* ppSlot );
+
+	// Calls the delegates of a shared list, skipping those detached since it was replaced.
+	// ppCheckSlot marks the published list while looking delegates up in it, or is NULL
+	// if the caller holds m_pSharedCS.
+	void NotifySharedList( SharedList* pList, void* volatile* ppCheckSlot, NotifyParams& notifyParams );
+
+	// Retires the replaced list, first waiting for other threads to stop notifying with
+	// it if bWait is set, and frees the retired lists no thread is notifying with.
+	void ReleaseSharedList( SharedList* pOldList, bool bWait );
+
+	// Frees the retired lists no thread is notifying with.  Called within m_pSharedCS.
+	void FreeRetiredSharedLists( );
+
+	// Returns true if the delegate is in the list.
+	static bool IsInSharedList( SharedList const* pList, DelegateBase* pDelegate );
+
+private:
+
+	// Number of delegates stored in the event before using the heap.  Most events
+	// only have a few observers.
+	enum { kNumLocalDelegates = 4 };
+
+	// Delegates attached to a single threaded event, indexed by the delegate's slot.
+	// Detached delegates leave a NULL slot until the slots are compacted.
+	DelegateBase*	m_aLocalDelegates[kNumLocalDelegates];
+	DelegateBase**	m_pDelegates;
+	uint32			m_nNumDelegates;
+	uint32			m_nMaxDelegates;
+	uint32			m_nNumDetached;
+
+	// Depth of DoNotify calls on a single threaded event.
+	uint32			m_nNotifyDepth;
+
+	// Delegate list of a thread safe event.  Lists are never changed once published.
+	struct SharedList
+	{
+		uint32			m_nNumDelegates;
+		DelegateBase*	m_aDelegates[1];
+	};
+	SharedList* volatile	m_pSharedList;
+
+	// Replaced lists that some thread may still be notifying with.
+	typedef std::vector<SharedList*, LTAllocator<SharedList*, LT_MEM_TYPE_GAMECODE> > TSharedListArray;
+	TSharedListArray		m_lstRetiredSharedLists;
+	uint32 volatile			m_nNumRetiredSharedLists;
+
+	// Notifies holding m_pSharedCS because their thread had no free slot to mark
+	// its list with.  Lists are not freed while there are any.
+	uint32					m_nLockedSharedNotifies;
+
+	// Serializes attach and detach on a thread safe event.  NULL for single threaded events.
+	CLTCriticalSection*		m_pSharedCS;
 };
 
 // Base class delegate that EventCaster works with.  Observers need to use the Delegate version.
 class DelegateBase
 {
 public:
+	DelegateBase( ) : m_nEventCasterSlot( 0 ) {}
 	virtual ~DelegateBase( ) {}
 	virtual void OnEvent( EventCaster::NotifyParams& notifyParams ) = 0;
 	virtual void OnDestroy( EventCaster& event ) = 0;
+
+private:
+
+	friend class EventCaster;
+
+	// Slot of the delegate in a single threaded event it is attached to.
+	uint32 m_nEventCasterSlot;
 };
 
 // Delegate
@@ -163,31 +253,6 @@ private:
 	EventCaster* m_pEventCaster;
 };
 
-inline EventCaster::~EventCaster( ) 
-{
-	// Make a copy and use the copy to send the events.  This prevents problems when delegates
-	// get removed during the event call.
-	DelegateList lstDelegates;
-	lstDelegates = m_lstDelegates;
-	for( DelegateList::iterator iter = lstDelegates.begin( ); iter != lstDelegates.end( ); iter++ )
-	{
-		(*iter)->OnDestroy( *this );
-	}
-}
-
-inline void EventCaster::DoNotify( NotifyParams& notifyParams )
-{
-	// Make a copy and use the copy to send the events.  This prevents problems when delegates
-	// get removed during the event call.
-	DelegateList lstDelegates;
-	lstDelegates = m_lstDelegates;
-	for( DelegateList::iterator iter = lstDelegates.begin( ); iter != lstDelegates.end( ); iter++ )
-	{
-		(*iter)->OnEvent( notifyParams );
-	}
-}
-
-
 // Add a DECLARE_EVENT for each event your class supports.  When
 // you want to signal the font, call <MyEvent>.Notify().
 #define DECLARE_EVENT( EventName ) \
@@ -195,6 +260,12 @@ inline void EventCaster::DoNotify( NotifyParams& notifyParams )
 		class EventName##EventCaster : public EventCaster { }; \
 		EventName##EventCaster EventName;
 
+// Use DECLARE_THREADSAFE_EVENT instead for events that are signaled from worker threads.
+#define DECLARE_THREADSAFE_EVENT( EventName ) \
+	public: \
+		class EventName##EventCaster : public EventCaster { public: EventName##EventCaster( ) : EventCaster( true ) { } }; \
+		EventName##EventCaster EventName;
+
 // Example usage:
 /*
 class ClockTimer
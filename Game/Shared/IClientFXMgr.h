@@ -20,6 +20,11 @@ struct CLIENTFX_CREATESTRUCT;
 //the number of motors we support for the controller
 #define NUM_CLIENTFX_CONTROLLER_MOTORS	2
 
+//a handle to a named effect group. Unlike the name this can be looked up without any string
+//comparisons, and it remains valid when the effect files are unloaded and reloaded.
+typedef uint32 HFXGROUP;
+#define INVALID_FX_GROUP		((HFXGROUP)-1)
+
 //------------------------------------------------------------
 // IClientFXOverlay
 // This interface must be implemented by any effects that want to subscribe to the overlay
@@ -74,6 +79,27 @@ public:
 										LTVector2& vOutFov) = 0;
 };
 
+//------------------------------------------------------------
+// IClientFXParallelUpdate
+// This interface must be implemented by any effects that want to move part of their update
+// onto the worker threads. Work queued with the effect manager is run after every effect has
+// received its update for the frame. ParallelUpdate can be called from any thread while other
+// queued work is running, so it may only touch data owned by the effect and must not call into
+// the engine or create effects. CommitParallelUpdate is then called from the main thread in the
+// order that the work was queued, and is where any results should be handed to the engine.
+class IClientFXParallelUpdate
+{
+public:
+	IClientFXParallelUpdate()	{}
+	virtual ~IClientFXParallelUpdate()	{}
+
+	//called to perform the queued work, potentially on a worker thread
+	virtual void	ParallelUpdate() = 0;
+
+	//called on the main thread once all queued work has completed
+	virtual void	CommitParallelUpdate() = 0;
+};
+
 class IClientFXMgr
 {
 public:
@@ -96,6 +122,11 @@ public:
 	//whether or not that effect could be created
 	virtual bool	CreateEffect(const CLIENTFX_CREATESTRUCT& cs, bool bStartInst) = 0;
 
+	//called to resolve an effect name to a handle that can be placed in the creation structure
+	//to avoid looking the effect up by name each time it is created. This should be done once
+	//and the handle kept. Returns INVALID_FX_GROUP for an empty name.
+	virtual HFXGROUP	ResolveEffect(const char* pszEffectName) = 0;
+
 	//---------------------------
 	// System Subscription
 	//
@@ -113,6 +144,18 @@ public:
 
 	//called to subscribe to the camera functionality which allows for modifying the camera positioning
 	virtual void	SubscribeCamera(LTLink<IClientFXCamera*>& Link) = 0;
+
+	//---------------------------
+	// Parallel Update
+
+	//called during an effect update to queue work to be run on the worker threads. This will
+	//return false if the work could not be queued, in which case the effect must perform the
+	//work itself. Otherwise nQueueIndex is filled in with the index needed to cancel the work
+	virtual bool	QueueParallelUpdate(IClientFXParallelUpdate* pUpdate, uint32& nQueueIndex) = 0;
+
+	//called to remove work that was queued but has not yet been run, such as when the effect
+	//is being destroyed or needs the results immediately
+	virtual void	CancelParallelUpdate(IClientFXParallelUpdate* pUpdate, uint32 nQueueIndex) = 0;
 };
 
 #endif
@@ -45,6 +45,8 @@ public:
 		bool operator!=(const CToken &cOther) const { return (m_nHashKey != cOther.m_nHashKey) || (LTStrICmp(m_pValue, cOther.m_pValue) != 0); }
 		const char *c_str() const { return m_pValue; }
 		operator const char *() const { return c_str(); }
+		// Case insensitive hash of the string, equal for tokens that compare equal
+		uint32 GetHashKey() const { return m_nHashKey; }
 	private:
 		void CalcHashKey();
 
@@ -73,21 +73,20 @@ void CollisionStatsLevel( uint32& nLevel, bool& bServer, HRECORD& hCollisionProp
 //						by the matching the collisionpropertythem to the
 //						WhenHitBy property of the structs.
 // Return type     : static uint32 - Index into Responses struct.
-// Argument        : HATTRIBUTE hResponses - Responses struct.
-// Argument        : HRECORD hCollisionPropertyUs - Our collisionproperty record.
+// Argument        : PhysicsCollisionMgr::CompiledCollisionProperty const& compiledUs - Our compiled collisionproperty record.
 // Argument        : HRECORD hCollisionPropertyThem - The other collisionproperty record.
 //////////////////////////////////////////////////////////////////////////
-static uint32 FindResponsesIndex( HATTRIBUTE hResponses, HRECORD hCollisionPropertyUs, HRECORD hCollisionPropertyThem )
+static uint32 FindResponsesIndex( PhysicsCollisionMgr::CompiledCollisionProperty const& compiledUs, HRECORD hCollisionPropertyThem )
 {
 	// Iterate through all the responses structs and look at the WhenHitBy attribute.  If it
 	// matches the them input, then use that specific responses struct.  Otherwise, use the responses
 	// struct that is set to NULL.  If that doesn't exist, then there's an error.
 	uint32 nResponsesIndex = (uint32)-1;
-	uint32 nNumResponses = g_pLTDatabase->GetNumValues( hResponses );
+	uint32 nNumResponses = ( uint32 )compiledUs.m_lstWhenHitBy.size( );
 	for( uint32 i = 0; i < nNumResponses; i++ )
 	{
 		// Get the whenhitby recordlink.
-		HRECORD hWhenHitBy = DATABASE_CATEGORY( CollisionProperty ).GETSTRUCTATTRIB( Responses, hResponses, i, WhenHitBy );
+		HRECORD hWhenHitBy = compiledUs.m_lstWhenHitBy[i];
 
 		// If not set, then this is the default response to use.  
 		if( !hWhenHitBy )
@@ -339,13 +338,15 @@ bool CollisionResponse::Init( PhysicsCollisionMgr* pPhysicsCollisionMgr, Collisi
 	}
 
 	// Get our responses struct based on who we hit.
-	m_hResponses = g_pLTDatabase->GetAttributeByIndex( m_hCollisionProperty, pPhysicsCollisionMgr->GetResponsesAttributeIndex( ));
+	PhysicsCollisionMgr::CompiledCollisionProperty const* pCompiledUs = 
+		pPhysicsCollisionMgr->GetCompiledCollisionProperty( m_hCollisionProperty );
+	m_hResponses = pCompiledUs ? pCompiledUs->m_hResponses : NULL;
 	if( !m_hResponses )
 	{
 		LTERROR( "Invalid CollisionProperty.  No responses specified." );
 		return false;
 	}
-	m_nResponsesIndex = FindResponsesIndex( m_hResponses, m_hCollisionProperty, hCollisionPropertyThem );
+	m_nResponsesIndex = FindResponsesIndex( *pCompiledUs, hCollisionPropertyThem );
 	if( m_nResponsesIndex == ( uint32 )-1 )
 	{
 		LTERROR( "Invalid CollisionProperty.  No default response specified." );
@@ -353,7 +354,7 @@ bool CollisionResponse::Init( PhysicsCollisionMgr* pPhysicsCollisionMgr, Collisi
 	}
 
 	// Get the default duration of this actor.
-	m_fDuration = DATABASE_CATEGORY( CollisionProperty ).GETRECORDATTRIB( m_hCollisionProperty, Duration );
+	m_fDuration = pCompiledUs->m_fDuration;
 
 #ifndef _FINAL
 	if( nStatsLevel > 0 && 
@@ -670,12 +671,12 @@ bool CollisionPair::HandleCollision( PhysicsCollisionMgr* pPhysicsCollisionMgr,
 	}
 
 	// Get the hardness from the collisions.
-	HATTRIBUTE hHardnessAttribute = g_pLTDatabase->GetAttributeByIndex( 
-		collisionData.hCollisionPropertyA, pPhysicsCollisionMgr->GetHardnessAttributeIndex());
-	float fHardnessA = g_pLTDatabase->GetFloat( hHardnessAttribute, 0, 0.0f );
-	hHardnessAttribute = g_pLTDatabase->GetAttributeByIndex( 
-		collisionData.hCollisionPropertyB, pPhysicsCollisionMgr->GetHardnessAttributeIndex());
-	float fHardnessB = g_pLTDatabase->GetFloat( hHardnessAttribute, 0, 0.0f );
+	PhysicsCollisionMgr::CompiledCollisionProperty const* pCompiledA = 
+		pPhysicsCollisionMgr->GetCompiledCollisionProperty( collisionData.hCollisionPropertyA );
+	float fHardnessA = pCompiledA ? pCompiledA->m_fHardness : 0.0f;
+	PhysicsCollisionMgr::CompiledCollisionProperty const* pCompiledB = 
+		pPhysicsCollisionMgr->GetCompiledCollisionProperty( collisionData.hCollisionPropertyB );
+	float fHardnessB = pCompiledB ? pCompiledB->m_fHardness : 0.0f;
 
 #ifndef _FINAL
 	uint32 nStatsLevel;
@@ -827,6 +828,10 @@ bool PhysicsCollisionMgr::Init( )
 
 	m_fSettleTime = 0.0f;
 
+	// Records are compiled again as they are used.
+	m_mapCompiledCollisionProperties.clear( );
+	ClearImpulseTables( );
+
 	// Cache some indexes to attributes for faster lookup.
 	m_nHardnessAttributeIndex = (uint32)-1;
 	m_nResponsesAttributeIndex = (uint32)-1;
@@ -853,6 +858,9 @@ void PhysicsCollisionMgr::Term( )
 {
 	RemoveAllCollisionPairs();
 
+	m_mapCompiledCollisionProperties.clear( );
+	ClearImpulseTables( );
+
 	m_bEnabled = false;
 }
 
@@ -1128,13 +1136,11 @@ bool PhysicsCollisionMgr::HandleRigidBodyCollision( CollisionData& collisionData
 			return false;
 		}
 
-		// Add it to the active lists.
-		m_lstCollisionPairs.push_back( pCollisionPair );
-
-		// Have to keep list sorted so we can do quick searches.  Most of the time we expect to
-		// have multiple collisions with a pair in rapid succession, so that the balance
-		// between sorting and binary searching should be favorable over no sorting and linear searching.
-		std::sort( m_lstCollisionPairs.begin(), m_lstCollisionPairs.end( ), FindCollisionPairPred( ));
+		// Add it to the active lists.  Have to keep list sorted so we can do quick searches, so
+		// insert it at its sorted position rather than resorting the whole list.
+		CollisionPairList::iterator iterInsert = std::lower_bound( m_lstCollisionPairs.begin( ), 
+			m_lstCollisionPairs.end( ), pCollisionPair, FindCollisionPairPred( ));
+		m_lstCollisionPairs.insert( iterInsert, pCollisionPair );
 	}
 
 	// Tell the pair to handle the collision.
@@ -1151,6 +1157,39 @@ void PhysicsCollisionMgr::DeleteCollisionPair( CollisionPair* pCollisionPair )
 	m_CollisionPairBank.Free( pCollisionPair );
 }
 
+PhysicsCollisionMgr::CompiledCollisionProperty const* PhysicsCollisionMgr::GetCompiledCollisionProperty( HRECORD hCollisionProperty )
+{
+	if( !hCollisionProperty )
+		return NULL;
+
+	// Use the previously compiled record if we have one.
+	CompiledCollisionPropertyMap::iterator iter = m_mapCompiledCollisionProperties.find( hCollisionProperty );
+	if( iter != m_mapCompiledCollisionProperties.end( ))
+		return &iter->second;
+
+	// Read the record from the database.
+	CompiledCollisionProperty& compiled = m_mapCompiledCollisionProperties[hCollisionProperty];
+
+	HATTRIBUTE hHardnessAttribute = g_pLTDatabase->GetAttributeByIndex( hCollisionProperty, m_nHardnessAttributeIndex );
+	compiled.m_fHardness = g_pLTDatabase->GetFloat( hHardnessAttribute, 0, 0.0f );
+
+	compiled.m_hResponses = g_pLTDatabase->GetAttributeByIndex( hCollisionProperty, m_nResponsesAttributeIndex );
+	if( compiled.m_hResponses )
+	{
+		compiled.m_fDuration = DATABASE_CATEGORY( CollisionProperty ).GETRECORDATTRIB( hCollisionProperty, Duration );
+
+		uint32 nNumResponses = g_pLTDatabase->GetNumValues( compiled.m_hResponses );
+		compiled.m_lstWhenHitBy.reserve( nNumResponses );
+		for( uint32 i = 0; i < nNumResponses; i++ )
+		{
+			compiled.m_lstWhenHitBy.push_back( DATABASE_CATEGORY( CollisionProperty ).GETSTRUCTATTRIB( 
+				Responses, compiled.m_hResponses, i, WhenHitBy ));
+		}
+	}
+
+	return &compiled;
+}
+
 CollisionPair* PhysicsCollisionMgr::FindCollisionPair( bool bFromServer, HPHYSICSRIGIDBODY hBodyA, HOBJECT hObjA,
 													  HPHYSICSRIGIDBODY hBodyB, HOBJECT hObjB )
 {
@@ -1176,6 +1215,75 @@ void PhysicsCollisionMgr::Update( )
 	}
 }
 
+// Impulse column of a database table, read once from the database.
+struct CompiledImpulseTable
+{
+	// Impulse of every entry in the table.
+	std::vector< uint32 > m_lstImpulses;
+
+	// Number of entries before the first infinite entry.  Entries
+	// from there on are never matched.
+	uint32 m_nNumSearchable;
+
+	// True if the searchable entries are in ascending order, which
+	// allows them to be binary searched.
+	bool m_bSorted;
+};
+
+// Matches PhysicsCollisionMgr::ImpulseAccessCB.
+typedef uint32 (*CompiledImpulseAccessCB)( HATTRIBUTE hStruct, uint32 nIndex );
+
+// The same database table may be read through different accessors, so tables are
+// keyed by both.
+typedef std::pair< HATTRIBUTE, CompiledImpulseAccessCB > CompiledImpulseTableKey;
+typedef std::map< CompiledImpulseTableKey, CompiledImpulseTable > CompiledImpulseTableMap;
+static CompiledImpulseTableMap s_mapCompiledImpulseTables;
+
+//////////////////////////////////////////////////////////////////////////
+// Function name   : GetCompiledImpulseTable
+// Description     : Gets the compiled impulse column for a database table,
+//						compiling it the first time the table is seen.
+// Return type     : static CompiledImpulseTable const& - Compiled table.
+// Argument        : HATTRIBUTE hStruct - Database table.
+// Argument        : ImpulseAccessCB pImpulseAccessCB - Callback to call for 
+//						getting impulse by index.
+//////////////////////////////////////////////////////////////////////////
+static CompiledImpulseTable const& GetCompiledImpulseTable( HATTRIBUTE hStruct, CompiledImpulseAccessCB pImpulseAccessCB )
+{
+	CompiledImpulseTableKey key( hStruct, pImpulseAccessCB );
+	CompiledImpulseTableMap::iterator iter = s_mapCompiledImpulseTables.find( key );
+	if( iter != s_mapCompiledImpulseTables.end( ))
+		return iter->second;
+
+	CompiledImpulseTable& table = s_mapCompiledImpulseTables[key];
+
+	uint32 nNumStructs = g_pLTDatabase->GetNumValues( hStruct );
+	table.m_lstImpulses.resize( nNumStructs );
+	table.m_nNumSearchable = nNumStructs;
+	table.m_bSorted = true;
+	for( uint32 nIndex = 0; nIndex < nNumStructs; nIndex++ )
+	{
+		uint32 nImpulse = pImpulseAccessCB( hStruct, nIndex );
+		table.m_lstImpulses[nIndex] = nImpulse;
+
+		// If the impulse is negative, that means infinite, so we've reached the end of the searchable entries.
+		if( table.m_nNumSearchable == nNumStructs )
+		{
+			if( nImpulse == ( uint32 )-1 )
+				table.m_nNumSearchable = nIndex;
+			else if( nIndex > 0 && nImpulse < table.m_lstImpulses[nIndex - 1] )
+				table.m_bSorted = false;
+		}
+	}
+
+	return table;
+}
+
+void PhysicsCollisionMgr::ClearImpulseTables( )
+{
+	s_mapCompiledImpulseTables.clear( );
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Function name   : FindImpulseInTable
 // Description     : Function used to lookup an impulse entry in a
@@ -1190,40 +1298,71 @@ void PhysicsCollisionMgr::Update( )
 //////////////////////////////////////////////////////////////////////////
 bool PhysicsCollisionMgr::FindImpulseInTable( float fImpulse, HATTRIBUTE hStruct, ImpulseAccessCB pImpulseAccessCB, 
 											 uint32& nIndexFound, uint32& nImpulseFound )
+{
+	uint32 nNextImpulseFound;
+	return FindImpulseRangeInTable( fImpulse, hStruct, pImpulseAccessCB, nIndexFound, nImpulseFound, nNextImpulseFound );
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Function name   : FindImpulseRangeInTable
+// Description     : Function used to lookup an impulse entry in a
+//						database table, along with the impulse of the
+//						following entry.  Used by responses.
+// Return type     : static bool - true if found entry.
+// Argument        : float fImpulse - Input impulse to lookup.
+// Argument        : HATTRIBUTE hStruct - Database table to look in.
+// Argument        : ImpulseAccessCB pImpulseAccessCB - Callback to call for 
+//						getting impulse by index.
+// Argument        : uint32& nIndexFound - index of impulse match.
+// Argument        : uint32& nImpulseFound - impulse found for nIndexFound.
+// Argument        : uint32& nNextImpulseFound - impulse of the entry after 
+//						nIndexFound, or -1 if there isn't one.
+//////////////////////////////////////////////////////////////////////////
+bool PhysicsCollisionMgr::FindImpulseRangeInTable( float fImpulse, HATTRIBUTE hStruct, ImpulseAccessCB pImpulseAccessCB, 
+												  uint32& nIndexFound, uint32& nImpulseFound, uint32& nNextImpulseFound )
 {
 	nIndexFound = (uint32)-1;
 	nImpulseFound = 0;
+	nNextImpulseFound = (uint32)-1;
 
-	// Get the number of structs.
-	uint32 nNumStructs = g_pLTDatabase->GetNumValues( hStruct );
-	if( nNumStructs == 0 )
+	if( !hStruct )
+		return false;
+
+	CompiledImpulseTable const& table = GetCompiledImpulseTable( hStruct, pImpulseAccessCB );
+	if( table.m_nNumSearchable == 0 )
 		return false;
 
 	// Pre-convert to integer.
 	uint32 nCollisionImpulse = ( uint32 )fImpulse;
 
-	// Find the struct to use based on the impulse.
-	for( uint32 nIndex = 0; nIndex < nNumStructs; nIndex++ )
+	if( table.m_bSorted )
 	{
-		// Get this struct's impulse.
-		uint32 nImpulse = pImpulseAccessCB( hStruct, nIndex );
-
-		// If the impulse is negative, that means infinite, so we've reached the end of the table.
-		if( nImpulse == ( uint32 )-1 )
-			break;
-
-		// Check if this entry is less than our collision impulse.
-		if( nImpulse <= nCollisionImpulse )
+		// Find the last entry that is less than or equal to our collision impulse.
+		std::vector< uint32 >::const_iterator iterFirst = table.m_lstImpulses.begin( );
+		std::vector< uint32 >::const_iterator iterUpper = std::upper_bound( iterFirst, 
+			iterFirst + table.m_nNumSearchable, nCollisionImpulse );
+		if( iterUpper != iterFirst )
 		{
-			// Consider this the best match so far.
-			nIndexFound = nIndex;
-			nImpulseFound = nImpulse;
+			nIndexFound = ( uint32 )( iterUpper - iterFirst ) - 1;
 		}
-		// The impulse entry is greater than the impulse and we
-		// have found a best match, then use the best match.
-		else if( nIndexFound != ( uint32 )-1 )
+	}
+	else
+	{
+		// Entries are out of order, so walk the table the same way the database was walked.
+		for( uint32 nIndex = 0; nIndex < table.m_nNumSearchable; nIndex++ )
 		{
-			break;
+			// Check if this entry is less than our collision impulse.
+			if( table.m_lstImpulses[nIndex] <= nCollisionImpulse )
+			{
+				// Consider this the best match so far.
+				nIndexFound = nIndex;
+			}
+			// The impulse entry is greater than the impulse and we
+			// have found a best match, then use the best match.
+			else if( nIndexFound != ( uint32 )-1 )
+			{
+				break;
+			}
 		}
 	}
 
@@ -1231,6 +1370,12 @@ bool PhysicsCollisionMgr::FindImpulseInTable( float fImpulse, HATTRIBUTE hStruct
 	if( nIndexFound == ( uint32 )-1 )
 		return false;
 
+	nImpulseFound = table.m_lstImpulses[nIndexFound];
+	if( nIndexFound + 1 < table.m_lstImpulses.size( ))
+	{
+		nNextImpulseFound = table.m_lstImpulses[nIndexFound + 1];
+	}
+
 	return true;
 }
 
@@ -1272,22 +1417,15 @@ uint8 PhysicsCollisionMgr::FindSoundVolume( CollisionResponse const& collisionRe
 
 	uint32 nIndexFound;
 	uint32 nImpulseFound;
-	if( !FindImpulseInTable( collisionResponse.GetImpulse( ), hStruct, SoundVolumeImpulseAccessCB, nIndexFound, nImpulseFound ))
+	uint32 nMaxImpulse;
+	if( !FindImpulseRangeInTable( collisionResponse.GetImpulse( ), hStruct, SoundVolumeImpulseAccessCB, nIndexFound, nImpulseFound, nMaxImpulse ))
 		return 100;
 
 	// Get the minimum volume to use.
 	uint32 nMinVolume = DATABASE_CATEGORY( CollisionProperty ).GETSTRUCTATTRIB( SoundVolume, hStruct, nIndexFound, Volume );
 
-	// If there are no more struct entries, then just use the minimum volume.
-	uint32 nNumStructs = g_pLTDatabase->GetNumValues( hStruct );
-	if( nIndexFound + 1 == nNumStructs )
-	{
-		return ( uint8 )LTCLAMP( nMinVolume, 0, 100 );
-	}
-
-	// Get the maximum impulse from the next higher struct entry.
-	uint32 nMaxImpulse = DATABASE_CATEGORY( CollisionProperty ).GETSTRUCTATTRIB( SoundVolume, hStruct, nIndexFound + 1, Impulse );
-	// If it's infinite, then just use the minimum.
+	// If there are no more struct entries, or the next higher struct entry
+	// is infinite, then just use the minimum volume.
 	if( nMaxImpulse == ( uint32 )-1 )
 		return ( uint8 )LTCLAMP( nMinVolume, 0, 100 );
 
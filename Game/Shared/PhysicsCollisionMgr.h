@@ -22,6 +22,8 @@
 #endif
 
 #include "object_bank.h"
+#include <map>
+#include <vector>
 
 //////////////////////////////////////////////////////////////////////////
 //
@@ -330,12 +332,43 @@ public:
 	// Gets the responses attribute index for faster lookups.
 	uint32			GetResponsesAttributeIndex( ) const { return m_nResponsesAttributeIndex; }
 
+	// Copy of the CollisionProperty record data that is read for every collision.
+	struct CompiledCollisionProperty
+	{
+		CompiledCollisionProperty( )
+		{
+			m_hResponses = NULL;
+			m_fHardness = 0.0f;
+			m_fDuration = 1.0f;
+		}
+
+		// Responses struct attribute.
+		HATTRIBUTE				m_hResponses;
+
+		// WhenHitBy record of each entry in the responses struct.
+		std::vector< HRECORD >	m_lstWhenHitBy;
+
+		float					m_fHardness;
+		float					m_fDuration;
+	};
+
+	// Gets the compiled data for a CollisionProperty record.  The data is read
+	// from the database the first time the record is seen.  Returns NULL for a NULL record.
+	CompiledCollisionProperty const* GetCompiledCollisionProperty( HRECORD hCollisionProperty );
+
 protected:
 
 	// Finds an impulse in a gdb CollisionProperty table given a accessor function callback.
 	typedef uint32 (*ImpulseAccessCB)( HATTRIBUTE hStruct, uint32 nIndex );
 	static bool FindImpulseInTable( float fImpulse, HATTRIBUTE hStruct, ImpulseAccessCB pImpulseAccessCB, 
 		uint32& nIndexFound, uint32& nImpulseFound );
+	// Same as FindImpulseInTable, but also gets the impulse of the entry after the one found.  
+	// nNextImpulseFound is infinite (-1) if there is no higher entry.  Used to interpolate between entries.
+	static bool FindImpulseRangeInTable( float fImpulse, HATTRIBUTE hStruct, ImpulseAccessCB pImpulseAccessCB, 
+		uint32& nIndexFound, uint32& nImpulseFound, uint32& nNextImpulseFound );
+
+	// Deletes the compiled impulse tables.
+	static void		ClearImpulseTables( );
 
 	// Finds a sounddb record in the sound gdb CollisionProperty table.
 	static HRECORD	FindSoundDBRecord( CollisionResponse const& collisionResponse );
@@ -368,9 +401,14 @@ private:
 	// Deletes a CollisionPair object.
 	void DeleteCollisionPair( CollisionPair* pCollisionPair );
 
-	// List of active CollisionPair objects.  Kept in sorted order.
+	// List of active CollisionPair objects.  Kept in sorted order.  New pairs
+	// are inserted at their sorted position.
 	CollisionPairList m_lstCollisionPairs;
 
+	// Compiled CollisionProperty records.
+	typedef std::map< HRECORD, CompiledCollisionProperty > CompiledCollisionPropertyMap;
+	CompiledCollisionPropertyMap m_mapCompiledCollisionProperties;
+
 	// Freelist of CollisionPair objects.
 	ObjectBank< CollisionPair, LT_MEM_TYPE_GAMECODE > m_CollisionPairBank;
 
@@ -23,6 +23,15 @@
 #include "ltprofileutils.h"
 #include "sys/win/mpstrconv.h"
 #include "iltfilemgr.h"
+#include "ltfileread.h"
+#include "ltfilewrite.h"
+#include "crc32utils.h"
+#include "lttimeutils.h"
+
+#if defined(PLATFORM_LINUX)
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 // ----------------------------------------------------------------------- //
 //
@@ -89,6 +98,9 @@ bool CSaveLoadMgr::Init( char const* pszProfileName, bool bUseMultiplayerFolders
 
 void CSaveLoadMgr::Term( )
 {
+	// Don't leave a save half written.
+	m_SaveDirWriter.WaitForCompletion( );
+
 	m_sProfileName.clear();
 }
 
@@ -159,6 +171,9 @@ bool CSaveLoadMgr::DeleteSpecificSaveDir( const char *pName )
 {
 	if( !pName ) return false;
 
+	// Make sure nothing is still being written into the profile.
+	m_SaveDirWriter.WaitForCompletion( );
+
 	// Delete the profile save root dir.  This deletes all the files and sub-folders.
 	char szAbsFile[MAX_PATH*2];
 	g_pLTBase->FileMgr()->GetAbsoluteUserFileName( GetProfileSaveDir( pName ), szAbsFile, LTARRAYSIZE( szAbsFile ));
@@ -365,6 +380,8 @@ bool CSaveLoadMgr::ReadSaveINI( const char *pKey, wchar_t* pwszSaveTitle, uint32
 //  ROUTINE:	CSaveLoadMgr::CopyWorkingDir
 //
 //  PURPOSE:	Copy all files in the profile working dir to the destination working dir..
+//				The files are snapshotted immediately and written in the
+//				background, see CSaveDirWriter.
 //
 // ----------------------------------------------------------------------- //
 
@@ -382,16 +399,14 @@ bool CSaveLoadMgr::CopyWorkingDir( const char *pDestDir )
 	char szDest[MAX_PATH*2] = "";
 	LTFileOperations::GetUserDirectory( szDest, LTARRAYSIZE( szDest ) );
 	LTStrCat( szDest, pDestDir, LTARRAYSIZE( szDest ) );
-	LTStrCat( szDest, FILE_PATH_SEPARATOR WORKING_DIR FILE_PATH_SEPARATOR, LTARRAYSIZE( szDest ) );
+	LTStrCat( szDest, FILE_PATH_SEPARATOR WORKING_DIR, LTARRAYSIZE( szDest ) );
 
 	char szSrc[MAX_PATH*2] = "";
 	LTFileOperations::GetUserDirectory( szSrc, LTARRAYSIZE( szSrc ));
 	LTStrCat( szSrc, szRelSrc, LTARRAYSIZE( szSrc ));
 
-	// We don't want to keep old saved levels around...
-	CWinUtil::EmptyDir( szDest );
-	
-	if( !CWinUtil::CopyDir( szSrc, szDest ))
+	// Old saved levels that are no longer in the working dir are removed by the writer.
+	if( !m_SaveDirWriter.Start( szSrc, szDest ))
 		return false;
 	
 	return true;
@@ -424,11 +439,23 @@ bool CSaveLoadMgr::CopyToWorkingDir( const char *pSrcDir )
 	LTFileOperations::GetUserDirectory( szDest, LTARRAYSIZE( szDest ));
 	LTStrCat( szDest, szRelDest, LTARRAYSIZE( szDest ));
 
+	// The source may still be being written by the last save.
+	m_SaveDirWriter.WaitForCompletion( );
+
 	// Clear out the working dir save files...
 	ClearWorkingDir();
 
-	// Copy over the working save files...
-	if( !CWinUtil::CopyDir( szSrc, szDest ))
+	// Copy over the working save files written by CopyWorkingDir.  Saves 
+	// from before CopyWorkingDir used the writer only have their top level files copied.
+	char szSrcWorking[MAX_PATH*2];
+	LTSNPrintF( szSrcWorking, LTARRAYSIZE( szSrcWorking ), "%s" FILE_PATH_SEPARATOR WORKING_DIR, szSrc );
+	CSaveDirWriter::RecoverDir( szSrcWorking );
+	if( CWinUtil::DirExist( szSrcWorking ))
+	{
+		if( !CSaveDirWriter::ReadDir( szSrcWorking, szDest ))
+			return false;
+	}
+	else if( !CWinUtil::CopyDir( szSrc, szDest ))
 		return false;
 
 	return true;
@@ -445,6 +472,9 @@ bool CSaveLoadMgr::CopyToWorkingDir( const char *pSrcDir )
 
 bool CSaveLoadMgr::ClearWorkingDir( )
 {
+	// Don't pull the files out from under a save in progress.
+	m_SaveDirWriter.WaitForCompletion( );
+
 	// Clear out the working dir save files...
 	char szAbsFile[MAX_PATH*2];
 	g_pLTBase->FileMgr()->GetAbsoluteUserFileName( GetSaveWorkingDir( GetProfileName() ), szAbsFile, LTARRAYSIZE( szAbsFile ));
@@ -569,3 +599,828 @@ bool CSaveLoadMgr::CanContinueGame( )
 
 	return true;
 }
+
+
+// Identifies the header at the start of each file in a save directory.
+#define SAVEDIR_FILE_FOURCC		LTMakeFourCC('S', 'V', 'D', 'F')
+
+// Suffixes of the directories used while a save directory is being replaced.
+#define SAVEDIR_STAGE_SUFFIX	".new"
+#define SAVEDIR_OLD_SUFFIX		".old"
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	RenameSavePath
+//
+//  PURPOSE:	Renames a file or directory.  pszDestPath must not exist.
+//
+// ----------------------------------------------------------------------- //
+
+static bool RenameSavePath( char const* pszSrcPath, char const* pszDestPath )
+{
+#if defined(PLATFORM_LINUX)
+	return ( rename( pszSrcPath, pszDestPath ) == 0 );
+#else
+	return ( MoveFileExA( pszSrcPath, pszDestPath, 0 ) != FALSE );
+#endif
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	LinkSaveFile
+//
+//  PURPOSE:	Makes pszNewFile another name for pszExistingFile.
+//
+// ----------------------------------------------------------------------- //
+
+static bool LinkSaveFile( char const* pszExistingFile, char const* pszNewFile )
+{
+#if defined(PLATFORM_LINUX)
+	return ( link( pszExistingFile, pszNewFile ) == 0 );
+#else
+	return ( CreateHardLinkA( pszNewFile, pszExistingFile, NULL ) != FALSE );
+#endif
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CreateSaveDir
+//
+//  PURPOSE:	Creates a single directory.  Unlike CWinUtil::CreateDir this
+//				is safe to call from the save thread.
+//
+// ----------------------------------------------------------------------- //
+
+static bool CreateSaveDir( char const* pszDir )
+{
+#if defined(PLATFORM_LINUX)
+	return ( mkdir( pszDir, 0777 ) == 0 );
+#else
+	return ( CreateDirectoryA( pszDir, NULL ) != FALSE );
+#endif
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CSaveDirWriter::CSaveDirWriter
+//
+//  PURPOSE:	Constructor...
+//
+// ----------------------------------------------------------------------- //
+
+CSaveDirWriter::CSaveDirWriter( )
+{
+	m_bResult = true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CSaveDirWriter::~CSaveDirWriter
+//
+//  PURPOSE:	Destructor...
+//
+// ----------------------------------------------------------------------- //
+
+CSaveDirWriter::~CSaveDirWriter( )
+{
+	WaitForCompletion( );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CSaveDirWriter::Start
+//
+//  PURPOSE:	Start writing the source dir to the destination...
+//
+// ----------------------------------------------------------------------- //
+
+bool CSaveDirWriter::Start( char const* pszSrcDir, char const* pszDestDir )
+{
+	if( !pszSrcDir || !pszDestDir ) return false;
+
+	// Only one copy at a time.
+	WaitForCompletion( );
+
+	if( !CWinUtil::DirExist( pszSrcDir ))
+		return false;
+
+	// Make sure the folders above the destination exist, since the thread only creates a single folder.
+	if( !CWinUtil::DirExist( pszDestDir ) && !CWinUtil::CreateDir( pszDestDir ))
+		return false;
+
+	m_sSrcDir = pszSrcDir;
+	m_sDestDir = pszDestDir;
+	m_bResult = true;
+
+	// Clean up after an earlier copy that didn't finish, so the old files can be compared.
+	RecoverDir( pszDestDir );
+
+	bool bRead = ReadSourceFiles( );
+
+	// Don't hold on to the largest file between saves.
+	std::vector<uint8>( ).swap( m_aSourceData );
+
+	if( !bRead )
+	{
+		m_aFiles.clear( );
+		return false;
+	}
+
+	m_Thread.Create( ThreadFunction, this );
+
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CSaveDirWriter::WaitForCompletion
+//
+//  PURPOSE:	Wait for the copy in progress to finish...
+//
+// ----------------------------------------------------------------------- //
+
+bool CSaveDirWriter::WaitForCompletion( )
+{
+	if( !m_Thread.IsCreated( ))
+		return m_bResult;
+
+	m_Thread.WaitForExit( );
+
+	if( !m_bResult )
+		DebugCPrint( 0, "CSaveDirWriter: Failed to write save files to '%s'", m_sDestDir.c_str( ));
+
+	m_aFiles.clear( );
+
+	return m_bResult;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CSaveDirWriter::ThreadFunction
+//
+//  PURPOSE:	Background thread entry point...
+//
+// ----------------------------------------------------------------------- //
+
+uint32 CSaveDirWriter::ThreadFunction( void* pArgument )
+{
+	CSaveDirWriter* pWriter = ( CSaveDirWriter* )pArgument;
+	pWriter->m_bResult = pWriter->WriteFiles( );
+
+	FinishedNotifyParams cNotifyParams( pWriter->Finished, pWriter->m_bResult );
+	pWriter->Finished.DoNotify( cNotifyParams );
+
+	return 0;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CSaveDirWriter::ReadSourceFiles
+//
+//  PURPOSE:	Read every file in the source dir.  Runs on the calling thread.
+//
+// ----------------------------------------------------------------------- //
+
+bool CSaveDirWriter::ReadSourceFiles( )
+{
+	m_aFiles.clear( );
+
+	char szFiles[MAX_PATH*2];
+	LTSNPrintF( szFiles, LTARRAYSIZE( szFiles ), "%s" FILE_PATH_SEPARATOR "*", m_sSrcDir.c_str( ));
+
+	bool bRead = true;
+	LTFINDFILEINFO file;
+	LTFINDFILEHANDLE hFile;
+	if( LTFileOperations::FindFirst( szFiles, hFile, &file ))
+	{
+		do
+		{
+			if( !file.bIsSubdir && !ReadSourceFile( file.name ))
+			{
+				bRead = false;
+				break;
+			}
+		}
+		while( LTFileOperations::FindNext( hFile, &file ));
+
+		LTFileOperations::FindClose( hFile );
+	}
+
+	return bRead;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CSaveDirWriter::ReadSourceFile
+//
+//  PURPOSE:	Read a single source file, and compress it unless the old 
+//				destination dir already holds the same data.
+//
+// ----------------------------------------------------------------------- //
+
+bool CSaveDirWriter::ReadSourceFile( char const* pszName )
+{
+	char szSrcFile[MAX_PATH*2];
+	char szDestFile[MAX_PATH*2];
+	LTSNPrintF( szSrcFile, LTARRAYSIZE( szSrcFile ), "%s" FILE_PATH_SEPARATOR "%s", m_sSrcDir.c_str( ), pszName );
+	LTSNPrintF( szDestFile, LTARRAYSIZE( szDestFile ), "%s" FILE_PATH_SEPARATOR "%s", m_sDestDir.c_str( ), pszName );
+
+	if( !ReadWholeFile( szSrcFile, m_aSourceData ))
+		return false;
+
+	m_aFiles.push_back( SFile( ));
+	SFile& File = m_aFiles.back( );
+	File.m_sName = pszName;
+	File.m_bUnchanged = false;
+
+	SFileHeader& Header = File.m_Header;
+	Header.m_nFourCC = SAVEDIR_FILE_FOURCC;
+	Header.m_nCompression = eCompression_None;
+	Header.m_nSize = ( uint32 )m_aSourceData.size( );
+	Header.m_nCRC = m_aSourceData.empty( ) ? 0 : CRC32Utils::CalcDataCRC( &m_aSourceData[0], Header.m_nSize );
+
+	// Reuse the old file if it holds the same data.
+	CLTFileRead cDestRead;
+	SFileHeader DestHeader;
+	if( cDestRead.Open( szDestFile ) && cDestRead.Read( &DestHeader, sizeof( DestHeader )))
+	{
+		cDestRead.Close( );
+		if( DestHeader.m_nFourCC == SAVEDIR_FILE_FOURCC && 
+			DestHeader.m_nSize == Header.m_nSize && 
+			DestHeader.m_nCRC == Header.m_nCRC )
+		{
+			File.m_bUnchanged = true;
+			return true;
+		}
+	}
+
+	// Compress it if that makes it smaller.
+	uint32 nDataSize = Header.m_nSize;
+	uint32 nMaxCompressedSize = 0;
+	if( nDataSize != 0 && g_pLTBase->GetCompressedBufferMaxSize( nDataSize, nMaxCompressedSize ) == LT_OK && nMaxCompressedSize != 0 )
+	{
+		File.m_aData.resize( nMaxCompressedSize );
+		uint32 nCompressedSize = 0;
+		if( g_pLTBase->CompressBuffer( &m_aSourceData[0], nDataSize, &File.m_aData[0], nMaxCompressedSize, nCompressedSize ) == LT_OK && 
+			nCompressedSize < nDataSize )
+		{
+			Header.m_nCompression = eCompression_Engine;
+			File.m_aData.resize( nCompressedSize );
+			return true;
+		}
+	}
+
+	File.m_aData.swap( m_aSourceData );
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CSaveDirWriter::WriteFiles
+//
+//  PURPOSE:	Build the new destination dir next to the old one and swap it
+//				in.  Runs on the background thread.
+//
+// ----------------------------------------------------------------------- //
+
+bool CSaveDirWriter::WriteFiles( )
+{
+	char const* pszDestDir = m_sDestDir.c_str( );
+
+	char szStageDir[MAX_PATH*2];
+	char szOldDir[MAX_PATH*2];
+	LTSNPrintF( szStageDir, LTARRAYSIZE( szStageDir ), "%s" SAVEDIR_STAGE_SUFFIX, pszDestDir );
+	LTSNPrintF( szOldDir, LTARRAYSIZE( szOldDir ), "%s" SAVEDIR_OLD_SUFFIX, pszDestDir );
+
+	if( !CreateSaveDir( szStageDir ))
+		return false;
+
+	// Write every file read by Start into the new dir.  Unchanged files are 
+	// linked from the old dir.
+	bool bWritten = true;
+	char szDestFile[MAX_PATH*2];
+	char szStageFile[MAX_PATH*2];
+	for( std::deque<SFile>::const_iterator iter = m_aFiles.begin( ); bWritten && iter != m_aFiles.end( ); ++iter )
+	{
+		SFile const& File = *iter;
+		LTSNPrintF( szDestFile, LTARRAYSIZE( szDestFile ), "%s" FILE_PATH_SEPARATOR "%s", pszDestDir, File.m_sName.c_str( ));
+		LTSNPrintF( szStageFile, LTARRAYSIZE( szStageFile ), "%s" FILE_PATH_SEPARATOR "%s", szStageDir, File.m_sName.c_str( ));
+
+		if( File.m_bUnchanged )
+		{
+			bWritten = LinkSaveFile( szDestFile, szStageFile );
+			continue;
+		}
+
+		CLTFileWrite cFileWrite;
+		bWritten = cFileWrite.Open( szStageFile, false ) &&
+			cFileWrite.Write( &File.m_Header, sizeof( File.m_Header )) && 
+			( File.m_aData.empty( ) || cFileWrite.Write( &File.m_aData[0], ( uint32 )File.m_aData.size( )));
+		cFileWrite.Close( );
+	}
+
+	if( !bWritten )
+	{
+		CWinUtil::RemoveDir( szStageDir );
+		return false;
+	}
+
+	// Swap the new dir in.  If we don't get past the second rename, RecoverDir 
+	// puts the old dir back before the next read or write of this save.
+	bool bHadOldDir = CWinUtil::DirExist( pszDestDir );
+	if( bHadOldDir && !RenameSavePath( pszDestDir, szOldDir ))
+	{
+		CWinUtil::RemoveDir( szStageDir );
+		return false;
+	}
+
+	if( !RenameSavePath( szStageDir, pszDestDir ))
+	{
+		if( bHadOldDir )
+			RenameSavePath( szOldDir, pszDestDir );
+		CWinUtil::RemoveDir( szStageDir );
+		return false;
+	}
+
+	if( bHadOldDir )
+		CWinUtil::RemoveDir( szOldDir );
+
+#ifndef _FINAL
+	// Make sure every file reads back as it was written.  Decoding needs the
+	// engine, so RunRoundTripTest checks that on the main thread.
+	std::vector<uint8> aSavedData;
+	for( std::deque<SFile>::const_iterator iter = m_aFiles.begin( ); iter != m_aFiles.end( ); ++iter )
+	{
+		SFile const& File = *iter;
+		LTSNPrintF( szDestFile, LTARRAYSIZE( szDestFile ), "%s" FILE_PATH_SEPARATOR "%s", pszDestDir, File.m_sName.c_str( ));
+
+		SFileHeader SavedHeader;
+		bool bMatch = ReadWholeFile( szDestFile, aSavedData ) && ( aSavedData.size( ) >= sizeof( SavedHeader ));
+		if( bMatch )
+		{
+			memcpy( &SavedHeader, &aSavedData[0], sizeof( SavedHeader ));
+			bMatch = ( SavedHeader.m_nFourCC == File.m_Header.m_nFourCC ) &&
+				( SavedHeader.m_nSize == File.m_Header.m_nSize ) &&
+				( SavedHeader.m_nCRC == File.m_Header.m_nCRC );
+		}
+		if( bMatch && !File.m_bUnchanged )
+		{
+			bMatch = ( aSavedData.size( ) - sizeof( SavedHeader ) == File.m_aData.size( )) &&
+				( File.m_aData.empty( ) || memcmp( &aSavedData[sizeof( SavedHeader )], &File.m_aData[0], File.m_aData.size( )) == 0 );
+		}
+
+		if( !bMatch )
+		{
+			LTERROR_PARAM1( "Saved file '%s' doesn't match the working copy", szDestFile );
+			bWritten = false;
+		}
+	}
+#endif // _FINAL
+
+	return bWritten;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CSaveDirWriter::ReadDir
+//
+//  PURPOSE:	Copy a save dir back into a working dir...
+//
+// ----------------------------------------------------------------------- //
+
+bool CSaveDirWriter::ReadDir( char const* pszSrcDir, char const* pszDestDir )
+{
+	if( !pszSrcDir || !pszDestDir ) return false;
+
+	if( !CWinUtil::DirExist( pszSrcDir ))
+		return false;
+
+	if( !CWinUtil::DirExist( pszDestDir ) && !CWinUtil::CreateDir( pszDestDir ))
+		return false;
+
+	char szPath[MAX_PATH*2];
+	LTSNPrintF( szPath, LTARRAYSIZE( szPath ), "%s" FILE_PATH_SEPARATOR "*", pszSrcDir );
+
+	std::vector<uint8> aFileData;
+	std::vector<uint8> aData;
+
+	bool bResult = true;
+	LTFINDFILEINFO file;
+	LTFINDFILEHANDLE hFile;
+	if( LTFileOperations::FindFirst( szPath, hFile, &file ))
+	{
+		do
+		{
+			if( file.bIsSubdir )
+				continue;
+
+			LTSNPrintF( szPath, LTARRAYSIZE( szPath ), "%s" FILE_PATH_SEPARATOR "%s", pszSrcDir, file.name );
+			if( !ReadWholeFile( szPath, aFileData ) || !DecodeFile( aFileData, aData ))
+			{
+				DebugCPrint( 0, "CSaveDirWriter: Save file '%s' is damaged", szPath );
+				bResult = false;
+				break;
+			}
+
+			LTSNPrintF( szPath, LTARRAYSIZE( szPath ), "%s" FILE_PATH_SEPARATOR "%s", pszDestDir, file.name );
+			CLTFileWrite cFileWrite;
+			if( !cFileWrite.Open( szPath, false ) || 
+				( !aData.empty( ) && !cFileWrite.Write( &aData[0], ( uint32 )aData.size( ))))
+			{
+				bResult = false;
+				break;
+			}
+		}
+		while( LTFileOperations::FindNext( hFile, &file ));
+
+		LTFileOperations::FindClose( hFile );
+	}
+
+	return bResult;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CSaveDirWriter::DecodeFile
+//
+//  PURPOSE:	Turn the contents of a file in a save dir back into the
+//				working copy.  Files without a header are from saves made
+//				before the header was added and are used as they are.
+//
+// ----------------------------------------------------------------------- //
+
+bool CSaveDirWriter::DecodeFile( std::vector<uint8>& aFileData, std::vector<uint8>& aData )
+{
+	SFileHeader Header;
+	if( aFileData.size( ) < sizeof( Header ))
+	{
+		aData.swap( aFileData );
+		return true;
+	}
+
+	memcpy( &Header, &aFileData[0], sizeof( Header ));
+	if( Header.m_nFourCC != SAVEDIR_FILE_FOURCC )
+	{
+		aData.swap( aFileData );
+		return true;
+	}
+
+	uint8 const* pPayload = &aFileData[0] + sizeof( Header );
+	uint32 nPayloadSize = ( uint32 )aFileData.size( ) - sizeof( Header );
+
+	aData.resize( Header.m_nSize );
+	switch( Header.m_nCompression )
+	{
+		case eCompression_None:
+		{
+			if( nPayloadSize != Header.m_nSize )
+				return false;
+			if( nPayloadSize != 0 )
+				memcpy( &aData[0], pPayload, nPayloadSize );
+		}
+		break;
+
+		case eCompression_Engine:
+		{
+			uint32 nDecompressedSize = 0;
+			if( Header.m_nSize == 0 ||
+				g_pLTBase->DecompressBuffer( pPayload, nPayloadSize, &aData[0], Header.m_nSize, nDecompressedSize ) != LT_OK ||
+				nDecompressedSize != Header.m_nSize )
+			{
+				return false;
+			}
+		}
+		break;
+
+		default:
+			return false;
+	}
+
+	// Make sure nothing was damaged along the way.
+	uint32 nCRC = aData.empty( ) ? 0 : CRC32Utils::CalcDataCRC( &aData[0], ( uint32 )aData.size( ));
+	return ( nCRC == Header.m_nCRC );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CSaveDirWriter::RecoverDir
+//
+//  PURPOSE:	Put back a save dir that was only half swapped, and remove
+//				anything left over from an interrupted copy.
+//
+// ----------------------------------------------------------------------- //
+
+void CSaveDirWriter::RecoverDir( char const* pszDir )
+{
+	char szStageDir[MAX_PATH*2];
+	char szOldDir[MAX_PATH*2];
+	LTSNPrintF( szStageDir, LTARRAYSIZE( szStageDir ), "%s" SAVEDIR_STAGE_SUFFIX, pszDir );
+	LTSNPrintF( szOldDir, LTARRAYSIZE( szOldDir ), "%s" SAVEDIR_OLD_SUFFIX, pszDir );
+
+	// Only the old dir is left if we stopped between the two renames.
+	if( !CWinUtil::DirExist( pszDir ) && CWinUtil::DirExist( szOldDir ))
+		RenameSavePath( szOldDir, pszDir );
+
+	if( CWinUtil::DirExist( szOldDir ))
+		CWinUtil::RemoveDir( szOldDir );
+
+	if( CWinUtil::DirExist( szStageDir ))
+		CWinUtil::RemoveDir( szStageDir );
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CSaveDirWriter::ReadWholeFile
+//
+//  PURPOSE:	Read an entire file into a buffer...
+//
+// ----------------------------------------------------------------------- //
+
+bool CSaveDirWriter::ReadWholeFile( char const* pszFile, std::vector<uint8>& aData )
+{
+	CLTFileRead cFileRead;
+	uint64 nSize = 0;
+	if( !cFileRead.Open( pszFile ) || !cFileRead.GetFileSize( nSize ))
+		return false;
+
+	aData.resize(( uint32 )nSize );
+	if( nSize != 0 && !cFileRead.Read( &aData[0], ( uint32 )nSize ))
+		return false;
+
+	return true;
+}
+
+#ifndef _FINAL
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	WriteRoundTripTestFile
+//
+//  PURPOSE:	Write a generated file for CSaveDirWriter::RunRoundTripTest.
+//				Odd seeds give noise that doesn't compress, even seeds
+//				give runs that do.
+//
+// ----------------------------------------------------------------------- //
+
+static bool WriteRoundTripTestFile( char const* pszDir, uint32 nFile, uint32 nSeed )
+{
+	char szPath[MAX_PATH*2];
+	LTSNPrintF( szPath, LTARRAYSIZE( szPath ), "%s" FILE_PATH_SEPARATOR "Level%03u.sav", pszDir, nFile );
+
+	// The first file is empty, the rest range up to a few hundred K.
+	uint32 nSize = ( nFile == 0 ) ? 0 : (( nFile * 7919 + nSeed * 104729 ) % ( 256 * 1024 )) + 1;
+	std::vector<uint8> aData( nSize );
+	uint32 nRandom = nFile * 2654435761u + nSeed;
+	for( uint32 nByte = 0; nByte < nSize; ++nByte )
+	{
+		nRandom = nRandom * 1664525 + 1013904223;
+		aData[nByte] = ( nSeed & 1 ) ? ( uint8 )( nRandom >> 24 ) : ( uint8 )(( nByte / 64 ) + nSeed );
+	}
+
+	CLTFileWrite cFileWrite;
+	if( !cFileWrite.Open( szPath, false ))
+		return false;
+	bool bWritten = aData.empty( ) || cFileWrite.Write( &aData[0], nSize );
+	cFileWrite.Close( );
+	return bWritten;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CompareRoundTripTestDirs
+//
+//  PURPOSE:	Count the files in pszSrcDir that aren't the same in 
+//				pszReadDir, and the files in pszReadDir that shouldn't be.
+//
+// ----------------------------------------------------------------------- //
+
+static uint32 CompareRoundTripTestDirs( char const* pszSrcDir, char const* pszReadDir )
+{
+	uint32 nFailures = 0;
+	uint32 nNumSrcFiles = 0;
+	uint32 nNumReadFiles = 0;
+
+	char szFiles[MAX_PATH*2];
+	char szPath[MAX_PATH*2];
+	std::vector<uint8> aSrcData;
+	std::vector<uint8> aReadData;
+	LTFINDFILEINFO file;
+	LTFINDFILEHANDLE hFile;
+
+	LTSNPrintF( szFiles, LTARRAYSIZE( szFiles ), "%s" FILE_PATH_SEPARATOR "*", pszSrcDir );
+	if( LTFileOperations::FindFirst( szFiles, hFile, &file ))
+	{
+		do
+		{
+			if( file.bIsSubdir )
+				continue;
+
+			++nNumSrcFiles;
+
+			CLTFileRead cFileRead;
+			uint64 nSize = 0;
+			LTSNPrintF( szPath, LTARRAYSIZE( szPath ), "%s" FILE_PATH_SEPARATOR "%s", pszSrcDir, file.name );
+			bool bMatch = cFileRead.Open( szPath ) && cFileRead.GetFileSize( nSize );
+			aSrcData.resize(( uint32 )nSize );
+			bMatch = bMatch && ( nSize == 0 || cFileRead.Read( &aSrcData[0], ( uint32 )nSize ));
+			cFileRead.Close( );
+
+			LTSNPrintF( szPath, LTARRAYSIZE( szPath ), "%s" FILE_PATH_SEPARATOR "%s", pszReadDir, file.name );
+			bMatch = bMatch && cFileRead.Open( szPath ) && cFileRead.GetFileSize( nSize );
+			aReadData.resize(( uint32 )nSize );
+			bMatch = bMatch && ( nSize == 0 || cFileRead.Read( &aReadData[0], ( uint32 )nSize ));
+			cFileRead.Close( );
+
+			if( !bMatch || aSrcData != aReadData )
+			{
+				DebugCPrint( 0, "SaveDirRoundTripTest: %s didn't come back", file.name );
+				++nFailures;
+			}
+		}
+		while( LTFileOperations::FindNext( hFile, &file ));
+
+		LTFileOperations::FindClose( hFile );
+	}
+
+	LTSNPrintF( szFiles, LTARRAYSIZE( szFiles ), "%s" FILE_PATH_SEPARATOR "*", pszReadDir );
+	if( LTFileOperations::FindFirst( szFiles, hFile, &file ))
+	{
+		do
+		{
+			if( !file.bIsSubdir )
+				++nNumReadFiles;
+		}
+		while( LTFileOperations::FindNext( hFile, &file ));
+
+		LTFileOperations::FindClose( hFile );
+	}
+
+	if( nNumReadFiles != nNumSrcFiles )
+	{
+		DebugCPrint( 0, "SaveDirRoundTripTest: read back %u files, expected %u", nNumReadFiles, nNumSrcFiles );
+		++nFailures;
+	}
+
+	return nFailures;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//  ROUTINE:	CSaveDirWriter::RunRoundTripTest
+//
+//  PURPOSE:	Save generated working dirs and read them back.
+//
+// ----------------------------------------------------------------------- //
+
+void CSaveDirWriter::RunRoundTripTest( uint32 nNumFiles )
+{
+	if( nNumFiles < 4 )
+	{
+		nNumFiles = 16;
+	}
+
+	uint32 nFailures = 0;
+
+	char szBaseDir[MAX_PATH*2];
+	char szSrcDir[MAX_PATH*2];
+	char szSaveDir[MAX_PATH*2];
+	char szReadDir[MAX_PATH*2];
+	LTFileOperations::GetUserDirectory( szBaseDir, LTARRAYSIZE( szBaseDir ));
+	LTStrCat( szBaseDir, "SaveDirRoundTripTest", LTARRAYSIZE( szBaseDir ));
+	LTSNPrintF( szSrcDir, LTARRAYSIZE( szSrcDir ), "%s" FILE_PATH_SEPARATOR "Working", szBaseDir );
+	LTSNPrintF( szSaveDir, LTARRAYSIZE( szSaveDir ), "%s" FILE_PATH_SEPARATOR "Save" FILE_PATH_SEPARATOR WORKING_DIR, szBaseDir );
+	LTSNPrintF( szReadDir, LTARRAYSIZE( szReadDir ), "%s" FILE_PATH_SEPARATOR "Read", szBaseDir );
+
+	if( CWinUtil::DirExist( szBaseDir ))
+		CWinUtil::RemoveDir( szBaseDir );
+	if( !CWinUtil::CreateDir( szSrcDir ))
+	{
+		DebugCPrint( 0, "SaveDirRoundTripTest: could not create %s", szSrcDir );
+		return;
+	}
+
+	for( uint32 nFile = 0; nFile < nNumFiles; ++nFile )
+	{
+		if( !WriteRoundTripTestFile( szSrcDir, nFile, nFile ))
+			++nFailures;
+	}
+
+	// Save twice: into an empty save dir, then over it after changing every
+	// third file, removing one and adding one.
+	CSaveDirWriter Writer;
+	for( uint32 nPass = 0; nPass < 2; ++nPass )
+	{
+		uint32 nExpectedUnchanged = 0;
+		if( nPass == 1 )
+		{
+			for( uint32 nFile = 1; nFile < nNumFiles; ++nFile )
+			{
+				if(( nFile % 3 ) == 0 )
+				{
+					if( !WriteRoundTripTestFile( szSrcDir, nFile, nFile + 1 ))
+						++nFailures;
+				}
+				else if( nFile != 1 )
+				{
+					++nExpectedUnchanged;
+				}
+			}
+
+			char szPath[MAX_PATH*2];
+			LTSNPrintF( szPath, LTARRAYSIZE( szPath ), "%s" FILE_PATH_SEPARATOR "Level%03u.sav", szSrcDir, 1 );
+			LTFileOperations::DeleteFile( szPath );
+			if( !WriteRoundTripTestFile( szSrcDir, nNumFiles, nNumFiles ))
+				++nFailures;
+
+			// The empty file hasn't changed either.
+			++nExpectedUnchanged;
+		}
+
+		TLTPrecisionTime StartTime = LTTimeUtils::GetPrecisionTime( );
+		bool bStarted = Writer.Start( szSrcDir, szSaveDir );
+		double fStartMS = LTTimeUtils::GetPrecisionTimeIntervalMS( StartTime, LTTimeUtils::GetPrecisionTime( ));
+
+		// The thread only reads the list of files, so it can be counted while it runs.
+		uint32 nUnchanged = 0;
+		for( std::deque<SFile>::const_iterator iter = Writer.m_aFiles.begin( ); iter != Writer.m_aFiles.end( ); ++iter )
+		{
+			if( iter->m_bUnchanged )
+				++nUnchanged;
+		}
+
+		StartTime = LTTimeUtils::GetPrecisionTime( );
+		bool bWritten = Writer.WaitForCompletion( );
+		double fWaitMS = LTTimeUtils::GetPrecisionTimeIntervalMS( StartTime, LTTimeUtils::GetPrecisionTime( ));
+
+		if( !bStarted || !bWritten )
+		{
+			DebugCPrint( 0, "SaveDirRoundTripTest: pass %u could not save", nPass );
+			++nFailures;
+			continue;
+		}
+
+		if( nUnchanged != nExpectedUnchanged )
+		{
+			DebugCPrint( 0, "SaveDirRoundTripTest: pass %u reused %u files, expected %u", nPass, nUnchanged, nExpectedUnchanged );
+			++nFailures;
+		}
+
+		char szLeftover[MAX_PATH*2];
+		LTSNPrintF( szLeftover, LTARRAYSIZE( szLeftover ), "%s" SAVEDIR_STAGE_SUFFIX, szSaveDir );
+		bool bLeftover = CWinUtil::DirExist( szLeftover );
+		LTSNPrintF( szLeftover, LTARRAYSIZE( szLeftover ), "%s" SAVEDIR_OLD_SUFFIX, szSaveDir );
+		bLeftover = bLeftover || CWinUtil::DirExist( szLeftover );
+		if( bLeftover )
+		{
+			DebugCPrint( 0, "SaveDirRoundTripTest: pass %u left a %s or %s dir behind", nPass, SAVEDIR_STAGE_SUFFIX, SAVEDIR_OLD_SUFFIX );
+			++nFailures;
+		}
+
+		if( CWinUtil::DirExist( szReadDir ))
+			CWinUtil::RemoveDir( szReadDir );
+		if( !ReadDir( szSaveDir, szReadDir ))
+		{
+			DebugCPrint( 0, "SaveDirRoundTripTest: pass %u could not read the save back", nPass );
+			++nFailures;
+			continue;
+		}
+
+		nFailures += CompareRoundTripTestDirs( szSrcDir, szReadDir );
+
+		DebugCPrint( 0, "SaveDirRoundTripTest: pass %u, %u files: %.3f ms in Start, %.3f ms waiting for the thread", 
+			nPass, ( uint32 )Writer.m_aFiles.size( ), fStartMS, fWaitMS );
+	}
+
+	// A damaged file must not be read back.
+	char szDamaged[MAX_PATH*2];
+	LTSNPrintF( szDamaged, LTARRAYSIZE( szDamaged ), "%s" FILE_PATH_SEPARATOR "Level%03u.sav", szSaveDir, nNumFiles - 1 );
+	std::vector<uint8> aDamaged;
+	if( ReadWholeFile( szDamaged, aDamaged ) && aDamaged.size( ) > sizeof( SFileHeader ))
+	{
+		aDamaged.back( ) ^= 0xFF;
+		LTFileOperations::DeleteFile( szDamaged );
+		CLTFileWrite cFileWrite;
+		if( cFileWrite.Open( szDamaged, false ))
+		{
+			cFileWrite.Write( &aDamaged[0], ( uint32 )aDamaged.size( ));
+			cFileWrite.Close( );
+		}
+
+		CWinUtil::RemoveDir( szReadDir );
+		if( ReadDir( szSaveDir, szReadDir ))
+		{
+			DebugCPrint( 0, "SaveDirRoundTripTest: a damaged save was read back" );
+			++nFailures;
+		}
+	}
+	else
+	{
+		++nFailures;
+	}
+
+	CWinUtil::RemoveDir( szBaseDir );
+
+	DebugCPrint( 0, "SaveDirRoundTripTest: %u failures - %s", nFailures, ( nFailures == 0 ) ? "PASSED" : "FAILED" );
+}
+
+#endif // _FINAL
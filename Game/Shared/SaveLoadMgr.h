@@ -14,6 +14,11 @@
 #define __SAVE_LOAD_MGR_H__
 
 #include "ltfileoperations.h"
+#include "ltthread.h"
+#include "EventCaster.h"
+#include <map>
+#include <vector>
+#include <deque>
 
 //
 // Defines...
@@ -44,6 +49,127 @@
 #define SLOTSAVE_BASE           "Slot"
 
 
+//--------------------------------------------------------------------------------------------
+// Copies the contents of a working directory into a save directory on a background thread.
+// Start reads and CRC's the source files and compresses the changed ones on the calling
+// thread, since the engine compressor is not thread safe.  The background thread then builds
+// the new save directory next to the old one and swaps it in with a rename, so a save
+// directory is always either the old save or the new one.  The working directory must not
+// change until the copy has finished, see WaitForCompletion.
+//
+// Each file in a save directory starts with an SFileHeader, which records the CRC and size
+// of the uncompressed data.  Files whose header matches the working copy are linked into the
+// new directory rather than being compressed and written again.  ReadDir reverses the copy,
+// and also reads save directories written before the header was added.
+//--------------------------------------------------------------------------------------------
+class CSaveDirWriter
+{
+	public : // Methods...
+
+		CSaveDirWriter();
+		~CSaveDirWriter();
+
+		// Starts copying the absolute directory pszSrcDir into pszDestDir.  Any
+		// copy already in progress is finished first.
+		bool Start( char const* pszSrcDir, char const* pszDestDir );
+
+		// Blocks until the copy in progress, if any, has finished.  Returns false
+		// if the last copy failed.
+		bool WaitForCompletion();
+
+		// Copies a save directory written by Start back into a working directory,
+		// decompressing and checking every file.  Runs on the calling thread.
+		static bool ReadDir( char const* pszSrcDir, char const* pszDestDir );
+
+		// Restores a save dir left half swapped by a crash, and removes any leftovers.
+		static void RecoverDir( char const* pszDir );
+
+#ifndef _FINAL
+		// Writes nNumFiles generated files through Start and ReadDir, changes some of
+		// them and does it again, and checks that the working copies come back.
+		// Prints PASSED or FAILED.
+		static void RunRoundTripTest( uint32 nNumFiles );
+#endif // _FINAL
+
+		// Signaled from the background thread when a copy has finished.
+		struct FinishedNotifyParams : public EventCaster::NotifyParams
+		{
+			FinishedNotifyParams( EventCaster& eventCaster, bool bResult ) : EventCaster::NotifyParams( eventCaster ), m_bResult( bResult )
+			{
+			}
+
+			bool m_bResult;
+		};
+		DECLARE_THREADSAFE_EVENT( Finished );
+
+	private : // Methods...
+
+		// Background thread entry point.
+		static uint32 ThreadFunction( void* pArgument );
+
+		// Reads the source dir into m_aFiles.
+		bool ReadSourceFiles();
+
+		// Reads a single source file into m_aFiles.
+		bool ReadSourceFile( char const* pszName );
+
+		// Builds the new destination dir and swaps it in.
+		bool WriteFiles();
+
+		// Reads a whole file into aData.
+		static bool ReadWholeFile( char const* pszFile, std::vector<uint8>& aData );
+
+		// Turns the contents of a file in a save dir back into the working copy.
+		// aFileData may be swapped into aData.
+		static bool DecodeFile( std::vector<uint8>& aFileData, std::vector<uint8>& aData );
+
+	private : // Members...
+
+		// Header at the start of each file in a save directory.
+		struct SFileHeader
+		{
+			uint32	m_nFourCC;
+			// ECompression
+			uint32	m_nCompression;
+			// Size and CRC of the uncompressed data.
+			uint32	m_nSize;
+			uint32	m_nCRC;
+		};
+
+		enum ECompression
+		{
+			eCompression_None,
+			eCompression_Engine,
+		};
+
+		// A source file read by Start, waiting to be written.
+		struct SFile
+		{
+			std::string			m_sName;
+			SFileHeader			m_Header;
+			// The destination already holds this data, so the old file is linked.
+			bool				m_bUnchanged;
+			// Data to write after the header, compressed if m_Header says so.
+			std::vector<uint8>	m_aData;
+		};
+
+		// Copy in progress.  These are owned by the background thread until
+		// WaitForCompletion returns.
+		std::string			m_sSrcDir;
+		std::string			m_sDestDir;
+		// A deque, so adding a file doesn't copy the data of the others.
+		std::deque<SFile>	m_aFiles;
+		bool				m_bResult;
+
+		// Scratch buffer for Start.
+		std::vector<uint8>	m_aSourceData;
+
+		CLTThread			m_Thread;
+
+		PREVENT_OBJECT_COPYING( CSaveDirWriter );
+};
+
+
 //--------------------------------------------------------------------------------------------
 /** @author ????
  *  @date   ??/??/????
@@ -101,6 +227,9 @@ class CSaveLoadMgr
 
 		bool ClearWorkingDir();
 
+		// Blocks until the working dir has finished copying to the last save.
+		bool WaitForPendingSave() { return m_SaveDirWriter.WaitForCompletion(); }
+
 		char const* GetProfileName( ) const { return m_sProfileName.c_str(); }
 
 		char const* const GetTransitionFile( char const * pProfile ) const
@@ -131,6 +260,13 @@ protected:
 		// Create all the save folders needed.
 		bool	BuildProfileSaveDir( );
 
+		// Wait for the last save to finish copying the working dir.  Anything that
+		// writes into the working dir must call this first.
+		bool	WaitForWorkingDirCopy( ) { return m_SaveDirWriter.WaitForCompletion( ); }
+
+		// Access to the writer copying the working dir, e.g. to attach to its Finished event.
+		CSaveDirWriter&	GetSaveDirWriter( ) { return m_SaveDirWriter; }
+
 		// Methods for easily getting paths and filenames..
 		char const* const GetProfileSaveDir( const char *pProfile ) const
 		{
@@ -256,6 +392,9 @@ protected:
 
 		std::string m_sProfileName;
 		bool        m_bUseMultiplayerFolders;
+
+		// Copies the working dir into save dirs in the background.
+		CSaveDirWriter m_SaveDirWriter;
 };
 
 #endif // __SAVE_LOAD_MGR_H__
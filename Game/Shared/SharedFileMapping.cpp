@@ -0,0 +1,265 @@
+// ----------------------------------------------------------------------- //
+//
+// MODULE  : SharedFileMapping.cpp
+//
+// PURPOSE : Read-only data shared between processes through a mapped
+//           cache file.
+//
+// CREATED : 10/18/26
+//
+// (c) 2026 Monolith Productions, Inc.  All Rights Reserved
+//
+// ----------------------------------------------------------------------- //
+
+#include "Stdafx.h"
+#include "SharedFileMapping.h"
+#include "ltfilewrite.h"
+#include "ltfileoperations.h"
+#include "crc32utils.h"
+
+// ----------------------------------------------------------------------- //
+
+CSharedFileMapping::CSharedFileMapping()
+:	m_pData		( NULL ),
+	m_nDataSize	( 0 )
+{
+	m_szFilename[0] = '\0';
+}
+
+CSharedFileMapping::~CSharedFileMapping()
+{
+	Unmap();
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CSharedFileMapping::GetCacheFilename
+//
+//	PURPOSE:	Builds the cache file name used for a block of data.
+//
+// ----------------------------------------------------------------------- //
+
+bool CSharedFileMapping::GetCacheFilename( const char* pszCacheName, const uint8* pData, uint32 nDataSize, char* pszFilename, uint32 nFilenameSize )
+{
+	if( !pszCacheName || !pData || ( nDataSize == 0 ) )
+	{
+		return false;
+	}
+
+	char szFolder[MAX_PATH];
+	if( !LTFileOperations::GetTempFilePath( szFolder, LTARRAYSIZE( szFolder )))
+	{
+		return false;
+	}
+
+	// The temp path has a trailing separator on some platforms and not on others.
+	uint32 nFolderLen = LTStrLen( szFolder );
+	if( ( nFolderLen > 0 ) && ( szFolder[nFolderLen - 1] != FILE_PATH_SEPARATOR[0] ))
+	{
+		LTStrCat( szFolder, FILE_PATH_SEPARATOR, LTARRAYSIZE( szFolder ));
+	}
+	LTStrCat( szFolder, SHAREDFILEMAPPING_FOLDER, LTARRAYSIZE( szFolder ));
+
+	if( !LTFileOperations::DirectoryExists( szFolder ) && !LTFileOperations::CreateNewDirectory( szFolder ))
+	{
+		return false;
+	}
+
+	uint32 nCRC = CRC32Utils::CalcDataCRC( pData, nDataSize );
+	LTSNPrintF( pszFilename, nFilenameSize, "%s%s%s_%08x_%08x.dat", szFolder, FILE_PATH_SEPARATOR, pszCacheName, nDataSize, nCRC );
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CSharedFileMapping::WriteCacheFile
+//
+//	PURPOSE:	Writes the data to a temporary file and moves it into place,
+//				so other processes never map a partially written file.
+//
+// ----------------------------------------------------------------------- //
+
+bool CSharedFileMapping::WriteCacheFile( const char* pszFilename, const uint8* pData, uint32 nDataSize )
+{
+	char szFolder[MAX_PATH];
+	LTStrCpy( szFolder, pszFilename, LTARRAYSIZE( szFolder ));
+	char* pszSeparator = strrchr( szFolder, FILE_PATH_SEPARATOR[0] );
+	if( !pszSeparator )
+	{
+		return false;
+	}
+	*pszSeparator = '\0';
+
+	char szTempFilename[MAX_PATH];
+	if( !LTFileOperations::GetTempFileName( szFolder, "shr", szTempFilename, LTARRAYSIZE( szTempFilename )))
+	{
+		return false;
+	}
+
+	CLTFileWrite File;
+	bool bWritten = File.Open( szTempFilename, false ) && File.Write( pData, nDataSize );
+	bWritten = File.Close() && bWritten;
+
+	// Another process may have moved its own copy into place first, in which
+	// case the rename fails on some platforms and that copy is used instead.
+	if( !bWritten || ( rename( szTempFilename, pszFilename ) != 0 ))
+	{
+		LTFileOperations::DeleteFile( szTempFilename );
+		return bWritten;
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CSharedFileMapping::DeleteOldCacheFiles
+//
+//	PURPOSE:	Deletes the cache files with the same name as a newly
+//				written one that are past SHAREDFILEMAPPING_MAX_AGE.  A
+//				file another process still has mapped is kept on Windows,
+//				and stays mapped until that process is done with it on
+//				Linux.
+//
+// ----------------------------------------------------------------------- //
+
+void CSharedFileMapping::DeleteOldCacheFiles( const char* pszCacheName, const char* pszFilename )
+{
+	char szFolder[MAX_PATH];
+	LTStrCpy( szFolder, pszFilename, LTARRAYSIZE( szFolder ));
+	char* pszSeparator = strrchr( szFolder, FILE_PATH_SEPARATOR[0] );
+	if( !pszSeparator )
+	{
+		return;
+	}
+	*pszSeparator = '\0';
+
+	char szFiles[MAX_PATH];
+	LTSNPrintF( szFiles, LTARRAYSIZE( szFiles ), "%s%s%s_*.dat", szFolder, FILE_PATH_SEPARATOR, pszCacheName );
+
+	time_t nOldest = time( NULL ) - SHAREDFILEMAPPING_MAX_AGE;
+
+	LTFINDFILEINFO file;
+	LTFINDFILEHANDLE hFile;
+	if( LTFileOperations::FindFirst( szFiles, hFile, &file ))
+	{
+		do
+		{
+			char szFile[MAX_PATH];
+			LTSNPrintF( szFile, LTARRAYSIZE( szFile ), "%s%s%s", szFolder, FILE_PATH_SEPARATOR, file.name );
+
+			if( !file.bIsSubdir && ( file.time_write < nOldest ) && !LTStrIEquals( szFile, pszFilename ))
+			{
+				LTFileOperations::DeleteFile( szFile );
+			}
+		}
+		while( LTFileOperations::FindNext( hFile, &file ));
+
+		LTFileOperations::FindClose( hFile );
+	}
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CSharedFileMapping::MapSharedCopy
+//
+//	PURPOSE:	Returns a mapped copy of the data, creating the cache file
+//				if no other process has done so yet.
+//
+// ----------------------------------------------------------------------- //
+
+const uint8* CSharedFileMapping::MapSharedCopy( const char* pszCacheName, const uint8* pData, uint32 nDataSize )
+{
+	Unmap();
+
+	char szFilename[MAX_PATH];
+	if( !GetCacheFilename( pszCacheName, pData, nDataSize, szFilename, LTARRAYSIZE( szFilename )))
+	{
+		return NULL;
+	}
+
+	// Try the existing file first, then write it out and try once more.  A file
+	// that does not match is replaced where the platform allows it.
+	for( uint32 iAttempt = 0; iAttempt < 2; ++iAttempt )
+	{
+		if( iAttempt > 0 )
+		{
+			if( !WriteCacheFile( szFilename, pData, nDataSize ))
+			{
+				return NULL;
+			}
+
+			DeleteOldCacheFiles( pszCacheName, szFilename );
+		}
+
+		if( !LTFileOperations::FileExists( szFilename ) || !MapFile( szFilename ))
+		{
+			continue;
+		}
+
+		if( ( m_nDataSize == nDataSize ) && ( memcmp( m_pData, pData, nDataSize ) == 0 ))
+		{
+			return m_pData;
+		}
+
+		Unmap();
+	}
+
+	return NULL;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CSharedFileMapping::MapFile
+//
+//	PURPOSE:	Maps an existing file as is.
+//
+// ----------------------------------------------------------------------- //
+
+const uint8* CSharedFileMapping::MapFile( const char* pszFilename )
+{
+	Unmap();
+
+	if( !m_File.OpenMapped( pszFilename, ILTFileRead::eAccessRandom ))
+	{
+		return NULL;
+	}
+
+	uint64 nFileSize = 0;
+	if( !m_File.GetFileSize( nFileSize ) || ( nFileSize == 0 ) || ( nFileSize > 0xffffffff ))
+	{
+		m_File.Close();
+		return NULL;
+	}
+
+	m_pData = ( const uint8* )m_File.GetMappedRange( 0, nFileSize );
+	if( !m_pData )
+	{
+		m_File.Close();
+		return NULL;
+	}
+
+	m_nDataSize = ( uint32 )nFileSize;
+	LTStrCpy( m_szFilename, pszFilename, LTARRAYSIZE( m_szFilename ));
+	return m_pData;
+}
+
+// ----------------------------------------------------------------------- //
+//
+//	ROUTINE:	CSharedFileMapping::Unmap
+//
+//	PURPOSE:	Releases the mapping.
+//
+// ----------------------------------------------------------------------- //
+
+void CSharedFileMapping::Unmap()
+{
+	if( m_pData )
+	{
+		m_File.Close();
+	}
+
+	m_pData = NULL;
+	m_nDataSize = 0;
+	m_szFilename[0] = '\0';
+}
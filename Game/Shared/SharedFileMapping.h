@@ -0,0 +1,80 @@
+// ----------------------------------------------------------------------- //
+//
+// MODULE  : SharedFileMapping.h
+//
+// PURPOSE : Read-only data shared between processes through a mapped
+//           cache file.
+//
+// CREATED : 10/18/26
+//
+// (c) 2026 Monolith Productions, Inc.  All Rights Reserved
+//
+// ----------------------------------------------------------------------- //
+
+#ifndef __SHAREDFILEMAPPING_H__
+#define __SHAREDFILEMAPPING_H__
+
+#include "ltfileread.h"
+
+// Name of the folder under the temp path that holds the cache files.
+#define SHAREDFILEMAPPING_FOLDER	"SharedDataCache"
+
+// Seconds after it was written that a cache file is deleted, the next time a
+// cache file with the same name is written.
+#define SHAREDFILEMAPPING_MAX_AGE	( 24 * 60 * 60 )
+
+// CSharedFileMapping
+//
+// Copies a block of read-only data to a cache file and maps the file back in, so
+// that several game servers running on the same machine with the same data share
+// a single set of physical pages instead of each keeping a private copy.
+//
+// The cache file name is made from the data size and CRC, so processes loading
+// the same data find each other's file, and the mapped contents are compared
+// against the source before they are used.  Each change to the data makes a new
+// file, so writing one deletes those with the same name that are over a day old.
+// If the data cannot be mapped (no
+// writable temp folder, or a stale file that is still in use) the caller keeps
+// using its own copy.
+class CSharedFileMapping
+{
+public:
+
+	CSharedFileMapping();
+	~CSharedFileMapping();
+
+	// Returns a mapped copy of pData, creating the cache file if no other process
+	// has done so yet.  Returns NULL if the data could not be mapped.
+	const uint8* MapSharedCopy( const char* pszCacheName, const uint8* pData, uint32 nDataSize );
+
+	// Maps an existing file as is.  Returns NULL if the file could not be mapped.
+	const uint8* MapFile( const char* pszFilename );
+
+	// Releases the mapping.  Pointers into the data are invalid afterwards.
+	void Unmap();
+
+	bool			IsMapped() const { return ( m_pData != NULL ); }
+	const uint8*	GetData() const { return m_pData; }
+	uint32			GetDataSize() const { return m_nDataSize; }
+	const char*		GetFilename() const { return m_szFilename; }
+
+	// Builds the cache file name used for a block of data.
+	static bool GetCacheFilename( const char* pszCacheName, const uint8* pData, uint32 nDataSize, char* pszFilename, uint32 nFilenameSize );
+
+private:
+
+	// Writes the data to a temporary file and moves it into place.
+	static bool WriteCacheFile( const char* pszFilename, const uint8* pData, uint32 nDataSize );
+
+	// Deletes old cache files with the same name as a newly written one.
+	static void DeleteOldCacheFiles( const char* pszCacheName, const char* pszFilename );
+
+	CLTFileRead		m_File;
+	const uint8*	m_pData;
+	uint32			m_nDataSize;
+	char			m_szFilename[MAX_PATH];
+
+	PREVENT_OBJECT_COPYING( CSharedFileMapping );
+};
+
+#endif // __SHAREDFILEMAPPING_H__
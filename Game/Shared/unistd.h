@@ -0,0 +1,13 @@
+// ----------------------------------------------------------------------- //
+//
+// MODULE  : unistd.h
+//
+// PURPOSE : Stand-in for the POSIX header on Windows, which has none.  It
+//			 shadows the system header wherever Shared is on the include
+//			 path, so other platforms are passed on to the real one.
+//
+// ----------------------------------------------------------------------- //
+
+#if defined(PLATFORM_LINUX)
+#include_next <unistd.h>
+#endif
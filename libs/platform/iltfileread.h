@@ -21,10 +21,33 @@ class ILTFileRead
 {
 public:
 
+	// hint describing how a mapped file will be accessed
+	enum EAccessPattern
+	{
+		eAccessNormal,
+		eAccessSequential,
+		eAccessRandom
+	};
+
 	// open the file for reading.  This will close a previously opened file prior
 	// to opening the new file.  Returns false if the file does not exist on disk.
 	virtual bool Open(const char* pszFilename) = 0;
 
+	// open the file for reading, mapping it into memory if the platform supports it.
+	// If the file cannot be mapped it is opened for buffered reading instead, so all
+	// other operations behave the same either way.  Returns false if the file does
+	// not exist on disk.  A mapped file must not be truncated while it is open, since
+	// touching the pages past its new end faults (SIGBUS on Linux) instead of failing
+	// the read.  Only map files that are replaced rather than rewritten in place, such
+	// as packed game data.
+	virtual bool OpenMapped(const char* pszFilename, EAccessPattern eAccessPattern = eAccessNormal) = 0;
+
+	// return a pointer to nBytes of file data starting at nPos without copying it.
+	// The pointer remains valid until the file is closed.  Returns NULL if the file
+	// is not mapped or the range extends past the end of the file, in which case
+	// the data must be retrieved with Seek and Read.
+	virtual const void* GetMappedRange(uint64 nPos, uint64 nBytes) = 0;
+
 	// test to see if this object has an open file.  Returns false if an error
 	// occurs during the operation.
 	virtual bool GetIsOpen(bool& bIsOpen) = 0;
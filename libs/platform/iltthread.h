@@ -27,7 +27,8 @@ public:
 	//create and start the thread. This takes an optional processor affinity that can be used
 	//to make the created thread run more frequently on the specified processor. This processor
 	//value is platform specific. -1 indicates no affinity:
-	//PC/Linux: Currently ignored
+	//PC: Currently ignored
+	//Linux: [0..n-1], the index of the processor the thread is restricted to.
 	//Xenon: [0..5], where 0,1 are hardware threads on core 1, and so on through core 3.
 	virtual void Create(UserThreadFunction pUserThreadFunction, void* pArgument, uint32 nProcessorAffinity = (uint32)-1) = 0;
 
@@ -27,11 +27,20 @@ public:
 
 	// Increments the specified numeric variable.  Both the return value and
 	// pAddend contain the incremented value.
-	static void InterlockedIncrement(uint32* pAddend);
+	static uint32 InterlockedIncrement(uint32* pAddend);
 
 	// Decrements the specified numeric variable.  Both the return value and
 	// pAddend contain the decremented value.
 	static uint32 InterlockedDecrement(uint32* pAddend);
+
+	// Sets the specified variable to nValue and returns its previous value.
+	// This is a full memory barrier, so writes made before the exchange are
+	// visible to other threads before the new value is.
+	static uint32 InterlockedExchange(uint32* pTarget, uint32 nValue);
+
+	// Sets the pointer at ppTarget to pValue and returns its previous value.
+	// Like InterlockedExchange, this is a full memory barrier.
+	static void* InterlockedExchangePtr(void* volatile* ppTarget, void* pValue);
 };
 
 #if defined(PLATFORM_WIN32) 
@@ -0,0 +1,512 @@
+// *********************************************************************** //
+//
+// MODULE  : ltjobsystem.cpp
+//
+// PURPOSE : Implementation of the work-stealing job system.  This is
+//			 written entirely in terms of the platform wrappers and is
+//           shared across all platforms.
+//
+// CREATED : 10/18/26
+//
+// (c) 2026 Monolith Productions, Inc.  All Rights Reserved
+//
+// *********************************************************************** //
+
+#include "stdafx.h"
+#include "ltjobsystem.h"
+#include "ltthread.h"
+#include "ltthreadevent.h"
+#include "ltthreadutils.h"
+#include "lttimeutils.h"
+#include "ltautocriticalsection.h"
+#include "ltinterlockedoperations.h"
+#include <deque>
+
+// thread local storage for the worker that is running on the current thread
+#if defined(PLATFORM_LINUX)
+	#define LTJOB_THREADLOCAL __thread
+#else
+	#define LTJOB_THREADLOCAL __declspec(thread)
+#endif
+
+// time in milliseconds an idle worker sleeps before checking the queues again.  Workers
+// are normally woken explicitly when work is queued, this only bounds missed wake-ups.
+static const uint32 knWorkerIdleTimeoutMS = 2;
+
+// Each queue is a double ended list of jobs.  The owning thread pushes and pops at the
+// back so that it works on the most recently queued (and most likely cached) jobs, while
+// other threads steal from the front where the oldest and typically largest jobs are.
+struct CLTJobSystem::SJobQueue
+{
+	std::deque<SLTJob>	m_Jobs;
+	CLTCriticalSection	m_csQueue;
+};
+
+struct CLTJobSystem::SWorker
+{
+	CLTJobSystem*	m_pJobSystem;
+	uint32			m_nIndex;
+	CLTThread		m_Thread;
+	CLTThreadEvent	m_evWake;
+};
+
+// the job system and worker index that own the current thread, if any
+static LTJOB_THREADLOCAL CLTJobSystem*	s_pCurrentJobSystem = NULL;
+static LTJOB_THREADLOCAL uint32			s_nCurrentWorker = CLTJobSystem::knExternalThread;
+
+// argument used to run one batch of a parallel for
+struct SParallelForBatch
+{
+	LTParallelForFunction	m_pfnRange;
+	void*					m_pData;
+	uint32					m_nBegin;
+	uint32					m_nEnd;
+};
+
+static void ParallelForBatchJob(void* pData)
+{
+	SParallelForBatch* pBatch = (SParallelForBatch*)pData;
+	pBatch->m_pfnRange(pBatch->m_pData, pBatch->m_nBegin, pBatch->m_nEnd);
+}
+
+//---------------------------------------------------------------------------//
+// CLTJobCounter
+//---------------------------------------------------------------------------//
+
+CLTJobCounter::CLTJobCounter()
+	: m_nCount(0)
+{
+}
+
+CLTJobCounter::~CLTJobCounter()
+{
+	LTASSERT(m_nCount == 0, "Job counter destroyed while jobs are outstanding");
+	LTASSERT(m_lstDependents.empty(), "Job counter destroyed with dependent jobs still waiting");
+}
+
+uint32 CLTJobCounter::GetCount()
+{
+	CLTAutoCriticalSection cAutoCS(m_csCounter);
+	return m_nCount;
+}
+
+//---------------------------------------------------------------------------//
+// CLTJobSystem
+//---------------------------------------------------------------------------//
+
+CLTJobSystem::CLTJobSystem()
+	: m_nExternalQueue(0),
+	  m_nNextWakeWorker(0),
+	  m_nNumParkedJobs(0),
+	  m_pfnTimingCallback(NULL),
+	  m_pTimingUserData(NULL),
+	  m_bShutdown(false),
+	  m_bInitialized(false)
+{
+}
+
+CLTJobSystem::~CLTJobSystem()
+{
+	Term();
+}
+
+bool CLTJobSystem::Init(uint32 nNumWorkers, bool bSetAffinity)
+{
+	if (m_bInitialized)
+	{
+		return true;
+	}
+
+	uint32 nNumProcessors = LTThreadUtils::GetProcessorCount();
+	if (nNumWorkers == 0)
+	{
+		nNumWorkers = (nNumProcessors > 1) ? nNumProcessors - 1 : 0;
+	}
+
+	m_nNextWakeWorker = 0;
+
+	// if any of the threads couldn't be created, stop the ones that were and start
+	// again with that many, since the workers that are running already know the
+	// size of the worker list
+	for (;;)
+	{
+		uint32 nNumStarted = StartWorkers(nNumWorkers, bSetAffinity);
+		if (nNumStarted == nNumWorkers)
+		{
+			break;
+		}
+
+		StopWorkers(nNumStarted);
+
+		for (uint32 nQueue = 0; nQueue < m_lstQueues.size(); ++nQueue)
+		{
+			delete m_lstQueues[nQueue];
+		}
+		m_lstQueues.clear();
+
+		nNumWorkers = nNumStarted;
+	}
+
+	m_bInitialized = true;
+	return true;
+}
+
+uint32 CLTJobSystem::StartWorkers(uint32 nNumWorkers, bool bSetAffinity)
+{
+	uint32 nNumProcessors = LTThreadUtils::GetProcessorCount();
+
+	m_bShutdown = false;
+
+	// one queue per worker plus the queue shared by external threads
+	m_nExternalQueue = nNumWorkers;
+	m_lstQueues.reserve(nNumWorkers + 1);
+	for (uint32 nQueue = 0; nQueue <= nNumWorkers; ++nQueue)
+	{
+		m_lstQueues.push_back(new SJobQueue);
+	}
+
+	// create all of the workers before starting any of them so that stealing never
+	// sees a partially constructed list
+	m_lstWorkers.reserve(nNumWorkers);
+	for (uint32 nWorker = 0; nWorker < nNumWorkers; ++nWorker)
+	{
+		SWorker* pWorker = new SWorker;
+		pWorker->m_pJobSystem = this;
+		pWorker->m_nIndex = nWorker;
+		m_lstWorkers.push_back(pWorker);
+	}
+
+	for (uint32 nWorker = 0; nWorker < nNumWorkers; ++nWorker)
+	{
+		// leave processor 0 for the owning thread
+		uint32 nAffinity = (uint32)-1;
+		if (bSetAffinity && (nNumProcessors > 1))
+		{
+			nAffinity = 1 + (nWorker % (nNumProcessors - 1));
+		}
+
+		m_lstWorkers[nWorker]->m_Thread.Create(WorkerThreadFunction, m_lstWorkers[nWorker], nAffinity);
+		if (!m_lstWorkers[nWorker]->m_Thread.IsCreated())
+		{
+			return nWorker;
+		}
+	}
+
+	return nNumWorkers;
+}
+
+void CLTJobSystem::StopWorkers(uint32 nNumStarted)
+{
+	// tell the workers to exit once their current job is complete
+	m_bShutdown = true;
+	for (uint32 nWorker = 0; nWorker < nNumStarted; ++nWorker)
+	{
+		m_lstWorkers[nWorker]->m_evWake.Set();
+	}
+
+	// join every worker before freeing any, since a worker finishing its last job
+	// may still wake the others
+	for (uint32 nWorker = 0; nWorker < nNumStarted; ++nWorker)
+	{
+		m_lstWorkers[nWorker]->m_Thread.WaitForExit();
+	}
+
+	for (uint32 nWorker = 0; nWorker < m_lstWorkers.size(); ++nWorker)
+	{
+		delete m_lstWorkers[nWorker];
+	}
+	m_lstWorkers.clear();
+}
+
+void CLTJobSystem::Term()
+{
+	if (!m_bInitialized)
+	{
+		return;
+	}
+
+	StopWorkers((uint32)m_lstWorkers.size());
+
+	// drain anything left behind so that counters are never left outstanding.  With
+	// no workers left any dependents released by these jobs are run immediately.
+	SLTJob Job;
+	for (uint32 nQueue = 0; nQueue < m_lstQueues.size(); ++nQueue)
+	{
+		while (PopJob(nQueue, false, Job))
+		{
+			ExecuteJob(Job, knExternalThread);
+		}
+	}
+
+	for (uint32 nQueue = 0; nQueue < m_lstQueues.size(); ++nQueue)
+	{
+		delete m_lstQueues[nQueue];
+	}
+	m_lstQueues.clear();
+
+	// anything still parked is waiting on a counter that no queued job will decrement
+	LTASSERT(m_nNumParkedJobs == 0, "Job system terminated with dependent jobs that can never run");
+	m_nNumParkedJobs = 0;
+
+	m_bInitialized = false;
+}
+
+void CLTJobSystem::AddJob(LTJobFunction pfnJob, void* pData, CLTJobCounter* pCounter, const char* pszName)
+{
+	LTASSERT(pfnJob, "Attempt to add a job without a job function");
+
+	SLTJob Job;
+	Job.m_pfnJob	= pfnJob;
+	Job.m_pData		= pData;
+	Job.m_pCounter	= pCounter;
+	Job.m_pszName	= pszName;
+
+	if (pCounter)
+	{
+		CLTAutoCriticalSection cAutoCS(pCounter->m_csCounter);
+		++pCounter->m_nCount;
+	}
+
+	QueueJob(Job);
+}
+
+void CLTJobSystem::AddDependentJob(CLTJobCounter& Dependency, LTJobFunction pfnJob, void* pData, CLTJobCounter* pCounter, const char* pszName)
+{
+	LTASSERT(pfnJob, "Attempt to add a job without a job function");
+
+	SLTJob Job;
+	Job.m_pfnJob	= pfnJob;
+	Job.m_pData		= pData;
+	Job.m_pCounter	= pCounter;
+	Job.m_pszName	= pszName;
+
+	if (pCounter)
+	{
+		CLTAutoCriticalSection cAutoCS(pCounter->m_csCounter);
+		++pCounter->m_nCount;
+	}
+
+	// park the job on the dependency if it still has outstanding work
+	{
+		CLTAutoCriticalSection cAutoCS(Dependency.m_csCounter);
+		if (Dependency.m_nCount != 0)
+		{
+			Dependency.m_lstDependents.push_back(Job);
+			LTInterlockedOperations::InterlockedIncrement(&m_nNumParkedJobs);
+			return;
+		}
+	}
+
+	QueueJob(Job);
+}
+
+void CLTJobSystem::WaitForCounter(CLTJobCounter& Counter)
+{
+	uint32 nQueue = GetCurrentQueue();
+	uint32 nWorkerIndex = (nQueue == m_nExternalQueue) ? knExternalThread : nQueue;
+
+	SLTJob Job;
+	while (!Counter.IsDone())
+	{
+		if (FindJob(nQueue, Job))
+		{
+			ExecuteJob(Job, nWorkerIndex);
+		}
+		else
+		{
+			// the remaining jobs are running on other threads
+			LTThreadUtils::RelinquishTimeslice();
+		}
+	}
+}
+
+void CLTJobSystem::ParallelFor(uint32 nCount, uint32 nBatchSize, LTParallelForFunction pfnRange, void* pData, const char* pszName)
+{
+	if (nCount == 0)
+	{
+		return;
+	}
+
+	if (nBatchSize == 0)
+	{
+		nBatchSize = 1;
+	}
+
+	// nothing to gain from splitting if there is only a single batch or nobody to share with
+	if ((nCount <= nBatchSize) || m_lstWorkers.empty())
+	{
+		pfnRange(pData, 0, nCount);
+		return;
+	}
+
+	uint32 nNumBatches = (nCount + nBatchSize - 1) / nBatchSize;
+	std::vector<SParallelForBatch> lstBatches(nNumBatches);
+
+	CLTJobCounter Counter;
+	for (uint32 nBatch = 0; nBatch < nNumBatches; ++nBatch)
+	{
+		SParallelForBatch& Batch = lstBatches[nBatch];
+		Batch.m_pfnRange	= pfnRange;
+		Batch.m_pData		= pData;
+		Batch.m_nBegin		= nBatch * nBatchSize;
+		Batch.m_nEnd		= LTMIN(Batch.m_nBegin + nBatchSize, nCount);
+
+		AddJob(ParallelForBatchJob, &Batch, &Counter, pszName);
+	}
+
+	WaitForCounter(Counter);
+}
+
+void CLTJobSystem::SetTimingCallback(LTJobTimingCallback pfnCallback, void* pUserData)
+{
+	m_pTimingUserData = pUserData;
+	m_pfnTimingCallback = pfnCallback;
+}
+
+uint32 CLTJobSystem::WorkerThreadFunction(void* pArgument)
+{
+	SWorker* pWorker = (SWorker*)pArgument;
+	CLTJobSystem* pJobSystem = pWorker->m_pJobSystem;
+
+	LTThreadUtils::SetThreadDebugName("LTJobSystem Worker");
+
+	s_pCurrentJobSystem = pJobSystem;
+	s_nCurrentWorker = pWorker->m_nIndex;
+
+	SLTJob Job;
+	while (!pJobSystem->m_bShutdown)
+	{
+		if (pJobSystem->FindJob(pWorker->m_nIndex, Job))
+		{
+			pJobSystem->ExecuteJob(Job, pWorker->m_nIndex);
+		}
+		else
+		{
+			pWorker->m_evWake.Block(knWorkerIdleTimeoutMS);
+		}
+	}
+
+	s_pCurrentJobSystem = NULL;
+	s_nCurrentWorker = knExternalThread;
+
+	return 0;
+}
+
+void CLTJobSystem::QueueJob(const SLTJob& Job)
+{
+	// run the job immediately if there is nobody else to run it
+	if (m_lstWorkers.empty())
+	{
+		ExecuteJob(Job, knExternalThread);
+		return;
+	}
+
+	SJobQueue* pQueue = m_lstQueues[GetCurrentQueue()];
+	{
+		CLTAutoCriticalSection cAutoCS(pQueue->m_csQueue);
+		pQueue->m_Jobs.push_back(Job);
+	}
+
+	// wake the workers in turn so that new work spreads out across the processors
+	uint32 nWakeWorker = LTInterlockedOperations::InterlockedIncrement(&m_nNextWakeWorker) % m_lstWorkers.size();
+	m_lstWorkers[nWakeWorker]->m_evWake.Set();
+}
+
+bool CLTJobSystem::PopJob(uint32 nQueue, bool bOwner, SLTJob& Job)
+{
+	SJobQueue* pQueue = m_lstQueues[nQueue];
+
+	CLTAutoCriticalSection cAutoCS(pQueue->m_csQueue);
+	if (pQueue->m_Jobs.empty())
+	{
+		return false;
+	}
+
+	if (bOwner)
+	{
+		Job = pQueue->m_Jobs.back();
+		pQueue->m_Jobs.pop_back();
+	}
+	else
+	{
+		Job = pQueue->m_Jobs.front();
+		pQueue->m_Jobs.pop_front();
+	}
+
+	return true;
+}
+
+bool CLTJobSystem::FindJob(uint32 nQueue, SLTJob& Job)
+{
+	// the external queue is shared, so treat everyone as a thief there to keep it FIFO
+	if (PopJob(nQueue, nQueue != m_nExternalQueue, Job))
+	{
+		return true;
+	}
+
+	// steal from the other queues, starting with our neighbour so that thieves spread out
+	uint32 nNumQueues = (uint32)m_lstQueues.size();
+	for (uint32 nOffset = 1; nOffset < nNumQueues; ++nOffset)
+	{
+		if (PopJob((nQueue + nOffset) % nNumQueues, false, Job))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void CLTJobSystem::ExecuteJob(const SLTJob& Job, uint32 nWorkerIndex)
+{
+	LTJobTimingCallback pfnTimingCallback = m_pfnTimingCallback;
+	if (pfnTimingCallback)
+	{
+		TLTPrecisionTime StartTime = LTTimeUtils::GetPrecisionTime();
+		Job.m_pfnJob(Job.m_pData);
+		TLTPrecisionTime EndTime = LTTimeUtils::GetPrecisionTime();
+
+		pfnTimingCallback(Job.m_pszName, nWorkerIndex, LTTimeUtils::GetPrecisionTimeIntervalMS(StartTime, EndTime), m_pTimingUserData);
+	}
+	else
+	{
+		Job.m_pfnJob(Job.m_pData);
+	}
+
+	if (Job.m_pCounter)
+	{
+		DecrementCounter(*Job.m_pCounter);
+	}
+}
+
+void CLTJobSystem::DecrementCounter(CLTJobCounter& Counter)
+{
+	std::vector<SLTJob> lstReleased;
+	{
+		CLTAutoCriticalSection cAutoCS(Counter.m_csCounter);
+		LTASSERT(Counter.m_nCount > 0, "Job counter decremented below zero");
+
+		--Counter.m_nCount;
+		if ((Counter.m_nCount == 0) && !Counter.m_lstDependents.empty())
+		{
+			lstReleased.swap(Counter.m_lstDependents);
+		}
+	}
+
+	// queue the dependents outside of the lock since they may run immediately
+	for (uint32 nJob = 0; nJob < lstReleased.size(); ++nJob)
+	{
+		LTInterlockedOperations::InterlockedDecrement(&m_nNumParkedJobs);
+		QueueJob(lstReleased[nJob]);
+	}
+}
+
+uint32 CLTJobSystem::GetCurrentQueue() const
+{
+	if ((s_pCurrentJobSystem == this) && (s_nCurrentWorker < m_lstWorkers.size()))
+	{
+		return s_nCurrentWorker;
+	}
+
+	return m_nExternalQueue;
+}
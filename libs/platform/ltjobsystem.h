@@ -0,0 +1,211 @@
+// *********************************************************************** //
+//
+// MODULE  : ltjobsystem.h
+//
+// PURPOSE : Work-stealing job system built on the platform thread,
+//			 thread event and critical section wrappers.
+//
+// CREATED : 10/18/26
+//
+// (c) 2026 Monolith Productions, Inc.  All Rights Reserved
+//
+// *********************************************************************** //
+
+#ifndef __LTJOBSYSTEM_H__
+#define __LTJOBSYSTEM_H__
+
+#ifndef __PLATFORM_H__
+#include "platform.h"
+#endif
+
+#ifndef __LTINTEGER_H__
+#include "ltinteger.h"
+#endif
+
+#ifndef __LTBASEDEFS_H__
+#include "ltbasedefs.h"
+#endif
+
+#ifndef __LTCRITICALSECTION_H__
+#include "ltcriticalsection.h"
+#endif
+
+#include <vector>
+
+class CLTJobSystem;
+class CLTJobCounter;
+
+// function executed by a job
+typedef void (*LTJobFunction)(void* pData);
+
+// function executed by a parallel for over the index range [nBegin, nEnd)
+typedef void (*LTParallelForFunction)(void* pData, uint32 nBegin, uint32 nEnd);
+
+// optional hook called after every job completes.  The worker index is the
+// index of the worker thread that ran the job, or CLTJobSystem::knExternalThread
+// if the job ran on a thread that is not owned by the job system.
+typedef void (*LTJobTimingCallback)(const char* pszJobName, uint32 nWorkerIndex, double fDurationMS, void* pUserData);
+
+// description of a single unit of work
+struct SLTJob
+{
+	SLTJob()
+		: m_pfnJob(NULL),
+		  m_pData(NULL),
+		  m_pCounter(NULL),
+		  m_pszName(NULL)
+	{
+	}
+
+	// function to run and the data passed to it
+	LTJobFunction	m_pfnJob;
+	void*			m_pData;
+
+	// counter decremented once the job has finished, may be NULL
+	CLTJobCounter*	m_pCounter;
+
+	// name reported to the timing hook, may be NULL
+	const char*		m_pszName;
+};
+
+// Counts the number of outstanding jobs associated with it.  Jobs may be made
+// dependent on a counter, in which case they are not queued until the counter
+// reaches zero.  A counter must outlive every job that references it.
+class CLTJobCounter
+{
+public:
+
+	CLTJobCounter();
+	~CLTJobCounter();
+
+	// number of jobs associated with this counter that have not yet finished
+	uint32 GetCount();
+
+	// true when every job associated with this counter has finished
+	bool IsDone() { return GetCount() == 0; }
+
+private:
+
+	friend class CLTJobSystem;
+
+	// number of outstanding jobs
+	uint32				m_nCount;
+
+	// jobs waiting for this counter to reach zero
+	std::vector<SLTJob>	m_lstDependents;
+
+	// protects the count and dependent list
+	CLTCriticalSection	m_csCounter;
+
+	PREVENT_OBJECT_COPYING(CLTJobCounter);
+};
+
+class CLTJobSystem
+{
+public:
+
+	// worker index reported for jobs run on threads not owned by the job system
+	static const uint32 knExternalThread = (uint32)-1;
+
+	CLTJobSystem();
+	~CLTJobSystem();
+
+	// Starts the worker threads.  Passing zero workers creates one worker per
+	// processor, less one for the calling thread which helps out while waiting
+	// on counters.  When bSetAffinity is true worker N is restricted to processor
+	// N+1 so that processor 0 is left to the thread that owns the job system.
+	// Affinity is off by default since every process that enables it pins its
+	// workers to the same processors, which is a poor fit for hosts running
+	// several server instances.  If a worker thread can't be created the job
+	// system runs with the workers that could be, so GetNumWorkers only ever
+	// counts running workers.
+	bool Init(uint32 nNumWorkers = 0, bool bSetAffinity = false);
+
+	// stops and joins all worker threads.  Any jobs still queued are run on the
+	// calling thread before returning, along with the dependent jobs that they
+	// release.  Dependent jobs still waiting after that can never run, and are
+	// reported.
+	void Term();
+
+	bool	IsInitialized() const	{ return m_bInitialized; }
+	uint32	GetNumWorkers() const	{ return (uint32)m_lstWorkers.size(); }
+
+	// Queues a job.  If pCounter is non-NULL it is incremented immediately and
+	// decremented once the job has finished.  If the job system has no workers
+	// the job is run immediately on the calling thread.
+	void AddJob(LTJobFunction pfnJob, void* pData, CLTJobCounter* pCounter = NULL, const char* pszName = NULL);
+
+	// Queues a job that will not start until the dependency counter reaches zero.
+	void AddDependentJob(CLTJobCounter& Dependency, LTJobFunction pfnJob, void* pData, CLTJobCounter* pCounter = NULL, const char* pszName = NULL);
+
+	// Blocks until the counter reaches zero.  The calling thread runs queued
+	// jobs while it waits, so this is safe to call from within a job.
+	void WaitForCounter(CLTJobCounter& Counter);
+
+	// Splits the range [0, nCount) into batches of at most nBatchSize indices,
+	// runs them across the workers and waits for all of them to finish.
+	void ParallelFor(uint32 nCount, uint32 nBatchSize, LTParallelForFunction pfnRange, void* pData, const char* pszName = NULL);
+
+	// installs the hook that receives the run time of every job, or NULL to disable
+	void SetTimingCallback(LTJobTimingCallback pfnCallback, void* pUserData);
+
+private:
+
+	struct SJobQueue;
+	struct SWorker;
+
+	// thread function for each of the workers
+	static uint32 WorkerThreadFunction(void* pArgument);
+
+	// creates the queues and workers and starts the worker threads, stopping at the
+	// first thread that can't be created.  Returns the number of threads started.
+	uint32 StartWorkers(uint32 nNumWorkers, bool bSetAffinity);
+
+	// stops and joins the first nNumStarted worker threads and frees every worker
+	void StopWorkers(uint32 nNumStarted);
+
+	// pushes a job onto the queue belonging to the calling thread and wakes a worker
+	void QueueJob(const SLTJob& Job);
+
+	// pops a job from the queue at nQueue (bOwner takes the newest, thieves the oldest)
+	bool PopJob(uint32 nQueue, bool bOwner, SLTJob& Job);
+
+	// finds a job for the thread owning nQueue, stealing from other queues if required
+	bool FindJob(uint32 nQueue, SLTJob& Job);
+
+	// runs a job and signals its counter
+	void ExecuteJob(const SLTJob& Job, uint32 nWorkerIndex);
+
+	// decrements a counter, queuing any dependents when it reaches zero
+	void DecrementCounter(CLTJobCounter& Counter);
+
+	// returns the queue index for the calling thread
+	uint32 GetCurrentQueue() const;
+
+	// job queues.  Each worker owns the queue with the same index and the
+	// final queue is shared by all threads that are not workers.
+	std::vector<SJobQueue*>	m_lstQueues;
+	uint32					m_nExternalQueue;
+
+	// worker threads
+	std::vector<SWorker*>	m_lstWorkers;
+
+	// worker to wake for the next queued job, advanced by every thread that queues work
+	uint32					m_nNextWakeWorker;
+
+	// number of dependent jobs waiting on a counter
+	uint32					m_nNumParkedJobs;
+
+	// timing hook
+	LTJobTimingCallback		m_pfnTimingCallback;
+	void*					m_pTimingUserData;
+
+	// set to tell the workers to exit
+	volatile bool			m_bShutdown;
+
+	bool					m_bInitialized;
+
+	PREVENT_OBJECT_COPYING(CLTJobSystem);
+};
+
+#endif // __LTJOBSYSTEM_H__
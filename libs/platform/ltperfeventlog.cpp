@@ -0,0 +1,297 @@
+// *********************************************************************** //
+//
+// MODULE  : ltperfeventlog.cpp
+//
+// PURPOSE : Implementation of the binary performance event log.  This is
+//			 written entirely in terms of the platform wrappers and is
+//           shared across all platforms.
+//
+// CREATED : 10/18/26
+//
+// (c) 2026 Monolith Productions, Inc.  All Rights Reserved
+//
+// *********************************************************************** //
+
+#include "stdafx.h"
+#include "ltperfeventlog.h"
+#include "ltinterlockedoperations.h"
+#include "ltautocriticalsection.h"
+
+// thread local storage for the buffer the current thread records into
+#if defined(PLATFORM_LINUX)
+	#define LTPERF_THREADLOCAL __thread
+#else
+	#define LTPERF_THREADLOCAL __declspec(thread)
+#endif
+
+// the log and buffer that the current thread records into, if any
+static LTPERF_THREADLOCAL CLTPerfEventLog*	s_pThreadBufferLog = NULL;
+static LTPERF_THREADLOCAL void*				s_pThreadBuffer = NULL;
+
+CLTPerfEventLog& CLTPerfEventLog::Instance()
+{
+	static CLTPerfEventLog s_Log;
+	return s_Log;
+}
+
+CLTPerfEventLog::CLTPerfEventLog()
+	: m_nBufferEvents(0),
+	  m_bOverflowNameWritten(false),
+	  m_nFrame(0),
+	  m_nFlushIntervalMS(0),
+	  m_nActive(0),
+	  m_nShutdown(0)
+{
+}
+
+CLTPerfEventLog::~CLTPerfEventLog()
+{
+	Stop();
+
+	for (uint32 nBuffer = 0; nBuffer < m_lstBuffers.size(); ++nBuffer)
+	{
+		delete [] m_lstBuffers[nBuffer]->m_pEvents;
+		delete m_lstBuffers[nBuffer];
+	}
+	m_lstBuffers.clear();
+}
+
+bool CLTPerfEventLog::Start(const char* pszFilename, uint32 nBufferEvents, uint32 nFlushIntervalMS)
+{
+	Stop();
+
+	if (!m_File.Open(pszFilename, false))
+	{
+		return false;
+	}
+
+	// round the buffer size up to a power of two so indices can be masked
+	m_nBufferEvents = 2;
+	while (m_nBufferEvents < nBufferEvents)
+	{
+		m_nBufferEvents <<= 1;
+	}
+	m_nFlushIntervalMS = nFlushIntervalMS;
+
+	// discard anything left in the buffers by a previous run
+	{
+		CLTAutoCriticalSection cAutoCS(m_csBuffers);
+		for (uint32 nBuffer = 0; nBuffer < m_lstBuffers.size(); ++nBuffer)
+		{
+			SThreadBuffer* pBuffer = m_lstBuffers[nBuffer];
+			pBuffer->m_nRead = pBuffer->m_nWrite;
+			pBuffer->m_nDroppedWritten = pBuffer->m_nDropped;
+		}
+	}
+
+	m_NameIDs.clear();
+	m_lstNames.clear();
+	m_bOverflowNameWritten = false;
+	m_nFrame = 0;
+	m_lstFileData.clear();
+
+	// the precision timer's units differ between platforms, so store its rate
+	uint32 nFileID = LTPERFEVENTLOG_FILEID;
+	uint32 nFileVersion = LTPERFEVENTLOG_VERSION;
+	double fTicksPerSecond = 1000000.0 / LTTimeUtils::GetPrecisionTimeIntervalS(0, 1000000);
+	Write(&nFileID, sizeof(nFileID));
+	Write(&nFileVersion, sizeof(nFileVersion));
+	Write(&fTicksPerSecond, sizeof(fTicksPerSecond));
+
+	LTInterlockedOperations::InterlockedExchange((uint32*)&m_nShutdown, 0);
+	LTInterlockedOperations::InterlockedExchange((uint32*)&m_nActive, 1);
+	m_WriterThread.Create(WriterThreadFunction, this);
+
+	return true;
+}
+
+void CLTPerfEventLog::Stop()
+{
+	if (!m_nActive)
+	{
+		return;
+	}
+
+	LTInterlockedOperations::InterlockedExchange((uint32*)&m_nActive, 0);
+
+	// let the writer finish its current pass and exit
+	LTInterlockedOperations::InterlockedExchange((uint32*)&m_nShutdown, 1);
+	m_evWake.Set();
+	m_WriterThread.WaitForExit();
+
+	// write out whatever was recorded after the writer's last pass
+	Flush();
+	m_File.Close();
+}
+
+void CLTPerfEventLog::AddEvent(EEventType eType, const char* pszName, uint32 nValue)
+{
+	SThreadBuffer* pBuffer = GetThreadBuffer();
+	if (!pBuffer)
+	{
+		return;
+	}
+
+	// only this thread changes m_nWrite, so it can be read without a barrier
+	uint32 nWrite = pBuffer->m_nWrite;
+	if (nWrite - pBuffer->m_nRead > pBuffer->m_nMask)
+	{
+		// full, drop the event rather than wait for the writer
+		++pBuffer->m_nDropped;
+		return;
+	}
+
+	SEvent& Event = pBuffer->m_pEvents[nWrite & pBuffer->m_nMask];
+	Event.m_nTime = LTTimeUtils::GetPrecisionTime();
+	Event.m_pszName = pszName;
+	Event.m_nValue = nValue;
+	Event.m_nType = eType;
+
+	// publish the event to the writer
+	LTInterlockedOperations::InterlockedExchange((uint32*)&pBuffer->m_nWrite, nWrite + 1);
+}
+
+CLTPerfEventLog::SThreadBuffer* CLTPerfEventLog::GetThreadBuffer()
+{
+	if (s_pThreadBufferLog == this)
+	{
+		return (SThreadBuffer*)s_pThreadBuffer;
+	}
+
+	CLTAutoCriticalSection cAutoCS(m_csBuffers);
+
+	// the thread index is stored in 16 bits
+	if (m_lstBuffers.size() >= 0xFFFF)
+	{
+		return NULL;
+	}
+
+	SThreadBuffer* pBuffer = new SThreadBuffer;
+	pBuffer->m_pEvents = new SEvent[m_nBufferEvents];
+	pBuffer->m_nMask = m_nBufferEvents - 1;
+	pBuffer->m_nThread = (uint16)m_lstBuffers.size();
+	pBuffer->m_nWrite = 0;
+	pBuffer->m_nRead = 0;
+	pBuffer->m_nDropped = 0;
+	pBuffer->m_nDroppedWritten = 0;
+	m_lstBuffers.push_back(pBuffer);
+
+	s_pThreadBufferLog = this;
+	s_pThreadBuffer = pBuffer;
+
+	return pBuffer;
+}
+
+uint32 CLTPerfEventLog::WriterThreadFunction(void* pArgument)
+{
+	CLTPerfEventLog* pLog = (CLTPerfEventLog*)pArgument;
+
+	while (!pLog->m_nShutdown)
+	{
+		pLog->m_evWake.Block(pLog->m_nFlushIntervalMS);
+		pLog->Flush();
+	}
+
+	return 0;
+}
+
+void CLTPerfEventLog::Flush()
+{
+	{
+		CLTAutoCriticalSection cAutoCS(m_csBuffers);
+
+		for (uint32 nBuffer = 0; nBuffer < m_lstBuffers.size(); ++nBuffer)
+		{
+			SThreadBuffer* pBuffer = m_lstBuffers[nBuffer];
+
+			// the exchange that published m_nWrite made the events visible first
+			uint32 nRead = pBuffer->m_nRead;
+			uint32 nWrite = pBuffer->m_nWrite;
+			if (nWrite != nRead)
+			{
+				m_lstFileEvents.resize(nWrite - nRead);
+				for (uint32 nEvent = 0; nRead + nEvent != nWrite; ++nEvent)
+				{
+					const SEvent& Event = pBuffer->m_pEvents[(nRead + nEvent) & pBuffer->m_nMask];
+					SLTPerfFileEvent& FileEvent = m_lstFileEvents[nEvent];
+					FileEvent.m_nTime = Event.m_nTime;
+					FileEvent.m_nValue = Event.m_nValue;
+					FileEvent.m_nNameID = Event.m_pszName ? GetNameID(Event.m_pszName) : 0;
+					FileEvent.m_nType = (uint8)Event.m_nType;
+					FileEvent.m_nPadding = 0;
+				}
+
+				// hand the slots back to the recording thread
+				LTInterlockedOperations::InterlockedExchange((uint32*)&pBuffer->m_nRead, nWrite);
+
+				uint8 nRecord = eRecord_Events;
+				uint32 nCount = (uint32)m_lstFileEvents.size();
+				Write(&nRecord, sizeof(nRecord));
+				Write(&pBuffer->m_nThread, sizeof(pBuffer->m_nThread));
+				Write(&nCount, sizeof(nCount));
+				Write(&m_lstFileEvents[0], nCount * sizeof(SLTPerfFileEvent));
+			}
+
+			uint32 nDropped = pBuffer->m_nDropped;
+			if (nDropped != pBuffer->m_nDroppedWritten)
+			{
+				uint8 nRecord = eRecord_Dropped;
+				Write(&nRecord, sizeof(nRecord));
+				Write(&pBuffer->m_nThread, sizeof(pBuffer->m_nThread));
+				Write(&nDropped, sizeof(nDropped));
+				pBuffer->m_nDroppedWritten = nDropped;
+			}
+		}
+	}
+
+	// write outside of the lock so new threads are never held up by the disk
+	if (!m_lstFileData.empty())
+	{
+		m_File.Write(&m_lstFileData[0], (uint32)m_lstFileData.size());
+		m_lstFileData.clear();
+	}
+}
+
+void CLTPerfEventLog::Write(const void* pData, uint32 nSize)
+{
+	const uint8* pBytes = (const uint8*)pData;
+	m_lstFileData.insert(m_lstFileData.end(), pBytes, pBytes + nSize);
+}
+
+uint16 CLTPerfEventLog::GetNameID(const char* pszName)
+{
+	TNameIDMap::iterator itName = m_NameIDs.find(pszName);
+	if (itName != m_NameIDs.end())
+	{
+		return itName->second;
+	}
+
+	// the ids are stored in 16 bits, so once they are used up every new name
+	// shares the overflow id
+	uint16 nNameID = kOverflowNameID;
+	if (m_NameIDs.size() < kMaxNameIDs)
+	{
+		nNameID = (uint16)m_NameIDs.size();
+		m_lstNames.push_back(pszName);
+		m_NameIDs[m_lstNames.back().c_str()] = nNameID;
+	}
+	else if (!m_bOverflowNameWritten)
+	{
+		m_bOverflowNameWritten = true;
+		pszName = "(other)";
+	}
+	else
+	{
+		return nNameID;
+	}
+
+	uint8 nRecord = eRecord_Name;
+	size_t nNameLength = strlen(pszName);
+	uint16 nLength = (uint16)((nNameLength < 0xFFFF) ? nNameLength : 0xFFFF);
+	Write(&nRecord, sizeof(nRecord));
+	Write(&nNameID, sizeof(nNameID));
+	Write(&nLength, sizeof(nLength));
+	Write(pszName, nLength);
+
+	return nNameID;
+}
@@ -0,0 +1,250 @@
+// *********************************************************************** //
+//
+// MODULE  : ltperfeventlog.h
+//
+// PURPOSE : Low overhead binary log of frame markers, timed scopes and
+//			 counters, written by a background thread.
+//
+// CREATED : 10/18/26
+//
+// (c) 2026 Monolith Productions, Inc.  All Rights Reserved
+//
+// *********************************************************************** //
+
+#ifndef __LTPERFEVENTLOG_H__
+#define __LTPERFEVENTLOG_H__
+
+#ifndef __PLATFORM_H__
+#include "platform.h"
+#endif
+
+#ifndef __LTINTEGER_H__
+#include "ltinteger.h"
+#endif
+
+#ifndef __LTBASEDEFS_H__
+#include "ltbasedefs.h"
+#endif
+
+#ifndef __LTCRITICALSECTION_H__
+#include "ltcriticalsection.h"
+#endif
+
+#include "ltthread.h"
+#include "ltthreadevent.h"
+#include "ltfilewrite.h"
+#include "lttimeutils.h"
+#include <vector>
+#include <map>
+#include <list>
+#include <string>
+#include <string.h>
+
+// identifies a performance event log file
+#define LTPERFEVENTLOG_FILEID		LTMakeFourCC('L','T','P','L')
+#define LTPERFEVENTLOG_VERSION		1
+
+// Each thread that records events gets its own ring buffer, so recording never
+// takes a lock or waits on the writer.  A background thread drains the buffers
+// to the log file.  If a buffer fills up before it is drained, new events from
+// that thread are dropped and counted rather than blocking the game.
+//
+// Names passed to the recording functions are stored by pointer and must stay
+// valid until the log is stopped, which string literals always do.  Names with
+// the same text share an id in the file.  Once kMaxNameIDs names have been
+// defined, any further names are logged under kOverflowNameID.
+//
+// File format, all values little endian:
+//
+//	uint32 LTPERFEVENTLOG_FILEID, uint32 LTPERFEVENTLOG_VERSION,
+//	double precision timer ticks per second
+//
+// followed by records, each starting with a uint8 ERecordType:
+//
+//	eRecord_Name		uint16 name id, uint16 length, characters (not terminated)
+//	eRecord_Events		uint16 thread, uint32 count, count * SLTPerfFileEvent
+//	eRecord_Dropped		uint16 thread, uint32 total events dropped by that thread
+//
+// Name ids are defined by an eRecord_Name before any event uses them.
+
+// event as stored in the file
+struct SLTPerfFileEvent
+{
+	// precision timer value when the event was recorded
+	uint64	m_nTime;
+
+	// frame number counted from the start of the log for frame markers,
+	// value for counters, zero otherwise
+	uint32	m_nValue;
+
+	// name id, unused for frame markers
+	uint16	m_nNameID;
+
+	// CLTPerfEventLog::EEventType
+	uint8	m_nType;
+
+	uint8	m_nPadding;
+};
+
+class CLTPerfEventLog
+{
+public:
+
+	enum
+	{
+		// name id that names are logged under once all the others are used
+		kOverflowNameID	= 0xFFFF,
+		kMaxNameIDs		= kOverflowNameID,
+	};
+
+	enum EEventType
+	{
+		eEvent_Frame,
+		eEvent_ScopeBegin,
+		eEvent_ScopeEnd,
+		eEvent_Counter,
+	};
+
+	enum ERecordType
+	{
+		eRecord_Name,
+		eRecord_Events,
+		eRecord_Dropped,
+	};
+
+	// log shared by everything in this module
+	static CLTPerfEventLog& Instance();
+
+	CLTPerfEventLog();
+	~CLTPerfEventLog();
+
+	// Opens the log file and starts the writer thread.  nBufferEvents is the
+	// size of each thread's ring buffer, rounded up to a power of two.  It only
+	// applies to threads that have not recorded into this log before.
+	bool Start(const char* pszFilename, uint32 nBufferEvents = 16384, uint32 nFlushIntervalMS = 100);
+
+	// stops the writer thread after it has drained every buffer and closes the file
+	void Stop();
+
+	bool IsActive() const { return m_nActive != 0; }
+
+	// Recording.  These do nothing while the log is not active.  Frame marks
+	// the end of a frame and must only be called from one thread.
+	void Frame()										{ if (m_nActive) AddEvent(eEvent_Frame, NULL, m_nFrame++); }
+	void BeginScope(const char* pszName)				{ if (m_nActive) AddEvent(eEvent_ScopeBegin, pszName, 0); }
+	void EndScope(const char* pszName)					{ if (m_nActive) AddEvent(eEvent_ScopeEnd, pszName, 0); }
+	void Counter(const char* pszName, uint32 nValue)	{ if (m_nActive) AddEvent(eEvent_Counter, pszName, nValue); }
+
+	// Records a scope for the life of the object.
+	class CScope
+	{
+	public:
+
+		CScope(const char* pszName)
+			: m_pszName(pszName)
+		{
+			CLTPerfEventLog::Instance().BeginScope(m_pszName);
+		}
+
+		~CScope()
+		{
+			CLTPerfEventLog::Instance().EndScope(m_pszName);
+		}
+
+	private:
+
+		const char*	m_pszName;
+	};
+
+private:
+
+	// event as recorded into a thread's ring buffer
+	struct SEvent
+	{
+		TLTPrecisionTime	m_nTime;
+		const char*			m_pszName;
+		uint32				m_nValue;
+		uint32				m_nType;
+	};
+
+	// Ring buffer owned by one recording thread.  Only the owning thread
+	// advances m_nWrite and only the writer thread advances m_nRead.  Both
+	// are free running and wrap through the buffer using m_nMask.
+	struct SThreadBuffer
+	{
+		SEvent*				m_pEvents;
+		uint32				m_nMask;
+		uint16				m_nThread;
+		volatile uint32		m_nWrite;
+		volatile uint32		m_nRead;
+		volatile uint32		m_nDropped;
+
+		// dropped count last written to the file
+		uint32				m_nDroppedWritten;
+	};
+
+	// appends an event to the calling thread's buffer
+	void AddEvent(EEventType eType, const char* pszName, uint32 nValue);
+
+	// returns the calling thread's buffer, creating it if needed
+	SThreadBuffer* GetThreadBuffer();
+
+	// thread function for the writer
+	static uint32 WriterThreadFunction(void* pArgument);
+
+	// copies everything recorded so far into the file
+	void Flush();
+
+	// appends raw data to the pending file data
+	void Write(const void* pData, uint32 nSize);
+
+	// returns the file id for a name, writing its definition if it is new
+	uint16 GetNameID(const char* pszName);
+
+	// all buffers ever created for this log, indexed by thread
+	std::vector<SThreadBuffer*>	m_lstBuffers;
+	CLTCriticalSection			m_csBuffers;
+
+	// size of newly created buffers
+	uint32						m_nBufferEvents;
+
+	// orders names by their text
+	struct SNameLess
+	{
+		bool operator()(const char* pszLeft, const char* pszRight) const { return strcmp(pszLeft, pszRight) < 0; }
+	};
+
+	// name ids assigned so far, keyed by copies of the names kept in m_lstNames
+	typedef std::map<const char*, uint16, SNameLess> TNameIDMap;
+	TNameIDMap					m_NameIDs;
+	std::list<std::string>		m_lstNames;
+
+	// set once the overflow name has been written
+	bool						m_bOverflowNameWritten;
+
+	// number of frames marked since the log was started
+	uint32						m_nFrame;
+
+	// data waiting to be written to the file
+	std::vector<uint8>			m_lstFileData;
+
+	// scratch copy of a buffer's events
+	std::vector<SLTPerfFileEvent>	m_lstFileEvents;
+
+	CLTFileWrite				m_File;
+	CLTThread					m_WriterThread;
+	CLTThreadEvent				m_evWake;
+	uint32						m_nFlushIntervalMS;
+
+	// Non-zero while events are being recorded.  Like the buffer indices,
+	// these are only changed with interlocked exchanges, since they are read
+	// by the recording threads and the writer thread.
+	volatile uint32				m_nActive;
+
+	// non-zero to tell the writer thread to exit
+	volatile uint32				m_nShutdown;
+
+	PREVENT_OBJECT_COPYING(CLTPerfEventLog);
+};
+
+#endif // __LTPERFEVENTLOG_H__
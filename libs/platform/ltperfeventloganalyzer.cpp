@@ -0,0 +1,415 @@
+// *********************************************************************** //
+//
+// MODULE  : ltperfeventloganalyzer.cpp
+//
+// PURPOSE : Implementation of the performance event log analyzer.  This is
+//			 written entirely in terms of the platform wrappers and is
+//           shared across all platforms.
+//
+// CREATED : 10/18/26
+//
+// (c) 2026 Monolith Productions, Inc.  All Rights Reserved
+//
+// *********************************************************************** //
+
+#include "stdafx.h"
+#include "ltperfeventloganalyzer.h"
+#include "ltfileread.h"
+#include "ltstrutils.h"
+#include <algorithm>
+
+float CLTPerfEventLogAnalyzer::SStats::GetPercentile(float fPercentile) const
+{
+	if (m_lstSamples.empty())
+	{
+		return 0.0f;
+	}
+
+	uint32 nRank = (uint32)(fPercentile * 0.01f * m_lstSamples.size());
+	if (nRank >= m_lstSamples.size())
+	{
+		nRank = (uint32)m_lstSamples.size() - 1;
+	}
+
+	return m_lstSamples[nRank];
+}
+
+CLTPerfEventLogAnalyzer::CLTPerfEventLogAnalyzer()
+{
+	Clear();
+}
+
+void CLTPerfEventLogAnalyzer::Clear()
+{
+	m_lstNames.clear();
+	m_lstThreads.clear();
+	m_lstScopes.clear();
+	m_StackSelfMS.clear();
+	m_ScopeStatsByName.clear();
+	m_CounterStatsByName.clear();
+	m_FrameStats = SStats();
+	m_FrameStats.m_sName = "Frame";
+	m_lstScopeStats.clear();
+	m_lstCounterStats.clear();
+
+	m_fTicksPerSecond = 1.0;
+	m_bHaveFirstTime = false;
+	m_nFirstTime = 0;
+
+	m_nNumThreads = 0;
+	m_nNumEvents = 0;
+	m_nNumDropped = 0;
+	m_nNumUnmatched = 0;
+	m_bTruncated = false;
+}
+
+// sorts statistics by total, largest first
+static bool IsLargerTotal(const CLTPerfEventLogAnalyzer::SStats& Left, const CLTPerfEventLogAnalyzer::SStats& Right)
+{
+	return Left.m_fTotal > Right.m_fTotal;
+}
+
+bool CLTPerfEventLogAnalyzer::Load(const char* pszFilename)
+{
+	Clear();
+
+	// the whole log is read in at once, the writer keeps it compact
+	CLTFileRead File;
+	uint64 nFileSize = 0;
+	if (!pszFilename || !File.Open(pszFilename) || !File.GetFileSize(nFileSize) || (nFileSize > 0xFFFFFFFF))
+	{
+		return false;
+	}
+
+	std::vector<uint8> lstData((uint32)nFileSize);
+	if (!lstData.empty() && !File.Read(&lstData[0], (uint32)nFileSize))
+	{
+		return false;
+	}
+	File.Close();
+
+	const uint8* pData = lstData.empty() ? NULL : &lstData[0];
+	uint32 nSize = (uint32)lstData.size();
+	uint32 nPos = 0;
+
+	// header
+	uint32 nFileID = 0;
+	uint32 nFileVersion = 0;
+	const uint32 nHeaderSize = sizeof(nFileID) + sizeof(nFileVersion) + sizeof(m_fTicksPerSecond);
+	if (nSize < nHeaderSize)
+	{
+		return false;
+	}
+	memcpy(&nFileID, pData + nPos, sizeof(nFileID));
+	nPos += sizeof(nFileID);
+	memcpy(&nFileVersion, pData + nPos, sizeof(nFileVersion));
+	nPos += sizeof(nFileVersion);
+	memcpy(&m_fTicksPerSecond, pData + nPos, sizeof(m_fTicksPerSecond));
+	nPos += sizeof(m_fTicksPerSecond);
+	if ((nFileID != LTPERFEVENTLOG_FILEID) || (nFileVersion != LTPERFEVENTLOG_VERSION) || !(m_fTicksPerSecond > 0.0))
+	{
+		return false;
+	}
+
+	// records, stopping at the first one that isn't all there
+	while (nPos < nSize)
+	{
+		uint8 nRecord = pData[nPos];
+		uint32 nRecordPos = nPos + 1;
+
+		if (nRecord == CLTPerfEventLog::eRecord_Name)
+		{
+			uint16 nNameID = 0;
+			uint16 nLength = 0;
+			if (nSize - nRecordPos < sizeof(nNameID) + sizeof(nLength))
+			{
+				m_bTruncated = true;
+				break;
+			}
+			memcpy(&nNameID, pData + nRecordPos, sizeof(nNameID));
+			nRecordPos += sizeof(nNameID);
+			memcpy(&nLength, pData + nRecordPos, sizeof(nLength));
+			nRecordPos += sizeof(nLength);
+			if (nSize - nRecordPos < nLength)
+			{
+				m_bTruncated = true;
+				break;
+			}
+
+			if (nNameID >= m_lstNames.size())
+			{
+				m_lstNames.resize(nNameID + 1);
+			}
+			m_lstNames[nNameID].assign((const char*)pData + nRecordPos, nLength);
+			nRecordPos += nLength;
+		}
+		else if (nRecord == CLTPerfEventLog::eRecord_Events)
+		{
+			uint16 nThread = 0;
+			uint32 nCount = 0;
+			if (nSize - nRecordPos < sizeof(nThread) + sizeof(nCount))
+			{
+				m_bTruncated = true;
+				break;
+			}
+			memcpy(&nThread, pData + nRecordPos, sizeof(nThread));
+			nRecordPos += sizeof(nThread);
+			memcpy(&nCount, pData + nRecordPos, sizeof(nCount));
+			nRecordPos += sizeof(nCount);
+			if ((nSize - nRecordPos) / sizeof(SLTPerfFileEvent) < nCount)
+			{
+				m_bTruncated = true;
+				break;
+			}
+
+			for (uint32 nEvent = 0; nEvent < nCount; ++nEvent)
+			{
+				SLTPerfFileEvent Event;
+				memcpy(&Event, pData + nRecordPos, sizeof(Event));
+				nRecordPos += sizeof(Event);
+				AddEvent(nThread, Event);
+			}
+		}
+		else if (nRecord == CLTPerfEventLog::eRecord_Dropped)
+		{
+			uint16 nThread = 0;
+			uint32 nDropped = 0;
+			if (nSize - nRecordPos < sizeof(nThread) + sizeof(nDropped))
+			{
+				m_bTruncated = true;
+				break;
+			}
+			memcpy(&nThread, pData + nRecordPos, sizeof(nThread));
+			nRecordPos += sizeof(nThread);
+			memcpy(&nDropped, pData + nRecordPos, sizeof(nDropped));
+			nRecordPos += sizeof(nDropped);
+
+			// the record holds the running total for the thread
+			if (nThread >= m_lstThreads.size())
+			{
+				m_lstThreads.resize(nThread + 1);
+			}
+			m_lstThreads[nThread].m_nDropped = nDropped;
+		}
+		else
+		{
+			// nothing after an unknown record can be trusted
+			m_bTruncated = true;
+			break;
+		}
+
+		nPos = nRecordPos;
+	}
+
+	// anything still open never ended
+	m_nNumThreads = (uint32)m_lstThreads.size();
+	for (uint32 nThread = 0; nThread < m_lstThreads.size(); ++nThread)
+	{
+		m_nNumUnmatched += (uint32)m_lstThreads[nThread].m_lstOpenScopes.size();
+		m_lstThreads[nThread].m_lstOpenScopes.clear();
+		m_nNumDropped += m_lstThreads[nThread].m_nDropped;
+	}
+
+	// finish off the statistics
+	std::sort(m_FrameStats.m_lstSamples.begin(), m_FrameStats.m_lstSamples.end());
+	for (TStatsMap::iterator itStats = m_ScopeStatsByName.begin(); itStats != m_ScopeStatsByName.end(); ++itStats)
+	{
+		itStats->second.m_sName = GetName(itStats->first);
+		std::sort(itStats->second.m_lstSamples.begin(), itStats->second.m_lstSamples.end());
+		m_lstScopeStats.push_back(itStats->second);
+	}
+	std::stable_sort(m_lstScopeStats.begin(), m_lstScopeStats.end(), IsLargerTotal);
+	for (TStatsMap::iterator itStats = m_CounterStatsByName.begin(); itStats != m_CounterStatsByName.end(); ++itStats)
+	{
+		itStats->second.m_sName = GetName(itStats->first);
+		std::sort(itStats->second.m_lstSamples.begin(), itStats->second.m_lstSamples.end());
+		m_lstCounterStats.push_back(itStats->second);
+	}
+	m_ScopeStatsByName.clear();
+	m_CounterStatsByName.clear();
+
+	return true;
+}
+
+void CLTPerfEventLogAnalyzer::AddEvent(uint16 nThread, const SLTPerfFileEvent& Event)
+{
+	++m_nNumEvents;
+
+	if (nThread >= m_lstThreads.size())
+	{
+		m_lstThreads.resize(nThread + 1);
+	}
+	SThreadState& Thread = m_lstThreads[nThread];
+
+	// times in the CSV are relative to the first event read
+	if (!m_bHaveFirstTime)
+	{
+		m_bHaveFirstTime = true;
+		m_nFirstTime = Event.m_nTime;
+	}
+
+	switch (Event.m_nType)
+	{
+	case CLTPerfEventLog::eEvent_Frame:
+		{
+			if (Thread.m_bFrameMarked)
+			{
+				float fFrameMS = (float)GetIntervalMS(Thread.m_nLastFrameTime, Event.m_nTime);
+				m_FrameStats.m_lstSamples.push_back(fFrameMS);
+				m_FrameStats.m_fTotal += fFrameMS;
+			}
+			Thread.m_bFrameMarked = true;
+			Thread.m_nLastFrameTime = Event.m_nTime;
+		}
+		break;
+
+	case CLTPerfEventLog::eEvent_ScopeBegin:
+		{
+			SOpenScope OpenScope;
+			OpenScope.m_nNameID = Event.m_nNameID;
+			OpenScope.m_nBeginTime = Event.m_nTime;
+			OpenScope.m_fChildMS = 0.0;
+			Thread.m_lstOpenScopes.push_back(OpenScope);
+		}
+		break;
+
+	case CLTPerfEventLog::eEvent_ScopeEnd:
+		{
+			// find the scope this ends, a begin may have been dropped or
+			// recorded before the log started
+			uint32 nOpen = (uint32)Thread.m_lstOpenScopes.size();
+			while ((nOpen > 0) && (Thread.m_lstOpenScopes[nOpen - 1].m_nNameID != Event.m_nNameID))
+			{
+				--nOpen;
+			}
+			if (nOpen == 0)
+			{
+				++m_nNumUnmatched;
+				break;
+			}
+
+			// scopes above it lost their ends
+			while (Thread.m_lstOpenScopes.size() > nOpen)
+			{
+				++m_nNumUnmatched;
+				Thread.m_lstOpenScopes.pop_back();
+			}
+
+			EndScope(nThread, Thread, Event.m_nTime);
+		}
+		break;
+
+	case CLTPerfEventLog::eEvent_Counter:
+		{
+			SStats& Stats = m_CounterStatsByName[Event.m_nNameID];
+			Stats.m_lstSamples.push_back((float)Event.m_nValue);
+			Stats.m_fTotal += Event.m_nValue;
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void CLTPerfEventLogAnalyzer::EndScope(uint16 nThread, SThreadState& Thread, uint64 nEndTime)
+{
+	const SOpenScope& OpenScope = Thread.m_lstOpenScopes.back();
+	double fDurationMS = GetIntervalMS(OpenScope.m_nBeginTime, nEndTime);
+
+	SScope Scope;
+	Scope.m_nThread = nThread;
+	Scope.m_nDepth = (uint16)(Thread.m_lstOpenScopes.size() - 1);
+	Scope.m_nNameID = OpenScope.m_nNameID;
+	Scope.m_fStartMS = GetIntervalMS(m_nFirstTime, OpenScope.m_nBeginTime);
+	Scope.m_fDurationMS = fDurationMS;
+	m_lstScopes.push_back(Scope);
+
+	SStats& Stats = m_ScopeStatsByName[OpenScope.m_nNameID];
+	Stats.m_lstSamples.push_back((float)fDurationMS);
+	Stats.m_fTotal += fDurationMS;
+
+	// the stack's own time excludes the scopes nested inside it
+	char szThread[32];
+	LTSNPrintF(szThread, LTARRAYSIZE(szThread), "thread %u", (uint32)nThread);
+	std::string sStack = szThread;
+	for (uint32 nOpen = 0; nOpen < Thread.m_lstOpenScopes.size(); ++nOpen)
+	{
+		sStack += ';';
+		sStack += GetName(Thread.m_lstOpenScopes[nOpen].m_nNameID);
+	}
+	m_StackSelfMS[sStack] += fDurationMS - OpenScope.m_fChildMS;
+
+	Thread.m_lstOpenScopes.pop_back();
+	if (!Thread.m_lstOpenScopes.empty())
+	{
+		Thread.m_lstOpenScopes.back().m_fChildMS += fDurationMS;
+	}
+}
+
+double CLTPerfEventLogAnalyzer::GetIntervalMS(uint64 nBegin, uint64 nEnd) const
+{
+	// events from different threads are not in time order, so this can be negative
+	return (double)(int64)(nEnd - nBegin) * 1000.0 / m_fTicksPerSecond;
+}
+
+const char* CLTPerfEventLogAnalyzer::GetName(uint16 nNameID) const
+{
+	if ((nNameID < m_lstNames.size()) && !m_lstNames[nNameID].empty())
+	{
+		return m_lstNames[nNameID].c_str();
+	}
+
+	return "(unnamed)";
+}
+
+bool CLTPerfEventLogAnalyzer::WriteCSV(const char* pszFilename) const
+{
+	CLTFileWrite File;
+	if (!File.Open(pszFilename, false))
+	{
+		return false;
+	}
+
+	std::string sText = "thread,depth,name,start_ms,duration_ms\n";
+	for (uint32 nScope = 0; nScope < m_lstScopes.size(); ++nScope)
+	{
+		const SScope& Scope = m_lstScopes[nScope];
+
+		char szLine[512];
+		LTSNPrintF(szLine, LTARRAYSIZE(szLine), "%u,%u,\"%s\",%.4f,%.4f\n", (uint32)Scope.m_nThread, (uint32)Scope.m_nDepth,
+			GetName(Scope.m_nNameID), Scope.m_fStartMS, Scope.m_fDurationMS);
+		sText += szLine;
+	}
+
+	bool bWritten = File.Write(sText.c_str(), (uint32)sText.size());
+	return File.Close() && bWritten;
+}
+
+bool CLTPerfEventLogAnalyzer::WriteFoldedStacks(const char* pszFilename) const
+{
+	CLTFileWrite File;
+	if (!File.Open(pszFilename, false))
+	{
+		return false;
+	}
+
+	std::string sText;
+	for (TStackTimeMap::const_iterator itStack = m_StackSelfMS.begin(); itStack != m_StackSelfMS.end(); ++itStack)
+	{
+		// flame graph tools expect whole numbers
+		double fMicroseconds = itStack->second * 1000.0 + 0.5;
+		if (fMicroseconds < 1.0)
+		{
+			continue;
+		}
+
+		char szTime[32];
+		LTSNPrintF(szTime, LTARRAYSIZE(szTime), " %u\n", (uint32)fMicroseconds);
+		sText += itStack->first;
+		sText += szTime;
+	}
+
+	bool bWritten = sText.empty() || File.Write(sText.c_str(), (uint32)sText.size());
+	return File.Close() && bWritten;
+}
@@ -0,0 +1,168 @@
+// *********************************************************************** //
+//
+// MODULE  : ltperfeventloganalyzer.h
+//
+// PURPOSE : Offline analysis of logs written by CLTPerfEventLog.
+//
+// CREATED : 10/18/26
+//
+// (c) 2026 Monolith Productions, Inc.  All Rights Reserved
+//
+// *********************************************************************** //
+
+#ifndef __LTPERFEVENTLOGANALYZER_H__
+#define __LTPERFEVENTLOGANALYZER_H__
+
+#ifndef __LTPERFEVENTLOG_H__
+#include "ltperfeventlog.h"
+#endif
+
+// Reads a performance event log back and works out how long each named scope
+// took, how long each frame took and what values each counter had.  The scopes
+// can also be written out as CSV, one row per scope, and as folded stacks that
+// flame graph tools take as input.
+//
+// A log may end part way through a record if the game did not shut down
+// cleanly, and events may be missing where a thread's buffer filled up.  The
+// analyzer keeps everything up to the end of the last whole record, and skips
+// scope ends that have no matching begin.
+class CLTPerfEventLogAnalyzer
+{
+public:
+
+	// Times of one scope name or of the frames in milliseconds, or the values
+	// of one counter.
+	struct SStats
+	{
+		SStats() : m_fTotal(0.0) {}
+
+		uint32 GetCount() const { return (uint32)m_lstSamples.size(); }
+		float GetMean() const { return m_lstSamples.empty() ? 0.0f : (float)(m_fTotal / m_lstSamples.size()); }
+		float GetMin() const { return m_lstSamples.empty() ? 0.0f : m_lstSamples.front(); }
+		float GetMax() const { return m_lstSamples.empty() ? 0.0f : m_lstSamples.back(); }
+
+		// nearest rank percentile, fPercentile between 0 and 100
+		float GetPercentile(float fPercentile) const;
+
+		std::string			m_sName;
+		double				m_fTotal;
+
+		// sorted once the log is loaded
+		std::vector<float>	m_lstSamples;
+	};
+
+	CLTPerfEventLogAnalyzer();
+
+	// Reads and analyzes a log.  Returns false if the file can't be read or
+	// is not a performance event log.
+	bool Load(const char* pszFilename);
+
+	void Clear();
+
+	uint32 GetNumThreads() const { return m_nNumThreads; }
+	uint32 GetNumEvents() const { return m_nNumEvents; }
+
+	// events the game dropped because a buffer was full
+	uint32 GetNumDropped() const { return m_nNumDropped; }
+
+	// scope ends without a begin and scopes still open at the end of the log
+	uint32 GetNumUnmatched() const { return m_nNumUnmatched; }
+
+	// set if the log ends part way through a record
+	bool IsTruncated() const { return m_bTruncated; }
+
+	// time between frame markers
+	const SStats& GetFrameStats() const { return m_FrameStats; }
+
+	// scopes by name, largest total time first
+	uint32 GetNumScopes() const { return (uint32)m_lstScopeStats.size(); }
+	const SStats& GetScopeStats(uint32 nScope) const { return m_lstScopeStats[nScope]; }
+
+	// counters by name, in name order
+	uint32 GetNumCounters() const { return (uint32)m_lstCounterStats.size(); }
+	const SStats& GetCounterStats(uint32 nCounter) const { return m_lstCounterStats[nCounter]; }
+
+	// Writes one line per scope: thread, depth, name, start and duration in
+	// milliseconds since the first event in the log.
+	bool WriteCSV(const char* pszFilename) const;
+
+	// Writes the time spent in each stack of scopes, excluding the scopes
+	// nested inside it, as "thread;outer;inner microseconds" lines.
+	bool WriteFoldedStacks(const char* pszFilename) const;
+
+private:
+
+	// scope that has begun but not yet ended on a thread
+	struct SOpenScope
+	{
+		uint16	m_nNameID;
+		uint64	m_nBeginTime;
+
+		// time spent in scopes nested inside this one
+		double	m_fChildMS;
+	};
+
+	// one ended scope
+	struct SScope
+	{
+		uint16	m_nThread;
+		uint16	m_nDepth;
+		uint16	m_nNameID;
+		double	m_fStartMS;
+		double	m_fDurationMS;
+	};
+
+	struct SThreadState
+	{
+		SThreadState() : m_bFrameMarked(false), m_nLastFrameTime(0), m_nDropped(0) {}
+
+		std::vector<SOpenScope>	m_lstOpenScopes;
+		bool					m_bFrameMarked;
+		uint64					m_nLastFrameTime;
+		uint32					m_nDropped;
+	};
+
+	// handles one event read from the log
+	void AddEvent(uint16 nThread, const SLTPerfFileEvent& Event);
+
+	// ends the scope on top of a thread's stack
+	void EndScope(uint16 nThread, SThreadState& Thread, uint64 nEndTime);
+
+	// converts a precision timer interval to milliseconds
+	double GetIntervalMS(uint64 nBegin, uint64 nEnd) const;
+
+	const char* GetName(uint16 nNameID) const;
+
+	// name of each id, empty for ids that were never defined
+	std::vector<std::string>	m_lstNames;
+
+	std::vector<SThreadState>	m_lstThreads;
+	std::vector<SScope>			m_lstScopes;
+
+	// self time of each stack of scopes
+	typedef std::map<std::string, double> TStackTimeMap;
+	TStackTimeMap				m_StackSelfMS;
+
+	// statistics by name id while loading
+	typedef std::map<uint16, SStats> TStatsMap;
+	TStatsMap					m_ScopeStatsByName;
+	TStatsMap					m_CounterStatsByName;
+
+	SStats						m_FrameStats;
+	std::vector<SStats>			m_lstScopeStats;
+	std::vector<SStats>			m_lstCounterStats;
+
+	double						m_fTicksPerSecond;
+	bool						m_bHaveFirstTime;
+	uint64						m_nFirstTime;
+
+	uint32						m_nNumThreads;
+	uint32						m_nNumEvents;
+	uint32						m_nNumDropped;
+	uint32						m_nNumUnmatched;
+	bool						m_bTruncated;
+
+	PREVENT_OBJECT_COPYING(CLTPerfEventLogAnalyzer);
+};
+
+#endif // __LTPERFEVENTLOGANALYZER_H__
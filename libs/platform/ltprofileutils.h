@@ -49,7 +49,10 @@ public:
 
 
 	// Writes the value of the key to the specified file and section.
-	// ANSI and wide-string versions are provided.
+	// ANSI and wide-string versions are provided.  As with the Win32 API a NULL
+	// value removes the key, a NULL key removes the section and a NULL section
+	// flushes any cached writes to the file.  Every write is made to the file
+	// before returning.
 	static bool WriteString(const char* pszSectionName, 
 							const char* pszKeyName,
 							const char* pszValueString,
@@ -65,6 +68,15 @@ public:
 							uint32 nValue,
 							const char* pszFileName);
 
+#if defined(PLATFORM_LINUX) && !defined(_FINAL)
+	// Compares ReadString with the line by line reader that it replaced, using
+	// nNumFiles generated profile files in pszFolder, and checks that every write
+	// is in the file as soon as WriteString returns.  Each failure is passed to
+	// pfnReport, and the number of failures is returned.
+	typedef void (*ReportFn)(const char* pszMessage);
+	static uint32 RunCompareTest(const char* pszFolder, uint32 nNumFiles, ReportFn pfnReport);
+#endif
+
 };
 
 #endif // __LTPROFILEUTILS_H__
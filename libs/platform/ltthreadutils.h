@@ -34,6 +34,9 @@ public:
 	//called to set the name of the current thread for debugging purposes. This does not do anything
 	//in release or on certain platforms.
 	static void SetThreadDebugName(const char* pszDebugName);
+
+	// returns the number of processors available to this process (always at least one)
+	static uint32 GetProcessorCount();
 };
 
 
@@ -19,6 +19,7 @@
 #include <fnmatch.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <stdlib.h>
 
 const mode_t DEFAULT_PERMISSIONS = 484; // rwxr--r--
 extern char g_szUserDirectory[MAX_PATH];
@@ -88,8 +89,15 @@ void LTFileOperations::GetUserDirectory(char const* pszGameName, char* pDirector
 
 bool LTFileOperations::GetTempFilePath(char* pszTempPathBuffer, uint32 nTempPathBufferSize)
 {
-	// use current directory
-	::getcwd(pszTempPathBuffer, nTempPathBufferSize);
+	// use the temp directory from the environment, falling back to /tmp, so that
+	// temporary files don't collect in the current directory
+	const char* pszTempPath = ::getenv("TMPDIR");
+	if ((pszTempPath == NULL) || (pszTempPath[0] == (char)NULL))
+	{
+		pszTempPath = "/tmp";
+	}
+
+	LTStrCpy(pszTempPathBuffer, pszTempPath, nTempPathBufferSize);
 	
 	return true;
 }
@@ -16,19 +16,31 @@
 #include "iltfileread.h"
 #include "linux_ltfilebase.h"
 #include "ltassert.h"
+#include <sys/mman.h>
 
 class CLinux_LTFileRead : private ILTFileRead,
 						  private CLinux_LTFileBase
 {
 public:
 
-	CLinux_LTFileRead() {}
-	virtual ~CLinux_LTFileRead() {}
+	CLinux_LTFileRead();
+	virtual ~CLinux_LTFileRead();
 
 	// open the file for reading.  This will close a previously opened file prior
 	// to opening the new file.  Returns false if the file does not exist on disk.
 	virtual bool Open(const char* pszFilename);
 
+	// open the file for reading and map it into memory.  If the file cannot be mapped
+	// it is left open for buffered reading.  Returns false if the file does not exist
+	// on disk.  The mapping is shared so that processes reading the same file share its
+	// pages, and a private mapping would fault just the same if the file were truncated,
+	// so files that may be truncated while open must be opened with Open instead.
+	virtual bool OpenMapped(const char* pszFilename, EAccessPattern eAccessPattern = eAccessNormal);
+
+	// return a pointer to nBytes of mapped file data starting at nPos.  Returns NULL if
+	// the file is not mapped or the range extends past the end of the file.
+	virtual const void* GetMappedRange(uint64 nPos, uint64 nBytes);
+
 	// test to see if this object has an open file.  Returns false if an error
 	// occurs during the operation.
 	virtual bool GetIsOpen(bool& bIsOpen);
@@ -61,13 +73,110 @@ public:
 	// close the file.  Returns false if an error occurs while closing the file.
 	virtual bool Close();
 
+private:
+
+	// test to see if the file is being accessed through a mapping
+	bool IsMapped() const { return m_pMappedData != NULL; }
+
+	// release the mapping if there is one
+	void Unmap();
+
+	// mapped file data, or NULL if the file is being read through the stream
+	uint8* m_pMappedData;
+
+	// size of the mapped file data
+	uint64 m_nMappedSize;
+
+	// current read position within the mapped data
+	uint64 m_nMappedPos;
+
+	// prevent copy and assignment
+	PREVENT_OBJECT_COPYING(CLinux_LTFileRead);
+
 };
 
+inline CLinux_LTFileRead::CLinux_LTFileRead()
+	: m_pMappedData(NULL),
+	  m_nMappedSize(0),
+	  m_nMappedPos(0)
+{
+}
+
+inline CLinux_LTFileRead::~CLinux_LTFileRead()
+{
+	Unmap();
+}
+
 inline bool CLinux_LTFileRead::Open(const char* pszFilename)
 {
+	Unmap();
+
 	return OpenImpl(pszFilename, eOpenRead);
 }
 
+inline bool CLinux_LTFileRead::OpenMapped(const char* pszFilename, EAccessPattern eAccessPattern)
+{
+	// open through the base class so that the case-insensitive path handling is shared
+	if (!Open(pszFilename))
+	{
+		return false;
+	}
+
+	// empty files cannot be mapped, but the buffered path handles them fine
+	uint64 nSize = 0;
+	if (!GetFileSizeImpl(nSize) || (nSize == 0) || (nSize != (uint64)(size_t)nSize))
+	{
+		return true;
+	}
+
+	void* pMapping = ::mmap(NULL, (size_t)nSize, PROT_READ, MAP_SHARED, ::fileno(GetFileHandle()), 0);
+	if (pMapping == MAP_FAILED)
+	{
+		// leave the file open for buffered reading
+		return true;
+	}
+
+	// tell the kernel how the pages will be touched so that it can read ahead accordingly
+	switch (eAccessPattern)
+	{
+		case eAccessSequential:
+			::madvise(pMapping, (size_t)nSize, MADV_SEQUENTIAL);
+			break;
+		case eAccessRandom:
+			::madvise(pMapping, (size_t)nSize, MADV_RANDOM);
+			break;
+		default:
+			break;
+	}
+
+	m_pMappedData = (uint8*)pMapping;
+	m_nMappedSize = nSize;
+	m_nMappedPos  = 0;
+
+	return true;
+}
+
+inline const void* CLinux_LTFileRead::GetMappedRange(uint64 nPos, uint64 nBytes)
+{
+	if (!IsMapped() || (nPos > m_nMappedSize) || (nBytes > (m_nMappedSize - nPos)))
+	{
+		return NULL;
+	}
+
+	return m_pMappedData + nPos;
+}
+
+inline void CLinux_LTFileRead::Unmap()
+{
+	if (IsMapped())
+	{
+		::munmap(m_pMappedData, (size_t)m_nMappedSize);
+		m_pMappedData = NULL;
+		m_nMappedSize = 0;
+		m_nMappedPos  = 0;
+	}
+}
+
 inline bool CLinux_LTFileRead::GetIsOpen(bool& bIsOpen)
 {
 	return GetIsOpenImpl(bIsOpen);
@@ -82,6 +191,18 @@ inline bool CLinux_LTFileRead::Read(void* const pBuffer, const uint32 nSize)
 	{
 		return true;
 	}
+
+	if (IsMapped())
+	{
+		if ((m_nMappedPos > m_nMappedSize) || (nSize > (m_nMappedSize - m_nMappedPos)))
+		{
+			return false;
+		}
+
+		::memcpy(pBuffer, m_pMappedData + m_nMappedPos, nSize);
+		m_nMappedPos += nSize;
+		return true;
+	}
 	
 	size_t nRead = ::fread(pBuffer, nSize, 1, GetFileHandle());
 	
@@ -95,31 +216,64 @@ inline bool CLinux_LTFileRead::Read(void* const pBuffer, const uint32 nSize)
 
 inline bool CLinux_LTFileRead::Seek(uint64 nPos)
 { 
+	if (IsMapped())
+	{
+		// match fseeko64, which allows seeking past the end of the file
+		m_nMappedPos = nPos;
+		return true;
+	}
+
 	return SeekImpl(nPos); 
 }
 
 inline bool CLinux_LTFileRead::SeekToEnd()
 {
+	if (IsMapped())
+	{
+		m_nMappedPos = m_nMappedSize;
+		return true;
+	}
+
 	return SeekToEndImpl();
 }
 
 inline bool CLinux_LTFileRead::GetPos(uint64& nPos)
 {
+	if (IsMapped())
+	{
+		nPos = m_nMappedPos;
+		return true;
+	}
+
 	return GetPosImpl(nPos);
 }
 
 inline bool CLinux_LTFileRead::GetIsEOF(bool& bIsEOF)
 {
+	if (IsMapped())
+	{
+		bIsEOF = (m_nMappedPos == m_nMappedSize);
+		return true;
+	}
+
 	return GetIsEOFImpl(bIsEOF);
 }
 
 inline bool CLinux_LTFileRead::GetFileSize(uint64& nSize)
 {
+	if (IsMapped())
+	{
+		nSize = m_nMappedSize;
+		return true;
+	}
+
 	return GetFileSizeImpl(nSize);
 }
 
 inline bool CLinux_LTFileRead::Close()
 {
+	Unmap();
+
 	return CloseImpl();
 }
 
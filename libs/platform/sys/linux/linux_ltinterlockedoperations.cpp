@@ -15,11 +15,13 @@
 
 static pthread_mutex_t g_hInterlockedMutex = PTHREAD_MUTEX_INITIALIZER;
 
-void LTInterlockedOperations::InterlockedIncrement(uint32* pAddend)
+uint32 LTInterlockedOperations::InterlockedIncrement(uint32* pAddend)
 {
 	::pthread_mutex_lock(&g_hInterlockedMutex);
-	++(*pAddend);
+	uint32 nRV = ++(*pAddend);
 	::pthread_mutex_unlock(&g_hInterlockedMutex);
+
+	return nRV;
 }
 
 uint32 LTInterlockedOperations::InterlockedDecrement(uint32* pAddend)
@@ -31,4 +33,19 @@ uint32 LTInterlockedOperations::InterlockedDecrement(uint32* pAddend)
 	return nRV;
 }
 
+uint32 LTInterlockedOperations::InterlockedExchange(uint32* pTarget, uint32 nValue)
+{
+	// __sync_lock_test_and_set is only an acquire barrier, so issue a full
+	// barrier first.  This doesn't take the mutex, so lock-free callers stay
+	// lock-free.
+	__sync_synchronize();
+	return __sync_lock_test_and_set(pTarget, nValue);
+}
+
+void* LTInterlockedOperations::InterlockedExchangePtr(void* volatile* ppTarget, void* pValue)
+{
+	__sync_synchronize();
+	return __sync_lock_test_and_set(ppTarget, pValue);
+}
+
 
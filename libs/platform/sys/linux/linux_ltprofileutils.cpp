@@ -13,95 +13,697 @@
 #include <stdafx.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <stdio.h>
 #include <map>
 #include <string>
+#include <vector>
 #include "ltprofileutils.h"
 #include "sys/win/mpstrconv.h"
 #include "ltfileread.h"
+#include "lttimeutils.h"
+#include "ltautocriticalsection.h"
 
-// container for complete profile section
-typedef std::map<std::string, std::string> KeyValueMap;
-struct ProfileSectionEntries
+// minimum time between checks of a profile on disk for changes made by other processes
+static const uint32 knProfileCheckIntervalMS = 1000;
+
+// index used for lines that do not hold a key
+static const uint32 knInvalidIndex = (uint32)-1;
+
+// Parsed representation of a profile file.  Every line of the file is kept so that
+// comments and ordering survive a rewrite, and the keys are indexed by an open
+// addressing hash table on (section, key).  Writes are applied to the parsed data
+// and then written straight through to the disk.
+class CLinux_ProfileFile
 {
-	KeyValueMap m_cKeyValueMap;
+public:
+
+	CLinux_ProfileFile(const char* pszAbsoluteFileName);
+
+	// reloads the file if it has changed on disk.  The disk is only checked once per
+	// check interval unless bForceCheck is set.  Unflushed writes are never discarded.
+	void Refresh(bool bForceCheck);
+
+	// returns the value of the key, or NULL if it is not present
+	const char* FindValue(const char* pszSectionName, const char* pszKeyName) const;
+
+	// sets the value of the key, adding the section and key as needed
+	void SetValue(const char* pszSectionName, const char* pszKeyName, const char* pszValue);
+
+	// removes a key, or a complete section
+	void RemoveKey(const char* pszSectionName, const char* pszKeyName);
+	void RemoveSection(const char* pszSectionName);
+
+	// writes any pending changes to disk.  The file is written under a temporary
+	// name and renamed over the original so that readers never see a partial file.
+	// With bSync the data is also forced to the disk before the rename, which guards
+	// against losing the file in a power failure rather than a process exit.
+	bool Flush(bool bSync);
+
+	bool IsDirty() const { return m_bDirty; }
+
+private:
+
+	// a line of the file.  Key lines refer to their entry, all other lines are raw text.
+	struct SLine
+	{
+		std::string	m_strText;
+		uint32		m_nEntry;
+	};
+
+	struct SSection
+	{
+		std::string			m_strName;
+		uint32				m_nHash;
+		bool				m_bHasHeader;
+		bool				m_bRemoved;
+		std::vector<SLine>	m_lstLines;
+	};
+
+	struct SEntry
+	{
+		uint32		m_nSection;
+		uint32		m_nLine;
+		uint32		m_nHash;
+		bool		m_bRemoved;
+		std::string	m_strKey;
+		std::string	m_strValue;
+	};
+
+	// discards all parsed data
+	void Clear();
+
+	// parses the file from disk, recording its current state
+	void Load();
+
+	// returns true if the file on disk differs from the state recorded at the last load
+	bool HasChangedOnDisk() const;
+
+	// records the current state of the file on disk
+	void RecordDiskState();
+
+	// section helpers
+	uint32 FindSection(const char* pszSectionName) const;
+	uint32 AddSection(const char* pszSectionName, uint32 nNameLength, bool bHasHeader);
+
+	// key helpers
+	uint32 FindEntry(uint32 nSection, const char* pszKeyName) const;
+	void AddEntry(uint32 nSection, const std::string& strKey, const std::string& strValue, const char* pszLineText);
+	void InsertIntoHashTable(uint32 nEntry);
+	void GrowHashTable();
+
+	// hash functions
+	static uint32 HashString(const char* pszString, uint32 nSeed);
+	static uint32 HashKey(uint32 nSection, const char* pszKeyName);
+
+	// absolute path of the file
+	std::string				m_strFileName;
+
+	// parsed contents.  Section 0 holds any lines before the first section header.
+	std::vector<SSection>	m_lstSections;
+	std::vector<SEntry>		m_lstEntries;
+
+	// hash table of entry index + 1, with zero marking an empty slot
+	std::vector<uint32>		m_lstHashTable;
+
+	// state of the file when it was last loaded or saved
+	bool					m_bExists;
+	time_t					m_nModifiedTime;
+	off_t					m_nSize;
+	ino_t					m_nInode;
+
+	// time of the last check against the disk
+	uint32					m_nLastCheckTimeMS;
+
+	// true if there are changes that have not been written to disk
+	bool					m_bDirty;
 };
 
-// container of sections to KeyValueMaps
-typedef std::map<std::string, ProfileSectionEntries> SectionMap;
-struct ProfileSections
+CLinux_ProfileFile::CLinux_ProfileFile(const char* pszAbsoluteFileName)
+	: m_strFileName(pszAbsoluteFileName),
+	  m_bExists(false),
+	  m_nModifiedTime(0),
+	  m_nSize(0),
+	  m_nInode(0),
+	  m_nLastCheckTimeMS(0),
+	  m_bDirty(false)
 {
-	SectionMap m_cSectionMap;
-};
+	Load();
+}
 
-// map of files to sections
-typedef std::map<std::string, ProfileSections> ProfileCache; 
+void CLinux_ProfileFile::Refresh(bool bForceCheck)
+{
+	uint32 nTimeMS = LTTimeUtils::GetTimeMS();
+	if (!bForceCheck && ((nTimeMS - m_nLastCheckTimeMS) < knProfileCheckIntervalMS))
+	{
+		return;
+	}
+	m_nLastCheckTimeMS = nTimeMS;
 
-// declare profile cache
-static ProfileCache g_cProfileCache;
+	if (!m_bDirty && HasChangedOnDisk())
+	{
+		Load();
+	}
+}
+
+const char* CLinux_ProfileFile::FindValue(const char* pszSectionName, const char* pszKeyName) const
+{
+	uint32 nSection = FindSection(pszSectionName);
+	if (nSection == knInvalidIndex)
+	{
+		return NULL;
+	}
 
-// helper for processing the file
-static ProfileCache::iterator ProcessProfileFile(const char* pszFileName);
+	uint32 nEntry = FindEntry(nSection, pszKeyName);
+	if (nEntry == knInvalidIndex)
+	{
+		return NULL;
+	}
 
-void LTProfileUtils::ReadString(const char*  pszSectionName, 
-								const char*  pszKeyName,
-								const char*  pszDefaultValue,
-								char* 	   pszValueString,
-								uint32	   nValueStringBufferSize,
-								const char*  pszFileName)
+	return m_lstEntries[nEntry].m_strValue.c_str();
+}
+
+void CLinux_ProfileFile::SetValue(const char* pszSectionName, const char* pszKeyName, const char* pszValue)
 {
-	// resolve file to absolute path
-	char pszAbsoluteFileName[MAX_PATH];
-	::realpath(pszFileName, pszAbsoluteFileName);
-	
-	// check profile cache for this file
-	ProfileCache::iterator itCachedProfile = g_cProfileCache.find(pszAbsoluteFileName);
-	if (itCachedProfile == g_cProfileCache.end())
-	{
-		// it's not in the cache, process the file
-		itCachedProfile = ProcessProfileFile(pszAbsoluteFileName);
-		
-		if (itCachedProfile == g_cProfileCache.end())
+	uint32 nSection = FindSection(pszSectionName);
+	if (nSection == knInvalidIndex)
+	{
+		nSection = AddSection(pszSectionName, LTStrLen(pszSectionName), true);
+	}
+	m_lstSections[nSection].m_bRemoved = false;
+
+	std::string strLine(pszKeyName);
+	strLine += '=';
+	strLine += pszValue;
+
+	uint32 nEntry = FindEntry(nSection, pszKeyName);
+	if (nEntry == knInvalidIndex)
+	{
+		AddEntry(nSection, pszKeyName, pszValue, strLine.c_str());
+	}
+	else
+	{
+		SEntry& Entry = m_lstEntries[nEntry];
+		Entry.m_strValue = pszValue;
+		Entry.m_bRemoved = false;
+		m_lstSections[nSection].m_lstLines[Entry.m_nLine].m_strText = strLine;
+	}
+
+	m_bDirty = true;
+}
+
+void CLinux_ProfileFile::RemoveKey(const char* pszSectionName, const char* pszKeyName)
+{
+	uint32 nSection = FindSection(pszSectionName);
+	if (nSection == knInvalidIndex)
+	{
+		return;
+	}
+
+	uint32 nEntry = FindEntry(nSection, pszKeyName);
+	if (nEntry != knInvalidIndex)
+	{
+		m_lstEntries[nEntry].m_bRemoved = true;
+		m_bDirty = true;
+	}
+}
+
+void CLinux_ProfileFile::RemoveSection(const char* pszSectionName)
+{
+	uint32 nSection = FindSection(pszSectionName);
+	if (nSection == knInvalidIndex)
+	{
+		return;
+	}
+
+	SSection& Section = m_lstSections[nSection];
+	Section.m_bRemoved = true;
+	for (uint32 nLine = 0; nLine < Section.m_lstLines.size(); ++nLine)
+	{
+		if (Section.m_lstLines[nLine].m_nEntry != knInvalidIndex)
 		{
-			// unable to open or process the file - return the default value if specified
-			if (pszDefaultValue)
+			m_lstEntries[Section.m_lstLines[nLine].m_nEntry].m_bRemoved = true;
+		}
+	}
+
+	m_bDirty = true;
+}
+
+bool CLinux_ProfileFile::Flush(bool bSync)
+{
+	// the last write may already be in the file, in which case it only needs syncing
+	if (!m_bDirty)
+	{
+		if (bSync && m_bExists)
+		{
+			int hFile = ::open(m_strFileName.c_str(), O_RDONLY);
+			if (hFile != -1)
 			{
-				LTStrCpy(pszValueString, pszDefaultValue, nValueStringBufferSize);
+				::fsync(hFile);
+				::close(hFile);
 			}
-			else
+		}
+
+		return true;
+	}
+
+	std::string strTempFileName = m_strFileName + ".tmp";
+	FILE* pFile = ::fopen(strTempFileName.c_str(), "wb");
+	if (!pFile)
+	{
+		return false;
+	}
+
+	bool bSuccess = true;
+	for (uint32 nSection = 0; nSection < m_lstSections.size(); ++nSection)
+	{
+		const SSection& Section = m_lstSections[nSection];
+		if (Section.m_bRemoved)
+		{
+			continue;
+		}
+
+		if (Section.m_bHasHeader)
+		{
+			bSuccess &= (::fprintf(pFile, "[%s]\n", Section.m_strName.c_str()) >= 0);
+		}
+
+		for (uint32 nLine = 0; nLine < Section.m_lstLines.size(); ++nLine)
+		{
+			const SLine& Line = Section.m_lstLines[nLine];
+			if ((Line.m_nEntry != knInvalidIndex) && m_lstEntries[Line.m_nEntry].m_bRemoved)
 			{
-				pszValueString = NULL;
+				continue;
 			}
-			return;
+
+			bSuccess &= (::fprintf(pFile, "%s\n", Line.m_strText.c_str()) >= 0);
 		}
 	}
-	
-	// look for the section
-	ProfileSections cProfile = (*itCachedProfile).second;
-	SectionMap::iterator itSection = cProfile.m_cSectionMap.find(pszSectionName);
-	
-	// if it's not there, return default value
-	if (itSection == cProfile.m_cSectionMap.end())
+
+	// make sure the data is on disk before the rename makes it visible if requested
+	bSuccess &= (::fflush(pFile) == 0);
+	if (bSync)
+	{
+		bSuccess &= (::fsync(::fileno(pFile)) == 0);
+	}
+	bSuccess &= (::fclose(pFile) == 0);
+
+	if (!bSuccess || (::rename(strTempFileName.c_str(), m_strFileName.c_str()) != 0))
+	{
+		::unlink(strTempFileName.c_str());
+		return false;
+	}
+
+	RecordDiskState();
+	m_bDirty = false;
+
+	return true;
+}
+
+void CLinux_ProfileFile::Clear()
+{
+	m_lstSections.clear();
+	m_lstEntries.clear();
+	m_lstHashTable.clear();
+	m_lstHashTable.resize(64, 0);
+
+	// section for lines before the first header
+	AddSection("", 0, false);
+}
+
+void CLinux_ProfileFile::Load()
+{
+	Clear();
+	RecordDiskState();
+	m_bDirty = false;
+
+	if (!m_bExists)
+	{
+		return;
+	}
+
+	// read the complete file in one go.  It isn't mapped since other programs may
+	// rewrite it in place while it is being read.
+	CLTFileRead cFileRead;
+	if (!cFileRead.Open(m_strFileName.c_str()))
+	{
+		return;
+	}
+
+	uint64 nSize = 0;
+	if (!cFileRead.GetFileSize(nSize))
 	{
-		LTStrCpy(pszValueString, pszDefaultValue, nValueStringBufferSize);
 		return;
 	}
-	
-	// look for the key
-	KeyValueMap::iterator itKeyValue = (*itSection).second.m_cKeyValueMap.find(pszKeyName);
-	
-	// if it's not there, return default value
-	if (itKeyValue == (*itSection).second.m_cKeyValueMap.end())
-	{		
-		LTStrCpy(pszValueString, pszDefaultValue, nValueStringBufferSize);
+
+	std::vector<char> lstFileData((size_t)nSize + 1, 0);
+	if ((nSize > 0) && !cFileRead.Read(&lstFileData[0], (uint32)nSize))
+	{
 		return;
-	}		
-	
-	// return the value
-	LTStrCpy(pszValueString, (*itKeyValue).second.c_str(), nValueStringBufferSize);
+	}
+	cFileRead.Close();
+
+	uint32 nCurrentSection = 0;
+
+	const char* pszData = &lstFileData[0];
+	const char* pszDataEnd = pszData + nSize;
+	while (pszData < pszDataEnd)
+	{
+		// find the end of this line
+		const char* pszLineEnd = (const char*)::memchr(pszData, '\n', pszDataEnd - pszData);
+		if (!pszLineEnd)
+		{
+			pszLineEnd = pszDataEnd;
+		}
+
+		std::string strLine(pszData, pszLineEnd - pszData);
+		pszData = pszLineEnd + 1;
+
+		// the text of the line without the carriage return
+		const char* pszLine = strLine.c_str();
+		uint32 nLineLength = (uint32)::strcspn(pszLine, "\r");
+
+		if ((nLineLength == 0) || (pszLine[0] == '#'))
+		{
+			// blank line or comment
+			SLine Line;
+			Line.m_strText = strLine;
+			Line.m_nEntry = knInvalidIndex;
+			m_lstSections[nCurrentSection].m_lstLines.push_back(Line);
+		}
+		else if (pszLine[0] == '[')
+		{
+			// section header - the name runs up to the closing bracket
+			const char* pszRightBracket = (const char*)::memchr(pszLine, ']', nLineLength);
+			uint32 nNameLength = pszRightBracket ? (uint32)(pszRightBracket - pszLine - 1) : nLineLength - 1;
+
+			std::string strName(pszLine + 1, nNameLength);
+			nCurrentSection = FindSection(strName.c_str());
+			if (nCurrentSection == knInvalidIndex)
+			{
+				nCurrentSection = AddSection(pszLine + 1, nNameLength, true);
+			}
+		}
+		else
+		{
+			const char* pszEqual = (const char*)::memchr(pszLine, '=', nLineLength);
+			if (!pszEqual)
+			{
+				// not a key and value, keep it as it is
+				SLine Line;
+				Line.m_strText = strLine;
+				Line.m_nEntry = knInvalidIndex;
+				m_lstSections[nCurrentSection].m_lstLines.push_back(Line);
+				continue;
+			}
+
+			std::string strKey(pszLine, pszEqual - pszLine);
+			std::string strValue(pszEqual + 1, pszLine + nLineLength - pszEqual - 1);
+
+			// the first occurrence of a key wins
+			if (FindEntry(nCurrentSection, strKey.c_str()) == knInvalidIndex)
+			{
+				AddEntry(nCurrentSection, strKey, strValue, strLine.c_str());
+			}
+			else
+			{
+				SLine Line;
+				Line.m_strText = strLine;
+				Line.m_nEntry = knInvalidIndex;
+				m_lstSections[nCurrentSection].m_lstLines.push_back(Line);
+			}
+		}
+	}
+}
+
+bool CLinux_ProfileFile::HasChangedOnDisk() const
+{
+	struct stat64 statInfo;
+	if (::stat64(m_strFileName.c_str(), &statInfo) == -1)
+	{
+		return m_bExists;
+	}
+
+	return !m_bExists ||
+		   (statInfo.st_mtime != m_nModifiedTime) ||
+		   (statInfo.st_size != m_nSize) ||
+		   (statInfo.st_ino != m_nInode);
+}
+
+void CLinux_ProfileFile::RecordDiskState()
+{
+	struct stat64 statInfo;
+	if (::stat64(m_strFileName.c_str(), &statInfo) == -1)
+	{
+		m_bExists = false;
+		m_nModifiedTime = 0;
+		m_nSize = 0;
+		m_nInode = 0;
+	}
+	else
+	{
+		m_bExists = true;
+		m_nModifiedTime = statInfo.st_mtime;
+		m_nSize = statInfo.st_size;
+		m_nInode = statInfo.st_ino;
+	}
+
+	m_nLastCheckTimeMS = LTTimeUtils::GetTimeMS();
+}
+
+uint32 CLinux_ProfileFile::FindSection(const char* pszSectionName) const
+{
+	uint32 nHash = HashString(pszSectionName, 0);
+	for (uint32 nSection = 0; nSection < m_lstSections.size(); ++nSection)
+	{
+		const SSection& Section = m_lstSections[nSection];
+		if ((Section.m_nHash == nHash) && (Section.m_strName == pszSectionName))
+		{
+			return nSection;
+		}
+	}
+
+	return knInvalidIndex;
+}
+
+uint32 CLinux_ProfileFile::AddSection(const char* pszSectionName, uint32 nNameLength, bool bHasHeader)
+{
+	SSection Section;
+	Section.m_strName.assign(pszSectionName, nNameLength);
+	Section.m_nHash = HashString(Section.m_strName.c_str(), 0);
+	Section.m_bHasHeader = bHasHeader;
+	Section.m_bRemoved = false;
+	m_lstSections.push_back(Section);
+
+	return (uint32)m_lstSections.size() - 1;
+}
+
+uint32 CLinux_ProfileFile::FindEntry(uint32 nSection, const char* pszKeyName) const
+{
+	uint32 nHash = HashKey(nSection, pszKeyName);
+	uint32 nMask = (uint32)m_lstHashTable.size() - 1;
+
+	for (uint32 nSlot = nHash & nMask; m_lstHashTable[nSlot] != 0; nSlot = (nSlot + 1) & nMask)
+	{
+		uint32 nEntry = m_lstHashTable[nSlot] - 1;
+		const SEntry& Entry = m_lstEntries[nEntry];
+		if ((Entry.m_nHash == nHash) && (Entry.m_nSection == nSection) && (Entry.m_strKey == pszKeyName))
+		{
+			return Entry.m_bRemoved ? knInvalidIndex : nEntry;
+		}
+	}
+
+	return knInvalidIndex;
+}
+
+void CLinux_ProfileFile::AddEntry(uint32 nSection, const std::string& strKey, const std::string& strValue, const char* pszLineText)
+{
+	// removed entries stay in the table, so revive one if it exists
+	uint32 nHash = HashKey(nSection, strKey.c_str());
+	uint32 nMask = (uint32)m_lstHashTable.size() - 1;
+	for (uint32 nSlot = nHash & nMask; m_lstHashTable[nSlot] != 0; nSlot = (nSlot + 1) & nMask)
+	{
+		SEntry& Entry = m_lstEntries[m_lstHashTable[nSlot] - 1];
+		if ((Entry.m_nHash == nHash) && (Entry.m_nSection == nSection) && (Entry.m_strKey == strKey))
+		{
+			Entry.m_strValue = strValue;
+			Entry.m_bRemoved = false;
+			m_lstSections[nSection].m_lstLines[Entry.m_nLine].m_strText = pszLineText;
+			return;
+		}
+	}
+
+	SSection& Section = m_lstSections[nSection];
+
+	SEntry Entry;
+	Entry.m_nSection = nSection;
+	Entry.m_nLine = (uint32)Section.m_lstLines.size();
+	Entry.m_nHash = nHash;
+	Entry.m_bRemoved = false;
+	Entry.m_strKey = strKey;
+	Entry.m_strValue = strValue;
+	m_lstEntries.push_back(Entry);
+
+	SLine Line;
+	Line.m_strText = pszLineText;
+	Line.m_nEntry = (uint32)m_lstEntries.size() - 1;
+	Section.m_lstLines.push_back(Line);
+
+	// keep the table at most half full
+	if ((m_lstEntries.size() * 2) > m_lstHashTable.size())
+	{
+		GrowHashTable();
+	}
+	else
+	{
+		InsertIntoHashTable(Line.m_nEntry);
+	}
 }
 
-void LTProfileUtils::ReadString(const wchar_t* pszSectionName, 
+void CLinux_ProfileFile::InsertIntoHashTable(uint32 nEntry)
+{
+	uint32 nMask = (uint32)m_lstHashTable.size() - 1;
+	uint32 nSlot = m_lstEntries[nEntry].m_nHash & nMask;
+	while (m_lstHashTable[nSlot] != 0)
+	{
+		nSlot = (nSlot + 1) & nMask;
+	}
+
+	m_lstHashTable[nSlot] = nEntry + 1;
+}
+
+void CLinux_ProfileFile::GrowHashTable()
+{
+	uint32 nNewSize = (uint32)m_lstHashTable.size() * 2;
+	m_lstHashTable.clear();
+	m_lstHashTable.resize(nNewSize, 0);
+
+	for (uint32 nEntry = 0; nEntry < m_lstEntries.size(); ++nEntry)
+	{
+		InsertIntoHashTable(nEntry);
+	}
+}
+
+uint32 CLinux_ProfileFile::HashString(const char* pszString, uint32 nSeed)
+{
+	// FNV-1a
+	uint32 nHash = 2166136261U ^ nSeed;
+	for (; *pszString; ++pszString)
+	{
+		nHash ^= (uint8)*pszString;
+		nHash *= 16777619U;
+	}
+
+	return nHash;
+}
+
+uint32 CLinux_ProfileFile::HashKey(uint32 nSection, const char* pszKeyName)
+{
+	return HashString(pszKeyName, nSection * 0x9E3779B9U);
+}
+
+// Cache of all profiles that have been accessed.  Any writes that could not be
+// flushed when they were made are tried again when the module is unloaded.
+class CLinux_ProfileCache
+{
+public:
+
+	~CLinux_ProfileCache();
+
+	// returns the profile for the file, loading it if necessary
+	CLinux_ProfileFile* GetProfile(const char* pszFileName);
+
+	// critical section protecting the cache and all of the profiles
+	CLTCriticalSection m_csCache;
+
+private:
+
+	// profiles by absolute path
+	typedef std::map<std::string, CLinux_ProfileFile*> ProfileMap;
+	ProfileMap m_cProfiles;
+
+	// profiles by the file name passed in, which avoids resolving the path on every access
+	ProfileMap m_cProfilesByName;
+};
+
+CLinux_ProfileCache::~CLinux_ProfileCache()
+{
+	for (ProfileMap::iterator itProfile = m_cProfiles.begin(); itProfile != m_cProfiles.end(); ++itProfile)
+	{
+		itProfile->second->Flush(true);
+		delete itProfile->second;
+	}
+}
+
+CLinux_ProfileFile* CLinux_ProfileCache::GetProfile(const char* pszFileName)
+{
+	ProfileMap::iterator itProfile = m_cProfilesByName.find(pszFileName);
+	if (itProfile != m_cProfilesByName.end())
+	{
+		return itProfile->second;
+	}
+
+	// resolve file to absolute path so that different names for a file share a profile.
+	// A file that does not exist yet is kept under the name it was given.
+	char pszAbsoluteFileName[MAX_PATH];
+	if (!::realpath(pszFileName, pszAbsoluteFileName))
+	{
+		LTStrCpy(pszAbsoluteFileName, pszFileName, LTARRAYSIZE(pszAbsoluteFileName));
+	}
+
+	CLinux_ProfileFile* pProfile = NULL;
+
+	itProfile = m_cProfiles.find(pszAbsoluteFileName);
+	if (itProfile != m_cProfiles.end())
+	{
+		pProfile = itProfile->second;
+	}
+	else
+	{
+		LT_MEM_TRACK_ALLOC(pProfile = new CLinux_ProfileFile(pszAbsoluteFileName), LT_MEM_TYPE_MISC);
+		m_cProfiles.insert(std::make_pair(std::string(pszAbsoluteFileName), pProfile));
+	}
+
+	m_cProfilesByName.insert(std::make_pair(std::string(pszFileName), pProfile));
+	return pProfile;
+}
+
+// declare profile cache
+static CLinux_ProfileCache g_cProfileCache;
+
+void LTProfileUtils::ReadString(const char*  pszSectionName,
+								const char*  pszKeyName,
+								const char*  pszDefaultValue,
+								char* 	   pszValueString,
+								uint32	   nValueStringBufferSize,
+								const char*  pszFileName)
+{
+	CLTAutoCriticalSection cAutoCS(g_cProfileCache.m_csCache);
+
+	const char* pszValue = NULL;
+	if (pszSectionName && pszKeyName && pszFileName)
+	{
+		CLinux_ProfileFile* pProfile = g_cProfileCache.GetProfile(pszFileName);
+		pProfile->Refresh(false);
+
+		pszValue = pProfile->FindValue(pszSectionName, pszKeyName);
+	}
+
+	// fall back to the default value if the key is not present
+	if (!pszValue)
+	{
+		pszValue = pszDefaultValue ? pszDefaultValue : "";
+	}
+
+	// the value may be the same buffer as the default
+	if (pszValue != pszValueString)
+	{
+		LTStrCpy(pszValueString, pszValue, nValueStringBufferSize);
+	}
+}
+
+void LTProfileUtils::ReadString(const wchar_t* pszSectionName,
 								const wchar_t* pszKeyName,
 								const wchar_t* pszDefaultValue,
 								wchar_t*	     pszValueString,
@@ -111,29 +713,29 @@ void LTProfileUtils::ReadString(const wchar_t* pszSectionName,
 	// get ANSI versions of strings
 	char pszSectionNameANSI[MAX_PATH];
 	LTStrCpy(pszSectionNameANSI, MPW2A(pszSectionName).c_str(), MAX_PATH);
-	
+
 	char pszKeyNameANSI[MAX_PATH];
 	LTStrCpy(pszKeyNameANSI, MPW2A(pszKeyName).c_str(), MAX_PATH);
-	
+
 	char pszDefaultValueANSI[MAX_PATH];
 	LTStrCpy(pszDefaultValueANSI, MPW2A(pszDefaultValue).c_str(), MAX_PATH);
-	
+
 	char pszFileNameANSI[MAX_PATH];
 	LTStrCpy(pszFileNameANSI, MPW2A(pszFileName).c_str(), MAX_PATH);
-	
+
 	char* pszValueStringANSI = NULL;
 	LT_MEM_TRACK_ALLOC(pszValueStringANSI = new char[nValueStringBufferSize], LT_MEM_TYPE_MISC);
-	
+
 	// call ANSI version
 	ReadString(pszSectionNameANSI, pszKeyNameANSI, pszDefaultValueANSI, pszValueStringANSI, nValueStringBufferSize, pszFileNameANSI);
-	
+
 	// convert output value
 	LTStrCpy(pszValueString, MPA2W(pszValueStringANSI), nValueStringBufferSize);
-	
+
 	delete [] pszValueStringANSI;
 }
 
-uint32 LTProfileUtils::ReadUint32(const char* pszSectionName, 
+uint32 LTProfileUtils::ReadUint32(const char* pszSectionName,
 								const char* pszKeyName,
 								uint32 nDefault,
 								const char* pszFileName)
@@ -141,30 +743,76 @@ uint32 LTProfileUtils::ReadUint32(const char* pszSectionName,
 	char szValue[64];
 	LTSNPrintF( szValue, LTARRAYSIZE( szValue ), "%d", nDefault );
 	ReadString( pszSectionName, pszKeyName, szValue, szValue, LTARRAYSIZE( szValue ), pszFileName);
-	
+
 	return ( uint32 )atoi( szValue );
 }
 
 
-bool LTProfileUtils::WriteString(const char* pszSectionName, 
+bool LTProfileUtils::WriteString(const char* pszSectionName,
 								const char* pszKeyName,
 								const char* pszValueString,
 								const char* pszFileName)
 {
-	// temporary stub
-	return false;
+	if (!pszFileName)
+	{
+		return false;
+	}
+
+	CLTAutoCriticalSection cAutoCS(g_cProfileCache.m_csCache);
+
+	CLinux_ProfileFile* pProfile = g_cProfileCache.GetProfile(pszFileName);
+
+	// writes are rare, so always pick up changes made by others before applying them
+	pProfile->Refresh(true);
+
+	// Following the Win32 conventions a NULL section flushes the file, a NULL key
+	// removes the section and a NULL value removes the key.  Every change is written
+	// through to the file straight away, as on Win32, so it survives the process
+	// being killed and other processes see it.  Only an explicit flush waits for the
+	// data to reach the disk, since callers write many keys in a row.
+	if (!pszSectionName)
+	{
+		return pProfile->Flush(true);
+	}
+	else if (!pszKeyName)
+	{
+		pProfile->RemoveSection(pszSectionName);
+	}
+	else if (!pszValueString)
+	{
+		pProfile->RemoveKey(pszSectionName, pszKeyName);
+	}
+	else
+	{
+		pProfile->SetValue(pszSectionName, pszKeyName, pszValueString);
+	}
+
+	return pProfile->Flush(false);
 }
 
-bool LTProfileUtils::WriteString(const wchar_t* pszSectionName, 
+bool LTProfileUtils::WriteString(const wchar_t* pszSectionName,
 								const wchar_t* pszKeyName,
 								const wchar_t* pszValueString,
 								const wchar_t* pszFileName)
 {
-	// temporary stub
-	return false;
+	if (!pszFileName)
+	{
+		return false;
+	}
+
+	// get ANSI versions of strings, keeping NULL arguments since they carry meaning
+	std::string strSectionName = pszSectionName ? MPW2A(pszSectionName).c_str() : "";
+	std::string strKeyName = pszKeyName ? MPW2A(pszKeyName).c_str() : "";
+	std::string strValue = pszValueString ? MPW2A(pszValueString).c_str() : "";
+	std::string strFileName = MPW2A(pszFileName).c_str();
+
+	return WriteString(pszSectionName ? strSectionName.c_str() : NULL,
+					   pszKeyName ? strKeyName.c_str() : NULL,
+					   pszValueString ? strValue.c_str() : NULL,
+					   strFileName.c_str());
 }
 
-bool LTProfileUtils::WriteUint32(const char* pszSectionName, 
+bool LTProfileUtils::WriteUint32(const char* pszSectionName,
 								const char* pszKeyName,
 								uint32 nValue,
 								const char* pszFileName)
@@ -174,119 +822,64 @@ bool LTProfileUtils::WriteUint32(const char* pszSectionName,
 	return (WriteString(pszSectionName, pszKeyName, szValue, pszFileName) != 0);
 }
 
-static bool IsEOL(const char* pData, uint32 nOffset, uint32& nEOLLength)
-{
-	// check for end of buffer
-	if (pData[nOffset] == 0) 
-	{
-		return true;
-	}
-	// check for CR character
-	else if (pData[nOffset] == '\r') 
-	{
-		// check for the following LF
-		if (pData[nOffset + 1] != 0)
-		{
-			if (pData[nOffset + 1] == '\n')
-			{
-				// end of line
-				nEOLLength = 2;
-
-				return true;
-			}
-		}
-		else
-		{
-			// found CR + end of buffer
-			nEOLLength = 1;
-
-			return true;
-		}
-	}
-	// check for LF character
-	else if (pData[nOffset] == '\n')
-	{
-		// end of line
-		nEOLLength = 1;
-
-		return true;
-	}
+#ifndef _FINAL
 
-	// not end of line
-	return false;
-}
+// The line by line reader that the cached profiles replaced, kept as it was
+// apart from starting outside of any section, so that the test can compare
+// against it.
+typedef std::map<std::string, std::string> TOldKeyValueMap;
+typedef std::map<std::string, TOldKeyValueMap> TOldSectionMap;
 
-static bool ReadLineFromProfileFile(CLTFileRead& cFileRead, char* pszLineBuffer, uint32 nLineBufferLength)
+static bool OldReadProfileLine(CLTFileRead& cFileRead, char* pszLineBuffer, uint32 nLineBufferLength)
 {
 	::memset(pszLineBuffer, 0, nLineBufferLength);
-	
+
 	uint64 nPos = 0;
-	if (!cFileRead.GetPos(nPos))
-	{
-		return false;
-	}
-	
 	uint64 nSize = 0;
-	if (!cFileRead.GetFileSize(nSize))
+	if (!cFileRead.GetPos(nPos) || !cFileRead.GetFileSize(nSize))
 	{
 		return false;
 	}
-		
+
 	uint64 nAmountRemaining = nSize - nPos;
-	
 	if (nAmountRemaining == 0)
 	{
 		return false;
 	}
-	
+
 	// read from the file until we either run out of buffer space or file data
 	for (uint32 nBufferIndex = 0; nBufferIndex < nLineBufferLength && nAmountRemaining > 0; ++nBufferIndex, --nAmountRemaining)
 	{
-		char cChar;
-		
-
-		if (!cFileRead.Read(&cChar, 1))
+		if (!cFileRead.Read(pszLineBuffer + nBufferIndex, 1))
 		{
-			// read failure
 			return false;
 		}
-		
-		*(pszLineBuffer + nBufferIndex) = cChar;
-		
-		if (*(pszLineBuffer + nBufferIndex) == '\n')
+
+		if (pszLineBuffer[nBufferIndex] == '\n')
 		{
-			// end of line
 			return true;
 		}
 	}
-	
+
 	return true;
-}	
-		
+}
 
-ProfileCache::iterator ProcessProfileFile(const char* pszFileName)
+static bool OldReadProfile(const char* pszFileName, TOldSectionMap& cSections)
 {
-	ProfileCache::iterator itCachedProfile = g_cProfileCache.end();
-	
-	// open the file	
+	cSections.clear();
+
 	CLTFileRead cFileRead;
 	if (!cFileRead.Open(pszFileName))
 	{
-		// can't open it
-		return itCachedProfile;
+		return false;
 	}
-	
-	ProfileSections cProfileSections;
 
-	// process the file line-by-line
 	char pszLine[MAX_PATH];
-	char pszCurrentSection[MAX_PATH];
+	char pszCurrentSection[MAX_PATH] = "";
 	char pszKey[MAX_PATH];
 	char pszValue[MAX_PATH];
-	
-	bool bIsEOF = false;
 
-	while (ReadLineFromProfileFile(cFileRead, pszLine, MAX_PATH))
+	while (OldReadProfileLine(cFileRead, pszLine, MAX_PATH))
 	{
 		if ((pszLine[0] == '\n') || (pszLine[0] == '\r') || (pszLine[0] == '#'))
 		{
@@ -297,8 +890,7 @@ ProfileCache::iterator ProcessProfileFile(const char* pszFileName)
 		{
 			// section tag - find ending bracket
 			char* pszRightBracket = ::index(pszLine, ']');
-			
-			LTSubStrCpy(pszCurrentSection, pszLine + 1, MAX_PATH, LTStrLen(pszLine) - LTStrLen(pszRightBracket) - 1);			
+			LTSubStrCpy(pszCurrentSection, pszLine + 1, MAX_PATH, LTStrLen(pszLine) - LTStrLen(pszRightBracket) - 1);
 		}
 		else
 		{
@@ -306,35 +898,205 @@ ProfileCache::iterator ProcessProfileFile(const char* pszFileName)
 			char* pszEqual = ::index(pszLine, '=');
 			if (!pszEqual)
 			{
-				// no equal sign
 				continue;
 			}
-			
-			// extract the key and value
+
 			LTSubStrCpy(pszKey, pszLine, MAX_PATH, LTStrLen(pszLine) - LTStrLen(pszEqual));
 			char* pszEOL = ::strpbrk(pszLine, "\r\n");
 			LTSubStrCpy(pszValue, pszEqual + 1, MAX_PATH, LTStrLen(pszEqual + 1) - LTStrLen(pszEOL));
-			
-			// add them to the cache			
-			SectionMap::iterator itSection = cProfileSections.m_cSectionMap.find(pszCurrentSection);
-			if (itSection == cProfileSections.m_cSectionMap.end())
+
+			// the first occurrence of a key wins
+			cSections[pszCurrentSection].insert(std::make_pair(std::string(pszKey), std::string(pszValue)));
+		}
+	}
+
+	return true;
+}
+
+// returns the value of a key read with the old reader, or NULL if it is not present
+static const char* OldFindValue(const TOldSectionMap& cSections, const std::string& strSection, const std::string& strKey)
+{
+	TOldSectionMap::const_iterator itSection = cSections.find(strSection);
+	if (itSection == cSections.end())
+	{
+		return NULL;
+	}
+
+	TOldKeyValueMap::const_iterator itKey = itSection->second.find(strKey);
+	return (itKey == itSection->second.end()) ? NULL : itKey->second.c_str();
+}
+
+// returns a random piece of profile text.  Brackets are left out since the old
+// reader can't handle a section header without its closing bracket.
+static std::string RandomProfileText(uint32& nSeed, uint32 nMaxLength, const char* pszCharacters)
+{
+	uint32 nNumCharacters = LTStrLen(pszCharacters);
+
+	std::string strText;
+	nSeed = (nSeed * 1103515245U) + 12345U;
+	uint32 nLength = (nSeed >> 16) % (nMaxLength + 1);
+	for (uint32 nCharacter = 0; nCharacter < nLength; ++nCharacter)
+	{
+		nSeed = (nSeed * 1103515245U) + 12345U;
+		strText += pszCharacters[(nSeed >> 16) % nNumCharacters];
+	}
+
+	return strText;
+}
+
+uint32 LTProfileUtils::RunCompareTest(const char* pszFolder, uint32 nNumFiles, ReportFn pfnReport)
+{
+	static const char* const kpszDefault = "<default>";
+
+	// lines the generated files start with, covering comments, blank lines, spacing
+	// around the equals sign, empty values, repeated keys and sections, text after
+	// a section header, carriage returns and keys before the first section
+	static const char* const kpszFixedLines =
+		"Early=before any section\n"
+		"# comment\n"
+		"\n"
+		"[Server]\n"
+		"Name=Test Server\n"
+		"Port = 27888 \n"
+		"Empty=\n"
+		"Equals=a=b=c\n"
+		"Repeated=first\n"
+		"Repeated=second\n"
+		"NoEquals\n"
+		"#Hidden=1\n"
+		"[Client]ignored\n"
+		"CRLF=value\r\n"
+		"\r\n"
+		"Middle=va\rlue\n"
+		"=NoKey\n"
+		"[Server]\n"
+		"Extra=from the repeated section\n"
+		"[]\n"
+		"Unnamed=1\n";
+
+	static const char* const kpszFixedSections[] = { "", "Server", "Client", "Missing" };
+	static const char* const kpszFixedKeys[] = { "Early", "Name", "Port", "Port ", "Empty", "Equals", "Repeated", "NoEquals",
+		"#Hidden", "CRLF", "Middle", "", "Extra", "Unnamed", "Missing" };
+
+	uint32 nFailures = 0;
+	char szMessage[512];
+	char szValue[512];
+
+	uint32 nSeed = 12345;
+	uint32 nRunTime = LTTimeUtils::GetTimeMS();
+
+	for (uint32 nFile = 0; nFile < nNumFiles; ++nFile)
+	{
+		// the name is new every run so that the profile cache doesn't hold an older file
+		char szFileName[MAX_PATH];
+		LTSNPrintF(szFileName, LTARRAYSIZE(szFileName), "%sProfileCompareTest_%u_%u.ini", pszFolder, nRunTime, nFile);
+
+		std::vector<std::string> lstSections(kpszFixedSections, kpszFixedSections + LTARRAYSIZE(kpszFixedSections));
+		std::vector<std::string> lstKeys(kpszFixedKeys, kpszFixedKeys + LTARRAYSIZE(kpszFixedKeys));
+
+		// generate the file, with random sections and keys after the fixed lines
+		std::string strFile = kpszFixedLines;
+		uint32 nNumSections = 1 + (nFile % 8);
+		for (uint32 nSection = 0; nSection < nNumSections; ++nSection)
+		{
+			std::string strSection = RandomProfileText(nSeed, 16, "abcXYZ019 _-.#=;");
+			lstSections.push_back(strSection);
+			strFile += "[" + strSection + "]\n";
+
+			uint32 nNumKeys = 1 + (nSeed >> 16) % 24;
+			for (uint32 nKey = 0; nKey < nNumKeys; ++nKey)
 			{
-				// add new section
-				ProfileSectionEntries cNewProfileSectionEntries;
-				cNewProfileSectionEntries.m_cKeyValueMap.insert(std::pair<std::string, std::string>(pszKey, pszValue));
-				cProfileSections.m_cSectionMap.insert(std::pair<std::string, ProfileSectionEntries>(pszCurrentSection, cNewProfileSectionEntries));
+				std::string strKey = RandomProfileText(nSeed, 24, "abcXYZ019 _-.#;");
+				lstKeys.push_back(strKey);
+				strFile += strKey + "=" + RandomProfileText(nSeed, 64, "abcXYZ019 _-.#=;\r") + (((nSeed >> 16) & 1) ? "\r\n" : "\n");
 			}
-			else
+		}
+
+		FILE* pFile = ::fopen(szFileName, "wb");
+		if (!pFile || (::fwrite(strFile.c_str(), 1, strFile.size(), pFile) != strFile.size()))
+		{
+			if (pFile)
+			{
+				::fclose(pFile);
+			}
+
+			LTSNPrintF(szMessage, LTARRAYSIZE(szMessage), "could not write %s", szFileName);
+			pfnReport(szMessage);
+			return nFailures + 1;
+		}
+		::fclose(pFile);
+
+		// every section and key must read the same with both readers
+		TOldSectionMap cOldSections;
+		OldReadProfile(szFileName, cOldSections);
+
+		for (uint32 nSection = 0; nSection < lstSections.size(); ++nSection)
+		{
+			for (uint32 nKey = 0; nKey < lstKeys.size(); ++nKey)
+			{
+				const char* pszOldValue = OldFindValue(cOldSections, lstSections[nSection], lstKeys[nKey]);
+				ReadString(lstSections[nSection].c_str(), lstKeys[nKey].c_str(), kpszDefault, szValue, LTARRAYSIZE(szValue), szFileName);
+
+				if (!LTStrEquals(szValue, pszOldValue ? pszOldValue : kpszDefault))
+				{
+					LTSNPrintF(szMessage, LTARRAYSIZE(szMessage), "file %u [%s] '%s' read '%s' instead of '%s'", nFile,
+						lstSections[nSection].c_str(), lstKeys[nKey].c_str(), szValue, pszOldValue ? pszOldValue : kpszDefault);
+					pfnReport(szMessage);
+					++nFailures;
+				}
+			}
+		}
+
+		// a write must be in the file as soon as it returns, which the old reader
+		// stands in for another process to check
+		const std::string& strSection = lstSections[4];
+		LTSNPrintF(szValue, LTARRAYSIZE(szValue), "written %u", nFile);
+
+		bool bWritten = WriteString(strSection.c_str(), "Written", szValue, szFileName);
+		OldReadProfile(szFileName, cOldSections);
+		const char* pszOldValue = OldFindValue(cOldSections, strSection, "Written");
+		bool bWriteFound = bWritten && pszOldValue && LTStrEquals(pszOldValue, szValue);
+
+		bool bRemoved = WriteString(strSection.c_str(), "Written", NULL, szFileName);
+		OldReadProfile(szFileName, cOldSections);
+		bool bRemoveFound = bRemoved && !OldFindValue(cOldSections, strSection, "Written");
+
+		bool bSectionRemoved = WriteString("Server", NULL, NULL, szFileName);
+		OldReadProfile(szFileName, cOldSections);
+		bool bSectionRemoveFound = bSectionRemoved && (cOldSections.find("Server") == cOldSections.end());
+
+		bool bFlushed = WriteString(NULL, NULL, NULL, szFileName);
+
+		if (!bWriteFound || !bRemoveFound || !bSectionRemoveFound || !bFlushed)
+		{
+			LTSNPrintF(szMessage, LTARRAYSIZE(szMessage), "file %u writes not in the file: set %d, remove key %d, remove section %d, flush %d",
+				nFile, bWriteFound, bRemoveFound, bSectionRemoveFound, bFlushed);
+			pfnReport(szMessage);
+			++nFailures;
+		}
+
+		// the rest of the file must be untouched by the writes
+		TOldSectionMap::const_iterator itSection = cOldSections.begin();
+		for (; itSection != cOldSections.end(); ++itSection)
+		{
+			TOldKeyValueMap::const_iterator itKey = itSection->second.begin();
+			for (; itKey != itSection->second.end(); ++itKey)
 			{
-				// add to current section
-				(*itSection).second.m_cKeyValueMap.insert(std::pair<std::string, std::string>(pszKey, pszValue));
-			}						
+				ReadString(itSection->first.c_str(), itKey->first.c_str(), kpszDefault, szValue, LTARRAYSIZE(szValue), szFileName);
+				if (!LTStrEquals(szValue, itKey->second.c_str()))
+				{
+					LTSNPrintF(szMessage, LTARRAYSIZE(szMessage), "file %u [%s] '%s' read '%s' after writing instead of '%s'", nFile,
+						itSection->first.c_str(), itKey->first.c_str(), szValue, itKey->second.c_str());
+					pfnReport(szMessage);
+					++nFailures;
+				}
+			}
 		}
+
+		::unlink(szFileName);
 	}
-	
-	// add to profile cache
-	return (g_cProfileCache.insert(std::pair<std::string, ProfileSections>(pszFileName, cProfileSections))).first;	
+
+	return nFailures;
 }
-	
-	
-	
+
+#endif // _FINAL
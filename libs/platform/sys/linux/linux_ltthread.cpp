@@ -11,6 +11,7 @@
 // *********************************************************************** //
 
 #include "linux_ltthread.h"
+#include <sched.h>
 
 extern "C" 
 {
@@ -26,8 +27,34 @@ void CLinux_LTThread::Create(UserThreadFunction pUserThreadFunction, void* pArgu
 	m_threadArgument.m_pUserThreadFunction = pUserThreadFunction;
 	m_threadArgument.m_pArgument = pArgument;
 
-	int returnValue = ::pthread_create(&m_hThread, NULL, &InternalThreadFunction, (void*)&m_threadArgument);
+	pthread_attr_t threadAttributes;
+	::pthread_attr_init(&threadAttributes);
+
+	// restrict the thread to the requested processor before it starts running
+	if (nProcessorAffinity != (uint32)-1)
+	{
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		CPU_SET(nProcessorAffinity, &cpuSet);
+		::pthread_attr_setaffinity_np(&threadAttributes, sizeof(cpuSet), &cpuSet);
+	}
+
+	int returnValue = ::pthread_create(&m_hThread, &threadAttributes, &InternalThreadFunction, (void*)&m_threadArgument);
 	
+	::pthread_attr_destroy(&threadAttributes);
+
+	// the processor may not be available to this process, so fall back to no affinity
+	if ((returnValue != 0) && (nProcessorAffinity != (uint32)-1))
+	{
+		returnValue = ::pthread_create(&m_hThread, NULL, &InternalThreadFunction, (void*)&m_threadArgument);
+	}
+
+	// the handle is undefined on failure, so clear it so that IsCreated reports the failure
+	if (returnValue != 0)
+	{
+		m_hThread = 0;
+	}
+
 	LTASSERT(returnValue == 0, "Failed to create thread");
 }
 
@@ -28,3 +28,9 @@ void LTThreadUtils::SetThreadDebugName(const char* pszDebugName)
 {
 	LTUNREFERENCED_PARAMETER(pszDebugName);
 }
+
+uint32 LTThreadUtils::GetProcessorCount()
+{
+	long nProcessors = ::sysconf(_SC_NPROCESSORS_ONLN);
+	return (nProcessors > 0) ? (uint32)nProcessors : 1;
+}
@@ -94,11 +94,12 @@ uint32 LTTimeUtils::GetTimeMS()
 
 TLTPrecisionTime LTTimeUtils::GetPrecisionTime()
 {
-	CLTAutoCriticalSection cTimeAutoCS(g_cTimeCS);
-	
+	// gettimeofday() is thread safe and this doesn't touch g_nLastTime, so no
+	// lock is needed.  Callers such as the performance event log rely on this
+	// not blocking.  Widen before multiplying so a 32 bit time_t doesn't overflow.
 	struct timeval timeValue;
 	::gettimeofday(&timeValue, NULL);
-	return (TLTPrecisionTime)((timeValue.tv_sec * 1000000) + timeValue.tv_usec);
+	return ((TLTPrecisionTime)timeValue.tv_sec * 1000000) + (TLTPrecisionTime)timeValue.tv_usec;
 }
 
 double LTTimeUtils::GetPrecisionTimeIntervalMS(TLTPrecisionTime StartTime, TLTPrecisionTime EndTime)
@@ -45,6 +45,16 @@ public:
 	// to opening the new file.  Returns false if the file does not exist on disk.
 	virtual bool Open(const char* pszFilename);
 
+	// open the file for reading and map a read-only view of it.  Reads still go
+	// through the buffered path, and the view is only used by GetMappedRange.  If the
+	// view cannot be created the file is left open for buffered reading.  Returns
+	// false if the file does not exist on disk.
+	virtual bool OpenMapped(const char* pszFilename, EAccessPattern eAccessPattern = eAccessNormal);
+
+	// return a pointer to nBytes of mapped file data starting at nPos.  Returns NULL if
+	// the file is not mapped or the range extends past the end of the file.
+	virtual const void* GetMappedRange(uint64 nPos, uint64 nBytes);
+
 	// test to see if this object has an open file.  Returns false if an error
 	// occurs during the operation.
 	virtual bool GetIsOpen(bool& bIsOpen);
@@ -94,6 +104,9 @@ private:
 	// helper for resetting the buffer positions
 	void ResetBuffer() { m_nBufferAmount = 0; m_nCurrentBufferPos = 0; }
 
+	// release the mapped view if there is one
+	void Unmap();
+
 	// file data buffer
 	CWin32_LTFileBuffer* m_pFileBuffer;
 
@@ -103,12 +116,22 @@ private:
 	// amount of data in the buffer, regardless of the current position
 	uint32 m_nBufferAmount;
 
+	// file mapping object and its read-only view, or NULL if the file is not mapped
+	HANDLE m_hMapping;
+	const uint8* m_pMappedData;
+
+	// size of the mapped view
+	uint64 m_nMappedSize;
+
 	// prevent copy and assignment
 	PREVENT_OBJECT_COPYING(CWin32_LTFileRead);
 
 };
 
 inline CWin32_LTFileRead::CWin32_LTFileRead()
+	: m_hMapping(NULL),
+	  m_pMappedData(NULL),
+	  m_nMappedSize(0)
 {
 	// acquire a file buffer
 	m_pFileBuffer = CWin32_LTFileBuffer::Allocate();
@@ -118,15 +141,78 @@ inline CWin32_LTFileRead::CWin32_LTFileRead()
 
 inline CWin32_LTFileRead::~CWin32_LTFileRead()
 {
+	Unmap();
+
 	// release the file buffer 
 	m_pFileBuffer->Release();
 }
 
 inline bool CWin32_LTFileRead::Open(const char* pszFilename)
 {
+	Unmap();
+
 	return OpenImpl(pszFilename, eOpenRead);
 }
 
+inline bool CWin32_LTFileRead::OpenMapped(const char* pszFilename, EAccessPattern eAccessPattern)
+{
+	LTUNREFERENCED_PARAMETER(eAccessPattern);
+
+	if (!Open(pszFilename))
+	{
+		return false;
+	}
+
+	// empty files cannot be mapped, but the buffered path handles them fine
+	uint64 nSize = 0;
+	if (!GetFileSizeImpl(nSize) || (nSize == 0) || (nSize != (uint64)(SIZE_T)nSize))
+	{
+		return true;
+	}
+
+	// views of the same file in other processes share the same physical pages
+	HANDLE hMapping = ::CreateFileMappingA(GetFileHandle(), NULL, PAGE_READONLY, 0, 0, NULL);
+	if (hMapping == NULL)
+	{
+		return true;
+	}
+
+	void* pView = ::MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (pView == NULL)
+	{
+		::CloseHandle(hMapping);
+		return true;
+	}
+
+	m_hMapping	  = hMapping;
+	m_pMappedData = (const uint8*)pView;
+	m_nMappedSize = nSize;
+
+	return true;
+}
+
+inline const void* CWin32_LTFileRead::GetMappedRange(uint64 nPos, uint64 nBytes)
+{
+	if ((m_pMappedData == NULL) || (nPos > m_nMappedSize) || (nBytes > (m_nMappedSize - nPos)))
+	{
+		return NULL;
+	}
+
+	return m_pMappedData + nPos;
+}
+
+inline void CWin32_LTFileRead::Unmap()
+{
+	if (m_pMappedData != NULL)
+	{
+		::UnmapViewOfFile(m_pMappedData);
+		::CloseHandle(m_hMapping);
+		m_hMapping	  = NULL;
+		m_pMappedData = NULL;
+		m_nMappedSize = 0;
+	}
+}
+
 inline bool CWin32_LTFileRead::GetIsOpen(bool& bIsOpen)
 {
 	return GetIsOpenImpl(bIsOpen);
@@ -191,6 +277,8 @@ inline bool CWin32_LTFileRead::GetFileSize(uint64& nSize)
 
 inline bool CWin32_LTFileRead::Close()
 {
+	Unmap();
+
 	return CloseImpl();
 }
 
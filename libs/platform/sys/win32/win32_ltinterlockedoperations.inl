@@ -12,12 +12,28 @@
 
 #include "windows.h"
 
-inline void LTInterlockedOperations::InterlockedIncrement(uint32* pAddend)
+inline uint32 LTInterlockedOperations::InterlockedIncrement(uint32* pAddend)
 {
-	::InterlockedIncrement((long volatile*)pAddend);
+	return ::InterlockedIncrement((long volatile*)pAddend);
 }
 
 inline uint32 LTInterlockedOperations::InterlockedDecrement(uint32* pAddend)
 {
 	return ::InterlockedDecrement((long volatile*)pAddend);
 }
+
+inline uint32 LTInterlockedOperations::InterlockedExchange(uint32* pTarget, uint32 nValue)
+{
+	return ::InterlockedExchange((long volatile*)pTarget, nValue);
+}
+
+inline void* LTInterlockedOperations::InterlockedExchangePtr(void* volatile* ppTarget, void* pValue)
+{
+#if defined(_WIN64)
+	return ::InterlockedExchangePointer((PVOID volatile*)ppTarget, pValue);
+#else
+	// Pointers are the size of a long, and older SDKs define
+	// InterlockedExchangePointer as a macro in terms of InterlockedExchange.
+	return (void*)::InterlockedExchange((long volatile*)ppTarget, (long)pValue);
+#endif
+}
@@ -70,6 +70,12 @@ inline void CWin32_LTThread::Create(UserThreadFunction pUserThreadFunction, void
 	DWORD nThreadID;
 	m_hThread = ::CreateThread(NULL, 0, InternalThreadFunction, &m_threadArgument, 0, &nThreadID);
 
+	// CreateThread returns NULL on failure, so convert that to the value IsCreated checks for
+	if (m_hThread == NULL)
+	{
+		m_hThread = INVALID_HANDLE_VALUE;
+	}
+
 	LTASSERT(m_hThread != INVALID_HANDLE_VALUE, "Failed to create thread");
 }
 
@@ -55,3 +55,10 @@ void LTThreadUtils::SetThreadDebugName(const char* pszDebugName)
 	LTUNREFERENCED_PARAMETER(pszDebugName);
 #endif
 }
+
+uint32 LTThreadUtils::GetProcessorCount()
+{
+	SYSTEM_INFO systemInfo;
+	::GetSystemInfo(&systemInfo);
+	return (systemInfo.dwNumberOfProcessors > 0) ? (uint32)systemInfo.dwNumberOfProcessors : 1;
+}